@@ -0,0 +1,873 @@
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include "EditSession.h"
+#include "ClipTrackIndexMap.h"
+#include "ParameterStream.h"
+#include "UndoableCommandHandler.h"
+#include "CommandHandler.h"
+#include "CommandServer.h"
+#include "LocalCommandServer.h"
+#include "MediaImporter.h"
+#include "ProjectFileFormat.h"
+#include "ProjectManager.h"
+#include "RenderScheduler.h"
+#include "SampleLibraryIndex.h"
+#include "SamplePreviewPlayer.h"
+#include "SpectralSeparation.h"
+
+#include <array>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace te = tracktion;
+
+namespace
+{
+
+void expect (bool condition, const std::string& message)
+{
+    if (! condition)
+        throw std::runtime_error (message);
+}
+
+/** Runs body() iterations times after a short warm-up and returns mean µs per call. */
+double measureMicrosPerIteration (int iterations, const std::function<void (int)>& body)
+{
+    const int warmUp = juce::jmax (1, iterations / 10);
+    for (int i = 0; i < warmUp; ++i)
+        body (i);
+
+    const auto start = juce::Time::getHighResolutionTicks();
+    for (int i = 0; i < iterations; ++i)
+        body (i);
+    const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+    return juce::Time::highResolutionTicksToSeconds (elapsed) * 1.0e6 / (double) iterations;
+}
+
+void report (const std::string& name, double microsPerIteration)
+{
+    std::cout << "  " << std::left << std::setw (48) << name
+              << std::right << std::setw (10) << std::fixed << std::setprecision (2)
+              << microsPerIteration << " us/op" << std::endl;
+}
+
+juce::var makeSetTrackVolumeCommand (double valueDb)
+{
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("action", "set_track_volume");
+    obj->setProperty ("track_id", 0);
+    obj->setProperty ("value_db", valueDb);
+    return juce::var (obj);
+}
+
+double volumeForIteration (int i)
+{
+    return -24.0 + (double) (i % 240) * 0.1;
+}
+
+//==============================================================================
+void benchmarkSetTrackVolumeDispatch (te::Engine& engine)
+{
+    constexpr int iterations = 20000;
+
+    EditSession session (engine);
+    session.getEdit().ensureNumberOfAudioTracks (1);
+    CommandHandler handler (session.getEdit());
+    UndoableCommandHandler undoableHandler (handler, session);
+
+    std::cout << "set_track_volume dispatch (" << iterations << " iterations)" << std::endl;
+
+    // Legacy path: serialise the command, let each layer parse it, then re-parse
+    // the response to check status — what runCommandCoalesced/AiAgent used to do.
+    report ("CommandHandler JSON round-trip",
+            measureMicrosPerIteration (iterations, [&] (int i)
+            {
+                auto response = juce::JSON::parse (
+                    handler.handleCommand (juce::JSON::toString (makeSetTrackVolumeCommand (volumeForIteration (i)))));
+                expect (response["status"].toString() == "ok", "Expected JSON set_track_volume to succeed");
+            }));
+
+    report ("CommandHandler typed executeCommand",
+            measureMicrosPerIteration (iterations, [&] (int i)
+            {
+                auto response = handler.executeCommand (makeSetTrackVolumeCommand (volumeForIteration (i)));
+                expect (response["status"].toString() == "ok", "Expected typed set_track_volume to succeed");
+            }));
+
+    report ("UndoableCommandHandler coalesced JSON round-trip",
+            measureMicrosPerIteration (iterations, [&] (int i)
+            {
+                auto response = juce::JSON::parse (undoableHandler.handleCommandCoalesced (
+                    juce::JSON::toString (makeSetTrackVolumeCommand (volumeForIteration (i)))));
+                expect (response["status"].toString() == "ok", "Expected coalesced JSON set_track_volume to succeed");
+            }));
+
+    session.endCoalescedTransaction();
+
+    report ("UndoableCommandHandler coalesced typed",
+            measureMicrosPerIteration (iterations, [&] (int i)
+            {
+                auto response = undoableHandler.executeCommandCoalesced (makeSetTrackVolumeCommand (volumeForIteration (i)));
+                expect (response["status"].toString() == "ok", "Expected coalesced typed set_track_volume to succeed");
+            }));
+}
+
+void benchmarkSetParameterOnLargeSession (te::Engine& engine)
+{
+    constexpr int trackCount = 300;
+    constexpr int iterations = 20000;
+
+    EditSession session (engine);
+    auto& edit = session.getEdit();
+    edit.ensureNumberOfAudioTracks (trackCount);
+
+    auto* lastTrack = te::getAudioTracks (edit).getLast();
+    expect (lastTrack != nullptr, "Expected last track for set_parameter benchmark");
+    auto plugin = edit.getPluginCache().createNewPlugin (te::ReverbPlugin::xmlTypeName, {});
+    expect (plugin != nullptr, "Expected built-in reverb for set_parameter benchmark");
+    lastTrack->pluginList.insertPlugin (plugin, 0, nullptr);
+    const auto paramId = plugin->getAutomatableParameters().getFirst()->paramID;
+
+    CommandHandler handler (edit);
+
+    std::cout << "set_parameter on track " << (trackCount - 1) << " of " << trackCount
+              << " (" << iterations << " iterations)" << std::endl;
+
+    report ("CommandHandler typed set_parameter",
+            measureMicrosPerIteration (iterations, [&] (int i)
+            {
+                auto* obj = new juce::DynamicObject();
+                obj->setProperty ("action", "set_parameter");
+                obj->setProperty ("track_id", trackCount - 1);
+                obj->setProperty ("plugin_id", te::ReverbPlugin::xmlTypeName);
+                obj->setProperty ("param_id", paramId);
+                obj->setProperty ("value", (double) (i % 100) / 100.0);
+
+                auto response = handler.executeCommand (juce::var (obj));
+                expect (response["status"].toString() == "ok", "Expected set_parameter to succeed");
+            }));
+}
+
+void benchmarkParameterStream (te::Engine& engine)
+{
+    // One second of a 1 kHz fader stream, drained at the stream's 10 ms tick.
+    constexpr int valuesPerSecond = 1000;
+    constexpr int valuesPerDrain = valuesPerSecond / (1000 / ParameterStream::drainIntervalMs);
+    constexpr int iterations = 20;
+
+    EditSession session (engine);
+    session.getEdit().ensureNumberOfAudioTracks (1);
+    CommandHandler handler (session.getEdit());
+    UndoableCommandHandler undoableHandler (handler, session);
+    ParameterStream stream (session);
+    undoableHandler.setParameterStream (&stream);
+
+    auto* open = new juce::DynamicObject();
+    open->setProperty ("action", "open_parameter_stream");
+    open->setProperty ("track_id", 0);
+    open->setProperty ("param_id", "volume");
+    const auto handle = (int) undoableHandler.executeCommand (juce::var (open))["handle"];
+    expect (handle > 0, "Expected open_parameter_stream to succeed");
+
+    std::cout << "1 kHz volume stream, 1 s per iteration (" << iterations << " iterations)" << std::endl;
+
+    report ("set_track_volume JSON commands (coalesced)",
+            measureMicrosPerIteration (iterations, [&] (int)
+            {
+                for (int i = 0; i < valuesPerSecond; ++i)
+                {
+                    auto response = juce::JSON::parse (undoableHandler.handleCommandCoalesced (
+                        juce::JSON::toString (makeSetTrackVolumeCommand (volumeForIteration (i)))));
+                    expect (response["status"].toString() == "ok", "Expected set_track_volume to succeed");
+                }
+            }));
+
+    session.endCoalescedTransaction();
+
+    report ("ParameterStream frames + 10 ms drains",
+            measureMicrosPerIteration (iterations, [&] (int)
+            {
+                std::vector<ParameterStream::Record> records ((size_t) valuesPerDrain);
+
+                for (int i = 0; i < valuesPerSecond; i += valuesPerDrain)
+                {
+                    for (int j = 0; j < valuesPerDrain; ++j)
+                        records[(size_t) j] = { handle, ParameterStream::UpdateKind::value,
+                                                (float) ((i + j) % 100) / 100.0f };
+
+                    auto frame = ParameterStream::encodeFrame (records);
+                    expect (stream.pushFrame (frame.getData(), frame.getSize()), "Expected frame to be accepted");
+                    stream.applyPendingUpdates();
+                }
+            }));
+
+    expect (stream.getNumDroppedUpdates() == 0, "Expected no dropped stream updates");
+}
+
+class TcpBenchmarkClient final : public juce::InterprocessConnection
+{
+public:
+    TcpBenchmarkClient() : juce::InterprocessConnection (false, 0x0000AD10) {}
+
+    void connectionMade() override {}
+    void connectionLost() override {}
+
+    void messageReceived (const juce::MemoryBlock& message) override
+    {
+        {
+            const juce::ScopedLock lock (messageLock);
+            lastMessage = message;
+        }
+        received.signal();
+    }
+
+    juce::String sendAndWait (const juce::String& text)
+    {
+        received.reset();
+        expect (sendMessage (juce::MemoryBlock (text.toRawUTF8(), text.getNumBytesAsUTF8())),
+                "Expected TCP benchmark message to send");
+        expect (received.wait (5000), "Expected TCP benchmark reply");
+
+        const juce::ScopedLock lock (messageLock);
+        return lastMessage.toString();
+    }
+
+private:
+    juce::WaitableEvent received;
+    juce::CriticalSection messageLock;
+    juce::MemoryBlock lastMessage;
+};
+
+int findAvailableTcpPort()
+{
+    for (int attempt = 0; attempt < 64; ++attempt)
+    {
+        const int port = 40000 + juce::Random::getSystemRandom().nextInt (20000);
+        juce::StreamingSocket socket;
+        if (socket.createListener (port))
+            return port;
+    }
+
+    return 0;
+}
+
+void benchmarkLocalTransportLatency (te::Engine& engine)
+{
+#if JUCE_WINDOWS
+    juce::ignoreUnused (engine);
+#else
+    constexpr int pingIterations = 2000;
+    constexpr int stateIterations = 50;
+
+    // A large session so get_edit_state is a realistic bulk payload.
+    EditSession session (engine);
+    session.getEdit().ensureNumberOfAudioTracks (300);
+    CommandHandler handler (session.getEdit());
+    UndoableCommandHandler undoableHandler (handler, session);
+    const auto callback = [&] (const juce::String& json) { return undoableHandler.handleCommand (json); };
+
+    const int port = findAvailableTcpPort();
+    CommandServer tcpServer (callback, port);
+    expect (port > 0 && tcpServer.start(), "Expected TCP command server to start");
+
+    const auto socketFile = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                .getChildFile ("waive_bench_" + juce::String (port) + ".sock");
+    LocalCommandServer localServer (callback, socketFile, tcpServer.getAuthToken());
+    expect (localServer.start(), "Expected local command server to start");
+
+    const juce::String ping ("{\"action\":\"ping\"}");
+    const juce::String getState ("{\"action\":\"get_edit_state\"}");
+
+    // Commands are dispatched on the message thread, so the clients run on a
+    // worker while this thread pumps the dispatch loop.
+    std::exception_ptr failure;
+    std::thread clients ([&]
+    {
+        try
+        {
+            TcpBenchmarkClient tcp;
+            expect (tcp.connectToSocket ("127.0.0.1", port, 1000), "Expected TCP client to connect");
+            expect (tcp.sendAndWait (tcpServer.getAuthToken()) == "AUTH_OK", "Expected TCP client to authenticate");
+
+            LocalCommandClient local;
+            expect (local.connect (socketFile) && local.authenticate (tcpServer.getAuthToken()),
+                    "Expected local client to authenticate");
+
+            LocalCommandClient localShm;
+            expect (localShm.connect (socketFile) && localShm.authenticate (tcpServer.getAuthToken())
+                        && localShm.openSharedMemoryRing (64 * 1024 * 1024),
+                    "Expected local client to negotiate a shared-memory ring");
+
+            const auto stateBytes = local.sendCommand (getState).getNumBytesAsUTF8();
+            std::cout << "transport round-trip latency (ping x" << pingIterations
+                      << ", get_edit_state " << (stateBytes / 1024) << " KiB x" << stateIterations << ")" << std::endl;
+
+            report ("TCP ping",
+                    measureMicrosPerIteration (pingIterations, [&] (int) { tcp.sendAndWait (ping); }));
+            report ("Unix socket ping",
+                    measureMicrosPerIteration (pingIterations, [&] (int) { local.sendCommand (ping); }));
+
+            report ("TCP get_edit_state",
+                    measureMicrosPerIteration (stateIterations, [&] (int) { tcp.sendAndWait (getState); }));
+            report ("Unix socket get_edit_state",
+                    measureMicrosPerIteration (stateIterations, [&] (int) { local.sendCommand (getState); }));
+            report ("Unix socket + shared-memory get_edit_state",
+                    measureMicrosPerIteration (stateIterations, [&] (int) { localShm.sendCommand (getState); }));
+
+            expect (localShm.getNumSharedMemoryPayloads() > 0, "Expected large responses to use the shared-memory ring");
+            tcp.disconnect();
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+
+        juce::MessageManager::getInstance()->stopDispatchLoop();
+    });
+
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    clients.join();
+
+    if (failure != nullptr)
+        std::rethrow_exception (failure);
+#endif
+}
+
+//==============================================================================
+juce::File writeNoiseWav (const juce::File& file, double seconds)
+{
+    constexpr double sampleRate = 44100.0;
+    const auto numSamples = (int) (seconds * sampleRate);
+
+    juce::AudioBuffer<float> buffer (2, numSamples);
+    juce::Random random (1234);
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample (ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+    file.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream (new juce::FileOutputStream (file));
+    auto options = juce::AudioFormatWriterOptions()
+                       .withSampleRate (sampleRate)
+                       .withNumChannels (2)
+                       .withBitsPerSample (24);
+
+    auto writer = juce::WavAudioFormat().createWriterFor (stream, options);
+    expect (writer != nullptr, "Expected WAV writer for benchmark fixture");
+    writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+    return file;
+}
+
+void benchmarkBatchRender (te::Engine& engine)
+{
+    constexpr int numTracks = 8;
+    constexpr double clipSeconds = 10.0;
+    constexpr int iterations = 3;
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("waive_bench_batch_render");
+    dir.deleteRecursively();
+    dir.createDirectory();
+
+    auto source = writeNoiseWav (dir.getChildFile ("source.wav"), clipSeconds);
+    auto edit = te::createEmptyEdit (engine, dir.getChildFile ("batch.tracktionedit"));
+    edit->ensureNumberOfAudioTracks (numTracks);
+
+    for (auto* track : te::getAudioTracks (*edit))
+        track->insertWaveClip ("source", source,
+                               { { te::TimePosition(), te::TimePosition::fromSeconds (clipSeconds) },
+                                 te::TimeDuration() },
+                               false);
+
+    // Stems plus a WAV/FLAC mix of every track.
+    const auto payload = R"({"action":"render_batch","output_dir":")"
+                         + dir.getChildFile ("out").getFullPathName().replace ("\\", "\\\\")
+                         + R"(","jobs":[{"name":"stems","stems":true},{"name":"mix","formats":["wav","flac"]}]})";
+
+    std::cout << numTracks << " tracks x " << clipSeconds << " s: render_batch of "
+              << numTracks + 2 << " files (" << iterations << " iterations)" << std::endl;
+
+    auto runBatch = [&] (int numThreads)
+    {
+        waive::RenderScheduler scheduler (engine, numThreads);
+        CommandHandler handler (*edit);
+        handler.setAllowedMediaDirectories ({ dir });
+        handler.setRenderScheduler (&scheduler);
+
+        return measureMicrosPerIteration (iterations, [&] (int)
+        {
+            auto response = juce::JSON::parse (handler.handleCommand (payload));
+            expect (response["status"].toString() == "ok", "Expected render_batch to queue");
+            expect (scheduler.waitForBatch (response["batch_id"].toString(), 300000), "Expected batch to finish");
+        });
+    };
+
+    report ("render_batch, 1 render thread", runBatch (1));
+    report ("render_batch, " + std::to_string (juce::SystemStats::getNumCpus()) + " render threads",
+            runBatch (juce::SystemStats::getNumCpus()));
+
+    edit.reset();
+    dir.deleteRecursively();
+}
+
+/** Applies a silence-cut style plan of 5000 splits across 10 tracks, once as
+    one performEdit per change with a te::findClipForID() lookup each (how plans
+    used to be applied) and once as a single performBulkEdit. */
+void benchmarkBulkPlanApply (te::Engine& engine)
+{
+    constexpr int numTracks = 10;
+    constexpr int splitsPerClip = 500;
+    constexpr double clipSeconds = 60.0;
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("waive_bench_bulk_apply");
+    dir.deleteRecursively();
+    dir.createDirectory();
+
+    auto source = writeNoiseWav (dir.getChildFile ("source.wav"), clipSeconds);
+
+    EditSession session (engine);
+    expect (session.performEdit ("Add Clips", [&] (te::Edit& edit)
+    {
+        edit.ensureNumberOfAudioTracks (numTracks);
+        for (auto* track : te::getAudioTracks (edit))
+        {
+            expect (track->insertWaveClip ("source", source,
+                                           { { te::TimePosition(), te::TimePosition::fromSeconds (clipSeconds) },
+                                             te::TimeDuration() },
+                                           false) != nullptr,
+                    "Expected benchmark clip insertion");
+        }
+    }), "Expected benchmark clips");
+
+    // Gaps cut from the back of each clip, as the silence cutter does.
+    struct Cut
+    {
+        te::EditItemID clipID;
+        double seconds = 0.0;
+    };
+
+    std::vector<Cut> cuts;
+    for (auto* track : te::getAudioTracks (session.getEdit()))
+        for (int i = splitsPerClip; i >= 1; --i)
+            cuts.push_back ({ track->getClips().getFirst()->itemID, clipSeconds * (double) i / (splitsPerClip + 1) });
+
+    auto splitAt = [] (te::Clip* clip, double seconds)
+    {
+        if (auto* clipTrack = dynamic_cast<te::ClipTrack*> (clip != nullptr ? clip->getTrack() : nullptr))
+            clipTrack->splitClip (*clip, te::TimePosition::fromSeconds (seconds));
+    };
+
+    auto timeApply = [&] (const std::function<void()>& apply)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        apply();
+        const auto elapsed = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+        int numClips = 0;
+        for (auto* track : te::getAudioTracks (session.getEdit()))
+            numClips += track->getClips().size();
+
+        expect (numClips == numTracks * (splitsPerClip + 1), "Expected every cut to be applied");
+        session.undo();
+        return elapsed * 1.0e6;
+    };
+
+    std::cout << cuts.size() << "-change plan over " << numTracks << " tracks" << std::endl;
+
+    report ("apply, performEdit per change", timeApply ([&]
+    {
+        for (const auto& cut : cuts)
+            session.performEdit ("Cut", true, [&] (te::Edit& edit) { splitAt (te::findClipForID (edit, cut.clipID), cut.seconds); });
+
+        session.endCoalescedTransaction();
+    }));
+
+    report ("apply, one performBulkEdit", timeApply ([&]
+    {
+        session.performBulkEdit ("Cut", [&] (te::Edit& edit)
+        {
+            const auto clipsByID = waive::buildClipLookup (edit);
+            for (const auto& cut : cuts)
+                splitAt (clipsByID.at (cut.clipID), cut.seconds);
+        });
+    }));
+
+    dir.deleteRecursively();
+}
+
+void benchmarkStemSeparation()
+{
+    constexpr double songSeconds = 300.0;
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("waive_bench_stems");
+    dir.deleteRecursively();
+    dir.createDirectory();
+
+    auto source = writeNoiseWav (dir.getChildFile ("song.wav"), songSeconds);
+    const std::array<juce::File, 2> stems { dir.getChildFile ("a.wav"), dir.getChildFile ("b.wav") };
+
+    std::cout << "Stem separation of a " << songSeconds / 60.0 << " min stereo file" << std::endl;
+
+    for (auto method : { waive::SeparationMethod::bandSplit, waive::SeparationMethod::harmonicPercussive })
+    {
+        waive::SeparationSettings settings;
+        settings.method = method;
+
+        const auto micros = measureMicrosPerIteration (1, [&] (int)
+        {
+            expect (waive::separateStems (source, {}, stems, settings).wasOk(), "Expected separation to succeed");
+        });
+
+        report (method == waive::SeparationMethod::bandSplit ? "separateStems, band split"
+                                                               : "separateStems, HPSS",
+                micros);
+    }
+
+    dir.deleteRecursively();
+}
+
+void benchmarkSampleLibrarySearch()
+{
+    constexpr int numEntries = 400000;
+
+    static const char* const categories[] = { "Drums", "Bass", "Keys", "Pads", "Vocals", "FX", "Guitars", "Percussion" };
+    static const char* const names[] = { "Kick", "Snare", "Hat", "Clap", "Tom", "Ride", "Stab", "Chord", "Lead", "Vox" };
+    static const char* const keys[] = { "A minor", "C major", "F# minor", "D major", "G minor", "E major" };
+
+    std::vector<waive::SampleLibraryEntry> entries;
+    entries.reserve ((size_t) numEntries);
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        waive::SampleLibraryEntry entry;
+        entry.path = juce::String ("/library/") + categories[i % 8] + "/Pack " + juce::String (i % 500)
+                     + "/" + names[(i / 8) % 10] + "_" + juce::String (i) + ".wav";
+        entry.readable = true;
+        entry.durationSeconds = 0.5 + (double) (i % 40);
+        entry.sampleRate = 44100.0;
+        entry.numChannels = 2;
+        entry.tempoBpm = 80.0 + (double) (i % 90);
+        entry.key = keys[i % 6];
+        entries.push_back (std::move (entry));
+    }
+
+    auto databaseFile = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                            .getChildFile ("waive_bench_library").getChildFile ("sample_index.db");
+    waive::SampleLibraryIndex index (databaseFile);
+
+    std::cout << "Sample library search over " << numEntries << " files" << std::endl;
+
+    report ("setEntries (build search tokens)", measureMicrosPerIteration (1, [&] (int)
+    {
+        index.setEntries (entries);
+    }));
+
+    // The baseline a folder browser offers: look at every path.
+    report ("linear scan of every path for \"snare\"", measureMicrosPerIteration (5, [&] (int)
+    {
+        int matches = 0;
+        for (const auto& entry : entries)
+            if (entry.path.containsIgnoreCase ("snare"))
+                ++matches;
+
+        expect (matches > 0, "Expected the linear scan to match");
+    }));
+
+    for (const auto* query : { "snare", "drums pack 12", "sn pa 40", "chord bpm:118-122", "vox key:am" })
+    {
+        report ("search \"" + std::string (query) + "\"", measureMicrosPerIteration (50, [&] (int)
+        {
+            expect (! index.search (query).empty(), "Expected search results");
+        }));
+    }
+
+    databaseFile.getParentDirectory().deleteRecursively();
+}
+
+void benchmarkSamplePreviewStart()
+{
+    constexpr int blockSize = 256;
+    constexpr double sampleRate = 48000.0;
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("waive_bench_preview");
+    dir.deleteRecursively();
+    dir.createDirectory();
+
+    std::array<juce::File, 4> files;
+    for (size_t i = 0; i < files.size(); ++i)
+        files[i] = writeNoiseWav (dir.getChildFile ("sample_" + juce::String ((int) i) + ".wav"), 30.0);
+
+    juce::AudioDeviceManager deviceManager;
+    waive::SamplePreviewPlayer player (deviceManager);
+    auto& source = player.getAudioSourceForTesting();
+    source.prepareToPlay (blockSize, sampleRate);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+
+    // Pulls blocks as a device would, without waiting, until one carries audio.
+    auto pullUntilAudible = [&]
+    {
+        for (int i = 0; i < 1000000; ++i)
+        {
+            juce::AudioSourceChannelInfo info (buffer);
+            source.getNextAudioBlock (info);
+            if (buffer.getMagnitude (0, 0, blockSize) > 0.0f)
+                return;
+
+            std::this_thread::yield();
+        }
+
+        throw std::runtime_error ("Preview never became audible");
+    };
+
+    std::cout << "Sample preview start (30 s stereo WAVs, " << blockSize << "-sample blocks)" << std::endl;
+
+    report ("preview() of a new file to first audible block", measureMicrosPerIteration (20, [&] (int i)
+    {
+        expect (player.preview (files[(size_t) i % files.size()]).wasOk(), "Expected preview to start");
+        pullUntilAudible();
+    }));
+
+    report ("scrub within a file to first audible block", measureMicrosPerIteration (50, [&] (int i)
+    {
+        player.setPosition ((double) (i * 7 % 29));
+        pullUntilAudible();
+    }));
+
+    player.stop();
+    source.releaseResources();
+    dir.deleteRecursively();
+}
+
+void benchmarkBulkMediaImport (te::Engine& engine)
+{
+    constexpr int numFiles = 200;
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("waive_bench_import");
+    dir.deleteRecursively();
+    dir.createDirectory();
+
+    // Separate copies for each path, so neither finds the other's headers cached.
+    std::array<juce::Array<juce::File>, 2> fileSets;
+    for (size_t set = 0; set < fileSets.size(); ++set)
+        for (int i = 0; i < numFiles; ++i)
+            fileSets[set].add (writeNoiseWav (dir.getChildFile ("import_" + juce::String ((int) set) + "_" + juce::String (i) + ".wav"), 2.0));
+
+    EditSession session (engine);
+    auto countClips = [&]
+    {
+        int numClips = 0;
+        for (auto* track : te::getAudioTracks (session.getEdit()))
+            numClips += track->getClips().size();
+        return numClips;
+    };
+
+    std::cout << "Importing " << numFiles << " files onto one track" << std::endl;
+
+    // What the drop handler did before: open each file on the calling thread, then insert it.
+    // Timed once by hand: a warm-up pass would leave the headers cached.
+    const auto syncStart = juce::Time::getHighResolutionTicks();
+    {
+        double start = 0.0;
+        for (auto& file : fileSets[0])
+        {
+            const auto length = te::AudioFile (engine, file).getLength();
+            session.performEdit ("Insert Audio Clip", [&] (te::Edit& edit)
+            {
+                te::getAudioTracks (edit).getFirst()->insertWaveClip (file.getFileNameWithoutExtension(), file,
+                                                                      { { te::TimePosition::fromSeconds (start),
+                                                                          te::TimePosition::fromSeconds (start + length) },
+                                                                        te::TimeDuration() },
+                                                                      false);
+            });
+            start += length;
+        }
+    }
+    report ("synchronous probe + insert per file",
+            juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - syncStart) * 1.0e6);
+
+    expect (countClips() == numFiles, "Expected the synchronous import to insert every file");
+    while (session.canUndo())
+        session.undo();
+
+    waive::MediaImporter importer (session);
+    const auto callStart = juce::Time::getHighResolutionTicks();
+    importer.importFiles (fileSets[1], 0, 0.0);
+    const auto returned = juce::Time::getHighResolutionTicks();
+    expect (importer.waitForImportsForTesting (60000), "Expected the background import to finish");
+    const auto finished = juce::Time::getHighResolutionTicks();
+
+    report ("MediaImporter::importFiles, time to return", juce::Time::highResolutionTicksToSeconds (returned - callStart) * 1.0e6);
+    report ("MediaImporter, time to last clip", juce::Time::highResolutionTicksToSeconds (finished - callStart) * 1.0e6);
+    expect (countClips() == numFiles, "Expected the background import to insert every file");
+
+    dir.deleteRecursively();
+}
+
+void populateLargeProject (te::Edit& edit, int numTracks, int clipsPerTrack, int notesPerClip)
+{
+    edit.ensureNumberOfAudioTracks (numTracks);
+
+    for (auto* track : te::getAudioTracks (edit))
+    {
+        for (int c = 0; c < clipsPerTrack; ++c)
+        {
+            auto clip = track->insertMIDIClip ("bench_clip",
+                                               te::TimeRange (te::TimePosition::fromSeconds (c * 4.0),
+                                                              te::TimePosition::fromSeconds (c * 4.0 + 4.0)),
+                                               nullptr);
+            for (int n = 0; n < notesPerClip; ++n)
+                clip->getSequence().addNote (36 + n, te::BeatPosition::fromBeats (n * 0.25),
+                                             te::BeatDuration::fromBeats (0.25), 100, 0, nullptr);
+        }
+    }
+}
+
+void benchmarkProjectFileFormats (te::Engine& engine)
+{
+    using Format = waive::ProjectFileFormat::Format;
+
+    constexpr int numTracks = 500;
+    constexpr int clipsPerTrack = 8;
+    constexpr int notesPerClip = 32;
+    constexpr int iterations = 5;
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("waive_bench_project_formats");
+    dir.deleteRecursively();
+    dir.createDirectory();
+
+    auto edit = te::createEmptyEdit (engine, dir.getChildFile ("source.tracktionedit"));
+    populateLargeProject (*edit, numTracks, clipsPerTrack, notesPerClip);
+    edit->flushState();
+
+    std::cout << "Saving and loading a " << numTracks << "-track edit with "
+              << numTracks * clipsPerTrack << " MIDI clips" << std::endl;
+
+    const std::array<std::pair<const char*, Format>, 3> formats {{
+        { "XML", Format::xml },
+        { "binary", Format::binary },
+        { "compressed binary", Format::compressedBinary },
+    }};
+
+    for (const auto& [name, format] : formats)
+    {
+        const auto file = dir.getChildFile ("project").withFileExtension (format == Format::xml ? waive::ProjectFileFormat::xmlFileExtension
+                                                                                                 : waive::ProjectFileFormat::binaryFileExtension);
+        const std::string label (name);
+
+        report (label + " writeState", measureMicrosPerIteration (iterations, [&] (int)
+        {
+            expect (waive::ProjectFileFormat::writeState (edit->state, file, format).wasOk(),
+                    "Expected " + label + " project write to succeed");
+        }));
+
+        report (label + " readState", measureMicrosPerIteration (iterations, [&] (int)
+        {
+            expect (waive::ProjectFileFormat::readState (file).isValid(), "Expected " + label + " project to read back");
+        }));
+
+        report (label + " loadEdit", measureMicrosPerIteration (1, [&] (int)
+        {
+            expect (waive::ProjectFileFormat::loadEdit (engine, file) != nullptr, "Expected " + label + " project to load");
+        }));
+
+        std::cout << "  " << std::left << std::setw (48) << (label + " file size")
+                  << std::right << std::setw (10) << file.getSize() / 1024 << " KiB" << std::endl;
+    }
+
+    edit.reset();
+    dir.deleteRecursively();
+}
+
+void benchmarkBackgroundSave (te::Engine& engine)
+{
+    constexpr int numTracks = 500;
+    constexpr int iterations = 5;
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("waive_bench_background_save");
+    dir.deleteRecursively();
+    dir.createDirectory();
+    const auto projectFile = dir.getChildFile ("project.tracktionedit");
+
+    // saveAs() adds to the recent files; keep them out of the app's settings.
+    auto settingsOptions = ProjectManager::getDefaultSettingsOptions();
+    settingsOptions.applicationName = "WaiveBenchmarks";
+    settingsOptions.folderName = dir.getChildFile ("settings").getFullPathName();
+
+    {
+        EditSession session (engine);
+        ProjectManager projectManager (session, settingsOptions);
+        session.performEdit ("Populate", [&] (te::Edit& edit) { populateLargeProject (edit, numTracks, 8, 32); });
+        expect (projectManager.saveAs (projectFile), "Expected the benchmark project to save");
+
+        std::cout << "Saving a " << numTracks << "-track XML project from the message thread" << std::endl;
+
+        report ("save() (message thread blocked)", measureMicrosPerIteration (iterations, [&] (int)
+        {
+            session.markAsChanged();
+            expect (projectManager.save(), "Expected the blocking save to succeed");
+        }));
+
+        // Timed by hand: the call returns long before the file is on disk.
+        double blockedSeconds = 0.0;
+        double totalSeconds = 0.0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            session.markAsChanged();
+            const auto start = juce::Time::getHighResolutionTicks();
+            expect (projectManager.saveInBackground(), "Expected the background save to start");
+            const auto returned = juce::Time::getHighResolutionTicks();
+            expect (projectManager.waitForPendingSaves (60000), "Expected the background save to finish");
+            const auto finished = juce::Time::getHighResolutionTicks();
+
+            blockedSeconds += juce::Time::highResolutionTicksToSeconds (returned - start);
+            totalSeconds += juce::Time::highResolutionTicksToSeconds (finished - start);
+        }
+
+        report ("saveInBackground() (message thread blocked)", blockedSeconds * 1.0e6 / iterations);
+        report ("saveInBackground() to file synced on disk", totalSeconds * 1.0e6 / iterations);
+    }
+
+    dir.deleteRecursively();
+}
+
+} // namespace
+
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    try
+    {
+        te::Engine engine ("WaiveBenchmarks");
+
+        benchmarkSetTrackVolumeDispatch (engine);
+        benchmarkSetParameterOnLargeSession (engine);
+        benchmarkParameterStream (engine);
+        benchmarkLocalTransportLatency (engine);
+        benchmarkBatchRender (engine);
+        benchmarkBulkPlanApply (engine);
+        benchmarkStemSeparation();
+        benchmarkSampleLibrarySearch();
+        benchmarkSamplePreviewStart();
+        benchmarkBulkMediaImport (engine);
+        benchmarkProjectFileFormats (engine);
+        benchmarkBackgroundSave (engine);
+
+        std::cout << "WaiveBenchmarks: DONE" << std::endl;
+        return 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "WaiveBenchmarks: FAIL: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -1,10 +1,14 @@
 #include "CommandHandler.h"
+#include "LoudnessMeter.h"
 #include "PathSanitizer.h"
 #include "PluginPresetManager.h"
 #include "ProjectPackager.h"
+#include "RenderScheduler.h"
+#include "TrackFreezeManager.h"
 
 #include <cmath>
 #include <filesystem>
+#include <vector>
 
 namespace
 {
@@ -49,26 +53,6 @@ juce::Array<te::Plugin*> getAddressablePlugins (te::PluginList& pluginList)
     return plugins;
 }
 
-bool pluginMatchesIdentifier (te::Plugin& plugin, const juce::String& requestedIdentifier)
-{
-    if (requestedIdentifier.isEmpty())
-        return false;
-
-    if (plugin.getName() == requestedIdentifier)
-        return true;
-
-    const auto stableIdentifier = waive::PluginPresetManager::getPluginIdentifier (plugin);
-    if (stableIdentifier == requestedIdentifier)
-        return true;
-
-    const auto fileIdentifier = plugin.state.getProperty ("fileOrIdentifier", {}).toString().trim();
-    if (fileIdentifier == requestedIdentifier)
-        return true;
-
-    const auto typeIdentifier = plugin.state.getProperty (te::IDs::type, {}).toString().trim();
-    return typeIdentifier == requestedIdentifier;
-}
-
 bool wouldCreateFolderCycle (te::Track& trackToMove, te::FolderTrack& destinationFolder)
 {
     if (&trackToMove == &destinationFolder)
@@ -81,31 +65,6 @@ bool wouldCreateFolderCycle (te::Track& trackToMove, te::FolderTrack& destinatio
     return false;
 }
 
-juce::Array<te::Track*> getPublicTracks (te::Edit& edit)
-{
-    juce::Array<te::Track*> tracks;
-
-    for (auto* track : edit.getTrackList())
-        if (dynamic_cast<te::AudioTrack*> (track) != nullptr
-            || dynamic_cast<te::FolderTrack*> (track) != nullptr)
-            tracks.add (track);
-
-    return tracks;
-}
-
-int getPublicTrackIndex (te::Edit& edit, te::Track* target)
-{
-    if (target == nullptr)
-        return -1;
-
-    const auto publicTracks = getPublicTracks (edit);
-    for (int i = 0; i < publicTracks.size(); ++i)
-        if (publicTracks.getUnchecked (i) == target)
-            return i;
-
-    return -1;
-}
-
 bool isWithinAllowedDirectories (const juce::String& originalPath,
                                  const juce::File& candidate,
                                  const juce::Array<juce::File>& allowedDirectories)
@@ -327,20 +286,37 @@ juce::String sanitiseOutputFileComponent (const juce::String& name, const juce::
 
 CommandHandler::CommandHandler (te::Edit& e)
     : edit (e),
-      presetManager (std::make_unique<waive::PluginPresetManager>())
+      presetManager (std::make_unique<waive::PluginPresetManager>()),
+      freezeManager (std::make_unique<TrackFreezeManager> (e))
 {
     // Initialize with safe defaults: user home + current working directory
     allowedMediaDirectories.add (juce::File::getSpecialLocation (juce::File::userHomeDirectory));
     allowedMediaDirectories.add (juce::File::getCurrentWorkingDirectory());
+
+    edit.state.addListener (this);
 }
 
-CommandHandler::~CommandHandler() = default;
+CommandHandler::~CommandHandler()
+{
+    edit.state.removeListener (this);
+}
 
 void CommandHandler::setProjectFile (const juce::File& projectFile)
 {
     currentProjectFile = projectFile;
 }
 
+void CommandHandler::setRenderScheduler (waive::RenderScheduler* scheduler, const juce::String& editId)
+{
+    renderScheduler = scheduler;
+    renderEditId = editId;
+}
+
+void CommandHandler::refreshPendingFreezes()
+{
+    freezeManager->refreshPendingFreezes();
+}
+
 void CommandHandler::setAllowedMediaDirectories (const juce::Array<juce::File>& directories)
 {
     allowedMediaDirectories = directories;
@@ -351,6 +327,16 @@ const juce::Array<juce::File>& CommandHandler::getAllowedMediaDirectories() cons
     return allowedMediaDirectories;
 }
 
+void CommandHandler::setCompressBinaryProjects (bool shouldCompress)
+{
+    compressBinaryProjects = shouldCompress;
+}
+
+bool CommandHandler::shouldCompressBinaryProjects() const
+{
+    return compressBinaryProjects;
+}
+
 juce::File CommandHandler::resolveProjectFile() const
 {
     if (currentProjectFile != juce::File())
@@ -482,6 +468,17 @@ bool CommandHandler::requireStringProperty (const juce::var& params,
     return true;
 }
 
+bool CommandHandler::requireOptionalBoolProperty (const juce::var& params,
+                                                  const char* propertyName,
+                                                  bool& valueOut,
+                                                  juce::var& errorResult)
+{
+    if (! params.hasProperty (propertyName))
+        return true;
+
+    return requireBoolProperty (params, propertyName, valueOut, errorResult);
+}
+
 bool CommandHandler::requireOptionalStringProperty (const juce::var& params,
                                                     const char* propertyName,
                                                     juce::String& valueOut,
@@ -543,6 +540,80 @@ bool CommandHandler::requireAnyDoubleProperty (const juce::var& params,
     return false;
 }
 
+//==============================================================================
+CommandHandler::CommandFunction CommandHandler::findCommand (const juce::String& action)
+{
+    static const std::unordered_map<juce::String, CommandFunction, StringHash> commandTable
+    {
+        { "ping",                    [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handlePing(); } },
+        { "get_edit_state",          [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleGetEditState(); } },
+        { "get_tracks",              [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleGetTracks(); } },
+        { "add_track",               [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleAddTrack(); } },
+        { "remove_track",            [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleRemoveTrack (params); } },
+        { "set_track_volume",        [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSetTrackVolume (params); } },
+        { "set_track_pan",           [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSetTrackPan (params); } },
+        { "insert_audio_clip",       [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleInsertAudioClip (params); } },
+        { "insert_midi_clip",        [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleInsertMidiClip (params); } },
+        { "load_plugin",             [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleLoadPlugin (params); } },
+        { "set_parameter",           [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSetParameter (params); } },
+        { "transport_play",          [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleTransportPlay(); } },
+        { "transport_stop",          [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleTransportStop(); } },
+        { "transport_seek",          [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleTransportSeek (params); } },
+        { "list_plugins",            [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleListPlugins(); } },
+        { "arm_track",               [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleArmTrack (params); } },
+        { "record_from_mic",         [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleRecordFromMic(); } },
+        { "split_clip",              [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSplitClip (params); } },
+        { "delete_clip",             [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleDeleteClip (params); } },
+        { "move_clip",               [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleMoveClip (params); } },
+        { "duplicate_clip",          [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleDuplicateClip (params); } },
+        { "trim_clip",               [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleTrimClip (params); } },
+        { "set_clip_gain",           [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSetClipGain (params); } },
+        { "rename_clip",             [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleRenameClip (params); } },
+        { "rename_track",            [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleRenameTrack (params); } },
+        { "solo_track",              [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSoloTrack (params); } },
+        { "mute_track",              [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleMuteTrack (params); } },
+        { "duplicate_track",         [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleDuplicateTrack (params); } },
+        { "get_transport_state",     [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleGetTransportState(); } },
+        { "set_tempo",               [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSetTempo (params); } },
+        { "set_loop_region",         [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSetLoopRegion (params); } },
+        { "export_mixdown",          [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleExportMixdown (params); } },
+        { "export_stems",            [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleExportStems (params); } },
+        { "get_render_status",       [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleGetRenderStatus (params); } },
+        { "render_batch",            [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleRenderBatch (params); } },
+        { "bounce_track",            [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleBounceTrack (params); } },
+        { "freeze_track",            [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleFreezeTrack (params); } },
+        { "unfreeze_track",          [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleUnfreezeTrack (params); } },
+        { "refresh_freezes",         [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleRefreshFreezes(); } },
+        { "remove_plugin",           [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleRemovePlugin (params); } },
+        { "bypass_plugin",           [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleBypassPlugin (params); } },
+        { "get_plugin_parameters",   [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleGetPluginParameters (params); } },
+        { "get_automation_params",   [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleGetAutomationParams (params); } },
+        { "get_automation_points",   [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleGetAutomationPoints (params); } },
+        { "add_automation_point",    [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleAddAutomationPoint (params); } },
+        { "remove_automation_point", [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleRemoveAutomationPoint (params); } },
+        { "clear_automation",        [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleClearAutomation (params); } },
+        { "set_clip_fade",           [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSetClipFade (params); } },
+        { "set_time_signature",      [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSetTimeSignature (params); } },
+        { "add_marker",              [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleAddMarker (params); } },
+        { "remove_marker",           [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleRemoveMarker (params); } },
+        { "list_markers",            [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleListMarkers(); } },
+        { "reorder_track",           [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleReorderTrack (params); } },
+        { "save_plugin_preset",      [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleSavePluginPreset (params); } },
+        { "load_plugin_preset",      [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleLoadPluginPreset (params); } },
+        { "add_folder_track",        [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleAddFolderTrack (params); } },
+        { "move_track_to_folder",    [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleMoveTrackToFolder (params); } },
+        { "remove_from_folder",      [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handleRemoveFromFolder (params); } },
+        { "collect_and_save",        [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleCollectAndSave(); } },
+        { "remove_unused_media",     [] (CommandHandler& h, const juce::var&)        -> juce::var { return h.handleRemoveUnusedMedia(); } },
+        { "package_as_zip",          [] (CommandHandler& h, const juce::var& params) -> juce::var { return h.handlePackageAsZip (params); } },
+    };
+
+    if (auto it = commandTable.find (action); it != commandTable.end())
+        return it->second;
+
+    return nullptr;
+}
+
 //==============================================================================
 juce::String CommandHandler::handleCommand (const juce::String& jsonString)
 {
@@ -551,72 +622,23 @@ juce::String CommandHandler::handleCommand (const juce::String& jsonString)
     if (! parsed.isObject())
         return juce::JSON::toString (makeError ("Invalid JSON"));
 
+    return juce::JSON::toString (executeCommand (parsed));
+}
+
+juce::var CommandHandler::executeCommand (const juce::var& parsed)
+{
+    if (! parsed.isObject())
+        return makeError ("Invalid command: expected an object");
+
     juce::String action;
     juce::var errorResult;
     if (! requireStringProperty (parsed, "action", action, errorResult))
-        return juce::JSON::toString (errorResult);
-
-    juce::var result;
-
-    if      (action == "ping")              result = handlePing();
-    else if (action == "get_edit_state")     result = handleGetEditState();
-    else if (action == "get_tracks")        result = handleGetTracks();
-    else if (action == "add_track")         result = handleAddTrack();
-    else if (action == "remove_track")      result = handleRemoveTrack (parsed);
-    else if (action == "set_track_volume")  result = handleSetTrackVolume (parsed);
-    else if (action == "set_track_pan")     result = handleSetTrackPan (parsed);
-    else if (action == "insert_audio_clip") result = handleInsertAudioClip (parsed);
-    else if (action == "insert_midi_clip")  result = handleInsertMidiClip (parsed);
-    else if (action == "load_plugin")       result = handleLoadPlugin (parsed);
-    else if (action == "set_parameter")     result = handleSetParameter (parsed);
-    else if (action == "transport_play")    result = handleTransportPlay();
-    else if (action == "transport_stop")    result = handleTransportStop();
-    else if (action == "transport_seek")    result = handleTransportSeek (parsed);
-    else if (action == "list_plugins")     result = handleListPlugins();
-    else if (action == "arm_track")        result = handleArmTrack (parsed);
-    else if (action == "record_from_mic")  result = handleRecordFromMic();
-    else if (action == "split_clip")       result = handleSplitClip (parsed);
-    else if (action == "delete_clip")      result = handleDeleteClip (parsed);
-    else if (action == "move_clip")        result = handleMoveClip (parsed);
-    else if (action == "duplicate_clip")   result = handleDuplicateClip (parsed);
-    else if (action == "trim_clip")        result = handleTrimClip (parsed);
-    else if (action == "set_clip_gain")    result = handleSetClipGain (parsed);
-    else if (action == "rename_clip")      result = handleRenameClip (parsed);
-    else if (action == "rename_track")        result = handleRenameTrack (parsed);
-    else if (action == "solo_track")          result = handleSoloTrack (parsed);
-    else if (action == "mute_track")          result = handleMuteTrack (parsed);
-    else if (action == "duplicate_track")     result = handleDuplicateTrack (parsed);
-    else if (action == "get_transport_state") result = handleGetTransportState();
-    else if (action == "set_tempo")           result = handleSetTempo (parsed);
-    else if (action == "set_loop_region")     result = handleSetLoopRegion (parsed);
-    else if (action == "export_mixdown")      result = handleExportMixdown (parsed);
-    else if (action == "export_stems")        result = handleExportStems (parsed);
-    else if (action == "bounce_track")        result = handleBounceTrack (parsed);
-    else if (action == "remove_plugin")       result = handleRemovePlugin (parsed);
-    else if (action == "bypass_plugin")       result = handleBypassPlugin (parsed);
-    else if (action == "get_plugin_parameters") result = handleGetPluginParameters (parsed);
-    else if (action == "get_automation_params")    result = handleGetAutomationParams (parsed);
-    else if (action == "get_automation_points")    result = handleGetAutomationPoints (parsed);
-    else if (action == "add_automation_point")     result = handleAddAutomationPoint (parsed);
-    else if (action == "remove_automation_point")  result = handleRemoveAutomationPoint (parsed);
-    else if (action == "clear_automation")         result = handleClearAutomation (parsed);
-    else if (action == "set_clip_fade")            result = handleSetClipFade (parsed);
-    else if (action == "set_time_signature")       result = handleSetTimeSignature (parsed);
-    else if (action == "add_marker")               result = handleAddMarker (parsed);
-    else if (action == "remove_marker")            result = handleRemoveMarker (parsed);
-    else if (action == "list_markers")             result = handleListMarkers();
-    else if (action == "reorder_track")            result = handleReorderTrack (parsed);
-    else if (action == "save_plugin_preset")       result = handleSavePluginPreset (parsed);
-    else if (action == "load_plugin_preset")       result = handleLoadPluginPreset (parsed);
-    else if (action == "add_folder_track")         result = handleAddFolderTrack (parsed);
-    else if (action == "move_track_to_folder")     result = handleMoveTrackToFolder (parsed);
-    else if (action == "remove_from_folder")       result = handleRemoveFromFolder (parsed);
-    else if (action == "collect_and_save")         result = handleCollectAndSave();
-    else if (action == "remove_unused_media")      result = handleRemoveUnusedMedia();
-    else if (action == "package_as_zip")           result = handlePackageAsZip (parsed);
-    else                                    result = makeError ("Unknown action: " + action);
-
-    return juce::JSON::toString (result);
+        return errorResult;
+
+    if (auto command = findCommand (action))
+        return command (*this, parsed);
+
+    return makeError ("Unknown action: " + action);
 }
 
 //==============================================================================
@@ -647,11 +669,8 @@ juce::var CommandHandler::handleGetTracks()
     auto result = makeOk();
     juce::Array<juce::var> trackList;
 
-    // Build index mapping for all tracks (folders + audio)
-    juce::HashMap<te::Track*, int> trackIndexMap;
-    const auto publicTracks = getPublicTracks (edit);
-    for (int trackId = 0; trackId < publicTracks.size(); ++trackId)
-        trackIndexMap.set (publicTracks.getUnchecked (trackId), trackId);
+    // Public indices for all tracks (folders + audio) come from the cached index.
+    const auto& publicTracks = getPublicTracks();
 
     for (int trackId = 0; trackId < publicTracks.size(); ++trackId)
     {
@@ -666,9 +685,9 @@ juce::var CommandHandler::handleGetTracks()
         trackObj->setProperty ("is_folder", folderTrack != nullptr);
 
         // Parent folder info
-        auto* parentFolder = track->getParentFolderTrack();
-        if (parentFolder && trackIndexMap.contains (parentFolder))
-            trackObj->setProperty ("parent_folder", trackIndexMap[parentFolder]);
+        const auto parentFolderIndex = getPublicTrackIndex (track->getParentFolderTrack());
+        if (parentFolderIndex >= 0)
+            trackObj->setProperty ("parent_folder", parentFolderIndex);
         else
             trackObj->setProperty ("parent_folder", juce::var());
 
@@ -678,8 +697,8 @@ juce::var CommandHandler::handleGetTracks()
             juce::Array<juce::var> childrenArray;
             for (auto* child : folderTrack->getAllSubTracks (false))
             {
-                if (trackIndexMap.contains (child))
-                    childrenArray.add (trackIndexMap[child]);
+                if (const auto childIndex = getPublicTrackIndex (child); childIndex >= 0)
+                    childrenArray.add (childIndex);
             }
             trackObj->setProperty ("children", childrenArray);
             trackObj->setProperty ("solo", folderTrack->isSolo (false));
@@ -690,6 +709,7 @@ juce::var CommandHandler::handleGetTracks()
             trackObj->setProperty ("children", juce::Array<juce::var>());
             trackObj->setProperty ("solo", audioTrack->isSolo (false));
             trackObj->setProperty ("mute", audioTrack->isMuted (false));
+            trackObj->setProperty ("frozen", TrackFreezeManager::isFrozen (*audioTrack));
 
             // Clip info
             juce::Array<juce::var> clipList;
@@ -734,7 +754,7 @@ juce::var CommandHandler::handleAddTrack()
 
     auto result = makeOk();
     if (auto* obj = result.getDynamicObject())
-        obj->setProperty ("track_index", getPublicTrackIndex (edit, newTrack));
+        obj->setProperty ("track_index", getPublicTrackIndex (newTrack));
     return result;
 }
 
@@ -1004,28 +1024,9 @@ juce::var CommandHandler::handleSetParameter (const juce::var& params)
 
     auto value = static_cast<float> (valueDouble);
 
-    auto* track = getTrackById (trackId);
-    if (track == nullptr)
-        return makeError ("Track not found: " + juce::String (trackId));
-
-    // Find the plugin on the track.
-    te::Plugin* foundPlugin = nullptr;
-    for (auto* p : getAddressablePlugins (track->pluginList))
-    {
-        if (p != nullptr && pluginMatchesIdentifier (*p, pluginId))
-        {
-            foundPlugin = p;
-            break;
-        }
-    }
-
-    if (foundPlugin == nullptr)
-        return makeError ("Plugin not found on track: " + pluginId);
-
-    // Find the parameter on the plugin
-    auto param = foundPlugin->getAutomatableParameterByID (paramId);
+    auto param = resolveParameter (params, errorResult);
     if (param == nullptr)
-        return makeError ("Parameter not found: " + paramId);
+        return errorResult;
 
     param->setParameter (value, juce::sendNotification);
 
@@ -1040,6 +1041,52 @@ juce::var CommandHandler::handleSetParameter (const juce::var& params)
     return result;
 }
 
+te::AutomatableParameter::Ptr CommandHandler::resolveParameter (const juce::var& params, juce::var& errorResult)
+{
+    int trackId = 0;
+    juce::String pluginId;
+    juce::String paramId;
+    if (! requireIntProperty (params, "track_id", trackId, errorResult)
+        || ! requireOptionalStringProperty (params, "plugin_id", pluginId, errorResult)
+        || ! requireStringProperty (params, "param_id", paramId, errorResult))
+        return {};
+
+    auto* track = getTrackById (trackId);
+    if (track == nullptr)
+    {
+        errorResult = makeError ("Track not found: " + juce::String (trackId));
+        return {};
+    }
+
+    te::Plugin* plugin = nullptr;
+    if (pluginId.isEmpty())
+    {
+        if (auto* audioTrack = dynamic_cast<te::AudioTrack*> (track))
+            plugin = audioTrack->getVolumePlugin();
+
+        if (plugin == nullptr)
+        {
+            errorResult = makeError ("Track has no volume/pan plugin: " + juce::String (trackId));
+            return {};
+        }
+    }
+    else
+    {
+        plugin = findPluginByIdentifier (*track, pluginId);
+        if (plugin == nullptr)
+        {
+            errorResult = makeError ("Plugin not found on track: " + pluginId);
+            return {};
+        }
+    }
+
+    auto param = plugin->getAutomatableParameterByID (paramId);
+    if (param == nullptr)
+        errorResult = makeError ("Parameter not found: " + paramId);
+
+    return param;
+}
+
 juce::var CommandHandler::handleTransportPlay()
 {
     edit.getTransport().play (false);
@@ -1222,7 +1269,7 @@ juce::var CommandHandler::handleRecordFromMic()
     auto result = makeOk();
     if (auto* obj = result.getDynamicObject())
     {
-        obj->setProperty ("track_index", getPublicTrackIndex (edit, targetTrack));
+        obj->setProperty ("track_index", getPublicTrackIndex (targetTrack));
         obj->setProperty ("input_device", waveIn->getName());
     }
     return result;
@@ -1658,7 +1705,7 @@ juce::var CommandHandler::handleDuplicateTrack (const juce::var& params)
     if (auto* obj = result.getDynamicObject())
     {
         obj->setProperty ("source_track_id", trackId);
-        obj->setProperty ("new_track_index", getPublicTrackIndex (edit, newTrack));
+        obj->setProperty ("new_track_index", getPublicTrackIndex (newTrack));
         obj->setProperty ("new_track_name", newTrack->getName());
     }
     return result;
@@ -1798,9 +1845,42 @@ juce::var CommandHandler::handleExportMixdown (const juce::var& params)
     if (isInvalidRenderRange (startSec, endSec))
         return makeError ("End time must be greater than start time");
 
+    bool renderAsync = false;
+    if (! requireOptionalBoolProperty (params, "async", renderAsync, errorResult))
+        return errorResult;
+
+    if (renderAsync && renderScheduler == nullptr)
+        return makeError ("Asynchronous rendering is not available");
+
     // Ensure parent directory exists only after validation succeeds.
     outputFile.getParentDirectory().createDirectory();
 
+    const te::TimeRange renderRange (te::TimePosition::fromSeconds (startSec), te::TimePosition::fromSeconds (endSec));
+
+    if (renderAsync)
+    {
+        waive::RenderScheduler::Request request;
+        request.editId = renderEditId;
+        edit.flushState(); // plugins only write their state back on a flush
+        request.editState = edit.state.createCopy();
+        request.editFile = te::EditFileOperations (edit).getEditFile();
+        request.destFile = outputFile;
+        request.range = renderRange;
+        request.measureLoudness = true;
+
+        const auto renderId = renderScheduler->enqueue (std::move (request));
+
+        auto result = makeOk();
+        if (auto* obj = result.getDynamicObject())
+        {
+            obj->setProperty ("render_id", renderId);
+            obj->setProperty ("render_status", "queued");
+            obj->setProperty ("file_path", outputFile.getFullPathName());
+            obj->setProperty ("duration", endSec - startSec);
+        }
+        return result;
+    }
+
     // Build track mask for all audio tracks
     juce::BigInteger tracksMask;
     auto audioTracks = te::getAudioTracks (edit);
@@ -1812,7 +1892,7 @@ juce::var CommandHandler::handleExportMixdown (const juce::var& params)
         "Export Mixdown",
         outputFile,
         edit,
-        te::TimeRange (te::TimePosition::fromSeconds (startSec), te::TimePosition::fromSeconds (endSec)),
+        renderRange,
         tracksMask,
         true,     // usePlugins
         true,     // useACID
@@ -1827,6 +1907,9 @@ juce::var CommandHandler::handleExportMixdown (const juce::var& params)
     {
         obj->setProperty ("file_path", outputFile.getFullPathName());
         obj->setProperty ("duration", endSec - startSec);
+
+        if (auto loudness = waive::LoudnessMeter::measureFile (outputFile))
+            obj->setProperty ("loudness", loudness->toVar());
     }
     return result;
 }
@@ -1852,18 +1935,47 @@ juce::var CommandHandler::handleExportStems (const juce::var& params)
     if (isInvalidRenderRange (startSec, endSec))
         return makeError ("End time must be greater than start time");
 
+    bool renderAsync = false;
+    if (! requireOptionalBoolProperty (params, "async", renderAsync, errorResult))
+        return errorResult;
+
+    if (renderAsync && renderScheduler == nullptr)
+        return makeError ("Asynchronous rendering is not available");
+
     outputDir.createDirectory();
 
+    // Frozen tracks render from their cached freeze file. A stale freeze is
+    // left alone and its track renders live from a thawed copy of the edit.
     auto audioTracks = te::getAudioTracks (edit);
+    juce::Array<te::AudioTrack*> staleTracks;
+    for (auto* track : audioTracks)
+        if (freezeManager->isStale (*track))
+            staleTracks.add (track);
+
     juce::Array<juce::var> exportedFiles;
     juce::StringArray errors;
 
+    // One snapshot shared by every stem; each stem renders on its own pool thread.
+    const auto editFile = te::EditFileOperations (edit).getEditFile();
+    const auto stateSnapshot = renderAsync || ! staleTracks.isEmpty() ? freezeManager->createRenderState()
+                                                                      : juce::ValueTree();
+
+    std::unique_ptr<te::Edit> liveEdit;
+    if (! renderAsync && ! staleTracks.isEmpty())
+    {
+        liveEdit = waive::RenderScheduler::createSnapshotEdit (edit.engine, stateSnapshot, editFile);
+        if (liveEdit == nullptr)
+            return makeError ("Failed to create a render snapshot");
+    }
+
     for (int i = 0; i < audioTracks.size(); ++i)
     {
         auto* track = audioTracks[i];
         if (track->getClips().isEmpty())
             continue;
 
+        const bool renderFromFreeze = TrackFreezeManager::isFrozen (*track) && ! staleTracks.contains (track);
+
         // Sanitize track name for filename
         auto safeName = sanitiseOutputFileComponent (track->getName(), "Track");
         auto stemFile = outputDir.getChildFile (juce::String::formatted ("%02d_", i) + safeName + ".wav");
@@ -1872,23 +1984,54 @@ juce::var CommandHandler::handleExportStems (const juce::var& params)
         juce::BigInteger trackMask;
         trackMask.setBit (track->getIndexInEditTrackList());
 
-        auto ok = te::Renderer::renderToFile (
-            "Export Stem: " + track->getName(),
-            stemFile,
-            edit,
-            te::TimeRange (te::TimePosition::fromSeconds (startSec), te::TimePosition::fromSeconds (endSec)),
-            trackMask,
-            true,   // usePlugins
-            true,   // useACID
-            {},     // allowedClips
-            false); // useThread
+        if (renderAsync)
+        {
+            auto* renderInfo = new juce::DynamicObject();
+            renderInfo->setProperty ("track_id", getPublicTrackIndex (track));
+            renderInfo->setProperty ("track_name", track->getName());
+            renderInfo->setProperty ("file_path", stemFile.getFullPathName());
+            renderInfo->setProperty ("frozen", renderFromFreeze);
+            renderInfo->setProperty ("render_id",
+                                     renderScheduler->enqueue ({ renderEditId,
+                                                                 stateSnapshot,
+                                                                 editFile,
+                                                                 stemFile,
+                                                                 te::TimeRange (te::TimePosition::fromSeconds (startSec),
+                                                                                te::TimePosition::fromSeconds (endSec)),
+                                                                 trackMask }));
+            exportedFiles.add (juce::var (renderInfo));
+            continue;
+        }
+
+        auto* renderEdit = &edit;
+        if (staleTracks.contains (track))
+        {
+            renderEdit = liveEdit.get();
+            trackMask.clear();
+
+            if (auto* liveTrack = te::findTrackForID (*liveEdit, track->itemID))
+                trackMask.setBit (liveTrack->getIndexInEditTrackList());
+        }
+
+        auto ok = ! trackMask.isZero()
+                  && te::Renderer::renderToFile (
+                         "Export Stem: " + track->getName(),
+                         stemFile,
+                         *renderEdit,
+                         te::TimeRange (te::TimePosition::fromSeconds (startSec), te::TimePosition::fromSeconds (endSec)),
+                         trackMask,
+                         true,   // usePlugins
+                         true,   // useACID
+                         {},     // allowedClips
+                         false); // useThread
 
         if (ok)
         {
             auto* fileInfo = new juce::DynamicObject();
-            fileInfo->setProperty ("track_id", getPublicTrackIndex (edit, track));
+            fileInfo->setProperty ("track_id", getPublicTrackIndex (track));
             fileInfo->setProperty ("track_name", track->getName());
             fileInfo->setProperty ("file_path", stemFile.getFullPathName());
+            fileInfo->setProperty ("frozen", renderFromFreeze);
             exportedFiles.add (juce::var (fileInfo));
         }
         else
@@ -1916,6 +2059,261 @@ juce::var CommandHandler::handleExportStems (const juce::var& params)
     return result;
 }
 
+juce::var CommandHandler::handleGetRenderStatus (const juce::var& params)
+{
+    juce::var errorResult;
+    juce::String renderId, batchId;
+    if (! requireOptionalStringProperty (params, "render_id", renderId, errorResult)
+        || ! requireOptionalStringProperty (params, "batch_id", batchId, errorResult))
+        return errorResult;
+
+    if (renderId.isEmpty() == batchId.isEmpty())
+        return makeError ("Provide exactly one of render_id or batch_id");
+
+    if (renderScheduler == nullptr)
+        return makeError ("Asynchronous rendering is not available");
+
+    auto status = renderId.isNotEmpty() ? renderScheduler->getStatus (renderId)
+                                        : renderScheduler->getBatchStatus (batchId);
+    if (! status.isObject())
+        return makeError (renderId.isNotEmpty() ? "Render not found: " + renderId
+                                                : "Render batch not found: " + batchId);
+
+    // "status" is reserved for the command result; the render state goes in render_status.
+    auto result = makeOk();
+    if (auto* obj = result.getDynamicObject())
+        for (const auto& property : status.getDynamicObject()->getProperties())
+            obj->setProperty (property.name == juce::Identifier ("status") ? juce::Identifier ("render_status")
+                                                                           : property.name,
+                              property.value);
+    return result;
+}
+
+juce::var CommandHandler::handleRenderBatch (const juce::var& params)
+{
+    juce::var errorResult;
+    juce::String outputDirPath;
+    if (! requireStringProperty (params, "output_dir", outputDirPath, errorResult))
+        return errorResult;
+    juce::File outputDir (outputDirPath);
+
+    if (! isWithinAllowedDirectories (outputDirPath, outputDir, allowedMediaDirectories))
+        return makeError ("Output directory is outside allowed directories");
+
+    if (renderScheduler == nullptr)
+        return makeError ("Asynchronous rendering is not available");
+
+    auto* jobs = params["jobs"].getArray();
+    if (jobs == nullptr || jobs->isEmpty())
+        return makeError ("Parameter must be a non-empty array: jobs");
+
+    auto readTrackList = [this] (const juce::var& job, const char* propertyName,
+                                 juce::Array<te::AudioTrack*>& tracksOut, juce::var& error)
+    {
+        if (! job.hasProperty (propertyName))
+            return true;
+
+        auto* ids = job[propertyName].getArray();
+        if (ids == nullptr)
+        {
+            error = makeError ("Parameter must be an array of track ids: " + juce::String (propertyName));
+            return false;
+        }
+
+        for (const auto& id : *ids)
+        {
+            auto* audioTrack = (id.isInt() || id.isInt64()) ? dynamic_cast<te::AudioTrack*> (getTrackById ((int) id))
+                                                             : nullptr;
+            if (audioTrack == nullptr)
+            {
+                error = makeError ("Audio track not found in " + juce::String (propertyName) + ": "
+                                   + id.toString());
+                return false;
+            }
+
+            tracksOut.addIfNotAlreadyThere (audioTrack);
+        }
+
+        return true;
+    };
+
+    // Expand and validate every job before anything is queued, so one bad job
+    // rejects the whole batch.
+    struct PlannedRender
+    {
+        int jobIndex;
+        juce::String format;
+        waive::RenderScheduler::Request request;
+    };
+
+    std::vector<PlannedRender> planned;
+    juce::Array<juce::File> plannedFiles;
+
+    for (int jobIndex = 0; jobIndex < jobs->size(); ++jobIndex)
+    {
+        const auto& job = jobs->getReference (jobIndex);
+        const auto jobLabel = "jobs[" + juce::String (jobIndex) + "]: ";
+        if (! job.isObject())
+            return makeError (jobLabel + "job must be an object");
+
+        juce::String name = "render_" + juce::String (jobIndex + 1);
+        double startSec = 0.0;
+        double endSec = edit.getLength().inSeconds();
+        bool stems = false;
+        double sampleRate = 0.0;
+        double oggQuality = 0.6;
+        if (! requireOptionalStringProperty (job, "name", name, errorResult)
+            || ! requireOptionalDoubleProperty (job, "start", startSec, errorResult)
+            || ! requireOptionalDoubleProperty (job, "end", endSec, errorResult)
+            || ! requireOptionalBoolProperty (job, "stems", stems, errorResult)
+            || ! requireOptionalDoubleProperty (job, "sample_rate", sampleRate, errorResult)
+            || ! requireOptionalDoubleProperty (job, "ogg_quality", oggQuality, errorResult))
+            return makeError (jobLabel + errorResult["message"].toString());
+
+        if (isInvalidRenderRange (startSec, endSec))
+            return makeError (jobLabel + "End time must be greater than start time");
+
+        if (sampleRate < 0.0 || oggQuality < 0.0 || oggQuality > 1.0)
+            return makeError (jobLabel + "sample_rate must be positive and ogg_quality within 0-1");
+
+        int bitDepth = 24;
+        if (job.hasProperty ("bit_depth"))
+        {
+            if (! requireIntProperty (job, "bit_depth", bitDepth, errorResult))
+                return makeError (jobLabel + errorResult["message"].toString());
+
+            if (bitDepth != 16 && bitDepth != 24 && bitDepth != 32)
+                return makeError (jobLabel + "bit_depth must be 16, 24 or 32");
+        }
+
+        juce::StringArray formats;
+        if (job.hasProperty ("formats"))
+        {
+            auto* formatList = job["formats"].getArray();
+            if (formatList == nullptr || formatList->isEmpty())
+                return makeError (jobLabel + "formats must be a non-empty array");
+
+            for (const auto& format : *formatList)
+            {
+                const auto formatName = format.toString().toLowerCase();
+                if (! format.isString() || (formatName != "wav" && formatName != "flac" && formatName != "ogg"))
+                    return makeError (jobLabel + "Unsupported format: " + format.toString());
+
+                formats.addIfNotAlreadyThere (formatName);
+            }
+        }
+        else
+        {
+            formats.add ("wav");
+        }
+
+        if (bitDepth == 32 && formats.contains ("flac"))
+            return makeError (jobLabel + "flac supports bit_depth 16 or 24");
+
+        juce::Array<te::AudioTrack*> selectedTracks, mutedTracks;
+        if (! readTrackList (job, "track_ids", selectedTracks, errorResult)
+            || ! readTrackList (job, "mute_track_ids", mutedTracks, errorResult))
+            return makeError (jobLabel + errorResult["message"].toString());
+
+        if (selectedTracks.isEmpty())
+            selectedTracks.addArray (te::getAudioTracks (edit));
+
+        selectedTracks.removeValuesIn (mutedTracks);
+        if (selectedTracks.isEmpty())
+            return makeError (jobLabel + "No tracks left to render");
+
+        // One output per stem, or a single mix of the selected tracks.
+        std::vector<std::pair<juce::String, juce::BigInteger>> outputs;
+        const auto baseName = sanitiseOutputFileComponent (name, "render");
+
+        if (stems)
+        {
+            for (auto* track : selectedTracks)
+            {
+                if (track->getClips().isEmpty())
+                    continue;
+
+                juce::BigInteger mask;
+                mask.setBit (track->getIndexInEditTrackList());
+                outputs.emplace_back (baseName + juce::String::formatted ("_%02d_", getPublicTrackIndex (track) + 1)
+                                          + sanitiseOutputFileComponent (track->getName(), "Track"),
+                                      mask);
+            }
+        }
+        else
+        {
+            juce::BigInteger mask;
+            for (auto* track : selectedTracks)
+                mask.setBit (track->getIndexInEditTrackList());
+            outputs.emplace_back (baseName, mask);
+        }
+
+        const te::TimeRange range (te::TimePosition::fromSeconds (startSec), te::TimePosition::fromSeconds (endSec));
+
+        for (const auto& [outputName, mask] : outputs)
+        {
+            for (const auto& format : formats)
+            {
+                auto destFile = outputDir.getChildFile (outputName + "." + format);
+                if (plannedFiles.contains (destFile))
+                    return makeError (jobLabel + "Duplicate output file: " + destFile.getFileName());
+
+                plannedFiles.add (destFile);
+
+                waive::RenderScheduler::Request request;
+                request.editId = renderEditId;
+                request.destFile = destFile;
+                request.range = range;
+                request.tracksMask = mask;
+                request.bitDepth = bitDepth;
+                request.sampleRate = sampleRate;
+                request.quality = format == "ogg" ? juce::roundToInt (oggQuality * 10.0) : 0;
+                request.measureLoudness = true;
+                planned.push_back ({ jobIndex, format, std::move (request) });
+            }
+        }
+    }
+
+    if (planned.empty())
+        return makeError ("No renders to queue: selected tracks have no clips");
+
+    outputDir.createDirectory();
+
+    // All renders share one state snapshot, but each format of an output is
+    // still rendered on its own rather than rendered once and encoded per
+    // format the way RenderDialog does.
+    edit.flushState();
+    const auto stateSnapshot = edit.state.createCopy();
+    const auto editFile = te::EditFileOperations (edit).getEditFile();
+    const auto batchId = renderScheduler->createBatch();
+
+    juce::Array<juce::var> renders;
+    for (auto& render : planned)
+    {
+        render.request.editState = stateSnapshot;
+        render.request.editFile = editFile;
+        render.request.batchId = batchId;
+
+        auto* renderInfo = new juce::DynamicObject();
+        renderInfo->setProperty ("job_index", render.jobIndex);
+        renderInfo->setProperty ("format", render.format);
+        renderInfo->setProperty ("file_path", render.request.destFile.getFullPathName());
+        renderInfo->setProperty ("render_id", renderScheduler->enqueue (std::move (render.request)));
+        renders.add (juce::var (renderInfo));
+    }
+
+    auto result = makeOk();
+    if (auto* obj = result.getDynamicObject())
+    {
+        obj->setProperty ("batch_id", batchId);
+        obj->setProperty ("output_dir", outputDir.getFullPathName());
+        obj->setProperty ("renders", renders);
+        obj->setProperty ("count", renders.size());
+        obj->setProperty ("render_threads", renderScheduler->getNumThreads());
+    }
+    return result;
+}
+
 juce::var CommandHandler::handleBounceTrack (const juce::var& params)
 {
     juce::var errorResult;
@@ -1927,6 +2325,9 @@ juce::var CommandHandler::handleBounceTrack (const juce::var& params)
     if (track == nullptr)
         return makeError ("Audio track not found: " + juce::String (trackId));
 
+    // Bounce the live clips and plugins, not the freeze render on top of them.
+    freezeManager->unfreeze (*track);
+
     if (track->getClips().isEmpty())
         return makeError ("Track has no clips to bounce");
 
@@ -1993,6 +2394,80 @@ juce::var CommandHandler::handleBounceTrack (const juce::var& params)
     return result;
 }
 
+juce::var CommandHandler::handleFreezeTrack (const juce::var& params)
+{
+    juce::var errorResult;
+    int trackId = 0;
+    double tailSeconds = 2.0;
+    if (! requireIntProperty (params, "track_id", trackId, errorResult)
+        || ! requireOptionalDoubleProperty (params, "tail_seconds", tailSeconds, errorResult))
+        return errorResult;
+
+    if (tailSeconds < 0.0 || tailSeconds > 30.0)
+        return makeError ("tail_seconds must be between 0 and 30");
+
+    auto* track = getAudioTrackById (trackId);
+    if (track == nullptr)
+        return makeError ("Audio track not found: " + juce::String (trackId));
+
+    // Freeze renders live with the project so they survive reopening it.
+    const auto projectFile = resolveProjectFile();
+    const auto cacheDir = projectFile != juce::File()
+                            ? projectFile.getParentDirectory().getChildFile ("Cache").getChildFile ("Freeze")
+                            : juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("waive_freeze");
+
+    auto freeze = freezeManager->freeze (*track, cacheDir, tailSeconds);
+    if (! freeze.ok)
+        return makeError (freeze.error);
+
+    auto result = makeOk();
+    if (auto* obj = result.getDynamicObject())
+    {
+        obj->setProperty ("track_id", trackId);
+        obj->setProperty ("frozen", true);
+        obj->setProperty ("cache_file", freeze.cacheFile.getFullPathName());
+        obj->setProperty ("cached", freeze.reusedCache);
+        obj->setProperty ("start", freeze.range.getStart().inSeconds());
+        obj->setProperty ("end", freeze.range.getEnd().inSeconds());
+    }
+    return result;
+}
+
+juce::var CommandHandler::handleUnfreezeTrack (const juce::var& params)
+{
+    juce::var errorResult;
+    int trackId = 0;
+    if (! requireIntProperty (params, "track_id", trackId, errorResult))
+        return errorResult;
+
+    auto* track = getAudioTrackById (trackId);
+    if (track == nullptr)
+        return makeError ("Audio track not found: " + juce::String (trackId));
+
+    const bool wasFrozen = freezeManager->unfreeze (*track);
+
+    auto result = makeOk();
+    if (auto* obj = result.getDynamicObject())
+    {
+        obj->setProperty ("track_id", trackId);
+        obj->setProperty ("frozen", false);
+        obj->setProperty ("was_frozen", wasFrozen);
+    }
+    return result;
+}
+
+juce::var CommandHandler::handleRefreshFreezes()
+{
+    // Catches changes made outside EditSession, such as a plugin edited in its
+    // own window; edits made through EditSession are checked as they happen.
+    const auto unfrozen = freezeManager->refreshStaleFreezes();
+
+    auto result = makeOk();
+    if (auto* obj = result.getDynamicObject())
+        obj->setProperty ("unfrozen", unfrozen);
+    return result;
+}
+
 juce::var CommandHandler::handleRemovePlugin (const juce::var& params)
 {
     juce::var errorResult;
@@ -2342,23 +2817,11 @@ juce::var CommandHandler::handleSetClipFade (const juce::var& params)
 
 te::Track* CommandHandler::getTrackById (int trackIndex)
 {
-    if (trackIndex < 0)
+    const auto& publicTracks = getPublicTracks();
+    if (trackIndex < 0 || trackIndex >= publicTracks.size())
         return nullptr;
 
-    int publicTrackIndex = 0;
-    for (auto* track : edit.getTrackList())
-    {
-        if (dynamic_cast<te::AudioTrack*> (track) == nullptr
-            && dynamic_cast<te::FolderTrack*> (track) == nullptr)
-            continue;
-
-        if (publicTrackIndex == trackIndex)
-            return track;
-
-        ++publicTrackIndex;
-    }
-
-    return nullptr;
+    return publicTracks.getUnchecked (trackIndex);
 }
 
 te::AudioTrack* CommandHandler::getAudioTrackById (int trackIndex)
@@ -2408,6 +2871,126 @@ te::PluginList* CommandHandler::getPluginListForParams (const juce::var& params,
     return &track->pluginList;
 }
 
+const juce::Array<te::Track*>& CommandHandler::getPublicTracks()
+{
+    if (! publicTrackCacheValid)
+    {
+        publicTrackCache.clearQuick();
+        publicTrackIndices.clear();
+
+        for (auto* track : edit.getTrackList())
+        {
+            if (dynamic_cast<te::AudioTrack*> (track) == nullptr
+                && dynamic_cast<te::FolderTrack*> (track) == nullptr)
+                continue;
+
+            publicTrackIndices[track] = publicTrackCache.size();
+            publicTrackCache.add (track);
+        }
+
+        publicTrackCacheValid = true;
+    }
+
+    return publicTrackCache;
+}
+
+int CommandHandler::getPublicTrackIndex (te::Track* track)
+{
+    if (track == nullptr)
+        return -1;
+
+    getPublicTracks();
+    if (auto it = publicTrackIndices.find (track); it != publicTrackIndices.end())
+        return it->second;
+
+    return -1;
+}
+
+te::Plugin* CommandHandler::findPluginByIdentifier (te::Track& track, const juce::String& identifier)
+{
+    if (identifier.isEmpty())
+        return nullptr;
+
+    auto [entry, inserted] = pluginIdentifierCache.try_emplace (&track);
+    auto& identifiers = entry->second;
+
+    if (inserted)
+    {
+        // First match in chain order wins, matching the previous linear scan.
+        for (auto* plugin : getAddressablePlugins (track.pluginList))
+        {
+            for (const auto& key : { plugin->getName(),
+                                     waive::PluginPresetManager::getPluginIdentifier (*plugin),
+                                     plugin->state.getProperty ("fileOrIdentifier", {}).toString().trim(),
+                                     plugin->state.getProperty (te::IDs::type, {}).toString().trim() })
+            {
+                if (key.isNotEmpty())
+                    identifiers.try_emplace (key, plugin);
+            }
+        }
+    }
+
+    if (auto it = identifiers.find (identifier); it != identifiers.end())
+        return it->second;
+
+    return nullptr;
+}
+
+void CommandHandler::invalidateTrackCache()
+{
+    publicTrackCacheValid = false;
+    publicTrackCache.clearQuick();
+    publicTrackIndices.clear();
+    invalidatePluginCache();
+}
+
+void CommandHandler::invalidatePluginCache()
+{
+    pluginIdentifierCache.clear();
+}
+
+void CommandHandler::valueTreePropertyChanged (juce::ValueTree& tree, const juce::Identifier& property)
+{
+    // Parameter values also live on PLUGIN nodes, so only identifier-bearing
+    // properties invalidate; set_parameter itself must not flush the cache.
+    if (tree.hasType (te::IDs::PLUGIN)
+        && (property == te::IDs::name || property == te::IDs::type
+            || property == juce::Identifier ("fileOrIdentifier")
+            || property == juce::Identifier ("pluginFormatName")
+            || property == juce::Identifier ("manufacturer")))
+        invalidatePluginCache();
+}
+
+void CommandHandler::valueTreeChildAdded (juce::ValueTree&, juce::ValueTree& child)
+{
+    if (te::TrackList::isTrack (child))
+        invalidateTrackCache();
+    else if (child.hasType (te::IDs::PLUGIN))
+        invalidatePluginCache();
+}
+
+void CommandHandler::valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree& child, int)
+{
+    if (te::TrackList::isTrack (child))
+        invalidateTrackCache();
+    else if (child.hasType (te::IDs::PLUGIN))
+        invalidatePluginCache();
+}
+
+void CommandHandler::valueTreeChildOrderChanged (juce::ValueTree& parent, int, int)
+{
+    // Track reorders change public indices; plugin reorders change first-match order.
+    if (parent == edit.state || te::TrackList::isTrack (parent))
+        invalidateTrackCache();
+    else
+        invalidatePluginCache();
+}
+
+void CommandHandler::valueTreeRedirected (juce::ValueTree&)
+{
+    invalidateTrackCache();
+}
+
 te::Clip* CommandHandler::getClipByIndex (int trackIndex, int clipIndex)
 {
     auto* track = getAudioTrackById (trackIndex);
@@ -2562,7 +3145,7 @@ juce::var CommandHandler::handleReorderTrack (const juce::var& params)
     if (! track)
         return makeError ("Track not found: " + juce::String (trackId));
 
-    const auto publicTracks = getPublicTracks (edit);
+    const auto publicTracks = getPublicTracks();
     if (newPosition < 0 || newPosition >= publicTracks.size())
         return makeError ("new_position out of range (0-" + juce::String (publicTracks.size() - 1) + ")");
 
@@ -2806,7 +3389,7 @@ juce::var CommandHandler::handleCollectAndSave()
         return errorResult;
 
     auto projectDir = editFile.getParentDirectory();
-    auto result = waive::ProjectPackager::collectAndSave (edit, projectDir, editFile);
+    auto result = waive::ProjectPackager::collectAndSave (edit, projectDir, editFile, compressBinaryProjects);
 
     auto response = result.errors.isEmpty()
                         ? makeOk()
@@ -2881,7 +3464,7 @@ juce::var CommandHandler::handlePackageAsZip (const juce::var& params)
     if (outputDir == juce::File() || (! outputDir.exists() && outputDir.createDirectory().failed()))
         return makeError ("Failed to create output directory: " + outputDir.getFullPathName());
 
-    auto packageResult = waive::ProjectPackager::packageEditAsZip (edit, projectFile, outputZip);
+    auto packageResult = waive::ProjectPackager::packageEditAsZip (edit, projectFile, outputZip, compressBinaryProjects);
     if (! packageResult.errors.isEmpty())
         return makeError ("Failed to collect project media before packaging: "
                           + packageResult.errors.joinIntoString ("; "));
@@ -2,21 +2,35 @@
 
 #include <JuceHeader.h>
 #include <tracktion_engine/tracktion_engine.h>
+#include <unordered_map>
 
 namespace te = tracktion;
-namespace waive { class PluginPresetManager; }
+namespace waive { class PluginPresetManager; class RenderScheduler; }
+class TrackFreezeManager;
 
 //==============================================================================
-/** Dispatches JSON commands to Tracktion Engine Edit operations. */
-class CommandHandler
+/** Dispatches JSON commands to Tracktion Engine Edit operations.
+
+    Dispatch goes through a hashed action table, and the public track index and
+    per-track plugin identifier lookups are cached. Both caches are invalidated
+    from a ValueTree listener on the edit when tracks or plugins are added,
+    removed, reordered or renamed. */
+class CommandHandler : private juce::ValueTree::Listener
 {
 public:
     explicit CommandHandler (te::Edit& edit);
     ~CommandHandler();
 
-    /** Process a JSON command string and return a JSON response string. */
+    /** Process a JSON command string and return a JSON response string.
+        This is the socket-boundary entry point; it parses once and forwards to
+        executeCommand(). */
     juce::String handleCommand (const juce::String& jsonString);
 
+    /** Typed in-process entry point. Takes an already-built command object
+        (with an "action" property) and returns the structured response object
+        without any JSON serialisation. */
+    juce::var executeCommand (const juce::var& command);
+
     /** Set the canonical project file path for project-scoped commands. */
     void setProjectFile (const juce::File& projectFile);
 
@@ -26,11 +40,66 @@ public:
     /** Get current allowed media directories. */
     const juce::Array<juce::File>& getAllowedMediaDirectories() const;
 
+    /** Whether binary projects written by collect_and_save and package_as_zip
+        are compressed; mirrors the user's project setting. */
+    void setCompressBinaryProjects (bool shouldCompress);
+    bool shouldCompressBinaryProjects() const;
+
+    /** Resolves the automatable parameter named by a command's track_id,
+        plugin_id and param_id, using the same lookup rules as set_parameter.
+        When plugin_id is omitted the track's volume/pan plugin is used, so
+        param_id may be "volume" or "pan". Returns nullptr and fills
+        errorResult on failure. */
+    te::AutomatableParameter::Ptr resolveParameter (const juce::var& params, juce::var& errorResult);
+
+    /** Enables "async": true on export_mixdown / export_stems. Renders are then
+        queued on the scheduler from a snapshot of the edit and polled with
+        get_render_status. editId tags the queued renders. */
+    void setRenderScheduler (waive::RenderScheduler* scheduler, const juce::String& editId = {});
+    waive::RenderScheduler* getRenderScheduler() const    { return renderScheduler; }
+
+    /** Unfreezes frozen tracks that edits since the last call have made stale.
+        Run it at the end of a mutation, inside its undo transaction, so the
+        unfreeze undoes together with the edit. */
+    void refreshPendingFreezes();
+
 private:
+    struct StringHash
+    {
+        size_t operator() (const juce::String& s) const noexcept { return (size_t) s.hash(); }
+    };
+
+    using CommandFunction = juce::var (*) (CommandHandler&, const juce::var&);
+    using PluginIdentifierMap = std::unordered_map<juce::String, te::Plugin*, StringHash>;
+
     te::Edit& edit;
     juce::File currentProjectFile;
     juce::Array<juce::File> allowedMediaDirectories;
+    bool compressBinaryProjects = true;
     std::unique_ptr<waive::PluginPresetManager> presetManager;
+    std::unique_ptr<TrackFreezeManager> freezeManager;
+    waive::RenderScheduler* renderScheduler = nullptr;
+    juce::String renderEditId;
+
+    // ── Lookup caches (invalidated by edit structure changes) ───────────
+    juce::Array<te::Track*> publicTrackCache;
+    std::unordered_map<te::Track*, int> publicTrackIndices;
+    bool publicTrackCacheValid = false;
+    std::unordered_map<te::Track*, PluginIdentifierMap> pluginIdentifierCache;
+
+    static CommandFunction findCommand (const juce::String& action);
+
+    const juce::Array<te::Track*>& getPublicTracks();
+    int getPublicTrackIndex (te::Track* track);
+    te::Plugin* findPluginByIdentifier (te::Track& track, const juce::String& identifier);
+    void invalidateTrackCache();
+    void invalidatePluginCache();
+
+    void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
+    void valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) override;
+    void valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) override;
+    void valueTreeChildOrderChanged (juce::ValueTree&, int, int) override;
+    void valueTreeRedirected (juce::ValueTree&) override;
 
     // ── Individual command handlers ─────────────────────────────────────
     juce::var handlePing();
@@ -66,7 +135,12 @@ private:
     juce::var handleSetLoopRegion (const juce::var& params);
     juce::var handleExportMixdown (const juce::var& params);
     juce::var handleExportStems (const juce::var& params);
+    juce::var handleGetRenderStatus (const juce::var& params);
+    juce::var handleRenderBatch (const juce::var& params);
     juce::var handleBounceTrack (const juce::var& params);
+    juce::var handleFreezeTrack (const juce::var& params);
+    juce::var handleUnfreezeTrack (const juce::var& params);
+    juce::var handleRefreshFreezes();
     juce::var handleRemovePlugin (const juce::var& params);
     juce::var handleBypassPlugin (const juce::var& params);
     juce::var handleGetPluginParameters (const juce::var& params);
@@ -106,6 +180,10 @@ private:
                               const char* propertyName,
                               bool& valueOut,
                               juce::var& errorResult);
+    bool requireOptionalBoolProperty (const juce::var& params,
+                                      const char* propertyName,
+                                      bool& valueOut,
+                                      juce::var& errorResult);
     bool requireOptionalDoubleProperty (const juce::var& params,
                                         const char* propertyName,
                                         double& valueOut,
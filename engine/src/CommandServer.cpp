@@ -36,9 +36,10 @@ void closeConnectionTransport (juce::InterprocessConnection& connection)
 //==============================================================================
 
 CommandConnection::CommandConnection (CommandCallback callback, const juce::String& authToken,
-                                      int timeoutMs)
+                                      int timeoutMs, BinaryFrameCallback frameCallback)
     : InterprocessConnection (false, 0x0000AD10),
       commandCallback (std::move (callback)),
+      binaryFrameCallback (std::move (frameCallback)),
       expectedToken (authToken),
       authTimeoutMs (timeoutMs)
 {
@@ -67,6 +68,10 @@ void CommandConnection::connectionLost()
 
 void CommandConnection::messageReceived (const juce::MemoryBlock& message)
 {
+    // High-rate binary frames skip logging, the message-thread hop and the reply.
+    if (authenticated && binaryFrameCallback != nullptr && binaryFrameCallback (message))
+        return;
+
     auto json = message.toString();
 
     // First message must be authentication token
@@ -104,30 +109,33 @@ void CommandConnection::messageReceived (const juce::MemoryBlock& message)
 
     juce::Logger::writeToLog ("Received: " + json);
 
-    juce::String response;
+    auto response = dispatchOnMessageThread (commandCallback, json);
+
+    juce::MemoryBlock responseBlock (response.toRawUTF8(),
+                                     response.getNumBytesAsUTF8());
+    sendMessage (responseBlock);
+}
 
+juce::String CommandConnection::dispatchOnMessageThread (const CommandCallback& callback,
+                                                         const juce::String& json,
+                                                         juce::Thread* threadToCheckForExitSignal)
+{
     // Marshal Edit mutations onto the message thread. This keeps behavior sane in the GUI app,
     // and also makes the headless server thread-safe with respect to JUCE/Tracktion state.
     if (juce::MessageManager::getInstance()->isThisTheMessageThread())
     {
-        response = commandCallback != nullptr
-                     ? commandCallback (json)
-                     : "{\"status\":\"error\",\"message\":\"No command handler configured\"}";
-    }
-    else
-    {
-        juce::MessageManagerLock messageManagerLock;
-        if (! messageManagerLock.lockWasGained())
-            response = "{\"status\":\"error\",\"message\":\"Failed to acquire message-thread lock\"}";
-        else
-            response = commandCallback != nullptr
-                         ? commandCallback (json)
-                         : "{\"status\":\"error\",\"message\":\"No command handler configured\"}";
+        return callback != nullptr
+                 ? callback (json)
+                 : "{\"status\":\"error\",\"message\":\"No command handler configured\"}";
     }
 
-    juce::MemoryBlock responseBlock (response.toRawUTF8(),
-                                     response.getNumBytesAsUTF8());
-    sendMessage (responseBlock);
+    juce::MessageManagerLock messageManagerLock (threadToCheckForExitSignal);
+    if (! messageManagerLock.lockWasGained())
+        return "{\"status\":\"error\",\"message\":\"Failed to acquire message-thread lock\"}";
+
+    return callback != nullptr
+             ? callback (json)
+             : "{\"status\":\"error\",\"message\":\"No command handler configured\"}";
 }
 
 void CommandConnection::startAuthTimeoutThread()
@@ -329,7 +337,7 @@ bool CommandServer::start()
 
 juce::InterprocessConnection* CommandServer::createConnectionObject()
 {
-    auto* conn = new CommandConnection (commandCallback, authToken, authTimeoutMs);
+    auto* conn = new CommandConnection (commandCallback, authToken, authTimeoutMs, binaryFrameCallback);
 
     juce::ScopedLock lock (connectionLock);
     connections.add (conn);
@@ -12,19 +12,30 @@ class CommandConnection : public juce::InterprocessConnection
 public:
     using CommandCallback = std::function<juce::String (const juce::String&)>;
 
+    /** Offered every authenticated message before JSON dispatch, on the socket
+        thread. Return true to consume it; consumed messages get no reply. */
+    using BinaryFrameCallback = std::function<bool (const juce::MemoryBlock&)>;
+
     explicit CommandConnection (CommandCallback callback, const juce::String& authToken,
-                                int authTimeoutMs = 5000);
+                                int authTimeoutMs = 5000,
+                                BinaryFrameCallback binaryFrameCallback = nullptr);
     ~CommandConnection() override;
 
     void connectionMade() override;
     void connectionLost() override;
     void messageReceived (const juce::MemoryBlock& message) override;
 
+    /** Runs callback on the message thread (taking the MessageManagerLock when
+        called from a socket thread). Shared by every command transport. */
+    static juce::String dispatchOnMessageThread (const CommandCallback& callback, const juce::String& json,
+                                                 juce::Thread* threadToCheckForExitSignal = nullptr);
+
 private:
     void startAuthTimeoutThread();
     void stopAuthTimeoutThread();
 
     CommandCallback commandCallback;
+    BinaryFrameCallback binaryFrameCallback;
     juce::String expectedToken;
     int authTimeoutMs = 5000;
     std::atomic<bool> authenticated { false };
@@ -39,10 +50,15 @@ class CommandServer : public juce::InterprocessConnectionServer
 {
 public:
     using CommandCallback = CommandConnection::CommandCallback;
+    using BinaryFrameCallback = CommandConnection::BinaryFrameCallback;
 
     CommandServer (CommandCallback callback, int port, int authTimeoutMs = 5000);
     ~CommandServer() override;
 
+    /** Route fire-and-forget binary frames (e.g. parameter stream records) away
+        from JSON dispatch. Applies to connections accepted after the call. */
+    void setBinaryFrameCallback (BinaryFrameCallback callback) { binaryFrameCallback = std::move (callback); }
+
     bool start();
 
     juce::InterprocessConnection* createConnectionObject() override;
@@ -55,6 +71,7 @@ public:
 
 private:
     CommandCallback commandCallback;
+    BinaryFrameCallback binaryFrameCallback;
     int port;
     int authTimeoutMs = 5000;
     juce::String authToken;
@@ -0,0 +1,250 @@
+#include "EditHost.h"
+#include "CommandHandler.h"
+#include "EditSession.h"
+#include "ParameterStream.h"
+#include "PathSanitizer.h"
+#include "ProjectFileFormat.h"
+#include "RenderScheduler.h"
+#include "StartupProfile.h"
+#include "UndoableCommandHandler.h"
+
+namespace
+{
+juce::var makeError (const juce::String& message)
+{
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("status", "error");
+    obj->setProperty ("message", message);
+    return juce::var (obj);
+}
+
+juce::var makeOk()
+{
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("status", "ok");
+    return juce::var (obj);
+}
+}
+
+//==============================================================================
+struct EditHost::HostedEdit
+{
+    HostedEdit (std::unique_ptr<EditSession> s, const juce::String& editId, waive::RenderScheduler& scheduler)
+        : session (std::move (s)),
+          handler (session->getEdit()),
+          undoableHandler (handler, *session)
+    {
+        handler.setRenderScheduler (&scheduler, editId);
+    }
+
+    std::unique_ptr<EditSession> session;
+    CommandHandler handler;
+    UndoableCommandHandler undoableHandler;
+};
+
+//==============================================================================
+EditHost::EditHost (te::Engine& e)
+    : engine (e),
+      renderScheduler (std::make_unique<waive::RenderScheduler> (e))
+{
+    auto& defaultEdit = addEdit (defaultEditId, std::make_unique<EditSession> (engine));
+    parameterStream = std::make_unique<ParameterStream> (*defaultEdit.session);
+    defaultEdit.undoableHandler.setParameterStream (parameterStream.get());
+}
+
+EditHost::~EditHost()
+{
+    parameterStream.reset();
+    edits.clear();
+    renderScheduler.reset();
+}
+
+EditHost::HostedEdit& EditHost::addEdit (const juce::String& editId, std::unique_ptr<EditSession> session)
+{
+    auto hosted = std::make_unique<HostedEdit> (std::move (session), editId, *renderScheduler);
+
+    // Opened edits share the default edit's path allowlist and project settings.
+    if (auto it = edits.find (defaultEditId); it != edits.end())
+    {
+        hosted->handler.setAllowedMediaDirectories (it->second->handler.getAllowedMediaDirectories());
+        hosted->handler.setCompressBinaryProjects (it->second->handler.shouldCompressBinaryProjects());
+    }
+
+    auto& ref = *hosted;
+    edits[editId] = std::move (hosted);
+    return ref;
+}
+
+ParameterStream& EditHost::getParameterStream()
+{
+    return *parameterStream;
+}
+
+EditSession* EditHost::getEditSession (const juce::String& editId)
+{
+    auto it = edits.find (editId);
+    return it != edits.end() ? it->second->session.get() : nullptr;
+}
+
+//==============================================================================
+juce::String EditHost::handleCommand (const juce::String& jsonString)
+{
+    auto parsed = juce::JSON::parse (jsonString);
+
+    if (! parsed.isObject())
+        return edits[defaultEditId]->undoableHandler.handleCommand (jsonString);
+
+    return juce::JSON::toString (executeCommand (parsed));
+}
+
+juce::var EditHost::executeCommand (const juce::var& command)
+{
+    if (! command.isObject())
+        return edits[defaultEditId]->undoableHandler.executeCommand (command);
+
+    const auto action = command["action"].toString();
+
+    if (onBeforeCommand != nullptr)
+        onBeforeCommand (action);
+
+    if (action == "open_edit")              return handleOpenEdit (command);
+    if (action == "close_edit")             return handleCloseEdit (command);
+    if (action == "list_edits")             return handleListEdits();
+    if (action == "get_startup_timings")    return handleGetStartupTimings();
+
+    juce::String editId = defaultEditId;
+    if (command.hasProperty ("edit_id"))
+    {
+        if (! command["edit_id"].isString())
+            return makeError ("Property 'edit_id' must be a string");
+
+        editId = command["edit_id"].toString();
+    }
+
+    auto it = edits.find (editId);
+    if (it == edits.end())
+        return makeError ("Edit not found: " + editId);
+
+    if (editId != defaultEditId
+        && (action == "open_parameter_stream" || action == "close_parameter_stream"))
+        return makeError ("Parameter streams are only available on the default edit");
+
+    return it->second->undoableHandler.executeCommand (command);
+}
+
+//==============================================================================
+bool EditHost::isAllowedEditFile (const juce::File& file) const
+{
+    const auto& allowed = edits.at (defaultEditId)->handler.getAllowedMediaDirectories();
+
+    for (const auto& dir : allowed)
+        if (waive::PathSanitizer::isWithinDirectory (file, dir))
+            return true;
+
+    return false;
+}
+
+juce::var EditHost::handleOpenEdit (const juce::var& params)
+{
+    std::unique_ptr<EditSession> session;
+
+    if (params.hasProperty ("file_path"))
+    {
+        if (! params["file_path"].isString())
+            return makeError ("Property 'file_path' must be a string");
+
+        const auto path = params["file_path"].toString();
+        if (! juce::File::isAbsolutePath (path))
+            return makeError ("file_path must be an absolute path");
+
+        const juce::File file (path);
+        if (! file.existsAsFile())
+            return makeError ("File not found: " + path);
+
+        if (! waive::ProjectFileFormat::isProjectFile (file))
+            return makeError ("file_path must be a .tracktionedit or .waiveproject file");
+
+        if (! isAllowedEditFile (file))
+            return makeError ("file_path is outside the allowed directories");
+
+        session = std::make_unique<EditSession> (engine);
+        session->loadFromFile (file);
+    }
+    else
+    {
+        session = std::make_unique<EditSession> (engine);
+    }
+
+    juce::String editId;
+    do
+        editId = "edit_" + juce::String (nextEditNumber++);
+    while (edits.count (editId) > 0);
+
+    auto& hosted = addEdit (editId, std::move (session));
+
+    auto result = makeOk();
+    if (auto* obj = result.getDynamicObject())
+    {
+        obj->setProperty ("edit_id", editId);
+        obj->setProperty ("track_count", te::getAudioTracks (hosted.session->getEdit()).size());
+    }
+    return result;
+}
+
+juce::var EditHost::handleCloseEdit (const juce::var& params)
+{
+    if (! params["edit_id"].isString())
+        return makeError ("Missing or invalid 'edit_id' property");
+
+    const auto editId = params["edit_id"].toString();
+    if (editId == defaultEditId)
+        return makeError ("The default edit cannot be closed");
+
+    auto it = edits.find (editId);
+    if (it == edits.end())
+        return makeError ("Edit not found: " + editId);
+
+    // Queued renders hold their own state snapshot, so they finish regardless.
+    edits.erase (it);
+
+    auto result = makeOk();
+    if (auto* obj = result.getDynamicObject())
+        obj->setProperty ("edit_id", editId);
+    return result;
+}
+
+juce::var EditHost::handleListEdits()
+{
+    juce::Array<juce::var> list;
+
+    for (const auto& [editId, hosted] : edits)
+    {
+        auto& edit = hosted->session->getEdit();
+        auto* info = new juce::DynamicObject();
+        info->setProperty ("edit_id", editId);
+        info->setProperty ("track_count", te::getAudioTracks (edit).size());
+        info->setProperty ("file_path", te::EditFileOperations (edit).getEditFile().getFullPathName());
+        info->setProperty ("has_unsaved_changes", hosted->session->hasChangedSinceSaved());
+        list.add (juce::var (info));
+    }
+
+    auto result = makeOk();
+    if (auto* obj = result.getDynamicObject())
+    {
+        obj->setProperty ("edits", list);
+        obj->setProperty ("count", list.size());
+        obj->setProperty ("render_threads", renderScheduler->getNumThreads());
+    }
+    return result;
+}
+
+juce::var EditHost::handleGetStartupTimings()
+{
+    if (startupProfile == nullptr)
+        return makeError ("Startup timings are not available");
+
+    auto result = makeOk();
+    if (auto* obj = result.getDynamicObject())
+        obj->setProperty ("startup", startupProfile->toVar());
+    return result;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace te = tracktion;
+
+class CommandHandler;
+class EditSession;
+class ParameterStream;
+class StartupProfile;
+class UndoableCommandHandler;
+namespace waive { class RenderScheduler; }
+
+//==============================================================================
+/** Hosts several independent edits in one headless engine process.
+
+    Every edit gets its own EditSession, CommandHandler and undo history, while
+    the te::Engine (and so the scanned plugin list and device manager) and one
+    RenderScheduler are shared between them. Commands pick an edit with an
+    optional "edit_id"; without one they go to the "default" edit, so
+    single-edit clients keep working unchanged.
+
+    Adds commands of its own: open_edit, close_edit, list_edits and
+    get_startup_timings.
+    Parameter streams stay on the default edit because binary frames carry no
+    edit id. Must be used on the message thread. */
+class EditHost
+{
+public:
+    explicit EditHost (te::Engine& engine);
+    ~EditHost();
+
+    static constexpr const char* defaultEditId = "default";
+
+    /** Process a JSON command string (socket boundary). */
+    juce::String handleCommand (const juce::String& jsonString);
+
+    /** Typed entry point; routes by "edit_id". */
+    juce::var executeCommand (const juce::var& command);
+
+    /** Stream that binary parameter frames are applied to (default edit). */
+    ParameterStream& getParameterStream();
+
+    waive::RenderScheduler& getRenderScheduler()  { return *renderScheduler; }
+
+    /** Returns the edit's session, or nullptr if the id is unknown. */
+    EditSession* getEditSession (const juce::String& editId);
+
+    int getNumEdits() const  { return (int) edits.size(); }
+
+    /** Profile reported by get_startup_timings. Must outlive the host. */
+    void setStartupProfile (const StartupProfile* profile)  { startupProfile = profile; }
+
+    /** Called with each command's action before it is dispatched. The lean
+        startup path uses it to bring up the audio device on first use. */
+    std::function<void (const juce::String& action)> onBeforeCommand;
+
+private:
+    struct HostedEdit;
+
+    juce::var handleOpenEdit (const juce::var& params);
+    juce::var handleCloseEdit (const juce::var& params);
+    juce::var handleListEdits();
+    juce::var handleGetStartupTimings();
+
+    HostedEdit& addEdit (const juce::String& editId, std::unique_ptr<EditSession> session);
+    bool isAllowedEditFile (const juce::File& file) const;
+
+    te::Engine& engine;
+    std::unique_ptr<waive::RenderScheduler> renderScheduler;
+    std::map<juce::String, std::unique_ptr<HostedEdit>> edits;
+    std::unique_ptr<ParameterStream> parameterStream;
+    const StartupProfile* startupProfile = nullptr;
+    int nextEditNumber = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EditHost)
+};
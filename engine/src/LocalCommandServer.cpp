@@ -0,0 +1,591 @@
+#include "LocalCommandServer.h"
+
+#if ! JUCE_WINDOWS
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr uint32_t messageMagic = 0x0000AD10;       // matches CommandConnection
+constexpr uint32_t maxMessageBytes = 64 * 1024 * 1024;
+constexpr int acceptPollIntervalMs = 100;
+
+enum class ReadResult
+{
+    ok,
+    timedOut,
+    closed
+};
+
+#if ! JUCE_WINDOWS
+#if defined (MSG_NOSIGNAL)
+constexpr int sendFlags = MSG_NOSIGNAL;
+#else
+constexpr int sendFlags = 0;
+#endif
+
+bool makeSocketAddress (const juce::File& socketFile, sockaddr_un& address)
+{
+    const auto path = socketFile.getFullPathName();
+    std::memset (&address, 0, sizeof (address));
+    address.sun_family = AF_UNIX;
+
+    if ((size_t) path.getNumBytesAsUTF8() >= sizeof (address.sun_path))
+        return false;
+
+    std::memcpy (address.sun_path, path.toRawUTF8(), (size_t) path.getNumBytesAsUTF8());
+    return true;
+}
+
+void disableSigPipe (int fd)
+{
+   #if defined (SO_NOSIGPIPE)
+    int enabled = 1;
+    ::setsockopt (fd, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof (enabled));
+   #else
+    juce::ignoreUnused (fd);
+   #endif
+}
+
+/** Writes the framing header and payload with a single sendmsg() where possible. */
+bool writeFrame (int fd, const void* data, size_t numBytes)
+{
+    if (numBytes > maxMessageBytes)
+        return false;
+
+    const uint32_t header[] = { juce::ByteOrder::swapIfBigEndian (messageMagic),
+                                juce::ByteOrder::swapIfBigEndian ((uint32_t) numBytes) };
+
+    iovec parts[2];
+    parts[0].iov_base = const_cast<uint32_t*> (header);
+    parts[0].iov_len = sizeof (header);
+    parts[1].iov_base = const_cast<void*> (data);
+    parts[1].iov_len = numBytes;
+
+    int partIndex = 0;
+    while (partIndex < 2)
+    {
+        msghdr msg {};
+        msg.msg_iov = parts + partIndex;
+        msg.msg_iovlen = (decltype (msg.msg_iovlen)) (2 - partIndex);
+
+        const auto sent = ::sendmsg (fd, &msg, sendFlags);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        auto remaining = (size_t) sent;
+        while (partIndex < 2 && remaining >= parts[partIndex].iov_len)
+            remaining -= parts[partIndex++].iov_len;
+
+        if (partIndex < 2)
+        {
+            parts[partIndex].iov_base = static_cast<char*> (parts[partIndex].iov_base) + remaining;
+            parts[partIndex].iov_len -= remaining;
+        }
+    }
+
+    return true;
+}
+
+ReadResult readFully (int fd, void* dest, size_t numBytes, juce::uint32 deadlineMs, bool hasDeadline)
+{
+    auto* out = static_cast<char*> (dest);
+
+    while (numBytes > 0)
+    {
+        if (hasDeadline)
+        {
+            const auto now = juce::Time::getMillisecondCounter();
+            if (now >= deadlineMs)
+                return ReadResult::timedOut;
+
+            pollfd pfd { fd, POLLIN, 0 };
+            const auto ready = ::poll (&pfd, 1, (int) (deadlineMs - now));
+            if (ready == 0)
+                return ReadResult::timedOut;
+            if (ready < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                return ReadResult::closed;
+            }
+        }
+
+        const auto received = ::recv (fd, out, numBytes, 0);
+        if (received == 0)
+            return ReadResult::closed;
+
+        if (received < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return ReadResult::closed;
+        }
+
+        out += received;
+        numBytes -= (size_t) received;
+    }
+
+    return ReadResult::ok;
+}
+
+/** Reads one framed message. timeoutMs < 0 waits indefinitely. */
+ReadResult readFrame (int fd, juce::MemoryBlock& message, int timeoutMs)
+{
+    const bool hasDeadline = timeoutMs >= 0;
+    const auto deadlineMs = juce::Time::getMillisecondCounter() + (juce::uint32) juce::jmax (0, timeoutMs);
+
+    uint32_t header[2] {};
+    const auto headerResult = readFully (fd, header, sizeof (header), deadlineMs, hasDeadline);
+    if (headerResult != ReadResult::ok)
+        return headerResult;
+
+    const auto size = juce::ByteOrder::swapIfBigEndian (header[1]);
+    if (juce::ByteOrder::swapIfBigEndian (header[0]) != messageMagic || size > maxMessageBytes)
+        return ReadResult::closed;
+
+    message.setSize ((size_t) size, false);
+    if (size == 0)
+        return ReadResult::ok;
+
+    return readFully (fd, message.getData(), (size_t) size, deadlineMs, hasDeadline);
+}
+
+bool writeText (int fd, const juce::String& text)
+{
+    return writeFrame (fd, text.toRawUTF8(), text.getNumBytesAsUTF8());
+}
+#endif
+}
+
+//==============================================================================
+class LocalCommandServer::Connection : public juce::Thread
+{
+public:
+    Connection (int socketFd, CommandCallback callback, BinaryFrameCallback frameCallback,
+                juce::String token, int timeoutMs)
+        : juce::Thread ("Waive local command connection"),
+          fd (socketFd),
+          commandCallback (std::move (callback)),
+          binaryFrameCallback (std::move (frameCallback)),
+          expectedToken (std::move (token)),
+          authTimeoutMs (timeoutMs)
+    {
+    }
+
+    ~Connection() override
+    {
+        close();
+    }
+
+    void close()
+    {
+#if ! JUCE_WINDOWS
+        signalThreadShouldExit();
+
+        if (fd >= 0)
+            ::shutdown (fd, SHUT_RDWR);
+
+        stopThread (2000);
+
+        if (fd >= 0)
+            ::close (fd);
+#endif
+        fd = -1;
+    }
+
+    bool isFinished() const noexcept { return finished.load(); }
+
+    void run() override
+    {
+#if ! JUCE_WINDOWS
+        juce::Logger::writeToLog ("Local client connected. Awaiting authentication...");
+        const auto connectedAtMs = juce::Time::getMillisecondCounter();
+
+        while (! threadShouldExit())
+        {
+            int timeoutMs = -1;
+            if (! authenticated && authTimeoutMs > 0)
+            {
+                timeoutMs = authTimeoutMs - (int) (juce::Time::getMillisecondCounter() - connectedAtMs);
+                if (timeoutMs <= 0)
+                {
+                    juce::Logger::writeToLog ("Authentication timeout - disconnecting");
+                    break;
+                }
+            }
+
+            juce::MemoryBlock message;
+            const auto result = readFrame (fd, message, timeoutMs);
+
+            if (result == ReadResult::timedOut)
+            {
+                juce::Logger::writeToLog ("Authentication timeout - disconnecting");
+                break;
+            }
+
+            if (result != ReadResult::ok || ! handleMessage (message))
+                break;
+        }
+
+        ::shutdown (fd, SHUT_RDWR);
+        juce::Logger::writeToLog ("Local client disconnected.");
+#endif
+        finished = true;
+    }
+
+private:
+#if ! JUCE_WINDOWS
+    bool handleMessage (const juce::MemoryBlock& message)
+    {
+        // High-rate binary frames skip logging, the message-thread hop and the reply.
+        if (authenticated && binaryFrameCallback != nullptr && binaryFrameCallback (message))
+            return true;
+
+        auto text = message.toString();
+
+        if (! authenticated)
+        {
+            if (text.trim() != expectedToken)
+            {
+                juce::Logger::writeToLog ("Invalid authentication token - disconnecting");
+                return false;
+            }
+
+            authenticated = true;
+            juce::Logger::writeToLog ("Local client authenticated successfully");
+            return writeText (fd, "AUTH_OK");
+        }
+
+        if (text.startsWith ("SHM_RING "))
+            return writeText (fd, openSharedMemoryRing (text.fromFirstOccurrenceOf (" ", false, false)));
+
+        juce::Logger::writeToLog ("Received: " + text);
+        return sendResponse (CommandConnection::dispatchOnMessageThread (commandCallback, text, this));
+    }
+
+    juce::String openSharedMemoryRing (const juce::String& requestedSize)
+    {
+        const auto capacity = (size_t) requestedSize.trim().getLargeIntValue();
+        if (capacity < sharedMemoryThreshold || capacity > maxSharedMemoryRingBytes)
+            return "SHM_ERROR invalid ring size";
+
+        ring = SharedMemoryRing::create (capacity);
+        if (ring == nullptr)
+            return "SHM_ERROR failed to create shared memory";
+
+        return "SHM_OK " + ring->getName() + " " + juce::String ((juce::int64) ring->getCapacity());
+    }
+
+    bool sendResponse (const juce::String& response)
+    {
+        const auto numBytes = response.getNumBytesAsUTF8();
+
+        if (ring != nullptr && numBytes >= sharedMemoryThreshold)
+        {
+            // Falls back to the socket if the client hasn't released enough space.
+            const auto position = ring->write (response.toRawUTF8(), numBytes);
+            if (position >= 0)
+                return writeText (fd, "SHM " + juce::String ((juce::int64) position) + " " + juce::String ((juce::int64) numBytes));
+        }
+
+        return writeFrame (fd, response.toRawUTF8(), numBytes);
+    }
+#endif
+
+    int fd = -1;
+    CommandCallback commandCallback;
+    BinaryFrameCallback binaryFrameCallback;
+    juce::String expectedToken;
+    int authTimeoutMs = 5000;
+    bool authenticated = false;
+    std::atomic<bool> finished { false };
+    std::unique_ptr<SharedMemoryRing> ring;
+};
+
+//==============================================================================
+// LocalCommandServer
+//==============================================================================
+
+LocalCommandServer::LocalCommandServer (CommandCallback callback, juce::File file,
+                                        juce::String token, int timeoutMs)
+    : juce::Thread ("Waive local command server"),
+      commandCallback (std::move (callback)),
+      socketFile (std::move (file)),
+      authToken (std::move (token)),
+      authTimeoutMs (timeoutMs)
+{
+}
+
+LocalCommandServer::~LocalCommandServer()
+{
+    stop();
+}
+
+juce::File LocalCommandServer::getDefaultSocketFileForPort (int port)
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+               .getChildFile ("Waive")
+               .getChildFile ("waive_engine_" + juce::String (port) + ".sock");
+}
+
+bool LocalCommandServer::start()
+{
+#if JUCE_WINDOWS
+    juce::Logger::writeToLog ("LocalCommandServer: Unix domain sockets are not supported on this platform");
+    return false;
+#else
+    if (authToken.isEmpty() || isThreadRunning())
+        return false;
+
+    sockaddr_un address {};
+    if (! makeSocketAddress (socketFile, address))
+    {
+        juce::Logger::writeToLog ("LocalCommandServer: socket path too long: " + socketFile.getFullPathName());
+        return false;
+    }
+
+    auto parentDir = socketFile.getParentDirectory();
+    if (! parentDir.exists() && parentDir.createDirectory().failed())
+        return false;
+
+    // Only replace a stale socket; never another file type or a live server.
+    struct stat existing {};
+    if (::lstat (address.sun_path, &existing) == 0)
+    {
+        if (! S_ISSOCK (existing.st_mode))
+            return false;
+
+        const auto probe = ::socket (AF_UNIX, SOCK_STREAM, 0);
+        const bool live = probe >= 0 && ::connect (probe, (const sockaddr*) &address, sizeof (address)) == 0;
+        if (probe >= 0)
+            ::close (probe);
+
+        if (live)
+            return false;
+
+        ::unlink (address.sun_path);
+    }
+
+    const auto fd = ::socket (AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+
+    // bind() creates the socket with the umask applied, so with group and
+    // other masked it is never reachable by another user, even before the
+    // chmod. The umask is process-wide; masking only group and other keeps
+    // files other threads create meanwhile usable by their owner.
+    const auto previousUmask = ::umask (S_IRWXG | S_IRWXO);
+    const auto bound = ::bind (fd, (const sockaddr*) &address, sizeof (address)) == 0;
+    ::umask (previousUmask);
+
+    if (! bound
+        || ::chmod (address.sun_path, S_IRUSR | S_IWUSR) != 0
+        || ::listen (fd, 16) != 0)
+    {
+        ::close (fd);
+        ::unlink (address.sun_path);
+        return false;
+    }
+
+    listenFd = fd;
+    startThread();
+    return true;
+#endif
+}
+
+void LocalCommandServer::stop()
+{
+#if ! JUCE_WINDOWS
+    signalThreadShouldExit();
+    stopThread (2000);
+
+    {
+        const juce::ScopedLock lock (connectionLock);
+        connections.clear();
+    }
+
+    if (listenFd >= 0)
+    {
+        ::close (listenFd);
+        listenFd = -1;
+        ::unlink (socketFile.getFullPathName().toRawUTF8());
+    }
+#endif
+}
+
+void LocalCommandServer::run()
+{
+#if ! JUCE_WINDOWS
+    while (! threadShouldExit())
+    {
+        pollfd pfd { listenFd, POLLIN, 0 };
+        if (::poll (&pfd, 1, acceptPollIntervalMs) <= 0)
+            continue;
+
+        const auto clientFd = ::accept (listenFd, nullptr, nullptr);
+        if (clientFd < 0)
+            continue;
+
+        disableSigPipe (clientFd);
+
+        auto* connection = new Connection (clientFd, commandCallback, binaryFrameCallback,
+                                           authToken, authTimeoutMs);
+
+        removeFinishedConnections();
+
+        const juce::ScopedLock lock (connectionLock);
+        connections.add (connection);
+        connection->startThread();
+    }
+#endif
+}
+
+void LocalCommandServer::removeFinishedConnections()
+{
+    const juce::ScopedLock lock (connectionLock);
+
+    for (int i = connections.size(); --i >= 0;)
+        if (connections.getUnchecked (i)->isFinished())
+            connections.remove (i);
+}
+
+//==============================================================================
+// LocalCommandClient
+//==============================================================================
+
+LocalCommandClient::~LocalCommandClient()
+{
+    disconnect();
+}
+
+bool LocalCommandClient::connect (const juce::File& socketFile)
+{
+#if JUCE_WINDOWS
+    juce::ignoreUnused (socketFile);
+    return false;
+#else
+    disconnect();
+
+    sockaddr_un address {};
+    if (! makeSocketAddress (socketFile, address))
+        return false;
+
+    fd = ::socket (AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+
+    if (::connect (fd, (const sockaddr*) &address, sizeof (address)) != 0)
+    {
+        disconnect();
+        return false;
+    }
+
+    disableSigPipe (fd);
+    return true;
+#endif
+}
+
+void LocalCommandClient::disconnect()
+{
+#if ! JUCE_WINDOWS
+    if (fd >= 0)
+        ::close (fd);
+#endif
+    fd = -1;
+    ring.reset();
+}
+
+bool LocalCommandClient::authenticate (const juce::String& token, int timeoutMs)
+{
+    if (! sendMessage (juce::MemoryBlock (token.toRawUTF8(), token.getNumBytesAsUTF8())))
+        return false;
+
+    juce::MemoryBlock reply;
+    return receiveMessage (reply, timeoutMs) && reply.toString() == "AUTH_OK";
+}
+
+bool LocalCommandClient::openSharedMemoryRing (size_t capacityBytes, int timeoutMs)
+{
+    const auto request = "SHM_RING " + juce::String ((juce::int64) capacityBytes);
+    if (! sendMessage (juce::MemoryBlock (request.toRawUTF8(), request.getNumBytesAsUTF8())))
+        return false;
+
+    juce::MemoryBlock reply;
+    if (! receiveMessage (reply, timeoutMs))
+        return false;
+
+    const auto tokens = juce::StringArray::fromTokens (reply.toString(), " ", {});
+    if (tokens.size() != 3 || tokens[0] != "SHM_OK")
+        return false;
+
+    ring = SharedMemoryRing::open (tokens[1]);
+    return ring != nullptr;
+}
+
+bool LocalCommandClient::sendMessage (const juce::MemoryBlock& message)
+{
+#if JUCE_WINDOWS
+    juce::ignoreUnused (message);
+    return false;
+#else
+    return fd >= 0 && writeFrame (fd, message.getData(), message.getSize());
+#endif
+}
+
+bool LocalCommandClient::receiveMessage (juce::MemoryBlock& message, int timeoutMs)
+{
+#if JUCE_WINDOWS
+    juce::ignoreUnused (message, timeoutMs);
+    return false;
+#else
+    if (fd < 0)
+        return false;
+
+    const auto result = readFrame (fd, message, timeoutMs);
+    if (result == ReadResult::closed)
+        disconnect();
+
+    if (result != ReadResult::ok)
+        return false;
+
+    if (ring == nullptr || message.getSize() < 4 || std::memcmp (message.getData(), "SHM ", 4) != 0)
+        return true;
+
+    const auto tokens = juce::StringArray::fromTokens (message.toString(), " ", {});
+    if (tokens.size() != 3)
+        return false;
+
+    juce::MemoryBlock payload;
+    if (! ring->read (tokens[1].getLargeIntValue(), (size_t) tokens[2].getLargeIntValue(), payload))
+        return false;
+
+    ++sharedMemoryPayloads;
+    message.swapWith (payload);
+    return true;
+#endif
+}
+
+juce::String LocalCommandClient::sendCommand (const juce::String& json, int timeoutMs)
+{
+    juce::MemoryBlock response;
+    if (! sendMessage (juce::MemoryBlock (json.toRawUTF8(), json.getNumBytesAsUTF8()))
+        || ! receiveMessage (response, timeoutMs))
+        return {};
+
+    return response.toString();
+}
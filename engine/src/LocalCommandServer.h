@@ -0,0 +1,104 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CommandServer.h"
+#include "SharedMemoryRing.h"
+
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+/** Unix-domain-socket command listener for clients on the same machine.
+
+    Speaks the same protocol as CommandServer: InterprocessConnection framing
+    (magic + length header), an auth token as the first message, then JSON
+    commands. Only the transport differs, so clients swap the address and
+    nothing else.
+
+    After authenticating, a client may send "SHM_RING <bytes>" to get a
+    SharedMemoryRing. The server replies "SHM_OK <name> <capacity>". From then
+    on, responses of at least sharedMemoryThreshold bytes are written into the
+    ring and announced with a short "SHM <position> <length>" message instead
+    of being copied through the socket.
+
+    Not available on Windows; start() returns false there. */
+class LocalCommandServer : private juce::Thread
+{
+public:
+    using CommandCallback = CommandConnection::CommandCallback;
+    using BinaryFrameCallback = CommandConnection::BinaryFrameCallback;
+
+    LocalCommandServer (CommandCallback callback, juce::File socketFile,
+                        juce::String authToken, int authTimeoutMs = 5000);
+    ~LocalCommandServer() override;
+
+    /** Same semantics as CommandServer::setBinaryFrameCallback(). */
+    void setBinaryFrameCallback (BinaryFrameCallback callback) { binaryFrameCallback = std::move (callback); }
+
+    bool start();
+    void stop();
+
+    juce::File getSocketFile() const { return socketFile; }
+
+    /** Default socket path next to the TCP server's auth token file. */
+    static juce::File getDefaultSocketFileForPort (int port);
+
+    static constexpr size_t sharedMemoryThreshold = 64 * 1024;
+    static constexpr size_t maxSharedMemoryRingBytes = 256 * 1024 * 1024;
+
+private:
+    class Connection;
+
+    void run() override;
+    void removeFinishedConnections();
+
+    CommandCallback commandCallback;
+    BinaryFrameCallback binaryFrameCallback;
+    juce::File socketFile;
+    juce::String authToken;
+    int authTimeoutMs = 5000;
+    int listenFd = -1;
+
+    juce::OwnedArray<Connection> connections;
+    juce::CriticalSection connectionLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LocalCommandServer)
+};
+
+//==============================================================================
+/** Minimal blocking client for LocalCommandServer. It is the reference
+    implementation of the local protocol and is used by tests and benchmarks. */
+class LocalCommandClient
+{
+public:
+    LocalCommandClient() = default;
+    ~LocalCommandClient();
+
+    bool connect (const juce::File& socketFile);
+    void disconnect();
+    bool isConnected() const noexcept  { return fd >= 0; }
+
+    /** Sends the auth token and waits for AUTH_OK. */
+    bool authenticate (const juce::String& token, int timeoutMs = 1000);
+
+    /** Asks the server for a shared-memory ring for large responses. */
+    bool openSharedMemoryRing (size_t capacityBytes, int timeoutMs = 1000);
+
+    bool sendMessage (const juce::MemoryBlock& message);
+
+    /** Waits for the next message, copying shared-memory payloads out of the
+        ring. Returns false on timeout or disconnect. */
+    bool receiveMessage (juce::MemoryBlock& message, int timeoutMs);
+
+    /** Sends a JSON command and returns the response (empty on failure). */
+    juce::String sendCommand (const juce::String& json, int timeoutMs = 5000);
+
+    int getNumSharedMemoryPayloads() const noexcept  { return sharedMemoryPayloads; }
+
+private:
+    int fd = -1;
+    std::unique_ptr<SharedMemoryRing> ring;
+    int sharedMemoryPayloads = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (LocalCommandClient)
+};
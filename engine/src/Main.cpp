@@ -1,12 +1,31 @@
 #include <JuceHeader.h>
 #include <tracktion_engine/tracktion_engine.h>
 #include "CommandServer.h"
-#include "CommandHandler.h"
-#include "EditSession.h"
-#include "UndoableCommandHandler.h"
+#include "EditHost.h"
+#include "LocalCommandServer.h"
+#include "ParameterStream.h"
+#include "StartupProfile.h"
+
+#include <atomic>
 
 namespace te = tracktion;
 
+namespace
+{
+/** Leaves the audio device closed until a command needs it (--lean). */
+struct LeanEngineBehaviour : public te::EngineBehaviour
+{
+    bool autoInitialiseDeviceManager() override { return false; }
+};
+
+bool needsAudioDevice (const juce::String& action)
+{
+    return action == "transport_play"
+        || action == "arm_track"
+        || action == "record_from_mic";
+}
+}
+
 //==============================================================================
 class WaiveApplication : public juce::JUCEApplicationBase
 {
@@ -24,37 +43,61 @@ public:
 
         juce::Logger::writeToLog ("Waive Engine v0.1.0 starting...");
 
+        const auto args = juce::StringArray::fromTokens (commandLine, true);
+
+        // --lean: accept commands as soon as the server is up. The plugin list
+        // (read from the cached scan in the engine settings, never rescanned),
+        // the default edit and the audio device are brought up on first use.
+        leanStartup = args.contains ("--lean");
+
         // ── Tracktion Engine ────────────────────────────────────────────
-        engine = std::make_unique<te::Engine> ("Waive");
-        engine->getPluginManager().initialise();
+        startupProfile.measure ("engine", [this]
+        {
+            if (leanStartup)
+                engine = std::make_unique<te::Engine> ("Waive", nullptr, std::make_unique<LeanEngineBehaviour>());
+            else
+                engine = std::make_unique<te::Engine> ("Waive");
+        });
 
-        editSession = std::make_unique<EditSession> (*engine);
-        edit = &editSession->getEdit();
-        juce::Logger::writeToLog ("Edit created with 1 audio track.");
+        if (! leanStartup)
+            ensureEditHost();
 
         // ── Command layer ───────────────────────────────────────────────
-        commandHandler = std::make_unique<CommandHandler> (*edit);
-        undoableHandler = std::make_unique<UndoableCommandHandler> (*commandHandler, *editSession);
-        commandServer  = std::make_unique<CommandServer> (
-            [this] (const juce::String& json)
+        startupProfile.measure ("command_server", [this]
+        {
+            commandServer  = std::make_unique<CommandServer> (
+                [this] (const juce::String& json)
+                {
+                    return handleCommand (json);
+                },
+                port);
+            commandServer->setBinaryFrameCallback ([this] (const juce::MemoryBlock& frame)
             {
-                return undoableHandler->handleCommand (json);
-            },
-            port);
+                return pushParameterFrame (frame);
+            });
+
+            commandServerStarted = commandServer->start();
+        });
 
-        if (commandServer->start())
+        if (commandServerStarted)
             juce::Logger::writeToLog ("Command server listening on port " + juce::String (port));
         else
             juce::Logger::writeToLog ("ERROR: Failed to start command server on port " + juce::String (port));
+
+        // Optional same-host transport; shares the TCP server's auth token.
+        if (args.contains ("--unix-socket") && commandServer->getAuthToken().isNotEmpty())
+            startupProfile.measure ("local_command_server", [this] { startLocalCommandServer(); });
+
+        startupProfile.markReady();
+        juce::Logger::writeToLog ("Startup " + startupProfile.toString());
     }
 
     void shutdown() override
     {
+        localCommandServer.reset();
         commandServer.reset();
-        undoableHandler.reset();
-        commandHandler.reset();
-        edit = nullptr;
-        editSession.reset();
+        parameterStream = nullptr;
+        editHost.reset();
         engine.reset();
 
         juce::Logger::writeToLog ("Waive Engine shut down.");
@@ -69,12 +112,84 @@ public:
 private:
     static constexpr int port = 9090;
 
+    juce::String handleCommand (const juce::String& json)
+    {
+        ensureEditHost();
+        return editHost->handleCommand (json);
+    }
+
+    bool pushParameterFrame (const juce::MemoryBlock& frame)
+    {
+        // Called on connection threads; streams only exist once a command has
+        // created the edit host, so earlier frames are left to the JSON path.
+        if (auto* stream = parameterStream.load())
+            return stream->pushFrame (frame.getData(), frame.getSize());
+
+        return false;
+    }
+
+    void ensureEditHost()
+    {
+        if (editHost != nullptr)
+            return;
+
+        // Built-in plugin types must be registered before any edit is created.
+        startupProfile.measure ("plugin_manager", [this] { engine->getPluginManager().initialise(); }, leanStartup);
+        startupProfile.measure ("default_edit", [this] { editHost = std::make_unique<EditHost> (*engine); }, leanStartup);
+
+        editHost->setStartupProfile (&startupProfile);
+        parameterStream = &editHost->getParameterStream();
+
+        if (leanStartup)
+        {
+            editHost->onBeforeCommand = [this] (const juce::String& action)
+            {
+                if (! audioDeviceInitialised && needsAudioDevice (action))
+                {
+                    audioDeviceInitialised = true;
+                    startupProfile.measure ("audio_device", [this] { engine->getDeviceManager().initialise(); }, true);
+                    juce::Logger::writeToLog ("Audio device initialised on first use by " + action);
+                }
+            };
+
+            juce::Logger::writeToLog ("Lazy startup finished: " + startupProfile.toString());
+        }
+        else
+        {
+            juce::Logger::writeToLog ("Default edit created with 1 audio track.");
+        }
+    }
+
+    void startLocalCommandServer()
+    {
+        localCommandServer = std::make_unique<LocalCommandServer> (
+            [this] (const juce::String& json)
+            {
+                return handleCommand (json);
+            },
+            LocalCommandServer::getDefaultSocketFileForPort (port),
+            commandServer->getAuthToken());
+        localCommandServer->setBinaryFrameCallback ([this] (const juce::MemoryBlock& frame)
+        {
+            return pushParameterFrame (frame);
+        });
+
+        const auto socketPath = localCommandServer->getSocketFile().getFullPathName();
+        if (localCommandServer->start())
+            juce::Logger::writeToLog ("Local command server listening on " + socketPath);
+        else
+            juce::Logger::writeToLog ("ERROR: Failed to start local command server on " + socketPath);
+    }
+
     std::unique_ptr<te::Engine>         engine;
-    std::unique_ptr<EditSession>        editSession;
-    te::Edit*                           edit = nullptr;
-    std::unique_ptr<CommandHandler>     commandHandler;
-    std::unique_ptr<UndoableCommandHandler> undoableHandler;
+    std::unique_ptr<EditHost>           editHost;
+    std::atomic<ParameterStream*>       parameterStream { nullptr };
+    StartupProfile                      startupProfile;
+    bool                                leanStartup = false;
+    bool                                audioDeviceInitialised = false;
+    bool                                commandServerStarted = false;
     std::unique_ptr<CommandServer>      commandServer;
+    std::unique_ptr<LocalCommandServer> localCommandServer;
 };
 
 //==============================================================================
@@ -0,0 +1,186 @@
+#include "SharedMemoryRing.h"
+
+#include <atomic>
+#include <cstring>
+
+#if ! JUCE_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct SharedMemoryRing::Header
+{
+    static constexpr uint32_t expectedMagic = 0x4d485357; // "WSHM"
+    static constexpr uint32_t expectedVersion = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    alignas (64) std::atomic<uint64_t> writePosition;
+    alignas (64) std::atomic<uint64_t> readPosition;
+};
+
+namespace
+{
+constexpr size_t headerBytes = 192;
+static_assert (sizeof (std::atomic<uint64_t>) == sizeof (uint64_t)
+               && std::atomic<uint64_t>::is_always_lock_free,
+               "Shared-memory positions must be lock-free across processes");
+}
+
+SharedMemoryRing::SharedMemoryRing (juce::String segmentName, void* mappedMemory, size_t size, bool owner)
+    : name (std::move (segmentName)), mapping (mappedMemory), mappingSize (size), ownsSegment (owner)
+{
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+#if ! JUCE_WINDOWS
+    if (mapping != nullptr)
+        ::munmap (mapping, mappingSize);
+
+    if (ownsSegment)
+        ::shm_unlink (name.toRawUTF8());
+#endif
+}
+
+SharedMemoryRing::Header& SharedMemoryRing::header() const noexcept
+{
+    return *static_cast<Header*> (mapping);
+}
+
+uint8_t* SharedMemoryRing::payload() const noexcept
+{
+    return static_cast<uint8_t*> (mapping) + headerBytes;
+}
+
+size_t SharedMemoryRing::getCapacity() const noexcept
+{
+    return (size_t) header().capacity;
+}
+
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::create (size_t capacityBytes)
+{
+#if JUCE_WINDOWS
+    juce::ignoreUnused (capacityBytes);
+    return nullptr;
+#else
+    static_assert (sizeof (Header) <= headerBytes, "Shared-memory ring header too large");
+
+    if (capacityBytes == 0)
+        return nullptr;
+
+    const auto segmentName = "/waive-" + juce::String (::getpid()) + "-"
+                             + juce::String::toHexString (juce::Random::getSystemRandom().nextInt64());
+    const auto fd = ::shm_open (segmentName.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+        return nullptr;
+
+    const auto size = headerBytes + capacityBytes;
+    if (::ftruncate (fd, (off_t) size) != 0)
+    {
+        ::close (fd);
+        ::shm_unlink (segmentName.toRawUTF8());
+        return nullptr;
+    }
+
+    auto* mapped = ::mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close (fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        ::shm_unlink (segmentName.toRawUTF8());
+        return nullptr;
+    }
+
+    auto* header = new (mapped) Header();
+    header->magic = Header::expectedMagic;
+    header->version = Header::expectedVersion;
+    header->capacity = capacityBytes;
+    header->writePosition.store (0);
+    header->readPosition.store (0);
+
+    return std::unique_ptr<SharedMemoryRing> (new SharedMemoryRing (segmentName, mapped, size, true));
+#endif
+}
+
+std::unique_ptr<SharedMemoryRing> SharedMemoryRing::open (const juce::String& segmentName)
+{
+#if JUCE_WINDOWS
+    juce::ignoreUnused (segmentName);
+    return nullptr;
+#else
+    const auto fd = ::shm_open (segmentName.toRawUTF8(), O_RDWR, 0);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat segmentStat {};
+    if (::fstat (fd, &segmentStat) != 0 || (size_t) segmentStat.st_size <= headerBytes)
+    {
+        ::close (fd);
+        return nullptr;
+    }
+
+    const auto size = (size_t) segmentStat.st_size;
+    auto* mapped = ::mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close (fd);
+
+    if (mapped == MAP_FAILED)
+        return nullptr;
+
+    const auto* header = static_cast<const Header*> (mapped);
+    if (header->magic != Header::expectedMagic
+        || header->version != Header::expectedVersion
+        || header->capacity != size - headerBytes)
+    {
+        ::munmap (mapped, size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<SharedMemoryRing> (new SharedMemoryRing (segmentName, mapped, size, false));
+#endif
+}
+
+int64_t SharedMemoryRing::write (const void* data, size_t numBytes)
+{
+    auto& h = header();
+    const auto capacity = h.capacity;
+
+    if (numBytes == 0 || numBytes > capacity)
+        return -1;
+
+    const auto writePosition = h.writePosition.load (std::memory_order_relaxed);
+    const auto readPosition = h.readPosition.load (std::memory_order_acquire);
+
+    // Payloads are contiguous: skip the tail if this one would straddle the end.
+    auto start = writePosition;
+    const auto offset = start % capacity;
+    if (offset + numBytes > capacity)
+        start += capacity - offset;
+
+    if (start + numBytes - readPosition > capacity)
+        return -1;
+
+    std::memcpy (payload() + (start % capacity), data, numBytes);
+    h.writePosition.store (start + numBytes, std::memory_order_release);
+    return (int64_t) start;
+}
+
+bool SharedMemoryRing::read (int64_t position, size_t numBytes, juce::MemoryBlock& dest)
+{
+    auto& h = header();
+    const auto capacity = h.capacity;
+    const auto start = (uint64_t) position;
+
+    if (position < 0 || numBytes == 0 || numBytes > capacity
+        || (start % capacity) + numBytes > capacity
+        || start < h.readPosition.load (std::memory_order_relaxed)
+        || start + numBytes > h.writePosition.load (std::memory_order_acquire))
+        return false;
+
+    dest.replaceAll (payload() + (start % capacity), numBytes);
+    h.readPosition.store (start + numBytes, std::memory_order_release);
+    return true;
+}
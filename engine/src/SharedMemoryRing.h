@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <memory>
+
+//==============================================================================
+/** Single-producer / single-consumer byte ring in a POSIX shared-memory segment.
+
+    The engine creates the segment and writes bulk payloads (large responses)
+    into it. A local client maps the same segment by name, copies each payload
+    out at the position the engine announced over the control socket, and then
+    publishes how far it has consumed so the space can be reused.
+
+    Positions are monotonically increasing byte counts; a payload never wraps,
+    so one that does not fit before the end of the buffer starts at offset 0.
+
+    Not available on Windows: create() and open() return nullptr there. */
+class SharedMemoryRing
+{
+public:
+    ~SharedMemoryRing();
+
+    /** Creates a new, uniquely named segment owned by this process. The segment
+        is unlinked when the returned object is destroyed. */
+    static std::unique_ptr<SharedMemoryRing> create (size_t capacityBytes);
+
+    /** Maps an existing segment created by another process. */
+    static std::unique_ptr<SharedMemoryRing> open (const juce::String& name);
+
+    const juce::String& getName() const noexcept  { return name; }
+    size_t getCapacity() const noexcept;
+
+    /** Producer side. Copies the payload into the ring and returns its position,
+        or -1 if the consumer has not released enough space. */
+    int64_t write (const void* data, size_t numBytes);
+
+    /** Consumer side. Copies the payload written at position into dest and
+        releases it (and anything before it) back to the producer. */
+    bool read (int64_t position, size_t numBytes, juce::MemoryBlock& dest);
+
+private:
+    struct Header;
+
+    SharedMemoryRing (juce::String name, void* mapping, size_t mappingSize, bool owner);
+
+    Header& header() const noexcept;
+    uint8_t* payload() const noexcept;
+
+    juce::String name;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    bool ownsSegment = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedMemoryRing)
+};
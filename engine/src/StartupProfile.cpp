@@ -0,0 +1,49 @@
+#include "StartupProfile.h"
+
+StartupProfile::StartupProfile()
+    : startMs (juce::Time::getMillisecondCounterHiRes())
+{
+}
+
+void StartupProfile::addPhase (const juce::String& name, double durationMs, bool deferred)
+{
+    phases.add ({ name, durationMs, deferred });
+}
+
+void StartupProfile::markReady()
+{
+    readyMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+}
+
+juce::var StartupProfile::toVar() const
+{
+    juce::Array<juce::var> phaseList;
+    double totalMs = 0.0;
+
+    for (const auto& phase : phases)
+    {
+        auto* info = new juce::DynamicObject();
+        info->setProperty ("name", phase.name);
+        info->setProperty ("ms", phase.durationMs);
+        info->setProperty ("deferred", phase.deferred);
+        phaseList.add (juce::var (info));
+        totalMs += phase.durationMs;
+    }
+
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("ready_ms", readyMs);
+    obj->setProperty ("phases", phaseList);
+    obj->setProperty ("total_ms", totalMs);
+    return juce::var (obj);
+}
+
+juce::String StartupProfile::toString() const
+{
+    juce::StringArray parts;
+
+    for (const auto& phase : phases)
+        parts.add (phase.name + " " + juce::String (phase.durationMs, 1) + " ms"
+                   + (phase.deferred ? " (deferred)" : ""));
+
+    return "ready in " + juce::String (readyMs, 1) + " ms (" + parts.joinIntoString (", ") + ")";
+}
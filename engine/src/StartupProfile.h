@@ -0,0 +1,47 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Timing breakdown of the headless engine's startup.
+
+    Phases are recorded in the order they run. A phase marked deferred ran
+    lazily after the command server was already accepting connections (lean
+    startup), so it counts towards total_ms but not ready_ms. */
+class StartupProfile
+{
+public:
+    StartupProfile();
+
+    /** Runs fn and records its wall-clock time under name. */
+    template <typename Fn>
+    void measure (const juce::String& name, Fn&& fn, bool deferred = false)
+    {
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        fn();
+        addPhase (name, juce::Time::getMillisecondCounterHiRes() - start, deferred);
+    }
+
+    void addPhase (const juce::String& name, double durationMs, bool deferred = false);
+
+    /** Call once the command server accepts connections. */
+    void markReady();
+
+    /** { ready_ms, phases: [{ name, ms, deferred }], total_ms } */
+    juce::var toVar() const;
+
+    /** One-line summary for the log, e.g. "ready in 4.1 ms (engine 3.2 ms, ...)". */
+    juce::String toString() const;
+
+private:
+    struct Phase
+    {
+        juce::String name;
+        double durationMs = 0.0;
+        bool deferred = false;
+    };
+
+    double startMs = 0.0;
+    double readyMs = -1.0;
+    juce::Array<Phase> phases;
+};
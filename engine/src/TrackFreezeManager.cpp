@@ -0,0 +1,535 @@
+#include "TrackFreezeManager.h"
+#include "RenderScheduler.h"
+
+namespace
+{
+const juce::Identifier freezeHashId ("waiveFreezeHash");
+const juce::Identifier freezeFileId ("waiveFreezeFile");
+const juce::Identifier freezeTailId ("waiveFreezeTailMs");
+const juce::Identifier freezeClipId ("waiveFreezeClip");
+const juce::Identifier restoreMuteId ("waiveFreezeRestoreMute");
+const juce::Identifier restoreEnabledId ("waiveFreezeRestoreEnabled");
+
+bool isFreezablePlugin (te::Plugin* plugin)
+{
+    return plugin != nullptr
+        && dynamic_cast<te::VolumeAndPanPlugin*> (plugin) == nullptr
+        && dynamic_cast<te::LevelMeterPlugin*> (plugin) == nullptr;
+}
+
+bool isFreezeClip (const te::Clip& clip)
+{
+    return clip.state.hasProperty (freezeClipId);
+}
+
+bool hasFreezeClip (te::AudioTrack& track)
+{
+    for (auto* clip : track.getClips())
+        if (isFreezeClip (*clip))
+            return true;
+
+    return false;
+}
+
+/** Rewrites a copy of a track's state to what it was before freezing. Mixer
+    and display properties are dropped too, since the render doesn't depend
+    on them. Mute/enabled defaults are removed so that "never set" and "set
+    back to the default" hash the same. */
+void normaliseForHash (juce::ValueTree& node, bool isRoot)
+{
+    if (isRoot)
+    {
+        for (const auto& id : { freezeHashId, freezeFileId, freezeTailId, te::IDs::name, te::IDs::colour,
+                                te::IDs::height, te::IDs::mute, te::IDs::solo, te::IDs::soloIsolate })
+            node.removeProperty (id, nullptr);
+    }
+
+    for (int i = node.getNumChildren(); --i >= 0;)
+    {
+        auto child = node.getChild (i);
+
+        if (child.hasProperty (freezeClipId)
+            || (child.hasType (te::IDs::PLUGIN)
+                && child[te::IDs::type].toString() == te::VolumeAndPanPlugin::xmlTypeName))
+        {
+            node.removeChild (i, nullptr);
+            continue;
+        }
+
+        if (child.hasProperty (restoreMuteId))
+        {
+            child.setProperty (te::IDs::mute, child[restoreMuteId], nullptr);
+            child.removeProperty (restoreMuteId, nullptr);
+        }
+
+        if (child.hasProperty (restoreEnabledId))
+        {
+            child.setProperty (te::IDs::enabled, child[restoreEnabledId], nullptr);
+            child.removeProperty (restoreEnabledId, nullptr);
+        }
+
+        if (child.hasProperty (te::IDs::mute) && ! (bool) child[te::IDs::mute])
+            child.removeProperty (te::IDs::mute, nullptr);
+
+        if (child.hasType (te::IDs::PLUGIN) && child.hasProperty (te::IDs::enabled) && (bool) child[te::IDs::enabled])
+            child.removeProperty (te::IDs::enabled, nullptr);
+
+        normaliseForHash (child, false);
+    }
+}
+
+/** Rewrites a copy of a frozen track's state to play live again, the way
+    unfreeze() would, without touching the edit. */
+void thawForRender (juce::ValueTree& node, bool isRoot)
+{
+    if (isRoot)
+        for (const auto& id : { freezeHashId, freezeFileId, freezeTailId })
+            node.removeProperty (id, nullptr);
+
+    for (int i = node.getNumChildren(); --i >= 0;)
+    {
+        auto child = node.getChild (i);
+
+        if (child.hasProperty (freezeClipId))
+        {
+            node.removeChild (i, nullptr);
+            continue;
+        }
+
+        if (child.hasProperty (restoreMuteId))
+        {
+            child.setProperty (te::IDs::mute, child[restoreMuteId], nullptr);
+            child.removeProperty (restoreMuteId, nullptr);
+        }
+
+        if (child.hasProperty (restoreEnabledId))
+        {
+            child.setProperty (te::IDs::enabled, child[restoreEnabledId], nullptr);
+            child.removeProperty (restoreEnabledId, nullptr);
+        }
+
+        thawForRender (child, false);
+    }
+}
+
+juce::ValueTree findTrackState (const juce::ValueTree& root, const juce::String& itemId)
+{
+    for (const auto& child : root)
+    {
+        if (te::TrackList::isTrack (child) && child[te::IDs::id].toString() == itemId)
+            return child;
+
+        if (auto found = findTrackState (child, itemId); found.isValid())
+            return found;
+    }
+
+    return {};
+}
+
+void clearSoloRecursive (juce::ValueTree node)
+{
+    for (auto child : node)
+    {
+        if (te::TrackList::isTrack (child))
+        {
+            child.removeProperty (te::IDs::solo, nullptr);
+            child.removeProperty (te::IDs::soloIsolate, nullptr);
+        }
+
+        clearSoloRecursive (child);
+    }
+}
+
+int toTailMillis (double tailSeconds)
+{
+    return juce::roundToInt (juce::jmax (0.0, tailSeconds) * 1000.0);
+}
+}
+
+//==============================================================================
+TrackFreezeManager::TrackFreezeManager (te::Edit& e)
+    : edit (e),
+      tempoState (edit.state.getChildWithName (te::IDs::TEMPOSEQUENCE))
+{
+    tempoState.addListener (this);
+    updateWatchedTracks();
+}
+
+TrackFreezeManager::~TrackFreezeManager()
+{
+    tempoState.removeListener (this);
+
+    for (auto* trackState : watchedTracks)
+        trackState->removeListener (this);
+}
+
+bool TrackFreezeManager::isFrozen (const te::AudioTrack& track)
+{
+    return track.state.hasProperty (freezeHashId);
+}
+
+juce::File TrackFreezeManager::getFreezeFile (const te::AudioTrack& track)
+{
+    return isFrozen (track) ? juce::File (track.state[freezeFileId].toString()) : juce::File();
+}
+
+juce::String TrackFreezeManager::computeContentHash (te::AudioTrack& track)
+{
+    // External plugins only write their state back on a flush, so a tweak
+    // made in a plugin window would otherwise leave the hash unchanged.
+    for (auto* plugin : track.pluginList)
+        if (isFreezablePlugin (plugin))
+            plugin->flushPluginStateToValueTree();
+
+    auto view = track.state.createCopy();
+    normaliseForHash (view, true);
+
+    juce::String key = view.toXmlString (juce::XmlElement::TextFormat().singleLine());
+    key << edit.state.getChildWithName (te::IDs::TEMPOSEQUENCE).toXmlString (juce::XmlElement::TextFormat().singleLine());
+
+    // Re-recorded or replaced source files change the render too.
+    for (auto* clip : track.getClips())
+    {
+        if (auto* waveClip = dynamic_cast<te::WaveAudioClip*> (clip); waveClip != nullptr && ! isFreezeClip (*clip))
+        {
+            const auto file = waveClip->getSourceFileReference().getFile();
+            key << file.getFullPathName() << ':' << file.getSize() << ':' << file.getLastModificationTime().toMilliseconds();
+        }
+    }
+
+    return juce::String::toHexString (key.hashCode64());
+}
+
+bool TrackFreezeManager::renderFreeze (te::AudioTrack& track, const juce::File& destFile, te::TimeRange range)
+{
+    // Render from a snapshot with the fader at unity, no fader automation and no
+    // solos elsewhere, so the file is the track's pre-fader signal.
+    edit.flushState();
+    auto state = edit.state.createCopy();
+    auto trackState = findTrackState (state, track.itemID.toString());
+    if (! trackState.isValid())
+        return false;
+
+    clearSoloRecursive (state);
+    trackState.removeProperty (te::IDs::mute, nullptr);
+
+    for (auto pluginState : trackState.getChildWithName (te::IDs::PLUGINS))
+    {
+        if (pluginState[te::IDs::type].toString() != te::VolumeAndPanPlugin::xmlTypeName)
+            continue;
+
+        pluginState.setProperty (te::IDs::volume, te::decibelsToVolumeFaderPosition (0.0f), nullptr);
+        pluginState.setProperty (te::IDs::pan, 0.0f, nullptr);
+        pluginState.removeAllChildren (nullptr);
+    }
+
+    auto snapshot = waive::RenderScheduler::createSnapshotEdit (edit.engine, state, edit.editFileRetriever());
+    if (snapshot == nullptr)
+        return false;
+
+    auto* snapshotTrack = te::findTrackForID (*snapshot, track.itemID);
+    if (snapshotTrack == nullptr)
+        return false;
+
+    juce::BigInteger tracksMask;
+    tracksMask.setBit (snapshotTrack->getIndexInEditTrackList());
+
+    juce::WavAudioFormat format;
+    juce::TemporaryFile tempFile (destFile);
+
+    te::Renderer::Parameters params (*snapshot);
+    params.destFile = tempFile.getFile();
+    params.audioFormat = &format;
+    params.bitDepth = 32;
+    params.time = range;
+    params.tracksToDo = tracksMask;
+    params.usePlugins = true;
+    params.useMasterPlugins = false;
+
+    if (te::Renderer::renderToFile ("Freeze: " + track.getName(), params) == juce::File())
+        return false;
+
+    return tempFile.overwriteTargetFileWithTemporary();
+}
+
+TrackFreezeManager::FreezeResult TrackFreezeManager::freeze (te::AudioTrack& track,
+                                                             const juce::File& cacheDirectory,
+                                                             double tailSeconds)
+{
+    FreezeResult result;
+    const auto tailMillis = toTailMillis (tailSeconds);
+
+    if (isFrozen (track) && (isStale (track) || (int) track.state[freezeTailId] != tailMillis))
+        unfreeze (track);
+
+    if (isFrozen (track))
+    {
+        result.ok = true;
+        result.reusedCache = true;
+        result.cacheFile = getFreezeFile (track);
+        for (auto* clip : track.getClips())
+            if (isFreezeClip (*clip))
+                result.range = clip->getPosition().time;
+        return result;
+    }
+
+    auto clips = track.getClips();
+    if (clips.isEmpty())
+    {
+        result.error = "Track has no clips to freeze";
+        return result;
+    }
+
+    auto start = clips.getFirst()->getPosition().getStart();
+    auto end = clips.getFirst()->getPosition().getEnd();
+    for (auto* clip : clips)
+    {
+        start = juce::jmin (start, clip->getPosition().getStart());
+        end = juce::jmax (end, clip->getPosition().getEnd());
+    }
+
+    result.range = te::TimeRange (start, end + te::TimeDuration::fromSeconds (tailMillis / 1000.0));
+
+    if (cacheDirectory.createDirectory().failed())
+    {
+        result.error = "Failed to create freeze cache directory";
+        return result;
+    }
+
+    const auto hash = computeContentHash (track);
+    result.cacheFile = cacheDirectory.getChildFile (track.itemID.toString() + "_" + hash
+                                                    + "_" + juce::String (tailMillis) + "ms.wav");
+    result.reusedCache = result.cacheFile.existsAsFile();
+
+    if (! result.reusedCache && ! renderFreeze (track, result.cacheFile, result.range))
+    {
+        result.error = "Freeze render failed";
+        return result;
+    }
+
+    auto* undoManager = &edit.getUndoManager();
+    const juce::ScopedValueSetter<bool> applying (applyingFreeze, true);
+
+    for (auto* plugin : track.pluginList)
+    {
+        if (! isFreezablePlugin (plugin))
+            continue;
+
+        plugin->state.setProperty (restoreEnabledId, plugin->isEnabled(), undoManager);
+        plugin->setEnabled (false);
+    }
+
+    for (auto* clip : clips)
+    {
+        clip->state.setProperty (restoreMuteId, clip->isMuted(), undoManager);
+        clip->setMuted (true);
+    }
+
+    auto freezeClip = track.insertWaveClip (track.getName() + " (frozen)",
+                                            result.cacheFile,
+                                            { result.range, te::TimeDuration() },
+                                            false);
+    if (freezeClip == nullptr)
+    {
+        unfreeze (track);
+        result.error = "Failed to insert the freeze clip";
+        return result;
+    }
+
+    freezeClip->state.setProperty (freezeClipId, true, undoManager);
+    track.state.setProperty (freezeFileId, result.cacheFile.getFullPathName(), undoManager);
+    track.state.setProperty (freezeTailId, tailMillis, undoManager);
+    track.state.setProperty (freezeHashId, hash, undoManager);
+    watchTrack (track.state);
+
+    result.ok = true;
+    return result;
+}
+
+bool TrackFreezeManager::unfreeze (te::AudioTrack& track)
+{
+    const bool wasFrozen = isFrozen (track);
+    auto* undoManager = &edit.getUndoManager();
+    const juce::ScopedValueSetter<bool> applying (applyingFreeze, true);
+
+    for (auto* clip : track.getClips())
+    {
+        if (isFreezeClip (*clip))
+        {
+            clip->removeFromParent();
+            continue;
+        }
+
+        if (clip->state.hasProperty (restoreMuteId))
+        {
+            clip->setMuted ((bool) clip->state[restoreMuteId]);
+            clip->state.removeProperty (restoreMuteId, undoManager);
+        }
+    }
+
+    for (auto* plugin : track.pluginList)
+    {
+        if (plugin != nullptr && plugin->state.hasProperty (restoreEnabledId))
+        {
+            plugin->setEnabled ((bool) plugin->state[restoreEnabledId]);
+            plugin->state.removeProperty (restoreEnabledId, undoManager);
+        }
+    }
+
+    track.state.removeProperty (freezeHashId, undoManager);
+    track.state.removeProperty (freezeFileId, undoManager);
+    track.state.removeProperty (freezeTailId, undoManager);
+    return wasFrozen;
+}
+
+bool TrackFreezeManager::isStale (te::AudioTrack& track)
+{
+    return isFrozen (track)
+        && (track.state[freezeHashId].toString() != computeContentHash (track)
+            || ! getFreezeFile (track).existsAsFile()
+            || ! hasFreezeClip (track));
+}
+
+juce::ValueTree TrackFreezeManager::createRenderState()
+{
+    edit.flushState();
+    auto state = edit.state.createCopy();
+
+    for (auto* track : te::getAudioTracks (edit))
+    {
+        if (! isStale (*track))
+            continue;
+
+        if (auto trackState = findTrackState (state, track->itemID.toString()); trackState.isValid())
+            thawForRender (trackState, true);
+    }
+
+    return state;
+}
+
+int TrackFreezeManager::refreshStaleFreezes()
+{
+    int unfrozen = 0;
+
+    for (auto* track : te::getAudioTracks (edit))
+    {
+        if (isFrozen (*track) && isStale (*track))
+        {
+            unfreeze (*track);
+            ++unfrozen;
+        }
+    }
+
+    changedTracks.clear();
+    tempoChanged = false;
+    updateWatchedTracks();
+    return unfrozen;
+}
+
+int TrackFreezeManager::refreshPendingFreezes()
+{
+    // Tracks frozen again by an undo or redo weren't being watched while
+    // they changed, so check them once as they're picked up.
+    updateWatchedTracks();
+
+    if (changedTracks.isEmpty() && ! tempoChanged)
+        return 0;
+
+    int unfrozen = 0;
+
+    for (auto* track : te::getAudioTracks (edit))
+    {
+        if (isFrozen (*track)
+            && (tempoChanged || changedTracks.contains (track->state))
+            && isStale (*track))
+        {
+            unfreeze (*track);
+            ++unfrozen;
+        }
+    }
+
+    changedTracks.clear();
+    tempoChanged = false;
+    updateWatchedTracks();
+    return unfrozen;
+}
+
+bool TrackFreezeManager::isWatched (const juce::ValueTree& trackState) const
+{
+    for (auto* watched : watchedTracks)
+        if (*watched == trackState)
+            return true;
+
+    return false;
+}
+
+void TrackFreezeManager::watchTrack (const juce::ValueTree& trackState)
+{
+    if (! isWatched (trackState))
+        watchedTracks.add (new juce::ValueTree (trackState))->addListener (this);
+}
+
+void TrackFreezeManager::updateWatchedTracks()
+{
+    for (int i = watchedTracks.size(); --i >= 0;)
+    {
+        auto* trackState = watchedTracks.getUnchecked (i);
+
+        if (! trackState->hasProperty (freezeHashId) || ! trackState->isAChildOf (edit.state))
+        {
+            trackState->removeListener (this);
+            watchedTracks.remove (i);
+        }
+    }
+
+    for (auto* track : te::getAudioTracks (edit))
+    {
+        if (isFrozen (*track) && ! isWatched (track->state))
+        {
+            watchTrack (track->state);
+            changedTracks.addIfNotAlreadyThere (track->state);
+        }
+    }
+}
+
+void TrackFreezeManager::markChanged (const juce::ValueTree& tree)
+{
+    if (applyingFreeze)
+        return;
+
+    for (auto node = tree; node.isValid(); node = node.getParent())
+    {
+        if (node == tempoState)
+        {
+            tempoChanged = true;
+            return;
+        }
+
+        if (isWatched (node))
+        {
+            changedTracks.addIfNotAlreadyThere (node);
+            return;
+        }
+    }
+}
+
+//==============================================================================
+void TrackFreezeManager::valueTreePropertyChanged (juce::ValueTree& tree, const juce::Identifier&)
+{
+    markChanged (tree);
+}
+
+void TrackFreezeManager::valueTreeChildAdded (juce::ValueTree& parent, juce::ValueTree&)
+{
+    markChanged (parent);
+}
+
+void TrackFreezeManager::valueTreeChildRemoved (juce::ValueTree& parent, juce::ValueTree&, int)
+{
+    markChanged (parent);
+}
+
+void TrackFreezeManager::valueTreeChildOrderChanged (juce::ValueTree& parent, int, int)
+{
+    markChanged (parent);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+namespace te = tracktion;
+
+//==============================================================================
+/** Freezes audio tracks: renders a track's clips through its plugin chain
+    once, then plays that render back with the track's plugins bypassed.
+
+    The render is pre-fader, so the track's volume and pan stay live. Renders
+    are cached by a hash of everything that shapes them: the track's clips,
+    plugins and automation, the tempo map and the clips' source files.
+    The render's tail length is part of the cache file name, so re-freezing
+    unchanged content with the same tail reuses the cached file.
+
+    While a track is frozen its original clips are muted, its plugins are
+    disabled and one clip plays the cached render. All of this is stored on
+    the edit, so it saves, loads and undoes like any other change. Only the
+    frozen tracks and the tempo sequence are listened to; an edit that
+    touches them is checked by refreshPendingFreezes(), which EditSession
+    runs at the end of the mutation so an unfreeze shares its undo step.
+    Offline renders of a frozen track, such as stem export, play the cached
+    render instead of running the plugin chain again, unless the render is
+    stale, in which case they run the track live. Must be used on the
+    message thread. */
+class TrackFreezeManager : private juce::ValueTree::Listener
+{
+public:
+    explicit TrackFreezeManager (te::Edit& edit);
+    ~TrackFreezeManager() override;
+
+    struct FreezeResult
+    {
+        bool ok = false;
+        juce::String error;
+        juce::File cacheFile;
+        bool reusedCache = false;
+        te::TimeRange range;
+    };
+
+    /** Freezes the track, rendering into cacheDirectory unless an up-to-date
+        render is already there. tailSeconds extends the render past the last
+        clip so reverb and delay tails survive; re-freezing a frozen track
+        with a different tail renders it again. */
+    FreezeResult freeze (te::AudioTrack& track, const juce::File& cacheDirectory, double tailSeconds);
+
+    /** Restores the track's clips and plugins. Returns false if it wasn't frozen. */
+    bool unfreeze (te::AudioTrack& track);
+
+    static bool isFrozen (const te::AudioTrack& track);
+    static juce::File getFreezeFile (const te::AudioTrack& track);
+
+    /** Unfreezes every frozen track whose content no longer matches its render,
+        or whose render file or freeze clip has gone. This changes the edit, so
+        only call it from inside an undo transaction, e.g. an explicit command
+        run through EditSession. Returns the number of tracks unfrozen. */
+    int refreshStaleFreezes();
+
+    /** Like refreshStaleFreezes(), but only checks the frozen tracks that have
+        changed since the last call. Call it at the end of a mutation, inside
+        its undo transaction, so one undo brings back both the edit and the
+        frozen state. Returns the number of tracks unfrozen. */
+    int refreshPendingFreezes();
+
+    /** True if the track is frozen but its render no longer matches its
+        content, or its render file or freeze clip has gone. */
+    bool isStale (te::AudioTrack& track);
+
+    /** Copies the edit's state for an offline render, with every stale frozen
+        track put back to its unfrozen clips and plugins so it renders live.
+        Flushes the edit's state first; nothing else in the edit changes. */
+    juce::ValueTree createRenderState();
+
+    /** Hash of the track's unfrozen content; freeze bookkeeping is ignored.
+        The track's plugins are flushed first, so plugin changes that haven't
+        reached the edit's state yet still count. */
+    juce::String computeContentHash (te::AudioTrack& track);
+
+private:
+    bool renderFreeze (te::AudioTrack& track, const juce::File& destFile, te::TimeRange range);
+    bool isWatched (const juce::ValueTree& trackState) const;
+    void watchTrack (const juce::ValueTree& trackState);
+    void updateWatchedTracks();
+    void markChanged (const juce::ValueTree& tree);
+
+    void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
+    void valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) override;
+    void valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) override;
+    void valueTreeChildOrderChanged (juce::ValueTree&, int, int) override;
+
+    te::Edit& edit;
+    juce::ValueTree tempoState;
+    juce::OwnedArray<juce::ValueTree> watchedTracks; // listeners live on the ValueTree object, so it mustn't move
+    juce::Array<juce::ValueTree> changedTracks;
+    bool tempoChanged = false;
+    bool applyingFreeze = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackFreezeManager)
+};
@@ -6,6 +6,7 @@
 #include "EditSession.h"
 #include "UndoableCommandHandler.h"
 #include "ProjectManager.h"
+#include "RenderScheduler.h"
 #include "JobQueue.h"
 #include "ToolRegistry.h"
 #include "ExternalToolRunner.h"
@@ -16,6 +17,7 @@
 #include "ProjectChatHistoryController.h"
 #include "Tool.h"
 #include "ScreenshotCapture.h"
+#include "UiMessageHelpers.h"
 
 namespace te = tracktion;
 
@@ -143,10 +145,12 @@ public:
 
         editSession = std::make_unique<EditSession> (*engine);
         jobQueue = std::make_unique<waive::JobQueue>();
+        renderScheduler = std::make_unique<waive::RenderScheduler> (*engine);
         projectManager = std::make_unique<ProjectManager> (*editSession);
 
         commandHandler = std::make_unique<CommandHandler> (editSession->getEdit());
         commandHandler->setProjectFile (projectManager->getCurrentFile());
+        commandHandler->setRenderScheduler (renderScheduler.get());
         undoableHandler = std::make_unique<UndoableCommandHandler> (*commandHandler, *editSession,
                                                                     projectManager.get());
 
@@ -167,6 +171,7 @@ public:
         toolRegistry = std::make_unique<waive::ToolRegistry>();
         commandHandler->setAllowedMediaDirectories (makeAllowedMediaDirectories (projectManager.get(),
                                                                                 modelManager.get()));
+        commandHandler->setCompressBinaryProjects (projectManager->shouldCompressBinaryProjects());
 
         // External tool runner
         externalToolRunner = std::make_unique<waive::ExternalToolRunner>();
@@ -300,6 +305,7 @@ public:
         undoableHandler.reset();
         commandHandler.reset();
         projectManager.reset();
+        renderScheduler.reset();
         jobQueue.reset();
         editSession.reset();
         engine.reset();
@@ -322,8 +328,10 @@ public:
         commandHandler = std::make_unique<CommandHandler> (editSession->getEdit());
         commandHandler->setProjectFile (projectManager != nullptr ? projectManager->getCurrentFile()
                                                                   : juce::File());
+        commandHandler->setRenderScheduler (renderScheduler.get());
         commandHandler->setAllowedMediaDirectories (makeAllowedMediaDirectories (projectManager.get(),
                                                                                 modelManager.get()));
+        commandHandler->setCompressBinaryProjects (projectManager == nullptr || projectManager->shouldCompressBinaryProjects());
         undoableHandler->setCommandHandler (*commandHandler);
 
         updateWindowTitle();
@@ -351,11 +359,35 @@ public:
             commandHandler->setProjectFile (projectFile);
             commandHandler->setAllowedMediaDirectories (makeAllowedMediaDirectories (projectManager.get(),
                                                                                     modelManager.get()));
+            commandHandler->setCompressBinaryProjects (projectManager->shouldCompressBinaryProjects());
         }
 
         updateWindowTitle();
     }
 
+    void projectSaveStarted (const juce::File&) override
+    {
+        saveProgress = 0.0f;
+        updateWindowTitle();
+    }
+
+    void projectSaveProgress (const juce::File&, float progress) override
+    {
+        saveProgress = progress;
+        updateWindowTitle();
+    }
+
+    void projectSaveFinished (const juce::File& projectFile, const juce::Result& result) override
+    {
+        updateWindowTitle();
+
+        if (result.failed())
+            waive::showMessageBoxAsyncSafe (juce::AlertWindow::WarningIcon,
+                                            "Save Failed",
+                                            "Could not save " + projectFile.getFileName() + ":\n"
+                                                + result.getErrorMessage());
+    }
+
 private:
     void seedDemoContent()
     {
@@ -385,6 +417,8 @@ private:
             title += " - " + projectManager->getProjectName();
             if (projectManager->isDirty())
                 title += " *";
+            if (projectManager->isSaving())
+                title += " (saving " + juce::String (juce::roundToInt (saveProgress * 100.0f)) + "%)";
         }
         return title;
     }
@@ -398,6 +432,7 @@ private:
     std::unique_ptr<te::Engine> engine;
     std::unique_ptr<EditSession> editSession;
     std::unique_ptr<waive::JobQueue> jobQueue;
+    std::unique_ptr<waive::RenderScheduler> renderScheduler;
     std::unique_ptr<ProjectManager> projectManager;
 
     std::unique_ptr<CommandHandler> commandHandler;
@@ -413,6 +448,7 @@ private:
 
     std::unique_ptr<waive::WaiveLookAndFeel> lookAndFeel;
     std::unique_ptr<MainWindow> mainWindow;
+    float saveProgress = 0.0f;
 
     bool screenshotMode = false;
     juce::File screenshotOutputDir;
@@ -6,6 +6,7 @@
 #include "SessionComponent.h"
 #include "TimelineComponent.h"
 #include "LibraryComponent.h"
+#include "MediaImporter.h"
 #include "PluginBrowserComponent.h"
 #include "ToolSidebarComponent.h"
 #include "ConsoleComponent.h"
@@ -18,6 +19,7 @@
 #include "AiAgent.h"
 #include "AiSettings.h"
 #include "WaiveSpacing.h"
+#include "ProjectFileFormat.h"
 #include "ProjectPackager.h"
 #include "UiMessageHelpers.h"
 
@@ -131,12 +133,16 @@ void MainComponent::initialiseUi (waive::JobQueue& jobQueue, waive::AiAgent* aiA
         commandHandler.setAllowedMediaDirectories (makeAllowedMediaDirectories (projectManager, modelManager));
     };
 
+    // One importer, so library imports show placeholders on the timeline and
+    // all imports coalesce into the same undo steps.
+    mediaImporter = std::make_unique<waive::MediaImporter> (editSession);
     sessionComponent = std::make_unique<SessionComponent> (editSession, commandHandler,
                                                             toolRegistry, modelManager,
                                                             &jobQueue, &projectManager,
                                                             refreshAllowedMediaDirectories,
-                                                            aiAgent, aiSettings);
-    libraryComponent = std::make_unique<LibraryComponent> (editSession);
+                                                            aiAgent, aiSettings,
+                                                            mediaImporter.get());
+    libraryComponent = std::make_unique<LibraryComponent> (editSession, mediaImporter.get());
     pluginBrowser = std::make_unique<PluginBrowserComponent> (editSession, commandHandler);
     console = std::make_unique<ConsoleComponent> (commandHandler);
     toolLog = std::make_unique<ToolLogComponent> (jobQueue);
@@ -480,18 +486,14 @@ bool MainComponent::perform (const juce::ApplicationCommandTarget::InvocationInf
             return true;
         case cmdOpen:
         {
-            juce::FileChooser chooser ("Open Project...", juce::File(), "*.tracktionedit");
+            juce::FileChooser chooser ("Open Project...", juce::File(), waive::ProjectFileFormat::getFileWildcard());
             if (chooser.browseForFileToOpen())
                 return projectManager.openProject (chooser.getResult());
             return false;
         }
         case cmdSave:
-        {
-            bool success = projectManager.save();
-            if (success)
-                AutoSaveManager::deleteAutoSave (projectManager.getCurrentFile());
-            return success;
-        }
+            // The autosave is cleared when the save completes and nothing changed meanwhile.
+            return projectManager.saveInBackground();
         case cmdSaveAs:
         {
             bool success = projectManager.saveAs();
@@ -607,7 +609,14 @@ bool MainComponent::perform (const juce::ApplicationCommandTarget::InvocationInf
                 return true;
             }
 
-            auto* renderDialog = new RenderDialog (editSession, commandHandler);
+            auto* scheduler = commandHandler.getRenderScheduler();
+            if (scheduler == nullptr)
+            {
+                juce::Logger::writeToLog ("Skipping render dialog: no render scheduler");
+                return true;
+            }
+
+            auto* renderDialog = new RenderDialog (editSession, commandHandler, *scheduler);
             juce::DialogWindow::LaunchOptions opts;
             opts.content.setOwned (renderDialog);
             opts.dialogTitle = "Render Audio";
@@ -632,7 +641,8 @@ bool MainComponent::perform (const juce::ApplicationCommandTarget::InvocationInf
 
             auto projectDir = currentFile.getParentDirectory();
             auto& edit = editSession.getEdit();
-            auto result = waive::ProjectPackager::collectAndSave (edit, projectDir, currentFile);
+            auto result = waive::ProjectPackager::collectAndSave (edit, projectDir, currentFile,
+                                                                  projectManager.shouldCompressBinaryProjects());
 
             if (result.errors.isEmpty())
                 projectManager.markCurrentProjectSaved();
@@ -735,7 +745,8 @@ bool MainComponent::perform (const juce::ApplicationCommandTarget::InvocationInf
                 auto& edit = editSession.getEdit();
 
                 // First collect external media
-                auto collectResult = waive::ProjectPackager::collectAndSave (edit, projectDir, currentFile);
+                auto collectResult = waive::ProjectPackager::collectAndSave (edit, projectDir, currentFile,
+                                                                             projectManager.shouldCompressBinaryProjects());
                 if (collectResult.errors.isEmpty())
                     projectManager.markCurrentProjectSaved();
 
@@ -13,7 +13,7 @@ class PluginBrowserComponent;
 class ToolSidebarComponent;
 
 namespace waive { class JobQueue; class ToolRegistry; class ModelManager;
-                  class AiAgent; class AiSettings; }
+                  class AiAgent; class AiSettings; class MediaImporter; }
 
 //==============================================================================
 class MainComponent : public juce::Component,
@@ -98,6 +98,7 @@ private:
     std::unique_ptr<waive::ToolRegistry> ownedToolRegistry;
     waive::ToolRegistry* toolRegistry = nullptr;
     waive::ModelManager* modelManager = nullptr;
+    std::unique_ptr<waive::MediaImporter> mediaImporter; // shared by the timeline and the library
     std::unique_ptr<SessionComponent> sessionComponent;
     std::unique_ptr<LibraryComponent> libraryComponent;
     std::unique_ptr<PluginBrowserComponent> pluginBrowser;
@@ -343,7 +343,7 @@ juce::String AiAgent::executeToolCall (const ChatMessage::ToolCall& call)
 
 juce::String AiAgent::executeCommand (const juce::String& action, const juce::var& args)
 {
-    // Build the command JSON expected by CommandHandler
+    // Build the command object expected by CommandHandler
     auto* cmdObj = new juce::DynamicObject();
     cmdObj->setProperty ("action", action);
 
@@ -357,16 +357,18 @@ juce::String AiAgent::executeCommand (const juce::String& action, const juce::va
         }
     }
 
-    auto cmdJson = juce::JSON::toString (juce::var (cmdObj));
+    const juce::var command (cmdObj);
 
+    // Dispatch through the typed entry point; the response is only serialised
+    // once, for the provider's tool-result message.
     if (juce::MessageManager::getInstance()->isThisTheMessageThread())
-        return commandHandler.handleCommand (cmdJson);
+        return juce::JSON::toString (commandHandler.executeCommand (command));
 
     juce::MessageManagerLock messageManagerLock;
     if (! messageManagerLock.lockWasGained())
         return "{\"status\":\"error\",\"message\":\"Failed to acquire message-thread lock.\"}";
 
-    return commandHandler.handleCommand (cmdJson);
+    return juce::JSON::toString (commandHandler.executeCommand (command));
 }
 
 void AiAgent::saveConversation (const juce::File& file)
@@ -447,6 +449,9 @@ juce::String AiAgent::executeTool (const juce::String& toolName, const juce::var
     SimpleReporter reporter;
     auto plan = task.run (reporter);
 
+    if (task.writeArtifact)
+        task.writeArtifact (plan);
+
     // Step 3: apply on message thread
     juce::Result applyResult = juce::Result::fail ("Not executed");
 
@@ -486,6 +486,30 @@ std::vector<AiToolDefinition> generateCommandDefinitions()
                                   { "track_id" }),
                       "export" });
 
+    // freeze_track
+    defs.push_back ({ "cmd_freeze_track",
+                      "Freeze a track: render its clips through its plugins to a cached file and bypass the plugins to save CPU. "
+                      "Editing the track's clips, plugins or automation unfreezes it automatically.",
+                      makeSchema ("object",
+                                  { { "track_id", prop ("integer", "0-based track index to freeze") },
+                                    { "tail_seconds", prop ("number", "Seconds rendered past the last clip for effect tails (0-30, default 2)") } },
+                                  { "track_id" }),
+                      "mixing" });
+
+    // unfreeze_track
+    defs.push_back ({ "cmd_unfreeze_track",
+                      "Unfreeze a track, restoring its original clips and live plugins.",
+                      makeSchema ("object",
+                                  { { "track_id", prop ("integer", "0-based track index to unfreeze") } },
+                                  { "track_id" }),
+                      "mixing" });
+
+    // refresh_freezes
+    defs.push_back ({ "cmd_refresh_freezes",
+                      "Unfreeze every frozen track whose content has changed since it was frozen, e.g. after a plugin was edited in its own window.",
+                      makeSchema ("object"),
+                      "mixing" });
+
     // remove_plugin
     defs.push_back ({ "cmd_remove_plugin",
                       "Remove a plugin from a track by its index (0-based among user/external plugins only).",
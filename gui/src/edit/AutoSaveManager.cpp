@@ -1,6 +1,7 @@
 #include "AutoSaveManager.h"
 #include "EditSession.h"
 #include "ProjectManager.h"
+#include "ProjectFileFormat.h"
 
 //==============================================================================
 AutoSaveManager::AutoSaveManager (EditSession& session, ProjectManager& projectMgr, int intervalSeconds)
@@ -55,10 +56,12 @@ void AutoSaveManager::writeAutoSaveSnapshot()
         return;
 
     // Persist a snapshot of the live edit state, not just the last explicit save on disk.
+    // Binary projects autosave in binary too; recovery detects the format.
     editSession.flushState();
 
-    auto xml = editSession.getEdit().state.createXml();
-    if (xml == nullptr || ! xml->writeTo (autoSaveFile, {}))
+    const auto format = waive::ProjectFileFormat::getFormatForSaving (currentFile,
+                                                                      projectManager.shouldCompressBinaryProjects());
+    if (waive::ProjectFileFormat::writeState (editSession.getEdit().state, autoSaveFile, format).failed())
     {
         juce::Logger::writeToLog ("AutoSaveManager: Failed to save auto-save snapshot to "
                                   + autoSaveFile.getFullPathName());
@@ -1,4 +1,5 @@
 #include "EditSession.h"
+#include "ProjectFileFormat.h"
 
 namespace
 {
@@ -54,8 +55,10 @@ void EditSession::replaceEdit (std::unique_ptr<te::Edit> newEdit)
     lastTransactionWasCoalesced = false;
     undoTransactionGroupSizes.clear();
     redoTransactionGroupSizes.clear();
+    transactionIds.clear();
     undoTransactionDepth = 0;
     redoTransactionDepth = 0;
+    ++editGeneration;
     resetDirtyTrackingToCurrentState();
 
     if (edit != nullptr)
@@ -78,7 +81,7 @@ void EditSession::replaceEdit (std::unique_ptr<te::Edit> newEdit)
 
 void EditSession::loadFromFile (const juce::File& file)
 {
-    auto newEdit = te::loadEditFromFile (engine, file);
+    auto newEdit = waive::ProjectFileFormat::loadEdit (engine, file);
     replaceEdit (std::move (newEdit));
 }
 
@@ -117,6 +120,8 @@ void EditSession::markAsChanged()
     if (edit != nullptr)
     {
         hasNonUndoableUnsavedChange = true;
+        ++changeCount;
+        ++nonUndoableChangeCount;
         edit->markAsChanged();
         listeners.call (&Listener::editStateChanged);
     }
@@ -130,6 +135,39 @@ void EditSession::setSavedStateFromFile (const juce::File& file)
     hasNonUndoableUnsavedChange = false;
 }
 
+EditSession::SavePoint EditSession::createSavePoint() const
+{
+    const auto transactionId = undoTransactionDepth > 0 ? transactionIds[(size_t) undoTransactionDepth - 1] : 0;
+    return { editGeneration, undoTransactionDepth, transactionId, changeCount, nonUndoableChangeCount };
+}
+
+void EditSession::markSavedAt (const SavePoint& savePoint)
+{
+    if (edit == nullptr || savePoint.editGeneration != editGeneration)
+        return;
+
+    if (changeCount == savePoint.changeCount)
+    {
+        resetChangedStatus();
+        return;
+    }
+
+    // Undo and redo back to the saved depth leave the edit clean again, as
+    // long as that depth still holds the saved transaction. If a new edit has
+    // replaced it since, no depth matches the file and the edit stays dirty.
+    const auto depth = savePoint.undoTransactionDepth;
+    const bool savedStateIsInHistory = depth == 0
+                                    || ((int) transactionIds.size() >= depth
+                                        && transactionIds[(size_t) depth - 1] == savePoint.transactionId);
+
+    // A change the undo history cannot see keeps it dirty until the next save.
+    savedUndoTransactionDepth = savedStateIsInHistory ? depth : -1;
+    useExternalSavedStateSnapshot = false;
+    externalSavedStateSnapshot.clear();
+    hasNonUndoableUnsavedChange = nonUndoableChangeCount != savePoint.nonUndoableChangeCount;
+    syncChangedStatusToTrackingState();
+}
+
 //==============================================================================
 bool EditSession::performEdit (const juce::String& actionName,
                                std::function<void (te::Edit&)> mutation)
@@ -162,12 +200,21 @@ bool EditSession::performEdit (const juce::String& actionName,
     try
     {
         mutation (*edit);
+        listeners.call ([this] (Listener& l) { l.editMutationFinished (*edit); });
         const auto actionsAfterMutation = undoManager.getNumActionsInCurrentTransaction();
         bool stateChanged = false;
 
         if (actionsAfterMutation > actionsBeforeMutation)
         {
             stateChanged = true;
+
+            // The new transaction discards the redo history, along with any
+            // saved state that was only reachable by redoing.
+            if (savedUndoTransactionDepth > undoTransactionDepth)
+                savedUndoTransactionDepth = -1;
+
+            transactionIds.resize ((size_t) undoTransactionDepth);
+            transactionIds.push_back (++lastTransactionId);
             ++undoTransactionDepth;
             redoTransactionDepth = 0;
             redoTransactionGroupSizes.clear();
@@ -182,11 +229,13 @@ bool EditSession::performEdit (const juce::String& actionName,
             if (wasDirtyBeforeMutation)
             {
                 stateChanged = true;
+                ++nonUndoableChangeCount;
             }
             else if (buildCurrentStateSnapshot() != cleanSnapshotBeforeMutation)
             {
                 stateChanged = true;
                 hasNonUndoableUnsavedChange = true;
+                ++nonUndoableChangeCount;
             }
         }
 
@@ -195,6 +244,7 @@ bool EditSession::performEdit (const juce::String& actionName,
 
         if (stateChanged)
         {
+            ++changeCount;
             edit->markAsChanged();
             listeners.call (&Listener::editStateChanged);
         }
@@ -221,6 +271,43 @@ bool EditSession::performEdit (const juce::String& actionName,
     return false;
 }
 
+bool EditSession::performBulkEdit (const juce::String& actionName,
+                                   std::function<void (te::Edit&)> mutation)
+{
+    return performBulkEdit (actionName, false, std::move (mutation));
+}
+
+bool EditSession::performBulkEdit (const juce::String& actionName,
+                                   bool coalesce,
+                                   std::function<void (te::Edit&)> mutation)
+{
+    if (edit == nullptr)
+        return false;
+
+    // Joins the outer transaction; a throw unwinds to the outer performEdit(),
+    // which rolls the whole bulk edit back.
+    if (bulkEditDepth > 0)
+    {
+        mutation (*edit);
+        return true;
+    }
+
+    bool ok = false;
+    {
+        const juce::ScopedValueSetter<int> depth (bulkEditDepth, 1);
+        listeners.call (&Listener::bulkEditStarted);
+
+        // Each inserted or moved clip would otherwise ask for a new playback graph.
+        te::TransportControl::ReallocationInhibitor inhibitor (edit->getTransport());
+        ok = performEdit (actionName, coalesce, std::move (mutation));
+    }
+
+    // Sent whether or not the mutation succeeded: a rolled-back edit still
+    // needs the views to catch up with the restored state.
+    listeners.call (&Listener::bulkEditFinished);
+    return ok;
+}
+
 bool EditSession::canUndo() const
 {
     return edit->getUndoManager().canUndo();
@@ -253,6 +340,7 @@ void EditSession::undo()
         undoTransactionGroupSizes.pop_back();
     }
 
+    ++changeCount;
     syncChangedStatusToSavedState();
     lastTransactionName.clear();
     lastTransactionWasCoalesced = false;
@@ -281,6 +369,7 @@ void EditSession::redo()
         redoTransactionGroupSizes.pop_back();
     }
 
+    ++changeCount;
     syncChangedStatusToSavedState();
     lastTransactionName.clear();
     lastTransactionWasCoalesced = false;
@@ -316,11 +405,11 @@ juce::String EditSession::buildStateSnapshotFromFile (const juce::File& file)
     if (! file.existsAsFile())
         return {};
 
-    auto xml = juce::XmlDocument::parse (file);
-    if (xml == nullptr)
+    auto state = waive::ProjectFileFormat::readState (file);
+    if (! state.isValid())
         return {};
 
-    return createStateSnapshot (juce::ValueTree::fromXml (*xml));
+    return createStateSnapshot (state);
 }
 
 void EditSession::resetDirtyTrackingToCurrentState()
@@ -25,6 +25,16 @@ public:
         virtual void editAboutToChange() {}
         virtual void editChanged() {}
         virtual void editStateChanged() {}
+
+        /** Called after a performEdit() mutation has run, inside its undo
+            transaction. Changes made here join that transaction, so they
+            undo together with the edit that caused them. */
+        virtual void editMutationFinished (te::Edit&) {}
+
+        /** Bracket a performBulkEdit(). Views should stop polling the edit on
+            bulkEditStarted() and refresh once on bulkEditFinished(). */
+        virtual void bulkEditStarted() {}
+        virtual void bulkEditFinished() {}
     };
 
     void addListener (Listener* l)       { listeners.add (l); }
@@ -56,6 +66,23 @@ public:
     /** Set the saved-state baseline from an on-disk project file without loading it. */
     void setSavedStateFromFile (const juce::File& file);
 
+    /** The edit's position in its change history, taken when a save that
+        finishes later snapshots the state. */
+    struct SavePoint
+    {
+        int editGeneration = 0;
+        int undoTransactionDepth = 0;
+        juce::uint64 transactionId = 0;
+        juce::uint64 changeCount = 0;
+        juce::uint64 nonUndoableChangeCount = 0;
+    };
+
+    SavePoint createSavePoint() const;
+
+    /** Marks the state at savePoint as saved. Changes made since then keep
+        the edit dirty; does nothing if the edit has been replaced. */
+    void markSavedAt (const SavePoint& savePoint);
+
     //==============================================================================
     /** Execute a mutation wrapped in an undo transaction.
         Returns true if the lambda ran without throwing. */
@@ -69,6 +96,23 @@ public:
                       bool coalesce,
                       std::function<void (te::Edit&)> mutation);
 
+    /** For mutations that make thousands of changes, such as applying a large
+        tool plan. Runs as one undoable performEdit() while listeners are told
+        to hold off (see Listener::bulkEditStarted()) and the playback graph is
+        rebuilt once at the end rather than after every change. Nested calls
+        join the outer bulk edit. */
+    bool performBulkEdit (const juce::String& actionName,
+                          std::function<void (te::Edit&)> mutation);
+
+    /** Coalescing overload — consecutive same-name bulk edits undo as one
+        step, as with performEdit(). Lets work that lands in batches, such as
+        a media import, stay a single undo. */
+    bool performBulkEdit (const juce::String& actionName,
+                          bool coalesce,
+                          std::function<void (te::Edit&)> mutation);
+
+    bool isBulkEditInProgress() const    { return bulkEditDepth > 0; }
+
     bool canUndo() const;
     bool canRedo() const;
     void undo();
@@ -93,9 +137,15 @@ private:
     juce::String externalSavedStateSnapshot;
     std::vector<int> undoTransactionGroupSizes;
     std::vector<int> redoTransactionGroupSizes;
+    std::vector<juce::uint64> transactionIds; // one per undo and redo step, oldest first
+    juce::uint64 lastTransactionId = 0;
     int undoTransactionDepth = 0;
     int savedUndoTransactionDepth = 0;
     int redoTransactionDepth = 0;
+    int bulkEditDepth = 0;
+    int editGeneration = 0;
+    juce::uint64 changeCount = 0;
+    juce::uint64 nonUndoableChangeCount = 0;
     bool hasNonUndoableUnsavedChange = false;
     bool useExternalSavedStateSnapshot = false;
     juce::ListenerList<Listener> listeners;
@@ -0,0 +1,452 @@
+#include "ParameterStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+constexpr char frameMagic[] = { 'W', 'P', 'S', '1' };
+constexpr size_t frameMagicSize = sizeof (frameMagic);
+constexpr size_t frameRecordSize = 8;
+constexpr uint32_t handleMask = 0x3fffffffu;
+constexpr int kindShift = 30;
+
+uint32_t packWord (int handle, ParameterStream::UpdateKind kind)
+{
+    return ((uint32_t) handle & handleMask) | ((uint32_t) kind << kindShift);
+}
+
+uint32_t floatToBits (float value)
+{
+    uint32_t bits = 0;
+    std::memcpy (&bits, &value, sizeof (bits));
+    return bits;
+}
+
+float bitsToFloat (uint32_t bits)
+{
+    float value = 0.0f;
+    std::memcpy (&value, &bits, sizeof (value));
+    return value;
+}
+
+std::atomic<uint64_t> nextStreamId { 1 };
+
+/** Handles hold their parameter alive, so a removed plugin or track has to
+    be spotted by its state leaving the edit. */
+bool isStillInEdit (te::AutomatableParameter& parameter, const te::Edit& edit)
+{
+    auto* plugin = parameter.getPlugin();
+    return plugin != nullptr && plugin->state.isAChildOf (edit.state);
+}
+
+/** A thread's claim on one stream's lane. Streams are matched by id rather
+    than address, so a claim outliving its stream is never used again; its
+    destructor runs at thread exit and hands the lane back. */
+struct LaneClaim
+{
+    uint64_t streamId = 0;
+    void* lane = nullptr;
+    std::shared_ptr<std::atomic<bool>> inUse;
+
+    LaneClaim (uint64_t id, void* l, std::shared_ptr<std::atomic<bool>> flag)
+        : streamId (id), lane (l), inUse (std::move (flag)) {}
+
+    LaneClaim (LaneClaim&&) = default;
+    LaneClaim& operator= (LaneClaim&&) = default;
+
+    ~LaneClaim()
+    {
+        if (inUse != nullptr)
+            inUse->store (false, std::memory_order_release);
+    }
+};
+
+thread_local std::vector<LaneClaim> laneClaims;
+}
+
+//==============================================================================
+ParameterStream::Lane::Lane (int capacity)
+    : fifo (capacity),
+      ring ((size_t) fifo.getTotalSize()),
+      inUse (std::make_shared<std::atomic<bool>> (true))
+{
+}
+
+//==============================================================================
+ParameterStream::ParameterStream (EditSession& session, int ringCapacity)
+    : editSession (session),
+      streamId (nextStreamId.fetch_add (1)),
+      laneCapacity (juce::jmax (16, ringCapacity))
+{
+    slots.resize (1);
+    editSession.addListener (this);
+}
+
+ParameterStream::~ParameterStream()
+{
+    stopTimer();
+    editSession.removeListener (this);
+    releaseAllHandles();
+
+    for (auto* lane = lanes.load(); lane != nullptr;)
+        delete std::exchange (lane, lane->next);
+}
+
+//==============================================================================
+int ParameterStream::registerParameter (te::AutomatableParameter::Ptr parameter, bool recordAutomation)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (parameter == nullptr || slots.size() > (size_t) handleMask)
+        return 0;
+
+    // Handles are never reused, so records still in flight for a closed
+    // handle can't land on a newly registered parameter.
+    Slot slot;
+    slot.parameter = std::move (parameter);
+    slot.recordAutomation = recordAutomation;
+    slots.push_back (std::move (slot));
+
+    if (! isTimerRunning())
+        startTimer (drainIntervalMs);
+
+    return (int) slots.size() - 1;
+}
+
+bool ParameterStream::unregisterParameter (int handle)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (getSlot (handle) == nullptr)
+        return false;
+
+    // Apply whatever the client sent before closing.
+    applyPendingUpdates();
+
+    auto* slot = getSlot (handle);
+    if (slot->inGesture)
+    {
+        slot->parameter->parameterChangeGestureEnd();
+        if (--openGestures == 0)
+            closeUndoGroup();
+    }
+
+    *slot = {};
+
+    if (getNumRegisteredParameters() == 0)
+    {
+        closeUndoGroup();
+        stopTimer();
+    }
+
+    return true;
+}
+
+int ParameterStream::getNumRegisteredParameters() const
+{
+    return (int) std::count_if (slots.begin(), slots.end(),
+                                [] (const Slot& s) { return s.parameter != nullptr; });
+}
+
+//==============================================================================
+bool ParameterStream::push (const Record& record)
+{
+    if (record.handle <= 0 || (uint32_t) record.handle > handleMask)
+        return false;
+
+    auto& lane = getLaneForThisThread();
+    const auto scope = lane.fifo.write (1);
+
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+    {
+        ++droppedUpdates;
+        return false;
+    }
+
+    scope.forEach ([&] (int index)
+    {
+        lane.ring[(size_t) index] = { packWord (record.handle, record.kind), record.value };
+    });
+
+    return true;
+}
+
+ParameterStream::Lane& ParameterStream::getLaneForThisThread()
+{
+    for (auto& claim : laneClaims)
+        if (claim.streamId == streamId)
+            return *static_cast<Lane*> (claim.lane);
+
+    // First push from this thread: take a lane whose thread has exited, or add one.
+    auto* lane = lanes.load (std::memory_order_acquire);
+    for (; lane != nullptr; lane = lane->next)
+    {
+        bool expected = false;
+        if (lane->inUse->compare_exchange_strong (expected, true, std::memory_order_acquire))
+            break;
+    }
+
+    if (lane == nullptr)
+    {
+        lane = new Lane (laneCapacity);
+        lane->next = lanes.load (std::memory_order_relaxed);
+        while (! lanes.compare_exchange_weak (lane->next, lane, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    laneClaims.emplace_back (streamId, lane, lane->inUse);
+    return *lane;
+}
+
+int ParameterStream::getNumProducerLanes() const noexcept
+{
+    int count = 0;
+    for (auto* lane = lanes.load (std::memory_order_acquire); lane != nullptr; lane = lane->next)
+        ++count;
+
+    return count;
+}
+
+template <typename Callback>
+void ParameterStream::drainLanes (Callback&& apply)
+{
+    for (auto* lane = lanes.load (std::memory_order_acquire); lane != nullptr; lane = lane->next)
+    {
+        const auto scope = lane->fifo.read (lane->fifo.getNumReady());
+        scope.forEach ([&] (int index) { apply (lane->ring[(size_t) index]); });
+    }
+}
+
+bool ParameterStream::isFrame (const void* data, size_t numBytes)
+{
+    return data != nullptr
+        && numBytes >= frameMagicSize
+        && (numBytes - frameMagicSize) % frameRecordSize == 0
+        && std::memcmp (data, frameMagic, frameMagicSize) == 0;
+}
+
+juce::MemoryBlock ParameterStream::encodeFrame (const std::vector<Record>& records)
+{
+    juce::MemoryBlock frame;
+    frame.ensureSize (frameMagicSize + records.size() * frameRecordSize);
+    frame.append (frameMagic, frameMagicSize);
+
+    for (const auto& record : records)
+    {
+        const uint32_t fields[] = {
+            juce::ByteOrder::swapIfBigEndian (packWord (record.handle, record.kind)),
+            juce::ByteOrder::swapIfBigEndian (floatToBits (record.value))
+        };
+        frame.append (fields, sizeof (fields));
+    }
+
+    return frame;
+}
+
+bool ParameterStream::pushFrame (const void* data, size_t numBytes)
+{
+    if (! isFrame (data, numBytes))
+        return false;
+
+    const auto* bytes = static_cast<const char*> (data) + frameMagicSize;
+    const auto numRecords = (int) ((numBytes - frameMagicSize) / frameRecordSize);
+
+    auto& lane = getLaneForThisThread();
+    const auto scope = lane.fifo.write (numRecords);
+    int decoded = 0;
+
+    scope.forEach ([&] (int index)
+    {
+        const auto* recordBytes = bytes + (size_t) decoded++ * frameRecordSize;
+        lane.ring[(size_t) index] = { juce::ByteOrder::littleEndianInt (recordBytes),
+                                 bitsToFloat (juce::ByteOrder::littleEndianInt (recordBytes + 4)) };
+    });
+
+    if (decoded < numRecords)
+        droppedUpdates += numRecords - decoded;
+
+    return true;
+}
+
+//==============================================================================
+int ParameterStream::applyPendingUpdates()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    releaseRemovedHandles();
+
+    int writes = 0;
+
+    {
+        drainLanes ([&] (const PackedRecord& record)
+        {
+            const auto handle = (int) (record.word & handleMask);
+            const auto kind = (UpdateKind) (record.word >> kindShift);
+
+            auto* slot = getSlot (handle);
+            if (slot == nullptr)
+                return;
+
+            switch (kind)
+            {
+                case UpdateKind::value:
+                    if (! std::isfinite (record.value))
+                        break;
+
+                    if (! slot->hasPendingValue)
+                        pendingHandles.push_back (handle);
+
+                    slot->hasPendingValue = true;
+                    slot->pendingValue = record.value;
+                    break;
+
+                case UpdateKind::gestureBegin:
+                    if (slot->inGesture)
+                        break;
+
+                    // Keep anything streamed before the gesture in its own undo step.
+                    writes += commitPendingValues();
+                    if (openGestures == 0)
+                        closeUndoGroup();
+
+                    slot->inGesture = true;
+                    ++openGestures;
+                    slot->parameter->parameterChangeGestureBegin();
+                    break;
+
+                case UpdateKind::gestureEnd:
+                    if (! slot->inGesture)
+                        break;
+
+                    writes += commitPendingValues();
+                    slot->inGesture = false;
+                    slot->parameter->parameterChangeGestureEnd();
+
+                    if (--openGestures == 0)
+                        closeUndoGroup();
+                    break;
+
+                default:
+                    break;
+            }
+        });
+    }
+
+    return writes + commitPendingValues();
+}
+
+ParameterStream::Slot* ParameterStream::getSlot (int handle)
+{
+    if (handle <= 0 || handle >= (int) slots.size())
+        return nullptr;
+
+    auto& slot = slots[(size_t) handle];
+    return slot.parameter != nullptr ? &slot : nullptr;
+}
+
+int ParameterStream::commitPendingValues()
+{
+    if (pendingHandles.empty())
+        return 0;
+
+    auto& edit = editSession.getEdit();
+    auto& transport = edit.getTransport();
+    const bool recording = transport.isPlaying();
+    const auto position = transport.getPosition();
+    int writes = 0;
+
+    editSession.performEdit ("Parameter Stream", true, [&] (te::Edit&)
+    {
+        for (auto handle : pendingHandles)
+        {
+            auto* slot = getSlot (handle);
+            if (slot == nullptr || ! slot->hasPendingValue)
+                continue;
+
+            slot->hasPendingValue = false;
+            slot->parameter->setParameter (slot->pendingValue, juce::sendNotification);
+
+            if (slot->recordAutomation && recording)
+                slot->parameter->getCurve().addPoint (position, slot->pendingValue, 0.0f,
+                                                      &edit.getUndoManager());
+            ++writes;
+        }
+    });
+
+    pendingHandles.clear();
+    undoGroupOpen = true;
+
+    if (openGestures == 0)
+        lastUngesturedWriteMs = juce::Time::getMillisecondCounter();
+
+    return writes;
+}
+
+void ParameterStream::closeUndoGroup()
+{
+    if (! undoGroupOpen)
+        return;
+
+    editSession.endCoalescedTransaction();
+    undoGroupOpen = false;
+}
+
+void ParameterStream::releaseRemovedHandles()
+{
+    auto& edit = editSession.getEdit();
+
+    for (auto& slot : slots)
+    {
+        if (slot.parameter == nullptr || isStillInEdit (*slot.parameter, edit))
+            continue;
+
+        // Records still queued for the handle are skipped once its slot is empty.
+        if (slot.inGesture)
+        {
+            slot.parameter->parameterChangeGestureEnd();
+            if (--openGestures == 0)
+                closeUndoGroup();
+        }
+
+        slot = {};
+    }
+}
+
+void ParameterStream::releaseAllHandles()
+{
+    // Drop anything queued for the old targets.
+    for (auto* lane = lanes.load (std::memory_order_acquire); lane != nullptr; lane = lane->next)
+        lane->fifo.finishedRead (lane->fifo.getNumReady());
+
+    for (auto& slot : slots)
+    {
+        if (slot.parameter != nullptr && slot.inGesture)
+            slot.parameter->parameterChangeGestureEnd();
+
+        slot = {};
+    }
+
+    pendingHandles.clear();
+    openGestures = 0;
+    undoGroupOpen = false;
+}
+
+//==============================================================================
+void ParameterStream::editAboutToChange()
+{
+    stopTimer();
+    releaseAllHandles();
+}
+
+void ParameterStream::timerCallback()
+{
+    applyPendingUpdates();
+
+    if (undoGroupOpen && openGestures == 0
+        && juce::Time::getMillisecondCounter() - lastUngesturedWriteMs > (juce::uint32) idleGestureTimeoutMs)
+        closeUndoGroup();
+}
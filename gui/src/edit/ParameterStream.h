@@ -0,0 +1,155 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+#include "EditSession.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace te = tracktion;
+
+//==============================================================================
+/** High-rate parameter control for external controllers.
+
+    A client registers a (track, plugin, parameter) target once and gets a small
+    integer handle back. After that it pushes compact value records, from any
+    thread, into a fixed-size ring. Each producing thread gets a ring of its
+    own on its first push (a "lane"), so pushes are lock-free single-producer
+    writes with no lock between connections; a lane is handed to a later
+    thread once its owner exits. The message thread drains every lane every
+    few milliseconds and applies only the latest value per handle, so a 1 kHz
+    fader stream costs one setParameter() per handle per tick instead of one
+    JSON command per sample. Records keep their order within a lane, which
+    is per connection, but not across lanes.
+
+    Values pushed between beginGesture() and endGesture() form one undo step.
+    Ungestured values are grouped the same way and closed after a short idle
+    period. Handles registered with recordAutomation also write curve points
+    while the transport is playing.
+
+    Handles are invalidated when the EditSession swaps its edit, and on the
+    next drain once their plugin or track has been removed. */
+class ParameterStream : private EditSession::Listener,
+                        private juce::Timer
+{
+public:
+    enum class UpdateKind : uint32_t
+    {
+        value        = 0,
+        gestureBegin = 1,
+        gestureEnd   = 2
+    };
+
+    struct Record
+    {
+        int handle = 0;
+        UpdateKind kind = UpdateKind::value;
+        float value = 0.0f;
+    };
+
+    /** ringCapacity is the number of records each producer's lane holds. */
+    explicit ParameterStream (EditSession& session, int ringCapacity = 8192);
+    ~ParameterStream() override;
+
+    //==============================================================================
+    /** Registers a parameter and returns its handle (message thread only). */
+    int registerParameter (te::AutomatableParameter::Ptr parameter, bool recordAutomation);
+
+    /** Releases a handle, closing any open gesture (message thread only).
+        Returns false if the handle is unknown. */
+    bool unregisterParameter (int handle);
+
+    int getNumRegisteredParameters() const;
+
+    //==============================================================================
+    /** Queues an update. Safe to call from any thread; returns false if the ring is full. */
+    bool push (const Record& record);
+
+    bool pushValue (int handle, float value)  { return push ({ handle, UpdateKind::value, value }); }
+    bool beginGesture (int handle)            { return push ({ handle, UpdateKind::gestureBegin, 0.0f }); }
+    bool endGesture (int handle)              { return push ({ handle, UpdateKind::gestureEnd, 0.0f }); }
+
+    /** Binary wire frame: the 4-byte magic "WPS1" followed by 8-byte records, each
+        a little-endian uint32 (handle in the low 30 bits, UpdateKind in the top two)
+        and a little-endian float32 value. */
+    static bool isFrame (const void* data, size_t numBytes);
+    static juce::MemoryBlock encodeFrame (const std::vector<Record>& records);
+
+    /** Decodes a frame and queues its records. Safe to call from any thread.
+        Returns false if the block is not a well-formed frame. */
+    bool pushFrame (const void* data, size_t numBytes);
+
+    //==============================================================================
+    /** Drains the ring and applies the latest value per handle (message thread only).
+        Driven by the internal timer; public so tests and benchmarks can drain
+        synchronously. Returns the number of parameter writes performed. */
+    int applyPendingUpdates();
+
+    /** Number of updates dropped because the ring was full. */
+    int getNumDroppedUpdates() const noexcept  { return droppedUpdates.load(); }
+
+    /** Number of producer lanes allocated so far; lanes are reused, so this
+        tracks the most threads ever pushing at once. */
+    int getNumProducerLanes() const noexcept;
+
+    static constexpr int drainIntervalMs = 10;
+    static constexpr int idleGestureTimeoutMs = 250;
+
+private:
+    struct PackedRecord
+    {
+        uint32_t word = 0;
+        float value = 0.0f;
+    };
+
+    /** One producer's single-producer/single-consumer ring. Lanes are only
+        ever prepended to the list and are freed with the stream. */
+    struct Lane
+    {
+        explicit Lane (int capacity);
+
+        juce::AbstractFifo fifo;
+        std::vector<PackedRecord> ring;
+        std::shared_ptr<std::atomic<bool>> inUse;   // cleared when the owning thread exits
+        Lane* next = nullptr;
+    };
+
+    struct Slot
+    {
+        te::AutomatableParameter::Ptr parameter;
+        bool recordAutomation = false;
+        bool inGesture = false;
+        bool hasPendingValue = false;
+        float pendingValue = 0.0f;
+    };
+
+    Lane& getLaneForThisThread();
+    template <typename Callback>
+    void drainLanes (Callback&& apply);
+    Slot* getSlot (int handle);
+    int commitPendingValues();
+    void closeUndoGroup();
+    void releaseRemovedHandles();
+    void releaseAllHandles();
+
+    void editAboutToChange() override;
+    void timerCallback() override;
+
+    EditSession& editSession;
+
+    const uint64_t streamId;
+    const int laneCapacity;
+    std::atomic<Lane*> lanes { nullptr };
+    std::atomic<int> droppedUpdates { 0 };
+
+    std::vector<Slot> slots;           // indexed by handle; slot 0 is unused
+    std::vector<int> pendingHandles;
+    int openGestures = 0;
+    bool undoGroupOpen = false;
+    juce::uint32 lastUngesturedWriteMs = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterStream)
+};
@@ -1,39 +1,17 @@
 #include "ProjectManager.h"
 #include "EditSession.h"
 #include "AutoSaveManager.h"
+#include "ProjectFileFormat.h"
 #include "UiMessageHelpers.h"
 
 #include <tracktion_engine/tracktion_engine.h>
+#include <algorithm>
+#include <atomic>
 
 namespace te = tracktion;
 
 namespace
 {
-bool replaceFileAtomically (const juce::File& sourceFile, const juce::File& destinationFile)
-{
-    if (! sourceFile.existsAsFile())
-        return false;
-
-    auto tempFile = destinationFile.getSiblingFile (destinationFile.getFileName()
-                                                    + ".tmp-"
-                                                    + juce::Uuid().toString());
-
-    if (tempFile.exists())
-        (void) tempFile.deleteFile();
-
-    if (! sourceFile.copyFileTo (tempFile))
-        return false;
-
-    const bool success = destinationFile.existsAsFile()
-                           ? tempFile.replaceFileIn (destinationFile)
-                           : tempFile.moveFileTo (destinationFile);
-
-    if (! success && tempFile.exists())
-        (void) tempFile.deleteFile();
-
-    return success;
-}
-
 void deleteTransientBackingFileIfNeeded (const juce::File& backingFile,
                                          const juce::File& destinationFile)
 {
@@ -53,21 +31,52 @@ void rebindEditBackingFile (te::Edit& edit, const juce::File& targetFile)
     edit.editFileRetriever = [targetFile] { return targetFile; };
 }
 
+bool isBinaryProjectFile (const juce::File& file)
+{
+    return waive::ProjectFileFormat::getFormatForSaving (file) != waive::ProjectFileFormat::Format::xml;
+}
+
 }
 
+//==============================================================================
+struct ProjectManager::PendingSave
+{
+    juce::File file;
+    juce::File previousBackingFile;
+    waive::ProjectFileFormat::Format format = waive::ProjectFileFormat::Format::xml;
+    EditSession::SavePoint savePoint;
+    juce::ValueTree snapshot;                   // owned by the save thread until done
+    juce::Result result { juce::Result::ok() };
+    std::atomic<bool> done { false };
+    juce::WaitableEvent finished { true };
+};
+
 //==============================================================================
 ProjectManager::ProjectManager (EditSession& session)
+    : ProjectManager (session, getDefaultSettingsOptions())
+{
+}
+
+ProjectManager::ProjectManager (EditSession& session, const juce::PropertiesFile::Options& settingsOptions)
     : editSession (session)
+{
+    appProperties.setStorageParameters (settingsOptions);
+}
+
+juce::PropertiesFile::Options ProjectManager::getDefaultSettingsOptions()
 {
     juce::PropertiesFile::Options opts;
     opts.applicationName     = "Waive";
     opts.filenameSuffix       = ".settings";
     opts.osxLibrarySubFolder = "Application Support/Waive";
-    appProperties.setStorageParameters (opts);
+    return opts;
 }
 
 ProjectManager::~ProjectManager()
 {
+    // A save is never interrupted; the file on disk must end up complete.
+    for (const auto& pendingSave : pendingSaves)
+        pendingSave->finished.wait (-1);
 }
 
 //==============================================================================
@@ -91,7 +100,7 @@ bool ProjectManager::newProject()
 
 bool ProjectManager::openProject()
 {
-    juce::FileChooser chooser ("Open Project", juce::File(), "*.tracktionedit");
+    juce::FileChooser chooser ("Open Project", juce::File(), waive::ProjectFileFormat::getFileWildcard());
 
     if (! chooser.browseForFileToOpen())
         return false;
@@ -214,16 +223,23 @@ bool ProjectManager::save()
     if (currentFile == juce::File())
         return saveAs();
 
+    waitForPendingSaves();
+
     const auto previousFile = currentFile;
     auto fileOps = te::EditFileOperations (editSession.getEdit());
     auto backingFile = fileOps.getEditFile();
 
-    if (backingFile != juce::File() && backingFile != currentFile)
+    if (isBinaryProjectFile (currentFile))
+    {
+        if (! writeBinaryProject (currentFile))
+            return false;
+    }
+    else if (backingFile != juce::File() && backingFile != currentFile)
     {
         if (! fileOps.save (false, true, false))
             return false;
 
-        if (! replaceFileAtomically (backingFile, currentFile))
+        if (! waive::ProjectFileFormat::replaceFileAtomically (backingFile, currentFile))
             return false;
 
         if (te::EditFileOperations (editSession.getEdit()).getEditFile() != currentFile)
@@ -245,28 +261,146 @@ bool ProjectManager::save()
     return true;
 }
 
+bool ProjectManager::saveInBackground()
+{
+    if (currentFile == juce::File())
+        return saveAs();
+
+    // The copy is the only work done on the message thread; it is far cheaper
+    // than serialising the tree and leaves the live edit free to keep changing.
+    editSession.flushState();
+
+    auto pendingSave = std::make_shared<PendingSave>();
+    pendingSave->file = currentFile;
+    pendingSave->previousBackingFile = te::EditFileOperations (editSession.getEdit()).getEditFile();
+    pendingSave->format = waive::ProjectFileFormat::getFormatForSaving (currentFile, shouldCompressBinaryProjects());
+    pendingSave->savePoint = editSession.createSavePoint();
+    pendingSave->snapshot = editSession.getEdit().state.createCopy();
+    pendingSaves.push_back (pendingSave);
+
+    listeners.call ([&] (Listener& listener) { listener.projectSaveStarted (currentFile); });
+
+    juce::WeakReference<ProjectManager> weakThis (this);
+    saveThread.addJob ([pendingSave, weakThis]
+    {
+        waive::ProjectWriteOptions options;
+        options.syncToDisk = true;
+        options.onProgress = [pendingSave, weakThis] (float progress)
+        {
+            juce::MessageManager::callAsync ([pendingSave, weakThis, progress]
+            {
+                // Dropped if the save was already reported by waitForPendingSaves().
+                if (weakThis != nullptr && weakThis->isPending (*pendingSave))
+                    weakThis->listeners.call ([&] (Listener& listener)
+                                              { listener.projectSaveProgress (pendingSave->file, progress); });
+            });
+        };
+
+        pendingSave->result = waive::ProjectFileFormat::writeState (pendingSave->snapshot, pendingSave->file,
+                                                                    pendingSave->format, options);
+        pendingSave->snapshot = {};
+        pendingSave->done = true;
+        pendingSave->finished.signal();
+
+        juce::MessageManager::callAsync ([weakThis]
+        {
+            if (weakThis != nullptr)
+                weakThis->finishCompletedSaves();
+        });
+    });
+
+    return true;
+}
+
+bool ProjectManager::waitForPendingSaves (int timeoutMs)
+{
+    const auto startMs = juce::Time::getMillisecondCounter();
+    const auto savesToWaitFor = pendingSaves;
+
+    for (const auto& pendingSave : savesToWaitFor)
+    {
+        int remainingMs = -1;
+        if (timeoutMs >= 0)
+            remainingMs = juce::jmax (0, timeoutMs - (int) (juce::Time::getMillisecondCounter() - startMs));
+
+        if (! pendingSave->finished.wait (remainingMs))
+            return false;
+    }
+
+    finishCompletedSaves();
+    return true;
+}
+
+bool ProjectManager::isPending (const PendingSave& pendingSave) const
+{
+    return std::any_of (pendingSaves.begin(), pendingSaves.end(),
+                        [&] (const auto& save) { return save.get() == &pendingSave; });
+}
+
+void ProjectManager::finishCompletedSaves()
+{
+    // Reported in start order, so a later save's result is never overwritten
+    // by an earlier one finishing after it.
+    while (! pendingSaves.empty() && pendingSaves.front()->done)
+    {
+        const auto pendingSave = pendingSaves.front();
+        pendingSaves.erase (pendingSaves.begin());
+        completeSave (*pendingSave);
+    }
+}
+
+void ProjectManager::completeSave (const PendingSave& pendingSave)
+{
+    if (pendingSave.result.failed())
+    {
+        juce::Logger::writeToLog ("ProjectManager: " + pendingSave.result.getErrorMessage());
+    }
+    else if (pendingSave.file == currentFile)
+    {
+        auto& edit = editSession.getEdit();
+        if (te::EditFileOperations (edit).getEditFile() != currentFile)
+            rebindEditBackingFile (edit, currentFile);
+
+        deleteTransientBackingFileIfNeeded (pendingSave.previousBackingFile, currentFile);
+        editSession.markSavedAt (pendingSave.savePoint);
+
+        // An autosave written during the save may hold the newer edits.
+        if (! isDirty())
+            AutoSaveManager::deleteAutoSave (currentFile);
+
+        listeners.call ([&] (Listener& listener)
+                        { listener.projectFileChanged (currentFile, currentFile, FileChangeKind::save); });
+        checkDirtyState();
+    }
+
+    listeners.call ([&] (Listener& listener)
+                    { listener.projectSaveFinished (pendingSave.file, pendingSave.result); });
+}
+
 bool ProjectManager::saveAs()
 {
-    juce::FileChooser chooser ("Save Project As", currentFile, "*.tracktionedit");
+    juce::FileChooser chooser ("Save Project As", currentFile, waive::ProjectFileFormat::getFileWildcard());
 
     if (! chooser.browseForFileToSave (true))
         return false;
 
     auto file = chooser.getResult();
     if (file.getFileExtension().isEmpty())
-        file = file.withFileExtension ("tracktionedit");
+        file = file.withFileExtension (getDefaultProjectExtension());
 
     return saveAs (file);
 }
 
 bool ProjectManager::saveAs (const juce::File& file)
 {
+    waitForPendingSaves();
+
     auto targetFile = file;
     if (targetFile == juce::File())
         return false;
 
     if (targetFile.getFileExtension().isEmpty())
-        targetFile = targetFile.withFileExtension ("tracktionedit");
+        targetFile = targetFile.withFileExtension (getDefaultProjectExtension());
 
     const auto parentDirectory = targetFile.getParentDirectory();
     if (parentDirectory == juce::File() || ! parentDirectory.exists())
@@ -275,9 +409,18 @@ bool ProjectManager::saveAs (const juce::File& file)
     auto fileOps = te::EditFileOperations (editSession.getEdit());
     auto backingFile = fileOps.getEditFile();
     const auto previousFile = currentFile;
-    editSession.flushState();
-    if (! fileOps.saveAs (targetFile, true))
-        return false;
+
+    if (isBinaryProjectFile (targetFile))
+    {
+        if (! writeBinaryProject (targetFile))
+            return false;
+    }
+    else
+    {
+        editSession.flushState();
+        if (! fileOps.saveAs (targetFile, true))
+            return false;
+    }
 
     // Tracktion's saveAs can leave the live edit bound to its previous backing file.
     // Rebind the current Edit in place so undo history and edit-scoped UI state survive Save As.
@@ -299,6 +442,56 @@ bool ProjectManager::saveAs (const juce::File& file)
     return true;
 }
 
+void ProjectManager::setBinaryProjectsByDefault (bool shouldUseBinary)
+{
+    if (auto* props = appProperties.getUserSettings())
+        props->setValue ("binaryProjectsByDefault", shouldUseBinary);
+}
+
+bool ProjectManager::areBinaryProjectsDefault() const
+{
+    if (auto* props = appProperties.getUserSettings())
+        return props->getBoolValue ("binaryProjectsByDefault", false);
+
+    return false;
+}
+
+void ProjectManager::setCompressBinaryProjects (bool shouldCompress)
+{
+    if (auto* props = appProperties.getUserSettings())
+        props->setValue ("compressBinaryProjects", shouldCompress);
+}
+
+bool ProjectManager::shouldCompressBinaryProjects() const
+{
+    if (auto* props = appProperties.getUserSettings())
+        return props->getBoolValue ("compressBinaryProjects", true);
+
+    return true;
+}
+
+juce::String ProjectManager::getDefaultProjectExtension() const
+{
+    return areBinaryProjectsDefault() ? waive::ProjectFileFormat::binaryFileExtension
+                                      : waive::ProjectFileFormat::xmlFileExtension;
+}
+
+bool ProjectManager::writeBinaryProject (const juce::File& file)
+{
+    // Written straight from the edit's state; Tracktion's own save only writes XML.
+    editSession.flushState();
+    const auto result = waive::ProjectFileFormat::writeState (editSession.getEdit().state, file,
+                                                              waive::ProjectFileFormat::getFormatForSaving (file, shouldCompressBinaryProjects()));
+    if (result.failed())
+    {
+        juce::Logger::writeToLog ("ProjectManager: " + result.getErrorMessage());
+        return false;
+    }
+
+    rebindEditBackingFile (editSession.getEdit(), file);
+    return true;
+}
+
 void ProjectManager::markCurrentProjectSaved()
 {
     if (currentFile == juce::File())
@@ -355,6 +548,8 @@ void ProjectManager::clearRecentFiles()
 //==============================================================================
 bool ProjectManager::confirmSaveIfDirty()
 {
+    waitForPendingSaves();
+
     if (! isDirty())
         return true;
 
@@ -3,9 +3,21 @@
 #include <JuceHeader.h>
 #include "EditSession.h"
 
+#include <memory>
+#include <vector>
+
 
 //==============================================================================
-/** Manages project file operations: new, open, save, save-as, recent files. */
+/** Manages project file operations: new, open, save, save-as, recent files.
+
+    Projects are saved as Tracktion XML (.tracktionedit) or, for files with
+    the .waiveproject extension, in the compact binary format described in
+    ProjectFileFormat. Either kind opens regardless of extension.
+
+    saveInBackground() only copies the edit's state on the message thread;
+    writing, fsync and the rename happen on a save thread. Edits made while it
+    runs stay unsaved. Anything that replaces the project or needs the file on
+    disk (save(), saveAs(), open, new, quit) waits for pending saves first. */
 class ProjectManager
 {
 public:
@@ -29,9 +41,32 @@ public:
         {
             juce::ignoreUnused (previousProjectFile, currentProjectFile, changeKind);
         }
+
+        /** Background saves, reported on the message thread. A successful save
+            is followed by projectFileChanged() with FileChangeKind::save. */
+        virtual void projectSaveStarted (const juce::File& projectFile)
+        {
+            juce::ignoreUnused (projectFile);
+        }
+
+        virtual void projectSaveProgress (const juce::File& projectFile, float progress)
+        {
+            juce::ignoreUnused (projectFile, progress);
+        }
+
+        virtual void projectSaveFinished (const juce::File& projectFile, const juce::Result& result)
+        {
+            juce::ignoreUnused (projectFile, result);
+        }
     };
 
     explicit ProjectManager (EditSession& session);
+
+    /** Keeps recent files and project settings in the given storage instead of
+        the app's, e.g. so a benchmark or test leaves the user's list alone. */
+    ProjectManager (EditSession& session, const juce::PropertiesFile::Options& settingsOptions);
+
+    static juce::PropertiesFile::Options getDefaultSettingsOptions();
     ~ProjectManager();
 
     bool newProject();
@@ -40,11 +75,29 @@ public:
     bool recoverProjectFromAutoSave (const juce::File& autoSaveFile,
                                      const juce::File& originalProjectFile);
     bool save();
+
+    /** Starts saving the current project and returns at once. An untitled
+        project goes through saveAs() instead. */
+    bool saveInBackground();
+    bool isSaving() const    { return ! pendingSaves.empty(); }
+
+    /** Blocks until every background save has finished and been reported.
+        Returns false on timeout; a negative timeout waits indefinitely. */
+    bool waitForPendingSaves (int timeoutMs = -1);
+
     bool saveAs();
     bool saveAs (const juce::File& file);
     bool confirmSaveIfDirty();
     void markCurrentProjectSaved();
 
+    /** Whether Save As without an extension picks .waiveproject. Off by default. */
+    void setBinaryProjectsByDefault (bool shouldUseBinary);
+    bool areBinaryProjectsDefault() const;
+
+    /** Whether binary projects are gzipped. On by default. */
+    void setCompressBinaryProjects (bool shouldCompress);
+    bool shouldCompressBinaryProjects() const;
+
     bool isDirty() const
     {
         return editSession.hasChangedSinceSaved();
@@ -95,6 +148,13 @@ private:
                               bool discardCurrentAutoSaveOnDiscard = false,
                               bool prepareCurrentProject = true);
     void addToRecentFiles (const juce::File& file);
+    juce::String getDefaultProjectExtension() const;
+    bool writeBinaryProject (const juce::File& file);
+
+    struct PendingSave;
+    bool isPending (const PendingSave& pendingSave) const;
+    void finishCompletedSaves();
+    void completeSave (const PendingSave& pendingSave);
 
     EditSession& editSession;
     juce::File currentFile;
@@ -103,5 +163,8 @@ private:
     juce::ListenerList<Listener> listeners;
     bool lastDirtyState = false;
 
+    std::vector<std::shared_ptr<PendingSave>> pendingSaves;     // in the order they were started
+    juce::ThreadPool saveThread { 1 };
+
     JUCE_DECLARE_WEAK_REFERENCEABLE (ProjectManager)
 };
@@ -1,6 +1,7 @@
 #include "UndoableCommandHandler.h"
 #include "CommandHandler.h"
 #include "EditSession.h"
+#include "ParameterStream.h"
 #include "ProjectManager.h"
 
 #include <stdexcept>
@@ -34,11 +35,17 @@ bool isPassThroughAction (const juce::String& action)
     return isReadOnlyAction (action)
         || action == "export_mixdown"
         || action == "export_stems"
+        || action == "render_batch"
         || action == "package_as_zip"
         || action == "collect_and_save"
         || action == "remove_unused_media";
 }
 
+bool isParameterStreamAction (const juce::String& action)
+{
+    return action == "open_parameter_stream" || action == "close_parameter_stream";
+}
+
 bool marksProjectAsSaved (const juce::String& action, const juce::var& response)
 {
     if (! response.isObject() || response["status"].toString() != "ok")
@@ -47,6 +54,14 @@ bool marksProjectAsSaved (const juce::String& action, const juce::var& response)
     return action == "collect_and_save";
 }
 
+juce::var makeErrorResponse (const juce::String& message)
+{
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("status", "error");
+    obj->setProperty ("message", message);
+    return juce::var (obj);
+}
+
 void deleteAutoSaveForProjectFile (const juce::File& projectFile)
 {
     if (projectFile == juce::File())
@@ -64,6 +79,17 @@ UndoableCommandHandler::UndoableCommandHandler (CommandHandler& handler, EditSes
                                                 ProjectManager* owningProjectManager)
     : commandHandler (&handler), editSession (session), projectManager (owningProjectManager)
 {
+    editSession.addListener (this);
+}
+
+UndoableCommandHandler::~UndoableCommandHandler()
+{
+    editSession.removeListener (this);
+}
+
+void UndoableCommandHandler::editMutationFinished (te::Edit&)
+{
+    commandHandler->refreshPendingFreezes();
 }
 
 void UndoableCommandHandler::setCommandHandler (CommandHandler& handler)
@@ -71,6 +97,11 @@ void UndoableCommandHandler::setCommandHandler (CommandHandler& handler)
     commandHandler = &handler;
 }
 
+waive::RenderScheduler* UndoableCommandHandler::getRenderScheduler() const
+{
+    return commandHandler->getRenderScheduler();
+}
+
 void UndoableCommandHandler::setAllowedMediaDirectories (const juce::Array<juce::File>& directories)
 {
     if (commandHandler != nullptr)
@@ -87,6 +118,16 @@ juce::String UndoableCommandHandler::handleCommandCoalesced (const juce::String&
     return handleInternal (jsonString, true);
 }
 
+juce::var UndoableCommandHandler::executeCommand (const juce::var& command)
+{
+    return executeInternal (command, false);
+}
+
+juce::var UndoableCommandHandler::executeCommandCoalesced (const juce::var& command)
+{
+    return executeInternal (command, true);
+}
+
 juce::String UndoableCommandHandler::handleInternal (const juce::String& jsonString, bool coalesce)
 {
     auto parsed = juce::JSON::parse (jsonString);
@@ -94,13 +135,25 @@ juce::String UndoableCommandHandler::handleInternal (const juce::String& jsonStr
     if (! parsed.isObject())
         return commandHandler->handleCommand (jsonString);
 
-    auto action = parsed["action"].toString();
+    return juce::JSON::toString (executeInternal (parsed, coalesce));
+}
+
+juce::var UndoableCommandHandler::executeInternal (const juce::var& command, bool coalesce)
+{
+    if (! command.isObject())
+        return commandHandler->executeCommand (command);
+
+    auto action = command["action"].toString();
+
+    // Stream handles only register/release targets; the values they carry are
+    // applied (and undo-grouped) by the ParameterStream itself.
+    if (parameterStream != nullptr && isParameterStreamAction (action))
+        return executeParameterStreamCommand (action, command);
 
     // Read-only queries and file-side-effect commands pass through without undo wrapping.
     if (isPassThroughAction (action))
     {
-        auto result = commandHandler->handleCommand (jsonString);
-        auto response = juce::JSON::parse (result);
+        auto response = commandHandler->executeCommand (command);
 
         if (marksProjectAsSaved (action, response))
         {
@@ -113,17 +166,16 @@ juce::String UndoableCommandHandler::handleInternal (const juce::String& jsonStr
             }
         }
 
-        return result;
+        return response;
     }
 
     // Mutating command — wrap in undo transaction.
-    juce::String result;
+    juce::var response;
     juce::String failureMessage;
     auto ok = editSession.performEdit (action, coalesce, [&] (te::Edit&)
     {
-        result = commandHandler->handleCommand (jsonString);
+        response = commandHandler->executeCommand (command);
 
-        auto response = juce::JSON::parse (result);
         if (response.isObject() && response["status"].toString() == "error")
         {
             failureMessage = response["message"].toString();
@@ -134,10 +186,51 @@ juce::String UndoableCommandHandler::handleInternal (const juce::String& jsonStr
     if (! ok)
     {
         if (failureMessage.isNotEmpty())
-            return result;
+            return response;
+
+        return makeErrorResponse ("Command failed during edit mutation");
+    }
+
+    return response;
+}
+
+juce::var UndoableCommandHandler::executeParameterStreamCommand (const juce::String& action,
+                                                                const juce::var& command)
+{
+    if (action == "close_parameter_stream")
+    {
+        if (! command.hasProperty ("handle"))
+            return makeErrorResponse ("Missing required parameter: handle");
+
+        const auto handle = (int) command["handle"];
+        if (! parameterStream->unregisterParameter (handle))
+            return makeErrorResponse ("Unknown parameter stream handle: " + juce::String (handle));
 
-        return "{ \"status\": \"error\", \"message\": \"Command failed during edit mutation\" }";
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty ("status", "ok");
+        obj->setProperty ("handle", handle);
+        return juce::var (obj);
     }
 
-    return result;
+    juce::var errorResult;
+    auto parameter = commandHandler->resolveParameter (command, errorResult);
+    if (parameter == nullptr)
+        return errorResult;
+
+    const bool recordAutomation = static_cast<bool> (command.getProperty ("record_automation", false));
+    const auto handle = parameterStream->registerParameter (parameter, recordAutomation);
+    if (handle <= 0)
+        return makeErrorResponse ("Failed to open parameter stream");
+
+    const auto range = parameter->getValueRange();
+
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("status", "ok");
+    obj->setProperty ("handle", handle);
+    obj->setProperty ("param_name", parameter->getParameterName());
+    obj->setProperty ("value", (double) parameter->getCurrentValue());
+    obj->setProperty ("min", (double) range.getStart());
+    obj->setProperty ("max", (double) range.getEnd());
+    obj->setProperty ("record_automation", recordAutomation);
+    return juce::var (obj);
 }
@@ -1,19 +1,25 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "EditSession.h"
+
 class CommandHandler;
-class EditSession;
+class ParameterStream;
 class ProjectManager;
+namespace waive { class RenderScheduler; }
 
 //==============================================================================
 /** Wraps CommandHandler, adding undo transactions for mutating commands.
     Read-only commands pass through directly; mutating commands are wrapped
-    in EditSession::performEdit so they participate in undo/redo. */
-class UndoableCommandHandler
+    in EditSession::performEdit so they participate in undo/redo. Every
+    EditSession mutation, wherever it comes from, ends by letting the handler
+    unfreeze the tracks it made stale within the same undo transaction. */
+class UndoableCommandHandler : private EditSession::Listener
 {
 public:
     UndoableCommandHandler (CommandHandler& handler, EditSession& session,
                             ProjectManager* projectManager = nullptr);
+    ~UndoableCommandHandler() override;
 
     /** Reseat the underlying CommandHandler (used after edit swap). */
     void setCommandHandler (CommandHandler& handler);
@@ -25,16 +31,36 @@ public:
         previous transaction had the same action name. */
     juce::String handleCommandCoalesced (const juce::String& jsonString);
 
+    /** Typed in-process entry point used by the GUI, AiAgent and tools.
+        Takes a command object and returns the structured response without any
+        JSON round-trip; JSON strings are reserved for the socket/console boundary. */
+    juce::var executeCommand (const juce::var& command);
+
+    /** Coalescing variant of executeCommand() for slider drags. */
+    juce::var executeCommandCoalesced (const juce::var& command);
+
     /** Refresh the underlying CommandHandler allowlist used for path validation. */
     void setAllowedMediaDirectories (const juce::Array<juce::File>& directories);
 
+    /** The scheduler the underlying CommandHandler queues renders on, if any. */
+    waive::RenderScheduler* getRenderScheduler() const;
+
     /** Get access to the EditSession (for undo/redo handling in AiAgent). */
     EditSession& getEditSession() { return editSession; }
 
+    /** Attach a ParameterStream so open_parameter_stream / close_parameter_stream
+        can register and release stream handles. Pass nullptr to detach. */
+    void setParameterStream (ParameterStream* stream) { parameterStream = stream; }
+
 private:
+    void editMutationFinished (te::Edit&) override;
+
     juce::String handleInternal (const juce::String& jsonString, bool coalesce);
+    juce::var executeInternal (const juce::var& command, bool coalesce);
+    juce::var executeParameterStreamCommand (const juce::String& action, const juce::var& command);
 
     CommandHandler* commandHandler;
     EditSession& editSession;
     ProjectManager* projectManager;
+    ParameterStream* parameterStream = nullptr;
 };
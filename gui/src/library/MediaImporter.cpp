@@ -0,0 +1,559 @@
+#include "MediaImporter.h"
+#include "SampleLibraryIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace waive
+{
+
+namespace
+{
+enum class ItemState
+{
+    probing,
+    ready,
+    failed
+};
+
+/** Resamples source to a 24-bit WAV at targetSampleRate, the same length in
+    seconds. Each channel goes through a windowed-sinc interpolator, after a
+    linear-phase low-pass when downsampling. Both delays are whole input
+    samples, so they are primed out before the first output sample, and the
+    reader's zeros past the end flush the tail through. */
+juce::Result convertSampleRate (const juce::File& source, const juce::File& destination,
+                                double targetSampleRate, const std::atomic<bool>& cancelled)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (source));
+    if (reader == nullptr || reader->numChannels <= 0 || reader->sampleRate <= 0)
+        return juce::Result::fail ("Could not read " + source.getFileName());
+
+    const auto numChannels = (int) reader->numChannels;
+    const auto sourceSampleRate = reader->sampleRate;
+    const auto ratio = sourceSampleRate / targetSampleRate;     // source samples per output sample
+    const auto outputLength = (int64) std::ceil ((double) reader->lengthInSamples / ratio);
+
+    std::unique_ptr<juce::OutputStream> stream (destination.createOutputStream());
+    if (stream == nullptr)
+        return juce::Result::fail ("Could not create " + destination.getFullPathName());
+
+    auto writerOptions = juce::AudioFormatWriterOptions()
+                             .withSampleRate (targetSampleRate)
+                             .withNumChannels (numChannels)
+                             .withBitsPerSample (24);
+
+    auto writer = juce::WavAudioFormat().createWriterFor (stream, writerOptions);
+    if (writer == nullptr)
+        return juce::Result::fail ("Could not create " + destination.getFullPathName());
+
+    auto failWith = [&] (const juce::String& message)
+    {
+        writer.reset();
+        (void) destination.deleteFile();
+        return juce::Result::fail (message);
+    };
+
+    // The interpolator doesn't band-limit, so downsampling filters below the
+    // new Nyquist first.
+    constexpr int lowPassOrder = 128;
+    const bool lowPass = ratio > 1.0;
+    juce::OwnedArray<juce::dsp::FIR::Filter<float>> lowPassFilters;
+
+    if (lowPass)
+    {
+        auto coefficients = juce::dsp::FilterDesign<float>::designFIRLowpassWindowMethod (
+            (float) (0.45 * targetSampleRate), sourceSampleRate, (size_t) lowPassOrder,
+            juce::dsp::WindowingFunction<float>::blackman);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            lowPassFilters.add (new juce::dsp::FIR::Filter<float> (coefficients));
+    }
+
+    std::vector<juce::WindowedSincInterpolator> interpolators ((size_t) numChannels);
+
+    const auto filterDelay = lowPass ? lowPassOrder / 2 : 0;
+    const auto interpolatorDelay = juce::roundToInt (juce::WindowedSincInterpolator::getBaseLatency());
+
+    constexpr int outputBlockSize = 8192;
+    const auto inputBlockSize = juce::jmax (filterDelay + interpolatorDelay,
+                                            (int) std::ceil (outputBlockSize * ratio) + 2);
+
+    juce::AudioBuffer<float> input (numChannels, inputBlockSize);
+    juce::AudioBuffer<float> output (numChannels, juce::jmax (outputBlockSize, interpolatorDelay));
+    int64 readPosition = 0;
+    int numBuffered = 0;
+
+    // Past the end of the file the reader fills with silence.
+    auto fill = [&]
+    {
+        const auto numToRead = inputBlockSize - numBuffered;
+        reader->read (&input, numBuffered, numToRead, readPosition, true, true);
+        readPosition += numToRead;
+
+        for (int channel = 0; channel < lowPassFilters.size(); ++channel)
+        {
+            auto& filter = *lowPassFilters[channel];
+            auto* data = input.getWritePointer (channel);
+
+            for (int i = numBuffered; i < inputBlockSize; ++i)
+                data[i] = filter.processSample (data[i]);
+        }
+
+        numBuffered = inputBlockSize;
+    };
+
+    auto consume = [&] (int numUsed)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = input.getWritePointer (channel);
+            std::copy (data + numUsed, data + numBuffered, data);
+        }
+
+        numBuffered -= numUsed;
+    };
+
+    // Drop the filter's delay, then load the interpolator's history at unit
+    // speed so its next output is the first source sample.
+    fill();
+    consume (filterDelay);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        interpolators[(size_t) channel].process (1.0, input.getReadPointer (channel),
+                                                 output.getWritePointer (channel), interpolatorDelay);
+
+    consume (interpolatorDelay);
+
+    for (int64 written = 0; written < outputLength;)
+    {
+        if (cancelled.load())
+            return failWith ("Import cancelled");
+
+        fill();
+
+        const auto numSamples = (int) juce::jmin ((int64) outputBlockSize, outputLength - written);
+        int numUsed = 0;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            numUsed = interpolators[(size_t) channel].process (ratio, input.getReadPointer (channel),
+                                                               output.getWritePointer (channel), numSamples);
+
+        consume (numUsed);
+
+        if (! writer->writeFromAudioSampleBuffer (output, 0, numSamples))
+            return failWith ("Could not write " + destination.getFileName());
+
+        written += numSamples;
+    }
+
+    return juce::Result::ok();
+}
+
+/** Copies or converts source into mediaFolder when the options ask for it,
+    and leaves the file to insert in resolvedFile. */
+juce::Result bringIntoProject (te::Engine& engine, const juce::File& source,
+                               const MediaImportOptions& options, const juce::File& mediaFolder,
+                               const std::atomic<bool>& cancelled, juce::File& resolvedFile)
+{
+    resolvedFile = source;
+
+    if (mediaFolder == juce::File())
+        return juce::Result::ok();
+
+    const bool convert = options.targetSampleRate > 0.0
+                      && std::abs (te::AudioFile (engine, source).getInfo().sampleRate - options.targetSampleRate) > 0.5;
+
+    if (! convert && (! options.copyIntoProject || source.isAChildOf (mediaFolder)))
+        return juce::Result::ok();
+
+    if (auto created = mediaFolder.createDirectory(); created.failed())
+        return created;
+
+    if (convert)
+    {
+        auto destination = mediaFolder.getNonexistentChildFile (source.getFileNameWithoutExtension()
+                                                                    + "_" + juce::String (juce::roundToInt (options.targetSampleRate)),
+                                                                ".wav", false);
+        auto converted = convertSampleRate (source, destination, options.targetSampleRate, cancelled);
+        if (converted.wasOk())
+            resolvedFile = destination;
+
+        return converted;
+    }
+
+    // Importing the same file twice reuses the first copy.
+    auto destination = mediaFolder.getChildFile (source.getFileName());
+    if (destination.existsAsFile() && destination.hasIdenticalContentTo (source))
+    {
+        resolvedFile = destination;
+        return juce::Result::ok();
+    }
+
+    destination = mediaFolder.getNonexistentChildFile (source.getFileNameWithoutExtension(), source.getFileExtension(), false);
+    if (! source.copyFileTo (destination))
+        return juce::Result::fail ("Could not copy " + source.getFileName() + " into " + mediaFolder.getFullPathName());
+
+    resolvedFile = destination;
+    return juce::Result::ok();
+}
+}
+
+//==============================================================================
+struct MediaImporter::Item
+{
+    juce::File source;
+    int audioTrackIndex = 0;
+
+    // Written by the probe before state, read on the message thread after it.
+    juce::File resolvedFile;
+    double lengthSeconds = 0.0;
+    juce::String error;
+    std::atomic<int> state { (int) ItemState::probing };
+
+    bool handled = false;               // message thread only: inserted or reported
+};
+
+struct MediaImporter::Batch
+{
+    juce::String actionName;
+    MediaImportOptions options;
+    double startSeconds = 0.0;
+    std::vector<std::unique_ptr<Item>> items;
+    std::atomic<bool> cancelled { false };
+
+    // Message thread only.
+    size_t nextInOrder = 0;             // first item not yet handled
+    double nextStartSeconds = 0.0;      // where the next end-to-end item goes
+    int numHandled = 0;
+    int numProbedSeen = 0;
+    int numImported = 0;
+    juce::StringArray errors;
+};
+
+//==============================================================================
+MediaImporter::MediaImporter (EditSession& session)
+    : editSession (session),
+      probePool (juce::jlimit (1, 4, juce::SystemStats::getNumCpus()))
+{
+    editSession.addListener (this);
+}
+
+MediaImporter::~MediaImporter()
+{
+    editSession.removeListener (this);
+    stopTimer();
+
+    for (auto& batch : batches)
+        batch->cancelled = true;
+
+    probePool.removeAllJobs (true, 5000);
+}
+
+void MediaImporter::importFiles (const juce::Array<juce::File>& files, int audioTrackIndex, double startSeconds)
+{
+    if (files.isEmpty())
+        return;
+
+    auto batch = std::make_shared<Batch>();
+    batch->actionName = files.size() == 1 ? juce::String ("Insert Audio Clip")
+                                          : "Import " + juce::String (files.size()) + " Files";
+    batch->options = options;
+    batch->startSeconds = juce::jmax (0.0, startSeconds);
+    batch->nextStartSeconds = batch->startSeconds;
+
+    audioTrackIndex = juce::jmax (0, audioTrackIndex);
+    for (int i = 0; i < files.size(); ++i)
+    {
+        auto item = std::make_unique<Item>();
+        item->source = files.getReference (i);
+        item->audioTrackIndex = options.oneTrackPerFile ? audioTrackIndex + i : audioTrackIndex;
+        batch->items.push_back (std::move (item));
+    }
+
+    const auto mediaFolder = (options.copyIntoProject || options.targetSampleRate > 0.0)
+                                 ? getProjectMediaFolder (editSession.getEdit())
+                                 : juce::File();
+
+    batches.push_back (batch);
+
+    auto& engine = editSession.getEngine();
+    for (auto& item : batch->items)
+    {
+        probePool.addJob ([batch, target = item.get(), &engine, mediaFolder]
+        {
+            if (batch->cancelled.load())
+                return;
+
+            auto result = bringIntoProject (engine, target->source, batch->options, mediaFolder,
+                                            batch->cancelled, target->resolvedFile);
+
+            if (result.wasOk())
+            {
+                // Fills the engine's info cache for the clip and its thumbnail.
+                const auto info = te::AudioFile (engine, target->resolvedFile).getInfo();
+                if (info.lengthInSamples > 0 && info.sampleRate > 0.0)
+                    target->lengthSeconds = (double) info.lengthInSamples / info.sampleRate;
+                else
+                    result = juce::Result::fail ("The file format is not supported or could not be read.");
+            }
+
+            if (result.failed())
+                target->error = result.getErrorMessage();
+
+            target->state.store ((int) (result.wasOk() ? ItemState::ready : ItemState::failed),
+                               std::memory_order_release);
+        });
+    }
+
+    listeners.call (&Listener::importPlaceholdersChanged);
+    startTimerHz (30);
+}
+
+void MediaImporter::cancelAll()
+{
+    if (batches.empty())
+        return;
+
+    for (auto& batch : batches)
+        batch->cancelled = true;
+
+    batches.clear();
+    lastInsertedBatch = nullptr;
+    stopTimer();
+    listeners.call (&Listener::importPlaceholdersChanged);
+}
+
+std::vector<MediaImportPlaceholder> MediaImporter::getPlaceholders() const
+{
+    std::vector<MediaImportPlaceholder> placeholders;
+
+    for (auto& batch : batches)
+    {
+        auto nextStart = batch->nextStartSeconds;
+
+        for (size_t i = batch->nextInOrder; i < batch->items.size(); ++i)
+        {
+            auto& item = *batch->items[i];
+            const auto state = (ItemState) item.state.load (std::memory_order_acquire);
+            if (item.handled || state == ItemState::failed)
+                continue;
+
+            MediaImportPlaceholder placeholder;
+            placeholder.file = item.source;
+            placeholder.audioTrackIndex = item.audioTrackIndex;
+            placeholder.probed = state == ItemState::ready;
+            placeholder.lengthSeconds = placeholder.probed ? item.lengthSeconds : unprobedPlaceholderSeconds;
+
+            if (batch->options.oneTrackPerFile)
+            {
+                placeholder.startSeconds = batch->startSeconds;
+            }
+            else
+            {
+                placeholder.startSeconds = nextStart;
+                nextStart += placeholder.lengthSeconds;
+            }
+
+            placeholders.push_back (placeholder);
+        }
+    }
+
+    return placeholders;
+}
+
+bool MediaImporter::waitForImportsForTesting (int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) juce::jmax (0, timeoutMs);
+
+    while (isImporting())
+    {
+        insertReadyItems();
+
+        if (! isImporting())
+            break;
+
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        juce::Thread::sleep (1);
+    }
+
+    return true;
+}
+
+bool MediaImporter::isImportableFile (const juce::File& file)
+{
+    static const juce::WildcardFileFilter filter (SampleLibraryIndex::getAudioFileWildcard(), {}, {});
+    return file.existsAsFile() && filter.isFileSuitable (file);
+}
+
+juce::File MediaImporter::getProjectMediaFolder (te::Edit& edit)
+{
+    if (edit.editFileRetriever == nullptr)
+        return {};
+
+    const auto editFile = edit.editFileRetriever();
+
+    // Unsaved projects are backed by a file in the temp folder.
+    if (editFile == juce::File() || editFile.isAChildOf (juce::File::getSpecialLocation (juce::File::tempDirectory)))
+        return {};
+
+    return editFile.getParentDirectory().getChildFile ("Audio");
+}
+
+//==============================================================================
+void MediaImporter::editAboutToChange()
+{
+    cancelAll();
+}
+
+void MediaImporter::timerCallback()
+{
+    insertReadyItems();
+}
+
+void MediaImporter::insertReadyItems()
+{
+    struct Insert
+    {
+        Item* item;
+        double startSeconds;
+    };
+
+    bool placeholdersChanged = false;
+    int budget = maxInsertsPerTick;
+
+    // finishBatch() removes from batches.
+    const auto activeBatches = batches;
+
+    for (auto& batch : activeBatches)
+    {
+        std::vector<Insert> inserts;
+        int numProbed = 0;
+        const auto numHandledBefore = batch->numHandled;
+
+        for (size_t i = batch->nextInOrder; i < batch->items.size(); ++i)
+        {
+            auto& item = *batch->items[i];
+
+            if (! item.handled)
+            {
+                const auto state = (ItemState) item.state.load (std::memory_order_acquire);
+                if (state == ItemState::probing)
+                {
+                    // An end-to-end item's start depends on every length before it.
+                    if (! batch->options.oneTrackPerFile)
+                        break;
+
+                    continue;
+                }
+
+                ++numProbed;
+
+                if (budget <= 0)
+                    continue;
+
+                item.handled = true;
+                ++batch->numHandled;
+
+                if (state == ItemState::failed)
+                {
+                    batch->errors.add (item.source.getFileName() + ": " + item.error);
+                }
+                else
+                {
+                    auto start = batch->startSeconds;
+                    if (! batch->options.oneTrackPerFile)
+                    {
+                        start = batch->nextStartSeconds;
+                        batch->nextStartSeconds += item.lengthSeconds;
+                    }
+
+                    inserts.push_back ({ &item, start });
+                    --budget;
+                }
+            }
+
+            if (i == batch->nextInOrder && item.handled)
+                ++batch->nextInOrder;
+        }
+
+        if (numProbed != batch->numProbedSeen || batch->numHandled != numHandledBefore)
+            placeholdersChanged = true;
+
+        batch->numProbedSeen = numProbed;
+
+        if (! inserts.empty())
+        {
+            // Another import's clips must not join this one's undo step.
+            if (lastInsertedBatch != batch.get())
+                editSession.endCoalescedTransaction();
+
+            lastInsertedBatch = batch.get();
+
+            int numInserted = 0;
+            const bool ok = editSession.performBulkEdit (batch->actionName, true, [&] (te::Edit& edit)
+            {
+                numInserted = 0;
+                int highestTrackIndex = 0;
+                for (auto& insert : inserts)
+                    highestTrackIndex = juce::jmax (highestTrackIndex, insert.item->audioTrackIndex);
+
+                edit.ensureNumberOfAudioTracks (highestTrackIndex + 1);
+                auto tracks = te::getAudioTracks (edit);
+
+                for (auto& insert : inserts)
+                {
+                    auto* track = tracks[insert.item->audioTrackIndex];
+                    const auto& file = insert.item->resolvedFile;
+                    if (track == nullptr)
+                        continue;
+
+                    const auto start = te::TimePosition::fromSeconds (insert.startSeconds);
+                    const auto end = te::TimePosition::fromSeconds (insert.startSeconds + insert.item->lengthSeconds);
+                    if (track->insertWaveClip (file.getFileNameWithoutExtension(), file,
+                                               { { start, end }, te::TimeDuration() }, false) != nullptr)
+                        ++numInserted;
+                }
+            });
+
+            if (ok)
+                batch->numImported += numInserted;
+            else
+                batch->errors.add ("Could not insert " + juce::String ((int) inserts.size()) + " clip(s)");
+        }
+
+        if (batch->numHandled == (int) batch->items.size())
+            finishBatch (*batch);
+    }
+
+    if (placeholdersChanged)
+        listeners.call (&Listener::importPlaceholdersChanged);
+
+    if (batches.empty())
+        stopTimer();
+}
+
+void MediaImporter::finishBatch (Batch& batch)
+{
+    if (lastInsertedBatch == &batch)
+    {
+        editSession.endCoalescedTransaction();
+        lastInsertedBatch = nullptr;
+    }
+
+    const auto numImported = batch.numImported;
+    const auto errors = batch.errors;
+
+    batches.erase (std::remove_if (batches.begin(), batches.end(),
+                                   [&batch] (const auto& b) { return b.get() == &batch; }),
+                   batches.end());
+
+    listeners.call (&Listener::importFinished, numImported, errors);
+}
+
+} // namespace waive
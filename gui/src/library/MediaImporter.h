@@ -0,0 +1,118 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "EditSession.h"
+
+#include <memory>
+#include <vector>
+
+namespace waive
+{
+
+struct MediaImportOptions
+{
+    bool oneTrackPerFile = false;       // each file on the next audio track; otherwise end to end on the target
+    bool copyIntoProject = false;       // copy into the project's Audio folder; ignored until the project is saved
+    double targetSampleRate = 0.0;      // convert to a 24-bit WAV at this rate while copying; 0 keeps the source
+};
+
+/** A clip that has been queued for import but is not in the edit yet. */
+struct MediaImportPlaceholder
+{
+    juce::File file;
+    int audioTrackIndex = 0;
+    double startSeconds = 0.0;
+    double lengthSeconds = 0.0;         // an estimate until the file has been probed
+    bool probed = false;
+};
+
+/** Inserts audio files into the edit without blocking the message thread.
+
+    importFiles() returns at once. Each file's header is probed on a small
+    pool of background threads, which also does any copy or sample-rate
+    conversion into the project media folder; the probe goes through the
+    engine's AudioFile info cache, so the clip and its thumbnail reuse it.
+    Until a file is ready, views draw it from getPlaceholders().
+
+    Ready files are inserted from a message-thread timer, a batch per tick, as
+    coalesced bulk edits under one action name, so an import with no other
+    edit in between undoes in one step. Files laid end to end are inserted in
+    order, since each start depends on the lengths before it. Tracks are
+    resolved by audio track index at insert time, and replacing the edit
+    cancels everything still pending. */
+class MediaImporter : private EditSession::Listener,
+                      private juce::Timer
+{
+public:
+    explicit MediaImporter (EditSession& session);
+    ~MediaImporter() override;
+
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        virtual void importPlaceholdersChanged() {}
+
+        /** Called once per importFiles() call, after its last file is inserted
+            or has failed. */
+        virtual void importFinished (int numImported, const juce::StringArray& errors)
+        {
+            juce::ignoreUnused (numImported, errors);
+        }
+    };
+
+    void addListener (Listener* l)       { listeners.add (l); }
+    void removeListener (Listener* l)    { listeners.remove (l); }
+
+    void setOptions (const MediaImportOptions& newOptions)  { options = newOptions; }
+    const MediaImportOptions& getOptions() const             { return options; }
+
+    /** Queues files for insertion from startSeconds on the audio track at
+        audioTrackIndex, using the current options. */
+    void importFiles (const juce::Array<juce::File>& files, int audioTrackIndex, double startSeconds);
+
+    bool isImporting() const    { return ! batches.empty(); }
+    void cancelAll();
+
+    std::vector<MediaImportPlaceholder> getPlaceholders() const;
+
+    /** Blocks until every queued file is inserted or has failed, running the
+        message-thread inserts itself. Returns false on timeout. */
+    bool waitForImportsForTesting (int timeoutMs);
+
+    /** True for files with an audio extension the library also indexes. */
+    static bool isImportableFile (const juce::File& file);
+
+    /** Where copied and converted files go: the Audio folder beside the
+        project file, or an invalid File for an unsaved project. */
+    static juce::File getProjectMediaFolder (te::Edit& edit);
+
+    /** Clips inserted per timer tick; keeps each tick well under a frame. */
+    static constexpr int maxInsertsPerTick = 64;
+
+    /** Width drawn for a placeholder whose length is not known yet. */
+    static constexpr double unprobedPlaceholderSeconds = 1.0;
+
+private:
+    struct Item;
+    struct Batch;
+
+    // EditSession::Listener
+    void editAboutToChange() override;
+
+    // Timer
+    void timerCallback() override;
+
+    void insertReadyItems();
+    void finishBatch (Batch& batch);
+
+    EditSession& editSession;
+    MediaImportOptions options;
+    juce::ThreadPool probePool;
+    std::vector<std::shared_ptr<Batch>> batches;
+    const Batch* lastInsertedBatch = nullptr;   // whose undo group the session may still be extending
+    juce::ListenerList<Listener> listeners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MediaImporter)
+};
+
+} // namespace waive
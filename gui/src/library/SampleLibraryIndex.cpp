@@ -0,0 +1,879 @@
+#include "SampleLibraryIndex.h"
+#include "AudioAnalysis.h"
+#include "AudioFeatures.h"
+#include "TempoAnalysis.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace waive
+{
+
+namespace
+{
+constexpr int databaseMagic = 0x494c5357;   // "WSLI"
+constexpr int databaseVersion = 1;
+
+// Least time between partial snapshots during a long scan. Building one
+// re-tokenises the whole library, so the gap also grows with that cost and
+// publishing stays a small fraction of the scan at any library size.
+constexpr juce::uint32 publishIntervalMs = 1000;
+constexpr juce::uint32 publishCostMultiple = 4;
+
+// Threads reading new and changed files; each opens and measures one file at a time.
+constexpr int maxReadThreads = 4;
+
+// Shorter files are one-shots, where a tempo estimate means nothing.
+constexpr double minTempoSeconds = 2.0;
+
+// Only the level fields of the summary are used.
+constexpr float analysisActivityGain = 0.001f;
+constexpr float analysisTransientRiseGain = 0.01f;
+
+const char* const pitchClassNames[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+
+/** Splits text into lower-case runs of letters or digits, breaking between
+    letters and digits too, so "Kick_120bpm" gives "kick", "120", "bpm". */
+void appendTokens (const juce::String& text, std::vector<std::string>& tokens)
+{
+    juce::String current;
+    int currentKind = 0;
+
+    auto flush = [&]
+    {
+        if (current.isNotEmpty())
+            tokens.push_back (current.toStdString());
+
+        current.clear();
+    };
+
+    const auto lower = text.toLowerCase();
+
+    for (auto p = lower.getCharPointer(); ! p.isEmpty();)
+    {
+        const auto c = p.getAndAdvance();
+        const auto kind = juce::CharacterFunctions::isDigit (c)  ? 2
+                        : juce::CharacterFunctions::isLetter (c) ? 1
+                                                                 : 0;
+        if (kind != currentKind)
+            flush();
+
+        currentKind = kind;
+        if (kind != 0)
+            current += c;
+    }
+
+    flush();
+}
+
+struct KeyName
+{
+    int pitchClass = -1;
+    int mode = -1;      // -1 either, 0 major, 1 minor
+};
+
+/** Parses "A", "am", "C#", "Bb minor", "F# major" and similar. */
+std::optional<KeyName> parseKeyName (const juce::String& text)
+{
+    const auto trimmed = text.trim().toLowerCase().removeCharacters (" _-");
+    if (trimmed.isEmpty())
+        return std::nullopt;
+
+    static const std::array<int, 7> letterPitchClasses { 9, 11, 0, 2, 4, 5, 7 };   // a .. g
+    const auto letter = trimmed[0];
+    if (letter < 'a' || letter > 'g')
+        return std::nullopt;
+
+    KeyName key;
+    key.pitchClass = letterPitchClasses[(size_t) (letter - 'a')];
+
+    auto rest = trimmed.substring (1);
+    if (rest.startsWith ("#"))
+    {
+        key.pitchClass = (key.pitchClass + 1) % 12;
+        rest = rest.substring (1);
+    }
+    else if (rest.startsWith ("b"))
+    {
+        key.pitchClass = (key.pitchClass + 11) % 12;
+        rest = rest.substring (1);
+    }
+
+    if (rest.isEmpty())
+        return key;
+
+    if (rest == "m" || rest == "min" || rest == "minor")
+        key.mode = 1;
+    else if (rest == "maj" || rest == "major")
+        key.mode = 0;
+    else
+        return std::nullopt;
+
+    return key;
+}
+
+/** Best of the 24 major and minor Krumhansl-Kessler key profiles against the
+    file's mean chroma, or empty when nothing correlates well. */
+juce::String estimateKey (const std::vector<float>& chroma)
+{
+    if (chroma.size() < 12)
+        return {};
+
+    std::array<double, 12> mean {};
+    for (size_t i = 0; i < chroma.size(); ++i)
+        mean[i % 12] += (double) chroma[i];
+
+    static const std::array<std::array<double, 12>, 2> profiles {{
+        { 6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88 },
+        { 6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17 }
+    }};
+
+    auto correlate = [] (const std::array<double, 12>& a, const std::array<double, 12>& b, int rotation)
+    {
+        double meanA = 0.0, meanB = 0.0;
+        for (int i = 0; i < 12; ++i)
+        {
+            meanA += a[(size_t) i];
+            meanB += b[(size_t) i];
+        }
+
+        meanA /= 12.0;
+        meanB /= 12.0;
+
+        double covariance = 0.0, varianceA = 0.0, varianceB = 0.0;
+        for (int i = 0; i < 12; ++i)
+        {
+            const auto da = a[(size_t) ((i + rotation) % 12)] - meanA;
+            const auto db = b[(size_t) i] - meanB;
+            covariance += da * db;
+            varianceA += da * da;
+            varianceB += db * db;
+        }
+
+        return varianceA > 0.0 && varianceB > 0.0 ? covariance / std::sqrt (varianceA * varianceB) : 0.0;
+    };
+
+    double best = 0.5;
+    juce::String key;
+
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        for (int tonic = 0; tonic < 12; ++tonic)
+        {
+            const auto score = correlate (mean, profiles[(size_t) mode], tonic);
+            if (score > best)
+            {
+                best = score;
+                key = juce::String (pitchClassNames[tonic]) + (mode == 0 ? " major" : " minor");
+            }
+        }
+    }
+
+    return key;
+}
+
+bool needsAnalysis (const SampleLibraryEntry& entry, const SampleLibraryScanOptions& options)
+{
+    if (! entry.readable)
+        return false;
+
+    return (options.measureLevels && ! entry.hasLevels)
+        || (options.detectTempoAndKey && ! entry.hasTempoAndKey && entry.durationSeconds <= options.maxAnalysisSeconds);
+}
+
+SampleLibraryEntry readEntry (juce::AudioFormatManager& formatManager,
+                              const juce::File& file,
+                              int64 fileSize,
+                              int64 modifiedMs,
+                              const SampleLibraryScanOptions& options,
+                              const std::function<bool()>& shouldCancel)
+{
+    SampleLibraryEntry entry;
+    entry.path = file.getFullPathName();
+    entry.fileSize = fileSize;
+    entry.modifiedMs = modifiedMs;
+
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+        if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+            return entry;
+
+        entry.readable = true;
+        entry.sampleRate = reader->sampleRate;
+        entry.numChannels = (int) reader->numChannels;
+        entry.durationSeconds = (double) reader->lengthInSamples / reader->sampleRate;
+
+        // ACID loops carry their tempo, which beats any estimate.
+        entry.tempoBpm = juce::jmax (0.0, reader->metadataValues.getValue (juce::WavAudioFormat::acidTempo, {}).getDoubleValue());
+    }
+
+    if (options.measureLevels)
+    {
+        const auto summary = analyseAudioFile (file, AudioAnalysisRange(),
+                                               analysisActivityGain, analysisTransientRiseGain,
+                                               shouldCancel, nullptr, true);
+        if (summary.valid && ! summary.cancelled)
+        {
+            entry.hasLevels = true;
+            entry.peakDb = juce::Decibels::gainToDecibels (summary.peakGain, -120.0f);
+            if (summary.hasLoudness)
+                entry.integratedLufs = summary.integratedLufs;
+        }
+    }
+
+    if (options.detectTempoAndKey && entry.durationSeconds <= options.maxAnalysisSeconds)
+    {
+        FeatureSettings settings;
+        settings.computeChroma = true;
+
+        const auto features = extractFeatures (file, AudioAnalysisRange(), settings, shouldCancel);
+        if (features.valid && ! features.cancelled)
+        {
+            entry.hasTempoAndKey = true;
+
+            if (entry.tempoBpm <= 0.0 && entry.durationSeconds >= minTempoSeconds)
+            {
+                const TempoSettings tempoSettings;
+                entry.tempoBpm = pickTempo (computeTempoStrength (features.onsetStrength, features.getFrameRate(), tempoSettings),
+                                            tempoSettings);
+            }
+
+            entry.key = estimateKey (features.chroma);
+        }
+    }
+
+    return entry;
+}
+}
+
+//==============================================================================
+struct SampleLibraryIndex::Snapshot
+{
+    std::vector<SampleLibraryEntry> entries;    // sorted by path
+    std::vector<std::string> tokens;            // sorted, unique
+    std::vector<std::vector<int>> postings;     // ascending entry indices, one list per token
+};
+
+class SampleLibraryIndex::ScanThread : public juce::Thread
+{
+public:
+    explicit ScanThread (SampleLibraryIndex& ownerToUse)
+        : juce::Thread ("SampleLibraryScan"),
+          owner (ownerToUse)
+    {
+    }
+
+    void run() override
+    {
+        for (;;)
+        {
+            owner.rescan ([this] { return threadShouldExit(); });
+
+            const std::lock_guard<std::mutex> lock (owner.scanStateMutex);
+            if (owner.scanRequested && ! threadShouldExit())
+            {
+                owner.scanRequested = false;
+                continue;
+            }
+
+            owner.scanInProgress = false;
+            return;
+        }
+    }
+
+private:
+    SampleLibraryIndex& owner;
+};
+
+//==============================================================================
+SampleLibraryIndex::SampleLibraryIndex (const juce::File& file)
+    : databaseFile (file),
+      snapshot (std::make_shared<Snapshot>()),
+      scanThread (std::make_unique<ScanThread> (*this))
+{
+    load();
+}
+
+SampleLibraryIndex::~SampleLibraryIndex()
+{
+    stopBackgroundScan();
+}
+
+juce::File SampleLibraryIndex::getDefaultDatabaseFile()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                      .getChildFile ("Waive")
+                      .getChildFile ("library")
+                      .getChildFile ("sample_index.db");
+}
+
+juce::String SampleLibraryIndex::getAudioFileWildcard()
+{
+    return "*.wav;*.aiff;*.aif;*.flac;*.mp3;*.ogg";
+}
+
+void SampleLibraryIndex::setRoots (const juce::Array<juce::File>& newRoots)
+{
+    const std::lock_guard<std::mutex> lock (settingsMutex);
+    roots = newRoots;
+}
+
+void SampleLibraryIndex::addRoot (const juce::File& root)
+{
+    const std::lock_guard<std::mutex> lock (settingsMutex);
+    roots.addIfNotAlreadyThere (root);
+}
+
+juce::Array<juce::File> SampleLibraryIndex::getRoots() const
+{
+    const std::lock_guard<std::mutex> lock (settingsMutex);
+    return roots;
+}
+
+void SampleLibraryIndex::setScanOptions (const SampleLibraryScanOptions& newOptions)
+{
+    const std::lock_guard<std::mutex> lock (settingsMutex);
+    options = newOptions;
+}
+
+SampleLibraryScanOptions SampleLibraryIndex::getScanOptions() const
+{
+    const std::lock_guard<std::mutex> lock (settingsMutex);
+    return options;
+}
+
+//==============================================================================
+SampleLibraryScanStats SampleLibraryIndex::rescan (const std::function<bool()>& shouldCancel)
+{
+    const std::lock_guard<std::mutex> rescanLock (rescanMutex);
+
+    const auto scanRoots = getRoots();
+    const auto scanOptions = getScanOptions();
+    const auto previous = getSnapshot();
+
+    std::unordered_map<juce::String, size_t> previousByPath;
+    previousByPath.reserve (previous->entries.size());
+    for (size_t i = 0; i < previous->entries.size(); ++i)
+        previousByPath.emplace (previous->entries[i].path, i);
+
+    std::vector<bool> previousSeen (previous->entries.size(), false);
+    std::unordered_set<juce::String> seenPaths;
+
+    // One slot per file found. A changed file keeps its old entry until it has
+    // been read again, so it stays searchable; a new file has none until then.
+    std::vector<SampleLibraryEntry> entries;
+    std::vector<bool> hasEntry;
+    entries.reserve (previous->entries.size());
+    hasEntry.reserve (previous->entries.size());
+
+    struct PendingRead
+    {
+        size_t slot;
+        juce::File file;
+        int64 fileSize;
+        int64 modifiedMs;
+    };
+
+    std::vector<PendingRead> pending;
+
+    SampleLibraryScanStats stats;
+
+    // The walk only stats files, so it finishes before any file is opened and
+    // the reads can be shared between threads.
+    for (const auto& root : scanRoots)
+    {
+        if (! root.isDirectory())
+            continue;
+
+        for (const auto& item : juce::RangedDirectoryIterator (root, true, getAudioFileWildcard(), juce::File::findFiles))
+        {
+            if (shouldCancel != nullptr && shouldCancel())
+            {
+                stats.cancelled = true;
+                break;
+            }
+
+            const auto file = item.getFile();
+            const auto path = file.getFullPathName();
+
+            // Nested roots would otherwise list a file twice.
+            if (! seenPaths.insert (path).second)
+                continue;
+
+            ++stats.filesSeen;
+            const auto fileSize = item.getFileSize();
+            const auto modifiedMs = item.getModificationTime().toMilliseconds();
+            const auto slot = entries.size();
+
+            if (const auto found = previousByPath.find (path); found != previousByPath.end())
+            {
+                previousSeen[found->second] = true;
+                const auto& existing = previous->entries[found->second];
+                entries.push_back (existing);
+                hasEntry.push_back (true);
+
+                if (existing.fileSize == fileSize && existing.modifiedMs == modifiedMs
+                    && ! needsAnalysis (existing, scanOptions))
+                    continue;
+            }
+            else
+            {
+                entries.emplace_back();
+                hasEntry.push_back (false);
+            }
+
+            pending.push_back ({ slot, file, fileSize, modifiedMs });
+        }
+
+        if (stats.cancelled)
+            break;
+    }
+
+    std::mutex resultsMutex;    // guards entries, hasEntry and the counters below during the reads
+
+    // Until the scan completes, files from the last scan that the walk didn't
+    // reach stay searchable.
+    auto collectEntries = [&] (bool keepUnseenPrevious)
+    {
+        std::vector<SampleLibraryEntry> collected;
+        collected.reserve (entries.size());
+
+        for (size_t i = 0; i < entries.size(); ++i)
+            if (hasEntry[i])
+                collected.push_back (entries[i]);
+
+        if (keepUnseenPrevious)
+            for (size_t i = 0; i < previous->entries.size(); ++i)
+                if (! previousSeen[i])
+                    collected.push_back (previous->entries[i]);
+
+        return collected;
+    };
+
+    if (! stats.cancelled && ! pending.empty())
+    {
+        std::condition_variable readerFinished;
+        std::atomic<bool> cancelled { false };
+        std::atomic<size_t> nextRead { 0 };
+        int readersRunning = juce::jlimit (1, maxReadThreads, juce::jmin ((int) pending.size(), juce::SystemStats::getNumCpus()));
+        int readSincePublish = 0;
+
+        // A background scan keeps its readers at background priority too.
+        auto* currentThread = juce::Thread::getCurrentThread();
+        const auto priority = currentThread != nullptr ? currentThread->getPriority() : juce::Thread::Priority::normal;
+
+        juce::ThreadPool readers (juce::ThreadPoolOptions()
+                                      .withThreadName ("SampleLibraryRead")
+                                      .withNumberOfThreads (readersRunning)
+                                      .withDesiredThreadPriority (priority));
+
+        for (int i = readersRunning; --i >= 0;)
+        {
+            readers.addJob ([&]
+            {
+                juce::AudioFormatManager formatManager;
+                formatManager.registerBasicFormats();
+                const std::function<bool()> readCancelled = [&cancelled] { return cancelled.load(); };
+
+                for (auto index = nextRead++; index < pending.size() && ! cancelled.load(); index = nextRead++)
+                {
+                    const auto& item = pending[index];
+                    auto entry = readEntry (formatManager, item.file, item.fileSize, item.modifiedMs, scanOptions, readCancelled);
+
+                    const std::lock_guard<std::mutex> lock (resultsMutex);
+                    entries[item.slot] = std::move (entry);
+                    hasEntry[item.slot] = true;
+                    ++stats.filesRead;
+                    ++readSincePublish;
+                }
+
+                {
+                    const std::lock_guard<std::mutex> lock (resultsMutex);
+                    --readersRunning;
+                }
+
+                readerFinished.notify_all();
+            });
+        }
+
+        auto nextPublishMs = juce::Time::getMillisecondCounter() + publishIntervalMs;
+        std::unique_lock<std::mutex> lock (resultsMutex);
+
+        while (readersRunning > 0)
+        {
+            readerFinished.wait_for (lock, std::chrono::milliseconds (50));
+
+            if (shouldCancel != nullptr && shouldCancel())
+                cancelled = true;
+
+            if (readersRunning == 0 || readSincePublish == 0 || juce::Time::getMillisecondCounter() < nextPublishMs)
+                continue;
+
+            readSincePublish = 0;
+            auto partial = collectEntries (true);
+            lock.unlock();
+
+            const auto publishStartMs = juce::Time::getMillisecondCounter();
+            publish (std::move (partial));
+            const auto nowMs = juce::Time::getMillisecondCounter();
+            nextPublishMs = nowMs + juce::jmax (publishIntervalMs, publishCostMultiple * (nowMs - publishStartMs));
+
+            lock.lock();
+        }
+
+        stats.cancelled = cancelled.load();
+    }
+
+    if (stats.cancelled)
+    {
+        publish (collectEntries (true));
+    }
+    else
+    {
+        stats.filesRemoved = (int) std::count (previousSeen.begin(), previousSeen.end(), false);
+        publish (collectEntries (false));
+    }
+
+    save();
+    return stats;
+}
+
+void SampleLibraryIndex::startBackgroundScan()
+{
+    const std::lock_guard<std::mutex> lock (scanStateMutex);
+
+    if (scanInProgress)
+    {
+        scanRequested = true;
+        return;
+    }
+
+    // A finished run clears scanInProgress as its last step, so this wait is short.
+    scanInProgress = true;
+    scanThread->waitForThreadToExit (-1);
+    scanThread->startThread (juce::Thread::Priority::background);
+}
+
+void SampleLibraryIndex::stopBackgroundScan()
+{
+    {
+        const std::lock_guard<std::mutex> lock (scanStateMutex);
+        scanRequested = false;
+    }
+
+    scanThread->stopThread (10000);
+
+    const std::lock_guard<std::mutex> lock (scanStateMutex);
+    scanInProgress = false;
+}
+
+bool SampleLibraryIndex::isScanning() const
+{
+    const std::lock_guard<std::mutex> lock (scanStateMutex);
+    return scanInProgress;
+}
+
+bool SampleLibraryIndex::waitForScanForTesting (int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+
+    while (isScanning())
+    {
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        juce::Thread::sleep (5);
+    }
+
+    return true;
+}
+
+//==============================================================================
+std::vector<SampleLibraryEntry> SampleLibraryIndex::search (const juce::String& query, int maxResults) const
+{
+    const auto current = getSnapshot();
+
+    std::vector<std::string> terms;
+    std::optional<juce::Range<double>> tempoRange;
+    std::optional<KeyName> keyFilter;
+
+    for (const auto& word : juce::StringArray::fromTokens (query, true))
+    {
+        const auto lower = word.toLowerCase();
+
+        if (lower.startsWith ("bpm:"))
+        {
+            const auto low = lower.fromFirstOccurrenceOf (":", false, false).upToFirstOccurrenceOf ("-", false, false).getDoubleValue();
+            const auto high = lower.containsChar ('-') ? lower.fromLastOccurrenceOf ("-", false, false).getDoubleValue() : low;
+            tempoRange = juce::Range<double> (juce::jmin (low, high) - 0.5, juce::jmax (low, high) + 0.5);
+        }
+        else if (lower.startsWith ("key:"))
+        {
+            keyFilter = parseKeyName (lower.fromFirstOccurrenceOf (":", false, false));
+            if (! keyFilter.has_value())
+                return {};
+        }
+        else
+        {
+            appendTokens (word, terms);
+        }
+    }
+
+    if (terms.empty() && ! tempoRange.has_value() && ! keyFilter.has_value())
+        return {};
+
+    // Entries carrying a token that starts with term. One-character terms
+    // match whole tokens only, or "a" would pull in most of the library.
+    auto matchesFor = [&current] (const std::string& term)
+    {
+        std::vector<int> matches;
+        auto it = std::lower_bound (current->tokens.begin(), current->tokens.end(), term);
+
+        for (; it != current->tokens.end() && it->compare (0, term.size(), term) == 0; ++it)
+        {
+            if (term.size() == 1 && it->size() != 1)
+                continue;
+
+            const auto& postings = current->postings[(size_t) (it - current->tokens.begin())];
+            matches.insert (matches.end(), postings.begin(), postings.end());
+        }
+
+        std::sort (matches.begin(), matches.end());
+        matches.erase (std::unique (matches.begin(), matches.end()), matches.end());
+        return matches;
+    };
+
+    std::optional<std::vector<int>> candidates;
+    for (const auto& term : terms)
+    {
+        auto matches = matchesFor (term);
+
+        if (candidates.has_value())
+        {
+            std::vector<int> both;
+            std::set_intersection (candidates->begin(), candidates->end(), matches.begin(), matches.end(),
+                                   std::back_inserter (both));
+            candidates = std::move (both);
+        }
+        else
+        {
+            candidates = std::move (matches);
+        }
+
+        if (candidates->empty())
+            return {};
+    }
+
+    // A filter-only query has to look at every entry.
+    if (! candidates.has_value())
+    {
+        candidates.emplace();
+        for (int i = 0; i < (int) current->entries.size(); ++i)
+            if (current->entries[(size_t) i].readable)
+                candidates->push_back (i);
+    }
+
+    std::vector<SampleLibraryEntry> results;
+    for (auto index : *candidates)
+    {
+        const auto& entry = current->entries[(size_t) index];
+
+        if (tempoRange.has_value() && ! tempoRange->contains (entry.tempoBpm))
+            continue;
+
+        if (keyFilter.has_value())
+        {
+            const auto entryKey = parseKeyName (entry.key);
+            if (! entryKey.has_value() || entryKey->pitchClass != keyFilter->pitchClass
+                || (keyFilter->mode >= 0 && entryKey->mode != keyFilter->mode))
+                continue;
+        }
+
+        results.push_back (entry);
+        if ((int) results.size() >= maxResults)
+            break;
+    }
+
+    return results;
+}
+
+int SampleLibraryIndex::getNumEntries() const
+{
+    return (int) getSnapshot()->entries.size();
+}
+
+void SampleLibraryIndex::setEntries (std::vector<SampleLibraryEntry> entries)
+{
+    publish (std::move (entries));
+}
+
+//==============================================================================
+std::shared_ptr<const SampleLibraryIndex::Snapshot> SampleLibraryIndex::getSnapshot() const
+{
+    const std::lock_guard<std::mutex> lock (snapshotMutex);
+    return snapshot;
+}
+
+void SampleLibraryIndex::publish (std::vector<SampleLibraryEntry> entries)
+{
+    auto next = std::make_shared<Snapshot>();
+    next->entries = std::move (entries);
+    std::sort (next->entries.begin(), next->entries.end(),
+               [] (const auto& lhs, const auto& rhs) { return lhs.path < rhs.path; });
+
+    std::unordered_map<std::string, std::vector<int>> postingsByToken;
+    std::vector<std::string> entryTokens;
+
+    for (int i = 0; i < (int) next->entries.size(); ++i)
+    {
+        const auto& entry = next->entries[(size_t) i];
+        if (! entry.readable)
+            continue;
+
+        const auto file = entry.getFile();
+        entryTokens.clear();
+        appendTokens (file.getParentDirectory().getFullPathName(), entryTokens);
+        appendTokens (file.getFileNameWithoutExtension(), entryTokens);
+
+        std::sort (entryTokens.begin(), entryTokens.end());
+        entryTokens.erase (std::unique (entryTokens.begin(), entryTokens.end()), entryTokens.end());
+
+        for (auto& token : entryTokens)
+            postingsByToken[std::move (token)].push_back (i);
+    }
+
+    next->tokens.reserve (postingsByToken.size());
+    for (const auto& [token, postings] : postingsByToken)
+        next->tokens.push_back (token);
+
+    std::sort (next->tokens.begin(), next->tokens.end());
+
+    next->postings.reserve (next->tokens.size());
+    for (const auto& token : next->tokens)
+        next->postings.push_back (std::move (postingsByToken[token]));
+
+    {
+        const std::lock_guard<std::mutex> lock (snapshotMutex);
+        snapshot = std::move (next);
+    }
+
+    sendChangeMessage();
+}
+
+//==============================================================================
+bool SampleLibraryIndex::save() const
+{
+    const std::lock_guard<std::mutex> lock (saveMutex);
+
+    const auto current = getSnapshot();
+    const auto savedRoots = getRoots();
+
+    if (! databaseFile.getParentDirectory().createDirectory())
+        return false;
+
+    juce::TemporaryFile temp (databaseFile);
+    {
+        juce::FileOutputStream fileStream (temp.getFile());
+        if (! fileStream.openedOk())
+            return false;
+
+        juce::GZIPCompressorOutputStream out (fileStream);
+        out.writeInt (databaseMagic);
+        out.writeInt (databaseVersion);
+
+        out.writeInt (savedRoots.size());
+        for (const auto& root : savedRoots)
+            out.writeString (root.getFullPathName());
+
+        out.writeInt ((int) current->entries.size());
+        for (const auto& entry : current->entries)
+        {
+            out.writeString (entry.path);
+            out.writeInt64 (entry.fileSize);
+            out.writeInt64 (entry.modifiedMs);
+            out.writeByte ((char) ((entry.readable ? 1 : 0) | (entry.hasLevels ? 2 : 0) | (entry.hasTempoAndKey ? 4 : 0)));
+            out.writeDouble (entry.durationSeconds);
+            out.writeDouble (entry.sampleRate);
+            out.writeInt (entry.numChannels);
+            out.writeFloat (entry.peakDb);
+            out.writeDouble (entry.integratedLufs);
+            out.writeDouble (entry.tempoBpm);
+            out.writeString (entry.key);
+        }
+
+        out.flush();
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+void SampleLibraryIndex::load()
+{
+    juce::FileInputStream fileStream (databaseFile);
+    if (! fileStream.openedOk())
+        return;
+
+    juce::GZIPDecompressorInputStream in (fileStream);
+    if (in.readInt() != databaseMagic || in.readInt() != databaseVersion)
+        return;
+
+    const auto numRoots = in.readInt();
+    if (numRoots < 0 || numRoots > 10000)
+        return;
+
+    juce::Array<juce::File> loadedRoots;
+    for (int i = 0; i < numRoots; ++i)
+    {
+        const auto path = in.readString();
+        if (juce::File::isAbsolutePath (path))
+            loadedRoots.add (juce::File (path));
+    }
+
+    const auto numEntries = in.readInt();
+    if (numEntries < 0)
+        return;
+
+    std::vector<SampleLibraryEntry> loaded;
+    loaded.reserve ((size_t) juce::jmin (numEntries, 1 << 20));
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        // A truncated file is dropped whole; the next scan rebuilds it.
+        if (in.isExhausted())
+            return;
+
+        SampleLibraryEntry entry;
+        entry.path = in.readString();
+        entry.fileSize = in.readInt64();
+        entry.modifiedMs = in.readInt64();
+
+        const auto flags = (int) in.readByte();
+        entry.readable = (flags & 1) != 0;
+        entry.hasLevels = (flags & 2) != 0;
+        entry.hasTempoAndKey = (flags & 4) != 0;
+
+        entry.durationSeconds = in.readDouble();
+        entry.sampleRate = in.readDouble();
+        entry.numChannels = in.readInt();
+        entry.peakDb = in.readFloat();
+        entry.integratedLufs = in.readDouble();
+        entry.tempoBpm = in.readDouble();
+        entry.key = in.readString();
+
+        if (juce::File::isAbsolutePath (entry.path))
+            loaded.push_back (std::move (entry));
+    }
+
+    setRoots (loadedRoots);
+    publish (std::move (loaded));
+}
+
+} // namespace waive
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace waive
+{
+
+/** One audio file in the sample library index. */
+struct SampleLibraryEntry
+{
+    juce::String path;
+    int64 fileSize = 0;
+    int64 modifiedMs = 0;               // modification time when the file was read
+    bool readable = false;              // false for files no format could open; kept so they aren't retried
+    double durationSeconds = 0.0;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    bool hasLevels = false;             // peakDb and integratedLufs were measured
+    float peakDb = -120.0f;
+    double integratedLufs = -120.0;
+    bool hasTempoAndKey = false;        // tempo and key analysis ran; either may still be unknown
+    double tempoBpm = 0.0;              // 0 when unknown
+    juce::String key;                   // e.g. "A minor"; empty when unknown
+
+    juce::File getFile() const  { return juce::File (path); }
+};
+
+struct SampleLibraryScanOptions
+{
+    bool measureLevels = true;          // peak and integrated LUFS, from one read of each new file
+    bool detectTempoAndKey = false;     // onset and chroma analysis of files up to maxAnalysisSeconds
+    double maxAnalysisSeconds = 60.0;
+};
+
+struct SampleLibraryScanStats
+{
+    int filesSeen = 0;
+    int filesRead = 0;                  // new or changed since the last scan
+    int filesRemoved = 0;
+    bool cancelled = false;
+};
+
+/** A persistent index of the audio files under a set of library folders.
+
+    Scans walk the folders and only open files that are new, or whose size or
+    modification time changed, so a rescan of an unchanged library is a
+    directory walk. Those files are read after the walk on a few threads at
+    the scanning thread's priority. The entries are saved to a compressed database file and
+    loaded back on construction.
+
+    Searches run against an immutable snapshot with a sorted token list over
+    file and folder names, so a query only touches the postings of the tokens
+    it matches, not every file. A scan publishes a new snapshot about once a
+    second while it reads, less often when the library is large enough that
+    building one takes a while, and again when it finishes. It sends a change
+    message each time. Searching is safe from any thread while a scan runs.
+
+    Query syntax: whitespace-separated terms, each matching the start of a
+    name token, all of which must match. "bpm:120" or "bpm:118-124" and
+    "key:am" / "key:c#" filter on the analysed tempo and key. */
+class SampleLibraryIndex : public juce::ChangeBroadcaster
+{
+public:
+    /** Loads databaseFile if it exists. Nothing is scanned until rescan() or
+        startBackgroundScan(). */
+    explicit SampleLibraryIndex (const juce::File& databaseFile);
+    ~SampleLibraryIndex() override;
+
+    /** Waive/library/sample_index.db in the user's application data folder. */
+    static juce::File getDefaultDatabaseFile();
+    static juce::String getAudioFileWildcard();
+
+    void setRoots (const juce::Array<juce::File>& roots);
+    void addRoot (const juce::File& root);
+    juce::Array<juce::File> getRoots() const;
+
+    void setScanOptions (const SampleLibraryScanOptions& options);
+    SampleLibraryScanOptions getScanOptions() const;
+
+    /** Brings the index up to date with the roots on the calling thread and
+        saves it. Files that disappeared are dropped only when the scan
+        completes; a cancelled scan keeps them. */
+    SampleLibraryScanStats rescan (const std::function<bool()>& shouldCancel = {});
+
+    /** Runs rescan() on a background thread. A request while a scan is running
+        queues one more scan after it. */
+    void startBackgroundScan();
+    void stopBackgroundScan();
+    bool isScanning() const;
+    bool waitForScanForTesting (int timeoutMs = 10000);
+
+    /** Results are ordered by path. */
+    std::vector<SampleLibraryEntry> search (const juce::String& query, int maxResults = 200) const;
+
+    int getNumEntries() const;
+
+    /** Replaces every entry and rebuilds the search tokens. */
+    void setEntries (std::vector<SampleLibraryEntry> entries);
+
+    bool save() const;
+    juce::File getDatabaseFile() const  { return databaseFile; }
+
+private:
+    struct Snapshot;
+    class ScanThread;
+
+    std::shared_ptr<const Snapshot> getSnapshot() const;
+    void publish (std::vector<SampleLibraryEntry> entries);
+    void load();
+
+    const juce::File databaseFile;
+
+    mutable std::mutex snapshotMutex;
+    std::shared_ptr<const Snapshot> snapshot;
+
+    mutable std::mutex settingsMutex;
+    juce::Array<juce::File> roots;
+    SampleLibraryScanOptions options;
+
+    std::mutex rescanMutex;             // one rescan at a time, background or not
+    mutable std::mutex saveMutex;
+
+    mutable std::mutex scanStateMutex;
+    bool scanInProgress = false;
+    bool scanRequested = false;
+    std::unique_ptr<ScanThread> scanThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleLibraryIndex)
+};
+
+} // namespace waive
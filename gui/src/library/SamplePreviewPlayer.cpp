@@ -0,0 +1,81 @@
+#include "SamplePreviewPlayer.h"
+
+namespace waive
+{
+
+SamplePreviewPlayer::SamplePreviewPlayer (juce::AudioDeviceManager& deviceManagerToUse)
+    : deviceManager (deviceManagerToUse)
+{
+    formatManager.registerBasicFormats();
+
+    // Disk reads must keep ahead of the device, so this thread outranks the
+    // background scanners.
+    readAheadThread.startThread (juce::Thread::Priority::high);
+
+    sourcePlayer.setSource (&transport);
+    deviceManager.addAudioCallback (&sourcePlayer);
+}
+
+SamplePreviewPlayer::~SamplePreviewPlayer()
+{
+    deviceManager.removeAudioCallback (&sourcePlayer);
+    sourcePlayer.setSource (nullptr);
+    transport.setSource (nullptr);
+    readAheadThread.stopThread (1000);
+}
+
+juce::Result SamplePreviewPlayer::preview (const juce::File& file, double startSeconds)
+{
+    if (file != currentFile || readerSource == nullptr)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+        if (reader == nullptr || reader->sampleRate <= 0.0)
+            return juce::Result::fail ("Cannot preview " + file.getFileName() + ": unsupported or unreadable file");
+
+        const auto sourceSampleRate = reader->sampleRate;
+        const auto numChannels = (int) reader->numChannels;
+        auto newSource = std::make_unique<juce::AudioFormatReaderSource> (reader.release(), true);
+
+        // setSource stops playback and swaps under the transport's callback lock.
+        transport.setSource (newSource.get(), readAheadSamples, &readAheadThread, sourceSampleRate, numChannels);
+        readerSource = std::move (newSource);
+        currentFile = file;
+    }
+
+    transport.setPosition (juce::jmax (0.0, startSeconds));
+    transport.start();
+    return juce::Result::ok();
+}
+
+void SamplePreviewPlayer::stop()
+{
+    transport.stop();
+}
+
+bool SamplePreviewPlayer::isPlaying() const
+{
+    return transport.isPlaying();
+}
+
+void SamplePreviewPlayer::setPosition (double seconds)
+{
+    if (readerSource != nullptr)
+        transport.setPosition (juce::jlimit (0.0, getLengthSeconds(), seconds));
+}
+
+double SamplePreviewPlayer::getPosition() const
+{
+    return transport.getCurrentPosition();
+}
+
+double SamplePreviewPlayer::getLengthSeconds() const
+{
+    return transport.getLengthInSeconds();
+}
+
+void SamplePreviewPlayer::setGain (float newGain)
+{
+    transport.setGain (newGain);
+}
+
+} // namespace waive
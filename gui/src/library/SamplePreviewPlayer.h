@@ -0,0 +1,54 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+
+namespace waive
+{
+
+/** Auditions library files on the audio device, outside the edit.
+
+    The file streams from disk through an AudioTransportSource whose
+    read-ahead buffer is filled on a dedicated thread, so starting a preview
+    only opens the file header and playback begins on the next audio block.
+    The player is one more callback on the device manager, mixed in after
+    the engine, so it never touches the edit or its transport. */
+class SamplePreviewPlayer
+{
+public:
+    explicit SamplePreviewPlayer (juce::AudioDeviceManager& deviceManager);
+    ~SamplePreviewPlayer();
+
+    /** Plays file from startSeconds. Previewing the file already loaded just
+        moves the play position, so it costs no reopen. */
+    juce::Result preview (const juce::File& file, double startSeconds = 0.0);
+    void stop();
+    bool isPlaying() const;
+
+    /** Scrubs the loaded file; playback continues from the new position. */
+    void setPosition (double seconds);
+    double getPosition() const;
+    double getLengthSeconds() const;
+    juce::File getFile() const { return currentFile; }
+
+    void setGain (float newGain);
+
+    /** The source the device plays, for driving the player without a device. */
+    juce::AudioSource& getAudioSourceForTesting() { return transport; }
+
+    /** Samples buffered ahead of the play position; about 0.7 s at 48 kHz. */
+    static constexpr int readAheadSamples = 32768;
+
+private:
+    juce::AudioDeviceManager& deviceManager;
+    juce::AudioFormatManager formatManager;
+    juce::TimeSliceThread readAheadThread { "SamplePreviewReadAhead" };
+    juce::AudioTransportSource transport;
+    std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
+    juce::AudioSourcePlayer sourcePlayer;
+    juce::File currentFile;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplePreviewPlayer)
+};
+
+} // namespace waive
@@ -2,10 +2,12 @@
 
 #include <algorithm>
 #include <limits>
+#include <optional>
 #include <tracktion_engine/tracktion_engine.h>
 
 #include "AudioAnalysis.h"
 #include "ClipTrackIndexMap.h"
+#include "CrossCorrelation.h"
 #include "EditSession.h"
 #include "JobQueue.h"
 #include "PathSanitizer.h"
@@ -23,10 +25,15 @@ struct ClipPlanInput
     te::EditItemID clipID;
     juce::String clipName;
     juce::File sourceFile;
+    waive::AudioAnalysisRange analysisRange;
     int trackIndex = -1;
     double clipStartSeconds = 0.0;
+    double clipLengthSeconds = 0.0;
 };
 
+// Below this the best match is more likely noise than the same source.
+constexpr float minimumCorrelation = 0.3f;
+
 double parseThresholdDb (const juce::var& params)
 {
     double thresholdDb = -30.0;
@@ -53,6 +60,36 @@ double parseMaxShiftSeconds (const juce::var& params)
     return juce::jlimit (1.0, 5000.0, maxShiftMs) / 1000.0;
 }
 
+bool parseCrossCorrelationMethod (const juce::var& params)
+{
+    if (auto* paramsObj = params.getDynamicObject())
+        return paramsObj->getProperty ("method").toString() == "cross_correlation";
+
+    return false;
+}
+
+bool parseDetectPolarity (const juce::var& params)
+{
+    if (auto* paramsObj = params.getDynamicObject())
+        if (paramsObj->hasProperty ("detect_polarity"))
+            return (bool) paramsObj->getProperty ("detect_polarity");
+
+    return false;
+}
+
+double parseWindowSeconds (const juce::var& params)
+{
+    double windowMs = 10000.0;
+
+    if (auto* paramsObj = params.getDynamicObject())
+    {
+        if (paramsObj->hasProperty ("window_ms"))
+            windowMs = (double) paramsObj->getProperty ("window_ms");
+    }
+
+    return juce::jlimit (250.0, 60000.0, windowMs) / 1000.0;
+}
+
 int parseAnalysisDelayMs (const juce::var& params)
 {
     int delayMs = 0;
@@ -80,6 +117,59 @@ void sleepWithCancellation (waive::ProgressReporter& reporter, int delayMs)
     }
 }
 
+struct CorrelatedClip
+{
+    double newStartSeconds = 0.0;
+    float correlation = 0.0f;
+    bool polarityInverted = false;
+};
+
+/** Lines target up with reference over the part of the timeline where both
+    play. Reads at most windowSeconds of the reference and that plus twice
+    maxShiftSeconds of the target, however long the clips are. */
+std::optional<CorrelatedClip> correlateWithReference (const ClipPlanInput& reference,
+                                                      const ClipPlanInput& target,
+                                                      double windowSeconds,
+                                                      double maxShiftSeconds,
+                                                      bool detectPolarity,
+                                                      const std::function<bool()>& shouldCancel)
+{
+    const auto windowStart = juce::jmax (reference.clipStartSeconds, target.clipStartSeconds);
+    const auto referenceOffset = windowStart - reference.clipStartSeconds;
+    const auto windowLength = juce::jmin (windowSeconds, reference.clipLengthSeconds - referenceOffset);
+    if (windowLength < 0.05)
+        return std::nullopt;
+
+    const auto referenceSignal = waive::readClipSignal (reference.sourceFile, reference.analysisRange,
+                                                        referenceOffset, windowLength, 0.0, shouldCancel);
+    if (! referenceSignal.valid)
+        return std::nullopt;
+
+    const auto targetSignal = waive::readClipSignal (target.sourceFile, target.analysisRange,
+                                                     windowStart - target.clipStartSeconds - maxShiftSeconds,
+                                                     windowLength + 2.0 * maxShiftSeconds,
+                                                     referenceSignal.sampleRate, shouldCancel);
+    if (! targetSignal.valid)
+        return std::nullopt;
+
+    waive::CorrelationSettings settings;
+    settings.detectPolarity = detectPolarity;
+
+    const auto match = waive::findBestLag (referenceSignal.samples, targetSignal.samples, settings);
+    if (! match.valid || std::abs (match.correlation) < minimumCorrelation)
+        return std::nullopt;
+
+    // The target window starts maxShiftSeconds before the reference window, so
+    // a match at that lag means the clips already line up.
+    const auto shiftSeconds = maxShiftSeconds - (double) match.lagSamples / referenceSignal.sampleRate;
+
+    CorrelatedClip result;
+    result.newStartSeconds = target.clipStartSeconds + shiftSeconds;
+    result.correlation = match.correlation;
+    result.polarityInverted = match.polarityInverted;
+    return result;
+}
+
 void writePlanArtifact (const juce::File& cacheDirectory, const juce::String& toolName, waive::ToolPlan& plan)
 {
     if (cacheDirectory == juce::File())
@@ -107,8 +197,10 @@ ToolDescription AlignClipsByTransientTool::describe() const
     ToolDescription desc;
     desc.name = "align_clips_by_transient";
     desc.displayName = "Align Clips By Transient";
-    desc.version = "1.0.0";
-    desc.description = "Align selected clips by their first detected transient.";
+    desc.version = "1.1.0";
+    desc.description = "Align selected clips by their first detected transient, or by cross-correlating them "
+                       "against the earliest clip (for several microphones on one source).";
+    desc.speculativePlanning = true;
 
     auto* schemaObj = new juce::DynamicObject();
     schemaObj->setProperty ("type", "object");
@@ -131,6 +223,27 @@ ToolDescription AlignClipsByTransientTool::describe() const
     maxShiftObj->setProperty ("description", "Maximum clip shift in milliseconds");
     propsObj->setProperty ("max_shift_ms", juce::var (maxShiftObj));
 
+    auto* methodObj = new juce::DynamicObject();
+    methodObj->setProperty ("type", "string");
+    methodObj->setProperty ("enum", juce::Array<juce::var> { "transient", "cross_correlation" });
+    methodObj->setProperty ("default", "transient");
+    methodObj->setProperty ("description", "Align by first transient, or by cross-correlation with the earliest selected clip");
+    propsObj->setProperty ("method", juce::var (methodObj));
+
+    auto* polarityObj = new juce::DynamicObject();
+    polarityObj->setProperty ("type", "boolean");
+    polarityObj->setProperty ("default", false);
+    polarityObj->setProperty ("description", "Also match inverted polarity and report it (cross_correlation only)");
+    propsObj->setProperty ("detect_polarity", juce::var (polarityObj));
+
+    auto* windowObj = new juce::DynamicObject();
+    windowObj->setProperty ("type", "number");
+    windowObj->setProperty ("minimum", 250.0);
+    windowObj->setProperty ("maximum", 60000.0);
+    windowObj->setProperty ("default", 10000.0);
+    windowObj->setProperty ("description", "Length of audio compared per clip in milliseconds (cross_correlation only)");
+    propsObj->setProperty ("window_ms", juce::var (windowObj));
+
     auto* delayObj = new juce::DynamicObject();
     delayObj->setProperty ("type", "integer");
     delayObj->setProperty ("minimum", 0);
@@ -144,6 +257,9 @@ ToolDescription AlignClipsByTransientTool::describe() const
     auto* defaults = new juce::DynamicObject();
     defaults->setProperty ("threshold_db", -30.0);
     defaults->setProperty ("max_shift_ms", 500.0);
+    defaults->setProperty ("method", "transient");
+    defaults->setProperty ("detect_polarity", false);
+    defaults->setProperty ("window_ms", 10000.0);
     defaults->setProperty ("analysis_delay_ms", 0);
     desc.defaultParams = juce::var (defaults);
 
@@ -186,6 +302,8 @@ juce::Result AlignClipsByTransientTool::preparePlan (const ToolExecutionContext&
         input.sourceFile = sourceFile;
         input.trackIndex = found->second;
         input.clipStartSeconds = clip->getPosition().getStart().inSeconds();
+        input.clipLengthSeconds = clip->getPosition().getLength().inSeconds();
+        input.analysisRange = AudioAnalysisRange::forClip (*waveClip);
 
         clipsToProcess.push_back (std::move (input));
     }
@@ -197,6 +315,9 @@ juce::Result AlignClipsByTransientTool::preparePlan (const ToolExecutionContext&
     const auto thresholdGain = juce::Decibels::decibelsToGain ((float) thresholdDb);
     const auto transientRiseGain = juce::jmax (0.01f, thresholdGain * 0.5f);
     const auto maxShiftSeconds = parseMaxShiftSeconds (params);
+    const auto useCrossCorrelation = parseCrossCorrelationMethod (params);
+    const auto detectPolarity = parseDetectPolarity (params);
+    const auto windowSeconds = parseWindowSeconds (params);
     const auto analysisDelayMs = parseAnalysisDelayMs (params);
     const auto cacheDirectory = context.projectCacheDirectory;
     const auto description = describe();
@@ -204,7 +325,8 @@ juce::Result AlignClipsByTransientTool::preparePlan (const ToolExecutionContext&
     outTask.jobName = "Plan: " + description.displayName;
     outTask.run = [clipsToProcess = std::move (clipsToProcess),
                    thresholdGain, transientRiseGain, maxShiftSeconds,
-                   analysisDelayMs, cacheDirectory, params, description] (ProgressReporter& reporter)
+                   useCrossCorrelation, detectPolarity, windowSeconds,
+                   analysisDelayMs, params, description] (ProgressReporter& reporter)
     {
         ToolPlan plan;
         plan.toolName = description.name;
@@ -212,6 +334,73 @@ juce::Result AlignClipsByTransientTool::preparePlan (const ToolExecutionContext&
         plan.planID = juce::Uuid().toString();
         plan.inputParams = params;
 
+        if (useCrossCorrelation)
+        {
+            // The earliest clip is the reference and stays put; every other
+            // clip is correlated against it in parallel.
+            const auto referenceIt = std::min_element (clipsToProcess.begin(), clipsToProcess.end(),
+                                                       [] (const auto& a, const auto& b)
+                                                       { return a.clipStartSeconds < b.clipStartSeconds; });
+            const auto referenceIndex = (int) std::distance (clipsToProcess.begin(), referenceIt);
+            const auto& reference = *referenceIt;
+
+            std::vector<std::optional<CorrelatedClip>> matches (clipsToProcess.size());
+            runInParallel (reporter, (int) clipsToProcess.size(), [&] (int i)
+            {
+                if (i == referenceIndex)
+                    return;
+
+                sleepWithCancellation (reporter, analysisDelayMs);
+                matches[(size_t) i] = correlateWithReference (reference, clipsToProcess[(size_t) i],
+                                                              windowSeconds, maxShiftSeconds, detectPolarity,
+                                                              [&reporter]() { return reporter.isCancelled(); });
+            }, "Correlated");
+
+            if (reporter.isCancelled())
+                return plan;
+
+            int invertedCount = 0;
+            for (size_t i = 0; i < clipsToProcess.size(); ++i)
+            {
+                if (! matches[i].has_value())
+                    continue;
+
+                const auto& input = clipsToProcess[i];
+                const auto& match = *matches[i];
+                const auto newStartSeconds = juce::jmax (0.0, match.newStartSeconds);
+
+                if (match.polarityInverted)
+                    ++invertedCount;
+
+                // Sample-accurate: anything under a millisecond still counts.
+                if (std::abs (newStartSeconds - input.clipStartSeconds) < 1.0e-6 && ! match.polarityInverted)
+                    continue;
+
+                ToolDiffEntry change;
+                change.kind = ToolDiffKind::clipMoved;
+                change.trackIndex = input.trackIndex;
+                change.clipID = input.clipID;
+                change.targetName = input.clipName;
+                change.parameterID = "clip.start_seconds";
+                change.beforeValue = input.clipStartSeconds;
+                change.afterValue = newStartSeconds;
+                change.summary = "Move clip '" + input.clipName + "' "
+                                 + juce::String (input.clipStartSeconds, 6) + " s -> "
+                                 + juce::String (newStartSeconds, 6) + " s (correlation "
+                                 + juce::String (std::abs (match.correlation), 2)
+                                 + (match.polarityInverted ? ", polarity inverted)" : ")");
+
+                plan.changes.add (change);
+            }
+
+            plan.summary = "Align " + juce::String (plan.changes.size()) + " clip(s) to '"
+                           + reference.clipName + "' by cross-correlation";
+            if (invertedCount > 0)
+                plan.summary << "; " << invertedCount << " clip(s) have inverted polarity";
+
+            return plan;
+        }
+
         struct ClipTransient
         {
             ClipPlanInput input;
@@ -233,6 +422,7 @@ juce::Result AlignClipsByTransientTool::preparePlan (const ToolExecutionContext&
             const auto& clipInput = clipsToProcess[(size_t) i];
             const auto analysis = analyseAudioFile (
                 clipInput.sourceFile,
+                clipInput.analysisRange,
                 thresholdGain,
                 transientRiseGain,
                 [&reporter]() { return reporter.isCancelled(); });
@@ -244,7 +434,7 @@ juce::Result AlignClipsByTransientTool::preparePlan (const ToolExecutionContext&
                 continue;
             }
 
-            const auto transientOffsetSeconds = (double) analysis.firstTransientSample / analysis.sampleRate;
+            const auto transientOffsetSeconds = analysis.toClipSeconds (analysis.firstTransientSample);
 
             ClipTransient transient;
             transient.input = clipInput;
@@ -296,9 +486,12 @@ juce::Result AlignClipsByTransientTool::preparePlan (const ToolExecutionContext&
         plan.summary = "Align " + juce::String (plan.changes.size())
                        + " clip(s) by detected transient";
 
-        writePlanArtifact (cacheDirectory, description.name, plan);
         return plan;
     };
+    outTask.writeArtifact = [cacheDirectory, toolName = description.name] (ToolPlan& plan)
+    {
+        writePlanArtifact (cacheDirectory, toolName, plan);
+    };
 
     return juce::Result::ok();
 }
@@ -313,17 +506,20 @@ juce::Result AlignClipsByTransientTool::apply (const ToolExecutionContext& conte
         return juce::Result::fail ("Tool plan has no changes to apply");
 
     int appliedCount = 0;
-    const auto ok = context.editSession.performEdit ("Align Clips By Transient", [&] (te::Edit& edit)
+    const auto ok = context.editSession.performBulkEdit ("Align Clips By Transient", [&] (te::Edit& edit)
     {
+        const auto clipsByID = waive::buildClipLookup (edit);
+
         for (const auto& change : plan.changes)
         {
             if (change.kind != ToolDiffKind::clipMoved || change.parameterID != "clip.start_seconds")
                 continue;
 
-            auto* clip = te::findClipForID (edit, change.clipID);
-            if (clip == nullptr)
+            const auto found = clipsByID.find (change.clipID);
+            if (found == clipsByID.end())
                 continue;
 
+            auto* clip = found->second;
             clip->setStart (te::TimePosition::fromSeconds (change.afterValue), true, false);
             ++appliedCount;
         }
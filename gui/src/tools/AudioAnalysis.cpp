@@ -1,5 +1,6 @@
 #include "AudioAnalysis.h"
 #include "AudioAnalysisCache.h"
+#include "LoudnessMeter.h"
 
 #include <algorithm>
 #include <cmath>
@@ -7,12 +8,133 @@
 namespace waive
 {
 
+namespace
+{
+constexpr int analysisBlockSize = 8192;
+
+/** Opens the file and fills in the summary's format and range fields. Returns
+    nullptr, leaving the summary invalid, when there is nothing to read. */
+std::unique_ptr<juce::AudioFormatReader> openRange (const juce::File& sourceFile,
+                                                    const AudioAnalysisRange& range,
+                                                    AudioAnalysisSummary& summary)
+{
+    if (! sourceFile.existsAsFile())
+        return nullptr;
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (sourceFile));
+    if (reader == nullptr || reader->numChannels <= 0 || reader->lengthInSamples <= 0)
+        return nullptr;
+
+    // Validate sample rate to prevent division by zero downstream
+    if (reader->sampleRate <= 0)
+        return nullptr;
+
+    summary.sampleRate = reader->sampleRate;
+    summary.speedRatio = range.getSpeedRatio();
+    summary.rangeStartSample = juce::jmin (reader->lengthInSamples,
+                                           (int64) std::llround (range.getSourceStartSeconds() * reader->sampleRate));
+    summary.totalSamples = reader->lengthInSamples - summary.rangeStartSample;
+
+    if (range.getSourceLengthSeconds() >= 0.0)
+        summary.totalSamples = juce::jmin (summary.totalSamples,
+                                           (int64) std::llround (range.getSourceLengthSeconds() * reader->sampleRate));
+
+    if (summary.totalSamples <= 0)
+    {
+        summary.totalSamples = 0;
+        return nullptr;
+    }
+
+    summary.valid = true;
+    return reader;
+}
+
+/** Reads the summary's range block by block and calls processSample with each
+    sample's position (relative to the range start) and its peak across
+    channels. The summary's peak and RMS are filled in on the way, and
+    processBlock, if given, sees every block as read. Returns false, marking
+    the summary cancelled, if shouldCancel fires. */
+template <typename SampleFunction>
+bool forEachSamplePeak (juce::AudioFormatReader& reader,
+                        AudioAnalysisSummary& summary,
+                        const std::function<bool()>& shouldCancel,
+                        SampleFunction&& processSample,
+                        const std::function<void (const juce::AudioBuffer<float>&, int)>& processBlock = {})
+{
+    juce::AudioBuffer<float> buffer ((int) reader.numChannels, analysisBlockSize);
+    double sumOfSquares = 0.0;
+    int64 samplesRead = 0;
+
+    for (int64 samplePos = 0; samplePos < summary.totalSamples;)
+    {
+        if (shouldCancel && shouldCancel())
+        {
+            summary.cancelled = true;
+            summary.valid = false;
+            return false;
+        }
+
+        const auto samplesThisBlock = (int) std::min<int64> ((int64) analysisBlockSize,
+                                                             summary.totalSamples - samplePos);
+        if (! reader.read (&buffer, 0, samplesThisBlock, summary.rangeStartSample + samplePos, true, true))
+            break;
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            const auto rms = (double) buffer.getRMSLevel (ch, 0, samplesThisBlock);
+            sumOfSquares += rms * rms * (double) samplesThisBlock;
+        }
+
+        samplesRead += samplesThisBlock;
+
+        if (processBlock)
+            processBlock (buffer, samplesThisBlock);
+
+        for (int s = 0; s < samplesThisBlock; ++s)
+        {
+            float samplePeak = 0.0f;
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                samplePeak = juce::jmax (samplePeak, std::abs (buffer.getSample (ch, s)));
+
+            summary.peakGain = juce::jmax (summary.peakGain, samplePeak);
+            processSample (samplePos + s, samplePeak);
+        }
+
+        samplePos += samplesThisBlock;
+    }
+
+    if (samplesRead > 0)
+        summary.rmsGain = (float) std::sqrt (sumOfSquares / ((double) samplesRead * (double) buffer.getNumChannels()));
+
+    return true;
+}
+}
+
 AudioAnalysisSummary analyseAudioFile (const juce::File& sourceFile,
                                        float activityThresholdGain,
                                        float transientRiseThresholdGain,
                                        const std::function<bool()>& shouldCancel,
                                        AudioAnalysisCache* cache)
 {
+    return analyseAudioFile (sourceFile, AudioAnalysisRange(), activityThresholdGain,
+                             transientRiseThresholdGain, shouldCancel, cache);
+}
+
+AudioAnalysisSummary analyseAudioFile (const juce::File& sourceFile,
+                                       const AudioAnalysisRange& range,
+                                       float activityThresholdGain,
+                                       float transientRiseThresholdGain,
+                                       const std::function<bool()>& shouldCancel,
+                                       AudioAnalysisCache* cache,
+                                       bool measureLoudness)
+{
+    const auto rangeStartSeconds = range.getSourceStartSeconds();
+    const auto rangeLengthSeconds = range.getSourceLengthSeconds();
+
 #ifdef WAIVE_PROFILE_TOOLS
     const auto startTime = juce::Time::getMillisecondCounterHiRes();
     const auto fileSize = sourceFile.getSize();
@@ -22,12 +144,17 @@ AudioAnalysisSummary analyseAudioFile (const juce::File& sourceFile,
 
     if (cache != nullptr)
     {
-        AudioAnalysisCache::CacheKey key { sourceFile, activityThresholdGain, transientRiseThresholdGain };
-        if (auto cached = cache->get (key))
+        AudioAnalysisCache::CacheKey key { sourceFile, activityThresholdGain, transientRiseThresholdGain,
+                                           rangeStartSeconds, rangeLengthSeconds };
+        auto cached = cache->get (key);
+        if (cached.has_value() && (cached->hasLoudness || ! measureLoudness))
         {
 #ifdef WAIVE_PROFILE_TOOLS
             DBG ("AudioAnalysis: Cache HIT for " << sourceFile.getFileName());
 #endif
+            // Entries are keyed by source time, so clips playing the same
+            // source region at different speeds share one analysis.
+            cached->speedRatio = range.getSpeedRatio();
             return *cached;
         }
 #ifdef WAIVE_PROFILE_TOOLS
@@ -39,81 +166,53 @@ AudioAnalysisSummary analyseAudioFile (const juce::File& sourceFile,
     }
 
     AudioAnalysisSummary summary;
-
-    if (! sourceFile.existsAsFile())
-        return summary;
-
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-
-    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (sourceFile));
-    if (reader == nullptr || reader->numChannels <= 0 || reader->lengthInSamples <= 0)
-        return summary;
-
-    // Validate sample rate to prevent division by zero downstream
-    if (reader->sampleRate <= 0)
+    auto reader = openRange (sourceFile, range, summary);
+    if (reader == nullptr)
         return summary;
 
-    summary.valid = true;
-    summary.sampleRate = reader->sampleRate;
-    summary.totalSamples = reader->lengthInSamples;
-
-    constexpr int blockSize = 8192;
-    juce::AudioBuffer<float> buffer ((int) reader->numChannels, blockSize);
-
     const float threshold = juce::jmax (0.0f, activityThresholdGain);
     const float transientRise = juce::jmax (0.0f, transientRiseThresholdGain);
-
-    int64 samplePos = 0;
     float envelope = 0.0f;
 
-    while (samplePos < summary.totalSamples)
+    LoudnessMeter meter;
+    std::function<void (const juce::AudioBuffer<float>&, int)> measureBlock;
+    if (measureLoudness)
     {
-        if (shouldCancel && shouldCancel())
+        meter.prepare (summary.sampleRate, (int) reader->numChannels);
+        measureBlock = [&meter] (const juce::AudioBuffer<float>& block, int numSamples)
         {
-            summary.cancelled = true;
-            summary.valid = false;
-            return summary;
-        }
-
-        const auto samplesThisBlock = (int) std::min<int64> ((int64) blockSize,
-                                                             summary.totalSamples - samplePos);
-        if (samplesThisBlock <= 0)
-            break;
-
-        if (! reader->read (&buffer, 0, samplesThisBlock, samplePos, true, true))
-            break;
+            meter.process (block, 0, numSamples);
+        };
+    }
 
-        for (int s = 0; s < samplesThisBlock; ++s)
+    const auto completed = forEachSamplePeak (*reader, summary, shouldCancel, [&] (int64 position, float samplePeak)
+    {
+        if (samplePeak >= threshold)
         {
-            float samplePeak = 0.0f;
-
-            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-                samplePeak = juce::jmax (samplePeak, std::abs (buffer.getSample (ch, s)));
-
-            summary.peakGain = juce::jmax (summary.peakGain, samplePeak);
+            if (summary.firstAboveSample < 0)
+                summary.firstAboveSample = position;
 
-            const auto absoluteSample = samplePos + s;
-            if (samplePeak >= threshold)
-            {
-                if (summary.firstAboveSample < 0)
-                    summary.firstAboveSample = absoluteSample;
+            summary.lastAboveSample = position;
+        }
 
-                summary.lastAboveSample = absoluteSample;
-            }
+        if (summary.firstTransientSample < 0
+            && summary.firstAboveSample >= 0
+            && samplePeak >= threshold
+            && (samplePeak - envelope) >= transientRise)
+        {
+            summary.firstTransientSample = position;
+        }
 
-            if (summary.firstTransientSample < 0
-                && summary.firstAboveSample >= 0
-                && samplePeak >= threshold
-                && (samplePeak - envelope) >= transientRise)
-            {
-                summary.firstTransientSample = absoluteSample;
-            }
+        envelope += (samplePeak - envelope) * 0.01f;
+    }, measureBlock);
 
-            envelope += (samplePeak - envelope) * 0.01f;
-        }
+    if (! completed)
+        return summary;
 
-        samplePos += samplesThisBlock;
+    if (measureLoudness)
+    {
+        summary.integratedLufs = meter.getResult().integratedLufs;
+        summary.hasLoudness = true;
     }
 
     if (summary.firstTransientSample < 0)
@@ -121,7 +220,8 @@ AudioAnalysisSummary analyseAudioFile (const juce::File& sourceFile,
 
     if (cache != nullptr && summary.valid)
     {
-        AudioAnalysisCache::CacheKey key { sourceFile, activityThresholdGain, transientRiseThresholdGain };
+        AudioAnalysisCache::CacheKey key { sourceFile, activityThresholdGain, transientRiseThresholdGain,
+                                           rangeStartSeconds, rangeLengthSeconds };
         cache->put (key, summary);
     }
 
@@ -134,4 +234,84 @@ AudioAnalysisSummary analyseAudioFile (const juce::File& sourceFile,
     return summary;
 }
 
+AudioAnalysisSummary detectActiveRegions (const juce::File& sourceFile,
+                                          const AudioAnalysisRange& range,
+                                          const ActivityGateSettings& gate,
+                                          const std::function<bool()>& shouldCancel)
+{
+    AudioAnalysisSummary summary;
+    auto reader = openRange (sourceFile, range, summary);
+    if (reader == nullptr)
+        return summary;
+
+    const float openThreshold = juce::jmax (0.0f, gate.openThresholdGain);
+    const float closeThreshold = juce::jlimit (0.0f, openThreshold, gate.closeThresholdGain);
+    const auto holdSamples = (int64) std::llround (juce::jmax (0.0, gate.holdSeconds) * summary.sampleRate);
+    const auto minGapSamples = (int64) std::llround (juce::jmax (0.0, gate.minGapSeconds) * summary.sampleRate);
+    const auto minRegionSamples = (int64) std::llround (juce::jmax (0.0, gate.minRegionSeconds) * summary.sampleRate);
+
+    auto& regions = summary.activeRegions;
+    bool gateOpen = false;
+    int64 regionStart = 0;
+    int64 lastActive = 0;
+
+    auto closeGate = [&]
+    {
+        gateOpen = false;
+        const auto regionEnd = lastActive + 1;
+
+        if (! regions.empty() && regionStart - regions.back().endSample < minGapSamples)
+            regions.back().endSample = regionEnd;
+        else
+            regions.push_back ({ regionStart, regionEnd });
+
+        // Drop isolated blips, but only once nothing later can merge into them.
+        if (regions.size() > 1)
+        {
+            const auto& previous = regions[regions.size() - 2];
+            if (previous.endSample - previous.startSample < minRegionSamples)
+                regions.erase (regions.end() - 2);
+        }
+    };
+
+    const auto completed = forEachSamplePeak (*reader, summary, shouldCancel, [&] (int64 position, float samplePeak)
+    {
+        if (! gateOpen)
+        {
+            if (samplePeak >= openThreshold)
+            {
+                gateOpen = true;
+                regionStart = position;
+                lastActive = position;
+            }
+        }
+        else if (samplePeak >= closeThreshold)
+        {
+            lastActive = position;
+        }
+        else if (position - lastActive > holdSamples)
+        {
+            closeGate();
+        }
+    });
+
+    if (! completed)
+        return summary;
+
+    if (gateOpen)
+        closeGate();
+
+    if (! regions.empty() && regions.back().endSample - regions.back().startSample < minRegionSamples)
+        regions.pop_back();
+
+    if (! regions.empty())
+    {
+        summary.firstAboveSample = regions.front().startSample;
+        summary.lastAboveSample = regions.back().endSample - 1;
+        summary.firstTransientSample = summary.firstAboveSample;
+    }
+
+    return summary;
+}
+
 } // namespace waive
@@ -2,22 +2,83 @@
 
 #include <JuceHeader.h>
 #include <functional>
+#include <vector>
 
 namespace waive
 {
 
 class AudioAnalysisCache;
 
+/** The part of a source file a clip plays. offsetSeconds and lengthSeconds
+    are in edit time, as reported by the clip's position; speedRatio converts
+    them to source time. A negative length means "to the end of the file". */
+struct AudioAnalysisRange
+{
+    double offsetSeconds = 0.0;
+    double lengthSeconds = -1.0;
+    double speedRatio = 1.0;
+
+    bool isWholeFile() const { return offsetSeconds <= 0.0 && lengthSeconds < 0.0; }
+
+    double getSpeedRatio() const            { return speedRatio > 0.0 ? speedRatio : 1.0; }
+    double getSourceStartSeconds() const    { return juce::jmax (0.0, offsetSeconds * getSpeedRatio()); }
+    double getSourceLengthSeconds() const   { return lengthSeconds < 0.0 ? -1.0 : lengthSeconds * getSpeedRatio(); }
+
+    /** The range a te::AudioClipBase plays. Looped clips can replay any part
+        of their source, so they get the whole file. Templated so this header
+        stays free of the tracktion include. */
+    template <typename AudioClipType>
+    static AudioAnalysisRange forClip (const AudioClipType& clip)
+    {
+        if (clip.isLooping())
+            return {};
+
+        const auto position = clip.getPosition();
+        return { position.getOffset().inSeconds(), position.getLength().inSeconds(), clip.getSpeedRatio() };
+    }
+};
+
+/** Gate used by detectActiveRegions(). Opening and closing at different levels
+    (hysteresis) stops the gate chattering on material that hovers around one
+    threshold. */
+struct ActivityGateSettings
+{
+    float openThresholdGain = 0.01f;    // gate opens at or above this peak
+    float closeThresholdGain = 0.005f;  // and closes once the peak stays below this
+    double holdSeconds = 0.05;          // for longer than the hold time
+    double minGapSeconds = 0.25;        // shorter silences are merged into the surrounding regions
+    double minRegionSeconds = 0.02;     // isolated regions shorter than this are dropped
+};
+
+/** A span of analysed samples, end exclusive. */
+struct AudioRegion
+{
+    int64 startSample = 0;
+    int64 endSample = 0;
+};
+
 struct AudioAnalysisSummary
 {
     bool valid = false;
     bool cancelled = false;
     double sampleRate = 0.0;
-    int64 totalSamples = 0;
+    double speedRatio = 1.0;
+    int64 rangeStartSample = 0;             // first analysed source sample
+    int64 totalSamples = 0;                 // samples analysed
     float peakGain = 0.0f;
-    int64 firstAboveSample = -1;
+    float rmsGain = 0.0f;                   // over every channel of the range
+    bool hasLoudness = false;               // integratedLufs was measured (measureLoudness)
+    double integratedLufs = -120.0;         // LoudnessMeter::floorDb when silent
+    int64 firstAboveSample = -1;            // sample positions are relative to rangeStartSample
     int64 lastAboveSample = -1;
     int64 firstTransientSample = -1;
+    std::vector<AudioRegion> activeRegions; // filled by detectActiveRegions() only
+
+    /** Converts an analysed sample position to seconds from the clip start. */
+    double toClipSeconds (int64 sample) const
+    {
+        return sampleRate > 0.0 ? (double) sample / sampleRate / speedRatio : 0.0;
+    }
 };
 
 AudioAnalysisSummary analyseAudioFile (const juce::File& sourceFile,
@@ -26,4 +87,25 @@ AudioAnalysisSummary analyseAudioFile (const juce::File& sourceFile,
                                        const std::function<bool()>& shouldCancel = {},
                                        AudioAnalysisCache* cache = nullptr);
 
+/** Analyses only the samples a clip plays, so a short clip cut from a long
+    recording costs a short read. Results are cached per range. With
+    measureLoudness, integrated LUFS is measured in the same pass; a cached
+    result without it is measured again. */
+AudioAnalysisSummary analyseAudioFile (const juce::File& sourceFile,
+                                       const AudioAnalysisRange& range,
+                                       float activityThresholdGain,
+                                       float transientRiseThresholdGain,
+                                       const std::function<bool()>& shouldCancel = {},
+                                       AudioAnalysisCache* cache = nullptr,
+                                       bool measureLoudness = false);
+
+/** Finds every non-silent region of the range in one streaming pass, for
+    cutting interior silence as well as trimming the ends. firstAboveSample
+    and lastAboveSample are set from the first and last region. Not cached:
+    the region list is only needed once per plan. */
+AudioAnalysisSummary detectActiveRegions (const juce::File& sourceFile,
+                                          const AudioAnalysisRange& range,
+                                          const ActivityGateSettings& gate,
+                                          const std::function<bool()>& shouldCancel = {});
+
 } // namespace waive
@@ -4,6 +4,20 @@
 namespace waive
 {
 
+AudioAnalysisCache::FeatureKey::FeatureKey (const juce::File& file,
+                                            const AudioAnalysisRange& range,
+                                            const FeatureSettings& s)
+    : sourceFile (file),
+      rangeStartSeconds (range.getSourceStartSeconds()),
+      rangeLengthSeconds (range.getSourceLengthSeconds())
+{
+    settings << s.fftOrder << "/" << s.hopSize
+             << "/o" << (int) s.computeOnsets
+             << "/m" << (int) s.computeMel << ":" << s.numMelBands << ":" << s.melMinHz << ":" << s.melMaxHz
+             << "/c" << (int) s.computeChroma
+             << "/l" << (int) s.computeLoudness;
+}
+
 AudioAnalysisCache::AudioAnalysisCache (int maxEntries_)
     : maxEntries (maxEntries_)
 {
@@ -12,62 +26,32 @@ AudioAnalysisCache::AudioAnalysisCache (int maxEntries_)
 std::optional<AudioAnalysisSummary> AudioAnalysisCache::get (const CacheKey& key)
 {
     const juce::ScopedLock sl (lock);
-    auto it = cache.find (key);
-    if (it != cache.end())
-    {
-        // Move accessed key to front (most recently used) - O(1) with iterator map
-        auto iterIt = iterMap.find (key);
-        if (iterIt != iterMap.end())
-            accessOrder.erase (iterIt->second);
-
-        accessOrder.push_front (key);
-        iterMap[key] = accessOrder.begin();
-        return it->second;
-    }
-    return std::nullopt;
+    return summaries.get (key);
 }
 
 void AudioAnalysisCache::put (const CacheKey& key, const AudioAnalysisSummary& summary)
 {
     const juce::ScopedLock sl (lock);
+    summaries.put (key, summary, maxEntries);
+}
 
-    // If already exists, update and move to front
-    auto it = cache.find (key);
-    if (it != cache.end())
-    {
-        it->second = summary;
-
-        // O(1) removal with iterator map
-        auto iterIt = iterMap.find (key);
-        if (iterIt != iterMap.end())
-            accessOrder.erase (iterIt->second);
-
-        accessOrder.push_front (key);
-        iterMap[key] = accessOrder.begin();
-        return;
-    }
-
-    // Evict LRU if at capacity
-    if ((int) cache.size() >= maxEntries && ! accessOrder.empty())
-    {
-        auto lru = accessOrder.back();
-        accessOrder.pop_back();
-        cache.erase (lru);
-        iterMap.erase (lru);
-    }
+std::optional<AudioFeatures> AudioAnalysisCache::getFeatures (const FeatureKey& key)
+{
+    const juce::ScopedLock sl (lock);
+    return features.get (key);
+}
 
-    // Insert new entry
-    cache[key] = summary;
-    accessOrder.push_front (key);
-    iterMap[key] = accessOrder.begin();
+void AudioAnalysisCache::putFeatures (const FeatureKey& key, const AudioFeatures& featuresToStore)
+{
+    const juce::ScopedLock sl (lock);
+    features.put (key, featuresToStore, maxEntries);
 }
 
 void AudioAnalysisCache::clear()
 {
     const juce::ScopedLock sl (lock);
-    cache.clear();
-    accessOrder.clear();
-    iterMap.clear();
+    summaries.clear();
+    features.clear();
 }
 
 } // namespace waive
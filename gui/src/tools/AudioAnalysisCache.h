@@ -3,7 +3,10 @@
 #include <JuceHeader.h>
 #include <unordered_map>
 #include <list>
+#include <cmath>
+#include <optional>
 #include "AudioAnalysis.h"
+#include "AudioFeatures.h"
 
 namespace waive
 {
@@ -17,12 +20,16 @@ public:
         juce::File sourceFile;
         float activityThreshold;
         float transientThreshold;
+        double rangeStartSeconds = 0.0;     // source time; length < 0 means to the end of the file
+        double rangeLengthSeconds = -1.0;
 
         bool operator== (const CacheKey& other) const
         {
             return sourceFile == other.sourceFile &&
                    std::abs (activityThreshold - other.activityThreshold) < 0.0001f &&
-                   std::abs (transientThreshold - other.transientThreshold) < 0.0001f;
+                   std::abs (transientThreshold - other.transientThreshold) < 0.0001f &&
+                   std::abs (rangeStartSeconds - other.rangeStartSeconds) < 1.0e-6 &&
+                   std::abs (rangeLengthSeconds - other.rangeLengthSeconds) < 1.0e-6;
         }
     };
 
@@ -33,21 +40,118 @@ public:
             auto h1 = std::hash<juce::String>() (key.sourceFile.getFullPathName());
             auto h2 = std::hash<float>() (key.activityThreshold);
             auto h3 = std::hash<float>() (key.transientThreshold);
-            return h1 ^ (h2 << 1) ^ (h3 << 2);
+            auto h4 = std::hash<int64>() ((int64) std::llround (key.rangeStartSeconds * 1.0e6));
+            auto h5 = std::hash<int64>() ((int64) std::llround (key.rangeLengthSeconds * 1.0e6));
+            return h1 ^ (h2 << 1) ^ (h3 << 2) ^ (h4 << 3) ^ (h5 << 4);
         }
     };
 
+    /** Identifies extractFeatures() output: the source range plus every
+        setting that changes the frames. */
+    struct FeatureKey
+    {
+        juce::File sourceFile;
+        double rangeStartSeconds = 0.0;
+        double rangeLengthSeconds = -1.0;
+        juce::String settings;
+
+        FeatureKey() = default;
+        FeatureKey (const juce::File& file, const AudioAnalysisRange& range, const FeatureSettings& featureSettings);
+
+        bool operator== (const FeatureKey& other) const
+        {
+            return sourceFile == other.sourceFile &&
+                   std::abs (rangeStartSeconds - other.rangeStartSeconds) < 1.0e-6 &&
+                   std::abs (rangeLengthSeconds - other.rangeLengthSeconds) < 1.0e-6 &&
+                   settings == other.settings;
+        }
+    };
+
+    struct FeatureKeyHash
+    {
+        std::size_t operator() (const FeatureKey& key) const
+        {
+            auto h1 = std::hash<juce::String>() (key.sourceFile.getFullPathName());
+            auto h2 = std::hash<int64>() ((int64) std::llround (key.rangeStartSeconds * 1.0e6));
+            auto h3 = std::hash<int64>() ((int64) std::llround (key.rangeLengthSeconds * 1.0e6));
+            auto h4 = std::hash<juce::String>() (key.settings);
+            return h1 ^ (h2 << 1) ^ (h3 << 2) ^ (h4 << 3);
+        }
+    };
+
+    /** maxEntries applies to summaries and feature sets separately. */
     explicit AudioAnalysisCache (int maxEntries = 256);
     ~AudioAnalysisCache() = default;
 
     std::optional<AudioAnalysisSummary> get (const CacheKey& key);
     void put (const CacheKey& key, const AudioAnalysisSummary& summary);
+
+    std::optional<AudioFeatures> getFeatures (const FeatureKey& key);
+    void putFeatures (const FeatureKey& key, const AudioFeatures& features);
+
     void clear();
 
 private:
-    std::unordered_map<CacheKey, AudioAnalysisSummary, CacheKeyHash> cache;
-    std::list<CacheKey> accessOrder;
-    std::unordered_map<CacheKey, std::list<CacheKey>::iterator, CacheKeyHash> iterMap;
+    /** Least-recently-used map with O(1) lookup, touch and eviction. */
+    template <typename Key, typename Value, typename Hash>
+    struct LruMap
+    {
+        std::unordered_map<Key, Value, Hash> values;
+        std::list<Key> accessOrder;
+        std::unordered_map<Key, typename std::list<Key>::iterator, Hash> iterMap;
+
+        void touch (const Key& key)
+        {
+            auto iterIt = iterMap.find (key);
+            if (iterIt != iterMap.end())
+                accessOrder.erase (iterIt->second);
+
+            accessOrder.push_front (key);
+            iterMap[key] = accessOrder.begin();
+        }
+
+        std::optional<Value> get (const Key& key)
+        {
+            auto it = values.find (key);
+            if (it == values.end())
+                return std::nullopt;
+
+            touch (key);
+            return it->second;
+        }
+
+        void put (const Key& key, const Value& value, int maxEntries)
+        {
+            auto it = values.find (key);
+            if (it != values.end())
+            {
+                it->second = value;
+                touch (key);
+                return;
+            }
+
+            if ((int) values.size() >= maxEntries && ! accessOrder.empty())
+            {
+                auto lru = accessOrder.back();
+                accessOrder.pop_back();
+                values.erase (lru);
+                iterMap.erase (lru);
+            }
+
+            values[key] = value;
+            touch (key);
+        }
+
+        void clear()
+        {
+            values.clear();
+            accessOrder.clear();
+            iterMap.clear();
+        }
+    };
+
+    LruMap<CacheKey, AudioAnalysisSummary, CacheKeyHash> summaries;
+    LruMap<FeatureKey, AudioFeatures, FeatureKeyHash> features;
     int maxEntries;
     juce::CriticalSection lock;
 };
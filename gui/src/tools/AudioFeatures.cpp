@@ -0,0 +1,376 @@
+#include "AudioFeatures.h"
+#include "AudioAnalysisCache.h"
+#include "LoudnessMeter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <optional>
+
+namespace waive
+{
+
+namespace
+{
+constexpr int readBlockSize = 65536;
+
+double hzToMel (double hz)   { return 2595.0 * std::log10 (1.0 + hz / 700.0); }
+double melToHz (double mel)  { return 700.0 * (std::pow (10.0, mel / 2595.0) - 1.0); }
+}
+
+const juce::dsp::FFT& getThreadLocalFft (int order)
+{
+    thread_local std::map<int, std::unique_ptr<juce::dsp::FFT>> plans;
+
+    order = juce::jlimit (1, 24, order);
+
+    auto& plan = plans[order];
+    if (plan == nullptr)
+        plan = std::make_unique<juce::dsp::FFT> (order);
+
+    return *plan;
+}
+
+const std::vector<float>& getSharedHannWindow (int size)
+{
+    static std::mutex lock;
+    static std::map<int, std::vector<float>> windows;
+
+    size = juce::jmax (1, size);
+
+    const std::lock_guard<std::mutex> guard (lock);
+    auto& window = windows[size];
+    if (window.empty())
+    {
+        window.resize ((size_t) size);
+        for (int i = 0; i < size; ++i)
+            window[(size_t) i] = 0.5f - 0.5f * std::cos (2.0f * juce::MathConstants<float>::pi * (float) i / (float) size);
+    }
+
+    return window;
+}
+
+//==============================================================================
+StreamingStft::StreamingStft (int fftOrder, int hop, int padding)
+    : fft (juce::jlimit (1, 24, fftOrder)),
+      frameSize (fft.getSize()),
+      hopSize (juce::jlimit (1, frameSize, hop)),
+      leadingPadding (juce::jmax (0, padding)),
+      window (getSharedHannWindow (frameSize))
+{
+    fftBuffer.assign ((size_t) frameSize * 2, 0.0f);
+    reset();
+}
+
+void StreamingStft::reset()
+{
+    pending.assign ((size_t) leadingPadding, 0.0f);
+}
+
+void StreamingStft::push (const float* samples, int numSamples, const FrameCallback& onFrame)
+{
+    pending.insert (pending.end(), samples, samples + numSamples);
+    processReadyFrames (onFrame);
+}
+
+void StreamingStft::pushSilence (int numSamples, const FrameCallback& onFrame)
+{
+    pending.insert (pending.end(), (size_t) juce::jmax (0, numSamples), 0.0f);
+    processReadyFrames (onFrame);
+}
+
+void StreamingStft::processReadyFrames (const FrameCallback& onFrame)
+{
+    size_t readPosition = 0;
+    const auto* bins = reinterpret_cast<const std::complex<float>*> (fftBuffer.data());
+
+    while (pending.size() - readPosition >= (size_t) frameSize)
+    {
+        const auto* frame = pending.data() + readPosition;
+
+        juce::FloatVectorOperations::multiply (fftBuffer.data(), frame, window.data(), frameSize);
+        juce::FloatVectorOperations::clear (fftBuffer.data() + frameSize, frameSize);
+        fft.performRealOnlyForwardTransform (fftBuffer.data(), true);
+
+        onFrame (frame, bins);
+        readPosition += (size_t) hopSize;
+    }
+
+    pending.erase (pending.begin(), pending.begin() + (std::ptrdiff_t) readPosition);
+}
+
+//==============================================================================
+SpectralFilterbank SpectralFilterbank::mel (int fftSize, double sampleRate, int numBands,
+                                            double minHz, double maxHz)
+{
+    SpectralFilterbank bank;
+    bank.numOutputs = juce::jmax (1, numBands);
+
+    const auto numBins = fftSize / 2 + 1;
+    const auto binHz = sampleRate / (double) fftSize;
+    maxHz = juce::jlimit (minHz + binHz, sampleRate * 0.5, maxHz);
+
+    // numBands triangles between numBands + 2 equally spaced mel points.
+    const auto minMel = hzToMel (juce::jmax (0.0, minHz));
+    const auto melStep = (hzToMel (maxHz) - minMel) / (double) (bank.numOutputs + 1);
+
+    for (int band = 0; band < bank.numOutputs; ++band)
+    {
+        const auto lower = melToHz (minMel + melStep * (double) band);
+        const auto centre = melToHz (minMel + melStep * (double) (band + 1));
+        const auto upper = melToHz (minMel + melStep * (double) (band + 2));
+        const auto norm = 2.0 / (upper - lower);
+
+        Band entry;
+        entry.output = band;
+        entry.firstBin = juce::jmax (0, (int) std::ceil (lower / binHz));
+        const auto lastBin = juce::jmin (numBins - 1, (int) std::floor (upper / binHz));
+
+        for (int bin = entry.firstBin; bin <= lastBin; ++bin)
+        {
+            const auto hz = (double) bin * binHz;
+            const auto rising = (hz - lower) / (centre - lower);
+            const auto falling = (upper - hz) / (upper - centre);
+            entry.weights.push_back ((float) (juce::jmax (0.0, juce::jmin (rising, falling)) * norm));
+        }
+
+        // Bands narrower than a bin still get the nearest one.
+        if (entry.weights.empty())
+        {
+            entry.firstBin = juce::jlimit (0, numBins - 1, (int) std::lround (centre / binHz));
+            entry.weights.push_back ((float) norm);
+        }
+
+        bank.bands.push_back (std::move (entry));
+    }
+
+    return bank;
+}
+
+SpectralFilterbank SpectralFilterbank::chroma (int fftSize, double sampleRate, double minHz, double maxHz)
+{
+    SpectralFilterbank bank;
+    bank.numOutputs = 12;
+
+    const auto numBins = fftSize / 2 + 1;
+    const auto binHz = sampleRate / (double) fftSize;
+
+    for (int bin = juce::jmax (1, (int) std::ceil (minHz / binHz)); bin < numBins; ++bin)
+    {
+        const auto hz = (double) bin * binHz;
+        if (hz > maxHz)
+            break;
+
+        const auto midiNote = (int) std::lround (69.0 + 12.0 * std::log2 (hz / 440.0));
+        const auto pitchClass = ((midiNote % 12) + 12) % 12;
+
+        // Neighbouring bins usually share a pitch class, so extend the run.
+        if (! bank.bands.empty())
+        {
+            auto& last = bank.bands.back();
+            if (last.output == pitchClass && last.firstBin + (int) last.weights.size() == bin)
+            {
+                last.weights.push_back (1.0f);
+                continue;
+            }
+        }
+
+        bank.bands.push_back ({ pitchClass, bin, { 1.0f } });
+    }
+
+    return bank;
+}
+
+void SpectralFilterbank::apply (const float* spectrum, float* output) const
+{
+    std::fill (output, output + numOutputs, 0.0f);
+
+    for (const auto& band : bands)
+        output[band.output] += std::inner_product (band.weights.begin(), band.weights.end(),
+                                                   spectrum + band.firstBin, 0.0f);
+}
+
+//==============================================================================
+SpectralFluxOnset::SpectralFluxOnset (int numBins, float compressionAmount)
+    : compression (juce::jmax (0.0f, compressionAmount)),
+      previous ((size_t) juce::jmax (1, numBins), 0.0f),
+      current (previous.size(), 0.0f)
+{
+}
+
+float SpectralFluxOnset::process (const float* magnitudes)
+{
+    for (size_t bin = 0; bin < current.size(); ++bin)
+        current[bin] = std::log1p (compression * magnitudes[bin]);
+
+    float flux = 0.0f;
+    if (hasPrevious)
+        for (size_t bin = 0; bin < current.size(); ++bin)
+            flux += juce::jmax (0.0f, current[bin] - previous[bin]);
+
+    std::swap (previous, current);
+    hasPrevious = true;
+    return flux;
+}
+
+void SpectralFluxOnset::reset()
+{
+    hasPrevious = false;
+}
+
+//==============================================================================
+AudioFeatures extractFeatures (const juce::File& sourceFile,
+                               const AudioAnalysisRange& range,
+                               const FeatureSettings& settings,
+                               const std::function<bool()>& shouldCancel,
+                               AudioAnalysisCache* cache)
+{
+    AudioFeatures features;
+
+    if (! sourceFile.existsAsFile())
+        return features;
+
+    const auto cacheKey = cache != nullptr ? AudioAnalysisCache::FeatureKey (sourceFile, range, settings)
+                                           : AudioAnalysisCache::FeatureKey();
+    if (cache != nullptr)
+    {
+        if (auto cached = cache->getFeatures (cacheKey))
+        {
+            // Keyed by source time, like analysis summaries.
+            cached->speedRatio = range.getSpeedRatio();
+            return *cached;
+        }
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (sourceFile));
+    if (reader == nullptr || reader->numChannels <= 0 || reader->lengthInSamples <= 0 || reader->sampleRate <= 0)
+        return features;
+
+    const auto startSample = juce::jmin (reader->lengthInSamples,
+                                         (int64) std::llround (range.getSourceStartSeconds() * reader->sampleRate));
+    auto numSamples = reader->lengthInSamples - startSample;
+    if (range.getSourceLengthSeconds() >= 0.0)
+        numSamples = juce::jmin (numSamples, (int64) std::llround (range.getSourceLengthSeconds() * reader->sampleRate));
+
+    if (numSamples <= 0)
+        return features;
+
+    const auto numChannels = (int) reader->numChannels;
+    StreamingStft stft (settings.fftOrder, settings.hopSize, getThreadLocalFft (settings.fftOrder).getSize() / 2);
+    const auto frameSize = stft.getFrameSize();
+    const auto numBins = stft.getNumBins();
+
+    features.sampleRate = reader->sampleRate;
+    features.speedRatio = range.getSpeedRatio();
+    features.hopSize = stft.getHopSize();
+
+    const auto expectedFrames = (size_t) (numSamples / features.hopSize + 1);
+    features.rms.reserve (expectedFrames);
+
+    SpectralFluxOnset onsets (numBins);
+    if (settings.computeOnsets)
+        features.onsetStrength.reserve (expectedFrames);
+
+    std::optional<SpectralFilterbank> melBank;
+    if (settings.computeMel)
+    {
+        melBank = SpectralFilterbank::mel (frameSize, reader->sampleRate, settings.numMelBands,
+                                           settings.melMinHz, settings.melMaxHz);
+        features.numMelBands = melBank->getNumOutputs();
+        features.mel.reserve (expectedFrames * (size_t) features.numMelBands);
+    }
+
+    std::optional<SpectralFilterbank> chromaBank;
+    if (settings.computeChroma)
+    {
+        chromaBank = SpectralFilterbank::chroma (frameSize, reader->sampleRate);
+        features.chroma.reserve (expectedFrames * 12);
+    }
+
+    LoudnessMeter meter;
+    if (settings.computeLoudness)
+        meter.prepare (reader->sampleRate, numChannels);
+
+    std::vector<float> magnitudes ((size_t) numBins);
+    std::vector<float> bandValues ((size_t) juce::jmax (12, features.numMelBands));
+
+    const StreamingStft::FrameCallback onFrame = [&] (const float* frameSamples, const std::complex<float>* bins)
+    {
+        const auto energy = std::inner_product (frameSamples, frameSamples + frameSize, frameSamples, 0.0f);
+        features.rms.push_back (std::sqrt (energy / (float) frameSize));
+
+        if (! settings.computeOnsets && ! melBank && ! chromaBank)
+            return;
+
+        for (int bin = 0; bin < numBins; ++bin)
+            magnitudes[(size_t) bin] = std::abs (bins[bin]);
+
+        if (settings.computeOnsets)
+            features.onsetStrength.push_back (onsets.process (magnitudes.data()));
+
+        if (melBank)
+        {
+            melBank->apply (magnitudes.data(), bandValues.data());
+            features.mel.insert (features.mel.end(), bandValues.begin(), bandValues.begin() + features.numMelBands);
+        }
+
+        if (chromaBank)
+        {
+            chromaBank->apply (magnitudes.data(), bandValues.data());
+            const auto peak = *std::max_element (bandValues.begin(), bandValues.begin() + 12);
+            const auto scale = peak > 1.0e-9f ? 1.0f / peak : 0.0f;
+
+            for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+                features.chroma.push_back (bandValues[(size_t) pitchClass] * scale);
+        }
+    };
+
+    juce::AudioBuffer<float> buffer (numChannels, (int) juce::jmin ((int64) readBlockSize, numSamples));
+    std::vector<float> mono ((size_t) buffer.getNumSamples());
+    const auto channelScale = 1.0f / (float) numChannels;
+
+    for (int64 position = 0; position < numSamples;)
+    {
+        if (shouldCancel && shouldCancel())
+        {
+            features = {};
+            features.cancelled = true;
+            return features;
+        }
+
+        const auto numThisBlock = (int) juce::jmin ((int64) buffer.getNumSamples(), numSamples - position);
+        if (! reader->read (&buffer, 0, numThisBlock, startSample + position, true, true))
+            break;
+
+        juce::FloatVectorOperations::copyWithMultiply (mono.data(), buffer.getReadPointer (0), channelScale, numThisBlock);
+        for (int ch = 1; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::addWithMultiply (mono.data(), buffer.getReadPointer (ch), channelScale, numThisBlock);
+
+        stft.push (mono.data(), numThisBlock, onFrame);
+
+        if (settings.computeLoudness)
+            meter.process (buffer, 0, numThisBlock);
+
+        position += numThisBlock;
+    }
+
+    // Trailing padding lets the last frames centre on the final samples.
+    stft.pushSilence (frameSize / 2, onFrame);
+
+    if (settings.computeLoudness)
+        features.momentaryLufs = meter.getMomentaryLoudness();
+
+    features.valid = true;
+
+    if (cache != nullptr)
+        cache->putFeatures (cacheKey, features);
+
+    return features;
+}
+
+} // namespace waive
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <complex>
+#include <functional>
+#include <vector>
+
+#include "AudioAnalysis.h"
+
+namespace waive
+{
+
+class AudioAnalysisCache;
+
+/** An FFT plan for the calling thread, made once per size and kept for the
+    thread's lifetime. Plans aren't shared between threads: JUCE's fallback
+    engine takes a lock inside each transform, so a shared plan would
+    serialise parallel work. Only use the plan on the thread that asked for
+    it; objects that may be handed to other threads own their plan instead.
+    Orders are clamped to 1 .. 24. */
+const juce::dsp::FFT& getThreadLocalFft (int order);
+
+/** A periodic Hann window of the given length, shared by every thread since
+    it is only ever read. */
+const std::vector<float>& getSharedHannWindow (int size);
+
+//==============================================================================
+/** Streaming short-time Fourier transform of one signal. Samples are pushed in
+    blocks of any size, and the callback receives each complete frame: the raw
+    frame samples and its non-negative frequency bins (getNumBins() of them)
+    after a Hann window. Only one frame of input is held at a time. Each
+    instance owns its FFT plan, so it can run on any thread.
+
+    leadingPadding zeros are inserted before the first sample. Half a frame
+    centres frame i on input sample i * hopSize. */
+class StreamingStft
+{
+public:
+    using FrameCallback = std::function<void (const float* frameSamples, const std::complex<float>* bins)>;
+
+    StreamingStft (int fftOrder, int hopSize, int leadingPadding = 0);
+
+    int getFrameSize() const    { return frameSize; }
+    int getHopSize() const      { return hopSize; }
+    int getNumBins() const      { return frameSize / 2 + 1; }
+
+    void push (const float* samples, int numSamples, const FrameCallback& onFrame);
+    void pushSilence (int numSamples, const FrameCallback& onFrame);
+
+    /** Drops buffered input and restores the leading padding. */
+    void reset();
+
+private:
+    void processReadyFrames (const FrameCallback& onFrame);
+
+    const juce::dsp::FFT fft;
+    const int frameSize;
+    const int hopSize;
+    const int leadingPadding;
+    const std::vector<float>& window;
+
+    std::vector<float> pending;
+    std::vector<float> fftBuffer;
+};
+
+//==============================================================================
+/** A sparse linear map from spectrum bins to bands. Each band is a run of
+    consecutive bin weights, so applying it is a handful of short dot products
+    instead of a dense bins x bands matrix. */
+class SpectralFilterbank
+{
+public:
+    /** Triangular mel bands, area-normalised (Slaney style) so wide high bands
+        don't outweigh narrow low ones. */
+    static SpectralFilterbank mel (int fftSize, double sampleRate, int numBands,
+                                   double minHz = 30.0, double maxHz = 8000.0);
+
+    /** 12 pitch classes, C first, with each bin between minHz and maxHz
+        assigned to its nearest equal-tempered pitch (A4 = 440 Hz). */
+    static SpectralFilterbank chroma (int fftSize, double sampleRate,
+                                      double minHz = 55.0, double maxHz = 5000.0);
+
+    int getNumOutputs() const   { return numOutputs; }
+
+    /** Writes getNumOutputs() values to output. */
+    void apply (const float* spectrum, float* output) const;
+
+private:
+    struct Band
+    {
+        int output = 0;
+        int firstBin = 0;
+        std::vector<float> weights;
+    };
+
+    int numOutputs = 0;
+    std::vector<Band> bands;
+};
+
+//==============================================================================
+/** Onset strength as spectral flux: the summed increase in log-compressed
+    magnitude since the previous frame. Decays and steady tones score zero, so
+    peaks mark note starts and hits. The first frame has nothing to compare
+    against and scores zero. */
+class SpectralFluxOnset
+{
+public:
+    explicit SpectralFluxOnset (int numBins, float compression = 100.0f);
+
+    float process (const float* magnitudes);
+    void reset();
+
+private:
+    const float compression;
+    std::vector<float> previous;
+    std::vector<float> current;
+    bool hasPrevious = false;
+};
+
+//==============================================================================
+struct FeatureSettings
+{
+    int fftOrder = 11;              // 2048-point frames
+    int hopSize = 512;
+    bool computeOnsets = true;
+    bool computeMel = false;
+    int numMelBands = 40;
+    double melMinHz = 30.0;
+    double melMaxHz = 8000.0;
+    bool computeChroma = false;
+    bool computeLoudness = false;   // momentary LUFS, which reads every channel
+};
+
+/** Per-frame features of part of a file. Frame i is centred on analysed
+    sample i * hopSize; the mel and chroma matrices are row-major, one row per
+    frame. */
+struct AudioFeatures
+{
+    bool valid = false;
+    bool cancelled = false;
+    double sampleRate = 0.0;
+    double speedRatio = 1.0;
+    int hopSize = 0;
+
+    std::vector<float> rms;             // per frame, over the whole frame
+    std::vector<float> onsetStrength;   // per frame, when computeOnsets
+    int numMelBands = 0;
+    std::vector<float> mel;             // magnitude per band, when computeMel
+    std::vector<float> chroma;          // 12 per frame, each frame's maximum scaled to 1, when computeChroma
+    std::vector<double> momentaryLufs;  // every 100 ms of source time, when computeLoudness
+
+    int getNumFrames() const { return (int) rms.size(); }
+
+    /** Frames per second of clip time. */
+    double getFrameRate() const
+    {
+        return hopSize > 0 ? sampleRate * speedRatio / (double) hopSize : 0.0;
+    }
+
+    double frameToClipSeconds (int frame) const
+    {
+        return sampleRate > 0.0 ? (double) frame * (double) hopSize / sampleRate / speedRatio : 0.0;
+    }
+};
+
+/** Reads the range once and computes the requested features in one streaming
+    pass. The STFT runs on a mono mixdown; memory is bounded by the read block
+    and the feature arrays, not the audio length. Results are cached per range
+    and settings when a cache is given. */
+AudioFeatures extractFeatures (const juce::File& sourceFile,
+                               const AudioAnalysisRange& range,
+                               const FeatureSettings& settings,
+                               const std::function<bool()>& shouldCancel = {},
+                               AudioAnalysisCache* cache = nullptr);
+
+} // namespace waive
@@ -2,18 +2,21 @@
 
 #include <algorithm>
 #include <map>
+#include <optional>
 #include <tracktion_engine/tracktion_engine.h>
 
 #include "AudioAnalysis.h"
 #include "ClipTrackIndexMap.h"
 #include "EditSession.h"
 #include "JobQueue.h"
+#include "LoudnessMeter.h"
 #include "ModelManager.h"
 #include "PathSanitizer.h"
 #include "ProjectManager.h"
 #include "SelectionManager.h"
 #include "SessionComponent.h"
 #include "TimelineComponent.h"
+#include "ToolAnalysisStore.h"
 
 namespace te = tracktion;
 
@@ -22,6 +25,7 @@ namespace
 struct ClipAnalysisInput
 {
     juce::File sourceFile;
+    waive::AudioAnalysisRange analysisRange;
     float clipGainDb = 0.0f;
 };
 
@@ -73,6 +77,27 @@ bool parseStereoSpread (const juce::var& params)
     return stereoSpread;
 }
 
+bool parseLoudnessMode (const juce::var& params)
+{
+    if (auto* paramsObj = params.getDynamicObject())
+        return paramsObj->getProperty ("level_mode").toString() == "loudness";
+
+    return false;
+}
+
+double parseTargetLufs (const juce::var& params)
+{
+    double targetLufs = -18.0;
+
+    if (auto* paramsObj = params.getDynamicObject())
+    {
+        if (paramsObj->hasProperty ("target_lufs"))
+            targetLufs = (double) paramsObj->getProperty ("target_lufs");
+    }
+
+    return juce::jlimit (-36.0, -6.0, targetLufs);
+}
+
 int parseAnalysisDelayMs (const juce::var& params)
 {
     int delayMs = 0;
@@ -152,6 +177,7 @@ ToolDescription AutoMixSuggestionsTool::describe() const
     desc.displayName = "Auto-Mix Suggestions (Model)";
     desc.version = "1.0.0";
     desc.description = "Suggest track volume/pan moves from selected clips. Requires installed auto-mix model.";
+    desc.speculativePlanning = true;
 
     auto* schemaObj = new juce::DynamicObject();
     schemaObj->setProperty ("type", "object");
@@ -172,6 +198,21 @@ ToolDescription AutoMixSuggestionsTool::describe() const
     targetObj->setProperty ("description", "Target per-track peak level in dBFS.");
     propsObj->setProperty ("target_peak_db", juce::var (targetObj));
 
+    auto* levelModeObj = new juce::DynamicObject();
+    levelModeObj->setProperty ("type", "string");
+    levelModeObj->setProperty ("enum", juce::Array<juce::var> { "peak", "loudness" });
+    levelModeObj->setProperty ("default", "peak");
+    levelModeObj->setProperty ("description", "Balance tracks by sample peak or by integrated loudness (EBU R128).");
+    propsObj->setProperty ("level_mode", juce::var (levelModeObj));
+
+    auto* targetLufsObj = new juce::DynamicObject();
+    targetLufsObj->setProperty ("type", "number");
+    targetLufsObj->setProperty ("minimum", -36.0);
+    targetLufsObj->setProperty ("maximum", -6.0);
+    targetLufsObj->setProperty ("default", -18.0);
+    targetLufsObj->setProperty ("description", "Target per-track integrated loudness in LUFS (loudness mode).");
+    propsObj->setProperty ("target_lufs", juce::var (targetLufsObj));
+
     auto* maxAdjustObj = new juce::DynamicObject();
     maxAdjustObj->setProperty ("type", "number");
     maxAdjustObj->setProperty ("minimum", 1.0);
@@ -199,6 +240,8 @@ ToolDescription AutoMixSuggestionsTool::describe() const
     auto* defaults = new juce::DynamicObject();
     defaults->setProperty ("model_version", "");
     defaults->setProperty ("target_peak_db", -14.0);
+    defaults->setProperty ("level_mode", "peak");
+    defaults->setProperty ("target_lufs", -18.0);
     defaults->setProperty ("max_adjust_db", 8.0);
     defaults->setProperty ("stereo_spread", true);
     defaults->setProperty ("analysis_delay_ms", 0);
@@ -273,6 +316,7 @@ juce::Result AutoMixSuggestionsTool::preparePlan (const ToolExecutionContext& co
         ClipAnalysisInput clipInput;
         clipInput.sourceFile = sourceFile;
         clipInput.clipGainDb = audioClip->getGainDB();
+        clipInput.analysisRange = waive::AudioAnalysisRange::forClip (*waveClip);
         trackPlanIter->second.clips.push_back (clipInput);
     }
 
@@ -284,22 +328,32 @@ juce::Result AutoMixSuggestionsTool::preparePlan (const ToolExecutionContext& co
     for (auto& entry : trackPlans)
         tracksToProcess.push_back (std::move (entry.second));
 
-    const auto targetPeakDb = parseTargetPeakDb (params);
+    const auto loudnessMode = parseLoudnessMode (params);
+    const auto targetLevelDb = loudnessMode ? parseTargetLufs (params) : parseTargetPeakDb (params);
     const auto maxAdjustDb = parseMaxAdjustDb (params);
     const auto stereoSpread = parseStereoSpread (params);
     const auto analysisDelayMs = parseAnalysisDelayMs (params);
     const auto modelInfo = *resolvedModel;
     const auto cacheDirectory = context.projectCacheDirectory;
     const auto description = describe();
+    const auto analysisStore = ToolAnalysisStore::forProject (cacheDirectory);
+
+    // Targets, limits and panning only shape the plan; the level mode decides
+    // what is measured.
+    auto* analysisParamsObj = new juce::DynamicObject();
+    analysisParamsObj->setProperty ("measure_loudness", loudnessMode);
+    const juce::var analysisParams (analysisParamsObj);
 
     outTask.jobName = "Plan: " + description.displayName;
     outTask.run = [tracksToProcess = std::move (tracksToProcess),
-                   targetPeakDb,
+                   analysisStore,
+                   analysisParams,
+                   loudnessMode,
+                   targetLevelDb,
                    maxAdjustDb,
                    stereoSpread,
                    analysisDelayMs,
                    modelInfo,
-                   cacheDirectory,
                    params,
                    description] (ProgressReporter& reporter) mutable
     {
@@ -323,28 +377,51 @@ juce::Result AutoMixSuggestionsTool::preparePlan (const ToolExecutionContext& co
                 return plan;
 
             const auto& trackInput = tracksToProcess[(size_t) i];
-            float peak = 0.0f;
+            // Level is the loudest clip, as peak dBFS or integrated LUFS.
+            std::optional<double> levelDb;
 
             for (const auto& clipInput : trackInput.clips)
             {
-                const auto analysis = analyseAudioFile (
-                    clipInput.sourceFile,
-                    0.0f,
-                    0.0f,
-                    [&reporter]() { return reporter.isCancelled(); });
+                const auto analyse = [&]
+                {
+                    return analyseAudioFile (clipInput.sourceFile, clipInput.analysisRange, 0.0f, 0.0f,
+                                             [&reporter]() { return reporter.isCancelled(); },
+                                             nullptr, loudnessMode);
+                };
+
+                // Peak and loudness come from the same read of the clip's range.
+                const auto analysis = analysisStore != nullptr
+                    ? analysisStore->getOrAnalyse (ToolAnalysisStore::makeKey (description, analysisParams,
+                                                                               clipInput.sourceFile,
+                                                                               clipInput.analysisRange),
+                                                   analyse)
+                    : analyse();
+
+                if (! analysis.valid)
+                    continue;
+
+                std::optional<double> clipLevelDb;
+                if (loudnessMode)
+                {
+                    if (analysis.integratedLufs > LoudnessMeter::floorDb)
+                        clipLevelDb = analysis.integratedLufs;
+                }
+                else if (analysis.peakGain > 0.0f)
+                {
+                    clipLevelDb = juce::Decibels::gainToDecibels (analysis.peakGain, -120.0f);
+                }
 
-                if (! analysis.valid || analysis.peakGain <= 0.0f)
+                if (! clipLevelDb.has_value())
                     continue;
 
-                const auto effectivePeak = analysis.peakGain * juce::Decibels::decibelsToGain (clipInput.clipGainDb);
-                peak = juce::jmax (peak, effectivePeak);
+                const auto effectiveLevelDb = *clipLevelDb + clipInput.clipGainDb;
+                levelDb = juce::jmax (levelDb.value_or (effectiveLevelDb), effectiveLevelDb);
             }
 
-            if (peak <= 0.0f)
+            if (! levelDb.has_value())
                 continue;
 
-            const auto sourcePeakDb = juce::Decibels::gainToDecibels (peak, -120.0f);
-            const auto desiredDeltaDb = targetPeakDb - sourcePeakDb;
+            const auto desiredDeltaDb = targetLevelDb - *levelDb;
             const auto constrainedDeltaDb = juce::jlimit (-maxAdjustDb, maxAdjustDb, desiredDeltaDb);
             const auto suggestedVolumeDb = juce::jlimit (-60.0, 6.0,
                                                          (double) trackInput.currentVolumeDb + constrainedDeltaDb);
@@ -392,9 +469,15 @@ juce::Result AutoMixSuggestionsTool::preparePlan (const ToolExecutionContext& co
 
         plan.summary = "Auto-mix suggestions for " + juce::String (totalTracks)
                        + " track(s) with model " + modelInfo.version;
-        writePlanArtifact (cacheDirectory, description.name, modelInfo.version, plan);
         return plan;
     };
+    outTask.writeArtifact = [cacheDirectory, toolName = description.name, modelVersion = modelInfo.version, analysisStore] (ToolPlan& plan)
+    {
+        if (analysisStore != nullptr)
+            analysisStore->save();
+
+        writePlanArtifact (cacheDirectory, toolName, modelVersion, plan);
+    };
 
     return juce::Result::ok();
 }
@@ -24,4 +24,23 @@ std::unordered_map<te::EditItemID, int> buildClipTrackIndexMap (te::Edit& edit)
     return clipToTrack;
 }
 
+std::unordered_map<te::EditItemID, te::Clip*> buildClipLookup (te::Edit& edit)
+{
+    std::unordered_map<te::EditItemID, te::Clip*> clipsByID;
+
+    for (auto* track : te::getAudioTracks (edit))
+    {
+        if (track == nullptr)
+            continue;
+
+        for (auto* clip : track->getClips())
+        {
+            if (clip != nullptr)
+                clipsByID[clip->itemID] = clip;
+        }
+    }
+
+    return clipsByID;
+}
+
 } // namespace waive
@@ -14,4 +14,11 @@ namespace waive
 */
 std::unordered_map<te::EditItemID, int> buildClipTrackIndexMap (te::Edit& edit);
 
+/** Build a map from clip ID to audio clip for applying plans.
+    te::findClipForID() walks every track per call, which is quadratic over a
+    plan that touches thousands of clips. Splitting or moving a clip keeps its
+    object, so the map stays valid while such a plan is applied.
+*/
+std::unordered_map<te::EditItemID, te::Clip*> buildClipLookup (te::Edit& edit);
+
 } // namespace waive
@@ -0,0 +1,269 @@
+#include "CrossCorrelation.h"
+#include "AudioFeatures.h"
+
+#include <cmath>
+#include <complex>
+#include <limits>
+
+namespace waive
+{
+
+namespace
+{
+constexpr int readBlockSize = 65536;
+
+std::vector<float> decimate (const std::vector<float>& input, int factor)
+{
+    std::vector<float> output (input.size() / (size_t) factor);
+    const auto scale = 1.0f / (float) factor;
+
+    // Box-filter each block before keeping one value, which is enough
+    // anti-aliasing for locating a correlation peak.
+    for (size_t i = 0; i < output.size(); ++i)
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < factor; ++k)
+            sum += input[i * (size_t) factor + (size_t) k];
+
+        output[i] = sum * scale;
+    }
+
+    return output;
+}
+
+double sumOfSquares (const float* data, int numSamples)
+{
+    double sum = 0.0;
+    for (int i = 0; i < numSamples; ++i)
+        sum += (double) data[i] * (double) data[i];
+
+    return sum;
+}
+
+/** Picks the better of two normalised scores, by magnitude when polarity may
+    be inverted. */
+bool isBetterScore (double score, double best, bool detectPolarity)
+{
+    return detectPolarity ? std::abs (score) > std::abs (best) : score > best;
+}
+
+/** Offset of the best match of reference in target, found with one FFT
+    cross-correlation. Only the position is used, so the transform's scaling
+    doesn't matter. */
+int findCoarseLag (const std::vector<float>& reference, const std::vector<float>& target, bool detectPolarity)
+{
+    const auto referenceLength = (int) reference.size();
+    const auto targetLength = (int) target.size();
+    const auto numLags = targetLength - referenceLength + 1;
+
+    // Lags only run up to targetLength - referenceLength, so a transform as
+    // long as the target never wraps the reference around.
+    int order = 1;
+    while ((1 << order) < targetLength)
+        ++order;
+
+    const auto& fft = getThreadLocalFft (order);
+    const auto size = fft.getSize();
+
+    std::vector<float> referenceSpectrum ((size_t) size * 2, 0.0f);
+    std::vector<float> targetSpectrum ((size_t) size * 2, 0.0f);
+    std::copy (reference.begin(), reference.end(), referenceSpectrum.begin());
+    std::copy (target.begin(), target.end(), targetSpectrum.begin());
+
+    fft.performRealOnlyForwardTransform (referenceSpectrum.data());
+    fft.performRealOnlyForwardTransform (targetSpectrum.data());
+
+    auto* referenceBins = reinterpret_cast<std::complex<float>*> (referenceSpectrum.data());
+    auto* targetBins = reinterpret_cast<std::complex<float>*> (targetSpectrum.data());
+    for (int i = 0; i < size; ++i)
+        targetBins[i] *= std::conj (referenceBins[i]);
+
+    fft.performRealOnlyInverseTransform (targetSpectrum.data());
+
+    // Running energy of the target under the reference, for normalisation.
+    std::vector<double> energyPrefix ((size_t) targetLength + 1, 0.0);
+    for (int i = 0; i < targetLength; ++i)
+        energyPrefix[(size_t) i + 1] = energyPrefix[(size_t) i] + (double) target[(size_t) i] * (double) target[(size_t) i];
+
+    int bestLag = 0;
+    double bestScore = detectPolarity ? 0.0 : -std::numeric_limits<double>::max();
+
+    for (int lag = 0; lag < numLags; ++lag)
+    {
+        const auto energy = energyPrefix[(size_t) (lag + referenceLength)] - energyPrefix[(size_t) lag];
+        if (energy <= 1.0e-12)
+            continue;
+
+        const auto score = (double) targetSpectrum[(size_t) lag] / std::sqrt (energy);
+        if (isBetterScore (score, bestScore, detectPolarity))
+        {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+
+    return bestLag;
+}
+}
+
+ClipSignal readClipSignal (const juce::File& sourceFile,
+                           const AudioAnalysisRange& range,
+                           double startSeconds,
+                           double lengthSeconds,
+                           double sampleRate,
+                           const std::function<bool()>& shouldCancel)
+{
+    ClipSignal signal;
+
+    if (! sourceFile.existsAsFile() || lengthSeconds <= 0.0)
+        return signal;
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (sourceFile));
+    if (reader == nullptr || reader->numChannels <= 0 || reader->lengthInSamples <= 0 || reader->sampleRate <= 0)
+        return signal;
+
+    const auto speedRatio = range.getSpeedRatio();
+    const auto sourceStartSeconds = range.getSourceStartSeconds();
+
+    signal.sampleRate = sampleRate > 0.0 ? sampleRate : reader->sampleRate / speedRatio;
+    signal.samples.assign ((size_t) std::llround (lengthSeconds * signal.sampleRate), 0.0f);
+    signal.valid = true;
+
+    // Only the part of the request that lies inside the clip has audio.
+    const auto clipEndSeconds = range.lengthSeconds >= 0.0 ? range.lengthSeconds
+                                                           : std::numeric_limits<double>::max();
+    const auto audibleStart = juce::jmax (0.0, startSeconds);
+    const auto audibleEnd = juce::jmin (clipEndSeconds, startSeconds + lengthSeconds);
+    if (audibleEnd <= audibleStart)
+        return signal;
+
+    const auto toSourceSample = [&] (double clipSeconds)
+    {
+        return (sourceStartSeconds + clipSeconds * speedRatio) * reader->sampleRate;
+    };
+
+    const auto firstSourceSample = (int64) std::floor (toSourceSample (audibleStart));
+    const auto endSourceSample = juce::jmin (reader->lengthInSamples,
+                                             (int64) std::ceil (toSourceSample (audibleEnd)) + 1);
+    if (firstSourceSample >= endSourceSample)
+        return signal;
+
+    const auto numSourceSamples = (int) (endSourceSample - firstSourceSample);
+    juce::AudioBuffer<float> buffer ((int) reader->numChannels, juce::jmin (readBlockSize, numSourceSamples));
+    std::vector<float> mono ((size_t) numSourceSamples, 0.0f);
+    const auto channelScale = 1.0f / (float) reader->numChannels;
+
+    for (int position = 0; position < numSourceSamples;)
+    {
+        if (shouldCancel && shouldCancel())
+        {
+            signal.valid = false;
+            signal.cancelled = true;
+            signal.samples.clear();
+            return signal;
+        }
+
+        const auto numThisBlock = juce::jmin (buffer.getNumSamples(), numSourceSamples - position);
+        if (! reader->read (&buffer, 0, numThisBlock, firstSourceSample + position, true, true))
+            break;
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            const auto* channelData = buffer.getReadPointer (ch);
+            for (int i = 0; i < numThisBlock; ++i)
+                mono[(size_t) (position + i)] += channelData[i] * channelScale;
+        }
+
+        position += numThisBlock;
+    }
+
+    // Resample into clip time with linear interpolation.
+    const auto firstOutput = (size_t) juce::jmax (0.0, std::ceil ((audibleStart - startSeconds) * signal.sampleRate));
+    const auto endOutput = juce::jmin (signal.samples.size(),
+                                       (size_t) std::ceil ((audibleEnd - startSeconds) * signal.sampleRate));
+
+    for (auto i = firstOutput; i < endOutput; ++i)
+    {
+        const auto position = toSourceSample (startSeconds + (double) i / signal.sampleRate) - (double) firstSourceSample;
+        const auto index = (int) std::floor (position);
+        if (index < 0 || index >= numSourceSamples)
+            continue;
+
+        const auto fraction = (float) (position - (double) index);
+        const auto next = index + 1 < numSourceSamples ? mono[(size_t) index + 1] : mono[(size_t) index];
+        signal.samples[i] = mono[(size_t) index] + fraction * (next - mono[(size_t) index]);
+    }
+
+    return signal;
+}
+
+CorrelationResult findBestLag (const std::vector<float>& reference,
+                               const std::vector<float>& target,
+                               const CorrelationSettings& settings)
+{
+    CorrelationResult result;
+
+    const auto referenceLength = (int) reference.size();
+    const auto targetLength = (int) target.size();
+    if (referenceLength <= 0 || targetLength < referenceLength)
+        return result;
+
+    const auto referenceEnergy = sumOfSquares (reference.data(), referenceLength);
+    if (referenceEnergy <= 1.0e-12)
+        return result;
+
+    // Coarse pass on decimated copies, keeping enough of the reference to
+    // correlate meaningfully.
+    auto factor = juce::jmax (1, settings.decimationFactor);
+    while (factor > 1 && referenceLength / factor < 64)
+        factor /= 2;
+
+    int searchStart = 0;
+    int searchEnd = targetLength - referenceLength;
+
+    if (searchEnd > 0)
+    {
+        const auto coarseLag = factor > 1
+            ? findCoarseLag (decimate (reference, factor), decimate (target, factor), settings.detectPolarity)
+            : findCoarseLag (reference, target, settings.detectPolarity);
+
+        // Decimation blurs the peak by about one coarse step either way.
+        searchStart = juce::jmax (0, (coarseLag - 2) * factor);
+        searchEnd = juce::jmin (searchEnd, (coarseLag + 2) * factor);
+    }
+
+    double bestScore = settings.detectPolarity ? 0.0 : -std::numeric_limits<double>::max();
+
+    for (int lag = searchStart; lag <= searchEnd; ++lag)
+    {
+        const auto* window = target.data() + lag;
+        double dot = 0.0;
+        for (int i = 0; i < referenceLength; ++i)
+            dot += (double) reference[(size_t) i] * (double) window[i];
+
+        const auto energy = sumOfSquares (window, referenceLength);
+        if (energy <= 1.0e-12)
+            continue;
+
+        const auto score = dot / std::sqrt (referenceEnergy * energy);
+        if (isBetterScore (score, bestScore, settings.detectPolarity))
+        {
+            bestScore = score;
+            result.lagSamples = lag;
+            result.valid = true;
+        }
+    }
+
+    if (result.valid)
+    {
+        result.correlation = (float) bestScore;
+        result.polarityInverted = settings.detectPolarity && bestScore < 0.0;
+    }
+
+    return result;
+}
+
+} // namespace waive
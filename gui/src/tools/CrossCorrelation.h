@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+
+#include "AudioAnalysis.h"
+
+namespace waive
+{
+
+/** Mono audio from part of a clip, resampled to a fixed rate in clip time. */
+struct ClipSignal
+{
+    bool valid = false;
+    bool cancelled = false;
+    double sampleRate = 0.0;
+    std::vector<float> samples;
+};
+
+/** Reads lengthSeconds of a clip starting startSeconds after the clip start
+    (which may be negative), mixed to mono and resampled to sampleRate. Times
+    outside the clip or the file read as silence. A sampleRate of 0 uses the
+    file's rate adjusted for the clip's speed. Memory is bounded by the
+    requested length, not the file length. */
+ClipSignal readClipSignal (const juce::File& sourceFile,
+                           const AudioAnalysisRange& range,
+                           double startSeconds,
+                           double lengthSeconds,
+                           double sampleRate = 0.0,
+                           const std::function<bool()>& shouldCancel = {});
+
+struct CorrelationSettings
+{
+    int decimationFactor = 8;     // coarse search runs at 1/decimationFactor of the rate
+    bool detectPolarity = false;  // also match the reference against the inverted target
+};
+
+struct CorrelationResult
+{
+    bool valid = false;
+    int lagSamples = 0;           // offset into the target where the reference lines up best
+    float correlation = 0.0f;     // normalised correlation at that offset, -1 .. 1
+    bool polarityInverted = false;
+};
+
+/** Finds the offset at which reference best matches target, which must be at
+    least as long. A coarse FFT cross-correlation of decimated copies finds
+    the peak, then a direct search at full rate around it makes the offset
+    sample-accurate. Correlation is normalised by the energy under the
+    reference at each offset, so loud passages don't win on level alone. */
+CorrelationResult findBestLag (const std::vector<float>& reference,
+                               const std::vector<float>& target,
+                               const CorrelationSettings& settings = {});
+
+} // namespace waive
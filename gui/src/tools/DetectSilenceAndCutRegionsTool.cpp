@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <map>
 #include <optional>
+#include <vector>
 #include <tracktion_engine/tracktion_engine.h>
 
 #include "AudioAnalysis.h"
@@ -14,16 +15,20 @@
 #include "SelectionManager.h"
 #include "SessionComponent.h"
 #include "TimelineComponent.h"
+#include "ToolAnalysisStore.h"
 
 namespace te = tracktion;
 
 namespace
 {
+constexpr double minClipSeconds = 0.01;
+
 struct ClipPlanInput
 {
     te::EditItemID clipID;
     juce::String clipName;
     juce::File sourceFile;
+    waive::AudioAnalysisRange analysisRange;
     int trackIndex = -1;
     double clipStartSeconds = 0.0;
     double clipEndSeconds = 0.0;
@@ -68,6 +73,54 @@ double parsePaddingSeconds (const juce::var& params)
     return juce::jlimit (0.0, 250.0, paddingMs) / 1000.0;
 }
 
+bool parseCutInteriorGaps (const juce::var& params)
+{
+    if (auto* paramsObj = params.getDynamicObject())
+        if (paramsObj->hasProperty ("cut_interior_gaps"))
+            return (bool) paramsObj->getProperty ("cut_interior_gaps");
+
+    return false;
+}
+
+double parseHysteresisDb (const juce::var& params)
+{
+    double hysteresisDb = 6.0;
+
+    if (auto* paramsObj = params.getDynamicObject())
+    {
+        if (paramsObj->hasProperty ("hysteresis_db"))
+            hysteresisDb = (double) paramsObj->getProperty ("hysteresis_db");
+    }
+
+    return juce::jlimit (0.0, 24.0, hysteresisDb);
+}
+
+double parseHoldSeconds (const juce::var& params)
+{
+    double holdMs = 50.0;
+
+    if (auto* paramsObj = params.getDynamicObject())
+    {
+        if (paramsObj->hasProperty ("hold_ms"))
+            holdMs = (double) paramsObj->getProperty ("hold_ms");
+    }
+
+    return juce::jlimit (0.0, 1000.0, holdMs) / 1000.0;
+}
+
+double parseMinGapSeconds (const juce::var& params)
+{
+    double minGapMs = 300.0;
+
+    if (auto* paramsObj = params.getDynamicObject())
+    {
+        if (paramsObj->hasProperty ("min_gap_ms"))
+            minGapMs = (double) paramsObj->getProperty ("min_gap_ms");
+    }
+
+    return juce::jlimit (20.0, 10000.0, minGapMs) / 1000.0;
+}
+
 int parseAnalysisDelayMs (const juce::var& params)
 {
     int delayMs = 0;
@@ -123,8 +176,9 @@ ToolDescription DetectSilenceAndCutRegionsTool::describe() const
     ToolDescription desc;
     desc.name = "detect_silence_and_cut_regions";
     desc.displayName = "Detect Silence And Cut Regions";
-    desc.version = "1.0.0";
-    desc.description = "Trim leading and trailing silence from selected audio clips.";
+    desc.version = "1.1.0";
+    desc.description = "Trim leading and trailing silence from selected audio clips, optionally cutting out silent gaps inside them. Looped clips are skipped.";
+    desc.speculativePlanning = true;
 
     auto* schemaObj = new juce::DynamicObject();
     schemaObj->setProperty ("type", "object");
@@ -155,6 +209,36 @@ ToolDescription DetectSilenceAndCutRegionsTool::describe() const
     paddingObj->setProperty ("description", "Padding to keep around detected content in milliseconds");
     propsObj->setProperty ("padding_ms", juce::var (paddingObj));
 
+    auto* interiorObj = new juce::DynamicObject();
+    interiorObj->setProperty ("type", "boolean");
+    interiorObj->setProperty ("default", false);
+    interiorObj->setProperty ("description", "Also split clips and remove silent gaps inside them");
+    propsObj->setProperty ("cut_interior_gaps", juce::var (interiorObj));
+
+    auto* hysteresisObj = new juce::DynamicObject();
+    hysteresisObj->setProperty ("type", "number");
+    hysteresisObj->setProperty ("minimum", 0.0);
+    hysteresisObj->setProperty ("maximum", 24.0);
+    hysteresisObj->setProperty ("default", 6.0);
+    hysteresisObj->setProperty ("description", "How far below the threshold the level must fall before a region closes, in dB");
+    propsObj->setProperty ("hysteresis_db", juce::var (hysteresisObj));
+
+    auto* holdObj = new juce::DynamicObject();
+    holdObj->setProperty ("type", "number");
+    holdObj->setProperty ("minimum", 0.0);
+    holdObj->setProperty ("maximum", 1000.0);
+    holdObj->setProperty ("default", 50.0);
+    holdObj->setProperty ("description", "How long the level must stay low before a region closes, in milliseconds");
+    propsObj->setProperty ("hold_ms", juce::var (holdObj));
+
+    auto* minGapObj = new juce::DynamicObject();
+    minGapObj->setProperty ("type", "number");
+    minGapObj->setProperty ("minimum", 20.0);
+    minGapObj->setProperty ("maximum", 10000.0);
+    minGapObj->setProperty ("default", 300.0);
+    minGapObj->setProperty ("description", "Shortest interior silence to cut, in milliseconds");
+    propsObj->setProperty ("min_gap_ms", juce::var (minGapObj));
+
     auto* delayObj = new juce::DynamicObject();
     delayObj->setProperty ("type", "integer");
     delayObj->setProperty ("minimum", 0);
@@ -169,6 +253,10 @@ ToolDescription DetectSilenceAndCutRegionsTool::describe() const
     defaults->setProperty ("threshold_db", -42.0);
     defaults->setProperty ("min_trim_ms", 20.0);
     defaults->setProperty ("padding_ms", 5.0);
+    defaults->setProperty ("cut_interior_gaps", false);
+    defaults->setProperty ("hysteresis_db", 6.0);
+    defaults->setProperty ("hold_ms", 50.0);
+    defaults->setProperty ("min_gap_ms", 300.0);
     defaults->setProperty ("analysis_delay_ms", 0);
     desc.defaultParams = juce::var (defaults);
 
@@ -188,6 +276,7 @@ juce::Result DetectSilenceAndCutRegionsTool::preparePlan (const ToolExecutionCon
 
     std::vector<ClipPlanInput> clipsToProcess;
     clipsToProcess.reserve ((size_t) selectedClips.size());
+    int loopedClipCount = 0;
 
     for (auto* clip : selectedClips)
     {
@@ -198,6 +287,14 @@ juce::Result DetectSilenceAndCutRegionsTool::preparePlan (const ToolExecutionCon
         if (waveClip == nullptr)
             continue;
 
+        // A looped clip replays its loop range, so a position in the file
+        // doesn't map to one place in the clip; trims and cuts would land wrong.
+        if (waveClip->isLooping())
+        {
+            ++loopedClipCount;
+            continue;
+        }
+
         const auto sourceFile = waveClip->getSourceFileReference().getFile();
         if (! sourceFile.existsAsFile())
             continue;
@@ -213,25 +310,50 @@ juce::Result DetectSilenceAndCutRegionsTool::preparePlan (const ToolExecutionCon
         input.trackIndex = it->second;
         input.clipStartSeconds = clip->getPosition().getStart().inSeconds();
         input.clipEndSeconds = clip->getPosition().getEnd().inSeconds();
+        input.analysisRange = AudioAnalysisRange::forClip (*waveClip);
 
         clipsToProcess.push_back (std::move (input));
     }
 
     if (clipsToProcess.empty())
-        return juce::Result::fail ("Selected clips are not analysable audio clips");
+        return juce::Result::fail (loopedClipCount > 0 ? "Looped clips cannot be trimmed to silence; turn looping off first"
+                                                       : "Selected clips are not analysable audio clips");
 
     const auto thresholdDb = parseThresholdDb (params);
     const auto thresholdGain = juce::Decibels::decibelsToGain ((float) thresholdDb);
     const auto minTrimSeconds = parseMinTrimSeconds (params);
     const auto paddingSeconds = parsePaddingSeconds (params);
+    const auto cutInteriorGaps = parseCutInteriorGaps (params);
     const auto analysisDelayMs = parseAnalysisDelayMs (params);
     const auto cacheDirectory = context.projectCacheDirectory;
     const auto description = describe();
 
+    ActivityGateSettings gate;
+    gate.openThresholdGain = thresholdGain;
+    gate.closeThresholdGain = juce::Decibels::decibelsToGain ((float) (thresholdDb - parseHysteresisDb (params)));
+    gate.holdSeconds = parseHoldSeconds (params);
+    gate.minGapSeconds = parseMinGapSeconds (params) + 2.0 * paddingSeconds;
+
+    // The gate decides what is found; padding and the minimum trim only
+    // decide which findings become edits.
+    const auto analysisStore = ToolAnalysisStore::forProject (cacheDirectory);
+    auto* analysisParamsObj = new juce::DynamicObject();
+    analysisParamsObj->setProperty ("threshold_gain", thresholdGain);
+    analysisParamsObj->setProperty ("cut_interior_gaps", cutInteriorGaps);
+    if (cutInteriorGaps)
+    {
+        analysisParamsObj->setProperty ("close_gain", gate.closeThresholdGain);
+        analysisParamsObj->setProperty ("hold_seconds", gate.holdSeconds);
+        analysisParamsObj->setProperty ("min_gap_seconds", gate.minGapSeconds);
+        analysisParamsObj->setProperty ("min_region_seconds", gate.minRegionSeconds);
+    }
+    const juce::var analysisParams (analysisParamsObj);
+
     outTask.jobName = "Plan: " + description.displayName;
-    outTask.run = [clipsToProcess = std::move (clipsToProcess),
-                   thresholdGain, minTrimSeconds, paddingSeconds,
-                   analysisDelayMs, cacheDirectory, params, description] (ProgressReporter& reporter)
+    outTask.run = [clipsToProcess = std::move (clipsToProcess), loopedClipCount,
+                   thresholdGain, minTrimSeconds, paddingSeconds, cutInteriorGaps, gate,
+                   analysisDelayMs, params, description,
+                   analysisStore, analysisParams] (ProgressReporter& reporter)
     {
         ToolPlan plan;
         plan.toolName = description.name;
@@ -239,39 +361,54 @@ juce::Result DetectSilenceAndCutRegionsTool::preparePlan (const ToolExecutionCon
         plan.planID = juce::Uuid().toString();
         plan.inputParams = params;
 
-        int clippedCount = 0;
-
+        // Clips are independent, so they are analysed in parallel. Each clip
+        // is one linear pass over its range.
         const int total = (int) clipsToProcess.size();
-        for (int i = 0; i < total; ++i)
-        {
-            if (reporter.isCancelled())
-                return plan;
+        std::vector<AudioAnalysisSummary> analyses ((size_t) total);
 
+        runInParallel (reporter, total, [&] (int i)
+        {
             sleepWithCancellation (reporter, analysisDelayMs);
-            if (reporter.isCancelled())
-                return plan;
 
+            const auto cancelled = [&reporter]() { return reporter.isCancelled(); };
+            const auto& clipInput = clipsToProcess[(size_t) i];
+            const auto analyse = [&]
+            {
+                return cutInteriorGaps
+                    ? detectActiveRegions (clipInput.sourceFile, clipInput.analysisRange, gate, cancelled)
+                    : analyseAudioFile (clipInput.sourceFile, clipInput.analysisRange,
+                                        thresholdGain, thresholdGain, cancelled);
+            };
+
+            analyses[(size_t) i] = analysisStore != nullptr
+                ? analysisStore->getOrAnalyse (ToolAnalysisStore::makeKey (description, analysisParams,
+                                                                           clipInput.sourceFile,
+                                                                           clipInput.analysisRange),
+                                               analyse)
+                : analyse();
+        });
+
+        if (reporter.isCancelled())
+            return plan;
+
+        int clippedCount = 0;
+        int gapCount = 0;
+
+        for (int i = 0; i < total; ++i)
+        {
             const auto& clipInput = clipsToProcess[(size_t) i];
-            const auto analysis = analyseAudioFile (
-                clipInput.sourceFile,
-                thresholdGain,
-                thresholdGain,
-                [&reporter]() { return reporter.isCancelled(); });
+            const auto& analysis = analyses[(size_t) i];
 
             if (! analysis.valid || analysis.sampleRate <= 0.0 || analysis.totalSamples <= 0
                 || analysis.firstAboveSample < 0 || analysis.lastAboveSample < 0)
-            {
-                reporter.setProgress ((float) (i + 1) / (float) total,
-                                      "Skipped silent clip: " + clipInput.clipName);
                 continue;
-            }
 
             const auto clipLengthSeconds = clipInput.clipEndSeconds - clipInput.clipStartSeconds;
-            if (clipLengthSeconds <= 0.01)
+            if (clipLengthSeconds <= minClipSeconds)
                 continue;
 
-            const auto activeStartSecondsRaw = ((double) analysis.firstAboveSample / analysis.sampleRate) - paddingSeconds;
-            const auto activeEndSecondsRaw = ((double) analysis.lastAboveSample / analysis.sampleRate) + paddingSeconds;
+            const auto activeStartSecondsRaw = analysis.toClipSeconds (analysis.firstAboveSample) - paddingSeconds;
+            const auto activeEndSecondsRaw = analysis.toClipSeconds (analysis.lastAboveSample) + paddingSeconds;
 
             const auto activeStartSeconds = juce::jlimit (0.0, clipLengthSeconds, activeStartSecondsRaw);
             const auto activeEndSeconds = juce::jlimit (0.0, clipLengthSeconds, activeEndSecondsRaw);
@@ -280,9 +417,9 @@ juce::Result DetectSilenceAndCutRegionsTool::preparePlan (const ToolExecutionCon
             auto newClipEnd = clipInput.clipStartSeconds + activeEndSeconds;
 
             newClipStart = juce::jlimit (clipInput.clipStartSeconds,
-                                         clipInput.clipEndSeconds - 0.01,
+                                         clipInput.clipEndSeconds - minClipSeconds,
                                          newClipStart);
-            newClipEnd = juce::jlimit (newClipStart + 0.01,
+            newClipEnd = juce::jlimit (newClipStart + minClipSeconds,
                                        clipInput.clipEndSeconds,
                                        newClipEnd);
 
@@ -322,18 +459,55 @@ juce::Result DetectSilenceAndCutRegionsTool::preparePlan (const ToolExecutionCon
                 changed = true;
             }
 
+            // Gaps between regions, shrunk by the padding kept around each region.
+            const auto& regions = analysis.activeRegions;
+            for (size_t r = 1; r < regions.size(); ++r)
+            {
+                const auto gapStart = clipInput.clipStartSeconds
+                                      + analysis.toClipSeconds (regions[r - 1].endSample) + paddingSeconds;
+                const auto gapEnd = clipInput.clipStartSeconds
+                                    + analysis.toClipSeconds (regions[r].startSample) - paddingSeconds;
+
+                if (gapStart <= newClipStart + minClipSeconds || gapEnd >= newClipEnd - minClipSeconds
+                    || gapEnd - gapStart < minClipSeconds)
+                    continue;
+
+                ToolDiffEntry cut;
+                cut.kind = ToolDiffKind::clipTrimmed;
+                cut.trackIndex = clipInput.trackIndex;
+                cut.clipID = clipInput.clipID;
+                cut.targetName = clipInput.clipName;
+                cut.parameterID = "clip.remove_range";
+                cut.beforeValue = gapStart;
+                cut.afterValue = gapEnd;
+                cut.summary = "Cut " + juce::String (gapEnd - gapStart, 3) + " s of silence at "
+                              + juce::String (gapStart, 3) + " s from clip '" + clipInput.clipName + "'";
+                plan.changes.add (cut);
+                ++gapCount;
+                changed = true;
+            }
+
             if (changed)
                 ++clippedCount;
-
-            reporter.setProgress ((float) (i + 1) / (float) total,
-                                  "Analysed " + juce::String (i + 1) + " / " + juce::String (total));
         }
 
-        plan.summary = "Trim silence on " + juce::String (clippedCount) + " clip(s)";
+        plan.summary = cutInteriorGaps
+                         ? "Cut " + juce::String (gapCount) + " silent gap(s) and trim silence on "
+                               + juce::String (clippedCount) + " clip(s)"
+                         : "Trim silence on " + juce::String (clippedCount) + " clip(s)";
+
+        if (loopedClipCount > 0)
+            plan.summary << "; skipped " << loopedClipCount << " looped clip(s)";
 
-        writePlanArtifact (cacheDirectory, description.name, plan);
         return plan;
     };
+    outTask.writeArtifact = [cacheDirectory, toolName = description.name, analysisStore] (ToolPlan& plan)
+    {
+        if (analysisStore != nullptr)
+            analysisStore->save();
+
+        writePlanArtifact (cacheDirectory, toolName, plan);
+    };
 
     return juce::Result::ok();
 }
@@ -351,6 +525,7 @@ juce::Result DetectSilenceAndCutRegionsTool::apply (const ToolExecutionContext&
     {
         std::optional<double> start;
         std::optional<double> end;
+        std::vector<std::pair<double, double>> removedRanges;
     };
 
     struct ClipTrimPlan
@@ -375,20 +550,28 @@ juce::Result DetectSilenceAndCutRegionsTool::apply (const ToolExecutionContext&
             clipTrim.values.start = change.afterValue;
         else if (change.parameterID == "clip.end_seconds")
             clipTrim.values.end = change.afterValue;
+        else if (change.parameterID == "clip.remove_range")
+            clipTrim.values.removedRanges.emplace_back (change.beforeValue, change.afterValue);
     }
 
     if (trimsByClip.empty())
         return juce::Result::fail ("No clip trim changes in plan");
 
+    // Everything happens in one bulk edit, so however many clips are cut the
+    // whole plan undoes in a single step and the timeline redraws once.
     int appliedCount = 0;
-    const auto ok = context.editSession.performEdit ("Detect Silence And Cut Regions", [&] (te::Edit& edit)
+    const auto ok = context.editSession.performBulkEdit ("Detect Silence And Cut Regions", [&] (te::Edit& edit)
     {
-        for (const auto& pair : trimsByClip)
+        const auto clipsByID = buildClipLookup (edit);
+
+        for (auto& pair : trimsByClip)
         {
-            auto* clip = te::findClipForID (edit, pair.second.clipID);
-            if (clip == nullptr)
+            const auto found = clipsByID.find (pair.second.clipID);
+            if (found == clipsByID.end())
                 continue;
 
+            auto* clip = found->second;
+
             auto* waveClip = dynamic_cast<te::WaveAudioClip*> (clip);
             if (waveClip == nullptr)
                 continue;
@@ -402,12 +585,37 @@ juce::Result DetectSilenceAndCutRegionsTool::apply (const ToolExecutionContext&
             if (pair.second.values.end.has_value())
                 newEnd = *pair.second.values.end;
 
-            if (newEnd <= newStart + 0.01)
+            if (newEnd <= newStart + minClipSeconds)
+                continue;
+
+            if (pair.second.values.start.has_value() || pair.second.values.end.has_value())
+            {
+                clip->setStart (te::TimePosition::fromSeconds (newStart), false, true);
+                clip->setEnd (te::TimePosition::fromSeconds (newEnd), true);
+                ++appliedCount;
+            }
+
+            // Cut gaps from the back so the clip being split always keeps the
+            // earlier audio and the remaining ranges stay inside it.
+            auto& ranges = pair.second.values.removedRanges;
+            std::sort (ranges.begin(), ranges.end(), [] (const auto& a, const auto& b) { return a.first > b.first; });
+
+            auto* clipTrack = dynamic_cast<te::ClipTrack*> (clip->getTrack());
+            if (clipTrack == nullptr)
                 continue;
 
-            clip->setStart (te::TimePosition::fromSeconds (newStart), false, true);
-            clip->setEnd (te::TimePosition::fromSeconds (newEnd), true);
-            ++appliedCount;
+            for (const auto& [gapStart, gapEnd] : ranges)
+            {
+                if (gapStart <= newStart + minClipSeconds || gapEnd >= clip->getPosition().getEnd().inSeconds() - minClipSeconds
+                    || gapEnd - gapStart < minClipSeconds)
+                    continue;
+
+                if (clipTrack->splitClip (*clip, te::TimePosition::fromSeconds (gapEnd)) == nullptr)
+                    continue;
+
+                clip->setEnd (te::TimePosition::fromSeconds (gapStart), true);
+                ++appliedCount;
+            }
         }
     });
 
@@ -0,0 +1,396 @@
+#include "DetectTempoTool.h"
+
+#include <algorithm>
+#include <vector>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include "AudioAnalysisCache.h"
+#include "AudioFeatures.h"
+#include "EditSession.h"
+#include "JobQueue.h"
+#include "PathSanitizer.h"
+#include "ProjectManager.h"
+#include "SelectionManager.h"
+#include "SessionComponent.h"
+#include "TempoAnalysis.h"
+#include "TimelineComponent.h"
+
+namespace te = tracktion;
+
+namespace
+{
+// Enough for a long session; beyond this the markers stop being readable.
+constexpr int maxBeatMarkers = 2000;
+
+struct ClipPlanInput
+{
+    te::EditItemID clipID;
+    juce::String clipName;
+    juce::File sourceFile;
+    waive::AudioAnalysisRange analysisRange;
+    double clipStartSeconds = 0.0;
+    double clipLengthSeconds = 0.0;
+};
+
+/** Onsets only, at 1024-point frames: tempo doesn't need finer frequency
+    resolution, and halving the frame halves the transform cost. */
+waive::FeatureSettings getOnsetFeatureSettings()
+{
+    waive::FeatureSettings settings;
+    settings.fftOrder = 10;
+    settings.hopSize = 512;
+    settings.computeOnsets = true;
+    return settings;
+}
+
+double parseBpmParam (const juce::var& params, const juce::Identifier& name, double defaultBpm)
+{
+    double bpm = defaultBpm;
+
+    if (auto* paramsObj = params.getDynamicObject())
+    {
+        if (paramsObj->hasProperty (name))
+            bpm = (double) paramsObj->getProperty (name);
+    }
+
+    return juce::jlimit (40.0, 300.0, bpm);
+}
+
+bool parseBoolParam (const juce::var& params, const juce::Identifier& name, bool defaultValue)
+{
+    if (auto* paramsObj = params.getDynamicObject())
+        if (paramsObj->hasProperty (name))
+            return (bool) paramsObj->getProperty (name);
+
+    return defaultValue;
+}
+
+void addClipInput (te::Clip* clip, std::vector<ClipPlanInput>& inputs)
+{
+    auto* waveClip = dynamic_cast<te::WaveAudioClip*> (clip);
+    if (waveClip == nullptr)
+        return;
+
+    const auto sourceFile = waveClip->getSourceFileReference().getFile();
+    if (! sourceFile.existsAsFile())
+        return;
+
+    ClipPlanInput input;
+    input.clipID = clip->itemID;
+    input.clipName = clip->getName();
+    input.sourceFile = sourceFile;
+    input.analysisRange = waive::AudioAnalysisRange::forClip (*waveClip);
+    input.clipStartSeconds = clip->getPosition().getStart().inSeconds();
+    input.clipLengthSeconds = clip->getPosition().getLength().inSeconds();
+    inputs.push_back (std::move (input));
+}
+
+void writePlanArtifact (const juce::File& cacheDirectory, const juce::String& toolName, waive::ToolPlan& plan)
+{
+    if (cacheDirectory == juce::File())
+        return;
+
+    auto sanitizedToolName = waive::PathSanitizer::sanitizePathComponent (toolName);
+    auto sanitizedPlanID = waive::PathSanitizer::sanitizePathComponent (plan.planID);
+    if (sanitizedToolName.isEmpty() || sanitizedPlanID.isEmpty())
+        return;
+
+    auto artifactDir = cacheDirectory.getChildFile ("tools").getChildFile (sanitizedToolName);
+    artifactDir.createDirectory();
+
+    auto artifact = artifactDir.getChildFile ("plan_" + sanitizedPlanID + ".json");
+    artifact.replaceWithText (juce::JSON::toString (waive::toolPlanToJson (plan), true));
+    plan.artifactFile = artifact;
+}
+}
+
+namespace waive
+{
+
+DetectTempoTool::DetectTempoTool()
+    : cache (std::make_shared<AudioAnalysisCache> (128))
+{
+}
+
+ToolDescription DetectTempoTool::describe() const
+{
+    ToolDescription desc;
+    desc.name = "detect_tempo";
+    desc.displayName = "Detect Tempo";
+    desc.version = "1.0.0";
+    desc.description = "Detect the tempo and beats of the selected clips (or all audio clips when none are "
+                       "selected), then set the edit tempo and optionally mark every beat.";
+    desc.speculativePlanning = true;
+
+    auto* schemaObj = new juce::DynamicObject();
+    schemaObj->setProperty ("type", "object");
+
+    auto* propsObj = new juce::DynamicObject();
+
+    auto* minBpmObj = new juce::DynamicObject();
+    minBpmObj->setProperty ("type", "number");
+    minBpmObj->setProperty ("minimum", 40.0);
+    minBpmObj->setProperty ("maximum", 300.0);
+    minBpmObj->setProperty ("default", 60.0);
+    minBpmObj->setProperty ("description", "Slowest tempo to consider, in BPM");
+    propsObj->setProperty ("min_bpm", juce::var (minBpmObj));
+
+    auto* maxBpmObj = new juce::DynamicObject();
+    maxBpmObj->setProperty ("type", "number");
+    maxBpmObj->setProperty ("minimum", 40.0);
+    maxBpmObj->setProperty ("maximum", 300.0);
+    maxBpmObj->setProperty ("default", 200.0);
+    maxBpmObj->setProperty ("description", "Fastest tempo to consider, in BPM");
+    propsObj->setProperty ("max_bpm", juce::var (maxBpmObj));
+
+    auto* setTempoObj = new juce::DynamicObject();
+    setTempoObj->setProperty ("type", "boolean");
+    setTempoObj->setProperty ("default", true);
+    setTempoObj->setProperty ("description", "Set the edit tempo to the detected BPM");
+    propsObj->setProperty ("set_tempo", juce::var (setTempoObj));
+
+    auto* markersObj = new juce::DynamicObject();
+    markersObj->setProperty ("type", "boolean");
+    markersObj->setProperty ("default", false);
+    markersObj->setProperty ("description", "Add a marker on every detected beat (at most "
+                                            + juce::String (maxBeatMarkers) + ")");
+    propsObj->setProperty ("add_beat_markers", juce::var (markersObj));
+
+    schemaObj->setProperty ("properties", juce::var (propsObj));
+    desc.inputSchema = juce::var (schemaObj);
+
+    auto* defaults = new juce::DynamicObject();
+    defaults->setProperty ("min_bpm", 60.0);
+    defaults->setProperty ("max_bpm", 200.0);
+    defaults->setProperty ("set_tempo", true);
+    defaults->setProperty ("add_beat_markers", false);
+    desc.defaultParams = juce::var (defaults);
+
+    return desc;
+}
+
+juce::Result DetectTempoTool::preparePlan (const ToolExecutionContext& context,
+                                           const juce::var& params,
+                                           ToolPlanTask& outTask)
+{
+    auto& edit = context.editSession.getEdit();
+    std::vector<ClipPlanInput> clipsToProcess;
+
+    auto selectedClips = context.sessionComponent.getTimeline().getSelectionManager().getSelectedClips();
+    if (! selectedClips.isEmpty())
+    {
+        for (auto* clip : selectedClips)
+            if (clip != nullptr)
+                addClipInput (clip, clipsToProcess);
+    }
+    else
+    {
+        for (auto* track : te::getAudioTracks (edit))
+            for (auto* clip : track->getClips())
+                addClipInput (clip, clipsToProcess);
+    }
+
+    if (clipsToProcess.empty())
+        return juce::Result::fail ("No analysable audio clips for tempo detection");
+
+    TempoSettings tempoSettings;
+    tempoSettings.minBpm = parseBpmParam (params, "min_bpm", 60.0);
+    tempoSettings.maxBpm = parseBpmParam (params, "max_bpm", 200.0);
+    if (tempoSettings.minBpm > tempoSettings.maxBpm)
+        std::swap (tempoSettings.minBpm, tempoSettings.maxBpm);
+
+    // Lean towards 120 unless the range excludes it.
+    tempoSettings.preferredBpm = juce::jlimit (tempoSettings.minBpm, tempoSettings.maxBpm, 120.0);
+
+    const auto setTempo = parseBoolParam (params, "set_tempo", true);
+    const auto addBeatMarkers = parseBoolParam (params, "add_beat_markers", false);
+    const auto currentBpm = edit.tempoSequence.getNumTempos() > 0 ? edit.tempoSequence.getTempo (0)->getBpm() : 120.0;
+    const auto cacheDirectory = context.projectCacheDirectory;
+    const auto description = describe();
+    const auto analysisCache = cache;
+
+    outTask.jobName = "Plan: " + description.displayName;
+    outTask.run = [clipsToProcess = std::move (clipsToProcess),
+                   tempoSettings, setTempo, addBeatMarkers, currentBpm,
+                   params, description, analysisCache] (ProgressReporter& reporter)
+    {
+        ToolPlan plan;
+        plan.toolName = description.name;
+        plan.toolVersion = description.version;
+        plan.planID = juce::Uuid().toString();
+        plan.inputParams = params;
+
+        const auto numClips = (int) clipsToProcess.size();
+        const auto featureSettings = getOnsetFeatureSettings();
+        std::vector<AudioFeatures> features ((size_t) numClips);
+        std::vector<std::vector<double>> strengths ((size_t) numClips);
+
+        runInParallel (reporter, numClips, [&] (int i)
+        {
+            const auto& input = clipsToProcess[(size_t) i];
+            auto& clipFeatures = features[(size_t) i];
+            clipFeatures = extractFeatures (input.sourceFile, input.analysisRange, featureSettings,
+                                            [&reporter]() { return reporter.isCancelled(); },
+                                            analysisCache.get());
+
+            if (clipFeatures.valid)
+                strengths[(size_t) i] = computeTempoStrength (clipFeatures.onsetStrength,
+                                                              clipFeatures.getFrameRate(), tempoSettings);
+        });
+
+        if (reporter.isCancelled())
+            return plan;
+
+        // Every clip votes for the tempo its envelope repeats at; the votes
+        // are normalised per clip, so long clips don't drown out short ones.
+        std::vector<double> sessionStrength;
+        int votingClips = 0;
+        for (const auto& strength : strengths)
+        {
+            if (strength.empty())
+                continue;
+
+            sessionStrength.resize (strength.size(), 0.0);
+            for (size_t i = 0; i < strength.size(); ++i)
+                sessionStrength[i] += strength[i];
+
+            ++votingClips;
+        }
+
+        const auto bpm = std::round (pickTempo (sessionStrength, tempoSettings) * 10.0) / 10.0;
+        if (bpm <= 0.0)
+        {
+            plan.summary = "No steady tempo found in " + juce::String (numClips) + " clip(s)";
+            return plan;
+        }
+
+        if (setTempo && std::abs (bpm - currentBpm) >= 0.05)
+        {
+            ToolDiffEntry change;
+            change.kind = ToolDiffKind::parameterChanged;
+            change.targetName = "Tempo";
+            change.parameterID = "tempo.bpm";
+            change.beforeValue = currentBpm;
+            change.afterValue = bpm;
+            change.summary = "Set tempo " + juce::String (currentBpm, 1) + " -> " + juce::String (bpm, 1) + " BPM";
+            plan.changes.add (change);
+        }
+
+        int numMarkers = 0;
+        if (addBeatMarkers)
+        {
+            std::vector<std::vector<double>> clipBeats ((size_t) numClips);
+            runInParallel (reporter, numClips, [&] (int i)
+            {
+                const auto& clipFeatures = features[(size_t) i];
+                if (strengths[(size_t) i].empty())
+                    return;
+
+                const auto& input = clipsToProcess[(size_t) i];
+                for (auto frame : trackBeats (clipFeatures.onsetStrength, clipFeatures.getFrameRate(), bpm, tempoSettings))
+                {
+                    const auto clipSeconds = clipFeatures.frameToClipSeconds (frame);
+                    if (clipSeconds < input.clipLengthSeconds)
+                        clipBeats[(size_t) i].push_back (input.clipStartSeconds + clipSeconds);
+                }
+            }, "Tracked");
+
+            if (reporter.isCancelled())
+                return plan;
+
+            std::vector<double> beats;
+            for (const auto& clip : clipBeats)
+                beats.insert (beats.end(), clip.begin(), clip.end());
+
+            std::sort (beats.begin(), beats.end());
+
+            // Clips that play together find the same beats; keep one marker
+            // per beat.
+            const auto mergeSeconds = 0.25 * 60.0 / bpm;
+            double lastMarker = -1.0e9;
+
+            for (auto beat : beats)
+            {
+                if (beat - lastMarker < mergeSeconds)
+                    continue;
+
+                if (numMarkers >= maxBeatMarkers)
+                    break;
+
+                lastMarker = beat;
+                ++numMarkers;
+
+                ToolDiffEntry change;
+                change.kind = ToolDiffKind::clipInserted;
+                change.targetName = "Beat " + juce::String (numMarkers);
+                change.parameterID = "marker.add";
+                change.afterValue = beat;
+                change.summary = "Add marker '" + change.targetName + "' at " + juce::String (beat, 3) + " s";
+                plan.changes.add (change);
+            }
+        }
+
+        plan.summary = "Detected " + juce::String (bpm, 1) + " BPM from " + juce::String (votingClips) + " clip(s)";
+        if (addBeatMarkers)
+            plan.summary << "; " << numMarkers << " beat marker(s)";
+
+        return plan;
+    };
+    outTask.writeArtifact = [cacheDirectory, toolName = description.name] (ToolPlan& plan)
+    {
+        writePlanArtifact (cacheDirectory, toolName, plan);
+    };
+
+    return juce::Result::ok();
+}
+
+juce::Result DetectTempoTool::apply (const ToolExecutionContext& context,
+                                     const ToolPlan& plan)
+{
+    if (plan.toolName != describe().name)
+        return juce::Result::fail ("Tool plan does not match tempo detection tool");
+
+    if (plan.changes.isEmpty())
+        return juce::Result::fail ("Tool plan has no changes to apply");
+
+    int appliedCount = 0;
+    const auto ok = context.editSession.performBulkEdit ("Detect Tempo", [&] (te::Edit& edit)
+    {
+        for (const auto& change : plan.changes)
+        {
+            if (change.kind == ToolDiffKind::parameterChanged && change.parameterID == "tempo.bpm")
+            {
+                if (edit.tempoSequence.getNumTempos() == 0)
+                    continue;
+
+                edit.tempoSequence.getTempo (0)->setBpm (juce::jlimit (te::TempoSetting::minBPM,
+                                                                       te::TempoSetting::maxBPM,
+                                                                       change.afterValue));
+                ++appliedCount;
+            }
+            else if (change.kind == ToolDiffKind::clipInserted && change.parameterID == "marker.add")
+            {
+                edit.ensureMarkerTrack();
+                auto* markerTrack = edit.getMarkerTrack();
+                if (markerTrack == nullptr)
+                    continue;
+
+                const auto position = te::TimePosition::fromSeconds (change.afterValue);
+                if (markerTrack->insertNewClip (te::TrackItem::Type::marker, change.targetName,
+                                                te::TimeRange (position, position + te::TimeDuration::fromSeconds (0.1)),
+                                                nullptr) != nullptr)
+                    ++appliedCount;
+            }
+        }
+    });
+
+    if (! ok)
+        return juce::Result::fail ("Failed to apply tempo detection changes");
+
+    if (appliedCount <= 0)
+        return juce::Result::fail ("No tempo detection changes from the plan could be applied");
+
+    return juce::Result::ok();
+}
+
+} // namespace waive
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+
+#include "Tool.h"
+
+namespace waive
+{
+
+class AudioAnalysisCache;
+
+/** Estimates one tempo from the onset envelopes of the selected clips (or
+    every audio clip when nothing is selected) and plans a tempo change and,
+    optionally, a marker on every detected beat. Envelopes are kept in the
+    tool's analysis cache, so re-planning with other settings skips the
+    audio. */
+class DetectTempoTool : public Tool
+{
+public:
+    DetectTempoTool();
+
+    ToolDescription describe() const override;
+    juce::Result preparePlan (const ToolExecutionContext& context,
+                              const juce::var& params,
+                              ToolPlanTask& outTask) override;
+    juce::Result apply (const ToolExecutionContext& context,
+                        const ToolPlan& plan) override;
+
+private:
+    // Shared with running plan jobs, which may outlive a single call.
+    std::shared_ptr<AudioAnalysisCache> cache;
+};
+
+} // namespace waive
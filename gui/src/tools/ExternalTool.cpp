@@ -190,7 +190,7 @@ juce::Result ExternalTool::apply (const ToolExecutionContext& context,
         return juce::Result::ok();
 
     int appliedCount = 0;
-    const auto ok = context.editSession.performEdit (manifest.displayName, [&] (te::Edit& edit)
+    const auto ok = context.editSession.performBulkEdit (manifest.displayName, [&] (te::Edit& edit)
     {
         auto* destTrack = findOrCreateTrackByName (edit, manifest.displayName + " Output");
         if (destTrack == nullptr)
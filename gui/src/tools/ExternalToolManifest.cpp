@@ -138,6 +138,9 @@ std::optional<ExternalToolManifest> parseManifest (const juce::File& manifestFil
     if (obj->hasProperty ("acceptsAudioInput"))
         manifest.acceptsAudioInput = (bool) obj->getProperty ("acceptsAudioInput");
 
+    if (obj->hasProperty ("wantsInputLoudness"))
+        manifest.wantsInputLoudness = (bool) obj->getProperty ("wantsInputLoudness");
+
     if (obj->hasProperty ("producesAudioOutput"))
         manifest.producesAudioOutput = (bool) obj->getProperty ("producesAudioOutput");
 
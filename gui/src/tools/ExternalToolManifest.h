@@ -20,6 +20,7 @@ struct ExternalToolManifest
     juce::File baseDirectory;
     int timeoutMs = 300000;
     bool acceptsAudioInput = false;
+    bool wantsInputLoudness = false;   // host measures the input and passes it as params.input_loudness
     bool producesAudioOutput = false;
 };
 
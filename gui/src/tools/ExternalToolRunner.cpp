@@ -1,5 +1,6 @@
 #include "ExternalToolRunner.h"
 #include "JobQueue.h"
+#include "LoudnessMeter.h"
 
 namespace waive
 {
@@ -208,9 +209,17 @@ ExternalToolOutput ExternalToolRunner::run (const ExternalToolManifest& manifest
         return output;
     }
 
+    // Tools that ask for it get the host's EBU R128 measurement of their
+    // input, so they don't need their own (approximate) loudness pass. It is
+    // a full read of the file, so tools that don't use it don't pay for it.
+    auto toolParams = params.isObject() ? params.clone() : juce::var (new juce::DynamicObject());
+    if (manifest.acceptsAudioInput && manifest.wantsInputLoudness && inputAudioFile.existsAsFile())
+        if (auto loudness = LoudnessMeter::measureFile (inputAudioFile, [&reporter] { return reporter.isCancelled(); }))
+            toolParams.getDynamicObject()->setProperty ("input_loudness", loudness->toVar());
+
     // Write params.json
     auto paramsFile = inputDir.getChildFile ("params.json");
-    if (! paramsFile.replaceWithText (juce::JSON::toString (params)))
+    if (! paramsFile.replaceWithText (juce::JSON::toString (toolParams)))
     {
         output.message = "Failed to write params.json";
         cleanupTempDirectory();
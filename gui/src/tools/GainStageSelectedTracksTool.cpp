@@ -13,6 +13,7 @@
 #include "SelectionManager.h"
 #include "SessionComponent.h"
 #include "TimelineComponent.h"
+#include "ToolAnalysisStore.h"
 
 namespace te = tracktion;
 
@@ -21,6 +22,7 @@ namespace
 struct ClipAnalysisInput
 {
     juce::File sourceFile;
+    waive::AudioAnalysisRange analysisRange;
     float clipGainDb = 0.0f;
 };
 
@@ -102,6 +104,7 @@ ToolDescription GainStageSelectedTracksTool::describe() const
     desc.displayName = "Gain-Stage Selected Tracks";
     desc.version = "1.0.0";
     desc.description = "Estimate peak level from selected clips and adjust track fader levels toward a target peak.";
+    desc.speculativePlanning = true;
 
     auto* schemaObj = new juce::DynamicObject();
     schemaObj->setProperty ("type", "object");
@@ -192,6 +195,7 @@ juce::Result GainStageSelectedTracksTool::preparePlan (const ToolExecutionContex
         ClipAnalysisInput clipInput;
         clipInput.sourceFile = sourceFile;
         clipInput.clipGainDb = audioClip->getGainDB();
+        clipInput.analysisRange = waive::AudioAnalysisRange::forClip (*waveClip);
         found->second.clips.push_back (clipInput);
     }
 
@@ -207,10 +211,12 @@ juce::Result GainStageSelectedTracksTool::preparePlan (const ToolExecutionContex
     const auto analysisDelayMs = parseAnalysisDelayMs (params);
     const auto cacheDirectory = context.projectCacheDirectory;
     const auto description = describe();
+    const auto analysisStore = ToolAnalysisStore::forProject (cacheDirectory);
 
     outTask.jobName = "Plan: " + description.displayName;
     outTask.run = [tracksToProcess = std::move (tracksToProcess),
-                   targetPeakDb, analysisDelayMs, cacheDirectory, params, description] (ProgressReporter& reporter)
+                   targetPeakDb, analysisDelayMs, params, description,
+                   analysisStore] (ProgressReporter& reporter)
     {
         ToolPlan plan;
         plan.toolName = description.name;
@@ -234,11 +240,24 @@ juce::Result GainStageSelectedTracksTool::preparePlan (const ToolExecutionContex
 
             for (const auto& clipInput : trackInput.clips)
             {
-                const auto analysis = analyseAudioFile (
-                    clipInput.sourceFile,
-                    0.0f,
-                    0.0f,
-                    [&reporter]() { return reporter.isCancelled(); });
+                const auto analyse = [&]
+                {
+                    return analyseAudioFile (
+                        clipInput.sourceFile,
+                        clipInput.analysisRange,
+                        0.0f,
+                        0.0f,
+                        [&reporter]() { return reporter.isCancelled(); });
+                };
+
+                // The peak doesn't depend on any parameter, so one entry per
+                // clip range serves every target.
+                const auto analysis = analysisStore != nullptr
+                    ? analysisStore->getOrAnalyse (ToolAnalysisStore::makeKey (description, {},
+                                                                               clipInput.sourceFile,
+                                                                               clipInput.analysisRange),
+                                                   analyse)
+                    : analyse();
 
                 if (! analysis.valid || analysis.peakGain <= 0.0f)
                     continue;
@@ -276,9 +295,15 @@ juce::Result GainStageSelectedTracksTool::preparePlan (const ToolExecutionContex
         plan.summary = "Gain-stage " + juce::String (plan.changes.size()) + " track(s) to target peak "
                        + juce::String (targetPeakDb, 1) + " dBFS";
 
-        writePlanArtifact (cacheDirectory, description.name, plan);
         return plan;
     };
+    outTask.writeArtifact = [cacheDirectory, toolName = description.name, analysisStore] (ToolPlan& plan)
+    {
+        if (analysisStore != nullptr)
+            analysisStore->save();
+
+        writePlanArtifact (cacheDirectory, toolName, plan);
+    };
 
     return juce::Result::ok();
 }
@@ -1,5 +1,8 @@
 #include "JobQueue.h"
 
+#include <exception>
+#include <thread>
+
 namespace waive
 {
 
@@ -21,9 +24,88 @@ bool ProgressReporter::isCancelled() const
     return cancelFlag.load();
 }
 
+//==============================================================================
+void runInParallel (ProgressReporter& reporter, int count, const std::function<void (int)>& work,
+                    const juce::String& verb)
+{
+    if (count <= 0)
+        return;
+
+    // A background job keeps to its own low-priority thread: a set of
+    // normal-priority workers would compete with the jobs the user is waiting on.
+    auto* currentThread = juce::Thread::getCurrentThread();
+    const bool runInline = currentThread != nullptr
+                        && currentThread->getPriority() == juce::Thread::Priority::background;
+
+    const auto numWorkers = runInline ? 1 : juce::jlimit (1, count, juce::SystemStats::getNumCpus());
+    std::atomic<int> nextItem { 0 };
+    std::atomic<int> finishedCount { 0 };
+    std::atomic<int> runningWorkers { numWorkers };
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+
+    const auto reportProgress = [&]
+    {
+        reporter.setProgress ((float) finishedCount.load() / (float) count,
+                              verb + " " + juce::String (finishedCount.load()) + " / " + juce::String (count));
+    };
+
+    auto worker = [&]
+    {
+        for (int i = nextItem++; i < count && ! reporter.isCancelled(); i = nextItem++)
+        {
+            try
+            {
+                work (i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock (failureMutex);
+                if (failure == nullptr)
+                    failure = std::current_exception();
+
+                nextItem = count;
+            }
+
+            ++finishedCount;
+
+            if (runInline)
+                reportProgress();
+        }
+
+        --runningWorkers;
+    };
+
+    if (runInline)
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        for (int w = 0; w < numWorkers; ++w)
+            workers.emplace_back (worker);
+
+        while (runningWorkers.load() > 0 && ! reporter.isCancelled())
+        {
+            reportProgress();
+            juce::Thread::sleep (20);
+        }
+
+        for (auto& thread : workers)
+            thread.join();
+    }
+
+    if (failure != nullptr)
+        std::rethrow_exception (failure);
+
+    reportProgress();
+}
+
 //==============================================================================
 JobQueue::JobQueue (int numThreads)
-    : threadPool (numThreads)
+    : threadPool (numThreads),
+      backgroundPool (1, 0, juce::Thread::Priority::background)
 {
     startTimerHz (10);
 }
@@ -33,6 +115,7 @@ JobQueue::~JobQueue()
     stopTimer();
     cancelAll();
     threadPool.removeAllJobs (true, 5000);
+    backgroundPool.removeAllJobs (true, 5000);
 }
 
 int JobQueue::submit (const JobDescriptor& descriptor, JobFunction jobFunction,
@@ -53,56 +136,108 @@ int JobQueue::submit (const JobDescriptor& descriptor, JobFunction jobFunction,
     // Fire pending event
     notifyListeners ({ id, descriptor, JobStatus::Pending, 0.0f, "Queued" });
 
-    auto capturedInfo = info;
-    auto capturedFn = std::move (jobFunction);
+    info->function = std::move (jobFunction);
 
-    threadPool.addJob ([this, capturedInfo, capturedFn]
-    {
-        capturedInfo->status.store (static_cast<int> (JobStatus::Running));
-        capturedInfo->hasUpdate.store (true);
+    const bool background = descriptor.priority == JobPriority::background;
+    (background ? backgroundPool : threadPool).addJob ([this, info, background] { runJob (info, background); });
 
-        ProgressReporter reporter (
-            capturedInfo->id,
-            capturedInfo->cancelFlag,
-            [capturedInfo] (int, float progress, const juce::String& message)
-            {
-                capturedInfo->lastProgress.store (progress);
-                {
-                    std::lock_guard<std::mutex> messageLock (capturedInfo->messageMutex);
-                    capturedInfo->lastMessage = message;
-                }
-                capturedInfo->hasUpdate.store (true);
-            });
+    return id;
+}
+
+void JobQueue::runJob (const std::shared_ptr<JobInfo>& info, bool onBackgroundThread)
+{
+    {
+        const std::lock_guard<std::mutex> lock (info->threadMutex);
+        if (info->claimed)
+            return;
 
-        JobStatus finalStatus = JobStatus::Completed;
+        info->claimed = true;
 
-        try
+        if (onBackgroundThread)
         {
-            capturedFn (reporter);
+            info->backgroundThread = juce::Thread::getCurrentThread();
 
-            if (capturedInfo->cancelFlag.load())
-                finalStatus = JobStatus::Cancelled;
+            if (info->promoted && info->backgroundThread != nullptr)
+                info->backgroundThread->setPriority (juce::Thread::Priority::normal);
         }
-        catch (const std::exception& e)
-        {
-            std::lock_guard<std::mutex> messageLock (capturedInfo->messageMutex);
-            capturedInfo->lastMessage = e.what();
-            finalStatus = JobStatus::Failed;
-        }
-        catch (...)
+    }
+
+    info->status.store (static_cast<int> (JobStatus::Running));
+    info->hasUpdate.store (true);
+
+    ProgressReporter reporter (
+        info->id,
+        info->cancelFlag,
+        [info] (int, float progress, const juce::String& message)
         {
-            std::lock_guard<std::mutex> messageLock (capturedInfo->messageMutex);
-            capturedInfo->lastMessage = "Unknown exception";
-            finalStatus = JobStatus::Failed;
-        }
+            info->lastProgress.store (progress);
+            {
+                std::lock_guard<std::mutex> messageLock (info->messageMutex);
+                info->lastMessage = message;
+            }
+            info->hasUpdate.store (true);
+        });
 
-        capturedInfo->status.store (static_cast<int> (finalStatus));
-        capturedInfo->lastProgress.store (finalStatus == JobStatus::Completed ? 1.0f
-                                                                              : capturedInfo->lastProgress.load());
-        capturedInfo->hasUpdate.store (true);
-    });
+    JobStatus finalStatus = JobStatus::Completed;
 
-    return id;
+    try
+    {
+        info->function (reporter);
+
+        if (info->cancelFlag.load())
+            finalStatus = JobStatus::Cancelled;
+    }
+    catch (const std::exception& e)
+    {
+        std::lock_guard<std::mutex> messageLock (info->messageMutex);
+        info->lastMessage = e.what();
+        finalStatus = JobStatus::Failed;
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> messageLock (info->messageMutex);
+        info->lastMessage = "Unknown exception";
+        finalStatus = JobStatus::Failed;
+    }
+
+    {
+        // The background thread goes back to its own priority for the next job.
+        const std::lock_guard<std::mutex> lock (info->threadMutex);
+        if (info->promoted && info->backgroundThread != nullptr)
+            info->backgroundThread->setPriority (juce::Thread::Priority::background);
+
+        info->backgroundThread = nullptr;
+    }
+
+    info->status.store (static_cast<int> (finalStatus));
+    info->lastProgress.store (finalStatus == JobStatus::Completed ? 1.0f
+                                                                  : info->lastProgress.load());
+    info->hasUpdate.store (true);
+}
+
+void JobQueue::promoteJob (int jobId)
+{
+    std::shared_ptr<JobInfo> info;
+
+    {
+        std::lock_guard<std::mutex> lock (jobsMutex);
+        auto it = jobs.find (jobId);
+        if (it == jobs.end())
+            return;
+
+        info = it->second;
+    }
+
+    const std::lock_guard<std::mutex> lock (info->threadMutex);
+    if (info->promoted || info->descriptor.priority != JobPriority::background)
+        return;
+
+    info->promoted = true;
+
+    if (! info->claimed)
+        threadPool.addJob ([this, info] { runJob (info, false); });
+    else if (info->backgroundThread != nullptr)
+        info->backgroundThread->setPriority (juce::Thread::Priority::normal);
 }
 
 void JobQueue::cancelJob (int jobId)
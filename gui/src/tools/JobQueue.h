@@ -10,10 +10,17 @@ namespace waive
 {
 
 //==============================================================================
+enum class JobPriority
+{
+    normal,
+    background     // speculative work; must never hold up a job the user asked for
+};
+
 struct JobDescriptor
 {
     juce::String name;
     juce::String category;
+    JobPriority priority = JobPriority::normal;
 };
 
 enum class JobStatus
@@ -52,7 +59,19 @@ private:
 };
 
 //==============================================================================
-/** App-wide background job system wrapping juce::ThreadPool. */
+/** Calls work (i) for every i in [0, count) on up to one thread per core and
+    returns once all calls have finished. The calling job thread only reports
+    "<verb> x / count" progress. On a background-priority thread the items run
+    one by one on the calling thread instead. No new items start once the job is cancelled.
+    An exception thrown by work is rethrown here after the workers have
+    stopped. */
+void runInParallel (ProgressReporter& reporter, int count, const std::function<void (int)>& work,
+                    const juce::String& verb = "Analysed");
+
+//==============================================================================
+/** App-wide background job system wrapping juce::ThreadPool. Background
+    priority jobs run one at a time on their own low-priority thread, so they
+    never take a worker from, or queue ahead of, normal jobs. */
 class JobQueue : private juce::Timer
 {
 public:
@@ -67,6 +86,12 @@ public:
                 CompletionCallback onComplete = nullptr);
 
     void cancelJob (int jobId);
+
+    /** Raises a background job to normal priority once the user is waiting on
+        it. A queued job is offered to the normal workers as well, and runs on
+        whichever picks it up first; a running one has its thread raised. */
+    void promoteJob (int jobId);
+
     bool waitForJobToFinish (int jobId, int timeoutMs = 5000);
     void cancelAll();
 
@@ -96,9 +121,19 @@ private:
         std::atomic<bool> hasUpdate { false };
         std::atomic<int> status { static_cast<int> (JobStatus::Pending) };
         CompletionCallback onComplete;
+        JobFunction function;
+
+        // Guards the claim, so a promoted job queued in both pools runs once.
+        std::mutex threadMutex;
+        bool claimed = false;
+        bool promoted = false;
+        juce::Thread* backgroundThread = nullptr;
     };
 
+    void runJob (const std::shared_ptr<JobInfo>& info, bool onBackgroundThread);
+
     juce::ThreadPool threadPool;
+    juce::ThreadPool backgroundPool;
     std::mutex jobsMutex;
     std::unordered_map<int, std::shared_ptr<JobInfo>> jobs;
     int64_t nextJobId = 1;
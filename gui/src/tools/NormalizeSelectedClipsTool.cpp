@@ -1,8 +1,11 @@
 #include "NormalizeSelectedClipsTool.h"
 
 #include <algorithm>
+#include <vector>
 #include <tracktion_engine/tracktion_engine.h>
 
+#include "AudioAnalysis.h"
+#include "AudioAnalysisCache.h"
 #include "ClipTrackIndexMap.h"
 #include "EditSession.h"
 #include "PathSanitizer.h"
@@ -11,6 +14,8 @@
 #include "TimelineComponent.h"
 #include "SelectionManager.h"
 #include "JobQueue.h"
+#include "LoudnessMeter.h"
+#include "ToolAnalysisStore.h"
 #include "ToolDiff.h"
 
 namespace te = tracktion;
@@ -22,10 +27,37 @@ struct ClipPlanInput
     te::EditItemID clipID;
     juce::String clipName;
     juce::File sourceFile;
+    waive::AudioAnalysisRange analysisRange;
     int trackIndex = -1;
     float currentGainDb = 0.0f;
 };
 
+enum class NormalizeMode
+{
+    peak,
+    rms,
+    lufs
+};
+
+// Only the level fields of the summary are used; the gate settings just need
+// to be the same on every plan so re-planning hits the cache.
+constexpr float analysisActivityGain = 0.001f;
+constexpr float analysisTransientRiseGain = 0.01f;
+
+NormalizeMode parseMode (const juce::var& params)
+{
+    if (auto* paramsObj = params.getDynamicObject())
+    {
+        const auto mode = paramsObj->getProperty ("mode").toString();
+        if (mode == "rms")
+            return NormalizeMode::rms;
+        if (mode == "lufs")
+            return NormalizeMode::lufs;
+    }
+
+    return NormalizeMode::peak;
+}
+
 double parseTargetPeakDb (const juce::var& params)
 {
     double targetPeakDb = -1.0;
@@ -52,41 +84,30 @@ int parseAnalysisDelayMs (const juce::var& params)
     return delayMs;
 }
 
-float analysePeakGain (const juce::File& sourceFile)
+double parseTargetRmsDb (const juce::var& params)
 {
-    if (! sourceFile.existsAsFile())
-        return 0.0f;
-
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-
-    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (sourceFile));
-    if (reader == nullptr || reader->numChannels <= 0)
-        return 0.0f;
+    double targetRmsDb = -18.0;
 
-    constexpr int blockSize = 8192;
-    juce::AudioBuffer<float> buffer ((int) reader->numChannels, blockSize);
-
-    float peak = 0.0f;
-    int64 samplePos = 0;
-    const auto totalSamples = reader->lengthInSamples;
-
-    while (samplePos < totalSamples)
+    if (auto* paramsObj = params.getDynamicObject())
     {
-        const auto samplesThisBlock = (int) std::min<int64> ((int64) blockSize, totalSamples - samplePos);
-        if (samplesThisBlock <= 0)
-            break;
+        if (paramsObj->hasProperty ("target_rms_db"))
+            targetRmsDb = (double) paramsObj->getProperty ("target_rms_db");
+    }
 
-        if (! reader->read (&buffer, 0, samplesThisBlock, samplePos, true, true))
-            break;
+    return juce::jlimit (-40.0, 0.0, targetRmsDb);
+}
 
-        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-            peak = juce::jmax (peak, buffer.getMagnitude (ch, 0, samplesThisBlock));
+double parseTargetLufs (const juce::var& params)
+{
+    double targetLufs = -14.0;
 
-        samplePos += samplesThisBlock;
+    if (auto* paramsObj = params.getDynamicObject())
+    {
+        if (paramsObj->hasProperty ("target_lufs"))
+            targetLufs = (double) paramsObj->getProperty ("target_lufs");
     }
 
-    return peak;
+    return juce::jlimit (-40.0, 0.0, targetLufs);
 }
 
 void sleepWithCancellation (waive::ProgressReporter& reporter, int delayMs)
@@ -107,19 +128,32 @@ void sleepWithCancellation (waive::ProgressReporter& reporter, int delayMs)
 namespace waive
 {
 
+NormalizeSelectedClipsTool::NormalizeSelectedClipsTool()
+    : cache (std::make_shared<AudioAnalysisCache> (128))
+{
+}
+
 ToolDescription NormalizeSelectedClipsTool::describe() const
 {
     ToolDescription desc;
     desc.name = "normalize_selected_clips";
     desc.displayName = "Normalize Selected Clips";
-    desc.version = "1.0.0";
-    desc.description = "Analyse selected audio clips and adjust clip gain to a target peak dB.";
+    desc.version = "1.1.0";
+    desc.description = "Analyse selected audio clips and adjust clip gain to a target peak, RMS or integrated loudness.";
+    desc.speculativePlanning = true;
 
     auto* schemaObj = new juce::DynamicObject();
     schemaObj->setProperty ("type", "object");
 
     auto* propsObj = new juce::DynamicObject();
 
+    auto* modeObj = new juce::DynamicObject();
+    modeObj->setProperty ("type", "string");
+    modeObj->setProperty ("enum", juce::Array<juce::var> { "peak", "rms", "lufs" });
+    modeObj->setProperty ("default", "peak");
+    modeObj->setProperty ("description", "Match sample peak, RMS level or integrated loudness (EBU R128). RMS and LUFS gains never push the peak over 0 dBFS.");
+    propsObj->setProperty ("mode", juce::var (modeObj));
+
     auto* targetObj = new juce::DynamicObject();
     targetObj->setProperty ("type", "number");
     targetObj->setProperty ("minimum", -24.0);
@@ -128,6 +162,22 @@ ToolDescription NormalizeSelectedClipsTool::describe() const
     targetObj->setProperty ("description", "Target peak level in dBFS");
     propsObj->setProperty ("target_peak_db", juce::var (targetObj));
 
+    auto* targetRmsObj = new juce::DynamicObject();
+    targetRmsObj->setProperty ("type", "number");
+    targetRmsObj->setProperty ("minimum", -40.0);
+    targetRmsObj->setProperty ("maximum", 0.0);
+    targetRmsObj->setProperty ("default", -18.0);
+    targetRmsObj->setProperty ("description", "Target RMS level in dBFS (rms mode)");
+    propsObj->setProperty ("target_rms_db", juce::var (targetRmsObj));
+
+    auto* targetLufsObj = new juce::DynamicObject();
+    targetLufsObj->setProperty ("type", "number");
+    targetLufsObj->setProperty ("minimum", -40.0);
+    targetLufsObj->setProperty ("maximum", 0.0);
+    targetLufsObj->setProperty ("default", -14.0);
+    targetLufsObj->setProperty ("description", "Target integrated loudness in LUFS (lufs mode)");
+    propsObj->setProperty ("target_lufs", juce::var (targetLufsObj));
+
     auto* delayObj = new juce::DynamicObject();
     delayObj->setProperty ("type", "integer");
     delayObj->setProperty ("minimum", 0);
@@ -139,7 +189,10 @@ ToolDescription NormalizeSelectedClipsTool::describe() const
     desc.inputSchema = juce::var (schemaObj);
 
     auto* defaults = new juce::DynamicObject();
+    defaults->setProperty ("mode", "peak");
     defaults->setProperty ("target_peak_db", -1.0);
+    defaults->setProperty ("target_rms_db", -18.0);
+    defaults->setProperty ("target_lufs", -14.0);
     defaults->setProperty ("analysis_delay_ms", 0);
     desc.defaultParams = juce::var (defaults);
 
@@ -182,6 +235,7 @@ juce::Result NormalizeSelectedClipsTool::preparePlan (const ToolExecutionContext
         input.clipID = clip->itemID;
         input.clipName = clip->getName();
         input.sourceFile = sourceFile;
+        input.analysisRange = waive::AudioAnalysisRange::forClip (*waveClip);
         input.trackIndex = found->second;
         input.currentGainDb = audioClip->getGainDB();
 
@@ -191,14 +245,26 @@ juce::Result NormalizeSelectedClipsTool::preparePlan (const ToolExecutionContext
     if (clipsToProcess.empty())
         return juce::Result::fail ("Selected clips are not analysable audio clips");
 
+    const auto mode = parseMode (params);
     const auto targetPeakDb = parseTargetPeakDb (params);
+    const auto targetLevelDb = mode == NormalizeMode::rms  ? parseTargetRmsDb (params)
+                             : mode == NormalizeMode::lufs ? parseTargetLufs (params)
+                                                           : targetPeakDb;
     const auto analysisDelayMs = parseAnalysisDelayMs (params);
     const auto cacheDirectory = context.projectCacheDirectory;
     const auto description = describe();
+    const auto analysisCache = cache;
+    const auto analysisStore = ToolAnalysisStore::forProject (cacheDirectory);
+
+    // Only loudness changes what is measured; the targets just shape the plan.
+    auto* analysisParamsObj = new juce::DynamicObject();
+    analysisParamsObj->setProperty ("measure_loudness", mode == NormalizeMode::lufs);
+    const juce::var analysisParams (analysisParamsObj);
 
     outTask.jobName = "Plan: " + description.displayName;
     outTask.run = [clipsToProcess = std::move (clipsToProcess),
-                   targetPeakDb, analysisDelayMs, cacheDirectory, params, description] (ProgressReporter& reporter)
+                   mode, targetLevelDb, analysisDelayMs, params, description,
+                   analysisCache, analysisStore, analysisParams] (ProgressReporter& reporter)
     {
         ToolPlan plan;
         plan.toolName = description.name;
@@ -207,29 +273,73 @@ juce::Result NormalizeSelectedClipsTool::preparePlan (const ToolExecutionContext
         plan.inputParams = params;
 
         const int total = (int) clipsToProcess.size();
+        std::vector<AudioAnalysisSummary> summaries ((size_t) total);
 
-        for (int i = 0; i < total; ++i)
+        // One read per clip gives peak and RMS, plus loudness when asked for.
+        // The project's analysis store makes re-planning with another target
+        // free, in this session and the next.
+        runInParallel (reporter, total, [&] (int i)
         {
-            if (reporter.isCancelled())
-                return plan;
-
             const auto& clipInput = clipsToProcess[(size_t) i];
             sleepWithCancellation (reporter, analysisDelayMs);
 
             if (reporter.isCancelled())
-                return plan;
+                return;
 
-            const auto peakGain = analysePeakGain (clipInput.sourceFile);
-            if (peakGain <= 0.0f)
+            const auto analyse = [&]
             {
-                reporter.setProgress ((float) (i + 1) / (float) total,
-                                      "Skipped silent clip: " + clipInput.clipName);
+                return analyseAudioFile (clipInput.sourceFile, clipInput.analysisRange,
+                                         analysisActivityGain, analysisTransientRiseGain,
+                                         [&reporter]() { return reporter.isCancelled(); },
+                                         analysisCache.get(),
+                                         mode == NormalizeMode::lufs);
+            };
+
+            summaries[(size_t) i] = analysisStore != nullptr
+                ? analysisStore->getOrAnalyse (ToolAnalysisStore::makeKey (description, analysisParams,
+                                                                           clipInput.sourceFile,
+                                                                           clipInput.analysisRange),
+                                               analyse)
+                : analyse();
+        });
+
+        if (reporter.isCancelled())
+            return plan;
+
+        int skippedCount = 0;
+        for (int i = 0; i < total; ++i)
+        {
+            const auto& clipInput = clipsToProcess[(size_t) i];
+            const auto& summary = summaries[(size_t) i];
+
+            if (! summary.valid || summary.peakGain <= 0.0f
+                || (mode == NormalizeMode::lufs && summary.integratedLufs <= LoudnessMeter::floorDb))
+            {
+                ++skippedCount;
                 continue;
             }
 
-            const auto sourcePeakDb = juce::Decibels::gainToDecibels (peakGain, -120.0f);
-            const auto gainDeltaDb = targetPeakDb - sourcePeakDb;
-            const auto newGainDb = juce::jlimit (-60.0f, 24.0f, clipInput.currentGainDb + (float) gainDeltaDb);
+            const auto sourcePeakDb = (double) juce::Decibels::gainToDecibels (summary.peakGain, -120.0f);
+            const auto sourceLevelDb = mode == NormalizeMode::rms  ? (double) juce::Decibels::gainToDecibels (summary.rmsGain, -120.0f)
+                                     : mode == NormalizeMode::lufs ? summary.integratedLufs
+                                                                   : sourcePeakDb;
+
+            // The levels are measured on the source file, so RMS and LUFS
+            // targets set the clip gain outright; normalising twice gives
+            // the same gain as normalising once.
+            auto gainDb = mode == NormalizeMode::peak ? clipInput.currentGainDb + (targetLevelDb - sourceLevelDb)
+                                                      : targetLevelDb - sourceLevelDb;
+
+            // Level-matching a dynamic clip can ask for more gain than its
+            // peaks allow; stop at full scale rather than clip.
+            bool peakLimited = false;
+            if (mode != NormalizeMode::peak && sourcePeakDb + gainDb > 0.0)
+            {
+                gainDb = -sourcePeakDb;
+                peakLimited = true;
+            }
+
+            const auto newGainDb = juce::jlimit (-60.0f, 24.0f, (float) gainDb);
 
             ToolDiffEntry change;
             change.kind = ToolDiffKind::parameterChanged;
@@ -241,35 +351,44 @@ juce::Result NormalizeSelectedClipsTool::preparePlan (const ToolExecutionContext
             change.afterValue = newGainDb;
             change.summary = "Set clip '" + clipInput.clipName + "' gain "
                              + juce::String (clipInput.currentGainDb, 2) + " dB -> "
-                             + juce::String (newGainDb, 2) + " dB";
+                             + juce::String (newGainDb, 2) + " dB"
+                             + (peakLimited ? " (peak-limited)" : "");
 
             plan.changes.add (change);
-
-            reporter.setProgress ((float) (i + 1) / (float) total,
-                                  "Analysed " + juce::String (i + 1) + " / " + juce::String (total));
         }
 
-        plan.summary = "Normalize " + juce::String (plan.changes.size())
-                       + " clip(s) to target peak " + juce::String (targetPeakDb, 1) + " dBFS";
+        const auto targetText = mode == NormalizeMode::rms  ? "target RMS " + juce::String (targetLevelDb, 1) + " dBFS"
+                              : mode == NormalizeMode::lufs ? "target loudness " + juce::String (targetLevelDb, 1) + " LUFS"
+                                                            : "target peak " + juce::String (targetLevelDb, 1) + " dBFS";
 
-        if (cacheDirectory != juce::File())
-        {
-            auto sanitizedToolName = PathSanitizer::sanitizePathComponent (description.name);
-            auto sanitizedPlanID = PathSanitizer::sanitizePathComponent (plan.planID);
-            if (sanitizedToolName.isNotEmpty() && sanitizedPlanID.isNotEmpty())
-            {
-                auto artifactDir = cacheDirectory.getChildFile ("tools").getChildFile (sanitizedToolName);
-                artifactDir.createDirectory();
-
-                auto artifact = artifactDir.getChildFile ("plan_" + sanitizedPlanID + ".json");
-                artifact.replaceWithText (juce::JSON::toString (toolPlanToJson (plan), true));
-                plan.artifactFile = artifact;
-            }
-        }
+        plan.summary = "Normalize " + juce::String (plan.changes.size()) + " clip(s) to " + targetText;
+        if (skippedCount > 0)
+            plan.summary << " (" << skippedCount << " silent clip(s) skipped)";
 
         return plan;
     };
 
+    outTask.writeArtifact = [cacheDirectory, toolName = description.name, analysisStore] (ToolPlan& plan)
+    {
+        if (analysisStore != nullptr)
+            analysisStore->save();
+
+        if (cacheDirectory == juce::File())
+            return;
+
+        auto sanitizedToolName = PathSanitizer::sanitizePathComponent (toolName);
+        auto sanitizedPlanID = PathSanitizer::sanitizePathComponent (plan.planID);
+        if (sanitizedToolName.isEmpty() || sanitizedPlanID.isEmpty())
+            return;
+
+        auto artifactDir = cacheDirectory.getChildFile ("tools").getChildFile (sanitizedToolName);
+        artifactDir.createDirectory();
+
+        auto artifact = artifactDir.getChildFile ("plan_" + sanitizedPlanID + ".json");
+        artifact.replaceWithText (juce::JSON::toString (toolPlanToJson (plan), true));
+        plan.artifactFile = artifact;
+    };
+
     return juce::Result::ok();
 }
 
@@ -283,15 +402,17 @@ juce::Result NormalizeSelectedClipsTool::apply (const ToolExecutionContext& cont
         return juce::Result::fail ("Tool plan has no changes to apply");
 
     int appliedCount = 0;
-    const auto ok = context.editSession.performEdit ("Normalize Selected Clips", [&] (te::Edit& edit)
+    const auto ok = context.editSession.performBulkEdit ("Normalize Selected Clips", [&] (te::Edit& edit)
     {
+        const auto clipsByID = waive::buildClipLookup (edit);
+
         for (const auto& change : plan.changes)
         {
             if (change.kind != ToolDiffKind::parameterChanged || change.parameterID != "clip.gain_db")
                 continue;
 
-            auto* clip = te::findClipForID (edit, change.clipID);
-            auto* audioClip = dynamic_cast<te::AudioClipBase*> (clip);
+            const auto found = clipsByID.find (change.clipID);
+            auto* audioClip = found != clipsByID.end() ? dynamic_cast<te::AudioClipBase*> (found->second) : nullptr;
             if (audioClip == nullptr)
                 continue;
 
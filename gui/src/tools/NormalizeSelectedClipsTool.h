@@ -1,19 +1,32 @@
 #pragma once
 
+#include <memory>
+
 #include "Tool.h"
 
 namespace waive
 {
 
+class AudioAnalysisCache;
+
+/** Sets the gain of each selected clip so its peak, RMS or integrated
+    loudness meets a target. Clips are analysed in parallel over only the
+    range they play, and the results are kept in the tool's analysis cache. */
 class NormalizeSelectedClipsTool : public Tool
 {
 public:
+    NormalizeSelectedClipsTool();
+
     ToolDescription describe() const override;
     juce::Result preparePlan (const ToolExecutionContext& context,
                               const juce::var& params,
                               ToolPlanTask& outTask) override;
     juce::Result apply (const ToolExecutionContext& context,
                         const ToolPlan& plan) override;
+
+private:
+    // Shared with running plan jobs, which may outlive a single call.
+    std::shared_ptr<AudioAnalysisCache> cache;
 };
 
 } // namespace waive
@@ -0,0 +1,441 @@
+#include "SpectralSeparation.h"
+#include "AudioFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace waive
+{
+
+namespace
+{
+constexpr int readBlockSize = 65536;
+
+using StemBuffers = std::array<std::vector<float>, 2>;
+
+/** Streaming STFT masker for one channel. Samples go in block by block and
+    both stems come out in step. The analysis delay is trimmed, so output
+    sample i lines up with input sample i. */
+class ChannelSeparator
+{
+public:
+    ChannelSeparator (const SeparationSettings& s, double sampleRate)
+        : settings (s),
+          fft (juce::jlimit (8, 14, s.fftOrder)),
+          frameSize (fft.getSize()),
+          hopSize (frameSize / 4),
+          numBins (frameSize / 2 + 1),
+          lookahead (s.method == SeparationMethod::harmonicPercussive ? juce::jmax (1, s.medianLength) / 2 : 0),
+          window (getSharedHannWindow (frameSize)),
+          // Leading zeros put the first input sample under full window overlap.
+          stft (juce::jlimit (8, 14, s.fftOrder), hopSize, frameSize - hopSize)
+    {
+        fftBuffer.assign ((size_t) frameSize * 2, 0.0f);
+
+        // Hann analysis and synthesis windows at 75% overlap sum to 1.5. The
+        // transform's own round-trip scale is measured rather than assumed.
+        fftBuffer[0] = 1.0f;
+        fft.performRealOnlyForwardTransform (fftBuffer.data());
+        fft.performRealOnlyInverseTransform (fftBuffer.data());
+        outputScale = (fftBuffer[0] != 0.0f ? 1.0f / fftBuffer[0] : 1.0f) / 1.5f;
+
+        if (settings.method == SeparationMethod::bandSplit)
+        {
+            // Complementary fourth-order split: the two masks always sum to one.
+            bandMask.resize ((size_t) numBins);
+            const auto crossover = juce::jmax (1.0, settings.crossoverHz);
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                const auto ratio = (double) bin * sampleRate / (double) frameSize / crossover;
+                bandMask[(size_t) bin] = (float) (1.0 / (1.0 + std::pow (ratio, 4.0)));
+            }
+        }
+
+        samplesToSkip = frameSize - hopSize;
+
+        for (auto& accumulator : accumulators)
+            accumulator.assign ((size_t) frameSize, 0.0f);
+
+        // The history never holds more than the median window, so its frames
+        // are allocated once and reused.
+        history.resize ((size_t) (2 * lookahead + 1));
+        for (auto& frame : history)
+        {
+            frame.bins.resize ((size_t) numBins);
+            frame.magnitudes.resize ((size_t) numBins);
+        }
+
+        timeScratch.reserve (history.size());
+        frequencyScratch.reserve (history.size());
+        masks.resize ((size_t) numBins);
+    }
+
+    void process (const float* input, int numSamples, StemBuffers& output)
+    {
+        totalInputSamples += numSamples;
+        stft.push (input, numSamples, [&] (const float*, const std::complex<float>* bins) { addFrame (bins, output); });
+    }
+
+    /** Flushes the frames still waiting on later input. */
+    void finish (StemBuffers& output)
+    {
+        stft.pushSilence (frameSize + lookahead * hopSize,
+                          [&] (const float*, const std::complex<float>* bins) { addFrame (bins, output); });
+    }
+
+private:
+    struct Frame
+    {
+        std::vector<std::complex<float>> bins;
+        std::vector<float> magnitudes;
+    };
+
+    /** The index-th oldest frame in the history. */
+    Frame& getFrame (int index)
+    {
+        return history[(size_t) ((oldestFrame + index) % (int) history.size())];
+    }
+
+    void addFrame (const std::complex<float>* bins, StemBuffers& output)
+    {
+        auto& frame = getFrame (numFrames++);
+        std::copy (bins, bins + numBins, frame.bins.begin());
+        for (int bin = 0; bin < numBins; ++bin)
+            frame.magnitudes[(size_t) bin] = std::abs (bins[bin]);
+
+        if (numFrames > lookahead)
+            synthesiseFrame (numFrames - 1 - lookahead, output);
+
+        if (numFrames > 2 * lookahead)
+        {
+            oldestFrame = (oldestFrame + 1) % (int) history.size();
+            --numFrames;
+        }
+    }
+
+    static float median (std::vector<float>& values)
+    {
+        const auto middle = values.begin() + (std::ptrdiff_t) (values.size() / 2);
+        std::nth_element (values.begin(), middle, values.end());
+        return *middle;
+    }
+
+    /** Fills masks with the first stem's share of each bin of the frame. */
+    void computeMasks (int frameIndex)
+    {
+        if (settings.method == SeparationMethod::bandSplit)
+        {
+            masks = bandMask;
+            return;
+        }
+
+        const auto& centre = getFrame (frameIndex).magnitudes;
+        const auto power = juce::jmax (0.1f, settings.maskPower);
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            // Sustained tones are smooth across time, hits are smooth across frequency.
+            timeScratch.clear();
+            for (int frame = 0; frame < numFrames; ++frame)
+                timeScratch.push_back (getFrame (frame).magnitudes[(size_t) bin]);
+
+            frequencyScratch.clear();
+            for (int other = juce::jmax (0, bin - lookahead); other <= juce::jmin (numBins - 1, bin + lookahead); ++other)
+                frequencyScratch.push_back (centre[(size_t) other]);
+
+            const auto harmonic = std::pow (median (timeScratch), power);
+            const auto percussive = std::pow (median (frequencyScratch), power);
+            const auto total = harmonic + percussive;
+            masks[(size_t) bin] = total > 1.0e-20f ? harmonic / total : 0.5f;
+        }
+    }
+
+    void synthesiseFrame (int frameIndex, StemBuffers& output)
+    {
+        computeMasks (frameIndex);
+        const auto& bins = getFrame (frameIndex).bins;
+
+        for (size_t stem = 0; stem < 2; ++stem)
+        {
+            auto* spectrum = reinterpret_cast<std::complex<float>*> (fftBuffer.data());
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                const auto mask = stem == 0 ? masks[(size_t) bin] : 1.0f - masks[(size_t) bin];
+                spectrum[bin] = bins[(size_t) bin] * mask;
+            }
+
+            for (int bin = numBins; bin < frameSize; ++bin)
+                spectrum[bin] = std::conj (spectrum[frameSize - bin]);
+
+            fft.performRealOnlyInverseTransform (fftBuffer.data());
+
+            auto& accumulator = accumulators[stem];
+            for (int i = 0; i < frameSize; ++i)
+                accumulator[(size_t) i] += fftBuffer[(size_t) i] * window[(size_t) i] * outputScale;
+        }
+
+        // The first hop is now complete: no later frame reaches back that far.
+        const auto skip = juce::jmin (samplesToSkip, hopSize);
+        samplesToSkip -= skip;
+        const auto available = juce::jmin ((int64) (hopSize - skip), totalInputSamples - emittedSamples);
+
+        for (size_t stem = 0; stem < 2; ++stem)
+        {
+            auto& accumulator = accumulators[stem];
+            if (available > 0)
+                output[stem].insert (output[stem].end(),
+                                     accumulator.begin() + skip,
+                                     accumulator.begin() + skip + (std::ptrdiff_t) available);
+
+            std::move (accumulator.begin() + hopSize, accumulator.end(), accumulator.begin());
+            std::fill (accumulator.end() - hopSize, accumulator.end(), 0.0f);
+        }
+
+        emittedSamples += juce::jmax ((int64) 0, available);
+    }
+
+    const SeparationSettings settings;
+    const juce::dsp::FFT fft; // own plan: each channel runs on its own worker thread
+    const int frameSize;
+    const int hopSize;
+    const int numBins;
+    const int lookahead;
+    const std::vector<float>& window;
+    StreamingStft stft;
+
+    std::vector<float> fftBuffer;
+    std::vector<float> bandMask;
+    std::vector<float> masks;
+    std::vector<float> timeScratch;
+    std::vector<float> frequencyScratch;
+    float outputScale = 1.0f;
+
+    std::vector<Frame> history;         // ring of the frames the median window spans
+    int oldestFrame = 0;
+    int numFrames = 0;
+    std::array<std::vector<float>, 2> accumulators;
+    int samplesToSkip = 0;
+    int64 totalInputSamples = 0;
+    int64 emittedSamples = 0;
+};
+
+/** Threads that stay up for a whole separation and run one task per channel
+    on request, so a block costs a wake-up per channel rather than a thread
+    start. Channel 0 runs on the calling thread. */
+class ChannelWorkers
+{
+public:
+    explicit ChannelWorkers (int numChannels)
+    {
+        for (int ch = 1; ch < numChannels; ++ch)
+            threads.emplace_back ([this, ch] { runWorker (ch); });
+    }
+
+    ~ChannelWorkers()
+    {
+        {
+            const std::lock_guard<std::mutex> lock (mutex);
+            stopping = true;
+        }
+
+        taskStarted.notify_all();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    /** Calls task (ch) for every channel and returns once all have finished. */
+    void run (const std::function<void (int)>& task)
+    {
+        {
+            const std::lock_guard<std::mutex> lock (mutex);
+            currentTask = &task;
+            numRunning = threads.size();
+            ++generation;
+        }
+
+        taskStarted.notify_all();
+        task (0);
+
+        std::unique_lock<std::mutex> lock (mutex);
+        taskFinished.wait (lock, [this] { return numRunning == 0; });
+        currentTask = nullptr;
+    }
+
+private:
+    void runWorker (int ch)
+    {
+        juce::uint64 lastGeneration = 0;
+
+        for (;;)
+        {
+            const std::function<void (int)>* task = nullptr;
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                taskStarted.wait (lock, [&] { return stopping || generation != lastGeneration; });
+                if (stopping)
+                    return;
+
+                lastGeneration = generation;
+                task = currentTask;
+            }
+
+            (*task) (ch);
+
+            {
+                const std::lock_guard<std::mutex> lock (mutex);
+                --numRunning;
+            }
+
+            taskFinished.notify_one();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable taskStarted;
+    std::condition_variable taskFinished;
+    const std::function<void (int)>* currentTask = nullptr;
+    juce::uint64 generation = 0;
+    size_t numRunning = 0;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+};
+
+std::unique_ptr<juce::AudioFormatWriter> createFloatWavWriter (const juce::File& file, double sampleRate, int numChannels)
+{
+    std::unique_ptr<juce::OutputStream> stream (file.createOutputStream());
+    if (stream == nullptr)
+        return nullptr;
+
+    auto options = juce::AudioFormatWriterOptions()
+                       .withSampleRate (sampleRate)
+                       .withNumChannels (numChannels)
+                       .withBitsPerSample (32);
+
+    return juce::WavAudioFormat().createWriterFor (stream, options);
+}
+}
+
+std::array<juce::String, 2> getStemNames (SeparationMethod method)
+{
+    if (method == SeparationMethod::harmonicPercussive)
+        return { "harmonic", "percussive" };
+
+    return { "low", "high" };
+}
+
+juce::Result separateStems (const juce::File& sourceFile,
+                            const AudioAnalysisRange& range,
+                            const std::array<juce::File, 2>& stemFiles,
+                            const SeparationSettings& settings,
+                            const std::function<bool()>& shouldCancel)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (sourceFile));
+    if (reader == nullptr || reader->numChannels <= 0 || reader->lengthInSamples <= 0 || reader->sampleRate <= 0)
+        return juce::Result::fail ("Could not read " + sourceFile.getFileName());
+
+    const auto startSample = juce::jmin (reader->lengthInSamples,
+                                         (int64) std::llround (range.getSourceStartSeconds() * reader->sampleRate));
+    auto numSamples = reader->lengthInSamples - startSample;
+    if (range.getSourceLengthSeconds() >= 0.0)
+        numSamples = juce::jmin (numSamples, (int64) std::llround (range.getSourceLengthSeconds() * reader->sampleRate));
+
+    if (numSamples <= 0)
+        return juce::Result::fail ("Clip range is outside " + sourceFile.getFileName());
+
+    const auto numChannels = (int) reader->numChannels;
+    std::array<std::unique_ptr<juce::AudioFormatWriter>, 2> writers;
+
+    // A cancelled or failed separation leaves no half-written stems behind.
+    auto failWith = [&] (const juce::String& message)
+    {
+        for (size_t stem = 0; stem < 2; ++stem)
+        {
+            writers[stem].reset();
+            (void) stemFiles[stem].deleteFile();
+        }
+
+        return juce::Result::fail (message);
+    };
+
+    for (size_t stem = 0; stem < 2; ++stem)
+    {
+        writers[stem] = createFloatWavWriter (stemFiles[stem], reader->sampleRate, numChannels);
+        if (writers[stem] == nullptr)
+            return failWith ("Could not create " + stemFiles[stem].getFileName());
+    }
+
+    std::vector<std::unique_ptr<ChannelSeparator>> separators;
+    std::vector<StemBuffers> outputs ((size_t) numChannels);
+    for (int ch = 0; ch < numChannels; ++ch)
+        separators.push_back (std::make_unique<ChannelSeparator> (settings, reader->sampleRate));
+
+    // Every channel produces the same number of samples per call, so the
+    // stems can be written as soon as a block has been processed.
+    auto writeOutputs = [&]
+    {
+        const auto available = (int) outputs[0][0].size();
+        if (available == 0)
+            return true;
+
+        for (size_t stem = 0; stem < 2; ++stem)
+        {
+            std::vector<float*> channelPointers;
+            for (auto& channelOutputs : outputs)
+                channelPointers.push_back (channelOutputs[stem].data());
+
+            const juce::AudioBuffer<float> buffer (channelPointers.data(), numChannels, available);
+            if (! writers[stem]->writeFromAudioSampleBuffer (buffer, 0, available))
+                return false;
+        }
+
+        for (auto& channelOutputs : outputs)
+            for (auto& stemOutput : channelOutputs)
+                stemOutput.clear();
+
+        return true;
+    };
+
+    ChannelWorkers workers (numChannels);
+    juce::AudioBuffer<float> input (numChannels, (int) juce::jmin ((int64) readBlockSize, numSamples));
+    int numThisBlock = 0;
+
+    const std::function<void (int)> processBlock = [&] (int ch)
+    {
+        separators[(size_t) ch]->process (input.getReadPointer (ch), numThisBlock, outputs[(size_t) ch]);
+    };
+
+    for (int64 position = 0; position < numSamples;)
+    {
+        if (shouldCancel && shouldCancel())
+            return failWith ("Cancelled");
+
+        numThisBlock = (int) juce::jmin ((int64) input.getNumSamples(), numSamples - position);
+        if (! reader->read (&input, 0, numThisBlock, startSample + position, true, true))
+            return failWith ("Failed reading " + sourceFile.getFileName());
+
+        workers.run (processBlock);
+
+        if (! writeOutputs())
+            return failWith ("Failed writing stems");
+
+        position += numThisBlock;
+    }
+
+    workers.run ([&] (int ch) { separators[(size_t) ch]->finish (outputs[(size_t) ch]); });
+
+    if (! writeOutputs())
+        return failWith ("Failed writing stems");
+
+    return juce::Result::ok();
+}
+
+} // namespace waive
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <functional>
+
+#include "AudioAnalysis.h"
+
+namespace waive
+{
+
+/** How separateStems() splits audio into its two stems. */
+enum class SeparationMethod
+{
+    bandSplit,          // "low" and "high", either side of a crossover frequency
+    harmonicPercussive  // "harmonic" and "percussive", by median filtering the spectrogram (HPSS)
+};
+
+struct SeparationSettings
+{
+    SeparationMethod method = SeparationMethod::bandSplit;
+    int fftOrder = 11;           // 2048-point frames, hop of a quarter frame
+    double crossoverHz = 250.0;  // bandSplit only
+    int medianLength = 17;       // harmonicPercussive: frames across time, bins across frequency
+    float maskPower = 2.0f;      // harmonicPercussive: higher values give harder masks
+};
+
+/** The names of the two stems a method writes, in stemFiles order. */
+std::array<juce::String, 2> getStemNames (SeparationMethod method);
+
+/** Splits the part of sourceFile given by range into two stems, written as
+    32-bit float WAVs at the source rate and length.
+
+    Each channel runs through a streaming STFT: every frame is masked into the
+    two stems and overlap-added back. The masks sum to one, so the stems add
+    up to the source. Memory is bounded by one read block and a few frames
+    per channel, not the file length; the frames are allocated up front.
+    Channels are processed in parallel on threads that last for the whole
+    call. On failure or cancellation the stem files are deleted. */
+juce::Result separateStems (const juce::File& sourceFile,
+                            const AudioAnalysisRange& range,
+                            const std::array<juce::File, 2>& stemFiles,
+                            const SeparationSettings& settings,
+                            const std::function<bool()>& shouldCancel = {});
+
+} // namespace waive
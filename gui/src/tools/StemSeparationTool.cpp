@@ -12,6 +12,7 @@
 #include "ProjectManager.h"
 #include "SelectionManager.h"
 #include "SessionComponent.h"
+#include "SpectralSeparation.h"
 #include "TimelineComponent.h"
 
 namespace te = tracktion;
@@ -23,6 +24,7 @@ struct ClipPlanInput
     te::EditItemID clipID;
     juce::String clipName;
     juce::File sourceFile;
+    waive::AudioAnalysisRange sourceRange;
     int trackIndex = -1;
     double clipStartSeconds = 0.0;
     double clipEndSeconds = 0.0;
@@ -68,85 +70,26 @@ void sleepWithCancellation (waive::ProgressReporter& reporter, int delayMs)
     }
 }
 
-bool writeSeparatedStems (const juce::File& inputFile,
-                          const juce::File& lowStemFile,
-                          const juce::File& highStemFile,
-                          waive::ProgressReporter& reporter)
+waive::SeparationSettings parseSeparationSettings (const juce::var& params)
 {
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-
-    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (inputFile));
-    if (reader == nullptr || reader->numChannels <= 0 || reader->lengthInSamples <= 0)
-        return false;
-
-    juce::WavAudioFormat wavFormat;
-    std::unique_ptr<juce::OutputStream> lowStream (lowStemFile.createOutputStream());
-    std::unique_ptr<juce::OutputStream> highStream (highStemFile.createOutputStream());
-    if (lowStream == nullptr || highStream == nullptr)
-        return false;
-
-    auto lowOptions = juce::AudioFormatWriterOptions()
-                          .withSampleRate (reader->sampleRate)
-                          .withNumChannels ((int) reader->numChannels)
-                          .withBitsPerSample (16);
-
-    auto highOptions = juce::AudioFormatWriterOptions()
-                           .withSampleRate (reader->sampleRate)
-                           .withNumChannels ((int) reader->numChannels)
-                           .withBitsPerSample (16);
-
-    auto lowWriter = wavFormat.createWriterFor (lowStream, lowOptions);
-    auto highWriter = wavFormat.createWriterFor (highStream, highOptions);
-    if (lowWriter == nullptr || highWriter == nullptr)
-        return false;
-
-    constexpr int blockSize = 8192;
-    juce::AudioBuffer<float> input ((int) reader->numChannels, blockSize);
-    juce::AudioBuffer<float> low ((int) reader->numChannels, blockSize);
-    juce::AudioBuffer<float> high ((int) reader->numChannels, blockSize);
-
-    std::vector<float> lowState ((size_t) reader->numChannels, 0.0f);
-    constexpr float smoothing = 0.03f;
-
-    int64 samplePosition = 0;
-    while (samplePosition < reader->lengthInSamples)
-    {
-        if (reporter.isCancelled())
-            return false;
-
-        const auto samplesThisBlock = (int) std::min<int64> ((int64) blockSize,
-                                                             reader->lengthInSamples - samplePosition);
-        if (! reader->read (&input, 0, samplesThisBlock, samplePosition, true, true))
-            return false;
+    waive::SeparationSettings settings;
 
-        for (int channel = 0; channel < input.getNumChannels(); ++channel)
-        {
-            auto* inData = input.getWritePointer (channel);
-            auto* lowData = low.getWritePointer (channel);
-            auto* highData = high.getWritePointer (channel);
-
-            auto channelState = lowState[(size_t) channel];
-            for (int sample = 0; sample < samplesThisBlock; ++sample)
-            {
-                const auto x = inData[sample];
-                channelState += (x - channelState) * smoothing;
-                lowData[sample] = channelState;
-                highData[sample] = x - channelState;
-            }
-
-            lowState[(size_t) channel] = channelState;
-        }
-
-        if (! lowWriter->writeFromAudioSampleBuffer (low, 0, samplesThisBlock))
-            return false;
-        if (! highWriter->writeFromAudioSampleBuffer (high, 0, samplesThisBlock))
-            return false;
+    if (auto* paramsObj = params.getDynamicObject())
+    {
+        if (paramsObj->getProperty ("method").toString() == "hpss")
+            settings.method = waive::SeparationMethod::harmonicPercussive;
 
-        samplePosition += samplesThisBlock;
+        if (paramsObj->hasProperty ("crossover_hz"))
+            settings.crossoverHz = (double) paramsObj->getProperty ("crossover_hz");
     }
 
-    return true;
+    settings.crossoverHz = juce::jlimit (40.0, 2000.0, settings.crossoverHz);
+    return settings;
+}
+
+juce::String getStemTrackName (const juce::String& stemName)
+{
+    return "Stem " + stemName.substring (0, 1).toUpperCase() + stemName.substring (1);
 }
 
 void writePlanArtifact (const juce::File& cacheDirectory,
@@ -217,8 +160,10 @@ ToolDescription StemSeparationTool::describe() const
     ToolDescription desc;
     desc.name = "stem_separation";
     desc.displayName = "Stem Separation (Model)";
-    desc.version = "1.0.0";
-    desc.description = "Generate low/high stems from selected clips. Requires installed stem-separator model.";
+    desc.version = "1.1.0";
+    desc.description = "Split selected clips into low/high or harmonic/percussive stems with the built-in "
+                       "spectral engine, written as 32-bit float WAVs. The stem-separator model must be "
+                       "installed; its version is recorded with the plan.";
 
     auto* schemaObj = new juce::DynamicObject();
     schemaObj->setProperty ("type", "object");
@@ -231,6 +176,21 @@ ToolDescription StemSeparationTool::describe() const
     modelVersionObj->setProperty ("description", "Optional installed model version. Empty resolves pinned/latest.");
     propsObj->setProperty ("model_version", juce::var (modelVersionObj));
 
+    auto* methodObj = new juce::DynamicObject();
+    methodObj->setProperty ("type", "string");
+    methodObj->setProperty ("enum", juce::Array<juce::var> { "band_split", "hpss" });
+    methodObj->setProperty ("default", "band_split");
+    methodObj->setProperty ("description", "Split into low/high bands, or into harmonic/percussive stems by median filtering.");
+    propsObj->setProperty ("method", juce::var (methodObj));
+
+    auto* crossoverObj = new juce::DynamicObject();
+    crossoverObj->setProperty ("type", "number");
+    crossoverObj->setProperty ("minimum", 40.0);
+    crossoverObj->setProperty ("maximum", 2000.0);
+    crossoverObj->setProperty ("default", 250.0);
+    crossoverObj->setProperty ("description", "Crossover between the low and high stems in Hz (band_split only).");
+    propsObj->setProperty ("crossover_hz", juce::var (crossoverObj));
+
     auto* delayObj = new juce::DynamicObject();
     delayObj->setProperty ("type", "integer");
     delayObj->setProperty ("minimum", 0);
@@ -243,6 +203,8 @@ ToolDescription StemSeparationTool::describe() const
 
     auto* defaults = new juce::DynamicObject();
     defaults->setProperty ("model_version", "");
+    defaults->setProperty ("method", "band_split");
+    defaults->setProperty ("crossover_hz", 250.0);
     defaults->setProperty ("analysis_delay_ms", 0);
     desc.defaultParams = juce::var (defaults);
 
@@ -297,6 +259,11 @@ juce::Result StemSeparationTool::preparePlan (const ToolExecutionContext& contex
         input.clipStartSeconds = clip->getPosition().getStart().inSeconds();
         input.clipEndSeconds = clip->getPosition().getEnd().inSeconds();
 
+        // Stems are inserted unstretched, so only clips at normal speed can be
+        // cut down to the part of the source they play.
+        if (waveClip->getSpeedRatio() == 1.0)
+            input.sourceRange = AudioAnalysisRange::forClip (*waveClip);
+
         clipsToProcess.push_back (std::move (input));
     }
 
@@ -304,6 +271,7 @@ juce::Result StemSeparationTool::preparePlan (const ToolExecutionContext& contex
         return juce::Result::fail ("Selected clips are not analysable wave clips");
 
     const auto analysisDelayMs = parseAnalysisDelayMs (params);
+    const auto separationSettings = parseSeparationSettings (params);
     const auto cacheDirectory = context.projectCacheDirectory;
     const auto description = describe();
     const auto modelInfo = *resolvedModel;
@@ -311,6 +279,7 @@ juce::Result StemSeparationTool::preparePlan (const ToolExecutionContext& contex
     outTask.jobName = "Plan: " + description.displayName;
     outTask.run = [clipsToProcess = std::move (clipsToProcess),
                    analysisDelayMs,
+                   separationSettings,
                    cacheDirectory,
                    params,
                    description,
@@ -335,25 +304,53 @@ juce::Result StemSeparationTool::preparePlan (const ToolExecutionContext& contex
                                                      .getChildFile ("plan_" + plan.planID);
         planOutputDirectory.createDirectory();
 
-        bool emittedTrackAdds = false;
+        const auto stemNames = getStemNames (separationSettings.method);
         const int total = (int) clipsToProcess.size();
-        for (int i = 0; i < total; ++i)
-        {
-            if (reporter.isCancelled())
-                return plan;
 
+        // Clips are separated in parallel, and each separation also splits its
+        // channels across threads.
+        std::vector<std::array<juce::File, 2>> stemFiles ((size_t) total);
+        std::vector<char> separated ((size_t) total, 0);
+
+        runInParallel (reporter, total, [&] (int i)
+        {
             sleepWithCancellation (reporter, analysisDelayMs);
-            if (reporter.isCancelled())
-                return plan;
 
             const auto& clipInput = clipsToProcess[(size_t) i];
-            const auto baseName = sanitiseStemBaseName (clipInput.clipName);
-            auto lowStemFile = planOutputDirectory.getChildFile (baseName + "_low.wav");
-            auto highStemFile = planOutputDirectory.getChildFile (baseName + "_high.wav");
+            const auto baseName = sanitiseStemBaseName (clipInput.clipName) + "_" + juce::String (i);
+            for (size_t stem = 0; stem < 2; ++stem)
+                stemFiles[(size_t) i][stem] = planOutputDirectory.getChildFile (baseName + "_" + stemNames[stem] + ".wav");
 
-            if (! writeSeparatedStems (clipInput.sourceFile, lowStemFile, highStemFile, reporter))
+            separated[(size_t) i] = separateStems (clipInput.sourceFile, clipInput.sourceRange,
+                                                   stemFiles[(size_t) i], separationSettings,
+                                                   [&reporter]() { return reporter.isCancelled(); }).wasOk();
+        }, "Separated clip");
+
+        // Stems finished before the cancel belong to no plan.
+        if (reporter.isCancelled())
+        {
+            (void) planOutputDirectory.deleteRecursively();
+            return plan;
+        }
+
+        for (const auto& stemName : stemNames)
+        {
+            ToolDiffEntry stemTrack;
+            stemTrack.kind = ToolDiffKind::trackAdded;
+            stemTrack.parameterID = "track.name";
+            stemTrack.targetName = getStemTrackName (stemName);
+            stemTrack.afterText = stemTrack.targetName;
+            stemTrack.summary = "Create destination track '" + stemTrack.targetName + "'";
+            plan.changes.add (stemTrack);
+        }
+
+        for (int i = 0; i < total; ++i)
+        {
+            if (! separated[(size_t) i])
                 continue;
 
+            const auto& clipInput = clipsToProcess[(size_t) i];
+
             auto* outputObj = new juce::DynamicObject();
             outputObj->setProperty ("source_clip_id", (juce::int64) clipInput.clipID.getRawID());
             outputObj->setProperty ("source_track_index", clipInput.trackIndex);
@@ -362,69 +359,35 @@ juce::Result StemSeparationTool::preparePlan (const ToolExecutionContext& contex
             outputObj->setProperty ("clip_end_seconds", clipInput.clipEndSeconds);
 
             juce::Array<juce::var> stemItems;
-            auto* lowStemObj = new juce::DynamicObject();
-            lowStemObj->setProperty ("stem_name", "low");
-            lowStemObj->setProperty ("file", lowStemFile.getFullPathName());
-            stemItems.add (juce::var (lowStemObj));
-
-            auto* highStemObj = new juce::DynamicObject();
-            highStemObj->setProperty ("stem_name", "high");
-            highStemObj->setProperty ("file", highStemFile.getFullPathName());
-            stemItems.add (juce::var (highStemObj));
-
-            outputObj->setProperty ("stems", stemItems);
-            outputItems.add (juce::var (outputObj));
-
-            if (! emittedTrackAdds)
+            for (size_t stem = 0; stem < 2; ++stem)
             {
-                ToolDiffEntry lowTrack;
-                lowTrack.kind = ToolDiffKind::trackAdded;
-                lowTrack.parameterID = "track.name";
-                lowTrack.targetName = "Stem Low";
-                lowTrack.afterText = "Stem Low";
-                lowTrack.summary = "Create destination track 'Stem Low'";
-                plan.changes.add (lowTrack);
-
-                ToolDiffEntry highTrack;
-                highTrack.kind = ToolDiffKind::trackAdded;
-                highTrack.parameterID = "track.name";
-                highTrack.targetName = "Stem High";
-                highTrack.afterText = "Stem High";
-                highTrack.summary = "Create destination track 'Stem High'";
-                plan.changes.add (highTrack);
-
-                emittedTrackAdds = true;
+                const auto& stemFile = stemFiles[(size_t) i][stem];
+
+                auto* stemObj = new juce::DynamicObject();
+                stemObj->setProperty ("stem_name", stemNames[stem]);
+                stemObj->setProperty ("file", stemFile.getFullPathName());
+                stemItems.add (juce::var (stemObj));
+
+                ToolDiffEntry insert;
+                insert.kind = ToolDiffKind::clipInserted;
+                insert.trackIndex = clipInput.trackIndex;
+                insert.clipID = clipInput.clipID;
+                insert.targetName = clipInput.clipName + " [" + stemNames[stem] + "]";
+                insert.parameterID = "clip.file_path";
+                insert.beforeValue = clipInput.clipStartSeconds;
+                insert.afterValue = clipInput.clipEndSeconds;
+                insert.afterText = stemFile.getFullPathName();
+                insert.summary = "Insert " + stemNames[stem] + " stem for clip '" + clipInput.clipName + "'";
+                plan.changes.add (insert);
             }
 
-            ToolDiffEntry lowInsert;
-            lowInsert.kind = ToolDiffKind::clipInserted;
-            lowInsert.trackIndex = clipInput.trackIndex;
-            lowInsert.clipID = clipInput.clipID;
-            lowInsert.targetName = clipInput.clipName + " [low]";
-            lowInsert.parameterID = "clip.file_path";
-            lowInsert.beforeValue = clipInput.clipStartSeconds;
-            lowInsert.afterValue = clipInput.clipEndSeconds;
-            lowInsert.afterText = lowStemFile.getFullPathName();
-            lowInsert.summary = "Insert low stem for clip '" + clipInput.clipName + "'";
-            plan.changes.add (lowInsert);
-
-            ToolDiffEntry highInsert;
-            highInsert.kind = ToolDiffKind::clipInserted;
-            highInsert.trackIndex = clipInput.trackIndex;
-            highInsert.clipID = clipInput.clipID;
-            highInsert.targetName = clipInput.clipName + " [high]";
-            highInsert.parameterID = "clip.file_path";
-            highInsert.beforeValue = clipInput.clipStartSeconds;
-            highInsert.afterValue = clipInput.clipEndSeconds;
-            highInsert.afterText = highStemFile.getFullPathName();
-            highInsert.summary = "Insert high stem for clip '" + clipInput.clipName + "'";
-            plan.changes.add (highInsert);
-
-            reporter.setProgress ((float) (i + 1) / (float) total,
-                                  "Separated clip " + juce::String (i + 1) + " / "
-                                  + juce::String (total));
+            outputObj->setProperty ("stems", stemItems);
+            outputItems.add (juce::var (outputObj));
         }
 
+        if (outputItems.isEmpty())
+            plan.changes.clear();
+
         payloadRoot->setProperty ("outputs", outputItems);
         plan.summary = "Generate stems for " + juce::String (outputItems.size())
                        + " clip(s) using model " + modelInfo.version;
@@ -457,11 +420,6 @@ juce::Result StemSeparationTool::apply (const ToolExecutionContext& context,
     int appliedCount = 0;
     const auto ok = context.editSession.performEdit ("Stem Separation", [&] (te::Edit& edit)
     {
-        auto* lowTrack = findOrCreateTrackByName (edit, "Stem Low");
-        auto* highTrack = findOrCreateTrackByName (edit, "Stem High");
-        if (lowTrack == nullptr || highTrack == nullptr)
-            return;
-
         for (const auto& outputVar : outputArray)
         {
             auto* outputObj = outputVar.getDynamicObject();
@@ -487,7 +445,7 @@ juce::Result StemSeparationTool::apply (const ToolExecutionContext& context,
                 if (! stemFile.existsAsFile())
                     continue;
 
-                auto* destinationTrack = stemName == "low" ? lowTrack : highTrack;
+                auto* destinationTrack = findOrCreateTrackByName (edit, getStemTrackName (stemName));
                 if (destinationTrack == nullptr)
                     continue;
 
@@ -0,0 +1,263 @@
+#include "TempoAnalysis.h"
+#include "AudioFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+
+namespace waive
+{
+
+namespace
+{
+struct BpmGrid
+{
+    double minBpm = 0.0;
+    double step = 0.0;
+    int numSteps = 0;
+
+    double bpmAt (int index) const { return minBpm + step * (double) index; }
+};
+
+BpmGrid getBpmGrid (const TempoSettings& settings)
+{
+    BpmGrid grid;
+    grid.minBpm = juce::jlimit (10.0, 1000.0, juce::jmin (settings.minBpm, settings.maxBpm));
+    const auto maxBpm = juce::jlimit (grid.minBpm, 1000.0, juce::jmax (settings.minBpm, settings.maxBpm));
+    grid.step = juce::jmax (0.01, settings.bpmResolution);
+    grid.numSteps = (int) std::floor ((maxBpm - grid.minBpm) / grid.step) + 1;
+    return grid;
+}
+
+/** Autocorrelation of the mean-removed envelope at lags 0 .. numFrames / 2,
+    corrected for the shrinking overlap at longer lags. */
+std::vector<double> autocorrelate (const std::vector<float>& envelope)
+{
+    const auto numFrames = (int) envelope.size();
+
+    double mean = 0.0;
+    for (auto value : envelope)
+        mean += value;
+    mean /= (double) numFrames;
+
+    // Zero padding to twice the length keeps the circular product from wrapping.
+    int order = 1;
+    while ((1 << order) < 2 * numFrames)
+        ++order;
+
+    const auto& fft = getThreadLocalFft (order);
+    const auto size = fft.getSize();
+
+    std::vector<float> buffer ((size_t) size * 2, 0.0f);
+    for (int i = 0; i < numFrames; ++i)
+        buffer[(size_t) i] = (float) (envelope[(size_t) i] - mean);
+
+    fft.performRealOnlyForwardTransform (buffer.data());
+
+    auto* bins = reinterpret_cast<std::complex<float>*> (buffer.data());
+    for (int i = 0; i < size; ++i)
+        bins[i] = std::norm (bins[i]);
+
+    fft.performRealOnlyInverseTransform (buffer.data());
+
+    std::vector<double> result ((size_t) (numFrames / 2 + 1));
+    for (size_t lag = 0; lag < result.size(); ++lag)
+        result[lag] = (double) buffer[lag] * (double) numFrames / (double) ((size_t) numFrames - lag);
+
+    return result;
+}
+}
+
+std::vector<double> computeTempoStrength (const std::vector<float>& onsetStrength,
+                                          double frameRate,
+                                          const TempoSettings& settings)
+{
+    if (onsetStrength.size() < 8 || frameRate <= 0.0)
+        return {};
+
+    const auto acf = autocorrelate (onsetStrength);
+    if (acf[0] <= 1.0e-12)
+        return {};
+
+    const auto maxLag = (double) (acf.size() - 1);
+    const auto grid = getBpmGrid (settings);
+    std::vector<double> strength ((size_t) grid.numSteps, 0.0);
+
+    for (int index = 0; index < grid.numSteps; ++index)
+    {
+        const auto period = 60.0 * frameRate / grid.bpmAt (index);
+
+        double sum = 0.0;
+        int count = 0;
+        for (int multiple = 1; multiple <= 4; ++multiple)
+        {
+            const auto lag = period * (double) multiple;
+            if (lag >= maxLag)
+                break;
+
+            const auto lower = (size_t) lag;
+            const auto fraction = lag - (double) lower;
+            sum += acf[lower] + fraction * (acf[lower + 1] - acf[lower]);
+            ++count;
+        }
+
+        if (count > 0)
+            strength[(size_t) index] = sum / (double) count / acf[0];
+    }
+
+    return strength;
+}
+
+double pickTempo (const std::vector<double>& tempoStrength, const TempoSettings& settings)
+{
+    const auto grid = getBpmGrid (settings);
+    const auto preferredBpm = juce::jmax (1.0, settings.preferredBpm);
+
+    double bestBpm = 0.0;
+    double bestScore = 0.0;
+
+    for (int index = 0; index < juce::jmin (grid.numSteps, (int) tempoStrength.size()); ++index)
+    {
+        // One octave either side of the preferred tempo keeps 61% of its weight.
+        const auto bpm = grid.bpmAt (index);
+        const auto octaves = std::log2 (bpm / preferredBpm);
+        const auto score = tempoStrength[(size_t) index] * std::exp (-0.5 * octaves * octaves);
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestBpm = bpm;
+        }
+    }
+
+    return bestBpm;
+}
+
+std::vector<int> trackBeats (const std::vector<float>& onsetStrength,
+                             double frameRate,
+                             double bpm,
+                             const TempoSettings& settings)
+{
+    const auto numFrames = (int) onsetStrength.size();
+    if (numFrames == 0 || frameRate <= 0.0 || bpm <= 0.0)
+        return {};
+
+    const auto period = 60.0 * frameRate / bpm;
+    if (period < 2.0 || period >= (double) numFrames)
+        return {};
+
+    double mean = 0.0;
+    for (auto value : onsetStrength)
+        mean += value;
+    mean /= (double) numFrames;
+
+    double variance = 0.0;
+    for (auto value : onsetStrength)
+        variance += ((double) value - mean) * ((double) value - mean);
+
+    const auto deviation = std::sqrt (variance / (double) numFrames);
+    if (deviation <= 1.0e-12)
+        return {};
+
+    // Smooth the normalised envelope with a Gaussian 1/32 of a beat wide so
+    // an onset split over neighbouring frames still reads as one peak.
+    const auto radius = (int) std::lround (period);
+    const auto sigma = period / 32.0;
+    std::vector<double> kernel ((size_t) (2 * radius + 1));
+    for (int k = -radius; k <= radius; ++k)
+        kernel[(size_t) (k + radius)] = std::exp (-0.5 * ((double) k / sigma) * ((double) k / sigma)) / deviation;
+
+    std::vector<double> local ((size_t) numFrames, 0.0);
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        double sum = 0.0;
+        for (int k = juce::jmax (-radius, -frame); k <= juce::jmin (radius, numFrames - 1 - frame); ++k)
+            sum += (double) onsetStrength[(size_t) (frame + k)] * kernel[(size_t) (k + radius)];
+
+        local[(size_t) frame] = sum;
+    }
+
+    // Best score of a beat sequence ending at each frame.
+    const auto minGap = juce::jmax (1, (int) std::lround (period / 2.0));
+    const auto maxGap = (int) std::lround (period * 2.0);
+    std::vector<double> score ((size_t) numFrames, 0.0);
+    std::vector<int> previousBeat ((size_t) numFrames, -1);
+
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        double best = -std::numeric_limits<double>::max();
+        int bestPrevious = -1;
+
+        for (int previous = juce::jmax (0, frame - maxGap); previous <= frame - minGap; ++previous)
+        {
+            const auto deviationFromPeriod = std::log ((double) (frame - previous) / period);
+            const auto candidate = score[(size_t) previous] - settings.tightness * deviationFromPeriod * deviationFromPeriod;
+            if (candidate > best)
+            {
+                best = candidate;
+                bestPrevious = previous;
+            }
+        }
+
+        // A sequence only continues while it has something to show for it.
+        if (bestPrevious >= 0 && best > 0.0)
+        {
+            score[(size_t) frame] = local[(size_t) frame] + best;
+            previousBeat[(size_t) frame] = bestPrevious;
+        }
+        else
+        {
+            score[(size_t) frame] = local[(size_t) frame];
+        }
+    }
+
+    // The last beat is the last strong peak of the cumulative score.
+    std::vector<double> peakScores;
+    for (int frame = 1; frame + 1 < numFrames; ++frame)
+        if (score[(size_t) frame] > score[(size_t) frame - 1] && score[(size_t) frame] >= score[(size_t) frame + 1])
+            peakScores.push_back (score[(size_t) frame]);
+
+    int lastBeat = (int) (std::max_element (score.begin(), score.end()) - score.begin());
+    if (! peakScores.empty())
+    {
+        auto middle = peakScores.begin() + (std::ptrdiff_t) (peakScores.size() / 2);
+        std::nth_element (peakScores.begin(), middle, peakScores.end());
+        const auto threshold = 0.5 * *middle;
+
+        for (int frame = numFrames - 2; frame >= 1; --frame)
+        {
+            if (score[(size_t) frame] >= threshold
+                && score[(size_t) frame] > score[(size_t) frame - 1] && score[(size_t) frame] >= score[(size_t) frame + 1])
+            {
+                lastBeat = frame;
+                break;
+            }
+        }
+    }
+
+    std::vector<int> beats;
+    for (int frame = lastBeat; frame >= 0; frame = previousBeat[(size_t) frame])
+        beats.push_back (frame);
+
+    std::reverse (beats.begin(), beats.end());
+
+    // Drop leading and trailing beats that land on much less than a typical onset.
+    double beatEnergy = 0.0;
+    for (auto frame : beats)
+        beatEnergy += local[(size_t) frame] * local[(size_t) frame];
+
+    const auto weakThreshold = 0.5 * std::sqrt (beatEnergy / (double) beats.size());
+
+    auto first = beats.begin();
+    while (first != beats.end() && local[(size_t) *first] < weakThreshold)
+        ++first;
+
+    auto last = beats.end();
+    while (last != first && local[(size_t) *(last - 1)] < weakThreshold)
+        --last;
+
+    return { first, last };
+}
+
+} // namespace waive
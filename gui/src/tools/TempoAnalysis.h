@@ -0,0 +1,41 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+namespace waive
+{
+
+struct TempoSettings
+{
+    double minBpm = 60.0;
+    double maxBpm = 200.0;
+    double preferredBpm = 120.0;    // centre of the tempo prior that settles half/double-tempo ambiguity
+    double bpmResolution = 0.1;
+    double tightness = 100.0;       // how strongly beat tracking keeps beats one period apart
+};
+
+/** Periodicity evidence of an onset envelope for every BPM from minBpm to
+    maxBpm in bpmResolution steps. Each value averages the envelope's
+    autocorrelation at the first four multiples of that beat period, which
+    pins the tempo down far more finely than a single lag. Values are
+    normalised by the envelope's energy, so strengths from clips of any level
+    or length can be summed before picking a session tempo. */
+std::vector<double> computeTempoStrength (const std::vector<float>& onsetStrength,
+                                          double frameRate,
+                                          const TempoSettings& settings);
+
+/** The BPM with the most evidence once weighted by a log-normal prior around
+    preferredBpm. Returns 0 if nothing is periodic. */
+double pickTempo (const std::vector<double>& tempoStrength, const TempoSettings& settings);
+
+/** Beat frames for a known tempo. Dynamic programming places each beat on a
+    strong onset while keeping consecutive beats close to one period apart
+    (Ellis 2007). Weak beats before the first and after the last clear onset
+    are dropped, so silence at either end gets no beats. */
+std::vector<int> trackBeats (const std::vector<float>& onsetStrength,
+                             double frameRate,
+                             double bpm,
+                             const TempoSettings& settings);
+
+} // namespace waive
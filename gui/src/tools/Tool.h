@@ -24,6 +24,7 @@ struct ToolDescription
     juce::var inputSchema;
     juce::var defaultParams;
     juce::String modelRequirement;
+    bool speculativePlanning = false;   // planning only reads the edit and audio, so it may start before Plan is pressed
 };
 
 struct ToolExecutionContext
@@ -39,6 +40,12 @@ struct ToolPlanTask
 {
     juce::String jobName;
     std::function<ToolPlan (ProgressReporter&)> run;
+
+    // Optional. Writes the plan's files to the project cache: its artifact,
+    // setting ToolPlan::artifactFile, and the project's analysis store. Kept
+    // out of run() so a speculative plan that is never adopted leaves no file
+    // behind; callers run it for plans they keep.
+    std::function<void (ToolPlan&)> writeArtifact;
 };
 
 class Tool
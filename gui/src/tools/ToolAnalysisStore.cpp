@@ -0,0 +1,216 @@
+#include "ToolAnalysisStore.h"
+#include "Tool.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace waive
+{
+
+namespace
+{
+constexpr int storeFormat = 1;
+}
+
+ToolAnalysisStore::ToolAnalysisStore (const juce::File& file, int maxEntries_)
+    : storeFile (file),
+      maxEntries (juce::jmax (1, maxEntries_))
+{
+    load();
+}
+
+std::shared_ptr<ToolAnalysisStore> ToolAnalysisStore::forProject (const juce::File& projectCacheDirectory)
+{
+    if (projectCacheDirectory == juce::File())
+        return nullptr;
+
+    static std::mutex storesMutex;
+    static std::map<juce::String, std::shared_ptr<ToolAnalysisStore>> stores;
+
+    const auto file = projectCacheDirectory.getChildFile ("tools").getChildFile ("analysis_store.json");
+    const std::lock_guard<std::mutex> lock (storesMutex);
+
+    auto& store = stores[file.getFullPathName()];
+    if (store == nullptr)
+        store = std::make_shared<ToolAnalysisStore> (file);
+
+    return store;
+}
+
+juce::String ToolAnalysisStore::makeKey (const ToolDescription& tool,
+                                         const juce::var& analysisParams,
+                                         const juce::File& sourceFile,
+                                         const AudioAnalysisRange& range)
+{
+    juce::String key;
+    key << tool.name << ':' << tool.version << ':'
+        << juce::JSON::toString (analysisParams, true) << ':'
+        << sourceFile.getFullPathName() << ':' << sourceFile.getSize() << ':'
+        << sourceFile.getLastModificationTime().toMilliseconds() << ':'
+        << range.offsetSeconds << ':' << range.lengthSeconds << ':' << range.getSpeedRatio();
+
+    return juce::String::toHexString (key.hashCode64());
+}
+
+std::optional<juce::var> ToolAnalysisStore::get (const juce::String& key)
+{
+    const juce::ScopedLock sl (lock);
+
+    auto it = entries.find (key);
+    if (it == entries.end())
+        return std::nullopt;
+
+    // Recency only matters for eviction, so a hit doesn't mark the store dirty.
+    it->second.lastUsed = ++useCounter;
+    return it->second.value;
+}
+
+void ToolAnalysisStore::put (const juce::String& key, const juce::var& value)
+{
+    const juce::ScopedLock sl (lock);
+
+    auto& entry = entries[key];
+    entry.value = value;
+    entry.lastUsed = ++useCounter;
+    dirty = true;
+
+    if ((int) entries.size() > maxEntries)
+    {
+        auto oldest = std::min_element (entries.begin(), entries.end(),
+                                        [] (const auto& lhs, const auto& rhs) { return lhs.second.lastUsed < rhs.second.lastUsed; });
+        entries.erase (oldest);
+    }
+}
+
+AudioAnalysisSummary ToolAnalysisStore::getOrAnalyse (const juce::String& key,
+                                                      const std::function<AudioAnalysisSummary()>& analyse)
+{
+    if (auto stored = get (key))
+        if (auto summary = analysisSummaryFromVar (*stored))
+            return *summary;
+
+    auto summary = analyse();
+    if (summary.valid && ! summary.cancelled)
+        put (key, analysisSummaryToVar (summary));
+
+    return summary;
+}
+
+bool ToolAnalysisStore::save()
+{
+    const juce::ScopedLock sl (lock);
+
+    if (! dirty)
+        return true;
+
+    auto* entriesObj = new juce::DynamicObject();
+    for (const auto& [key, entry] : entries)
+    {
+        auto* entryObj = new juce::DynamicObject();
+        entryObj->setProperty ("used", entry.lastUsed);
+        entryObj->setProperty ("value", entry.value);
+        entriesObj->setProperty (juce::Identifier (key), juce::var (entryObj));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty ("format", storeFormat);
+    root->setProperty ("entries", juce::var (entriesObj));
+
+    if (! storeFile.getParentDirectory().createDirectory())
+        return false;
+
+    if (! storeFile.replaceWithText (juce::JSON::toString (juce::var (root), true)))
+        return false;
+
+    dirty = false;
+    return true;
+}
+
+int ToolAnalysisStore::getNumEntries() const
+{
+    const juce::ScopedLock sl (lock);
+    return (int) entries.size();
+}
+
+void ToolAnalysisStore::load()
+{
+    if (! storeFile.existsAsFile())
+        return;
+
+    const auto root = juce::JSON::parse (storeFile);
+    if ((int) root.getProperty ("format", 0) != storeFormat)
+        return;
+
+    auto* entriesObj = root.getProperty ("entries", {}).getDynamicObject();
+    if (entriesObj == nullptr)
+        return;
+
+    for (const auto& property : entriesObj->getProperties())
+    {
+        Entry entry;
+        entry.value = property.value.getProperty ("value", {});
+        entry.lastUsed = (int64) property.value.getProperty ("used", 0);
+        useCounter = juce::jmax (useCounter, entry.lastUsed);
+        entries[property.name.toString()] = std::move (entry);
+    }
+}
+
+//==============================================================================
+juce::var analysisSummaryToVar (const AudioAnalysisSummary& summary)
+{
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("sample_rate", summary.sampleRate);
+    obj->setProperty ("speed_ratio", summary.speedRatio);
+    obj->setProperty ("range_start", summary.rangeStartSample);
+    obj->setProperty ("total_samples", summary.totalSamples);
+    obj->setProperty ("peak", summary.peakGain);
+    obj->setProperty ("rms", summary.rmsGain);
+    if (summary.hasLoudness)
+        obj->setProperty ("integrated_lufs", summary.integratedLufs);
+    obj->setProperty ("first_above", summary.firstAboveSample);
+    obj->setProperty ("last_above", summary.lastAboveSample);
+    obj->setProperty ("first_transient", summary.firstTransientSample);
+
+    juce::Array<juce::var> regions;
+    for (const auto& region : summary.activeRegions)
+        regions.add (juce::Array<juce::var> { region.startSample, region.endSample });
+
+    obj->setProperty ("regions", regions);
+    return juce::var (obj);
+}
+
+std::optional<AudioAnalysisSummary> analysisSummaryFromVar (const juce::var& value)
+{
+    auto* obj = value.getDynamicObject();
+    if (obj == nullptr || ! obj->hasProperty ("sample_rate"))
+        return std::nullopt;
+
+    AudioAnalysisSummary summary;
+    summary.valid = true;
+    summary.sampleRate = (double) obj->getProperty ("sample_rate");
+    summary.speedRatio = (double) obj->getProperty ("speed_ratio");
+    summary.rangeStartSample = (int64) obj->getProperty ("range_start");
+    summary.totalSamples = (int64) obj->getProperty ("total_samples");
+    summary.peakGain = (float) obj->getProperty ("peak");
+    summary.rmsGain = (float) obj->getProperty ("rms");
+    summary.hasLoudness = obj->hasProperty ("integrated_lufs");
+    if (summary.hasLoudness)
+        summary.integratedLufs = (double) obj->getProperty ("integrated_lufs");
+    summary.firstAboveSample = (int64) obj->getProperty ("first_above");
+    summary.lastAboveSample = (int64) obj->getProperty ("last_above");
+    summary.firstTransientSample = (int64) obj->getProperty ("first_transient");
+
+    if (auto* regions = obj->getProperty ("regions").getArray())
+    {
+        for (const auto& region : *regions)
+            if (region.isArray() && region.size() == 2)
+                summary.activeRegions.push_back ({ (int64) region[0], (int64) region[1] });
+    }
+
+    if (summary.sampleRate <= 0.0 || summary.speedRatio <= 0.0)
+        return std::nullopt;
+
+    return summary;
+}
+
+} // namespace waive
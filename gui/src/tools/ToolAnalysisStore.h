@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+
+#include "AudioAnalysis.h"
+
+namespace waive
+{
+
+struct ToolDescription;
+
+/** Memoised per-clip analysis for tool plans, kept for the whole session and
+    saved in the project cache directory.
+
+    Entries are keyed by the tool's name and version, the parameters that
+    change the analysis, and a fingerprint of the source audio (path, size,
+    modification time and the range the clip plays). Parameters that only
+    shape the plan, such as a target level, stay out of the key, so changing
+    them and planning again skips the audio entirely. Editing or replacing a
+    source file changes its fingerprint and so misses. */
+class ToolAnalysisStore
+{
+public:
+    /** Loads storeFile if it exists. Nothing is written until save(). */
+    explicit ToolAnalysisStore (const juce::File& storeFile, int maxEntries = 4096);
+
+    /** The store shared by every tool planning in a project cache directory.
+        Returns nullptr for an empty directory. */
+    static std::shared_ptr<ToolAnalysisStore> forProject (const juce::File& projectCacheDirectory);
+
+    static juce::String makeKey (const ToolDescription& tool,
+                                 const juce::var& analysisParams,
+                                 const juce::File& sourceFile,
+                                 const AudioAnalysisRange& range);
+
+    std::optional<juce::var> get (const juce::String& key);
+    void put (const juce::String& key, const juce::var& value);
+
+    /** Returns the stored summary for key, or runs analyse and stores its
+        result. Invalid and cancelled results are returned but not stored. */
+    AudioAnalysisSummary getOrAnalyse (const juce::String& key,
+                                       const std::function<AudioAnalysisSummary()>& analyse);
+
+    /** Writes the entries if anything changed since the last load or save. */
+    bool save();
+
+    int getNumEntries() const;
+    juce::File getFile() const { return storeFile; }
+
+private:
+    struct Entry
+    {
+        juce::var value;
+        int64 lastUsed = 0;
+    };
+
+    void load();
+
+    const juce::File storeFile;
+    const int maxEntries;
+    std::map<juce::String, Entry> entries;
+    int64 useCounter = 0;
+    bool dirty = false;
+    mutable juce::CriticalSection lock;
+};
+
+/** JSON-safe round trip of an analysis summary, for the store. */
+juce::var analysisSummaryToVar (const AudioAnalysisSummary& summary);
+std::optional<AudioAnalysisSummary> analysisSummaryFromVar (const juce::var& value);
+
+} // namespace waive
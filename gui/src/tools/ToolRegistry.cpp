@@ -2,6 +2,7 @@
 #include "AlignClipsByTransientTool.h"
 #include "AutoMixSuggestionsTool.h"
 #include "DetectSilenceAndCutRegionsTool.h"
+#include "DetectTempoTool.h"
 #include "GainStageSelectedTracksTool.h"
 #include "NormalizeSelectedClipsTool.h"
 #include "RenameTracksFromClipsTool.h"
@@ -22,6 +23,7 @@ ToolRegistry::ToolRegistry()
     registerTool (std::make_unique<AlignClipsByTransientTool>());
     registerTool (std::make_unique<StemSeparationTool>());
     registerTool (std::make_unique<AutoMixSuggestionsTool>());
+    registerTool (std::make_unique<DetectTempoTool>());
 }
 
 void ToolRegistry::registerTool (std::unique_ptr<Tool> tool)
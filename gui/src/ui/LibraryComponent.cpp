@@ -7,13 +7,133 @@
 
 #include <tracktion_engine/tracktion_engine.h>
 
+#include <cmath>
+#include <iterator>
+
 namespace te = tracktion;
 
+namespace
+{
+constexpr int maxSearchResults = 500;
+
+// Rates offered for conversion on import; 0 keeps each file's own rate.
+const double importSampleRates[] = { 0.0, 44100.0, 48000.0, 88200.0, 96000.0 };
+
+enum ImportMenuItem
+{
+    importMenuOneTrackPerFile = 1,
+    importMenuCopyIntoProject,
+    importMenuSampleRateBase = 100
+};
+
+juce::PropertiesFile::Options getSettingsOptions()
+{
+    juce::PropertiesFile::Options opts;
+    opts.applicationName     = "Waive";
+    opts.filenameSuffix       = ".settings";
+    opts.osxLibrarySubFolder = "Application Support/Waive";
+    return opts;
+}
+
+juce::String describeEntry (const waive::SampleLibraryEntry& entry)
+{
+    juce::StringArray parts;
+    parts.add (juce::String (entry.durationSeconds, 2) + " s");
+
+    if (entry.tempoBpm > 0.0)
+        parts.add (juce::String (juce::roundToInt (entry.tempoBpm)) + " bpm");
+
+    if (entry.key.isNotEmpty())
+        parts.add (entry.key);
+
+    if (entry.hasLevels)
+        parts.add (juce::String (entry.peakDb, 1) + " dBFS");
+
+    return parts.joinIntoString ("  ");
+}
+}
+
+//==============================================================================
+/** Waveform of the file selected for preview, with the play position. Click
+    or drag to audition from that point. */
+struct LibraryComponent::PreviewStrip : public juce::Component
+{
+    explicit PreviewStrip (LibraryComponent& o) : owner (o)
+    {
+        setTitle ("Preview Waveform");
+        setDescription ("Waveform of the selected file - click or drag to audition from a position");
+    }
+
+    void setFile (const juce::File& file)
+    {
+        thumbnail.reset();
+        lengthSeconds = 0.0;
+
+        if (file.existsAsFile())
+        {
+            auto& engine = owner.editSession.getEngine();
+            te::AudioFile audioFile (engine, file);
+            lengthSeconds = audioFile.getLength();
+
+            // The engine's thumbnail cache is shared with the timeline's clips,
+            // so a file that has been on the timeline draws straight away.
+            if (! waive::isHeadlessUiEnvironment())
+                thumbnail = std::make_unique<te::SmartThumbnail> (engine, audioFile, *this, nullptr);
+        }
+
+        repaint();
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        auto* pal = waive::getWaivePalette (*this);
+        auto bounds = getLocalBounds();
+
+        g.setColour (pal ? pal->insetBg : juce::Colour (0xff1a1a1a));
+        g.fillRect (bounds);
+
+        if (lengthSeconds <= 0.0)
+            return;
+
+        if (thumbnail != nullptr && thumbnail->isFullyLoaded())
+        {
+            g.setColour (pal ? pal->waveform : juce::Colour (0xccffffff));
+            thumbnail->drawChannels (g, bounds.reduced (waive::Spacing::xxs),
+                                     { te::TimePosition(), te::TimePosition::fromSeconds (lengthSeconds) },
+                                     1.0f);
+        }
+
+        auto& player = owner.previewPlayer;
+        if (player.getFile() == owner.previewFile && (player.isPlaying() || player.getPosition() > 0.0))
+        {
+            const auto x = (float) (player.getPosition() / lengthSeconds * (double) getWidth());
+            g.setColour (pal ? pal->playhead : juce::Colour (0xffff5050));
+            g.drawVerticalLine (juce::roundToInt (x), 0.0f, (float) getHeight());
+        }
+    }
+
+    void mouseDown (const juce::MouseEvent& e) override  { scrubTo (e.x); }
+    void mouseDrag (const juce::MouseEvent& e) override  { scrubTo (e.x); }
+
+    void scrubTo (int x)
+    {
+        if (lengthSeconds > 0.0 && getWidth() > 0)
+            owner.previewFrom (juce::jlimit (0.0, lengthSeconds, (double) x / (double) getWidth() * lengthSeconds));
+    }
+
+    LibraryComponent& owner;
+    std::unique_ptr<te::SmartThumbnail> thumbnail;
+    double lengthSeconds = 0.0;
+};
+
 //==============================================================================
-LibraryComponent::LibraryComponent (EditSession& session)
+LibraryComponent::LibraryComponent (EditSession& session, waive::MediaImporter* sharedImporter)
     : editSession (session),
+      ownedMediaImporter (sharedImporter == nullptr ? std::make_unique<waive::MediaImporter> (session) : nullptr),
+      mediaImporter (sharedImporter != nullptr ? *sharedImporter : *ownedMediaImporter),
       fileFilter ("*.wav;*.aiff;*.flac;*.mp3;*.ogg", "*", "Audio Files"),
-      directoryList (&fileFilter, scanThread)
+      directoryList (&fileFilter, scanThread),
+      previewPlayer (session.getEngine().getDeviceManager().deviceManager)
 {
     scanThread.startThread (juce::Thread::Priority::background);
 
@@ -25,6 +145,7 @@ LibraryComponent::LibraryComponent (EditSession& session)
     fileTree = std::make_unique<juce::FileTreeComponent> (directoryList);
     fileTree->addListener (this);
     fileTree->setDragAndDropDescription ("LibraryFile");
+    fileTree->setMultiSelectEnabled (true);
     fileTree->setTitle ("File Browser");
     fileTree->setDescription ("Browse and drag audio files");
     fileTree->setTooltip ("Browse and drag audio files into the timeline");
@@ -41,6 +162,14 @@ LibraryComponent::LibraryComponent (EditSession& session)
     targetTrackCombo.setWantsKeyboardFocus (true);
     addAndMakeVisible (targetTrackCombo);
 
+    importOptionsButton.setButtonText ("Options");
+    importOptionsButton.onClick = [this] { showImportOptionsMenu(); };
+    importOptionsButton.setTitle ("Import Options");
+    importOptionsButton.setDescription ("Choose how imported files are placed, copied and converted");
+    importOptionsButton.setTooltip ("Place files on one track or one each, copy them into the project, or convert their sample rate");
+    importOptionsButton.setWantsKeyboardFocus (true);
+    addAndMakeVisible (importOptionsButton);
+
     goUpButton.setButtonText ("..");
     goUpButton.onClick = [this] { goUp(); };
     goUpButton.setTitle ("Go Up");
@@ -70,24 +199,85 @@ LibraryComponent::LibraryComponent (EditSession& session)
     favoritesCombo.setWantsKeyboardFocus (true);
     addAndMakeVisible (favoritesCombo);
 
+    searchBox.setTextToShowWhenEmpty ("Search library (bpm:120, key:am)", juce::Colour (0xff808080));
+    searchBox.onTextChange = [this] { updateSearchResults(); };
+    searchBox.onEscapeKey = [this] { searchBox.clear(); updateSearchResults(); };
+    searchBox.setTitle ("Library Search");
+    searchBox.setDescription ("Search indexed samples by name, tempo or key");
+    searchBox.setTooltip ("Search indexed samples by name; add bpm:120 or key:am to filter");
+    addAndMakeVisible (searchBox);
+
+    indexButton.setButtonText ("Index");
+    indexButton.onClick = [this] { indexCurrentDirectory(); };
+    indexButton.setTitle ("Index Folder");
+    indexButton.setDescription ("Add the current directory to the search index");
+    indexButton.setTooltip ("Add the current directory to the search index and scan it");
+    indexButton.setWantsKeyboardFocus (true);
+    addAndMakeVisible (indexButton);
+
+    indexStatusLabel.setFont (waive::Fonts::caption());
+    indexStatusLabel.setTitle ("Index Status");
+    addAndMakeVisible (indexStatusLabel);
+
+    resultsList.setModel (this);
+    resultsList.setTitle ("Search Results");
+    resultsList.setDescription ("Indexed samples matching the search");
+    resultsList.setRowHeight (waive::Spacing::controlHeightDefault);
+    resultsList.setMultipleSelectionEnabled (true);
+    addChildComponent (resultsList);
+
+    previewStrip = std::make_unique<PreviewStrip> (*this);
+    addAndMakeVisible (*previewStrip);
+
+    previewButton.setButtonText ("Play");
+    previewButton.onClick = [this] { togglePreview(); };
+    previewButton.setTitle ("Preview");
+    previewButton.setDescription ("Play or stop a preview of the selected file");
+    previewButton.setTooltip ("Audition the selected file without adding it to the edit");
+    previewButton.setWantsKeyboardFocus (true);
+    previewButton.setEnabled (false);
+    addAndMakeVisible (previewButton);
+
+    autoPreviewToggle.setButtonText ("Auto");
+    autoPreviewToggle.setTitle ("Auto Preview");
+    autoPreviewToggle.setDescription ("Preview each file as it is selected");
+    autoPreviewToggle.setTooltip ("Play each file as soon as it is selected");
+    addAndMakeVisible (autoPreviewToggle);
+
+    // A shared importer's errors are reported by the timeline.
+    if (ownedMediaImporter != nullptr)
+        mediaImporter.addListener (this);
+
     loadFavorites();
+    loadImportOptions();
     refreshTargetTrackList();
+
+    setIndex (std::make_unique<waive::SampleLibraryIndex> (waive::SampleLibraryIndex::getDefaultDatabaseFile()));
 }
 
 LibraryComponent::~LibraryComponent()
 {
+    stopTimer();
+
+    if (ownedMediaImporter != nullptr)
+        mediaImporter.removeListener (this);
+
+    previewPlayer.stop();
+    setIndex (nullptr);
     fileTree->removeListener (this);
     scanThread.stopThread (1000);
 }
 
 void LibraryComponent::paint (juce::Graphics& g)
 {
-    if (directoryList.getNumFiles() == 0)
+    const bool searching = resultsList.isVisible();
+    if (searching ? searchResults.empty() : directoryList.getNumFiles() == 0)
     {
         g.setFont (waive::Fonts::caption());
         auto* pal = waive::getWaivePalette (*this);
         g.setColour (pal ? pal->textMuted : juce::Colour (0xff808080));
-        g.drawText ("No files in directory", getLocalBounds(), juce::Justification::centred, true);
+        g.drawText (searching ? "No matching samples" : "No files in directory",
+                    getLocalBounds(), juce::Justification::centred, true);
     }
 }
 
@@ -107,10 +297,29 @@ void LibraryComponent::resized()
     auto targetRow = bounds.removeFromTop (waive::Spacing::controlHeightDefault);
     targetTrackLabel.setBounds (targetRow.removeFromLeft (80));
     targetRow.removeFromLeft (waive::Spacing::xs);
+    importOptionsButton.setBounds (targetRow.removeFromRight (70));
+    targetRow.removeFromRight (waive::Spacing::xs);
     targetTrackCombo.setBounds (targetRow);
 
+    bounds.removeFromTop (waive::Spacing::xs);
+    auto searchRow = bounds.removeFromTop (waive::Spacing::controlHeightDefault);
+    indexButton.setBounds (searchRow.removeFromRight (60));
+    searchRow.removeFromRight (waive::Spacing::xs);
+    searchBox.setBounds (searchRow);
+
+    indexStatusLabel.setBounds (bounds.removeFromTop (waive::Spacing::controlHeightSmall));
+
+    auto previewRow = bounds.removeFromBottom (waive::Spacing::controlHeightDefault);
+    previewButton.setBounds (previewRow.removeFromLeft (60));
+    previewRow.removeFromLeft (waive::Spacing::xs);
+    autoPreviewToggle.setBounds (previewRow.removeFromLeft (70));
+    bounds.removeFromBottom (waive::Spacing::xs);
+    previewStrip->setBounds (bounds.removeFromBottom (48));
+    bounds.removeFromBottom (waive::Spacing::xs);
+
     bounds.removeFromTop (waive::Spacing::xs);
     fileTree->setBounds (bounds);
+    resultsList.setBounds (bounds);
 }
 
 bool LibraryComponent::selectTargetTrackForTesting (int trackIndex)
@@ -129,6 +338,53 @@ int LibraryComponent::getSelectedTargetTrackIndexForTesting() const
     return targetTrackCombo.getSelectedItemIndex();
 }
 
+void LibraryComponent::setIndexDatabaseForTesting (const juce::File& databaseFile)
+{
+    setIndex (std::make_unique<waive::SampleLibraryIndex> (databaseFile));
+}
+
+waive::SampleLibraryIndex& LibraryComponent::getIndexForTesting()
+{
+    return *libraryIndex;
+}
+
+void LibraryComponent::setSearchTextForTesting (const juce::String& text)
+{
+    searchBox.setText (text, false);
+    updateSearchResults();
+}
+
+const std::vector<waive::SampleLibraryEntry>& LibraryComponent::getSearchResultsForTesting() const
+{
+    return searchResults;
+}
+
+bool LibraryComponent::isShowingSearchResultsForTesting() const
+{
+    return resultsList.isVisible();
+}
+
+void LibraryComponent::selectPreviewFileForTesting (const juce::File& file)
+{
+    setPreviewFile (file);
+}
+
+bool LibraryComponent::togglePreviewForTesting()
+{
+    togglePreview();
+    return previewPlayer.isPlaying();
+}
+
+waive::SamplePreviewPlayer& LibraryComponent::getPreviewPlayerForTesting()
+{
+    return previewPlayer;
+}
+
+void LibraryComponent::selectionChanged()
+{
+    setPreviewFile (fileTree->getSelectedFile());
+}
+
 void LibraryComponent::fileDoubleClicked (const juce::File& file)
 {
     refreshTargetTrackList();
@@ -156,24 +412,220 @@ void LibraryComponent::fileDoubleClicked (const juce::File& file)
     }
     auto transportPos = edit.getTransport().getPosition().inSeconds();
 
-    te::AudioFile audioFile (edit.engine, file);
-    auto duration = audioFile.getLength();
+    mediaImporter.importFiles ({ file }, te::getAudioTracks (edit).indexOf (track), transportPos);
+}
 
-    if (duration <= 0.0)
-    {
+void LibraryComponent::importFinished (int, const juce::StringArray& errors)
+{
+    if (! errors.isEmpty())
         waive::showMessageBoxAsyncSafe (juce::MessageBoxIconType::WarningIcon,
-                                        "Cannot Load File", "The selected file format is not supported or could not be read.");
+                                        "Cannot Load File", errors.joinIntoString ("\n"));
+}
+
+waive::MediaImporter& LibraryComponent::getMediaImporterForTesting()
+{
+    return mediaImporter;
+}
+
+void LibraryComponent::setImportOptionsForTesting (const waive::MediaImportOptions& options)
+{
+    setImportOptions (options);
+}
+
+//==============================================================================
+int LibraryComponent::getNumRows()
+{
+    return (int) searchResults.size();
+}
+
+void LibraryComponent::paintListBoxItem (int row, juce::Graphics& g, int width, int height, bool rowIsSelected)
+{
+    if (! juce::isPositiveAndBelow (row, (int) searchResults.size()))
+        return;
+
+    const auto& entry = searchResults[(size_t) row];
+    auto* pal = waive::getWaivePalette (*this);
+
+    if (rowIsSelected)
+        g.fillAll (pal ? pal->selection : juce::Colour (0xff2f4f4f));
+
+    auto area = juce::Rectangle<int> (0, 0, width, height).reduced (6, 0);
+
+    g.setFont (waive::Fonts::caption());
+    g.setColour (pal ? pal->textMuted : juce::Colour (0xff808080));
+    g.drawFittedText (describeEntry (entry), area.removeFromRight (area.getWidth() / 2),
+                      juce::Justification::centredRight, 1);
+
+    g.setColour (pal ? pal->textPrimary : juce::Colour (0xffffffff));
+    g.drawFittedText (entry.getFile().getFileName(), area, juce::Justification::centredLeft, 1);
+}
+
+void LibraryComponent::listBoxItemDoubleClicked (int row, const juce::MouseEvent&)
+{
+    if (juce::isPositiveAndBelow (row, (int) searchResults.size()))
+        fileDoubleClicked (searchResults[(size_t) row].getFile());
+}
+
+juce::var LibraryComponent::getDragSourceDescription (const juce::SparseSet<int>& rows)
+{
+    // ["LibraryFile", path...], one path per selected row.
+    juce::Array<juce::var> description { "LibraryFile" };
+    for (int i = 0; i < rows.size(); ++i)
+        if (juce::isPositiveAndBelow (rows[i], (int) searchResults.size()))
+            description.add (searchResults[(size_t) rows[i]].path);
+
+    if (description.size() < 2)
+        return {};
+
+    return description;
+}
+
+void LibraryComponent::selectedRowsChanged (int lastRowSelected)
+{
+    if (juce::isPositiveAndBelow (lastRowSelected, (int) searchResults.size()))
+        setPreviewFile (searchResults[(size_t) lastRowSelected].getFile());
+}
+
+void LibraryComponent::changeListenerCallback (juce::ChangeBroadcaster*)
+{
+    // A scan published a new snapshot.
+    updateIndexStatus();
+    updateSearchResults();
+}
+
+void LibraryComponent::setIndex (std::unique_ptr<waive::SampleLibraryIndex> newIndex)
+{
+    if (libraryIndex != nullptr)
+    {
+        libraryIndex->removeChangeListener (this);
+        libraryIndex->stopBackgroundScan();
+    }
+
+    libraryIndex = std::move (newIndex);
+
+    if (libraryIndex != nullptr)
+    {
+        libraryIndex->addChangeListener (this);
+
+        // Catch up with files added or changed while the app was closed.
+        if (! libraryIndex->getRoots().isEmpty())
+            libraryIndex->startBackgroundScan();
+
+        updateIndexStatus();
+        updateSearchResults();
+    }
+}
+
+void LibraryComponent::indexCurrentDirectory()
+{
+    auto dir = directoryList.getDirectory();
+    if (! dir.isDirectory() || libraryIndex == nullptr)
+        return;
+
+    libraryIndex->addRoot (dir);
+    libraryIndex->startBackgroundScan();
+    indexStatusLabel.setText ("Indexing " + dir.getFileName() + "...", juce::dontSendNotification);
+}
+
+void LibraryComponent::updateSearchResults()
+{
+    const auto query = searchBox.getText().trim();
+    const bool searching = query.isNotEmpty();
+
+    searchResults = searching && libraryIndex != nullptr ? libraryIndex->search (query, maxSearchResults)
+                                                         : std::vector<waive::SampleLibraryEntry>();
+
+    resultsList.updateContent();
+    resultsList.setVisible (searching);
+    fileTree->setVisible (! searching);
+    repaint();
+}
+
+void LibraryComponent::updateIndexStatus()
+{
+    if (libraryIndex == nullptr)
         return;
+
+    const auto numEntries = libraryIndex->getNumEntries();
+    indexStatusLabel.setText (numEntries == 0 ? juce::String ("No folders indexed")
+                                              : juce::String (numEntries) + " files indexed",
+                              juce::dontSendNotification);
+}
+
+//==============================================================================
+void LibraryComponent::timerCallback()
+{
+    // Runs only while a preview plays, to move the play position and to
+    // notice when the file ends.
+    previewStrip->repaint();
+
+    if (! previewPlayer.isPlaying())
+    {
+        stopTimer();
+        updatePreviewButton();
     }
+}
+
+void LibraryComponent::setPreviewFile (const juce::File& file)
+{
+    const auto audioFile = file.existsAsFile() ? file : juce::File();
+    if (audioFile == previewFile)
+        return;
+
+    previewFile = audioFile;
+    previewStrip->setFile (previewFile);
+
+    if (previewFile == juce::File())
+        previewPlayer.stop();
+    else if (autoPreviewToggle.getToggleState())
+        previewFrom (0.0);
+
+    updatePreviewButton();
+}
 
-    editSession.performEdit ("Insert Audio Clip", [&] (te::Edit&)
+void LibraryComponent::togglePreview()
+{
+    if (previewPlayer.isPlaying())
     {
-        track->insertWaveClip (file.getFileNameWithoutExtension(), file,
-                               { { te::TimePosition::fromSeconds (transportPos),
-                                   te::TimePosition::fromSeconds (transportPos + duration) },
-                                 te::TimeDuration() },
-                               false);
-    });
+        previewPlayer.stop();
+        updatePreviewButton();
+    }
+    else if (previewFile.existsAsFile())
+    {
+        previewFrom (0.0);
+    }
+}
+
+void LibraryComponent::previewFrom (double seconds)
+{
+    if (! previewFile.existsAsFile())
+        return;
+
+    // A file already loaded just moves its play position.
+    if (previewPlayer.getFile() == previewFile && previewPlayer.isPlaying())
+    {
+        previewPlayer.setPosition (seconds);
+    }
+    else
+    {
+        auto result = previewPlayer.preview (previewFile, seconds);
+        if (result.failed())
+        {
+            waive::showMessageBoxAsyncSafe (juce::MessageBoxIconType::WarningIcon,
+                                            "Cannot Preview File", result.getErrorMessage());
+            return;
+        }
+    }
+
+    startTimerHz (30);
+    updatePreviewButton();
+    previewStrip->repaint();
+}
+
+void LibraryComponent::updatePreviewButton()
+{
+    previewButton.setButtonText (previewPlayer.isPlaying() ? "Stop" : "Play");
+    previewButton.setEnabled (previewFile != juce::File() || previewPlayer.isPlaying());
 }
 
 void LibraryComponent::goUp()
@@ -207,13 +659,8 @@ void LibraryComponent::addCurrentToFavorites()
 
 void LibraryComponent::loadFavorites()
 {
-    juce::PropertiesFile::Options opts;
-    opts.applicationName     = "Waive";
-    opts.filenameSuffix       = ".settings";
-    opts.osxLibrarySubFolder = "Application Support/Waive";
-
     juce::ApplicationProperties props;
-    props.setStorageParameters (opts);
+    props.setStorageParameters (getSettingsOptions());
 
     if (auto* settings = props.getUserSettings())
     {
@@ -232,13 +679,8 @@ void LibraryComponent::loadFavorites()
 
 void LibraryComponent::saveFavorites()
 {
-    juce::PropertiesFile::Options opts;
-    opts.applicationName     = "Waive";
-    opts.filenameSuffix       = ".settings";
-    opts.osxLibrarySubFolder = "Application Support/Waive";
-
     juce::ApplicationProperties props;
-    props.setStorageParameters (opts);
+    props.setStorageParameters (getSettingsOptions());
 
     if (auto* settings = props.getUserSettings())
     {
@@ -247,6 +689,75 @@ void LibraryComponent::saveFavorites()
     }
 }
 
+void LibraryComponent::showImportOptionsMenu()
+{
+    const auto options = mediaImporter.getOptions();
+
+    juce::PopupMenu rateMenu;
+    for (int i = 0; i < (int) std::size (importSampleRates); ++i)
+    {
+        const auto rate = importSampleRates[i];
+        rateMenu.addItem (importMenuSampleRateBase + i,
+                          rate > 0.0 ? juce::String (rate / 1000.0, 1) + " kHz" : juce::String ("Keep Source Rate"),
+                          true, std::abs (options.targetSampleRate - rate) < 0.5);
+    }
+
+    juce::PopupMenu menu;
+    menu.addItem (importMenuOneTrackPerFile, "One Track per File", true, options.oneTrackPerFile);
+    menu.addItem (importMenuCopyIntoProject, "Copy into Project", true, options.copyIntoProject);
+    menu.addSubMenu ("Convert Sample Rate", rateMenu);
+
+    juce::Component::SafePointer<LibraryComponent> safeThis (this);
+
+    menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (&importOptionsButton), [safeThis] (int result)
+    {
+        if (! safeThis || result == 0)
+            return;
+
+        auto updated = safeThis->mediaImporter.getOptions();
+
+        if (result == importMenuOneTrackPerFile)
+            updated.oneTrackPerFile = ! updated.oneTrackPerFile;
+        else if (result == importMenuCopyIntoProject)
+            updated.copyIntoProject = ! updated.copyIntoProject;
+        else if (juce::isPositiveAndBelow (result - importMenuSampleRateBase, (int) std::size (importSampleRates)))
+            updated.targetSampleRate = importSampleRates[result - importMenuSampleRateBase];
+
+        safeThis->setImportOptions (updated);
+    });
+}
+
+void LibraryComponent::loadImportOptions()
+{
+    juce::ApplicationProperties props;
+    props.setStorageParameters (getSettingsOptions());
+
+    if (auto* settings = props.getUserSettings())
+    {
+        waive::MediaImportOptions options;
+        options.oneTrackPerFile = settings->getBoolValue ("importOneTrackPerFile", false);
+        options.copyIntoProject = settings->getBoolValue ("importCopyIntoProject", false);
+        options.targetSampleRate = juce::jmax (0.0, settings->getDoubleValue ("importTargetSampleRate", 0.0));
+        mediaImporter.setOptions (options);
+    }
+}
+
+void LibraryComponent::setImportOptions (const waive::MediaImportOptions& options)
+{
+    mediaImporter.setOptions (options);
+
+    juce::ApplicationProperties props;
+    props.setStorageParameters (getSettingsOptions());
+
+    if (auto* settings = props.getUserSettings())
+    {
+        settings->setValue ("importOneTrackPerFile", options.oneTrackPerFile);
+        settings->setValue ("importCopyIntoProject", options.copyIntoProject);
+        settings->setValue ("importTargetSampleRate", options.targetSampleRate);
+        settings->saveIfNeeded();
+    }
+}
+
 void LibraryComponent::refreshTargetTrackList()
 {
     auto selectedTrackName = targetTrackCombo.getText();
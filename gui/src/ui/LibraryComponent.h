@@ -2,14 +2,32 @@
 
 #include <JuceHeader.h>
 #include "../edit/EditSession.h"
+#include "../library/MediaImporter.h"
+#include "../library/SampleLibraryIndex.h"
+#include "../library/SamplePreviewPlayer.h"
 
 //==============================================================================
-/** File browser for audio files. Double-click inserts a clip on the selected target track. */
+/** File browser for audio files. Double-click inserts a clip on the selected
+    target track; the file is read in the background, so the clip lands a
+    moment later.
+
+    Typing in the search box swaps the tree for results from the sample
+    library index, which the Index button extends with the current folder.
+    The selected file can be auditioned from the preview strip, which also
+    scrubs when clicked or dragged. The Options menu sets how the importer
+    places, copies and converts files; the choices persist in the app
+    settings. */
 class LibraryComponent : public juce::Component,
-                         public juce::FileBrowserListener
+                         public juce::FileBrowserListener,
+                         private juce::ListBoxModel,
+                         private juce::ChangeListener,
+                         private juce::Timer,
+                         private waive::MediaImporter::Listener
 {
 public:
-    explicit LibraryComponent (EditSession& session);
+    /** Double-clicked files go through sharedImporter when one is given, so
+        the timeline draws their placeholders and reports their errors. */
+    explicit LibraryComponent (EditSession& session, waive::MediaImporter* sharedImporter = nullptr);
     ~LibraryComponent() override;
 
     void paint (juce::Graphics& g) override;
@@ -17,22 +35,69 @@ public:
     bool selectTargetTrackForTesting (int trackIndex);
     int getSelectedTargetTrackIndexForTesting() const;
 
+    /** Swaps in an index backed by databaseFile, for tests that must not touch the user's library. */
+    void setIndexDatabaseForTesting (const juce::File& databaseFile);
+    waive::SampleLibraryIndex& getIndexForTesting();
+    void setSearchTextForTesting (const juce::String& text);
+    const std::vector<waive::SampleLibraryEntry>& getSearchResultsForTesting() const;
+    bool isShowingSearchResultsForTesting() const;
+
+    void selectPreviewFileForTesting (const juce::File& file);
+    bool togglePreviewForTesting();
+    waive::SamplePreviewPlayer& getPreviewPlayerForTesting();
+    waive::MediaImporter& getMediaImporterForTesting();
+
+    /** Applies and saves options as the Options menu would. */
+    void setImportOptionsForTesting (const waive::MediaImportOptions& options);
+
     // FileBrowserListener
-    void selectionChanged() override {}
+    void selectionChanged() override;
     void fileClicked (const juce::File&, const juce::MouseEvent&) override {}
     void fileDoubleClicked (const juce::File& file) override;
     void browserRootChanged (const juce::File&) override {}
 
 private:
+    // ListBoxModel
+    int getNumRows() override;
+    void paintListBoxItem (int row, juce::Graphics& g, int width, int height, bool rowIsSelected) override;
+    void listBoxItemDoubleClicked (int row, const juce::MouseEvent&) override;
+    juce::var getDragSourceDescription (const juce::SparseSet<int>& rows) override;
+    void selectedRowsChanged (int lastRowSelected) override;
+
+    // ChangeListener
+    void changeListenerCallback (juce::ChangeBroadcaster*) override;
+
+    // Timer
+    void timerCallback() override;
+
+    // MediaImporter::Listener
+    void importFinished (int numImported, const juce::StringArray& errors) override;
+
+    void setIndex (std::unique_ptr<waive::SampleLibraryIndex> newIndex);
+    void indexCurrentDirectory();
+    void updateSearchResults();
+    void updateIndexStatus();
+
+    struct PreviewStrip;
+    void setPreviewFile (const juce::File& file);
+    void togglePreview();
+    void previewFrom (double seconds);
+    void updatePreviewButton();
+
     void goUp();
     void setRoot (const juce::File& dir);
     void addCurrentToFavorites();
     void loadFavorites();
     void saveFavorites();
+    void showImportOptionsMenu();
+    void loadImportOptions();
+    void setImportOptions (const waive::MediaImportOptions& options);
     void refreshTargetTrackList();
     tracktion::engine::AudioTrack* getTargetTrack() const;
 
     EditSession& editSession;
+    std::unique_ptr<waive::MediaImporter> ownedMediaImporter;
+    waive::MediaImporter& mediaImporter;
 
     juce::TimeSliceThread scanThread { "LibraryScan" };
     juce::WildcardFileFilter fileFilter;
@@ -41,9 +106,23 @@ private:
 
     juce::Label targetTrackLabel;
     juce::ComboBox targetTrackCombo;
+    juce::TextButton importOptionsButton;
     juce::ComboBox favoritesCombo;
     juce::TextButton addFavButton;
     juce::TextButton goUpButton;
 
     juce::StringArray favoritesPaths;
+
+    std::unique_ptr<waive::SampleLibraryIndex> libraryIndex;
+    std::vector<waive::SampleLibraryEntry> searchResults;
+    juce::TextEditor searchBox;
+    juce::TextButton indexButton;
+    juce::Label indexStatusLabel;
+    juce::ListBox resultsList;
+
+    waive::SamplePreviewPlayer previewPlayer;
+    juce::File previewFile;
+    std::unique_ptr<PreviewStrip> previewStrip;
+    juce::TextButton previewButton;
+    juce::ToggleButton autoPreviewToggle;
 };
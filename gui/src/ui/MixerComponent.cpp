@@ -127,6 +127,17 @@ void MixerComponent::editChanged()
     rebuildStrips();
 }
 
+void MixerComponent::bulkEditStarted()
+{
+    stopTimer();
+}
+
+void MixerComponent::bulkEditFinished()
+{
+    timerCallback();
+    startTimerHz (30);
+}
+
 void MixerComponent::rebuildStrips()
 {
     strips.clear();
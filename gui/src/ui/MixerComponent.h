@@ -30,6 +30,8 @@ public:
 private:
     void editAboutToChange() override;
     void editChanged() override;
+    void bulkEditStarted() override;
+    void bulkEditFinished() override;
     void timerCallback() override;
     void rebuildStrips();
     void applyTrackHighlights();
@@ -2,6 +2,8 @@
 #include "EditSession.h"
 #include "UndoableCommandHandler.h"
 #include "PathSanitizer.h"
+#include "RenderEncoder.h"
+#include "RenderScheduler.h"
 #include "WaiveSpacing.h"
 #include "WaiveLookAndFeel.h"
 #include "UiMessageHelpers.h"
@@ -23,28 +25,6 @@ void showRenderValidationError (juce::Component* parent, const juce::String& tit
                                     parent);
 }
 
-std::unique_ptr<te::Edit> createSnapshotEditForRender (te::Engine& engine,
-                                                       const juce::ValueTree& state,
-                                                       const juce::File& editFile)
-{
-    auto projectItemId = te::ProjectItemID::fromProperty (state, te::IDs::projectID);
-    if (! projectItemId.isValid())
-        projectItemId = te::ProjectItemID::createNewID (0);
-
-    return te::Edit::createEdit (te::Edit::Options
-    {
-        engine,
-        state.createCopy(),
-        projectItemId,
-        te::Edit::forEditing,
-        nullptr,
-        te::Edit::getDefaultNumUndoLevels(),
-        [editFile] { return editFile; },
-        {},
-        0
-    });
-}
-
 double getProjectSampleRate (te::Edit& edit)
 {
     if (auto* device = edit.engine.getDeviceManager().deviceManager.getCurrentAudioDevice())
@@ -53,6 +33,16 @@ double getProjectSampleRate (te::Edit& edit)
     return edit.engine.getDeviceManager().getSampleRate();
 }
 
+juce::String getExtensionForFormat (int formatId)
+{
+    switch (formatId)
+    {
+        case 2: return ".flac";
+        case 3: return ".ogg";
+        default: return ".wav";
+    }
+}
+
 juce::String sanitiseStemFileComponent (const juce::String& name)
 {
     auto safe = name.replaceCharacters ("\\/:*?\"<>|", "________").trim();
@@ -60,100 +50,41 @@ juce::String sanitiseStemFileComponent (const juce::String& name)
     return safe.isEmpty() ? "Track" : safe;
 }
 
-bool normaliseRenderedFile (const juce::File& targetFile,
-                            int formatId,
-                            double sampleRate,
-                            int bitDepth,
-                            double oggQuality,
-                            double normalizeLevelDb)
+juce::String formatSeconds (double seconds)
 {
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-
-    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (targetFile));
-    if (reader == nullptr)
-        return false;
-
-    constexpr int blockSize = 8192;
-    juce::AudioBuffer<float> buffer ((int) reader->numChannels, blockSize);
-    float maxPeak = 0.0f;
-
-    for (juce::int64 pos = 0; pos < reader->lengthInSamples; pos += blockSize)
-    {
-        auto numToRead = juce::jmin (blockSize, (int) (reader->lengthInSamples - pos));
-        reader->read (&buffer, 0, numToRead, pos, true, true);
-
-        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-            maxPeak = juce::jmax (maxPeak, buffer.getMagnitude (ch, 0, numToRead));
-    }
-
-    if (maxPeak <= 0.0001f)
-        return true;
-
-    const float targetLevel = juce::Decibels::decibelsToGain ((float) normalizeLevelDb);
-    const float gain = targetLevel / maxPeak;
-
-    reader.reset (formatManager.createReaderFor (targetFile));
-    if (reader == nullptr)
-        return false;
-
-    const auto tempFile = targetFile.getSiblingFile (targetFile.getFileNameWithoutExtension()
-                                                     + "_temp"
-                                                     + targetFile.getFileExtension());
-
-    std::unique_ptr<juce::AudioFormat> writeFormat;
-    switch (formatId)
-    {
-        case 1: writeFormat = std::make_unique<juce::WavAudioFormat>(); break;
-        case 2: writeFormat = std::make_unique<juce::FlacAudioFormat>(); break;
-        case 3: writeFormat = std::make_unique<juce::OggVorbisAudioFormat>(); break;
-        default: writeFormat = std::make_unique<juce::WavAudioFormat>(); break;
-    }
-
-    auto outStream = std::make_unique<juce::FileOutputStream> (tempFile);
-    if (! outStream->openedOk())
-        return false;
-
-    JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Wdeprecated-declarations")
-    std::unique_ptr<juce::AudioFormatWriter> writer (writeFormat->createWriterFor (
-        outStream.release(), sampleRate, reader->numChannels, bitDepth,
-        reader->metadataValues, (formatId == 3) ? (int) (oggQuality * 10) : 0));
-    JUCE_END_IGNORE_WARNINGS_GCC_LIKE
-
-    if (writer == nullptr)
-        return false;
-
-    for (juce::int64 pos = 0; pos < reader->lengthInSamples; pos += blockSize)
-    {
-        auto numToRead = juce::jmin (blockSize, (int) (reader->lengthInSamples - pos));
-        reader->read (&buffer, 0, numToRead, pos, true, true);
-        buffer.applyGain (0, numToRead, gain);
-        writer->writeFromAudioSampleBuffer (buffer, 0, numToRead);
-    }
-
-    writer.reset();
-    reader.reset();
+    return juce::String (seconds, 2).trimCharactersAtEnd ("0").trimCharactersAtEnd (".");
+}
 
-    if (targetFile.existsAsFile() && ! targetFile.deleteFile())
-    {
-        tempFile.deleteFile();
-        return false;
-    }
+/** Parses "start-end" pairs in seconds separated by commas, e.g. "0-30, 60-90". */
+std::optional<std::vector<te::TimeRange>> parseExtraRanges (const juce::String& text)
+{
+    std::vector<te::TimeRange> ranges;
 
-    if (! tempFile.moveFileTo (targetFile))
+    for (auto token : juce::StringArray::fromTokens (text, ",", {}))
     {
-        tempFile.deleteFile();
-        return false;
+        token = token.trim();
+        if (token.isEmpty())
+            continue;
+
+        const auto start = token.upToFirstOccurrenceOf ("-", false, false).trim();
+        const auto end = token.fromFirstOccurrenceOf ("-", false, false).trim();
+        if (! token.containsChar ('-') || ! start.containsOnly ("0123456789.") || ! end.containsOnly ("0123456789.")
+            || start.isEmpty() || end.isEmpty() || end.getDoubleValue() <= start.getDoubleValue())
+            return std::nullopt;
+
+        ranges.push_back (te::TimeRange (te::TimePosition::fromSeconds (start.getDoubleValue()),
+                                         te::TimePosition::fromSeconds (end.getDoubleValue())));
     }
 
-    return true;
+    return ranges;
 }
 
 }
 
 //==============================================================================
-RenderDialog::RenderDialog (EditSession& session, UndoableCommandHandler& handler)
-    : editSession (session), commandHandler (handler), progressBar (progressValue)
+RenderDialog::RenderDialog (EditSession& session, UndoableCommandHandler& handler,
+                            waive::RenderScheduler& scheduler)
+    : editSession (session), commandHandler (handler), renderScheduler (scheduler), progressBar (progressValue)
 {
     setTitle ("Render Dialog");
     setDescription ("Configure audio export settings and render the current project");
@@ -174,6 +105,23 @@ RenderDialog::RenderDialog (EditSession& session, UndoableCommandHandler& handle
     formatCombo.setWantsKeyboardFocus (true);
     addAndMakeVisible (formatCombo);
 
+    // Extra formats
+    extraFormatsLabel.setText ("Also Encode:", juce::dontSendNotification);
+    extraFormatsLabel.setTitle ("Also Encode Label");
+    addAndMakeVisible (extraFormatsLabel);
+
+    for (auto [toggle, name] : { std::pair { &extraWavToggle, "WAV" },
+                                 std::pair { &extraFlacToggle, "FLAC" },
+                                 std::pair { &extraOggToggle, "OGG" } })
+    {
+        toggle->setButtonText (name);
+        toggle->setTitle ("Also Encode " + juce::String (name));
+        toggle->setDescription ("Also encode the render as " + juce::String (name) + " without rendering again");
+        toggle->setTooltip ("Encode an extra " + juce::String (name) + " file from the same render");
+        toggle->setWantsKeyboardFocus (true);
+        addAndMakeVisible (*toggle);
+    }
+
     // Sample rate
     sampleRateLabel.setText ("Sample Rate:", juce::dontSendNotification);
     sampleRateLabel.setTitle ("Sample Rate Label");
@@ -276,13 +224,33 @@ RenderDialog::RenderDialog (EditSession& session, UndoableCommandHandler& handle
     endLabel.setVisible (false);
     endEditor.setVisible (false);
 
+    // Extra ranges
+    extraRangesLabel.setText ("Extra Ranges:", juce::dontSendNotification);
+    extraRangesLabel.setTitle ("Extra Ranges Label");
+    addAndMakeVisible (extraRangesLabel);
+
+    extraRangesEditor.setTextToShowWhenEmpty ("e.g. 0-30, 60-90", juce::Colours::grey);
+    extraRangesEditor.setTitle ("Extra Ranges");
+    extraRangesEditor.setDescription ("Further ranges in seconds to render in the same batch");
+    extraRangesEditor.setTooltip ("Comma-separated start-end pairs in seconds; each is rendered as its own file");
+    extraRangesEditor.setWantsKeyboardFocus (true);
+    addAndMakeVisible (extraRangesEditor);
+
     // Normalize
-    normalizeToggle.setButtonText ("Normalize to -0.1 dBFS");
-    normalizeToggle.setTitle ("Normalize Output");
-    normalizeToggle.setDescription ("Normalize rendered audio to minus 0.1 dBFS");
-    normalizeToggle.setTooltip ("Normalize rendered audio");
-    normalizeToggle.setWantsKeyboardFocus (true);
-    addAndMakeVisible (normalizeToggle);
+    normalizeLabel.setText ("Normalize:", juce::dontSendNotification);
+    normalizeLabel.setTitle ("Normalize Label");
+    addAndMakeVisible (normalizeLabel);
+
+    normalizeCombo.addItem ("Off", 1);
+    normalizeCombo.addItem ("Peak -0.1 dBFS", 2);
+    normalizeCombo.addItem ("Loudness -14 LUFS (streaming)", 3);
+    normalizeCombo.addItem ("Loudness -23 LUFS (broadcast)", 4);
+    normalizeCombo.setSelectedId (1);
+    normalizeCombo.setTitle ("Normalize Output");
+    normalizeCombo.setDescription ("Normalize rendered audio by sample peak or by integrated loudness");
+    normalizeCombo.setTooltip ("Loudness modes keep true peak at or below -1 dBTP");
+    normalizeCombo.setWantsKeyboardFocus (true);
+    addAndMakeVisible (normalizeCombo);
 
     // Mixdown vs stems
     mixdownToggle.setButtonText ("Mixdown (single file)");
@@ -304,6 +272,13 @@ RenderDialog::RenderDialog (EditSession& session, UndoableCommandHandler& handle
     addAndMakeVisible (stemsToggle);
     mixdownToggle.onClick = [this] { updateOutputMode(); };
 
+    alternateMixesToggle.setButtonText ("Alternate mixes (one per muted track)");
+    alternateMixesToggle.setTitle ("Alternate Mixes");
+    alternateMixesToggle.setDescription ("Also render the mixdown once with each track muted");
+    alternateMixesToggle.setTooltip ("Render an extra mix without each track, e.g. an instrumental");
+    alternateMixesToggle.setWantsKeyboardFocus (true);
+    addAndMakeVisible (alternateMixesToggle);
+
     // Output path
     outputPathLabel.setText ("Output:", juce::dontSendNotification);
     outputPathLabel.setTitle ("Output Path Label");
@@ -341,13 +316,28 @@ RenderDialog::RenderDialog (EditSession& session, UndoableCommandHandler& handle
 
     updateFormatOptions();
     updateOutputMode();
-    setSize (600, 520);
+    setSize (600, 628);
+
+    renderScheduler.addListener (this);
 }
 
 RenderDialog::~RenderDialog()
 {
-    if (renderThread.joinable())
-        renderThread.join();
+    renderScheduler.removeListener (this);
+
+    // Renders still queued or running clean up after themselves; masters
+    // that already finished are ours to delete.
+    if (activeBatchId.isNotEmpty())
+    {
+        renderScheduler.cancelBatch (activeBatchId);
+
+        for (const auto& output : activeOutputs)
+            output.master.deleteFile();
+    }
+
+    encodeCancelled = true;
+    if (encodeThread.joinable())
+        encodeThread.join();
 }
 
 int RenderDialog::getSelectedFormatForTesting() const
@@ -410,6 +400,33 @@ void RenderDialog::setStemsModeForTesting (bool shouldRenderStems)
         (shouldRenderStems ? stemsToggle : mixdownToggle).triggerClick();
 }
 
+void RenderDialog::setExtraFormatForTesting (int formatId, bool shouldEncode)
+{
+    auto* toggle = getExtraFormatToggle (formatId);
+    if (toggle->isEnabled())
+        toggle->setToggleState (shouldEncode, juce::dontSendNotification);
+}
+
+bool RenderDialog::isExtraFormatEnabledForTesting (int formatId) const
+{
+    switch (formatId)
+    {
+        case 2: return extraFlacToggle.isEnabled();
+        case 3: return extraOggToggle.isEnabled();
+        default: return extraWavToggle.isEnabled();
+    }
+}
+
+int RenderDialog::getSelectedNormalizationForTesting() const
+{
+    return normalizeCombo.getSelectedId();
+}
+
+void RenderDialog::selectNormalizationForTesting (int normalizationId)
+{
+    normalizeCombo.setSelectedId (normalizationId, juce::sendNotificationSync);
+}
+
 juce::String RenderDialog::getOutputPathForTesting() const
 {
     return outputPathEditor.getText();
@@ -420,6 +437,32 @@ juce::String RenderDialog::getOutputLabelTextForTesting() const
     return outputPathLabel.getText();
 }
 
+void RenderDialog::setOutputPathForTesting (const juce::String& path)
+{
+    outputPathEditor.setText (path, juce::dontSendNotification);
+}
+
+void RenderDialog::setExtraRangesForTesting (const juce::String& ranges)
+{
+    extraRangesEditor.setText (ranges, juce::dontSendNotification);
+}
+
+void RenderDialog::setAlternateMixesForTesting (bool shouldRenderAlternateMixes)
+{
+    alternateMixesToggle.setToggleState (shouldRenderAlternateMixes, juce::dontSendNotification);
+}
+
+juce::StringArray RenderDialog::getPlannedOutputNamesForTesting() const
+{
+    juce::StringArray names;
+
+    if (pendingRenderData.has_value())
+        for (const auto& output : planOutputs (*pendingRenderData))
+            names.add (output.baseFile.getFileName());
+
+    return names;
+}
+
 void RenderDialog::resized()
 {
     auto bounds = getLocalBounds().reduced (waive::Spacing::md);
@@ -437,6 +480,15 @@ void RenderDialog::resized()
     formatRow.removeFromLeft (waive::Spacing::sm);
     formatCombo.setBounds (formatRow);
 
+    // Extra formats
+    auto extraRow = row (waive::Spacing::controlHeightDefault);
+    extraFormatsLabel.setBounds (extraRow.removeFromLeft (120));
+    extraRow.removeFromLeft (waive::Spacing::sm);
+    const auto toggleWidth = extraRow.getWidth() / 3;
+    extraWavToggle.setBounds (extraRow.removeFromLeft (toggleWidth));
+    extraFlacToggle.setBounds (extraRow.removeFromLeft (toggleWidth));
+    extraOggToggle.setBounds (extraRow);
+
     // Sample rate
     auto srRow = row (waive::Spacing::controlHeightDefault);
     sampleRateLabel.setBounds (srRow.removeFromLeft (120));
@@ -472,13 +524,22 @@ void RenderDialog::resized()
     endRow.removeFromLeft (waive::Spacing::sm);
     endEditor.setBounds (endRow);
 
+    // Extra ranges
+    auto extraRangesRow = row (waive::Spacing::controlHeightDefault);
+    extraRangesLabel.setBounds (extraRangesRow.removeFromLeft (120));
+    extraRangesRow.removeFromLeft (waive::Spacing::sm);
+    extraRangesEditor.setBounds (extraRangesRow);
+
     // Normalize
-    row (waive::Spacing::controlHeightDefault).removeFromLeft (120); // spacer
-    normalizeToggle.setBounds (row (waive::Spacing::controlHeightDefault));
+    auto normalizeRow = row (waive::Spacing::controlHeightDefault);
+    normalizeLabel.setBounds (normalizeRow.removeFromLeft (120));
+    normalizeRow.removeFromLeft (waive::Spacing::sm);
+    normalizeCombo.setBounds (normalizeRow);
 
     // Mixdown/stems
     mixdownToggle.setBounds (row (waive::Spacing::controlHeightDefault));
     stemsToggle.setBounds (row (waive::Spacing::controlHeightDefault));
+    alternateMixesToggle.setBounds (row (waive::Spacing::controlHeightDefault));
 
     // Output path
     auto pathRow = row (waive::Spacing::controlHeightDefault);
@@ -527,11 +588,32 @@ void RenderDialog::updateFormatOptions()
 
     oggQualityLabel.setVisible (isOgg);
     oggQualitySlider.setVisible (isOgg);
+
+    // The primary format is always encoded; only the others are extras.
+    for (int formatId = 1; formatId <= 3; ++formatId)
+    {
+        auto* toggle = getExtraFormatToggle (formatId);
+        const bool isPrimary = formatId == formatCombo.getSelectedId();
+        toggle->setEnabled (! isPrimary && ! rendering);
+        if (isPrimary)
+            toggle->setToggleState (false, juce::dontSendNotification);
+    }
+}
+
+juce::ToggleButton* RenderDialog::getExtraFormatToggle (int formatId)
+{
+    switch (formatId)
+    {
+        case 2: return &extraFlacToggle;
+        case 3: return &extraOggToggle;
+        default: return &extraWavToggle;
+    }
 }
 
 void RenderDialog::updateOutputMode()
 {
     const bool stemsMode = stemsToggle.getToggleState();
+    alternateMixesToggle.setEnabled (! stemsMode && ! rendering);
     outputPathLabel.setText (stemsMode ? "Output Dir:" : "Output:", juce::dontSendNotification);
 
     auto currentPath = outputPathEditor.getText().trim();
@@ -678,6 +760,15 @@ bool RenderDialog::prepareRenderData()
         range = te::TimeRange (te::TimePosition::fromSeconds (start), te::TimePosition::fromSeconds (end));
     }
 
+    auto extraRanges = parseExtraRanges (extraRangesEditor.getText());
+    if (! extraRanges.has_value())
+    {
+        showRenderValidationError (this,
+                                   "Invalid Extra Ranges",
+                                   "Enter extra ranges as start-end pairs in seconds, separated by commas (e.g. 0-30, 60-90).");
+        return false;
+    }
+
     // Track mask using consistent indexing
     juce::BigInteger tracksMask;
     auto tracks = te::getAudioTracks (edit);
@@ -685,231 +776,319 @@ bool RenderDialog::prepareRenderData()
         tracksMask.setBit (tracks[i]->getIndexInEditTrackList());
 
     // Mixdown vs stems
-    bool normalize = normalizeToggle.getToggleState();
-    double normalizeLevel = -0.1; // -0.1 dBFS
-
-    pendingRenderData = RenderData { formatId, sampleRate, bitDepth, oggQuality,
-                                     range.getStart().inSeconds(), range.getEnd().inSeconds(), tracksMask,
-                                     doStems, outputTarget, normalize, normalizeLevel,
-                                     edit.state.createCopy(),
-                                     te::EditFileOperations (edit).getEditFile(),
-                                     &edit.engine };
+    const auto normalizeId = normalizeCombo.getSelectedId();
+    const bool normalize = normalizeId > 1;
+    const bool normalizeToLoudness = normalizeId >= 3;
+    const double normalizeLevel = normalizeId == 3 ? -14.0 : (normalizeId == 4 ? -23.0 : -0.1);
+
+    juce::Array<int> extraFormatIds;
+    for (int extraId = 1; extraId <= 3; ++extraId)
+        if (extraId != formatId && getExtraFormatToggle (extraId)->getToggleState())
+            extraFormatIds.add (extraId);
+
+    RenderData data;
+    data.formatId = formatId;
+    data.extraFormatIds = extraFormatIds;
+    data.sampleRate = sampleRate;
+    data.bitDepth = bitDepth;
+    data.oggQuality = oggQuality;
+    data.rangeStartSeconds = range.getStart().inSeconds();
+    data.rangeEndSeconds = range.getEnd().inSeconds();
+    data.extraRanges = std::move (*extraRanges);
+    data.tracksMask = tracksMask;
+    data.doStems = doStems;
+    data.alternateMixes = ! doStems && alternateMixesToggle.getToggleState();
+    data.outputFile = outputTarget;
+    data.normalize = normalize;
+    data.normalizeToLoudness = normalizeToLoudness;
+    data.normalizeLevel = normalizeLevel;
+    edit.flushState(); // plugins only write their state back on a flush
+    data.editState = edit.state.createCopy();
+    data.editFile = te::EditFileOperations (edit).getEditFile();
+    data.enginePtr = &edit.engine;
+
+    for (auto* track : tracks)
+        data.audioTracks.emplace_back (track->getIndexInEditTrackList(), track->getName());
+
+    pendingRenderData = std::move (data);
     return true;
 }
 
+std::vector<RenderDialog::PlannedOutput> RenderDialog::planOutputs (const RenderData& data)
+{
+    std::vector<te::TimeRange> ranges { te::TimeRange (te::TimePosition::fromSeconds (data.rangeStartSeconds),
+                                                       te::TimePosition::fromSeconds (data.rangeEndSeconds)) };
+    ranges.insert (ranges.end(), data.extraRanges.begin(), data.extraRanges.end());
+
+    std::vector<PlannedOutput> outputs;
+
+    for (size_t r = 0; r < ranges.size(); ++r)
+    {
+        const auto& range = ranges[r];
+        const auto rangeSuffix = r == 0 ? juce::String()
+                                        : "_" + formatSeconds (range.getStart().inSeconds())
+                                              + "-" + formatSeconds (range.getEnd().inSeconds()) + "s";
+
+        if (data.doStems)
+        {
+            for (size_t i = 0; i < data.audioTracks.size(); ++i)
+            {
+                juce::BigInteger singleMask;
+                singleMask.setBit (data.audioTracks[i].first);
+
+                const auto name = juce::String::formatted ("%02d_%s", (int) i + 1,
+                                                           sanitiseStemFileComponent (data.audioTracks[i].second).toRawUTF8());
+                outputs.push_back ({ data.outputFile.getChildFile (name + rangeSuffix), range, singleMask, {} });
+            }
+
+            continue;
+        }
+
+        const auto mixBase = data.outputFile.withFileExtension ("");
+        outputs.push_back ({ mixBase.getSiblingFile (mixBase.getFileName() + rangeSuffix), range, data.tracksMask, {} });
+
+        if (data.alternateMixes && data.audioTracks.size() > 1)
+        {
+            for (const auto& [trackIndex, trackName] : data.audioTracks)
+            {
+                auto mask = data.tracksMask;
+                mask.clearBit (trackIndex);
+
+                outputs.push_back ({ mixBase.getSiblingFile (mixBase.getFileName() + rangeSuffix + "_without_"
+                                                             + sanitiseStemFileComponent (trackName)),
+                                     range, mask, {} });
+            }
+        }
+    }
+
+    return outputs;
+}
+
+void RenderDialog::setControlsEnabled (bool enabled)
+{
+    formatCombo.setEnabled (enabled);
+    sampleRateCombo.setEnabled (enabled);
+    bitDepthCombo.setEnabled (enabled);
+    oggQualitySlider.setEnabled (enabled);
+    rangeCombo.setEnabled (enabled);
+    startEditor.setEnabled (enabled);
+    endEditor.setEnabled (enabled);
+    extraRangesEditor.setEnabled (enabled);
+    normalizeCombo.setEnabled (enabled);
+    mixdownToggle.setEnabled (enabled);
+    stemsToggle.setEnabled (enabled);
+    outputPathEditor.setEnabled (enabled);
+    browseButton.setEnabled (enabled);
+    alternateMixesToggle.setEnabled (enabled && ! stemsToggle.getToggleState());
+    updateFormatOptions();
+}
+
 void RenderDialog::performRender()
 {
+    if (rendering)
+    {
+        cancelRender();
+        return;
+    }
+
     if (! prepareRenderData())
         return;
 
     rendering = true;
-    progressValue = -1.0;
-    renderButton.setEnabled (false);
-    formatCombo.setEnabled (false);
-    sampleRateCombo.setEnabled (false);
-    bitDepthCombo.setEnabled (false);
-    oggQualitySlider.setEnabled (false);
-    rangeCombo.setEnabled (false);
-    startEditor.setEnabled (false);
-    endEditor.setEnabled (false);
-    normalizeToggle.setEnabled (false);
-    mixdownToggle.setEnabled (false);
-    stemsToggle.setEnabled (false);
-    outputPathEditor.setEnabled (false);
-    browseButton.setEnabled (false);
+    cancelRequested = false;
+    encodeCancelled = false;
+    setControlsEnabled (false);
+    renderButton.setButtonText ("Cancel");
+    progressValue = 0.0;
     progressBar.setVisible (true);
 
-    auto data = *pendingRenderData;
+    activeRenderData = std::move (pendingRenderData);
     pendingRenderData.reset();
 
-    if (renderThread.joinable())
-        renderThread.join();
+    if (encodeThread.joinable())
+        encodeThread.join();
+
+    // Each output is rendered once to a float master on the scheduler; every
+    // requested format is then encoded from that master.
+    activeOutputs = planOutputs (*activeRenderData);
+    activeBatchId = renderScheduler.createBatch();
+
+    for (auto& output : activeOutputs)
+    {
+        output.master = juce::File::createTempFile (".wav");
+
+        waive::RenderScheduler::Request request;
+        request.editState = activeRenderData->editState;
+        request.editFile = activeRenderData->editFile;
+        request.destFile = output.master;
+        request.range = output.range;
+        request.tracksMask = output.tracksMask;
+        request.bitDepth = 32;  // float master; encoders quantise
+        request.sampleRate = activeRenderData->sampleRate;
+        request.batchId = activeBatchId;
+        renderScheduler.enqueue (std::move (request));
+    }
+}
+
+void RenderDialog::cancelRender()
+{
+    if (cancelRequested)
+        return;
+
+    cancelRequested = true;
+    encodeCancelled = true;
+    renderButton.setButtonText ("Cancelling...");
+    renderButton.setEnabled (false);
+
+    // Once encoding has started the batch is gone and the encode thread
+    // stops between outputs.
+    if (activeBatchId.isNotEmpty())
+        renderScheduler.cancelBatch (activeBatchId);
+}
+
+void RenderDialog::renderFinished (const juce::String&, const juce::String& batchId)
+{
+    if (batchId.isEmpty() || batchId != activeBatchId)
+        return;
+
+    // A cancelled batch is forgotten by the scheduler once it settles.
+    const auto status = renderScheduler.getBatchStatus (batchId);
+    const auto total = (int) status["total"];
+    const auto finished = (int) status["completed"] + (int) status["failed"];
+
+    if (! status.isVoid() && finished < total)
+    {
+        progressValue = total > 0 ? (double) finished / (double) total : 0.0;
+        return;
+    }
+
+    activeBatchId.clear();
+
+    if (cancelRequested || status["status"].toString() != "done")
+    {
+        for (const auto& output : activeOutputs)
+            output.master.deleteFile();
+
+        finishRender (false, cancelRequested ? juce::String() : "Failed to render audio.");
+        return;
+    }
+
+    encodeOutputs();
+}
+
+void RenderDialog::encodeOutputs()
+{
+    progressValue = -1.0;
 
     auto safeThis = juce::Component::SafePointer<RenderDialog> (this);
-    renderThread = std::thread ([safeThis, data]() mutable
+    encodeThread = std::thread ([safeThis, this, data = *activeRenderData, outputs = activeOutputs]
     {
-        auto snapshotEdit = createSnapshotEditForRender (*data.enginePtr, data.editState, data.editFile);
-        if (snapshotEdit == nullptr)
+        juce::Array<int> formatIds { data.formatId };
+        formatIds.addArray (data.extraFormatIds);
+
+        waive::RenderEncoder::Normalisation normalisation;
+        if (data.normalize)
         {
-            juce::MessageManager::callAsync ([safeThis]
-            {
-                if (safeThis == nullptr)
-                    return;
-
-                safeThis->progressValue = 0.0;
-                safeThis->progressBar.setVisible (false);
-                waive::showMessageBoxAsyncSafe (juce::AlertWindow::WarningIcon,
-                                                "Render Failed",
-                                                "Failed to create a render snapshot.");
-                safeThis->resetControls();
-            });
-            return;
+            normalisation.mode = data.normalizeToLoudness ? waive::RenderEncoder::Normalisation::Mode::loudness
+                                                          : waive::RenderEncoder::Normalisation::Mode::peak;
+            normalisation.targetDb = data.normalizeLevel;
         }
 
-        auto& editRef = *snapshotEdit;
-        bool success = false;
+        bool success = true;
         juce::Array<juce::File> renderedFiles;
+        std::optional<waive::LoudnessMeter::Result> mixLoudness;
 
-        // Create AudioFormat pointer
-        std::unique_ptr<juce::AudioFormat> format;
-        switch (data.formatId)
-        {
-            case 1: format = std::make_unique<juce::WavAudioFormat>(); break;
-            case 2: format = std::make_unique<juce::FlacAudioFormat>(); break;
-            case 3: format = std::make_unique<juce::OggVorbisAudioFormat>(); break;
-            default: format = std::make_unique<juce::WavAudioFormat>(); break;
-        }
-
-        if (data.doStems)
+        for (const auto& output : outputs)
         {
-            // Render stems
-            auto tracksToRender = te::getAudioTracks (editRef);
-            auto outputDir = data.outputFile;
-            auto ext = data.outputFile.getFileExtension();
-            if (ext.isEmpty())
+            // The dialog joins this thread before it goes away.
+            if (success && ! encodeCancelled)
             {
-                switch (data.formatId)
+                std::vector<waive::RenderEncoder::Target> targets;
+                for (auto formatId : formatIds)
                 {
-                    case 2: ext = ".flac"; break;
-                    case 3: ext = ".ogg"; break;
-                    default: ext = ".wav"; break;
+                    waive::RenderEncoder::Target target;
+                    target.file = output.baseFile.withFileExtension (getExtensionForFormat (formatId));
+                    target.sampleRate = data.sampleRate;
+                    target.bitDepth = data.bitDepth;
+                    target.quality = (formatId == 3) ? (int) (data.oggQuality * 10) : 0;
+                    targets.push_back (target);
                 }
-            }
 
-            success = true;
-            for (int i = 0; i < tracksToRender.size(); ++i)
-            {
-                juce::BigInteger singleMask;
-                singleMask.setBit (tracksToRender[i]->getIndexInEditTrackList());
-
-                auto stemFile = outputDir.getChildFile (juce::String::formatted ("%02d_%s%s",
-                                                                                  i + 1,
-                                                                                  sanitiseStemFileComponent (tracksToRender[i]->getName()).toRawUTF8(),
-                                                                                  ext.toRawUTF8()));
-
-                // Create Parameters with format settings
-                te::Renderer::Parameters params (editRef);
-                params.destFile = stemFile;
-                params.audioFormat = format.get();
-                params.bitDepth = data.bitDepth;
-                params.sampleRateForAudio = data.sampleRate;
-                params.quality = (data.formatId == 3) ? (int)(data.oggQuality * 10) : 0;
-                params.time = te::TimeRange (te::TimePosition::fromSeconds (data.rangeStartSeconds),
-                                             te::TimePosition::fromSeconds (data.rangeEndSeconds));
-                params.tracksToDo = singleMask;
-                params.usePlugins = true;
-                params.useMasterPlugins = true;
-
-                auto result = te::Renderer::renderToFile ("Rendering stem " + tracksToRender[i]->getName(), params);
-                if (result == juce::File())
-                {
-                    success = false;
-                    break; // Stop rendering on first failure
-                }
+                auto encoded = waive::RenderEncoder::encode (output.master, targets, normalisation);
+                success = encoded.ok;
 
-                renderedFiles.add (result);
-            }
-        }
-        else
-        {
-            // Mixdown
-            te::Renderer::Parameters params (editRef);
-            params.destFile = data.outputFile;
-            params.audioFormat = format.get();
-            params.bitDepth = data.bitDepth;
-            params.sampleRateForAudio = data.sampleRate;
-            params.quality = (data.formatId == 3) ? (int)(data.oggQuality * 10) : 0;
-            params.time = te::TimeRange (te::TimePosition::fromSeconds (data.rangeStartSeconds),
-                                         te::TimePosition::fromSeconds (data.rangeEndSeconds));
-            params.tracksToDo = data.tracksMask;
-            params.usePlugins = true;
-            params.useMasterPlugins = true;
-
-            auto result = te::Renderer::renderToFile ("Rendering mixdown", params);
-            success = (result != juce::File());
-            if (success)
-                renderedFiles.add (result);
-        }
-
-        if (success && data.normalize)
-        {
-            for (auto& renderedFile : renderedFiles)
-            {
-                if (! normaliseRenderedFile (renderedFile,
-                                             data.formatId,
-                                             data.sampleRate,
-                                             data.bitDepth,
-                                             data.oggQuality,
-                                             data.normalizeLevel))
+                if (success)
                 {
-                    success = false;
-                    break;
+                    renderedFiles.add (targets.front().file);
+                    if (renderedFiles.size() == 1)
+                        mixLoudness = encoded.getOutputLoudness();
                 }
             }
-        }
 
-        const auto finalFile = renderedFiles.isEmpty() ? data.outputFile : renderedFiles.getFirst();
-        const auto renderedCount = renderedFiles.size();
-        const auto outputDir = data.doStems ? data.outputFile.getFullPathName()
-                                            : finalFile.getParentDirectory().getFullPathName();
-        juce::MessageManager::callAsync ([safeThis, success, finalFile, renderedCount, outputDir]
-        {
-            if (safeThis == nullptr)
-                return;
+            output.master.deleteFile();
+        }
 
-            safeThis->progressValue = 0.0;
-            safeThis->progressBar.setVisible (false);
+        const bool cancelled = encodeCancelled;
+        juce::String message;
 
-            if (success)
+        if (success && ! cancelled)
+        {
+            if (renderedFiles.size() > 1)
             {
-                juce::String message;
-                if (renderedCount > 1)
-                {
-                    message = "Rendered " + juce::String (renderedCount)
-                              + " stem files to:\n" + outputDir;
-                }
-                else
-                {
-                    auto size = finalFile.getSize();
-                    auto sizeStr = size < 1024 * 1024
-                                   ? juce::String (size / 1024) + " KB"
-                                   : juce::String (size / (1024 * 1024)) + " MB";
-                    message = "File: " + finalFile.getFullPathName() + "\nSize: " + sizeStr;
-                }
-
-                waive::showMessageBoxAsyncSafe (juce::AlertWindow::InfoIcon,
-                                                "Render Complete",
-                                                message);
+                const auto outputDir = data.doStems ? data.outputFile.getFullPathName()
+                                                    : renderedFiles.getFirst().getParentDirectory().getFullPathName();
+                message = "Rendered " + juce::String (renderedFiles.size())
+                          + (data.doStems ? " stem files to:\n" : " files to:\n") + outputDir;
             }
             else
             {
-                waive::showMessageBoxAsyncSafe (juce::AlertWindow::WarningIcon,
-                                                "Render Failed",
-                                                "Failed to render audio.");
+                const auto finalFile = renderedFiles.getFirst();
+                auto size = finalFile.getSize();
+                auto sizeStr = size < 1024 * 1024
+                               ? juce::String (size / 1024) + " KB"
+                               : juce::String (size / (1024 * 1024)) + " MB";
+                message = "File: " + finalFile.getFullPathName() + "\nSize: " + sizeStr;
+
+                if (mixLoudness.has_value() && ! data.doStems)
+                    message << "\nLoudness: " << juce::String (mixLoudness->integratedLufs, 1) << " LUFS, LRA "
+                            << juce::String (mixLoudness->loudnessRangeLu, 1) << " LU, true peak "
+                            << juce::String (mixLoudness->truePeakDb, 1) << " dBTP";
             }
+        }
+        else if (! cancelled)
+        {
+            message = "Failed to render audio.";
+        }
 
-            safeThis->resetControls();
+        juce::MessageManager::callAsync ([safeThis, ok = success && ! cancelled, message]
+        {
+            if (safeThis != nullptr)
+                safeThis->finishRender (ok, message);
         });
     });
 }
 
+void RenderDialog::finishRender (bool success, const juce::String& message)
+{
+    activeRenderData.reset();
+    activeOutputs.clear();
+
+    if (success)
+        waive::showMessageBoxAsyncSafe (juce::AlertWindow::InfoIcon, "Render Complete", message);
+    else if (message.isNotEmpty())
+        waive::showMessageBoxAsyncSafe (juce::AlertWindow::WarningIcon, "Render Failed", message);
+
+    resetControls();
+}
+
 void RenderDialog::resetControls()
 {
     pendingRenderData.reset();
     rendering = false;
+    cancelRequested = false;
     progressValue = 0.0;
     progressBar.setVisible (false);
+    renderButton.setButtonText ("Render");
     renderButton.setEnabled (true);
-    formatCombo.setEnabled (true);
-    sampleRateCombo.setEnabled (true);
-    bitDepthCombo.setEnabled (true);
-    oggQualitySlider.setEnabled (true);
-    rangeCombo.setEnabled (true);
-    startEditor.setEnabled (true);
-    endEditor.setEnabled (true);
-    normalizeToggle.setEnabled (true);
-    mixdownToggle.setEnabled (true);
-    stemsToggle.setEnabled (true);
-    outputPathEditor.setEnabled (true);
-    browseButton.setEnabled (true);
+    setControlsEnabled (true);
 }
@@ -1,19 +1,30 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <atomic>
 #include <optional>
 #include <thread>
+#include <vector>
 #include <tracktion_engine/tracktion_engine.h>
 
+#include "RenderScheduler.h"
+
 class EditSession;
 class UndoableCommandHandler;
 
 //==============================================================================
-/** Multi-format render dialog for exporting audio (WAV, FLAC, OGG). */
-class RenderDialog : public juce::Component
+/** Multi-format render dialog for exporting audio (WAV, FLAC, OGG).
+
+    Every output (the mixdown, each stem, each extra range and each alternate
+    mix) is queued as one batch on the app's RenderScheduler. The dialog
+    follows the batch through RenderScheduler::Listener, so the message thread
+    never waits on it, and the Render button becomes Cancel meanwhile. */
+class RenderDialog : public juce::Component,
+                     private waive::RenderScheduler::Listener
 {
 public:
-    RenderDialog (EditSession& session, UndoableCommandHandler& handler);
+    RenderDialog (EditSession& session, UndoableCommandHandler& handler,
+                  waive::RenderScheduler& scheduler);
     ~RenderDialog() override;
 
     void resized() override;
@@ -29,25 +40,61 @@ public:
     void setLoopRangeForTesting (double startSeconds, double endSeconds, bool enabled);
     bool triggerRenderForTesting();
     void setStemsModeForTesting (bool shouldRenderStems);
+    void setExtraFormatForTesting (int formatId, bool shouldEncode);
+    bool isExtraFormatEnabledForTesting (int formatId) const;
+    int getSelectedNormalizationForTesting() const;
+    void selectNormalizationForTesting (int normalizationId);
     juce::String getOutputPathForTesting() const;
     juce::String getOutputLabelTextForTesting() const;
+    void setOutputPathForTesting (const juce::String& path);
+    void setExtraRangesForTesting (const juce::String& ranges);
+    void setAlternateMixesForTesting (bool shouldRenderAlternateMixes);
+
+    /** Output file names (without extension) the last successful
+        triggerRenderForTesting() would queue. */
+    juce::StringArray getPlannedOutputNamesForTesting() const;
 
 private:
+    struct RenderData;
+
+    struct PlannedOutput
+    {
+        juce::File baseFile;    // final path without the format extension
+        te::TimeRange range;
+        juce::BigInteger tracksMask;
+        juce::File master;
+    };
+
+    static std::vector<PlannedOutput> planOutputs (const RenderData& data);
+
     bool prepareRenderData();
     void updateFileExtension();
     void updateFormatOptions();
     void updateOutputMode();
     void browseForOutputPath();
     void performRender();
+    void cancelRender();
+    void encodeOutputs();
+    void finishRender (bool success, const juce::String& message);
+    void setControlsEnabled (bool enabled);
     void resetControls();
+    void renderFinished (const juce::String& renderId, const juce::String& batchId) override;
+    juce::ToggleButton* getExtraFormatToggle (int formatId);
 
     EditSession& editSession;
     UndoableCommandHandler& commandHandler;
+    waive::RenderScheduler& renderScheduler;
 
     // Format selection
     juce::Label formatLabel;
     juce::ComboBox formatCombo;
 
+    // Extra formats encoded from the same render
+    juce::Label extraFormatsLabel;
+    juce::ToggleButton extraWavToggle;
+    juce::ToggleButton extraFlacToggle;
+    juce::ToggleButton extraOggToggle;
+
     // Quality options
     juce::Label sampleRateLabel;
     juce::ComboBox sampleRateCombo;
@@ -68,10 +115,15 @@ private:
     juce::Label endLabel;
     juce::TextEditor endEditor;
 
+    juce::Label extraRangesLabel;
+    juce::TextEditor extraRangesEditor;
+
     // Output options
-    juce::ToggleButton normalizeToggle;
+    juce::Label normalizeLabel;
+    juce::ComboBox normalizeCombo;
     juce::ToggleButton mixdownToggle;
     juce::ToggleButton stemsToggle;
+    juce::ToggleButton alternateMixesToggle;
 
     juce::Label outputPathLabel;
     juce::TextEditor outputPathEditor;
@@ -85,23 +137,34 @@ private:
     struct RenderData
     {
         int formatId = 1;
+        juce::Array<int> extraFormatIds;
         double sampleRate = 48000.0;
         int bitDepth = 24;
         double oggQuality = 0.6;
         double rangeStartSeconds = 0.0;
         double rangeEndSeconds = 0.0;
+        std::vector<te::TimeRange> extraRanges;
         juce::BigInteger tracksMask;
         bool doStems = false;
+        bool alternateMixes = false;
         juce::File outputFile;
         bool normalize = false;
+        bool normalizeToLoudness = false;   // integrated LUFS rather than sample peak
         double normalizeLevel = -0.1;
         juce::ValueTree editState;
         juce::File editFile;
         tracktion::engine::Engine* enginePtr = nullptr;
+        std::vector<std::pair<int, juce::String>> audioTracks;  // edit track index, name
     };
 
     std::optional<RenderData> pendingRenderData;
 
-    std::thread renderThread;
+    // The render in flight
+    std::optional<RenderData> activeRenderData;
+    std::vector<PlannedOutput> activeOutputs;
+    juce::String activeBatchId;
+    bool cancelRequested = false;
+    std::atomic<bool> encodeCancelled { false };
+    std::thread encodeThread;
     bool rendering = false;
 };
@@ -81,7 +81,8 @@ SessionComponent::SessionComponent (EditSession& session, UndoableCommandHandler
                                     ProjectManager* projectMgr,
                                     std::function<void()> onModelStorageChanged,
                                     waive::AiAgent* aiAgent,
-                                    waive::AiSettings* aiSettings)
+                                    waive::AiSettings* aiSettings,
+                                    waive::MediaImporter* mediaImporter)
     : editSession (session), commandHandler (handler)
 {
     playButton.setButtonText ("Play");
@@ -329,7 +330,7 @@ SessionComponent::SessionComponent (EditSession& session, UndoableCommandHandler
     };
 
     // Timeline
-    timeline = std::make_unique<TimelineComponent> (editSession);
+    timeline = std::make_unique<TimelineComponent> (editSession, mediaImporter);
     addAndMakeVisible (timeline.get());
     timeline->getSelectionManager().addListener (this);
     editSession.addListener (this);
@@ -31,7 +31,8 @@ public:
                       ProjectManager* projectMgr = nullptr,
                       std::function<void()> onModelStorageChanged = {},
                       waive::AiAgent* aiAgent = nullptr,
-                      waive::AiSettings* aiSettings = nullptr);
+                      waive::AiSettings* aiSettings = nullptr,
+                      waive::MediaImporter* mediaImporter = nullptr);
     ~SessionComponent() override;
 
     void resized() override;
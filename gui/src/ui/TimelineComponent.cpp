@@ -45,13 +45,16 @@ juce::String buildTrackStructureSignature (te::Edit& edit)
 }
 
 //==============================================================================
-TimelineComponent::TimelineComponent (EditSession& session)
-    : editSession (session)
+TimelineComponent::TimelineComponent (EditSession& session, waive::MediaImporter* sharedImporter)
+    : editSession (session),
+      ownedMediaImporter (sharedImporter == nullptr ? std::make_unique<waive::MediaImporter> (session) : nullptr),
+      mediaImporter (sharedImporter != nullptr ? *sharedImporter : *ownedMediaImporter)
 {
     selectionManager = std::make_unique<SelectionManager>();
     selectionManager->setEdit (&editSession.getEdit());
     selectionManager->addListener (this);
     editSession.addListener (this);
+    mediaImporter.addListener (this);
 
     ruler = std::make_unique<TimeRulerComponent> (editSession, *this);
     addAndMakeVisible (ruler.get());
@@ -82,6 +85,7 @@ TimelineComponent::~TimelineComponent()
 {
     stopTimer();
     horizontalScrollbar.removeListener (this);
+    mediaImporter.removeListener (this);
     editSession.removeListener (this);
     selectionManager->removeListener (this);
 }
@@ -145,6 +149,53 @@ void TimelineComponent::paint (juce::Graphics& g)
     }
 }
 
+void TimelineComponent::paintOverChildren (juce::Graphics& g)
+{
+    const auto placeholders = mediaImporter.getPlaceholders();
+    if (placeholders.empty())
+        return;
+
+    auto* pal = waive::getWaivePalette (*this);
+    const auto tracks = te::getAudioTracks (editSession.getEdit());
+    const auto clipArea = getLocalBounds().withTrimmedLeft (waive::Spacing::trackHeaderWidth)
+                                          .withTrimmedTop (waive::Spacing::rulerHeight)
+                                          .withTrimmedBottom (waive::Spacing::scrollbarThickness);
+
+    g.saveState();
+    g.reduceClipRegion (clipArea);
+    g.setFont (waive::Fonts::caption());
+
+    for (const auto& placeholder : placeholders)
+    {
+        auto* track = tracks[placeholder.audioTrackIndex];
+        TrackLaneComponent* lane = nullptr;
+        for (auto& candidate : trackLanes)
+            if (candidate != nullptr && track != nullptr && candidate->getAudioTrack() == track)
+                lane = candidate.get();
+
+        // Files bound for tracks that don't exist yet have no lane to draw in.
+        if (lane == nullptr)
+            continue;
+
+        const auto laneBounds = getLocalArea (lane, lane->getLocalBounds());
+        const auto x = timeToX (placeholder.startSeconds);
+        const auto width = juce::jmax (4, timeToX (placeholder.startSeconds + placeholder.lengthSeconds) - x);
+        const auto box = juce::Rectangle<int> (x, laneBounds.getY(), width, laneBounds.getHeight()).reduced (0, 4).toFloat();
+
+        const auto colour = pal ? pal->waveform : juce::Colour (0xff4a90d9);
+        g.setColour (colour.withAlpha (placeholder.probed ? 0.35f : 0.15f));
+        g.fillRoundedRectangle (box, 4.0f);
+        g.setColour (colour.withAlpha (0.7f));
+        g.drawRoundedRectangle (box, 4.0f, 1.0f);
+
+        g.setColour (pal ? pal->textMuted : juce::Colour (0xff808080));
+        g.drawFittedText (placeholder.file.getFileNameWithoutExtension(), box.toNearestInt().reduced (6, 2),
+                          juce::Justification::topLeft, 1);
+    }
+
+    g.restoreState();
+}
+
 void TimelineComponent::mouseWheelMove (const juce::MouseEvent& e,
                                          const juce::MouseWheelDetails& wheel)
 {
@@ -195,57 +246,102 @@ void TimelineComponent::mouseWheelMove (const juce::MouseEvent& e,
 //==============================================================================
 bool TimelineComponent::isInterestedInDragSource (const juce::DragAndDropTarget::SourceDetails& details)
 {
-    return details.description.toString() == "LibraryFile";
+    // Search results drag ["LibraryFile", path...]; the file tree drags the
+    // bare description and is asked for its selection.
+    const auto& description = details.description;
+    return description.toString() == "LibraryFile"
+        || (description.isArray() && description.size() >= 2 && description[0].toString() == "LibraryFile");
 }
 
 void TimelineComponent::itemDropped (const juce::DragAndDropTarget::SourceDetails& details)
 {
-    if (auto* fileTree = dynamic_cast<juce::FileTreeComponent*> (details.sourceComponent.get()))
+    juce::Array<juce::File> files;
+    if (details.description.isArray())
     {
-        auto file = fileTree->getSelectedFile();
-        if (! file.existsAsFile())
-        {
-            waive::showMessageBoxAsyncSafe (juce::MessageBoxIconType::WarningIcon,
-                                            "Cannot Drop File", "The selected file does not exist.");
-            return;
-        }
+        for (int i = 1; i < details.description.size(); ++i)
+            files.add (juce::File (details.description[i].toString()));
+    }
+    else if (auto* fileTree = dynamic_cast<juce::FileTreeComponent*> (details.sourceComponent.get()))
+    {
+        for (int i = 0; i < fileTree->getNumSelectedFiles(); ++i)
+            files.add (fileTree->getSelectedFile (i));
+    }
+    else
+    {
+        return;
+    }
 
-        auto localPos = details.localPosition;
-        double dropTime = snapTimeToGrid (juce::jmax (0.0, xToTime (localPos.x)));
-        int laneIndex = trackIndexAtY (localPos.y - waive::Spacing::rulerHeight);
+    importFilesAt (files, details.localPosition);
+}
 
-        auto& edit = editSession.getEdit();
-        auto tracks = te::getAudioTracks (edit);
+bool TimelineComponent::isInterestedInFileDrag (const juce::StringArray& files)
+{
+    for (auto& path : files)
+        if (waive::MediaImporter::isImportableFile (juce::File (path)))
+            return true;
 
-        if (tracks.isEmpty())
-        {
-            waive::showMessageBoxAsyncSafe (juce::MessageBoxIconType::WarningIcon,
-                                            "Cannot Drop File", "No tracks available. Add a track first.");
-            return;
-        }
+    return false;
+}
 
-        auto* track = getAudioTrackForLaneIndex (laneIndex);
-        if (track == nullptr)
-            track = tracks.getFirst();
-        te::AudioFile audioFile (edit.engine, file);
-        auto duration = audioFile.getLength();
+void TimelineComponent::filesDropped (const juce::StringArray& files, int x, int y)
+{
+    juce::Array<juce::File> audioFiles;
+    for (auto& path : files)
+        if (waive::MediaImporter::isImportableFile (juce::File (path)))
+            audioFiles.add (juce::File (path));
 
-        if (duration <= 0.0)
-        {
-            waive::showMessageBoxAsyncSafe (juce::MessageBoxIconType::WarningIcon,
-                                            "Cannot Drop File", "The file format is not supported or could not be read.");
-            return;
-        }
+    importFilesAt (audioFiles, { x, y });
+}
 
-        editSession.performEdit ("Insert Audio Clip", [&] (te::Edit&)
-        {
-            track->insertWaveClip (file.getFileNameWithoutExtension(), file,
-                                   { { te::TimePosition::fromSeconds (dropTime),
-                                       te::TimePosition::fromSeconds (dropTime + duration) },
-                                     te::TimeDuration() },
-                                   false);
-        });
+void TimelineComponent::importFilesAt (const juce::Array<juce::File>& files, juce::Point<int> position)
+{
+    juce::Array<juce::File> existingFiles;
+    for (auto& file : files)
+        if (file.existsAsFile())
+            existingFiles.add (file);
+
+    if (existingFiles.isEmpty())
+    {
+        waive::showMessageBoxAsyncSafe (juce::MessageBoxIconType::WarningIcon,
+                                        "Cannot Drop File", "The selected file does not exist.");
+        return;
+    }
+
+    double dropTime = snapTimeToGrid (juce::jmax (0.0, xToTime (position.x)));
+    int laneIndex = trackIndexAtY (position.y - waive::Spacing::rulerHeight);
+
+    auto tracks = te::getAudioTracks (editSession.getEdit());
+
+    if (tracks.isEmpty())
+    {
+        waive::showMessageBoxAsyncSafe (juce::MessageBoxIconType::WarningIcon,
+                                        "Cannot Drop File", "No tracks available. Add a track first.");
+        return;
     }
+
+    auto* track = getAudioTrackForLaneIndex (laneIndex);
+    if (track == nullptr)
+        track = tracks.getFirst();
+
+    // Headers are read in the background; the clips appear as each file is ready.
+    mediaImporter.importFiles (existingFiles, tracks.indexOf (track), dropTime);
+}
+
+void TimelineComponent::importPlaceholdersChanged()
+{
+    repaint();
+}
+
+void TimelineComponent::importFinished (int numImported, const juce::StringArray& errors)
+{
+    juce::ignoreUnused (numImported);
+
+    if (errors.isEmpty())
+        return;
+
+    waive::showMessageBoxAsyncSafe (juce::MessageBoxIconType::WarningIcon,
+                                    errors.size() == 1 ? "Cannot Import File" : "Some Files Were Not Imported",
+                                    errors.joinIntoString ("\n"));
 }
 
 //==============================================================================
@@ -606,6 +702,31 @@ void TimelineComponent::editChanged()
     playhead->repaint();
 }
 
+void TimelineComponent::bulkEditStarted()
+{
+    stopTimer();
+}
+
+void TimelineComponent::bulkEditFinished()
+{
+    // Clips may have moved as well as been added, which polling alone would
+    // miss, so rebuild each lane's clips once here instead.
+    if (getDisplayTrackCount() != lastTrackCount
+        || buildTrackStructureSignature (editSession.getEdit()) != lastTrackStructureSignature)
+    {
+        rebuildTracks();
+    }
+    else
+    {
+        for (auto& lane : trackLanes)
+            if (lane != nullptr)
+                lane->updateClips();
+    }
+
+    timerCallback();
+    startTimerHz (5);
+}
+
 std::vector<TrackLaneComponent*> TimelineComponent::getTrackLaneComponentsForTesting() const
 {
     std::vector<TrackLaneComponent*> result;
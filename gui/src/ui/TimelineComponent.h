@@ -4,6 +4,7 @@
 #include <tracktion_engine/tracktion_engine.h>
 #include <unordered_set>
 #include "EditSession.h"
+#include "MediaImporter.h"
 #include "SelectionManager.h"
 
 namespace te = tracktion;
@@ -20,13 +21,19 @@ struct TimelineLaneDescriptor
 };
 
 //==============================================================================
-/** Main timeline container — manages zoom, scroll, track lanes, and playhead. */
+/** Main timeline container — manages zoom, scroll, track lanes, and playhead.
+    Dropped audio files are imported in the background and drawn as
+    placeholders until their clips are inserted. The importer is normally the
+    app's shared one, so imports started elsewhere (e.g. the library) are
+    drawn too; without one the timeline owns its own. */
 class TimelineComponent : public juce::Component,
                           public juce::DragAndDropTarget,
+                          public juce::FileDragAndDropTarget,
                           private SelectionManager::Listener,
                           private EditSession::Listener,
                           private juce::Timer,
-                          private juce::ScrollBar::Listener
+                          private juce::ScrollBar::Listener,
+                          private waive::MediaImporter::Listener
 {
 public:
     enum class SnapResolution
@@ -37,17 +44,22 @@ public:
         quarterBeat
     };
 
-    TimelineComponent (EditSession& session);
+    explicit TimelineComponent (EditSession& session, waive::MediaImporter* sharedImporter = nullptr);
     ~TimelineComponent() override;
 
     void resized() override;
     void paint (juce::Graphics& g) override;
+    void paintOverChildren (juce::Graphics& g) override;
     void mouseWheelMove (const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
 
     // DragAndDropTarget
     bool isInterestedInDragSource (const juce::DragAndDropTarget::SourceDetails& details) override;
     void itemDropped (const juce::DragAndDropTarget::SourceDetails& details) override;
 
+    // FileDragAndDropTarget
+    bool isInterestedInFileDrag (const juce::StringArray& files) override;
+    void filesDropped (const juce::StringArray& files, int x, int y) override;
+
     // Coordinate conversion
     int timeToX (double seconds) const;
     double xToTime (int x) const;
@@ -74,6 +86,7 @@ public:
 
     SelectionManager& getSelectionManager()  { return *selectionManager; }
     EditSession& getEditSession()            { return editSession; }
+    waive::MediaImporter& getMediaImporter() { return mediaImporter; }
 
     void rebuildTracks();
     void deleteSelectedClips();
@@ -102,13 +115,20 @@ private:
     void selectionChanged() override;
     void editAboutToChange() override;
     void editChanged() override;
+    void bulkEditStarted() override;
+    void bulkEditFinished() override;
     void timerCallback() override;
     void scrollBarMoved (juce::ScrollBar* scrollBarThatHasMoved, double newRangeStart) override;
+    void importPlaceholdersChanged() override;
+    void importFinished (int numImported, const juce::StringArray& errors) override;
+    void importFilesAt (const juce::Array<juce::File>& files, juce::Point<int> position);
     te::AudioTrack* getAudioTrackForLaneIndex (int laneIndex) const;
     void appendTrackLaneRecursive (te::Track& track, int depth);
     int getDisplayTrackCount() const;
 
     EditSession& editSession;
+    std::unique_ptr<waive::MediaImporter> ownedMediaImporter;
+    waive::MediaImporter& mediaImporter;
 
     double pixelsPerSecond = 100.0;
     double scrollOffsetSeconds = 0.0;
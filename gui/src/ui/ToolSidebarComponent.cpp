@@ -9,6 +9,7 @@
 #include "EditSession.h"
 #include "ProjectManager.h"
 #include "SessionComponent.h"
+#include "TimelineComponent.h"
 #include "WaiveLookAndFeel.h"
 #include "WaiveFonts.h"
 #include "WaiveSpacing.h"
@@ -21,6 +22,9 @@ struct PlanState
     std::mutex mutex;
     std::optional<waive::ToolPlan> plan;
 };
+
+// Long enough to let a shift-click run of selections settle first.
+constexpr int speculativePlanDelayMs = 300;
 }
 
 //==============================================================================
@@ -379,10 +383,12 @@ ToolSidebarComponent::ToolSidebarComponent (waive::ToolRegistry& registry,
     addAndMakeVisible (previewEditor);
 
     toolCombo.onChange = [this] {
+        toolChosenByUser = true;
         loadDefaultParamsForSelectedTool();
         clearPendingPlanState();
         lastPlanError.clear();
         updateButtonStates();
+        scheduleSpeculativePlan();
     };
     planButton.onClick = [this] { runPlan(); };
     applyButton.onClick = [this] { applyPlan(); };
@@ -397,15 +403,47 @@ ToolSidebarComponent::ToolSidebarComponent (waive::ToolRegistry& registry,
 
     editSession.addListener (this);
     jobQueue.addListener (this);
+    sessionComponent.getTimeline().getSelectionManager().addListener (this);
 }
 
 ToolSidebarComponent::~ToolSidebarComponent()
 {
+    stopTimer();
+    cancelSpeculativePlan();
     cancelRunningPlanAndWait (2000);
+    sessionComponent.getTimeline().getSelectionManager().removeListener (this);
     editSession.removeListener (this);
     jobQueue.removeListener (this);
 }
 
+void ToolSidebarComponent::setSpeculativePlanningEnabled (bool shouldSpeculate)
+{
+    speculativePlanningEnabled = shouldSpeculate;
+
+    if (speculativePlanningEnabled)
+    {
+        scheduleSpeculativePlan();
+    }
+    else
+    {
+        stopTimer();
+        cancelSpeculativePlan();
+    }
+}
+
+void ToolSidebarComponent::visibilityChanged()
+{
+    if (isShownToUser())
+    {
+        scheduleSpeculativePlan();
+    }
+    else
+    {
+        stopTimer();
+        cancelSpeculativePlan();
+    }
+}
+
 void ToolSidebarComponent::notifyModelStorageChanged()
 {
     if (onModelStorageChanged)
@@ -414,6 +452,8 @@ void ToolSidebarComponent::notifyModelStorageChanged()
 
 void ToolSidebarComponent::editAboutToChange()
 {
+    stopTimer();
+    cancelSpeculativePlan();
     cancelRunningPlan();
     clearPendingPlanState ("Project changed");
     updateButtonStates();
@@ -421,8 +461,28 @@ void ToolSidebarComponent::editAboutToChange()
 
 void ToolSidebarComponent::editChanged()
 {
+    ++editRevision;
     clearPendingPlanState();
     updateButtonStates();
+    scheduleSpeculativePlan();
+}
+
+void ToolSidebarComponent::editStateChanged()
+{
+    // Plans capture clip and track state, so any edit makes a speculative one stale.
+    ++editRevision;
+    scheduleSpeculativePlan();
+}
+
+void ToolSidebarComponent::selectionChanged()
+{
+    scheduleSpeculativePlan();
+}
+
+void ToolSidebarComponent::timerCallback()
+{
+    stopTimer();
+    startSpeculativePlan();
 }
 
 void ToolSidebarComponent::paint (juce::Graphics& g)
@@ -536,8 +596,13 @@ void ToolSidebarComponent::populateToolList()
         toolNamesByComboIndex.add (desc.name);
     }
 
+    // Selecting the default tool isn't a user choice, so it mustn't go
+    // through onChange and start speculating.
     if (toolCombo.getNumItems() > 0)
-        toolCombo.setSelectedItemIndex (0, juce::sendNotification);
+    {
+        toolCombo.setSelectedItemIndex (0, juce::dontSendNotification);
+        loadDefaultParamsForSelectedTool();
+    }
 }
 
 void ToolSidebarComponent::loadDefaultParamsForSelectedTool()
@@ -571,6 +636,12 @@ void ToolSidebarComponent::runPlan()
 
     auto params = schemaForm.getParams();
 
+    if (adoptSpeculativePlan (toolName, params))
+        return;
+
+    stopTimer();
+    cancelSpeculativePlan();
+
     waive::ToolPlanTask task;
     waive::ToolExecutionContext context {
         editSession,
@@ -601,9 +672,13 @@ void ToolSidebarComponent::runPlan()
 
     activePlanJobID = jobQueue.submit (
         { task.jobName, "tool_plan" },
-        [taskFn = std::move (task.run), sharedPlan] (waive::ProgressReporter& reporter)
+        [taskFn = std::move (task.run), writeArtifact = std::move (task.writeArtifact), sharedPlan] (waive::ProgressReporter& reporter)
         {
             auto producedPlan = taskFn (reporter);
+
+            if (writeArtifact && ! reporter.isCancelled())
+                writeArtifact (producedPlan);
+
             std::lock_guard<std::mutex> lock (sharedPlan->mutex);
             sharedPlan->plan = std::move (producedPlan);
         },
@@ -746,6 +821,7 @@ void ToolSidebarComponent::handlePlanCompletion (waive::JobStatus status, std::o
 {
     planRunning = false;
     activePlanJobID = 0;
+    ++planCompletionCount;
 
     if (status == waive::JobStatus::Completed)
     {
@@ -792,6 +868,188 @@ void ToolSidebarComponent::handlePlanCompletion (waive::JobStatus status, std::o
     updateButtonStates();
 }
 
+juce::String ToolSidebarComponent::makePlanRequestKey (const juce::String& toolName, const juce::var& params) const
+{
+    juce::String key;
+    key << toolName << '|' << juce::JSON::toString (params, true) << '|' << editRevision << '|'
+        << resolveProjectCacheDirectory().getFullPathName() << '|';
+
+    // Order matters: some tools treat the first selected clip specially.
+    for (auto* clip : sessionComponent.getTimeline().getSelectionManager().getSelectedClips())
+        if (clip != nullptr)
+            key << clip->itemID.toString() << ',';
+
+    return key;
+}
+
+bool ToolSidebarComponent::shouldSpeculate() const
+{
+    return speculativePlanningEnabled && toolChosenByUser && isShownToUser();
+}
+
+bool ToolSidebarComponent::isShownToUser() const
+{
+    if (isShowing())
+        return true;
+
+    // Tests drive the sidebar without a window; there only visibility counts.
+    if (getTopLevelComponent()->getPeer() != nullptr)
+        return false;
+
+    for (auto* component = static_cast<const juce::Component*> (this); component != nullptr;
+         component = component->getParentComponent())
+        if (! component->isVisible())
+            return false;
+
+    return true;
+}
+
+void ToolSidebarComponent::scheduleSpeculativePlan()
+{
+    cancelSpeculativePlan();
+
+    if (shouldSpeculate())
+        startTimer (speculativePlanDelayMs);
+}
+
+void ToolSidebarComponent::startSpeculativePlan()
+{
+    cancelSpeculativePlan();
+
+    if (! shouldSpeculate() || planRunning)
+        return;
+
+    const auto toolName = getSelectedToolName();
+    auto* tool = toolRegistry.findTool (toolName);
+    if (tool == nullptr || ! tool->describe().speculativePlanning)
+        return;
+
+    const auto params = schemaForm.getParams();
+
+    waive::ToolPlanTask task;
+    waive::ToolExecutionContext context {
+        editSession,
+        projectManager,
+        sessionComponent,
+        modelManager,
+        resolveProjectCacheDirectory()
+    };
+
+    // Nothing plannable yet, e.g. no selection. Plan will say why if pressed.
+    if (tool->preparePlan (context, params, task).failed())
+        return;
+
+    auto sharedPlan = std::make_shared<PlanState>();
+    juce::Component::SafePointer<ToolSidebarComponent> safeThis (this);
+
+    // The artifact is only written if the plan is adopted, so abandoned
+    // speculation leaves nothing in the project cache.
+    speculativeArtifactWriter = std::move (task.writeArtifact);
+    speculativeRequestKey = makePlanRequestKey (toolName, params);
+    speculativeJobID = jobQueue.submit (
+        { task.jobName + " (speculative)", "tool_plan", waive::JobPriority::background },
+        [taskFn = std::move (task.run), sharedPlan] (waive::ProgressReporter& reporter)
+        {
+            auto producedPlan = taskFn (reporter);
+            std::lock_guard<std::mutex> lock (sharedPlan->mutex);
+            sharedPlan->plan = std::move (producedPlan);
+        },
+        [safeThis, sharedPlan] (int jobID, waive::JobStatus status)
+        {
+            if (safeThis == nullptr)
+                return;
+
+            std::optional<waive::ToolPlan> result;
+            {
+                std::lock_guard<std::mutex> lock (sharedPlan->mutex);
+                if (sharedPlan->plan.has_value())
+                    result = std::move (sharedPlan->plan.value());
+            }
+
+            safeThis->handleSpeculativeCompletion (jobID, status, std::move (result));
+        });
+}
+
+void ToolSidebarComponent::cancelSpeculativePlan()
+{
+    // The job only captures its own copies of the plan inputs, and the
+    // analysis store keeps completed results only, so it can be abandoned
+    // without waiting.
+    if (speculativeJobID > 0)
+        jobQueue.cancelJob (speculativeJobID);
+
+    speculativeJobID = 0;
+    speculativeRequestKey.clear();
+    speculativePlan.reset();
+    speculativeArtifactWriter = nullptr;
+}
+
+bool ToolSidebarComponent::adoptSpeculativePlan (const juce::String& toolName, const juce::var& params)
+{
+    if (speculativeRequestKey.isEmpty() || speculativeRequestKey != makePlanRequestKey (toolName, params))
+        return false;
+
+    lastPlanError.clear();
+    pendingPlan.reset();
+    sessionComponent.clearToolPreview();
+    previewEditor.clear();
+    speculativeRequestKey.clear();
+
+    auto writeArtifact = std::move (speculativeArtifactWriter);
+    speculativeArtifactWriter = nullptr;
+
+    if (speculativePlan.has_value())
+    {
+        auto plan = std::move (speculativePlan);
+        speculativePlan.reset();
+
+        if (writeArtifact)
+            writeArtifact (*plan);
+
+        handlePlanCompletion (waive::JobStatus::Completed, std::move (plan));
+        return true;
+    }
+
+    // Still running: it becomes the plan job, and its completion is routed
+    // to handlePlanCompletion() from here on. The user is now waiting on it,
+    // so it no longer runs at background priority.
+    jobQueue.promoteJob (speculativeJobID);
+    adoptedArtifactWriter = std::move (writeArtifact);
+    activePlanJobID = speculativeJobID;
+    speculativeJobID = 0;
+    planRunning = true;
+    setStatusText ("Planning...");
+    updateButtonStates();
+    return true;
+}
+
+void ToolSidebarComponent::handleSpeculativeCompletion (int jobID, waive::JobStatus status,
+                                                        std::optional<waive::ToolPlan> planResult)
+{
+    if (planRunning && jobID == activePlanJobID)
+    {
+        auto writeArtifact = std::move (adoptedArtifactWriter);
+        adoptedArtifactWriter = nullptr;
+
+        if (writeArtifact && status == waive::JobStatus::Completed && planResult.has_value())
+            writeArtifact (*planResult);
+
+        handlePlanCompletion (status, std::move (planResult));
+        return;
+    }
+
+    // Superseded by a newer selection or edit.
+    if (jobID != speculativeJobID)
+        return;
+
+    speculativeJobID = 0;
+
+    if (status == waive::JobStatus::Completed && planResult.has_value())
+        speculativePlan = std::move (planResult);
+    else
+        speculativeRequestKey.clear();
+}
+
 juce::File ToolSidebarComponent::resolveProjectCacheDirectory() const
 {
     auto currentProjectFile = projectManager.getCurrentFile();
@@ -846,6 +1104,7 @@ void ToolSidebarComponent::selectToolForTesting (const juce::String& toolName)
     {
         if (toolNamesByComboIndex[i] == toolName)
         {
+            toolChosenByUser = true;
             toolCombo.setSelectedItemIndex (i, juce::sendNotification);
             // CRITICAL: Explicitly call loadDefaultParamsForSelectedTool to ensure schema rebuild.
             // toolCombo.onChange may not fire reliably in test context.
@@ -867,8 +1126,10 @@ bool ToolSidebarComponent::runPlanForTesting()
     if (planRunning)
         return false;
 
+    // An adopted speculative plan may complete without starting a job.
+    const auto completionsBefore = planCompletionCount;
     runPlan();
-    return planRunning;
+    return planRunning || planCompletionCount != completionsBefore;
 }
 
 bool ToolSidebarComponent::applyPlanForTesting()
@@ -905,6 +1166,20 @@ bool ToolSidebarComponent::waitForIdleForTesting (int timeoutMs)
     return ! planRunning;
 }
 
+bool ToolSidebarComponent::waitForSpeculativePlanForTesting (int timeoutMs)
+{
+    int elapsedMs = 0;
+    constexpr int stepMs = 20;
+
+    while (! speculativePlan.has_value() && (isTimerRunning() || speculativeJobID > 0) && elapsedMs < timeoutMs)
+    {
+        juce::MessageManager::getInstance()->runDispatchLoopUntil (stepMs);
+        elapsedMs += stepMs;
+    }
+
+    return speculativePlan.has_value();
+}
+
 bool ToolSidebarComponent::hasPendingPlanForTesting() const
 {
     return pendingPlan.has_value();
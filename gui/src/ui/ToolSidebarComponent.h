@@ -7,6 +7,7 @@
 #include "JobQueue.h"
 #include "ToolDiff.h"
 #include "SchemaFormComponent.h"
+#include "SelectionManager.h"
 
 class ProjectManager;
 class SessionComponent;
@@ -15,10 +16,22 @@ namespace waive { class ToolRegistry; class ModelManager; }
 
 //==============================================================================
 /** Collapsible sidebar for tool plan/preview/apply workflow.
-    Replaces the standalone ToolsComponent tab. */
+    Replaces the standalone ToolsComponent tab.
+
+    For tools that declare speculativePlanning, a plan is started at
+    background priority shortly after the selection, tool or edit changes,
+    and cancelled when any of them changes again. Nothing is speculated
+    until the user picks a tool, or while the sidebar is hidden. Pressing Plan with the same
+    tool, parameters, selection and edit adopts it: a finished plan is shown
+    at once and a running one becomes the plan job, promoted to normal
+    priority. The plan artifact is written only on adoption. Otherwise it is cancelled
+    and Plan starts afresh, reusing whatever analysis the speculative run
+    already finished through the project's analysis store. */
 class ToolSidebarComponent : public juce::Component,
                              public waive::JobQueue::Listener,
-                             private EditSession::Listener
+                             private EditSession::Listener,
+                             private SelectionManager::Listener,
+                             private juce::Timer
 {
 public:
     ToolSidebarComponent (waive::ToolRegistry& registry,
@@ -32,6 +45,9 @@ public:
 
     void paint (juce::Graphics& g) override;
     void resized() override;
+    void visibilityChanged() override;
+
+    void setSpeculativePlanningEnabled (bool shouldSpeculate);
 
     //==============================================================================
     // Test helpers — same API as the old ToolsComponent for compatibility.
@@ -59,6 +75,7 @@ public:
     bool isModelInstalledForTesting (const juce::String& modelID,
                                      const juce::String& version = {}) const;
     juce::String getToolModelRequirementForTesting (const juce::String& toolName) const;
+    bool waitForSpeculativePlanForTesting (int timeoutMs = 4000);
 
     //==============================================================================
     // waive::JobQueue::Listener
@@ -67,6 +84,9 @@ public:
 private:
     void editAboutToChange() override;
     void editChanged() override;
+    void editStateChanged() override;
+    void selectionChanged() override;
+    void timerCallback() override;
 
     class ModelManagerSection;
     friend class ModelManagerSection;
@@ -88,6 +108,15 @@ private:
     void clearPendingPlanState (const juce::String& statusText = {});
     void notifyModelStorageChanged();
 
+    juce::String makePlanRequestKey (const juce::String& toolName, const juce::var& params) const;
+    bool shouldSpeculate() const;
+    bool isShownToUser() const;
+    void scheduleSpeculativePlan();
+    void startSpeculativePlan();
+    void cancelSpeculativePlan();
+    bool adoptSpeculativePlan (const juce::String& toolName, const juce::var& params);
+    void handleSpeculativeCompletion (int jobID, waive::JobStatus status, std::optional<waive::ToolPlan> planResult);
+
     waive::ToolRegistry& toolRegistry;
     EditSession& editSession;
     ProjectManager& projectManager;
@@ -101,6 +130,16 @@ private:
 
     int activePlanJobID = 0;
     bool planRunning = false;
+    int planCompletionCount = 0;
+
+    bool speculativePlanningEnabled = true;
+    bool toolChosenByUser = false; // the default tool is never speculated
+    int speculativeJobID = 0;
+    juce::String speculativeRequestKey;             // empty when nothing is speculated
+    std::optional<waive::ToolPlan> speculativePlan; // set once the speculative job finishes
+    std::function<void (waive::ToolPlan&)> speculativeArtifactWriter;
+    std::function<void (waive::ToolPlan&)> adoptedArtifactWriter; // for an adopted plan still running
+    int editRevision = 0;
     juce::String lastPlanError;
     mutable std::map<juce::String, juce::String> toolToRequiredModel;
     std::function<void()> onModelStorageChanged;
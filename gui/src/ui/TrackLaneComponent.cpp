@@ -821,3 +821,8 @@ juce::Colour TrackLaneComponent::getTrackColorForTesting() const
 
     return *trackColors[track.getIndexInEditTrackList() % 12];
 }
+
+int TrackLaneComponent::getNumClipComponentsForTesting() const
+{
+    return (int) clipComponents.size();
+}
@@ -44,6 +44,7 @@ public:
     int getIndentDepth() const              { return depth; }
 
     juce::Colour getTrackColorForTesting() const;
+    int getNumClipComponentsForTesting() const;
 
 private:
     enum ContextMenuItemId
@@ -4,14 +4,14 @@
 namespace waive
 {
 
-juce::String runCommand (UndoableCommandHandler& handler, const juce::var& commandObject)
+juce::var runCommand (UndoableCommandHandler& handler, const juce::var& commandObject)
 {
-    return handler.handleCommand (juce::JSON::toString (commandObject));
+    return handler.executeCommand (commandObject);
 }
 
-juce::String runCommandCoalesced (UndoableCommandHandler& handler, const juce::var& commandObject)
+juce::var runCommandCoalesced (UndoableCommandHandler& handler, const juce::var& commandObject)
 {
-    return handler.handleCommandCoalesced (juce::JSON::toString (commandObject));
+    return handler.executeCommandCoalesced (commandObject);
 }
 
 juce::var makeAction (const juce::String& action)
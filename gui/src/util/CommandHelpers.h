@@ -7,11 +7,12 @@ class UndoableCommandHandler;
 namespace waive
 {
 
-/** Send a JSON command object to the handler and return the response string. */
-juce::String runCommand (UndoableCommandHandler& handler, const juce::var& commandObject);
+/** Run a command object through the handler's typed entry point and return the
+    structured response object (no JSON round-trip). */
+juce::var runCommand (UndoableCommandHandler& handler, const juce::var& commandObject);
 
 /** Coalescing variant for slider drags. */
-juce::String runCommandCoalesced (UndoableCommandHandler& handler, const juce::var& commandObject);
+juce::var runCommandCoalesced (UndoableCommandHandler& handler, const juce::var& commandObject);
 
 /** Create a minimal JSON command object with the given action name. */
 juce::var makeAction (const juce::String& action);
@@ -0,0 +1,341 @@
+#include "LoudnessMeter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace waive
+{
+
+namespace
+{
+constexpr int truePeakFilterTaps = 49;
+constexpr double absoluteGateLufs = -70.0;
+
+double energyToLufs (double energy)
+{
+    if (energy <= 0.0)
+        return LoudnessMeter::floorDb;
+
+    return juce::jmax (LoudnessMeter::floorDb, -0.691 + 10.0 * std::log10 (energy));
+}
+
+double gainToDb (float gain)
+{
+    return gain > 0.0f ? juce::jmax (LoudnessMeter::floorDb, 20.0 * std::log10 ((double) gain))
+                       : LoudnessMeter::floorDb;
+}
+
+/** Mean energy of the blocks louder than thresholdLufs, or 0 if none are. */
+double gatedMeanEnergy (const std::vector<double>& blocks, double thresholdLufs)
+{
+    double sum = 0.0;
+    int count = 0;
+
+    for (auto energy : blocks)
+    {
+        if (energyToLufs (energy) > thresholdLufs)
+        {
+            sum += energy;
+            ++count;
+        }
+    }
+
+    return count > 0 ? sum / count : 0.0;
+}
+}
+
+//==============================================================================
+juce::var LoudnessMeter::Result::toVar() const
+{
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("integrated_lufs", integratedLufs);
+    obj->setProperty ("momentary_max_lufs", momentaryMaxLufs);
+    obj->setProperty ("short_term_max_lufs", shortTermMaxLufs);
+    obj->setProperty ("loudness_range_lu", loudnessRangeLu);
+    obj->setProperty ("true_peak_dbtp", truePeakDb);
+    obj->setProperty ("sample_peak_dbfs", samplePeakDb);
+    obj->setProperty ("duration", durationSeconds);
+    return juce::var (obj);
+}
+
+//==============================================================================
+void LoudnessMeter::prepare (double newSampleRate, int numChannels)
+{
+    sampleRate = newSampleRate;
+
+    // K-weighting (BS.1770-4 Annex 1), derived for any sample rate.
+    {
+        const double f0 = 1681.974450955533, gainDb = 3.999843853973347, q = 0.7071752369554196;
+        const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double vh = std::pow (10.0, gainDb / 20.0);
+        const double vb = std::pow (vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        shelf = { (vh + vb * k / q + k * k) / a0,
+                  2.0 * (k * k - vh) / a0,
+                  (vh - vb * k / q + k * k) / a0,
+                  2.0 * (k * k - 1.0) / a0,
+                  (1.0 - k / q + k * k) / a0 };
+    }
+
+    {
+        const double f0 = 38.13547087602444, q = 0.5003270373238773;
+        const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        highPass = { 1.0, -2.0, 1.0,
+                     2.0 * (k * k - 1.0) / a0,
+                     (1.0 - k / q + k * k) / a0 };
+    }
+
+    // True peak: windowed-sinc interpolator split into polyphase branches.
+    oversampling = sampleRate >= 192000.0 ? 1 : (sampleRate >= 96000.0 ? 2 : 4);
+    tapsPerPhase = (truePeakFilterTaps + oversampling - 1) / oversampling;
+    phaseCoefficients.assign ((size_t) oversampling, std::vector<float> ((size_t) tapsPerPhase, 0.0f));
+
+    for (int j = 0; j < truePeakFilterTaps; ++j)
+    {
+        const double m = j - (truePeakFilterTaps - 1) / 2.0;
+        const double x = juce::MathConstants<double>::pi * m / oversampling;
+        const double sinc = std::abs (m) < 1.0e-9 ? 1.0 : std::sin (x) / x;
+        const double window = 0.5 * (1.0 - std::cos (2.0 * juce::MathConstants<double>::pi * j / (truePeakFilterTaps - 1)));
+        phaseCoefficients[(size_t) (j % oversampling)][(size_t) (j / oversampling)] = (float) (sinc * window);
+    }
+
+    channels.assign ((size_t) juce::jmax (1, numChannels), ChannelState());
+    for (size_t ch = 0; ch < channels.size(); ++ch)
+    {
+        // 5.1 (L R C LFE Ls Rs): LFE is excluded and the surrounds weighted up.
+        if (channels.size() == 6)
+            channels[ch].weight = ch == 3 ? 0.0 : (ch >= 4 ? 1.41 : 1.0);
+
+        channels[ch].history.assign ((size_t) tapsPerPhase * 2, 0.0f);
+    }
+
+    subBlockLength = juce::jmax (1, juce::roundToInt (sampleRate * 0.1));
+    reset();
+}
+
+void LoudnessMeter::reset()
+{
+    for (auto& channel : channels)
+    {
+        channel.z1[0] = channel.z1[1] = channel.z2[0] = channel.z2[1] = 0.0;
+        std::fill (channel.history.begin(), channel.history.end(), 0.0f);
+        channel.historyPos = 0;
+    }
+
+    subBlockPos = 0;
+    subBlockEnergy = 0.0;
+    recentSubBlocks.assign (30, 0.0);
+    numSubBlocks = 0;
+    momentaryBlocks.clear();
+    shortTermBlocks.clear();
+    truePeak = 0.0f;
+    samplePeak = 0.0f;
+    samplesProcessed = 0;
+}
+
+float LoudnessMeter::processTruePeak (ChannelState& channel, float sample)
+{
+    // The delay line is stored twice so the taps always read contiguously.
+    channel.history[(size_t) channel.historyPos] = sample;
+    channel.history[(size_t) (channel.historyPos + tapsPerPhase)] = sample;
+    const auto* newest = channel.history.data() + channel.historyPos + tapsPerPhase;
+    channel.historyPos = (channel.historyPos + 1) % tapsPerPhase;
+
+    float peak = 0.0f;
+    for (const auto& coefficients : phaseCoefficients)
+    {
+        float sum = 0.0f;
+        for (int t = 0; t < tapsPerPhase; ++t)
+            sum += coefficients[(size_t) t] * newest[-t];
+
+        peak = juce::jmax (peak, std::abs (sum));
+    }
+
+    return peak;
+}
+
+void LoudnessMeter::process (const float* const* channelData, int numChannels, int numSamples)
+{
+    jassert (sampleRate > 0.0);
+    numChannels = juce::jmin (numChannels, (int) channels.size());
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const auto chunk = juce::jmin (numSamples - pos, subBlockLength - subBlockPos);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& channel = channels[(size_t) ch];
+            const auto* input = channelData[ch] + pos;
+            double sumSquares = 0.0;
+
+            for (int i = 0; i < chunk; ++i)
+            {
+                const double x = input[i];
+                samplePeak = juce::jmax (samplePeak, std::abs (input[i]));
+
+                if (oversampling > 1)
+                    truePeak = juce::jmax (truePeak, processTruePeak (channel, input[i]));
+
+                const double s = shelf.b0 * x + channel.z1[0];
+                channel.z1[0] = shelf.b1 * x - shelf.a1 * s + channel.z2[0];
+                channel.z2[0] = shelf.b2 * x - shelf.a2 * s;
+
+                const double y = highPass.b0 * s + channel.z1[1];
+                channel.z1[1] = highPass.b1 * s - highPass.a1 * y + channel.z2[1];
+                channel.z2[1] = highPass.b2 * s - highPass.a2 * y;
+
+                sumSquares += y * y;
+            }
+
+            subBlockEnergy += channel.weight * sumSquares;
+        }
+
+        pos += chunk;
+        subBlockPos += chunk;
+        samplesProcessed += chunk;
+
+        if (subBlockPos == subBlockLength)
+            finishSubBlock();
+    }
+
+    if (oversampling == 1)
+        truePeak = samplePeak;
+}
+
+void LoudnessMeter::process (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    std::vector<const float*> pointers ((size_t) buffer.getNumChannels());
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        pointers[(size_t) ch] = buffer.getReadPointer (ch, startSample);
+
+    process (pointers.data(), buffer.getNumChannels(), numSamples);
+}
+
+void LoudnessMeter::finishSubBlock()
+{
+    recentSubBlocks[(size_t) (numSubBlocks % 30)] = subBlockEnergy / subBlockLength;
+    ++numSubBlocks;
+    subBlockEnergy = 0.0;
+    subBlockPos = 0;
+
+    auto meanOfLast = [this] (int count)
+    {
+        double sum = 0.0;
+        for (int i = 1; i <= count; ++i)
+            sum += recentSubBlocks[(size_t) ((numSubBlocks - i) % 30)];
+        return sum / count;
+    };
+
+    if (numSubBlocks >= 4)
+        momentaryBlocks.push_back (meanOfLast (4));
+
+    if (numSubBlocks >= 30)
+        shortTermBlocks.push_back (meanOfLast (30));
+}
+
+std::vector<double> LoudnessMeter::getMomentaryLoudness() const
+{
+    std::vector<double> loudness;
+    loudness.reserve (momentaryBlocks.size());
+
+    for (auto energy : momentaryBlocks)
+        loudness.push_back (energyToLufs (energy));
+
+    return loudness;
+}
+
+LoudnessMeter::Result LoudnessMeter::getResult() const
+{
+    Result result;
+    result.samplePeakDb = gainToDb (samplePeak);
+    result.truePeakDb = gainToDb (juce::jmax (truePeak, samplePeak));
+    result.durationSeconds = sampleRate > 0.0 ? (double) samplesProcessed / sampleRate : 0.0;
+
+    for (auto energy : momentaryBlocks)
+        result.momentaryMaxLufs = juce::jmax (result.momentaryMaxLufs, energyToLufs (energy));
+
+    for (auto energy : shortTermBlocks)
+        result.shortTermMaxLufs = juce::jmax (result.shortTermMaxLufs, energyToLufs (energy));
+
+    // Integrated: absolute gate, then a relative gate 10 LU below the result.
+    if (const auto ungated = gatedMeanEnergy (momentaryBlocks, absoluteGateLufs); ungated > 0.0)
+    {
+        const auto relativeGate = energyToLufs (ungated) - 10.0;
+        result.integratedLufs = energyToLufs (gatedMeanEnergy (momentaryBlocks, juce::jmax (absoluteGateLufs, relativeGate)));
+    }
+
+    // LRA (EBU Tech 3342): 10th to 95th percentile of gated short-term loudness.
+    if (const auto ungated = gatedMeanEnergy (shortTermBlocks, absoluteGateLufs); ungated > 0.0)
+    {
+        const auto gate = juce::jmax (absoluteGateLufs, energyToLufs (ungated) - 20.0);
+
+        std::vector<double> levels;
+        for (auto energy : shortTermBlocks)
+            if (const auto lufs = energyToLufs (energy); lufs > gate)
+                levels.push_back (lufs);
+
+        if (levels.size() > 1)
+        {
+            std::sort (levels.begin(), levels.end());
+            const auto percentile = [&levels] (double p)
+            {
+                return levels[(size_t) juce::roundToInt (p * (double) (levels.size() - 1))];
+            };
+            result.loudnessRangeLu = percentile (0.95) - percentile (0.10);
+        }
+    }
+
+    return result;
+}
+
+std::optional<LoudnessMeter::Result> LoudnessMeter::measureFile (const juce::File& file,
+                                                                 const std::function<bool()>& shouldCancel)
+{
+    return measureFile (file, 0.0, -1.0, shouldCancel);
+}
+
+std::optional<LoudnessMeter::Result> LoudnessMeter::measureFile (const juce::File& file,
+                                                                 double startSeconds,
+                                                                 double lengthSeconds,
+                                                                 const std::function<bool()>& shouldCancel)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+    if (reader == nullptr || reader->sampleRate <= 0.0 || reader->numChannels == 0)
+        return std::nullopt;
+
+    constexpr int blockSize = 8192;
+    const auto numChannels = (int) reader->numChannels;
+
+    LoudnessMeter meter;
+    meter.prepare (reader->sampleRate, numChannels);
+
+    const auto start = juce::jlimit ((juce::int64) 0, reader->lengthInSamples,
+                                     (juce::int64) std::llround (startSeconds * reader->sampleRate));
+    auto end = reader->lengthInSamples;
+    if (lengthSeconds >= 0.0)
+        end = juce::jmin (end, start + (juce::int64) std::llround (lengthSeconds * reader->sampleRate));
+
+    juce::AudioBuffer<float> buffer (numChannels, blockSize);
+    for (juce::int64 pos = start; pos < end; pos += blockSize)
+    {
+        if (shouldCancel != nullptr && shouldCancel())
+            return std::nullopt;
+
+        const auto numSamples = (int) juce::jmin ((juce::int64) blockSize, end - pos);
+        if (! reader->read (&buffer, 0, numSamples, pos, true, true))
+            return std::nullopt;
+
+        meter.process (buffer, 0, numSamples);
+    }
+
+    return meter.getResult();
+}
+
+} // namespace waive
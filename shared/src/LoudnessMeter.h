@@ -0,0 +1,107 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace waive
+{
+
+//==============================================================================
+/** Streaming EBU R128 / ITU-R BS.1770-4 loudness and true-peak meter.
+
+    Feed it blocks as they are produced (a render, an encoder pass, a file
+    read) and ask for the result at the end; nothing is buffered beyond the
+    per-100 ms block energies, so a single pass over the audio is enough.
+
+    Measures momentary (400 ms) and short-term (3 s) loudness maxima, gated
+    integrated loudness, loudness range (LRA) and true peak from a 4x
+    oversampled signal (2x at 96 kHz and above). Levels below the meter's
+    floor are reported as floorDb so results stay JSON-safe. */
+class LoudnessMeter
+{
+public:
+    static constexpr double floorDb = -120.0;
+
+    struct Result
+    {
+        double integratedLufs = floorDb;
+        double momentaryMaxLufs = floorDb;
+        double shortTermMaxLufs = floorDb;
+        double loudnessRangeLu = 0.0;
+        double truePeakDb = floorDb;        // dBTP
+        double samplePeakDb = floorDb;      // dBFS
+        double durationSeconds = 0.0;
+
+        /** { integrated_lufs, momentary_max_lufs, short_term_max_lufs,
+              loudness_range_lu, true_peak_dbtp, sample_peak_dbfs, duration } */
+        juce::var toVar() const;
+    };
+
+    LoudnessMeter() = default;
+
+    void prepare (double sampleRate, int numChannels);
+    void reset();
+
+    void process (const float* const* channelData, int numChannels, int numSamples);
+    void process (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    Result getResult() const;
+
+    /** Momentary (400 ms) loudness in LUFS every 100 ms so far. The first
+        value covers the first 400 ms. */
+    std::vector<double> getMomentaryLoudness() const;
+
+    /** Reads a whole file through the meter. Returns nullopt if the file can't
+        be read or shouldCancel() returns true part-way. */
+    static std::optional<Result> measureFile (const juce::File& file,
+                                              const std::function<bool()>& shouldCancel = {});
+
+    /** Measures lengthSeconds of the file from startSeconds (source time); a
+        negative length reads to the end. */
+    static std::optional<Result> measureFile (const juce::File& file,
+                                              double startSeconds,
+                                              double lengthSeconds,
+                                              const std::function<bool()>& shouldCancel = {});
+
+private:
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    struct ChannelState
+    {
+        double z1[2] {}, z2[2] {};          // transposed DF-II state, one pair per stage
+        std::vector<float> history;         // true-peak interpolator delay line
+        int historyPos = 0;
+        double weight = 1.0;
+    };
+
+    float processTruePeak (ChannelState& channel, float sample);
+    void finishSubBlock();
+
+    double sampleRate = 0.0;
+    Biquad shelf, highPass;
+    std::vector<ChannelState> channels;
+
+    int oversampling = 4;
+    int tapsPerPhase = 0;
+    std::vector<std::vector<float>> phaseCoefficients;
+
+    int subBlockLength = 0;                 // 100 ms in samples
+    int subBlockPos = 0;
+    double subBlockEnergy = 0.0;
+    std::vector<double> recentSubBlocks;    // ring of the last 30 sub-block energies
+    int numSubBlocks = 0;
+
+    std::vector<double> momentaryBlocks;    // 400 ms gating block energies, 100 ms hop
+    std::vector<double> shortTermBlocks;    // 3 s block energies, 100 ms hop
+
+    float truePeak = 0.0f;
+    float samplePeak = 0.0f;
+    juce::int64 samplesProcessed = 0;
+};
+
+} // namespace waive
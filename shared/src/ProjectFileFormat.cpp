@@ -0,0 +1,268 @@
+#include "ProjectFileFormat.h"
+
+#if ! JUCE_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace waive
+{
+
+namespace
+{
+constexpr int compressedFlag = 1;
+
+// The binary tree is already compact; at large sizes the extra ratio of
+// higher zlib levels costs more save time than it is worth.
+constexpr int compressionLevel = 1;
+
+constexpr size_t writeBufferSize = 1 << 16;
+
+juce::File createTemporarySibling (const juce::File& destinationFile)
+{
+    auto tempFile = destinationFile.getSiblingFile (destinationFile.getFileName()
+                                                    + ".tmp-"
+                                                    + juce::Uuid().toString());
+
+    if (tempFile.exists())
+        (void) tempFile.deleteFile();
+
+    return tempFile;
+}
+
+/** Waits for the file's data to reach the disk. The renamed project is only
+    durable once its folder entry is synced too. */
+bool syncFileToDisk (const juce::File& file)
+{
+   #if JUCE_WINDOWS
+    // No portable handle from JUCE here; Windows flushes on its own schedule.
+    juce::ignoreUnused (file);
+    return true;
+   #else
+    const int fd = ::open (file.getFullPathName().toRawUTF8(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    const bool synced = ::fsync (fd) == 0;
+    ::close (fd);
+    return synced;
+   #endif
+}
+
+bool moveIntoPlace (const juce::File& tempFile, const juce::File& destinationFile)
+{
+    const bool success = destinationFile.existsAsFile()
+                           ? tempFile.replaceFileIn (destinationFile)
+                           : tempFile.moveFileTo (destinationFile);
+
+    if (! success && tempFile.exists())
+        (void) tempFile.deleteFile();
+
+    return success;
+}
+}
+
+juce::String ProjectFileFormat::getFileWildcard()
+{
+    return juce::String ("*") + xmlFileExtension + ";*" + binaryFileExtension;
+}
+
+bool ProjectFileFormat::isProjectFile (const juce::File& file)
+{
+    return file.hasFileExtension (xmlFileExtension) || file.hasFileExtension (binaryFileExtension);
+}
+
+ProjectFileFormat::Format ProjectFileFormat::getFormatForSaving (const juce::File& file, bool compressBinary)
+{
+    if (! file.hasFileExtension (binaryFileExtension))
+        return Format::xml;
+
+    return compressBinary ? Format::compressedBinary : Format::binary;
+}
+
+ProjectFileFormat::Format ProjectFileFormat::detectFormat (const juce::File& file)
+{
+    juce::FileInputStream input (file);
+    if (! input.openedOk())
+        return Format::unknown;
+
+    if (input.getTotalLength() >= 12 && input.readInt() == binaryMagic)
+    {
+        (void) input.readInt();
+        return (input.readInt() & compressedFlag) != 0 ? Format::compressedBinary : Format::binary;
+    }
+
+    return Format::xml;
+}
+
+juce::ValueTree ProjectFileFormat::readState (const juce::File& file)
+{
+    const auto format = detectFormat (file);
+
+    if (format == Format::unknown)
+        return {};
+
+    if (format == Format::xml)
+    {
+        if (auto xml = juce::XmlDocument::parse (file))
+            return juce::ValueTree::fromXml (*xml);
+
+        return {};
+    }
+
+    // One read of the whole file; the tree is then parsed from memory.
+    juce::MemoryBlock data;
+    if (! file.loadFileAsData (data))
+        return {};
+
+    juce::MemoryInputStream input (data, false);
+    (void) input.readInt();
+    if (input.readInt() > binaryVersion)
+        return {};
+
+    if ((input.readInt() & compressedFlag) != 0)
+    {
+        juce::GZIPDecompressorInputStream decompressed (&input, false);
+        return juce::ValueTree::readFromStream (decompressed);
+    }
+
+    return juce::ValueTree::readFromStream (input);
+}
+
+juce::Result ProjectFileFormat::writeState (const juce::ValueTree& state, const juce::File& file, Format format)
+{
+    return writeState (state, file, format, {});
+}
+
+juce::Result ProjectFileFormat::writeState (const juce::ValueTree& state, const juce::File& file, Format format,
+                                            const ProjectWriteOptions& options)
+{
+    const auto reportProgress = [&options] (float progress)
+    {
+        if (options.onProgress)
+            options.onProgress (progress);
+    };
+
+    if (! state.isValid() || format == Format::unknown)
+        return juce::Result::fail ("No project state to write");
+
+    const auto parentDirectory = file.getParentDirectory();
+    if (parentDirectory == juce::File() || ! parentDirectory.isDirectory())
+        return juce::Result::fail ("Folder does not exist: " + parentDirectory.getFullPathName());
+
+    auto tempFile = createTemporarySibling (file);
+    reportProgress (0.0f);
+
+    {
+        juce::FileOutputStream stream (tempFile, writeBufferSize);
+        if (! stream.openedOk())
+            return juce::Result::fail ("Could not write " + tempFile.getFullPathName());
+
+        if (format == Format::xml)
+        {
+            auto xml = state.createXml();
+            if (xml == nullptr)
+            {
+                stream.flush();
+                (void) tempFile.deleteFile();
+                return juce::Result::fail ("Could not convert the project to XML");
+            }
+
+            reportProgress (0.4f);
+            xml->writeTo (stream, {});
+        }
+        else
+        {
+            const bool compress = format == Format::compressedBinary;
+            stream.writeInt (binaryMagic);
+            stream.writeInt (binaryVersion);
+            stream.writeInt (compress ? compressedFlag : 0);
+
+            if (compress)
+            {
+                juce::GZIPCompressorOutputStream compressed (stream, compressionLevel);
+                state.writeToStream (compressed);
+                compressed.flush();
+            }
+            else
+            {
+                state.writeToStream (stream);
+            }
+        }
+
+        stream.flush();
+        if (stream.getStatus().failed())
+        {
+            (void) tempFile.deleteFile();
+            return juce::Result::fail ("Could not write " + file.getFullPathName() + ": " + stream.getStatus().getErrorMessage());
+        }
+    }
+
+    reportProgress (0.8f);
+
+    if (options.syncToDisk && ! syncFileToDisk (tempFile))
+    {
+        (void) tempFile.deleteFile();
+        return juce::Result::fail ("Could not flush " + file.getFullPathName() + " to disk");
+    }
+
+    reportProgress (0.9f);
+
+    if (! moveIntoPlace (tempFile, file))
+        return juce::Result::fail ("Could not replace " + file.getFullPathName());
+
+    if (options.syncToDisk)
+        (void) syncFileToDisk (file.getParentDirectory());
+
+    reportProgress (1.0f);
+    return juce::Result::ok();
+}
+
+std::unique_ptr<te::Edit> ProjectFileFormat::loadEdit (te::Engine& engine, const juce::File& file)
+{
+    const auto format = detectFormat (file);
+    if (format == Format::xml || format == Format::unknown)
+        return te::loadEditFromFile (engine, file);
+
+    auto state = readState (file);
+    if (! state.hasType (te::IDs::EDIT))
+    {
+        juce::Logger::writeToLog ("ProjectFileFormat: could not read " + file.getFullPathName());
+        return te::createEmptyEdit (engine, file);
+    }
+
+    auto projectItemId = te::ProjectItemID::fromProperty (state, te::IDs::projectID);
+    if (! projectItemId.isValid())
+        projectItemId = te::ProjectItemID::createNewID (0);
+
+    return te::Edit::createEdit (te::Edit::Options
+    {
+        engine,
+        state,
+        projectItemId,
+        te::Edit::forEditing,
+        nullptr,
+        te::Edit::getDefaultNumUndoLevels(),
+        [file] { return file; },
+        [file] (const juce::String& path)
+        {
+            // Media paths are stored relative to the project folder once collected.
+            return juce::File::isAbsolutePath (path) ? juce::File (path) : file.getSiblingFile (path);
+        },
+        0
+    });
+}
+
+bool ProjectFileFormat::replaceFileAtomically (const juce::File& sourceFile, const juce::File& destinationFile)
+{
+    if (! sourceFile.existsAsFile())
+        return false;
+
+    auto tempFile = createTemporarySibling (destinationFile);
+    if (! sourceFile.copyFileTo (tempFile))
+        return false;
+
+    return moveIntoPlace (tempFile, destinationFile);
+}
+
+} // namespace waive
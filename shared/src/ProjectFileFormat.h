@@ -0,0 +1,81 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+#include <functional>
+#include <memory>
+
+namespace te = tracktion;
+
+namespace waive
+{
+
+/** Extra work for ProjectFileFormat::writeState(), which may run on a
+    background thread. */
+struct ProjectWriteOptions
+{
+    bool syncToDisk = false;                        // fsync the file and its folder before returning
+    std::function<void (float)> onProgress;         // 0..1, called on the writing thread
+};
+
+//==============================================================================
+/** Reads and writes project files as Tracktion XML or as a compact binary tree.
+
+    Binary projects hold the edit's ValueTree as written by
+    juce::ValueTree::writeToStream(), optionally gzipped, after a short
+    header. They skip building and parsing XML text, so large edits load and
+    save several times faster and are a fraction of the size. A file's format
+    is detected from its contents when reading, so either kind opens whatever
+    its extension. When saving, the extension decides: ".waiveproject" is
+    binary, anything else stays XML for import into and export to other
+    Tracktion-based tools.
+
+    Every write goes to a temporary sibling file that replaces the target
+    only once it is complete. */
+class ProjectFileFormat
+{
+public:
+    enum class Format
+    {
+        xml,
+        binary,
+        compressedBinary,
+        unknown
+    };
+
+    static constexpr const char* xmlFileExtension = ".tracktionedit";
+    static constexpr const char* binaryFileExtension = ".waiveproject";
+
+    /** "*.tracktionedit;*.waiveproject", for file choosers. */
+    static juce::String getFileWildcard();
+    static bool isProjectFile (const juce::File& file);
+
+    /** Binary for ".waiveproject" files, xml for everything else. */
+    static Format getFormatForSaving (const juce::File& file, bool compressBinary = true);
+
+    /** Looks at the first bytes only. */
+    static Format detectFormat (const juce::File& file);
+
+    /** Returns an invalid tree if the file is missing, corrupt or from a
+        newer binary version. */
+    static juce::ValueTree readState (const juce::File& file);
+
+    /** Safe to call from any thread on a tree no other thread is changing,
+        such as a copy of the edit's state. */
+    static juce::Result writeState (const juce::ValueTree& state, const juce::File& file, Format format);
+    static juce::Result writeState (const juce::ValueTree& state, const juce::File& file, Format format,
+                                    const ProjectWriteOptions& options);
+
+    /** Loads either format as an edit backed by file. XML goes through
+        te::loadEditFromFile() unchanged. */
+    static std::unique_ptr<te::Edit> loadEdit (te::Engine& engine, const juce::File& file);
+
+    /** Copies sourceFile next to destinationFile, then renames it over the
+        destination, so readers never see a partly written project. */
+    static bool replaceFileAtomically (const juce::File& sourceFile, const juce::File& destinationFile);
+
+    static constexpr int binaryMagic = 0x4a505657;      // "WVPJ"
+    static constexpr int binaryVersion = 1;
+};
+
+} // namespace waive
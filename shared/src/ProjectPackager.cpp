@@ -1,4 +1,5 @@
 #include "ProjectPackager.h"
+#include "ProjectFileFormat.h"
 #include <tracktion_engine/tracktion_engine.h>
 #include <filesystem>
 
@@ -51,7 +52,7 @@ bool copyDirectoryRecursively (const juce::File& sourceDir, const juce::File& de
     return true;
 }
 
-bool writeEditSnapshotToFile (te::Edit& edit, const juce::File& destinationFile)
+bool writeEditSnapshotToFile (te::Edit& edit, const juce::File& destinationFile, bool compressBinary)
 {
     edit.flushState();
 
@@ -59,10 +60,8 @@ bool writeEditSnapshotToFile (te::Edit& edit, const juce::File& destinationFile)
     if (parentDir == juce::File() || (! parentDir.exists() && parentDir.createDirectory().failed()))
         return false;
 
-    if (auto xml = edit.state.createXml())
-        return xml->writeTo (destinationFile, {});
-
-    return false;
+    return ProjectFileFormat::writeState (edit.state, destinationFile,
+                                          ProjectFileFormat::getFormatForSaving (destinationFile, compressBinary)).wasOk();
 }
 
 bool preparePackagingStagingDirectory (const juce::File& sourceProjectDir,
@@ -229,7 +228,8 @@ juce::File ProjectPackager::getUniqueTargetFile (const juce::File& targetDir, co
 
 ProjectPackager::CollectResult ProjectPackager::collectAndSave (te::Edit& edit,
                                                                 const juce::File& projectDir,
-                                                                const juce::File& projectFile)
+                                                                const juce::File& projectFile,
+                                                                bool compressBinary)
 {
     CollectResult result;
     std::vector<std::pair<te::AudioClipBase*, juce::String>> updatedReferences;
@@ -339,7 +339,11 @@ ProjectPackager::CollectResult ProjectPackager::collectAndSave (te::Edit& edit,
     rewriteProjectMediaReferencesRelativeToProject (edit, projectDir, updatedReferences);
 
     edit.flushState();
-    if (! te::EditFileOperations (edit).saveAs (saveTarget, true))
+    const auto saveFormat = ProjectFileFormat::getFormatForSaving (saveTarget, compressBinary);
+    const bool saved = saveFormat == ProjectFileFormat::Format::xml
+                         ? te::EditFileOperations (edit).saveAs (saveTarget, true)
+                         : ProjectFileFormat::writeState (edit.state, saveTarget, saveFormat).wasOk();
+    if (! saved)
     {
         rollbackCollectedMedia (updatedReferences, copiedFiles);
         if (! saveTargetExisted && saveTarget.existsAsFile())
@@ -471,7 +475,7 @@ bool ProjectPackager::packageAsZip (const juce::File& projectFile, const juce::F
         if (isPackagedAuxiliaryProjectFile (file))
             continue;
 
-        if (file.hasFileExtension (".tracktionedit"))
+        if (ProjectFileFormat::isProjectFile (file))
             continue;
 
         builder.addFile (file, 9, relativePath);
@@ -512,7 +516,8 @@ bool ProjectPackager::packageAsZip (const juce::File& projectFile, const juce::F
 
 ProjectPackager::PackageResult ProjectPackager::packageEditAsZip (te::Edit& edit,
                                                                   const juce::File& projectFile,
-                                                                  const juce::File& outputZip)
+                                                                  const juce::File& outputZip,
+                                                                  bool compressBinary)
 {
     PackageResult result;
 
@@ -545,14 +550,14 @@ ProjectPackager::PackageResult ProjectPackager::packageEditAsZip (te::Edit& edit
         return result;
     }
 
-    if (! writeEditSnapshotToFile (edit, stagingProjectFile))
+    if (! writeEditSnapshotToFile (edit, stagingProjectFile, compressBinary))
     {
         result.errors.add ("Failed to write packaging snapshot project file");
         cleanupStagingRoot();
         return result;
     }
 
-    auto stagingEdit = te::loadEditFromFile (edit.engine, stagingProjectFile);
+    auto stagingEdit = ProjectFileFormat::loadEdit (edit.engine, stagingProjectFile);
     if (stagingEdit == nullptr)
     {
         result.errors.add ("Failed to load packaging snapshot project");
@@ -560,7 +565,7 @@ ProjectPackager::PackageResult ProjectPackager::packageEditAsZip (te::Edit& edit
         return result;
     }
 
-    auto collectResult = collectAndSave (*stagingEdit, stagingProjectDir, stagingProjectFile);
+    auto collectResult = collectAndSave (*stagingEdit, stagingProjectDir, stagingProjectFile, compressBinary);
     result.filesCopied = collectResult.filesCopied;
     result.bytesCopied = collectResult.bytesCopied;
     if (! collectResult.errors.isEmpty())
@@ -32,15 +32,19 @@ public:
         juce::StringArray errors;
     };
 
+    /** Binary projects are written compressed or not according to
+        compressBinary, which callers take from the user's project settings. */
     static CollectResult collectAndSave (tracktion::engine::Edit& edit,
                                          const juce::File& projectDir,
-                                         const juce::File& projectFile = {});
+                                         const juce::File& projectFile = {},
+                                         bool compressBinary = true);
     static juce::Array<juce::File> findExternalMedia (tracktion::engine::Edit& edit, const juce::File& projectDir);
     static juce::Array<juce::File> findUnusedMedia (tracktion::engine::Edit& edit, const juce::File& projectDir);
     static RemoveResult removeUnusedMedia (tracktion::engine::Edit& edit, const juce::File& projectDir);
     static PackageResult packageEditAsZip (tracktion::engine::Edit& edit,
                                            const juce::File& projectFile,
-                                           const juce::File& outputZip);
+                                           const juce::File& outputZip,
+                                           bool compressBinary = true);
     static bool packageAsZip (const juce::File& projectFile, const juce::File& outputZip);
     static bool isWithinProjectDirectory (const juce::File& file, const juce::File& projectDir);
 
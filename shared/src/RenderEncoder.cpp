@@ -0,0 +1,220 @@
+#include "RenderEncoder.h"
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace waive
+{
+
+namespace
+{
+constexpr int encodeBlockSize = 8192;
+
+std::unique_ptr<juce::AudioFormat> createFormatForTarget (const juce::File& file)
+{
+    if (file.hasFileExtension (".flac"))
+        return std::make_unique<juce::FlacAudioFormat>();
+
+    if (file.hasFileExtension (".ogg"))
+        return std::make_unique<juce::OggVorbisAudioFormat>();
+
+    return std::make_unique<juce::WavAudioFormat>();
+}
+
+std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapMaster (const juce::File& master)
+{
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader (juce::WavAudioFormat().createMemoryMappedReader (master));
+
+    if (reader == nullptr || ! reader->mapEntireFile())
+        return nullptr;
+
+    return reader;
+}
+}
+
+std::optional<LoudnessMeter::Result> RenderEncoder::analyse (const juce::File& master)
+{
+    auto reader = mapMaster (master);
+    if (reader == nullptr)
+        return std::nullopt;
+
+    const auto numChannels = (int) reader->numChannels;
+    LoudnessMeter meter;
+    meter.prepare (reader->sampleRate, numChannels);
+
+    juce::AudioBuffer<float> buffer (numChannels, encodeBlockSize);
+    for (juce::int64 pos = 0; pos < reader->lengthInSamples; pos += encodeBlockSize)
+    {
+        const auto numSamples = (int) juce::jmin ((juce::int64) encodeBlockSize, reader->lengthInSamples - pos);
+        reader->read (&buffer, 0, numSamples, pos, true, true);
+        meter.process (buffer, 0, numSamples);
+    }
+
+    return meter.getResult();
+}
+
+float RenderEncoder::computeGain (const LoudnessMeter::Result& master,
+                                  const Normalisation& normalisation,
+                                  bool* limitedByTruePeak)
+{
+    if (limitedByTruePeak != nullptr)
+        *limitedByTruePeak = false;
+
+    // Below -80 dBFS there is nothing meaningful to normalise.
+    if (normalisation.mode == Normalisation::Mode::none || master.samplePeakDb <= -80.0)
+        return 1.0f;
+
+    if (normalisation.mode == Normalisation::Mode::peak)
+        return juce::Decibels::decibelsToGain ((float) (normalisation.targetDb - master.samplePeakDb));
+
+    if (master.integratedLufs <= LoudnessMeter::floorDb)
+        return 1.0f;
+
+    auto gainDb = normalisation.targetDb - master.integratedLufs;
+    if (master.truePeakDb + gainDb > normalisation.truePeakCeilingDb)
+    {
+        gainDb = normalisation.truePeakCeilingDb - master.truePeakDb;
+        if (limitedByTruePeak != nullptr)
+            *limitedByTruePeak = true;
+    }
+
+    return juce::Decibels::decibelsToGain ((float) gainDb);
+}
+
+LoudnessMeter::Result RenderEncoder::Result::getOutputLoudness() const
+{
+    const auto gainDb = (double) juce::Decibels::gainToDecibels (gain);
+    auto shift = [gainDb] (double level)
+    {
+        return level <= LoudnessMeter::floorDb ? level : level + gainDb;
+    };
+
+    auto output = master;
+    output.integratedLufs = shift (master.integratedLufs);
+    output.momentaryMaxLufs = shift (master.momentaryMaxLufs);
+    output.shortTermMaxLufs = shift (master.shortTermMaxLufs);
+    output.truePeakDb = shift (master.truePeakDb);
+    output.samplePeakDb = shift (master.samplePeakDb);
+    return output;
+}
+
+juce::String RenderEncoder::encodeTarget (const juce::File& master, const Target& target, float gain)
+{
+    auto reader = mapMaster (master);
+    if (reader == nullptr)
+        return "Failed to map rendered master: " + master.getFileName();
+
+    const auto sourceRate = reader->sampleRate;
+    const auto targetRate = target.sampleRate > 0.0 ? target.sampleRate : sourceRate;
+    const auto numChannels = (int) reader->numChannels;
+    const auto sourceLength = reader->lengthInSamples;
+
+    auto format = createFormatForTarget (target.file);
+    auto bitDepth = target.bitDepth;
+    if (target.file.hasFileExtension (".flac"))
+        bitDepth = juce::jmin (24, bitDepth);
+    else if (target.file.hasFileExtension (".ogg"))
+        bitDepth = 16;
+
+    // Written next to the target and swapped in only once complete.
+    juce::TemporaryFile tempFile (target.file);
+    std::unique_ptr<juce::OutputStream> stream (new juce::FileOutputStream (tempFile.getFile()));
+    auto options = juce::AudioFormatWriterOptions()
+                       .withSampleRate (targetRate)
+                       .withNumChannels (numChannels)
+                       .withBitsPerSample (bitDepth)
+                       .withQualityOptionIndex (target.quality);
+
+    auto writer = format->createWriterFor (stream, options);
+    if (writer == nullptr)
+        return "Unsupported encoder settings for " + target.file.getFileName();
+
+    juce::AudioFormatReaderSource readerSource (reader.get(), false);
+    std::unique_ptr<juce::ResamplingAudioSource> resampler;
+    juce::AudioSource* source = &readerSource;
+
+    if (std::abs (targetRate - sourceRate) > 0.5)
+    {
+        resampler = std::make_unique<juce::ResamplingAudioSource> (&readerSource, false, numChannels);
+        resampler->setResamplingRatio (sourceRate / targetRate);
+        source = resampler.get();
+    }
+
+    source->prepareToPlay (encodeBlockSize, targetRate);
+
+    const auto outputLength = (juce::int64) std::ceil ((double) sourceLength * targetRate / sourceRate);
+    juce::AudioBuffer<float> buffer (numChannels, encodeBlockSize);
+    bool written = true;
+
+    for (juce::int64 pos = 0; pos < outputLength && written; pos += encodeBlockSize)
+    {
+        const auto numSamples = (int) juce::jmin ((juce::int64) encodeBlockSize, outputLength - pos);
+        juce::AudioSourceChannelInfo info (&buffer, 0, numSamples);
+        source->getNextAudioBlock (info);
+
+        if (gain != 1.0f)
+            buffer.applyGain (0, numSamples, gain);
+
+        written = writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+    }
+
+    source->releaseResources();
+    writer.reset();
+
+    if (! written)
+        return "Failed to write " + target.file.getFileName();
+
+    if (! tempFile.overwriteTargetFileWithTemporary())
+        return "Failed to replace " + target.file.getFileName();
+
+    return {};
+}
+
+RenderEncoder::Result RenderEncoder::encode (const juce::File& master,
+                                             const std::vector<Target>& targets,
+                                             Normalisation normalisation,
+                                             int maxThreads)
+{
+    Result result;
+
+    auto analysis = analyse (master);
+    if (! analysis.has_value())
+    {
+        result.errors.add ("Failed to map rendered master: " + master.getFileName());
+        return result;
+    }
+
+    result.master = *analysis;
+    result.gain = computeGain (result.master, normalisation, &result.gainLimitedByTruePeak);
+
+    std::vector<juce::String> errors (targets.size());
+    std::atomic<size_t> nextTarget { 0 };
+
+    auto worker = [&]
+    {
+        for (auto i = nextTarget++; i < targets.size(); i = nextTarget++)
+            errors[i] = encodeTarget (master, targets[i], result.gain);
+    };
+
+    const auto numThreads = juce::jlimit<size_t> (1, juce::jmax<size_t> (1, targets.size()),
+                                                  (size_t) (maxThreads > 0 ? maxThreads
+                                                                           : juce::SystemStats::getNumCpus()));
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numThreads; ++i)
+        workers.emplace_back (worker);
+
+    worker();
+
+    for (auto& thread : workers)
+        thread.join();
+
+    for (const auto& error : errors)
+        if (error.isNotEmpty())
+            result.errors.add (error);
+
+    result.ok = result.errors.isEmpty();
+    return result;
+}
+
+} // namespace waive
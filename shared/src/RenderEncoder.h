@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "LoudnessMeter.h"
+#include <optional>
+#include <vector>
+
+namespace waive
+{
+
+//==============================================================================
+/** Fans one rendered float master out to several encoded files.
+
+    The edit is rendered once to a 32-bit float WAV. That file is memory-mapped
+    for one LoudnessMeter pass (loudness, true peak) and for every encoder, so
+    nothing is decoded twice. Targets (WAV/FLAC/OGG at their own bit depth and
+    sample rate) are then encoded in parallel, with one normalisation gain
+    applied while each encoder writes. */
+class RenderEncoder
+{
+public:
+    struct Target
+    {
+        juce::File file;            // format follows the extension (.wav, .flac, .ogg)
+        double sampleRate = 0.0;    // 0 = keep the master's rate
+        int bitDepth = 24;          // clamped to 24 for FLAC, ignored for OGG
+        int quality = 0;            // OGG quality index 0-10
+    };
+
+    struct Normalisation
+    {
+        enum class Mode
+        {
+            none,
+            peak,       // sample peak lands on targetDb (dBFS)
+            loudness    // integrated loudness lands on targetDb (LUFS)
+        };
+
+        Mode mode = Mode::none;
+        double targetDb = 0.0;
+        double truePeakCeilingDb = -1.0;    // loudness mode never pushes true peak past this
+    };
+
+    struct Result
+    {
+        bool ok = false;
+        LoudnessMeter::Result master;       // measured before any gain
+        float gain = 1.0f;                  // gain applied to every target
+        bool gainLimitedByTruePeak = false;
+        juce::StringArray errors;
+
+        /** Loudness of the encoded targets (the master shifted by the gain). */
+        LoudnessMeter::Result getOutputLoudness() const;
+    };
+
+    /** Encodes master into every target, normalised as requested (silent
+        masters are left alone). Targets run on up to maxThreads threads
+        (0 = one per core). */
+    static Result encode (const juce::File& master,
+                          const std::vector<Target>& targets,
+                          Normalisation normalisation = {},
+                          int maxThreads = 0);
+
+    /** Runs the mapped master through a LoudnessMeter. Returns nullopt if the
+        file can't be mapped. */
+    static std::optional<LoudnessMeter::Result> analyse (const juce::File& master);
+
+    /** Gain that applies the normalisation to a master with this loudness. */
+    static float computeGain (const LoudnessMeter::Result& master,
+                              const Normalisation& normalisation,
+                              bool* limitedByTruePeak = nullptr);
+
+    /** Encodes a single target; returns an empty string on success. */
+    static juce::String encodeTarget (const juce::File& master, const Target& target, float gain);
+};
+
+} // namespace waive
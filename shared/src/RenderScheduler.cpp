@@ -0,0 +1,478 @@
+#include "RenderScheduler.h"
+#include "LoudnessMeter.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+
+namespace waive
+{
+
+namespace
+{
+/** Runs fn on the message thread and waits for it to return. Tracktion
+    expects edits and their plugins to be built and torn down there. */
+void callOnMessageThread (const std::function<void()>& fn)
+{
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        fn();
+        return;
+    }
+
+    juce::WaitableEvent finished;
+    juce::MessageManager::callAsync ([&fn, &finished]
+    {
+        fn();
+        finished.signal();
+    });
+    finished.wait (-1);
+}
+
+/** Waits without starving callOnMessageThread() when called on the message thread. */
+void waitBriefly()
+{
+   #if JUCE_MODAL_LOOPS_PERMITTED
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        juce::MessageManager::getInstance()->runDispatchLoopUntil (5);
+        return;
+    }
+   #endif
+
+    juce::Thread::sleep (5);
+}
+}
+
+//==============================================================================
+class RenderScheduler::RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob (RenderScheduler& owner, juce::String id, Request r)
+        : juce::ThreadPoolJob ("Render " + id),
+          scheduler (owner), renderId (std::move (id)), request (std::move (r))
+    {
+    }
+
+    const juce::String& getRenderId() const noexcept    { return renderId; }
+
+    JobStatus runJob() override
+    {
+        if (scheduler.isCancelled (renderId))
+        {
+            scheduler.setStatus (renderId, Status::failed, "Cancelled");
+            return jobHasFinished;
+        }
+
+        scheduler.setStatus (renderId, Status::rendering);
+
+        // Only the render pass runs on this thread; the snapshot edit is
+        // built and destroyed on the message thread.
+        std::unique_ptr<te::Edit> snapshot;
+        callOnMessageThread ([&]
+        {
+            snapshot = createSnapshotEdit (scheduler.engine, request.editState, request.editFile);
+        });
+
+        if (snapshot == nullptr)
+        {
+            scheduler.setStatus (renderId, Status::failed, "Failed to create a render snapshot");
+            return jobHasFinished;
+        }
+
+        const auto error = render (*snapshot);
+        callOnMessageThread ([&] { snapshot.reset(); });
+
+        if (error.isNotEmpty())
+        {
+            scheduler.setStatus (renderId, Status::failed, error);
+            return jobHasFinished;
+        }
+
+        if (scheduler.isCancelled (renderId))
+        {
+            request.destFile.deleteFile();
+            scheduler.setStatus (renderId, Status::failed, "Cancelled");
+            return jobHasFinished;
+        }
+
+        if (request.measureLoudness)
+            if (auto loudness = LoudnessMeter::measureFile (request.destFile))
+                scheduler.setLoudness (renderId, loudness->toVar());
+
+        scheduler.setStatus (renderId, Status::done);
+        return jobHasFinished;
+    }
+
+private:
+    /** Returns an error message, or an empty string once the file is written. */
+    juce::String render (te::Edit& snapshot)
+    {
+        auto tracksMask = request.tracksMask;
+        if (tracksMask.isZero())
+            for (auto* track : te::getAudioTracks (snapshot))
+                tracksMask.setBit (track->getIndexInEditTrackList());
+
+        if (! request.destFile.getParentDirectory().createDirectory())
+            return "Failed to create output directory";
+
+        auto format = createFormatForFile (request.destFile);
+
+        te::Renderer::Parameters params (snapshot);
+        params.destFile = request.destFile;
+        params.audioFormat = format.get();
+        params.bitDepth = request.bitDepth;
+        params.quality = request.quality;
+        params.time = request.range;
+        params.tracksToDo = tracksMask;
+        params.usePlugins = true;
+        params.useMasterPlugins = true;
+
+        if (request.sampleRate > 0.0)
+            params.sampleRateForAudio = request.sampleRate;
+
+        if (te::Renderer::renderToFile ("Render " + renderId, params) == juce::File())
+            return "Render failed";
+
+        return {};
+    }
+
+    RenderScheduler& scheduler;
+    juce::String renderId;
+    Request request;
+};
+
+//==============================================================================
+RenderScheduler::RenderScheduler (te::Engine& e, int numThreads)
+    : engine (e),
+      pool (juce::jmax (1, numThreads))
+{
+}
+
+RenderScheduler::~RenderScheduler()
+{
+    // Queued renders are dropped. Running ones still need the message thread
+    // to tear down their snapshots, which waitUntilIdle() keeps serviced.
+    pool.removeAllJobs (false, 0);
+    waitUntilIdle (30000);
+    cancelPendingUpdate();
+}
+
+juce::String RenderScheduler::enqueue (Request request)
+{
+    juce::String renderId;
+
+    {
+        const juce::ScopedLock lock (recordLock);
+        renderId = "render_" + juce::String (nextRenderNumber++);
+
+        Record record;
+        record.editId = request.editId;
+        record.batchId = request.batchId;
+        record.file = request.destFile;
+        records[renderId] = record;
+
+        if (request.batchId.isNotEmpty())
+            batches[request.batchId].add (renderId);
+    }
+
+    pool.addJob (new RenderJob (*this, renderId, std::move (request)), true);
+    return renderId;
+}
+
+juce::var RenderScheduler::getStatus (const juce::String& renderId)
+{
+    const juce::ScopedLock lock (recordLock);
+    auto status = createStatusVar (renderId);
+
+    // Batch members are dropped with their batch.
+    if (auto it = records.find (renderId); it != records.end() && isFinished (it->second) && it->second.batchId.isEmpty())
+        records.erase (it);
+
+    return status;
+}
+
+juce::var RenderScheduler::createStatusVar (const juce::String& renderId) const
+{
+    auto it = records.find (renderId);
+    if (it == records.end())
+        return {};
+
+    const auto statusName = [] (Status status) -> juce::String
+    {
+        switch (status)
+        {
+            case Status::queued:    return "queued";
+            case Status::rendering: return "rendering";
+            case Status::done:      return "done";
+            case Status::failed:    break;
+        }
+
+        return "failed";
+    };
+
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("render_id", renderId);
+    obj->setProperty ("edit_id", it->second.editId);
+    if (it->second.batchId.isNotEmpty())
+        obj->setProperty ("batch_id", it->second.batchId);
+    obj->setProperty ("status", statusName (it->second.status));
+    obj->setProperty ("file_path", it->second.file.getFullPathName());
+    if (it->second.message.isNotEmpty())
+        obj->setProperty ("message", it->second.message);
+    if (! it->second.loudness.isVoid())
+        obj->setProperty ("loudness", it->second.loudness);
+    return juce::var (obj);
+}
+
+juce::String RenderScheduler::createBatch()
+{
+    const juce::ScopedLock lock (recordLock);
+
+    auto batchId = "batch_" + juce::String (nextBatchNumber++);
+    batches[batchId];
+    return batchId;
+}
+
+juce::var RenderScheduler::getBatchStatus (const juce::String& batchId)
+{
+    const juce::ScopedLock lock (recordLock);
+
+    auto batchIt = batches.find (batchId);
+    if (batchIt == batches.end())
+        return {};
+
+    juce::Array<juce::var> renders;
+    int completed = 0, failed = 0, started = 0;
+
+    for (const auto& renderId : batchIt->second)
+    {
+        renders.add (createStatusVar (renderId));
+
+        switch (records.at (renderId).status)
+        {
+            case Status::done:      ++completed; break;
+            case Status::failed:    ++failed;    break;
+            case Status::rendering: ++started;   break;
+            case Status::queued:                 break;
+        }
+    }
+
+    const auto total = batchIt->second.size();
+    juce::String status = "queued";
+    if (completed + failed == total)
+        status = failed > 0 ? "failed" : "done";
+    else if (completed + failed + started > 0)
+        status = "rendering";
+
+    auto* obj = new juce::DynamicObject();
+    obj->setProperty ("batch_id", batchId);
+    obj->setProperty ("status", status);
+    obj->setProperty ("total", total);
+    obj->setProperty ("completed", completed);
+    obj->setProperty ("failed", failed);
+    obj->setProperty ("renders", renders);
+
+    if (completed + failed == total)
+    {
+        for (const auto& renderId : batchIt->second)
+            records.erase (renderId);
+
+        batches.erase (batchIt);
+    }
+
+    return juce::var (obj);
+}
+
+void RenderScheduler::cancelBatch (const juce::String& batchId)
+{
+    struct BatchSelector : public juce::ThreadPool::JobSelector
+    {
+        explicit BatchSelector (const juce::StringArray& ids) : renderIds (ids) {}
+
+        bool isJobSuitable (juce::ThreadPoolJob* job) override
+        {
+            auto* renderJob = dynamic_cast<RenderJob*> (job);
+            return renderJob != nullptr && renderIds.contains (renderJob->getRenderId());
+        }
+
+        juce::StringArray renderIds;
+    };
+
+    juce::StringArray renderIds;
+
+    {
+        const juce::ScopedLock lock (recordLock);
+
+        auto batchIt = batches.find (batchId);
+        if (batchIt == batches.end())
+            return;
+
+        renderIds = batchIt->second;
+        for (const auto& renderId : renderIds)
+            records.at (renderId).cancelled = true;
+    }
+
+    // Removes the jobs still waiting; running ones see the flag when they finish.
+    BatchSelector selector (renderIds);
+    pool.removeAllJobs (false, 0, &selector);
+
+    // A job picked up just before the removal may still be marked queued;
+    // it will find its status already final and leave it.
+    for (const auto& renderId : renderIds)
+        setStatus (renderId, Status::failed, "Cancelled", Status::queued);
+}
+
+bool RenderScheduler::waitUntilIdle (int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) juce::jmax (0, timeoutMs);
+
+    while (pool.getNumJobs() > 0)
+    {
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        waitBriefly();
+    }
+
+    return true;
+}
+
+bool RenderScheduler::waitForBatch (const juce::String& batchId, int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) juce::jmax (0, timeoutMs);
+
+    for (;;)
+    {
+        {
+            const juce::ScopedLock lock (recordLock);
+
+            auto batchIt = batches.find (batchId);
+            if (batchIt == batches.end())
+                return false;
+
+            const bool finished = std::all_of (batchIt->second.begin(), batchIt->second.end(),
+                                               [this] (const juce::String& renderId)
+                                               {
+                                                   return isFinished (records.at (renderId));
+                                               });
+            if (finished)
+                return true;
+        }
+
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        waitBriefly();
+    }
+}
+
+bool RenderScheduler::isFinished (const Record& record)
+{
+    return record.status == Status::done || record.status == Status::failed;
+}
+
+bool RenderScheduler::isCancelled (const juce::String& renderId) const
+{
+    const juce::ScopedLock lock (recordLock);
+
+    // A render that has already been forgotten has no one left to report to.
+    auto it = records.find (renderId);
+    return it == records.end() || it->second.cancelled;
+}
+
+void RenderScheduler::setStatus (const juce::String& renderId, Status status, const juce::String& message,
+                                 std::optional<Status> onlyIf)
+{
+    {
+        const juce::ScopedLock lock (recordLock);
+
+        auto it = records.find (renderId);
+        if (it == records.end() || isFinished (it->second))
+            return;
+
+        if (onlyIf.has_value() && it->second.status != *onlyIf)
+            return;
+
+        it->second.status = status;
+        it->second.message = message;
+
+        if (! isFinished (it->second))
+            return;
+
+        const auto batchId = it->second.batchId;
+        finishedRenders.emplace_back (renderId, batchId);
+
+        // Nobody polls a cancelled batch, so it is forgotten once it settles.
+        if (it->second.cancelled)
+        {
+            if (auto batchIt = batches.find (batchId); batchIt != batches.end()
+                && std::all_of (batchIt->second.begin(), batchIt->second.end(),
+                                [this] (const juce::String& id) { return isFinished (records.at (id)); }))
+            {
+                for (const auto& id : batchIt->second)
+                    records.erase (id);
+
+                batches.erase (batchIt);
+            }
+        }
+    }
+
+    triggerAsyncUpdate();
+}
+
+void RenderScheduler::handleAsyncUpdate()
+{
+    decltype (finishedRenders) finished;
+
+    {
+        const juce::ScopedLock lock (recordLock);
+        finished.swap (finishedRenders);
+    }
+
+    for (const auto& [renderId, batchId] : finished)
+        listeners.call ([&] (Listener& l) { l.renderFinished (renderId, batchId); });
+}
+
+void RenderScheduler::setLoudness (const juce::String& renderId, const juce::var& loudness)
+{
+    const juce::ScopedLock lock (recordLock);
+
+    if (auto it = records.find (renderId); it != records.end())
+        it->second.loudness = loudness;
+}
+
+std::unique_ptr<juce::AudioFormat> RenderScheduler::createFormatForFile (const juce::File& file)
+{
+    if (file.hasFileExtension (".flac"))
+        return std::make_unique<juce::FlacAudioFormat>();
+
+    if (file.hasFileExtension (".ogg"))
+        return std::make_unique<juce::OggVorbisAudioFormat>();
+
+    return std::make_unique<juce::WavAudioFormat>();
+}
+
+std::unique_ptr<te::Edit> RenderScheduler::createSnapshotEdit (te::Engine& engine,
+                                                               const juce::ValueTree& state,
+                                                               const juce::File& editFile)
+{
+    auto projectItemId = te::ProjectItemID::fromProperty (state, te::IDs::projectID);
+    if (! projectItemId.isValid())
+        projectItemId = te::ProjectItemID::createNewID (0);
+
+    return te::Edit::createEdit (te::Edit::Options
+    {
+        engine,
+        state.createCopy(),
+        projectItemId,
+        te::Edit::forRendering,
+        nullptr,
+        te::Edit::getDefaultNumUndoLevels(),
+        [editFile] { return editFile; },
+        {},
+        0
+    });
+}
+
+} // namespace waive
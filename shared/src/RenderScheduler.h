@@ -0,0 +1,158 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace te = tracktion;
+
+namespace waive
+{
+
+//==============================================================================
+/** Runs offline renders on a pool of background threads.
+
+    Each request carries a copy of an edit's state, so the live edit can keep
+    changing (or be closed) while its render runs. Requests from different
+    edits render in parallel, up to one thread per core by default.
+    Callers get a render id back and poll getStatus().
+
+    Snapshot edits are built and destroyed on the message thread, as
+    Tracktion expects; only the render pass runs on the pool. A thread that
+    blocks the message thread waiting for renders must use waitUntilIdle()
+    or waitForBatch(), which keep it serviced.
+
+    Related requests (loop ranges, stems, alternate mixes, extra formats) can
+    be grouped into a batch, tracked together with getBatchStatus() and
+    cancelled with cancelBatch(). UI code that shouldn't poll can register a
+    Listener, which hears about each finished render on the message thread. */
+class RenderScheduler : private juce::AsyncUpdater
+{
+public:
+    struct Request
+    {
+        juce::String editId;
+        juce::ValueTree editState;
+        juce::File editFile;
+        juce::File destFile;
+        te::TimeRange range;
+        juce::BigInteger tracksMask;    // empty = every audio track
+
+        // Encoder settings. The format follows destFile's extension
+        // (.wav, .flac or .ogg).
+        int bitDepth = 24;
+        double sampleRate = 0.0;        // 0 = engine default
+        int quality = 0;                // OGG quality index 0-10
+
+        juce::String batchId;           // from createBatch(); empty = none
+
+        // Run the finished file through a LoudnessMeter on the render thread
+        // and report it as "loudness" in getStatus().
+        bool measureLoudness = false;
+    };
+
+    explicit RenderScheduler (te::Engine& engine,
+                              int numThreads = juce::SystemStats::getNumCpus());
+    ~RenderScheduler() override;
+
+    /** Receives a callback on the message thread each time a render finishes,
+        whether it succeeded, failed or was cancelled. */
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        virtual void renderFinished (const juce::String& renderId, const juce::String& batchId) = 0;
+    };
+
+    void addListener (Listener* l)       { listeners.add (l); }
+    void removeListener (Listener* l)    { listeners.remove (l); }
+
+    /** Queues a render and returns its id. */
+    juce::String enqueue (Request request);
+
+    /** Returns { render_id, edit_id, status, file_path, message, loudness } for
+        a render, or a void var if the id is unknown. status is one of "queued",
+        "rendering", "done" or "failed"; loudness is only present for finished
+        renders that asked for it.
+
+        A finished render is reported once and then forgotten, unless it
+        belongs to a batch, which is forgotten as a whole once
+        getBatchStatus() reports it finished. */
+    juce::var getStatus (const juce::String& renderId);
+
+    /** Returns a fresh batch id to put in Request::batchId. */
+    juce::String createBatch();
+
+    /** Returns { batch_id, status, total, completed, failed, renders } where
+        renders holds getStatus() for each job in enqueue order, or a void var
+        if the id is unknown. status is "done" once every job succeeded and
+        "failed" once all finished with at least one failure. */
+    juce::var getBatchStatus (const juce::String& batchId);
+
+    /** Drops the batch's queued renders. Renders already running can't be
+        interrupted; they finish in the background and delete their output.
+        Every cancelled render reports "failed" with the message "Cancelled",
+        and the batch is forgotten once its last render has finished. */
+    void cancelBatch (const juce::String& batchId);
+
+    /** Blocks until no render is queued or running, or timeoutMs elapses. */
+    bool waitUntilIdle (int timeoutMs);
+
+    /** Blocks until every job in the batch has finished, or timeoutMs elapses. */
+    bool waitForBatch (const juce::String& batchId, int timeoutMs);
+
+    /** Returns the file extension's matching writer format (WAV by default). */
+    static std::unique_ptr<juce::AudioFormat> createFormatForFile (const juce::File& file);
+
+    int getNumThreads() const { return pool.getNumThreads(); }
+
+    /** Builds a standalone edit from a state snapshot for offline rendering. */
+    static std::unique_ptr<te::Edit> createSnapshotEdit (te::Engine& engine,
+                                                         const juce::ValueTree& state,
+                                                         const juce::File& editFile);
+
+private:
+    class RenderJob;
+
+    enum class Status
+    {
+        queued,
+        rendering,
+        done,
+        failed
+    };
+
+    struct Record
+    {
+        juce::String editId;
+        juce::String batchId;
+        Status status = Status::queued;
+        juce::File file;
+        juce::String message;
+        juce::var loudness;
+        bool cancelled = false;
+    };
+
+    static bool isFinished (const Record& record);
+    bool isCancelled (const juce::String& renderId) const;
+    void handleAsyncUpdate() override;
+    void setStatus (const juce::String& renderId, Status status, const juce::String& message = {},
+                    std::optional<Status> onlyIf = std::nullopt);
+    void setLoudness (const juce::String& renderId, const juce::var& loudness);
+    juce::var createStatusVar (const juce::String& renderId) const;
+
+    te::Engine& engine;
+    juce::ThreadPool pool;
+    mutable juce::CriticalSection recordLock;
+    std::map<juce::String, Record> records;
+    std::map<juce::String, juce::StringArray> batches;
+    std::vector<std::pair<juce::String, juce::String>> finishedRenders;    // render id, batch id
+    juce::ListenerList<Listener> listeners;
+    int nextRenderNumber = 1;
+    int nextBatchNumber = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderScheduler)
+};
+
+} // namespace waive
@@ -2,16 +2,26 @@
 #include <tracktion_engine/tracktion_engine.h>
 
 #include "EditSession.h"
+#include "ParameterStream.h"
 #include "UndoableCommandHandler.h"
 #include "ClipEditActions.h"
 #include "ModelManager.h"
 #include "PathSanitizer.h"
 #include "AudioAnalysisCache.h"
 #include "AudioAnalysis.h"
+#include "ProjectFileFormat.h"
 #include "ProjectPackager.h"
 #include "PluginPresetManager.h"
 #include "CommandHandler.h"
+#include "TrackFreezeManager.h"
 #include "CommandServer.h"
+#include "EditHost.h"
+#include "StartupProfile.h"
+#include "LocalCommandServer.h"
+#include "SharedMemoryRing.h"
+#include "RenderScheduler.h"
+#include "RenderEncoder.h"
+#include "LoudnessMeter.h"
 #include "AiToolSchema.h"
 
 #include <cmath>
@@ -20,6 +30,8 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #if ! JUCE_WINDOWS
@@ -450,6 +462,78 @@ void testDirtyStateSavepointAcrossCoalescedUndoRedo (te::Engine& engine)
     expect (session.hasChangedSinceSaved(), "Expected redo to restore the dirty state after the savepoint");
 }
 
+void testSavePointKeepsLaterEditsDirty (te::Engine& engine)
+{
+    EditSession session (engine);
+    auto& edit = session.getEdit();
+
+    auto addTrack = [&] (const juce::String& actionName, bool coalesce = false)
+    {
+        return session.performEdit (actionName, coalesce, [&] (te::Edit& e)
+        {
+            e.ensureNumberOfAudioTracks (getAudioTrackCount (e) + 1);
+        });
+    };
+
+    expect (addTrack ("Before Save"), "Expected pre-save mutation to succeed");
+
+    // Nothing changes while the save runs: the edit ends up clean.
+    auto savePoint = session.createSavePoint();
+    session.markSavedAt (savePoint);
+    expect (! session.hasChangedSinceSaved(), "Expected an unchanged save point to leave the session clean");
+
+    // A coalesced edit straddling the save keeps growing its group after the snapshot.
+    expect (addTrack ("Drag", true), "Expected first coalesced mutation to succeed");
+    savePoint = session.createSavePoint();
+    expect (addTrack ("Drag", true), "Expected coalesced mutation during save to succeed");
+    session.markSavedAt (savePoint);
+    expect (session.hasChangedSinceSaved(), "Expected an edit made during the save to keep the session dirty");
+    expect (getAudioTrackCount (edit) == 4, "Expected every mutation to apply");
+
+    session.undo();
+    expect (session.hasChangedSinceSaved(),
+            "Expected undoing past the saved state to stay dirty");
+    session.redo();
+    expect (session.hasChangedSinceSaved(), "Expected redo past the saved state to stay dirty");
+
+    expect (addTrack ("Saved Edit"), "Expected mutation before second save to succeed");
+    savePoint = session.createSavePoint();
+    expect (addTrack ("Edit During Save"), "Expected mutation during second save to succeed");
+    session.markSavedAt (savePoint);
+    expect (session.hasChangedSinceSaved(), "Expected the later edit to keep the session dirty");
+    session.undo();
+    expect (! session.hasChangedSinceSaved(), "Expected undoing back to the save point to restore the clean state");
+
+    // Undoing below the save point and editing again puts a different
+    // transaction at the saved depth, so reaching that depth isn't clean.
+    expect (addTrack ("Branch Base"), "Expected mutation before branching save to succeed");
+    savePoint = session.createSavePoint();
+    session.undo();
+    expect (addTrack ("Other Branch"), "Expected mutation on the new branch to succeed");
+    session.markSavedAt (savePoint);
+    expect (session.hasChangedSinceSaved(), "Expected an edit on another branch at the saved depth to stay dirty");
+
+    session.resetChangedStatus();
+    session.undo();
+    expect (addTrack ("Replaces Saved Redo"), "Expected mutation replacing the saved redo step to succeed");
+    expect (session.hasChangedSinceSaved(), "Expected replacing the saved state's redo step to stay dirty");
+
+    // Changes the undo history cannot see keep the session dirty, even after undoing back.
+    savePoint = session.createSavePoint();
+    session.markAsChanged();
+    expect (addTrack ("Undoable After Mark"), "Expected mutation after markAsChanged to succeed");
+    session.undo();
+    session.markSavedAt (savePoint);
+    expect (session.hasChangedSinceSaved(), "Expected a non-undoable change during save to keep the session dirty");
+
+    // A save point from a replaced edit is ignored.
+    savePoint = session.createSavePoint();
+    session.createNew();
+    expect (addTrack ("New Edit"), "Expected mutation on new edit to succeed");
+    session.markSavedAt (savePoint);
+    expect (session.hasChangedSinceSaved(), "Expected a stale save point not to clean a replaced edit");
+}
+
 void testNoOpPerformEditDoesNotDirtyCleanSession (te::Engine& engine)
 {
     EditSession session (engine);
@@ -478,6 +562,96 @@ void testNoOpPerformEditDoesNotDirtyCleanSession (te::Engine& engine)
     session.removeListener (&listener);
 }
 
+void testBulkEditNotifiesOnceAndUndoesInOneStep (te::Engine& engine)
+{
+    EditSession session (engine);
+    auto& edit = session.getEdit();
+    const auto initialTrackCount = getAudioTrackCount (edit);
+
+    struct Listener final : EditSession::Listener
+    {
+        explicit Listener (EditSession& s) : session (s) {}
+
+        void bulkEditStarted() override
+        {
+            ++startedCount;
+            inProgressAtStart = session.isBulkEditInProgress();
+        }
+
+        void bulkEditFinished() override
+        {
+            ++finishedCount;
+            inProgressAtFinish = session.isBulkEditInProgress();
+        }
+
+        void editStateChanged() override    { ++editStateChangedCount; }
+
+        EditSession& session;
+        int startedCount = 0;
+        int finishedCount = 0;
+        int editStateChangedCount = 0;
+        bool inProgressAtStart = false;
+        bool inProgressAtFinish = true;
+    } listener (session);
+
+    session.addListener (&listener);
+
+    // Nested bulk edits join the outer one rather than notifying again.
+    expect (session.performBulkEdit ("Bulk Add Tracks", [&] (te::Edit& e)
+    {
+        for (int i = 0; i < 8; ++i)
+            e.ensureNumberOfAudioTracks (getAudioTrackCount (e) + 1);
+
+        expect (session.performBulkEdit ("Nested Bulk Add", [] (te::Edit& inner)
+        {
+            inner.ensureNumberOfAudioTracks (getAudioTrackCount (inner) + 1);
+        }), "Expected nested bulk edit to succeed");
+    }), "Expected bulk edit to succeed");
+
+    expect (getAudioTrackCount (edit) == initialTrackCount + 9, "Expected bulk edit to add nine tracks");
+    expect (listener.startedCount == 1 && listener.finishedCount == 1,
+            "Expected one started/finished pair for a nested bulk edit");
+    expect (listener.inProgressAtStart && ! listener.inProgressAtFinish,
+            "Expected isBulkEditInProgress to cover the mutation but not the finish notification");
+    expect (listener.editStateChangedCount == 1, "Expected one edit-state notification for the whole bulk edit");
+
+    session.undo();
+    expect (getAudioTrackCount (edit) == initialTrackCount, "Expected one undo to revert the whole bulk edit");
+
+    // A throwing mutation still tells listeners to catch up.
+    expect (! session.performBulkEdit ("Throwing Bulk Edit", [] (te::Edit& e)
+    {
+        e.ensureNumberOfAudioTracks (getAudioTrackCount (e) + 1);
+        throw std::runtime_error ("bulk failure");
+    }), "Expected throwing bulk edit to fail");
+
+    expect (listener.finishedCount == 2, "Expected a failed bulk edit to send bulkEditFinished");
+    expect (getAudioTrackCount (edit) == initialTrackCount, "Expected the failed bulk edit to roll back");
+    expect (! session.isBulkEditInProgress(), "Expected no bulk edit in progress after failure");
+
+    // Coalesced bulk edits of the same name undo together, until the group is ended.
+    for (int batch = 0; batch < 3; ++batch)
+        expect (session.performBulkEdit ("Import Batches", true, [] (te::Edit& e)
+        {
+            e.ensureNumberOfAudioTracks (getAudioTrackCount (e) + 1);
+        }), "Expected coalesced bulk edit to succeed");
+
+    session.endCoalescedTransaction();
+    expect (session.performBulkEdit ("Import Batches", true, [] (te::Edit& e)
+    {
+        e.ensureNumberOfAudioTracks (getAudioTrackCount (e) + 1);
+    }), "Expected bulk edit after the group ended to succeed");
+
+    expect (listener.startedCount == 6 && listener.finishedCount == 6,
+            "Expected each coalesced bulk edit to notify listeners");
+    session.undo();
+    expect (getAudioTrackCount (edit) == initialTrackCount + 3, "Expected undo to stop at the ended group");
+    session.undo();
+    expect (getAudioTrackCount (edit) == initialTrackCount, "Expected one undo to revert all coalesced batches");
+
+    session.removeListener (&listener);
+}
+
 void testUndoableCommandHandlerWrapsMutatingCommands (te::Engine& engine)
 {
     EditSession session (engine);
@@ -513,6 +687,587 @@ void testUndoableCommandHandlerWrapsMutatingCommands (te::Engine& engine)
             "Expected failing command to avoid creating a new undo transaction");
 }
 
+void testTypedCommandEntryPointMatchesJsonPath (te::Engine& engine)
+{
+    EditSession session (engine);
+    CommandHandler handler (session.getEdit());
+    UndoableCommandHandler undoableHandler (handler, session);
+
+    auto* command = new juce::DynamicObject();
+    command->setProperty ("action", "set_track_volume");
+    command->setProperty ("track_id", 0);
+    command->setProperty ("value_db", -6.0);
+
+    auto typedResponse = handler.executeCommand (juce::var (command));
+    expect (typedResponse.isObject(), "Expected typed executeCommand to return a response object");
+    expect (typedResponse["status"].toString() == "ok", "Expected typed set_track_volume to succeed");
+    expect (std::abs ((double) typedResponse["volume_db"] + 6.0) < 0.0001,
+            "Expected typed response to carry the structured volume result");
+
+    auto jsonResponse = juce::JSON::parse (handler.handleCommand (juce::JSON::toString (juce::var (command))));
+    expect (juce::JSON::toString (jsonResponse) == juce::JSON::toString (typedResponse),
+            "Expected JSON and typed entry points to produce identical responses");
+
+    auto invalidResponse = handler.executeCommand (juce::var ("set_track_volume"));
+    expect (invalidResponse["status"].toString() == "error",
+            "Expected typed executeCommand to reject non-object commands");
+
+    session.resetChangedStatus();
+    for (auto db : { -3.0, -2.0, -1.0 })
+    {
+        auto* dragStep = new juce::DynamicObject();
+        dragStep->setProperty ("action", "set_track_volume");
+        dragStep->setProperty ("track_id", 0);
+        dragStep->setProperty ("value_db", db);
+
+        auto response = undoableHandler.executeCommandCoalesced (juce::var (dragStep));
+        expect (response["status"].toString() == "ok", "Expected coalesced typed command to succeed");
+    }
+    session.endCoalescedTransaction();
+    expect (session.hasChangedSinceSaved(), "Expected typed mutation to dirty the edit");
+
+    session.undo();
+    auto* track = te::getAudioTracks (session.getEdit()).getFirst();
+    expect (track != nullptr, "Expected track for typed command undo check");
+    auto* volPlugin = track->pluginList.getPluginsOfType<te::VolumeAndPanPlugin>().getFirst();
+    expect (volPlugin != nullptr, "Expected volume plugin for typed command undo check");
+    expect (std::abs (volPlugin->getVolumeDb() + 6.0f) < 0.01f,
+            "Expected one undo to revert the whole coalesced typed drag");
+
+    auto* failing = new juce::DynamicObject();
+    failing->setProperty ("action", "remove_track");
+    failing->setProperty ("track_id", 999);
+    auto failureResponse = undoableHandler.executeCommand (juce::var (failing));
+    expect (failureResponse["status"].toString() == "error", "Expected typed failing command to report error");
+    expect (failureResponse["message"].toString().contains ("Track not found"),
+            "Expected typed failing command to preserve the underlying error message");
+}
+
+void testParameterStreamCoalescesUpdatesIntoGestures (te::Engine& engine)
+{
+    EditSession session (engine);
+    CommandHandler handler (session.getEdit());
+    UndoableCommandHandler undoableHandler (handler, session);
+    ParameterStream stream (session);
+    undoableHandler.setParameterStream (&stream);
+
+    auto* open = new juce::DynamicObject();
+    open->setProperty ("action", "open_parameter_stream");
+    open->setProperty ("track_id", 0);
+    open->setProperty ("param_id", "volume");
+    auto openResponse = undoableHandler.executeCommand (juce::var (open));
+    expect (openResponse["status"].toString() == "ok", "Expected open_parameter_stream on track volume to succeed");
+
+    const auto handle = (int) openResponse["handle"];
+    expect (handle > 0, "Expected open_parameter_stream to return a positive handle");
+    expect (stream.getNumRegisteredParameters() == 1, "Expected one registered stream handle");
+
+    auto* track = te::getAudioTracks (session.getEdit()).getFirst();
+    expect (track != nullptr, "Expected track for parameter stream test");
+    auto* volPlugin = track->getVolumePlugin();
+    expect (volPlugin != nullptr, "Expected volume plugin for parameter stream test");
+    const auto initialValue = volPlugin->volParam->getCurrentValue();
+
+    // A gesture spanning several drains collapses to one write per drain and one undo step.
+    session.resetChangedStatus();
+    expect (stream.beginGesture (handle), "Expected gesture begin to be queued");
+    for (int i = 0; i < 500; ++i)
+        expect (stream.pushValue (handle, 0.2f + (float) i * 0.0001f), "Expected stream value to be queued");
+    expect (stream.applyPendingUpdates() == 1, "Expected queued values to coalesce into a single write");
+
+    for (int i = 0; i < 500; ++i)
+        expect (stream.pushValue (handle, 0.4f), "Expected stream value to be queued");
+    expect (stream.endGesture (handle), "Expected gesture end to be queued");
+    expect (stream.applyPendingUpdates() == 1, "Expected second drain to coalesce into a single write");
+
+    expect (std::abs (volPlugin->volParam->getCurrentValue() - 0.4f) < 0.0001f,
+            "Expected stream to apply the latest value");
+    expect (session.hasChangedSinceSaved(), "Expected streamed values to dirty the edit");
+
+    session.undo();
+    expect (std::abs (volPlugin->volParam->getCurrentValue() - initialValue) < 0.0001f,
+            "Expected one undo to revert the whole streamed gesture");
+
+    // Binary frames decode to the same records.
+    auto frame = ParameterStream::encodeFrame ({ { handle, ParameterStream::UpdateKind::value, 0.25f },
+                                                 { handle, ParameterStream::UpdateKind::value, 0.3f } });
+    expect (ParameterStream::isFrame (frame.getData(), frame.getSize()), "Expected encoded frame to be recognised");
+    expect (stream.pushFrame (frame.getData(), frame.getSize()), "Expected encoded frame to be accepted");
+    expect (stream.applyPendingUpdates() == 1, "Expected frame records to coalesce into a single write");
+    expect (std::abs (volPlugin->volParam->getCurrentValue() - 0.3f) < 0.0001f,
+            "Expected frame to apply its latest value");
+
+    const juce::String json ("{\"action\":\"ping\"}");
+    expect (! ParameterStream::isFrame (json.toRawUTF8(), json.getNumBytesAsUTF8()),
+            "Expected JSON commands not to be mistaken for stream frames");
+
+    auto* close = new juce::DynamicObject();
+    close->setProperty ("action", "close_parameter_stream");
+    close->setProperty ("handle", handle);
+    expect (undoableHandler.executeCommand (juce::var (close))["status"].toString() == "ok",
+            "Expected close_parameter_stream to succeed");
+    expect (stream.getNumRegisteredParameters() == 0, "Expected closed handle to be released");
+    expect (undoableHandler.executeCommand (juce::var (close))["status"].toString() == "error",
+            "Expected closing an unknown handle to fail");
+
+    stream.pushValue (handle, 0.9f);
+    expect (stream.applyPendingUpdates() == 0, "Expected values for a closed handle to be ignored");
+
+    auto* badOpen = new juce::DynamicObject();
+    badOpen->setProperty ("action", "open_parameter_stream");
+    badOpen->setProperty ("track_id", 0);
+    badOpen->setProperty ("plugin_id", "missing");
+    badOpen->setProperty ("param_id", "volume");
+    auto badResponse = undoableHandler.executeCommand (juce::var (badOpen));
+    expect (badResponse["message"].toString().contains ("Plugin not found"),
+            "Expected open_parameter_stream to report unresolved targets");
+
+    ParameterStream smallStream (session, 16);
+    int accepted = 0;
+    for (int i = 0; i < 32; ++i)
+        accepted += smallStream.pushValue (1, 0.5f) ? 1 : 0;
+    expect (accepted < 32 && smallStream.getNumDroppedUpdates() == 32 - accepted,
+            "Expected a full ring to drop and count excess updates");
+
+    // Removing the track behind a handle releases it on the next drain, even mid-gesture.
+    session.getEdit().ensureNumberOfAudioTracks (2);
+    auto* removedTrack = te::getAudioTracks (session.getEdit())[1];
+    const auto removedHandle = stream.registerParameter (removedTrack->getVolumePlugin()->volParam, false);
+    expect (stream.beginGesture (removedHandle) && stream.pushValue (removedHandle, 0.5f),
+            "Expected values for the soon-removed track to be queued");
+    expect (stream.applyPendingUpdates() == 1, "Expected the soon-removed track's value to apply");
+
+    session.getEdit().deleteTrack (removedTrack);
+    stream.pushValue (removedHandle, 0.6f);
+    expect (stream.applyPendingUpdates() == 0, "Expected values for a removed track to be dropped");
+    expect (stream.getNumRegisteredParameters() == 0, "Expected a removed track's handle to be released");
+}
+
+void testParameterStreamGivesEachProducerItsOwnLane (te::Engine& engine)
+{
+    constexpr int numProducers = 4;
+    constexpr int valuesPerProducer = 1000;
+
+    EditSession session (engine);
+    session.getEdit().ensureNumberOfAudioTracks (numProducers);
+    ParameterStream stream (session);
+
+    std::vector<int> handles;
+    for (auto* track : te::getAudioTracks (session.getEdit()))
+        if (handles.size() < (size_t) numProducers)
+            handles.push_back (stream.registerParameter (track->getVolumePlugin()->volParam, false));
+
+    expect (handles.size() == (size_t) numProducers, "Expected one stream handle per producer track");
+
+    const auto finalValue = [] (int producer) { return 0.1f + 0.2f * (float) producer; };
+
+    const auto runProducers = [&]
+    {
+        std::vector<std::thread> producers;
+        for (int p = 0; p < numProducers; ++p)
+            producers.emplace_back ([&, p]
+            {
+                for (int i = 0; i < valuesPerProducer; ++i)
+                    stream.pushValue (handles[(size_t) p], i + 1 == valuesPerProducer ? finalValue (p) : 0.5f);
+            });
+
+        for (auto& producer : producers)
+            producer.join();
+    };
+
+    // Concurrent producers each write their own ring, so none contend or drop.
+    runProducers();
+    expect (stream.getNumProducerLanes() == numProducers, "Expected one lane per producing thread");
+    expect (stream.getNumDroppedUpdates() == 0, "Expected no updates dropped across producer lanes");
+    expect (stream.applyPendingUpdates() == numProducers, "Expected one write per handle after draining every lane");
+
+    auto tracks = te::getAudioTracks (session.getEdit());
+    for (int p = 0; p < numProducers; ++p)
+        expect (std::abs (tracks[p]->getVolumePlugin()->volParam->getCurrentValue() - finalValue (p)) < 0.0001f,
+                "Expected each producer's last value to be applied");
+
+    // Lanes of exited threads are handed to new ones.
+    runProducers();
+    expect (stream.getNumProducerLanes() == numProducers, "Expected exited threads' lanes to be reused");
+    expect (stream.applyPendingUpdates() == numProducers, "Expected reused lanes to be drained");
+}
+
+void testEditHostIsolatesEditsAndUndoHistories (te::Engine& engine)
+{
+    EditHost host (engine);
+
+    auto run = [&host] (const juce::String& json) { return host.executeCommand (juce::JSON::parse (json)); };
+
+    auto opened = run (R"({"action":"open_edit"})");
+    expect (opened["status"].toString() == "ok", "Expected open_edit to create a new edit");
+    const auto editId = opened["edit_id"].toString();
+    expect (editId.isNotEmpty() && editId != EditHost::defaultEditId, "Expected open_edit to return a fresh edit id");
+    expect (host.getNumEdits() == 2, "Expected the default edit plus the opened edit");
+
+    auto added = run (R"({"action":"add_track","edit_id":")" + editId + R"("})");
+    expect (added["status"].toString() == "ok", "Expected add_track to succeed on the opened edit");
+
+    auto* openedSession = host.getEditSession (editId);
+    auto* defaultSession = host.getEditSession (EditHost::defaultEditId);
+    expect (openedSession != nullptr && defaultSession != nullptr, "Expected both edit sessions to be reachable");
+    expect (getAudioTrackCount (openedSession->getEdit()) == 2, "Expected add_track to land on the addressed edit");
+    expect (getAudioTrackCount (defaultSession->getEdit()) == 1, "Expected the default edit to be untouched");
+    expect (openedSession->canUndo() && ! defaultSession->canUndo(), "Expected undo history to be per edit");
+
+    auto unknown = run (R"({"action":"get_tracks","edit_id":"missing"})");
+    expect (unknown["status"].toString() == "error", "Expected commands for an unknown edit_id to fail");
+
+    auto stream = run (R"({"action":"open_parameter_stream","edit_id":")" + editId + R"(","track_id":0,"param_id":"volume"})");
+    expect (stream["status"].toString() == "error", "Expected parameter streams to be limited to the default edit");
+
+    auto listed = run (R"({"action":"list_edits"})");
+    expect ((int) listed["count"] == 2, "Expected list_edits to report both edits");
+
+    expect (run (R"({"action":"close_edit","edit_id":"default"})")["status"].toString() == "error",
+            "Expected the default edit to refuse close_edit");
+    expect (run (R"({"action":"close_edit","edit_id":")" + editId + R"("})")["status"].toString() == "ok",
+            "Expected close_edit to close the opened edit");
+    expect (host.getNumEdits() == 1 && host.getEditSession (editId) == nullptr,
+            "Expected the closed edit to be released");
+}
+
+void testEditHostReportsStartupTimings (te::Engine& engine)
+{
+    EditHost host (engine);
+
+    auto unavailable = host.executeCommand (juce::JSON::parse (R"({"action":"get_startup_timings"})"));
+    expect (unavailable["status"].toString() == "error", "Expected get_startup_timings to fail without a profile");
+
+    StartupProfile profile;
+    profile.measure ("engine", [] { juce::Thread::sleep (2); });
+    profile.markReady();
+    profile.addPhase ("plugin_manager", 5.0, true);
+    host.setStartupProfile (&profile);
+
+    juce::StringArray seenActions;
+    host.onBeforeCommand = [&seenActions] (const juce::String& action) { seenActions.add (action); };
+
+    auto response = host.executeCommand (juce::JSON::parse (R"({"action":"get_startup_timings"})"));
+    expect (response["status"].toString() == "ok", "Expected get_startup_timings to succeed");
+    expect (seenActions.contains ("get_startup_timings"), "Expected onBeforeCommand to see every action");
+
+    auto startup = response["startup"];
+    auto* phases = startup["phases"].getArray();
+    expect (phases != nullptr && phases->size() == 2, "Expected both recorded phases");
+    expect ((*phases)[0]["name"].toString() == "engine" && (double) (*phases)[0]["ms"] >= 1.0,
+            "Expected measure() to record the phase duration");
+    expect ((bool) (*phases)[1]["deferred"], "Expected lazily run phases to be marked deferred");
+    expect ((double) startup["ready_ms"] >= 0.0, "Expected ready time to be set by markReady");
+    expect ((double) startup["total_ms"] >= 5.0, "Expected total time to include deferred phases");
+    expect (profile.toString().contains ("(deferred)"), "Expected the log summary to flag deferred phases");
+}
+
+void testAsyncExportMixdownRendersOnScheduler (te::Engine& engine)
+{
+    auto fixtureDir = getFixtureDir ("async_export_mixdown");
+    auto backingFile = fixtureDir.getChildFile ("async_export_mixdown.tracktionedit");
+    auto edit = te::createEmptyEdit (engine, backingFile);
+    edit->ensureNumberOfAudioTracks (1);
+
+    auto* track = te::getAudioTracks (*edit).getFirst();
+    expect (track != nullptr, "Expected audio track for async export test");
+
+    auto audioFile = writeTestWav (fixtureDir.getChildFile ("source.wav"));
+    auto clip = track->insertWaveClip (
+        "source",
+        audioFile,
+        { { te::TimePosition::fromSeconds (0.0),
+            te::TimePosition::fromSeconds (0.1) },
+          te::TimeDuration() },
+        false);
+    expect (clip != nullptr, "Expected clip insertion for async export test");
+
+    auto outputFile = fixtureDir.getChildFile ("mixdown.wav");
+    const auto payload = juce::String::formatted (R"({
+        "action":"export_mixdown",
+        "file_path":"%s",
+        "start":0.0,
+        "end":0.1,
+        "async":true
+    })", outputFile.getFullPathName().replace ("\\", "\\\\").replace ("\"", "\\\"").toRawUTF8());
+
+    CommandHandler handler (*edit);
+    handler.setAllowedMediaDirectories ({ fixtureDir });
+
+    auto unavailable = runJsonCommand (handler, payload);
+    expect (unavailable["status"].toString() == "error",
+            "Expected async export to fail without a render scheduler");
+
+    waive::RenderScheduler scheduler (engine, 2);
+    handler.setRenderScheduler (&scheduler, "test_edit");
+
+    auto queued = runJsonCommand (handler, payload);
+    expect (queued["status"].toString() == "ok", "Expected async export_mixdown to queue a render");
+    const auto renderId = queued["render_id"].toString();
+    expect (renderId.isNotEmpty(), "Expected async export_mixdown to return a render id");
+
+    // The live edit may change while the snapshot renders.
+    edit->ensureNumberOfAudioTracks (3);
+
+    expect (scheduler.waitUntilIdle (30000), "Expected the queued render to finish");
+
+    auto status = runJsonCommand (handler, R"({"action":"get_render_status","render_id":")" + renderId + R"("})");
+    expect (status["render_status"].toString() == "done", "Expected get_render_status to report a finished render");
+    expect (status["edit_id"].toString() == "test_edit", "Expected the render to be tagged with its edit id");
+    expect (outputFile.existsAsFile() && outputFile.getSize() > 0, "Expected the async render to write its file");
+    expect (status["loudness"].isObject() && (double) status["loudness"]["integrated_lufs"] < 0.0,
+            "Expected a finished export_mixdown render to report its loudness");
+
+    auto reported = runJsonCommand (handler, R"({"action":"get_render_status","render_id":")" + renderId + R"("})");
+    expect (reported["status"].toString() == "error", "Expected a finished render to be forgotten once reported");
+
+    auto missing = runJsonCommand (handler, R"({"action":"get_render_status","render_id":"render_999"})");
+    expect (missing["status"].toString() == "error", "Expected unknown render ids to be rejected");
+
+    edit.reset();
+    (void) fixtureDir.deleteRecursively();
+}
+
+void testRenderBatchExpandsJobsIntoParallelRenders (te::Engine& engine)
+{
+    auto fixtureDir = getFixtureDir ("render_batch");
+    auto backingFile = fixtureDir.getChildFile ("render_batch.tracktionedit");
+    auto edit = te::createEmptyEdit (engine, backingFile);
+    edit->ensureNumberOfAudioTracks (2);
+
+    auto audioFile = writeTestWav (fixtureDir.getChildFile ("source.wav"));
+    for (auto* track : te::getAudioTracks (*edit))
+    {
+        auto clip = track->insertWaveClip (
+            "source",
+            audioFile,
+            { { te::TimePosition::fromSeconds (0.0),
+                te::TimePosition::fromSeconds (0.1) },
+              te::TimeDuration() },
+            false);
+        expect (clip != nullptr, "Expected clip insertion for render_batch test");
+    }
+
+    waive::RenderScheduler scheduler (engine, 4);
+    CommandHandler handler (*edit);
+    handler.setAllowedMediaDirectories ({ fixtureDir });
+    handler.setRenderScheduler (&scheduler);
+
+    auto outputDir = fixtureDir.getChildFile ("batch");
+    const auto escapedDir = outputDir.getFullPathName().replace ("\\", "\\\\").replace ("\"", "\\\"");
+
+    auto rejected = runJsonCommand (handler, R"({"action":"render_batch","output_dir":")" + escapedDir + R"(",
+        "jobs":[{"name":"mix"},{"name":"bad","formats":["mp3"]}]})");
+    expect (rejected["status"].toString() == "error", "Expected an unsupported format to reject the batch");
+    expect (! outputDir.exists(), "Expected a rejected batch to queue nothing");
+
+    auto floatFlac = runJsonCommand (handler, R"({"action":"render_batch","output_dir":")" + escapedDir + R"(",
+        "jobs":[{"name":"mix","formats":["wav","flac"],"bit_depth":32}]})");
+    expect (floatFlac["status"].toString() == "error", "Expected 32-bit flac to reject the batch");
+    expect (! outputDir.exists(), "Expected a rejected 32-bit flac batch to queue nothing");
+
+    auto response = runJsonCommand (handler, R"({"action":"render_batch","output_dir":")" + escapedDir + R"(",
+        "jobs":[
+            {"name":"mix","formats":["wav","flac"]},
+            {"name":"no_track_2","mute_track_ids":[1],"start":0.0,"end":0.05},
+            {"name":"stems","stems":true,"bit_depth":16}
+        ]})");
+    expect (response["status"].toString() == "ok", "Expected render_batch to queue the batch");
+    expect ((int) response["count"] == 5, "Expected two formats, one alternate mix and two stems");
+
+    const auto batchId = response["batch_id"].toString();
+    expect (scheduler.waitForBatch (batchId, 60000), "Expected the batch to finish");
+
+    auto status = runJsonCommand (handler, R"({"action":"get_render_status","batch_id":")" + batchId + R"("})");
+    expect (status["render_status"].toString() == "done", "Expected every render in the batch to succeed");
+    expect ((int) status["completed"] == 5, "Expected the batch status to count completed renders");
+    expect (runJsonCommand (handler, R"({"action":"get_render_status","batch_id":")" + batchId + R"("})")["status"].toString() == "error",
+            "Expected a finished batch to be forgotten once reported");
+
+    for (const auto& render : *response["renders"].getArray())
+        expect (juce::File (render["file_path"].toString()).getSize() > 0,
+                "Expected each batch render to write its file: " + render["file_path"].toString().toStdString());
+
+    expect (outputDir.getChildFile ("mix.flac").existsAsFile(), "Expected the FLAC variant of the mix");
+
+    auto ambiguous = runJsonCommand (handler, R"({"action":"get_render_status","batch_id":")" + batchId
+                                                  + R"(","render_id":"render_1"})");
+    expect (ambiguous["status"].toString() == "error", "Expected render_id and batch_id together to be rejected");
+
+    struct FinishedCounter : public waive::RenderScheduler::Listener
+    {
+        void renderFinished (const juce::String&, const juce::String& id) override
+        {
+            if (id == batchId)
+                ++count;
+        }
+
+        juce::String batchId;
+        int count = 0;
+    } counter;
+
+    scheduler.addListener (&counter);
+    counter.batchId = scheduler.createBatch();
+    juce::Array<juce::File> cancelledFiles;
+    for (int i = 0; i < 8; ++i)
+    {
+        waive::RenderScheduler::Request request;
+        request.editState = edit->state.createCopy();
+        request.destFile = outputDir.getChildFile ("cancelled_" + juce::String (i) + ".wav");
+        request.range = { te::TimePosition(), te::TimePosition::fromSeconds (0.1) };
+        request.batchId = counter.batchId;
+        cancelledFiles.add (request.destFile);
+        scheduler.enqueue (std::move (request));
+    }
+
+    scheduler.cancelBatch (counter.batchId);
+    expect (scheduler.waitUntilIdle (60000), "Expected cancelled renders to settle");
+    juce::MessageManager::getInstance()->runDispatchLoopUntil (50);
+    scheduler.removeListener (&counter);
+
+    expect (scheduler.getBatchStatus (counter.batchId).isVoid(), "Expected a cancelled batch to be forgotten once settled");
+    expect (counter.count == 8, "Expected the listener to hear about every cancelled render");
+    for (const auto& file : cancelledFiles)
+        expect (! file.existsAsFile(), "Expected a cancelled render to leave no file");
+
+    edit.reset();
+    (void) fixtureDir.deleteRecursively();
+}
+
+void testRenderEncoderFansOutWithSingleGain()
+{
+    auto fixtureDir = getFixtureDir ("render_encoder");
+    auto master = fixtureDir.getChildFile ("master.wav");
+
+    {
+        std::unique_ptr<juce::OutputStream> stream (new juce::FileOutputStream (master));
+        auto options = juce::AudioFormatWriterOptions()
+                           .withSampleRate (44100.0)
+                           .withNumChannels (2)
+                           .withBitsPerSample (32);
+        auto writer = juce::WavAudioFormat().createWriterFor (stream, options);
+        expect (writer != nullptr, "Expected a float WAV writer for the encoder master");
+
+        juce::AudioBuffer<float> buffer (2, 44100);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            const auto sample = 0.25f * std::sin (juce::MathConstants<float>::twoPi * 440.0f * (float) i / 44100.0f);
+            buffer.setSample (0, i, sample);
+            buffer.setSample (1, i, sample * 0.5f);
+        }
+        writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+    }
+
+    auto analysis = waive::RenderEncoder::analyse (master);
+    expect (analysis.has_value() && std::abs (analysis->samplePeakDb - juce::Decibels::gainToDecibels (0.25)) < 0.01,
+            "Expected the mapped master pass to find the master's peak");
+
+    std::vector<waive::RenderEncoder::Target> targets (4);
+    targets[0].file = fixtureDir.getChildFile ("out.wav");
+    targets[0].bitDepth = 16;
+    targets[1].file = fixtureDir.getChildFile ("out.flac");
+    targets[2].file = fixtureDir.getChildFile ("out.ogg");
+    targets[2].quality = 5;
+    targets[3].file = fixtureDir.getChildFile ("out_22k.wav");
+    targets[3].sampleRate = 22050.0;
+
+    waive::RenderEncoder::Normalisation peakNormalisation;
+    peakNormalisation.mode = waive::RenderEncoder::Normalisation::Mode::peak;
+    peakNormalisation.targetDb = -6.0;
+
+    auto result = waive::RenderEncoder::encode (master, targets, peakNormalisation, 4);
+    expect (result.ok, "Expected every target to encode: " + result.errors.joinIntoString ("; ").toStdString());
+    expect (std::abs (result.gain - juce::Decibels::decibelsToGain (-6.0f) / 0.25f) < 0.01f,
+            "Expected one gain derived from the master peak");
+
+    waive::RenderEncoder::Normalisation loudnessNormalisation;
+    loudnessNormalisation.mode = waive::RenderEncoder::Normalisation::Mode::loudness;
+    loudnessNormalisation.targetDb = -16.0;
+    const auto loudnessGain = waive::RenderEncoder::computeGain (result.master, loudnessNormalisation);
+    expect (std::abs (result.master.integratedLufs + juce::Decibels::gainToDecibels (loudnessGain) + 16.0) < 0.05,
+            "Expected loudness normalisation to land the integrated loudness on the target");
+
+    loudnessNormalisation.targetDb = -3.0;
+    bool limited = false;
+    const auto cappedGain = waive::RenderEncoder::computeGain (result.master, loudnessNormalisation, &limited);
+    expect (limited && result.master.truePeakDb + juce::Decibels::gainToDecibels (cappedGain) <= -0.99,
+            "Expected loudness normalisation to stop at the true-peak ceiling");
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    for (const auto& target : targets)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (target.file));
+        expect (reader != nullptr, "Expected a readable encode: " + target.file.getFileName().toStdString());
+
+        const auto expectedLength = target.sampleRate > 0.0 ? 22050 : 44100;
+        expect (std::abs ((int) reader->lengthInSamples - expectedLength) < 64,
+                "Expected the encoded length to follow the target rate: " + target.file.getFileName().toStdString());
+
+        if (! target.file.hasFileExtension (".ogg"))
+        {
+            juce::Range<float> levels[2];
+            reader->readMaxLevels (0, reader->lengthInSamples, levels, 2);
+            const auto peak = juce::jmax (std::abs (levels[0].getStart()), levels[0].getEnd());
+            expect (std::abs (juce::Decibels::gainToDecibels (peak) + 6.0f) < 0.2f,
+                    "Expected the target peak to land on the normalise level: " + target.file.getFileName().toStdString());
+        }
+    }
+
+    auto failed = waive::RenderEncoder::encode (fixtureDir.getChildFile ("missing.wav"), targets);
+    expect (! failed.ok, "Expected a missing master to fail the encode");
+
+    (void) fixtureDir.deleteRecursively();
+}
+
+void testLoudnessMeterMatchesReferenceLevels()
+{
+    constexpr double sampleRate = 48000.0;
+    const auto renderSine = [] (waive::LoudnessMeter& meter, double frequency, float amplitude,
+                                double phase, double seconds)
+    {
+        meter.prepare (sampleRate, 2);
+        juce::AudioBuffer<float> buffer (2, 4800);
+
+        for (int block = 0; block < (int) (seconds * 10.0); ++block)
+        {
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const auto n = (double) (block * buffer.getNumSamples() + i);
+                const auto sample = amplitude * (float) std::sin (juce::MathConstants<double>::twoPi * frequency * n / sampleRate + phase);
+                buffer.setSample (0, i, sample);
+                buffer.setSample (1, i, sample);
+            }
+
+            meter.process (buffer, 0, buffer.getNumSamples());
+        }
+
+        return meter.getResult();
+    };
+
+    // EBU Tech 3341 case 1: stereo 1 kHz sine at -23 dBFS reads -23 LUFS.
+    waive::LoudnessMeter meter;
+    auto reference = renderSine (meter, 1000.0, juce::Decibels::decibelsToGain (-23.0f), 0.0, 20.0);
+    expect (std::abs (reference.integratedLufs + 23.0) < 0.1, "Expected -23 LUFS for the EBU reference tone");
+    expect (std::abs (reference.momentaryMaxLufs + 23.0) < 0.1, "Expected momentary loudness to match a steady tone");
+    expect (std::abs (reference.shortTermMaxLufs + 23.0) < 0.1, "Expected short-term loudness to match a steady tone");
+    expect (reference.loudnessRangeLu < 0.1, "Expected no loudness range for a steady tone");
+    expect (std::abs (reference.durationSeconds - 20.0) < 0.001, "Expected the meter to count processed samples");
+
+    // A quarter-rate sine sampled 45 degrees off its peaks: samples sit 3 dB
+    // below the waveform's real peak, which only the oversampled meter sees.
+    auto interSample = renderSine (meter, sampleRate / 4.0, 0.5f, juce::MathConstants<double>::pi / 4.0, 1.0);
+    expect (std::abs (interSample.samplePeakDb - (juce::Decibels::gainToDecibels (0.5) - 3.01)) < 0.05,
+            "Expected sample peak to miss the inter-sample peak");
+    expect (std::abs (interSample.truePeakDb - juce::Decibels::gainToDecibels (0.5)) < 0.5,
+            "Expected true peak to recover the inter-sample peak");
+
+    auto silence = renderSine (meter, 1000.0, 0.0f, 0.0, 1.0);
+    expect (silence.integratedLufs == waive::LoudnessMeter::floorDb, "Expected silence to report the meter floor");
+    expect (silence.toVar()["integrated_lufs"].isDouble(), "Expected a JSON-safe result for silence");
+}
+
 void testUndoableCommandHandlerPassesThroughFileSideEffectCommands (te::Engine& engine)
 {
     auto fixtureDir = getFixtureDir ("undoable_export_passthrough");
@@ -920,6 +1675,31 @@ void testCollectAndSaveCopiesExternalMediaAndRewritesReferences (te::Engine& eng
     (void) fixtureDir.deleteRecursively();
 }
 
+void testCollectAndSaveFollowsBinaryCompressionSetting (te::Engine& engine)
+{
+    using Format = waive::ProjectFileFormat::Format;
+
+    auto fixtureDir = getFixtureDir ("collect_binary_compression");
+    auto projectDir = fixtureDir.getChildFile ("project");
+    expect (projectDir.createDirectory().wasOk(), "Expected binary collect project directory");
+
+    const auto projectFile = projectDir.getChildFile ("collect.waiveproject");
+    auto edit = te::createEmptyEdit (engine, projectFile);
+    edit->ensureNumberOfAudioTracks (1);
+
+    auto result = waive::ProjectPackager::collectAndSave (*edit, projectDir, projectFile, false);
+    expect (result.errors.isEmpty(), "Expected uncompressed binary collect/save to succeed");
+    expect (waive::ProjectFileFormat::detectFormat (projectFile) == Format::binary,
+            "Expected collect/save to honour compressBinary = false");
+
+    result = waive::ProjectPackager::collectAndSave (*edit, projectDir, projectFile, true);
+    expect (result.errors.isEmpty(), "Expected compressed binary collect/save to succeed");
+    expect (waive::ProjectFileFormat::detectFormat (projectFile) == Format::compressedBinary,
+            "Expected collect/save to compress when asked");
+
+    (void) fixtureDir.deleteRecursively();
+}
+
 void testCollectAndSaveRewritesInternalAbsoluteReferencesRelative (te::Engine& engine)
 {
     auto fixtureDir = getFixtureDir ("collect_internal_absolute_reference");
@@ -1232,6 +2012,103 @@ void testPackageAsZipOverwritesExistingArchiveAtomically (te::Engine& engine)
     (void) fixtureDir.deleteRecursively();
 }
 
+void testProjectFileFormatsRoundTripAndReplaceAtomically (te::Engine& engine)
+{
+    using Format = waive::ProjectFileFormat::Format;
+
+    auto fixtureDir = getFixtureDir ("project_file_formats");
+    fixtureDir.createDirectory();
+
+    auto edit = te::createEmptyEdit (engine, fixtureDir.getChildFile ("source.tracktionedit"));
+    edit->ensureNumberOfAudioTracks (3);
+
+    auto* track = te::getAudioTracks (*edit).getFirst();
+    expect (track != nullptr, "Expected project format fixture track");
+
+    auto clip = track->insertMIDIClip (
+        "binary_round_trip",
+        te::TimeRange (te::TimePosition::fromSeconds (0.0),
+                       te::TimePosition::fromSeconds (2.0)),
+        nullptr);
+    expect (clip != nullptr, "Expected project format fixture clip");
+    clip->getSequence().addNote (60, te::BeatPosition::fromBeats (0.0),
+                                 te::BeatDuration::fromBeats (1.0),
+                                 100, 0, &edit->getUndoManager());
+    edit->flushState();
+
+    const auto xmlFile = fixtureDir.getChildFile ("round_trip.tracktionedit");
+    const auto binaryFile = fixtureDir.getChildFile ("round_trip.waiveproject");
+    const auto compressedFile = fixtureDir.getChildFile ("round_trip_compressed.waiveproject");
+
+    expect (waive::ProjectFileFormat::getFormatForSaving (xmlFile) == Format::xml,
+            "Expected .tracktionedit to save as XML");
+    expect (waive::ProjectFileFormat::getFormatForSaving (binaryFile, false) == Format::binary,
+            "Expected .waiveproject to save as binary");
+    expect (waive::ProjectFileFormat::getFormatForSaving (binaryFile) == Format::compressedBinary,
+            "Expected .waiveproject to compress by default");
+
+    const std::pair<juce::File, Format> cases[] = {
+        { xmlFile, Format::xml },
+        { binaryFile, Format::binary },
+        { compressedFile, Format::compressedBinary },
+    };
+
+    for (const auto& [file, format] : cases)
+    {
+        const auto name = file.getFileName().toStdString();
+        auto result = waive::ProjectFileFormat::writeState (edit->state, file, format);
+        expect (result.wasOk(), "Expected project write to succeed for " + name + ": " + result.getErrorMessage().toStdString());
+        expect (waive::ProjectFileFormat::detectFormat (file) == format,
+                "Expected written format to be detected for " + name);
+
+        // XML stores every property as text, so only binary keeps the exact var types.
+        auto readBack = waive::ProjectFileFormat::readState (file);
+        expect (readBack.hasType (te::IDs::EDIT), "Expected an edit tree to be read back from " + name);
+        if (format != Format::xml)
+            expect (readBack.isEquivalentTo (edit->state),
+                    "Expected project state to round-trip unchanged for " + name);
+    }
+
+    expect (compressedFile.getSize() < binaryFile.getSize(),
+            "Expected compressed binary project to be smaller than uncompressed");
+    expect (binaryFile.getSize() < xmlFile.getSize(),
+            "Expected binary project to be smaller than XML");
+
+    // Overwrites go through a temporary sibling that is renamed into place.
+    auto overwrite = waive::ProjectFileFormat::writeState (edit->state, compressedFile, Format::compressedBinary);
+    expect (overwrite.wasOk(), "Expected binary project overwrite to succeed");
+    expect (fixtureDir.findChildFiles (juce::File::findFiles, false, "*.tmp-*").isEmpty(),
+            "Expected no temporary files left after project writes");
+
+    auto missingParent = fixtureDir.getChildFile ("missing").getChildFile ("project.waiveproject");
+    expect (waive::ProjectFileFormat::writeState (edit->state, missingParent, Format::binary).failed(),
+            "Expected project write into a missing folder to fail");
+
+    auto corruptFile = fixtureDir.getChildFile ("corrupt.waiveproject");
+    {
+        juce::FileOutputStream corrupt (corruptFile);
+        corrupt.writeInt (waive::ProjectFileFormat::binaryMagic);
+        corrupt.writeInt (waive::ProjectFileFormat::binaryVersion + 1);
+        corrupt.writeInt (0);
+    }
+    expect (! waive::ProjectFileFormat::readState (corruptFile).isValid(),
+            "Expected a newer binary version to be rejected");
+
+    auto loaded = waive::ProjectFileFormat::loadEdit (engine, compressedFile);
+    expect (loaded != nullptr, "Expected binary project to load as an edit");
+    auto* loadedTrack = te::getAudioTracks (*loaded).getFirst();
+    expect (loadedTrack != nullptr && loadedTrack->getClips().size() == 1,
+            "Expected binary project to load with its clip");
+    expect (te::getAudioTracks (*loaded).size() == 3,
+            "Expected binary project to load every track");
+    expect (te::EditFileOperations (*loaded).getEditFile() == compressedFile,
+            "Expected binary project edit to be backed by its own file");
+
+    loaded.reset();
+    edit.reset();
+    (void) fixtureDir.deleteRecursively();
+}
+
 void testPackageEditAsZipIncludesProjectRelativeMediaOutsideAudio (te::Engine& engine)
 {
     auto fixtureDir = getFixtureDir ("package_zip_project_relative_media");
@@ -1819,6 +2696,98 @@ void testCommandServerAllowsDelayedAuthenticationWhenTimeoutDisabled()
             "Expected delayed authentication to succeed when timeout is disabled");
 }
 
+void testSharedMemoryRingWrapsAndReleasesSpace()
+{
+#if ! JUCE_WINDOWS
+    auto producer = SharedMemoryRing::create (1024);
+    expect (producer != nullptr, "Expected shared-memory ring to be created");
+
+    auto consumer = SharedMemoryRing::open (producer->getName());
+    expect (consumer != nullptr, "Expected shared-memory ring to open by name");
+    expect (consumer->getCapacity() == 1024, "Expected consumer to see the producer's capacity");
+
+    juce::MemoryBlock first (600, false), second (600, false), received;
+    first.fillWith (0x11);
+    second.fillWith (0x22);
+
+    const auto firstPosition = producer->write (first.getData(), first.getSize());
+    expect (firstPosition == 0, "Expected first payload at position 0");
+    expect (producer->write (second.getData(), second.getSize()) < 0,
+            "Expected write to fail while the consumer holds the space");
+
+    expect (consumer->read (firstPosition, first.getSize(), received) && received == first,
+            "Expected consumer to read the first payload");
+    expect (! consumer->read (firstPosition, first.getSize(), received),
+            "Expected a released payload not to be readable again");
+
+    const auto secondPosition = producer->write (second.getData(), second.getSize());
+    expect (secondPosition == 1024, "Expected a payload that would straddle the end to start at the next lap");
+    expect (consumer->read (secondPosition, second.getSize(), received) && received == second,
+            "Expected consumer to read the wrapped payload intact");
+
+    expect (SharedMemoryRing::open ("/waive-missing-ring") == nullptr,
+            "Expected opening an unknown segment to fail");
+#endif
+}
+
+void testLocalCommandServerAuthenticatesAndNegotiatesSharedMemory()
+{
+#if ! JUCE_WINDOWS
+    const auto socketFile = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                .getChildFile ("waive_local_" + juce::String::toHexString (juce::Random::getSystemRandom().nextInt()) + ".sock");
+    const juce::String token ("local-test-token");
+
+    std::atomic<int> framesReceived { 0 };
+    LocalCommandServer server ([] (const juce::String&) { return "{}"; }, socketFile, token, 0);
+    server.setBinaryFrameCallback ([&] (const juce::MemoryBlock& frame)
+    {
+        if (! ParameterStream::isFrame (frame.getData(), frame.getSize()))
+            return false;
+
+        ++framesReceived;
+        return true;
+    });
+
+    const auto umaskBefore = ::umask (S_IWGRP | S_IWOTH);
+    ::umask (umaskBefore);
+    expect (server.start(), "Expected local command server to start");
+    const auto umaskAfter = ::umask (umaskBefore);
+    expect (umaskAfter == umaskBefore, "Expected starting the server to restore the process umask");
+
+    struct stat socketStat
+    {
+    };
+    expect (::stat (socketFile.getFullPathName().toRawUTF8(), &socketStat) == 0 && S_ISSOCK (socketStat.st_mode),
+            "Expected a Unix domain socket at the configured path");
+    expect ((socketStat.st_mode & 0777) == 0600, "Expected local socket mode to be 0600");
+
+    {
+        LocalCommandServer competingServer ([] (const juce::String&) { return "{}"; }, socketFile, token, 0);
+        expect (! competingServer.start(), "Expected a second server not to take over a live socket");
+    }
+
+    LocalCommandClient rejected;
+    expect (rejected.connect (socketFile), "Expected client to connect to the local socket");
+    expect (! rejected.authenticate ("wrong-token"), "Expected a wrong token to be rejected");
+
+    LocalCommandClient client;
+    expect (client.connect (socketFile), "Expected client to connect to the local socket");
+    expect (client.authenticate (token), "Expected the shared auth token to be accepted");
+    expect (client.openSharedMemoryRing (1024 * 1024), "Expected shared-memory ring negotiation to succeed");
+
+    auto frame = ParameterStream::encodeFrame ({ { 1, ParameterStream::UpdateKind::value, 0.5f } });
+    expect (client.sendMessage (frame), "Expected binary frame to send over the local socket");
+
+    const auto deadline = juce::Time::getMillisecondCounter() + 1000u;
+    while (framesReceived.load() == 0 && juce::Time::getMillisecondCounter() < deadline)
+        juce::Thread::sleep (5);
+    expect (framesReceived.load() == 1, "Expected binary frames to reach the frame callback");
+
+    server.stop();
+    expect (! socketFile.exists(), "Expected the socket file to be removed on stop");
+#endif
+}
+
 void testPluginPresetManagerUsesDocumentedWrapperAndStableIdentifier (te::Engine& engine)
 {
     auto fixtureDir = getFixtureDir ("plugin_preset_manager");
@@ -2394,6 +3363,71 @@ void testSetParameterAcceptsStablePluginIdentifier (te::Engine& engine)
     (void) fixtureDir.deleteRecursively();
 }
 
+void testCommandHandlerLookupCachesFollowEditStructureChanges (te::Engine& engine)
+{
+    auto fixtureDir = getFixtureDir ("command_lookup_cache");
+    auto edit = te::createEmptyEdit (engine, fixtureDir.getChildFile ("lookup_cache.tracktionedit"));
+    edit->ensureNumberOfAudioTracks (2);
+
+    CommandHandler handler (*edit);
+
+    auto makeSetParameter = [] (int trackId, const juce::String& pluginId, const juce::String& paramId)
+    {
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty ("action", "set_parameter");
+        obj->setProperty ("track_id", trackId);
+        obj->setProperty ("plugin_id", pluginId);
+        obj->setProperty ("param_id", paramId);
+        obj->setProperty ("value", 0.5);
+        return juce::var (obj);
+    };
+
+    // Warm both caches before mutating the edit behind the handler's back.
+    auto tracksResponse = runJsonCommand (handler, R"({ "action":"get_tracks" })");
+    expect (tracksResponse["tracks"].size() == 2, "Expected two public tracks before structure change");
+    expect (handler.executeCommand (makeSetParameter (1, "reverb", "roomSize"))["status"].toString() == "error",
+            "Expected set_parameter to fail before the plugin exists");
+
+    edit->ensureNumberOfAudioTracks (3);
+    tracksResponse = runJsonCommand (handler, R"({ "action":"get_tracks" })");
+    expect (tracksResponse["tracks"].size() == 3, "Expected cached public tracks to refresh after a track is added");
+
+    auto* secondTrack = te::getAudioTracks (*edit)[1];
+    expect (secondTrack != nullptr, "Expected second track for lookup cache test");
+    auto plugin = edit->getPluginCache().createNewPlugin (te::ReverbPlugin::xmlTypeName, {});
+    expect (plugin != nullptr, "Expected built-in reverb for lookup cache test");
+    secondTrack->pluginList.insertPlugin (plugin, 0, nullptr);
+
+    auto params = plugin->getAutomatableParameters();
+    expect (! params.isEmpty(), "Expected reverb parameters for lookup cache test");
+    const auto paramId = params.getFirst()->paramID;
+
+    expect (handler.executeCommand (makeSetParameter (1, te::ReverbPlugin::xmlTypeName, paramId))["status"].toString() == "ok",
+            "Expected plugin identifier cache to refresh after a plugin is inserted");
+
+    edit->moveTrack (secondTrack, te::TrackInsertPoint (nullptr, te::getAudioTracks (*edit).getLast()));
+    expect (handler.executeCommand (makeSetParameter (2, te::ReverbPlugin::xmlTypeName, paramId))["status"].toString() == "ok",
+            "Expected public track index cache to follow a track reorder");
+    expect (handler.executeCommand (makeSetParameter (1, te::ReverbPlugin::xmlTypeName, paramId))["status"].toString() == "error",
+            "Expected the old index to stop resolving to the moved track");
+
+    plugin->deleteFromParent();
+    expect (handler.executeCommand (makeSetParameter (2, te::ReverbPlugin::xmlTypeName, paramId))["status"].toString() == "error",
+            "Expected plugin identifier cache to drop removed plugins");
+
+    edit->deleteTrack (te::getAudioTracks (*edit).getLast());
+    tracksResponse = runJsonCommand (handler, R"({ "action":"get_tracks" })");
+    expect (tracksResponse["tracks"].size() == 2, "Expected cached public tracks to refresh after a track is removed");
+    expect (runJsonCommand (handler, R"({ "action":"set_track_volume", "track_id":2, "value_db":-3.0 })")["status"].toString() == "error",
+            "Expected removed track index not to resolve from a stale cache");
+
+    auto unknownResponse = runJsonCommand (handler, R"({ "action":"not_a_command" })");
+    expect (unknownResponse["message"].toString() == "Unknown action: not_a_command",
+            "Expected hashed dispatch to report unknown actions");
+
+    (void) fixtureDir.deleteRecursively();
+}
+
 void testMoveTrackToFolderRejectsCycles (te::Engine& engine)
 {
     auto fixtureDir = getFixtureDir ("folder_cycle");
@@ -2923,6 +3957,141 @@ void testBounceTrackWritesProjectManagedUniqueFiles (te::Engine& engine)
     (void) fixtureDir.deleteRecursively();
 }
 
+void testFreezeTrackCachesRenderAndInvalidatesOnEdit (te::Engine& engine)
+{
+    auto fixtureDir = getFixtureDir ("freeze_track");
+    auto projectDir = fixtureDir.getChildFile ("project");
+    auto projectFile = projectDir.getChildFile ("freeze_track.tracktionedit");
+    projectDir.createDirectory();
+
+    auto edit = te::createEmptyEdit (engine, projectFile);
+    edit->ensureNumberOfAudioTracks (1);
+    auto* track = te::getAudioTracks (*edit).getFirst();
+
+    auto source = writeTestWav (projectDir.getChildFile ("freeze_source.wav"), 0.3f);
+    auto clip = track->insertWaveClip ("freeze_source", source,
+                                       { { te::TimePosition::fromSeconds (0.0),
+                                           te::TimePosition::fromSeconds (0.2) },
+                                         te::TimeDuration() },
+                                       false);
+    expect (clip != nullptr, "Expected clip insertion for freeze test");
+
+    auto pluginState = te::createValueTree (te::IDs::PLUGIN,
+                                            te::IDs::type, te::ReverbPlugin::xmlTypeName,
+                                            "pluginFormatName", te::PluginManager::builtInPluginFormatName,
+                                            "fileOrIdentifier", te::ReverbPlugin::xmlTypeName,
+                                            "manufacturer", "Waive");
+    auto plugin = edit->getPluginCache().createNewPlugin (pluginState);
+    expect (plugin != nullptr, "Expected reverb plugin for freeze test");
+    track->pluginList.insertPlugin (plugin, 0, nullptr);
+    edit->getTransport().ensureContextAllocated();
+
+    CommandHandler handler (*edit);
+    handler.setProjectFile (projectFile);
+    handler.setAllowedMediaDirectories ({ fixtureDir });
+
+    auto frozen = runJsonCommand (handler, R"({ "action":"freeze_track", "track_id":0, "tail_seconds":0.5 })");
+    expect (frozen["status"].toString() == "ok", "Expected freeze_track to succeed");
+    expect (! (bool) frozen["cached"], "Expected first freeze to render a new cache file");
+    const juce::File cacheFile (frozen["cache_file"].toString());
+    expect (cacheFile.existsAsFile() && cacheFile.isAChildOf (projectDir),
+            "Expected freeze render to be cached inside the project directory");
+    expect (std::abs ((double) frozen["end"] - 0.7) < 1.0e-6, "Expected freeze range to include the tail");
+    expect (TrackFreezeManager::isFrozen (*track), "Expected track to be marked frozen");
+    expect (clip->isMuted(), "Expected original clip to be muted while frozen");
+    expect (! plugin->isEnabled(), "Expected track plugins to be bypassed while frozen");
+    expect (track->getClips().size() == 2, "Expected one freeze clip alongside the original");
+
+    auto stemsDir = fixtureDir.getChildFile ("stems");
+    auto stems = runJsonCommand (handler, juce::String::formatted (R"({
+        "action":"export_stems",
+        "output_dir":"%s"
+    })", stemsDir.getFullPathName().replace ("\\", "\\\\").replace ("\"", "\\\"").toRawUTF8()));
+    expect (stems["status"].toString() == "ok", "Expected export_stems of a frozen track to succeed");
+    expect ((bool) stems["stems"][0]["frozen"], "Expected stem export to render from the freeze");
+
+    auto unfrozen = runJsonCommand (handler, R"({ "action":"unfreeze_track", "track_id":0 })");
+    expect (unfrozen["status"].toString() == "ok" && (bool) unfrozen["was_frozen"], "Expected unfreeze_track to succeed");
+    expect (! TrackFreezeManager::isFrozen (*track), "Expected track to be unfrozen");
+    expect (! clip->isMuted() && plugin->isEnabled(), "Expected unfreeze to restore clip and plugin state");
+    expect (track->getClips().size() == 1, "Expected unfreeze to remove the freeze clip");
+
+    auto refrozen = runJsonCommand (handler, R"({ "action":"freeze_track", "track_id":0, "tail_seconds":0.5 })");
+    expect (refrozen["status"].toString() == "ok" && (bool) refrozen["cached"],
+            "Expected refreezing unchanged content to reuse the cached render");
+    expect (refrozen["cache_file"].toString() == cacheFile.getFullPathName(), "Expected the same cache file on refreeze");
+
+    auto longerTail = runJsonCommand (handler, R"({ "action":"freeze_track", "track_id":0, "tail_seconds":1.0 })");
+    expect (longerTail["status"].toString() == "ok" && ! (bool) longerTail["cached"],
+            "Expected refreezing with a different tail to render again");
+    expect (longerTail["cache_file"].toString() != cacheFile.getFullPathName(),
+            "Expected a different tail to use a different cache file");
+    expect (std::abs ((double) longerTail["end"] - 1.2) < 1.0e-6, "Expected the new tail in the freeze range");
+    expect (track->getClips().size() == 2, "Expected refreezing to replace the freeze clip");
+
+    clip->setStart (te::TimePosition::fromSeconds (0.1), true, false);
+    const auto undoDepth = edit->getUndoManager().getNumActionsInCurrentTransaction();
+    auto tracks = runJsonCommand (handler, R"({ "action":"get_tracks" })");
+    expect ((bool) tracks["tracks"][0]["frozen"], "Expected get_tracks to leave the freeze state alone");
+
+    auto liveStems = runJsonCommand (handler, juce::String::formatted (R"({
+        "action":"export_stems",
+        "output_dir":"%s"
+    })", stemsDir.getFullPathName().replace ("\\", "\\\\").replace ("\"", "\\\"").toRawUTF8()));
+    expect (liveStems["status"].toString() == "ok", "Expected export_stems with a stale freeze to succeed");
+    expect (! (bool) liveStems["stems"][0]["frozen"], "Expected a stale freeze to render live");
+    expect (TrackFreezeManager::isFrozen (*track) && clip->isMuted(), "Expected stem export not to unfreeze the track");
+    expect (edit->getUndoManager().getNumActionsInCurrentTransaction() == undoDepth,
+            "Expected get_tracks and export_stems not to add undoable changes");
+
+    auto refreshed = runJsonCommand (handler, R"({ "action":"refresh_freezes" })");
+    expect (refreshed["status"].toString() == "ok" && (int) refreshed["unfrozen"] == 1,
+            "Expected refresh_freezes to unfreeze the moved track");
+    expect (! TrackFreezeManager::isFrozen (*track), "Expected moving a clip to invalidate the freeze");
+    expect (! clip->isMuted() && plugin->isEnabled(), "Expected invalidation to restore clip and plugin state");
+
+    (void) fixtureDir.deleteRecursively();
+}
+
+void testFreezeInvalidationSharesTheEditUndoStep (te::Engine& engine)
+{
+    auto fixtureDir = getFixtureDir ("freeze_undo");
+    EditSession session (engine);
+    auto& edit = session.getEdit();
+    edit.ensureNumberOfAudioTracks (1);
+    auto* track = te::getAudioTracks (edit).getFirst();
+
+    auto source = writeTestWav (fixtureDir.getChildFile ("freeze_undo_source.wav"), 0.3f);
+    auto clip = track->insertWaveClip ("freeze_undo_source", source,
+                                       { { te::TimePosition::fromSeconds (0.0),
+                                           te::TimePosition::fromSeconds (0.2) },
+                                         te::TimeDuration() },
+                                       false);
+    expect (clip != nullptr, "Expected clip insertion for freeze undo test");
+    edit.getTransport().ensureContextAllocated();
+
+    CommandHandler handler (edit);
+    handler.setAllowedMediaDirectories ({ fixtureDir });
+    UndoableCommandHandler undoableHandler (handler, session);
+
+    auto frozen = juce::JSON::parse (undoableHandler.handleCommand (R"({ "action":"freeze_track", "track_id":0 })"));
+    expect (frozen["status"].toString() == "ok", "Expected freeze_track to succeed through the undoable handler");
+
+    session.performEdit ("Move Clip", [&] (te::Edit&)
+    {
+        clip->setStart (te::TimePosition::fromSeconds (0.1), true, false);
+    });
+    expect (! TrackFreezeManager::isFrozen (*track), "Expected the move to unfreeze the track before performEdit returns");
+
+    session.undo();
+    expect (std::abs (clip->getPosition().getStart().inSeconds()) < 1.0e-6, "Expected undo to restore the clip position");
+    expect (TrackFreezeManager::isFrozen (*track) && clip->isMuted(),
+            "Expected the same undo step to restore the frozen state");
+
+    (void) juce::File (frozen["cache_file"].toString()).deleteFile();
+    (void) fixtureDir.deleteRecursively();
+}
+
 void testSetLoopRegionRejectsInvalidBoundsWithoutMutation (te::Engine& engine)
 {
     auto fixtureDir = getFixtureDir ("invalid_loop_region");
@@ -3562,8 +4731,19 @@ int main()
         testPerformEditExceptionSafety (session);
         testCoalescedPerformEditExceptionSafety (engine);
         testDirtyStateSavepointAcrossCoalescedUndoRedo (engine);
+        testSavePointKeepsLaterEditsDirty (engine);
         testNoOpPerformEditDoesNotDirtyCleanSession (engine);
+        testBulkEditNotifiesOnceAndUndoesInOneStep (engine);
         testUndoableCommandHandlerWrapsMutatingCommands (engine);
+        testTypedCommandEntryPointMatchesJsonPath (engine);
+        testParameterStreamCoalescesUpdatesIntoGestures (engine);
+        testParameterStreamGivesEachProducerItsOwnLane (engine);
+        testEditHostIsolatesEditsAndUndoHistories (engine);
+        testEditHostReportsStartupTimings (engine);
+        testAsyncExportMixdownRendersOnScheduler (engine);
+        testRenderBatchExpandsJobsIntoParallelRenders (engine);
+        testRenderEncoderFansOutWithSingleGain();
+        testLoudnessMeterMatchesReferenceLevels();
         testUndoableCommandHandlerPassesThroughFileSideEffectCommands (engine);
         testClickTrackToggleSupportsUndoRedo (engine);
         testModelManagerSettingsPersistence();
@@ -3577,12 +4757,14 @@ int main()
         testCollectAndSavePersistsToExplicitProjectFile (engine);
         testCollectAndSaveCopiesExternalMediaAndRewritesReferences (engine);
         testCollectAndSaveRewritesInternalAbsoluteReferencesRelative (engine);
+        testCollectAndSaveFollowsBinaryCompressionSetting (engine);
         testCollectAndSaveRollsBackWhenOneFileFails (engine);
         testRemoveUnusedMediaReportsActualBytesFreed (engine);
         testMediaManagementCanonicalisesSymlinkedReferences (engine);
         testCollectAndSaveRestoresReferencesWhenSaveFails (engine);
         testPackageAsZipIncludesOnlyCurrentProjectFile (engine);
         testPackageAsZipOverwritesExistingArchiveAtomically (engine);
+        testProjectFileFormatsRoundTripAndReplaceAtomically (engine);
         testPackageEditAsZipIncludesProjectRelativeMediaOutsideAudio (engine);
         testPackageAsZipRejectsOutputInsideProjectDirectory (engine);
         testPackageAsZipRejectsSymlinkedOutputInsideProjectDirectory (engine);
@@ -3596,6 +4778,8 @@ int main()
         testCommandServerStartFailureDoesNotClobberExistingAuthTokenFile();
         testCommandServerDisconnectsSilentUnauthenticatedClients();
         testCommandServerAllowsDelayedAuthenticationWhenTimeoutDisabled();
+        testSharedMemoryRingWrapsAndReleasesSpace();
+        testLocalCommandServerAuthenticatesAndNegotiatesSharedMemory();
         testPluginPresetManagerUsesDocumentedWrapperAndStableIdentifier (engine);
         testPluginPresetCommandsSupportMasterChain (engine);
         testPluginPresetCommandsRejectMissingPluginIndex (engine);
@@ -3604,6 +4788,7 @@ int main()
         testCommandSchemaDocumentsAliases();
         testAiToolSchemaDocumentsAliases();
         testSetParameterAcceptsStablePluginIdentifier (engine);
+        testCommandHandlerLookupCachesFollowEditStructureChanges (engine);
         testTrackCommandsReturnPublicIndicesWithFolderTracks (engine);
         testReorderTrackUsesPublicIndicesAcrossFolderTracks (engine);
         testMoveTrackToFolderRejectsCycles (engine);
@@ -3615,6 +4800,8 @@ int main()
         testExportStemsRejectsInvalidBounds (engine);
         testCommandHandlerRejectsSymlinkEscapesForOutputFiles (engine);
         testBounceTrackWritesProjectManagedUniqueFiles (engine);
+        testFreezeTrackCachesRenderAndInvalidatesOnEdit (engine);
+        testFreezeInvalidationSharesTheEditUndoStep (engine);
         testSetLoopRegionRejectsInvalidBoundsWithoutMutation (engine);
         testUndoableCommandHandlerSupportsLoopRegionUndoRedo (engine);
         testCommandHandlerRejectsMalformedCommandRequests (engine);
@@ -3,6 +3,11 @@
 
 #include "AudioAnalysis.h"
 #include "AudioAnalysisCache.h"
+#include "AudioFeatures.h"
+#include "CrossCorrelation.h"
+#include "SpectralSeparation.h"
+#include "TempoAnalysis.h"
+#include "ToolAnalysisStore.h"
 #include "EditSession.h"
 #include "ToolDiff.h"
 #include "Tool.h"
@@ -18,12 +23,18 @@
 #include "StemSeparationTool.h"
 #include "RenameTracksFromClipsTool.h"
 #include "AutoMixSuggestionsTool.h"
+#include "SampleLibraryIndex.h"
+#include "SamplePreviewPlayer.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 namespace te = tracktion;
 
@@ -286,13 +297,163 @@ void testAnalysisCaching()
     expect (summary1.totalSamples == summary2.totalSamples, "Cached total samples should match");
 }
 
+void testAnalysisClipRange()
+{
+    // 1 s silence, 0.5 s tone, 1 s silence; the clip plays 0.8 s .. 1.8 s of it.
+    auto file = generateSilenceContentSilenceWav ("range_test.wav", 1.0, 0.5, 1.0, 0.5f);
+    const auto summary = waive::analyseAudioFile (file, { 0.8, 1.0, 1.0 }, 0.01f, 0.0f);
+
+    expect (summary.valid, "Range analysis should succeed");
+    expect (summary.rangeStartSample == (juce::int64) (0.8 * 44100.0), "Range should start at the clip offset");
+    expect (summary.totalSamples == 44100, "Only the clip's length should be read");
+    expectApprox (summary.toClipSeconds (summary.firstAboveSample), 0.2, 0.01,
+                  "Content should be found 0.2 s into the clip");
+    expectApprox (summary.toClipSeconds (summary.lastAboveSample), 0.7, 0.01,
+                  "Content should end 0.7 s into the clip");
+
+    // At double speed the same source region plays in half the edit time.
+    const auto fast = waive::analyseAudioFile (file, { 0.4, 0.5, 2.0 }, 0.01f, 0.0f);
+    expect (fast.valid && fast.totalSamples == 44100, "Speed ratio should scale the source range");
+    expectApprox (fast.toClipSeconds (fast.firstAboveSample), 0.1, 0.01,
+                  "Positions should be reported in clip time at double speed");
+
+    const auto silentPart = waive::analyseAudioFile (file, { 0.0, 0.9, 1.0 }, 0.01f, 0.0f);
+    expect (silentPart.valid && silentPart.firstAboveSample < 0,
+            "A range covering only the leading silence should find no activity");
+
+    const auto pastEnd = waive::analyseAudioFile (file, { 5.0, 1.0, 1.0 }, 0.01f, 0.0f);
+    expect (! pastEnd.valid, "A range past the end of the file should be invalid");
+}
+
+void testAnalysisCachingPerRange()
+{
+    auto file = generateSilenceContentSilenceWav ("range_cache_test.wav", 1.0, 0.5, 1.0, 0.5f);
+    waive::AudioAnalysisCache cache (10);
+
+    const auto silent = waive::analyseAudioFile (file, { 0.0, 0.9, 1.0 }, 0.01f, 0.0f, {}, &cache);
+    const auto active = waive::analyseAudioFile (file, { 0.8, 1.0, 1.0 }, 0.01f, 0.0f, {}, &cache);
+    expect (silent.firstAboveSample < 0 && active.firstAboveSample >= 0,
+            "Different ranges of one file should get separate cache entries");
+
+    waive::AudioAnalysisCache::CacheKey key { file, 0.01f, 0.0f, 0.8, 1.0 };
+    expect (cache.get (key).has_value(), "Range entry should be cached under its source range");
+
+    waive::AudioAnalysisCache::CacheKey wholeFileKey { file, 0.01f, 0.0f };
+    expect (! cache.get (wholeFileKey).has_value(), "Range analyses should not populate the whole-file entry");
+
+    // Same source region at double speed reuses the entry but reports clip time at its own speed.
+    const auto fast = waive::analyseAudioFile (file, { 0.4, 0.5, 2.0 }, 0.01f, 0.0f, {}, &cache);
+    expect (fast.firstAboveSample == active.firstAboveSample, "Same source range should hit the cache");
+    expectApprox (fast.toClipSeconds (fast.firstAboveSample), 0.1, 0.01,
+                  "Cached result should use the caller's speed ratio");
+}
+
+void testAnalysisLevelsAndLoudness()
+{
+    // A 0.5 amplitude sine: RMS 0.5 / sqrt(2), and about -9 LUFS near 440 Hz.
+    auto file = generateSineWav ("levels_test.wav", 440.0, 0.5f, 2.0);
+    waive::AudioAnalysisCache cache (10);
+
+    const auto plain = waive::analyseAudioFile (file, {}, 0.01f, 0.0f, {}, &cache);
+    expect (plain.valid, "Level analysis should succeed");
+    expectApprox (plain.rmsGain, 0.5 / std::sqrt (2.0), 0.005, "RMS of a 0.5 amplitude sine");
+    expect (! plain.hasLoudness, "Loudness should only be measured when asked for");
+
+    const auto measured = waive::analyseAudioFile (file, {}, 0.01f, 0.0f, {}, &cache, true);
+    expect (measured.hasLoudness, "A cached entry without loudness should be measured again");
+    expectApprox (measured.integratedLufs, -9.0, 0.5, "Integrated loudness of a 0.5 amplitude sine");
+    expectApprox (measured.peakGain, plain.peakGain, 1.0e-6, "Loudness pass should report the same peak");
+
+    const auto cached = waive::analyseAudioFile (file, {}, 0.01f, 0.0f, {}, &cache);
+    expect (cached.hasLoudness, "The loudness result should replace the cached entry");
+
+    const auto silence = waive::analyseAudioFile (generateSilenceWav ("levels_silence.wav", 1.0),
+                                                  {}, 0.01f, 0.0f, {}, nullptr, true);
+    expect (silence.rmsGain == 0.0f, "Silence should have zero RMS");
+    expect (silence.integratedLufs <= -120.0, "Silence should sit on the loudness floor");
+}
+
+void testToolAnalysisStore()
+{
+    auto fixtureDir = getUniqueFixtureDir ("analysis_store");
+    auto storeFile = fixtureDir.getChildFile ("analysis_store.json");
+    auto file = generateSilenceContentSilenceWav ("store_test.wav", 0.5, 1.0, 0.5, 0.5f);
+    const waive::AudioAnalysisRange range { 0.25, 1.5, 1.0 };
+
+    waive::ToolDescription tool;
+    tool.name = "store_test_tool";
+    tool.version = "1.0.0";
+
+    auto* paramsObj = new juce::DynamicObject();
+    paramsObj->setProperty ("threshold_gain", 0.01);
+    const juce::var analysisParams (paramsObj);
+
+    const auto key = waive::ToolAnalysisStore::makeKey (tool, analysisParams, file, range);
+    expect (key == waive::ToolAnalysisStore::makeKey (tool, analysisParams, file, range), "Keys should be stable");
+
+    auto* otherParamsObj = new juce::DynamicObject();
+    otherParamsObj->setProperty ("threshold_gain", 0.02);
+    expect (key != waive::ToolAnalysisStore::makeKey (tool, juce::var (otherParamsObj), file, range),
+            "Analysis parameters should be part of the key");
+    expect (key != waive::ToolAnalysisStore::makeKey (tool, analysisParams, file, { 0.5, 1.0, 1.0 }),
+            "The clip range should be part of the key");
+
+    auto newerTool = tool;
+    newerTool.version = "1.1.0";
+    expect (key != waive::ToolAnalysisStore::makeKey (newerTool, analysisParams, file, range),
+            "The tool version should be part of the key");
+
+    int analyseCount = 0;
+    const auto analyse = [&]
+    {
+        ++analyseCount;
+        return waive::detectActiveRegions (file, range, {});
+    };
+
+    waive::AudioAnalysisSummary first;
+    {
+        waive::ToolAnalysisStore store (storeFile);
+        first = store.getOrAnalyse (key, analyse);
+        const auto second = store.getOrAnalyse (key, analyse);
+        expect (analyseCount == 1, "A stored analysis should not be recomputed");
+        expect (second.activeRegions.size() == first.activeRegions.size(), "Stored regions should round-trip");
+        expect (store.save() && storeFile.existsAsFile(), "The store should save to its file");
+    }
+
+    // A new session reads the same entries back from the project cache.
+    waive::ToolAnalysisStore reloaded (storeFile);
+    const auto restored = reloaded.getOrAnalyse (key, analyse);
+    expect (analyseCount == 1, "A reloaded store should serve saved analyses");
+    expect (restored.valid && restored.firstAboveSample == first.firstAboveSample
+                && restored.lastAboveSample == first.lastAboveSample,
+            "Restored activity bounds should match");
+    expectApprox (restored.peakGain, first.peakGain, 1.0e-6, "Restored peak should match");
+    expect (restored.activeRegions.size() == 1
+                && restored.activeRegions.front().startSample == first.activeRegions.front().startSample,
+            "Restored regions should match");
+
+    // Rewriting the source changes its fingerprint.
+    juce::Thread::sleep (20);
+    file = generateSilenceContentSilenceWav ("store_test.wav", 0.5, 1.0, 0.5, 0.25f);
+    expect (waive::ToolAnalysisStore::makeKey (tool, analysisParams, file, range) != key,
+            "A rewritten source file should get a new key");
+
+    waive::ToolAnalysisStore small (fixtureDir.getChildFile ("small_store.json"), 2);
+    small.put ("a", 1);
+    small.put ("b", 2);
+    (void) small.get ("a");
+    small.put ("c", 3);
+    expect (small.getNumEntries() == 2 && small.get ("a").has_value() && ! small.get ("b").has_value(),
+            "The least recently used entry should be evicted");
+}
+
 // ── Tool Registration Tests ────────────────────────────────────────────────
 
 void testToolRegistryCompleteness()
 {
     waive::ToolRegistry registry;
 
-    // All 7 built-in tools should be registered
+    // All 8 built-in tools should be registered
     const juce::StringArray expectedTools = {
         "normalize_selected_clips",
         "rename_tracks_from_clips",
@@ -300,7 +461,8 @@ void testToolRegistryCompleteness()
         "detect_silence_and_cut_regions",
         "align_clips_by_transient",
         "stem_separation",
-        "auto_mix_suggestions"
+        "auto_mix_suggestions",
+        "detect_tempo"
     };
 
     for (auto& name : expectedTools)
@@ -322,7 +484,8 @@ void testToolDescriptions()
         "detect_silence_and_cut_regions",
         "align_clips_by_transient",
         "stem_separation",
-        "auto_mix_suggestions"
+        "auto_mix_suggestions",
+        "detect_tempo"
     };
 
     for (auto& name : toolNames)
@@ -457,6 +620,57 @@ with open(os.path.join(output_dir, "result.json"), "w", encoding="utf-8") as han
             "Expected helper script to inherit the original process working directory");
 }
 
+void testExternalToolRunnerMeasuresInputLoudnessOnlyWhenAsked()
+{
+    auto fixtureDir = getUniqueFixtureDir ("external_runner_loudness");
+    auto scriptFile = fixtureDir.getChildFile ("echo_params.py");
+    auto inputFile = generateSineWav ("external_runner_loudness.wav", 440.0, 0.3f, 1.0);
+
+    writeTextFile (scriptFile, R"(#!/usr/bin/env python3
+import json
+import os
+import sys
+
+args = sys.argv[1:]
+input_dir = args[args.index("--input-dir") + 1]
+output_dir = args[args.index("--output-dir") + 1]
+
+with open(os.path.join(input_dir, "params.json"), encoding="utf-8") as handle:
+    params = json.load(handle)
+
+with open(os.path.join(output_dir, "result.json"), "w", encoding="utf-8") as handle:
+    json.dump({"has_input_loudness": "input_loudness" in params}, handle)
+)");
+
+    waive::ExternalToolManifest manifest;
+    manifest.name = "runner_loudness_test";
+    manifest.displayName = "Runner Loudness Test";
+    manifest.version = "1.0.0";
+    manifest.executable = "python3";
+    manifest.arguments.add ("echo_params.py");
+    manifest.baseDirectory = fixtureDir;
+    manifest.timeoutMs = 10000;
+    manifest.acceptsAudioInput = true;
+
+    waive::ExternalToolRunner runner;
+    std::atomic<bool> cancelFlag { false };
+    waive::ProgressReporter reporter (1, cancelFlag,
+                                      [] (int, float, const juce::String&) {});
+
+    const auto receivedLoudness = [&]
+    {
+        auto output = runner.run (manifest, juce::var(), inputFile, reporter);
+        expect (output.success, "Expected the loudness echo tool to run");
+        auto* resultObj = output.resultData.getDynamicObject();
+        return resultObj != nullptr && (bool) resultObj->getProperty ("has_input_loudness");
+    };
+
+    expect (! receivedLoudness(), "Expected no input_loudness unless the manifest asks for it");
+
+    manifest.wantsInputLoudness = true;
+    expect (receivedLoudness(), "Expected input_loudness when the manifest asks for it");
+}
+
 void testExternalToolRunnerPreservesFailureOutput()
 {
     auto fixtureDir = getUniqueFixtureDir ("external_runner_failure");
@@ -728,6 +942,65 @@ void testSilenceDetectionWithQuietContent()
     expect (summary.firstAboveSample == -1, "Very quiet content should not exceed threshold");
 }
 
+void testSilenceDetectionInteriorRegions()
+{
+    // tone 0.5-1.5 s, long gap, tone 2.5-3.0 s, short gap, tone 3.1-3.6 s with a
+    // quiet tail to 3.9 s, then a 5 ms blip at 4.4 s.
+    constexpr double sampleRate = 44100.0;
+    std::vector<float> samples ((size_t) (5.0 * sampleRate), 0.0f);
+
+    auto addTone = [&] (double startSec, double endSec, float amplitude)
+    {
+        for (auto i = (size_t) (startSec * sampleRate); i < (size_t) (endSec * sampleRate); ++i)
+            samples[i] = amplitude * (float) std::sin (2.0 * juce::MathConstants<double>::pi * 440.0 * (double) i / sampleRate);
+    };
+
+    addTone (0.5, 1.5, 0.5f);
+    addTone (2.5, 3.0, 0.5f);
+    addTone (3.1, 3.6, 0.5f);
+    addTone (3.6, 3.9, 0.008f); // between the close and open thresholds
+    addTone (4.4, 4.405, 0.5f);
+
+    auto file = writeTestWav ("interior_regions.wav", samples.data(), (int) samples.size());
+
+    waive::ActivityGateSettings gate;
+    gate.openThresholdGain = 0.01f;
+    gate.closeThresholdGain = 0.005f;
+    const auto summary = waive::detectActiveRegions (file, {}, gate);
+
+    expect (summary.valid, "Region detection should succeed");
+    expect (summary.activeRegions.size() == 2,
+            "Short gap should merge and the blip should be dropped, got "
+                + std::to_string (summary.activeRegions.size()) + " regions");
+
+    if (summary.activeRegions.size() == 2)
+    {
+        const auto& first = summary.activeRegions[0];
+        const auto& second = summary.activeRegions[1];
+        expectApprox (first.startSample / sampleRate, 0.5, 0.01, "First region start");
+        expectApprox (first.endSample / sampleRate, 1.5, 0.01, "First region end");
+        expectApprox (second.startSample / sampleRate, 2.5, 0.01, "Second region start");
+        expectApprox (second.endSample / sampleRate, 3.9, 0.01, "Hysteresis should keep the quiet tail open");
+        expect (summary.firstAboveSample == first.startSample && summary.lastAboveSample == second.endSample - 1,
+                "First/last activity should span the regions");
+    }
+
+    // Without hysteresis the quiet tail is silence.
+    gate.closeThresholdGain = gate.openThresholdGain;
+    const auto noHysteresis = waive::detectActiveRegions (file, {}, gate);
+    expect (noHysteresis.activeRegions.size() == 2
+                && std::abs (noHysteresis.activeRegions[1].endSample / sampleRate - 3.6) < 0.01,
+            "Without hysteresis the region should close at the end of the loud tone");
+
+    // A longer minimum gap joins everything into one region.
+    gate.minGapSeconds = 2.0;
+    const auto merged = waive::detectActiveRegions (file, {}, gate);
+    expect (merged.activeRegions.size() == 1, "Gaps under min_gap should merge into one region");
+
+    const auto cancelled = waive::detectActiveRegions (file, {}, gate, [] { return true; });
+    expect (cancelled.cancelled && ! cancelled.valid, "Cancelled detection should be invalid");
+}
+
 // ── Transient Alignment Logic Test ────────────────────────────────────────
 
 void testTransientAlignmentCalculation()
@@ -761,6 +1034,172 @@ void testTransientAlignmentCalculation()
 
 // ── Gain Staging Logic Test ───────────────────────────────────────────────
 
+void testCrossCorrelationFindsSampleOffset()
+{
+    // The same noise burst picked up by two mics: the far one is 1234 samples
+    // later, quieter, inverted and has its own noise floor.
+    constexpr int numSamples = 44100 * 2;
+    constexpr int delaySamples = 1234;
+    juce::Random random (42);
+
+    std::vector<float> source ((size_t) numSamples, 0.0f);
+    for (int i = 22050; i < 66150; ++i)
+        source[(size_t) i] = random.nextFloat() * 2.0f - 1.0f;
+
+    std::vector<float> farMic ((size_t) numSamples, 0.0f);
+    for (int i = delaySamples; i < numSamples; ++i)
+        farMic[(size_t) i] = -0.4f * source[(size_t) (i - delaySamples)] + 0.02f * (random.nextFloat() * 2.0f - 1.0f);
+
+    auto nearFile = writeTestWav ("xcorr_near.wav", source.data(), numSamples);
+    auto farFile = writeTestWav ("xcorr_far.wav", farMic.data(), numSamples);
+
+    // Both clips start at 0; compare 1 s of the near mic against the far mic
+    // read with 100 ms either side, as the align tool does.
+    const auto reference = waive::readClipSignal (nearFile, {}, 0.0, 1.0);
+    const auto target = waive::readClipSignal (farFile, {}, -0.1, 1.2, reference.sampleRate);
+    expect (reference.valid && target.valid, "Clip signals should be readable");
+    expect (reference.samples.size() == 44100 && target.samples.size() == 52920,
+            "Clip signals should have the requested length");
+    expect (target.samples[0] == 0.0f, "Time before the clip start should read as silence");
+
+    waive::CorrelationSettings settings;
+    const auto positiveOnly = waive::findBestLag (reference.samples, target.samples, settings);
+    expect (! positiveOnly.valid || positiveOnly.correlation < 0.3f,
+            "An inverted copy should not match strongly without polarity detection");
+
+    settings.detectPolarity = true;
+    const auto match = waive::findBestLag (reference.samples, target.samples, settings);
+    expect (match.valid, "Correlation should find a match");
+    expect (match.lagSamples == 4410 + delaySamples,
+            "Offset should be sample-accurate, got " + std::to_string (match.lagSamples));
+    expect (match.polarityInverted && match.correlation < -0.9f, "Inverted polarity should be detected");
+
+    // A clip that starts 0.5 s into the far mic's file sees the same audio 0.5 s earlier.
+    const auto offsetTarget = waive::readClipSignal (farFile, { 0.5, 1.5, 1.0 }, -0.1, 1.2, reference.sampleRate);
+    expectApprox (offsetTarget.samples[4410], target.samples[4410 + 22050], 1.0e-4,
+                  "Clip offset should shift the read source range");
+}
+
+void testRunInParallelVisitsEveryItem()
+{
+    std::atomic<bool> cancelled { false };
+    waive::ProgressReporter reporter (1, cancelled, nullptr);
+
+    std::vector<int> visits (257, 0);
+    waive::runInParallel (reporter, (int) visits.size(), [&] (int i) { ++visits[(size_t) i]; });
+    expect (std::all_of (visits.begin(), visits.end(), [] (int v) { return v == 1; }),
+            "Every item should be processed exactly once");
+
+    bool threw = false;
+    try
+    {
+        waive::runInParallel (reporter, 16, [] (int i) { if (i == 3) throw std::runtime_error ("boom"); });
+    }
+    catch (const std::runtime_error&)
+    {
+        threw = true;
+    }
+    expect (threw, "A worker exception should reach the job thread");
+
+    cancelled = true;
+    std::atomic<int> calls { 0 };
+    waive::runInParallel (reporter, 100, [&] (int) { ++calls; });
+    expect (calls.load() == 0, "No items should start once the job is cancelled");
+}
+
+void testBackgroundJobsDoNotBlockNormalJobs()
+{
+    // One normal worker: if background work shared it, the normal job would wait.
+    waive::JobQueue queue (1);
+    std::atomic<bool> release { false };
+    std::atomic<bool> backgroundStarted { false };
+    std::atomic<bool> normalRan { false };
+
+    queue.submit ({ "Speculative", "test", waive::JobPriority::background },
+                  [&] (waive::ProgressReporter& reporter)
+                  {
+                      backgroundStarted = true;
+                      while (! release.load() && ! reporter.isCancelled())
+                          juce::Thread::sleep (5);
+                  });
+
+    for (int waited = 0; ! backgroundStarted.load() && waited < 2000; waited += 10)
+        juce::Thread::sleep (10);
+
+    expect (backgroundStarted.load(), "The background job should run");
+
+    queue.submit ({ "Requested", "test" }, [&] (waive::ProgressReporter&) { normalRan = true; });
+
+    for (int waited = 0; ! normalRan.load() && waited < 2000; waited += 10)
+        juce::Thread::sleep (10);
+
+    expect (normalRan.load(), "A normal job should not wait behind a background job");
+
+    release = true;
+}
+
+void testPromotedBackgroundJobLeavesTheBackgroundQueue()
+{
+    waive::JobQueue queue (1);
+    std::atomic<bool> release { false };
+    std::atomic<bool> blockerStarted { false };
+    std::atomic<int> promotedRuns { 0 };
+
+    queue.submit ({ "Blocker", "test", waive::JobPriority::background },
+                  [&] (waive::ProgressReporter& reporter)
+                  {
+                      blockerStarted = true;
+                      while (! release.load() && ! reporter.isCancelled())
+                          juce::Thread::sleep (5);
+                  });
+
+    for (int waited = 0; ! blockerStarted.load() && waited < 2000; waited += 10)
+        juce::Thread::sleep (10);
+
+    // Queued behind the blocker on the single background thread until promoted.
+    const auto jobId = queue.submit ({ "Adopted", "test", waive::JobPriority::background },
+                                     [&] (waive::ProgressReporter&) { ++promotedRuns; });
+    juce::Thread::sleep (50);
+    expect (promotedRuns.load() == 0, "A queued background job should wait for the background thread");
+
+    queue.promoteJob (jobId);
+
+    for (int waited = 0; promotedRuns.load() == 0 && waited < 2000; waited += 10)
+        juce::Thread::sleep (10);
+
+    expect (promotedRuns.load() == 1, "A promoted job should run on a normal worker");
+
+    // Its stale background entry must not run it a second time.
+    release = true;
+    expect (queue.waitForJobToFinish (jobId, 2000), "The promoted job should finish");
+    juce::Thread::sleep (100);
+    expect (promotedRuns.load() == 1, "A promoted job should run exactly once");
+}
+
+void testBackgroundJobRunsParallelWorkOnItsOwnThread()
+{
+    waive::JobQueue queue (1);
+    std::mutex idsMutex;
+    std::vector<std::thread::id> workerIds;
+    std::thread::id jobThreadId;
+
+    const auto jobId = queue.submit ({ "Speculative", "test", waive::JobPriority::background },
+                                     [&] (waive::ProgressReporter& reporter)
+                                     {
+                                         jobThreadId = std::this_thread::get_id();
+                                         waive::runInParallel (reporter, 8, [&] (int)
+                                         {
+                                             std::lock_guard<std::mutex> lock (idsMutex);
+                                             workerIds.push_back (std::this_thread::get_id());
+                                         });
+                                     });
+
+    expect (queue.waitForJobToFinish (jobId, 2000), "The background job should finish");
+    expect (workerIds.size() == 8, "Every item should run");
+    expect (std::all_of (workerIds.begin(), workerIds.end(), [&] (auto id) { return id == jobThreadId; }),
+            "A background job's parallel work should stay on its low-priority thread");
+}
+
 void testGainStagingCalculation()
 {
     // File at 0.3 amplitude → peak ≈ -10.46 dB
@@ -780,48 +1219,403 @@ void testGainStagingCalculation()
 
 // ── Stem Separation Logic Test ────────────────────────────────────────────
 
-void testExponentialSmoothingSeparation()
+std::vector<float> readMonoWav (const juce::File& file)
 {
-    // Mix of low (100Hz) and high (4000Hz) sine waves
-    int numSamples = 44100;
-    std::vector<float> samples (numSamples);
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+    if (reader == nullptr)
+        return {};
+
+    juce::AudioBuffer<float> buffer (1, (int) reader->lengthInSamples);
+    reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, false);
+    return { buffer.getReadPointer (0), buffer.getReadPointer (0) + buffer.getNumSamples() };
+}
+
+double rmsOf (const std::vector<float>& samples, size_t start, size_t end)
+{
+    double sum = 0.0;
+    for (auto i = start; i < end; ++i)
+        sum += (double) samples[i] * (double) samples[i];
+
+    return end > start ? std::sqrt (sum / (double) (end - start)) : 0.0;
+}
+
+void testSpectralSeparationBandSplit()
+{
+    // 80 Hz + 4 kHz; the stems should divide them at the crossover and add
+    // back up to the source.
+    constexpr int numSamples = 44100 * 3;
+    std::vector<float> mix ((size_t) numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        mix[(size_t) i] = 0.4f * (float) std::sin (2.0 * juce::MathConstants<double>::pi * 80.0 * i / 44100.0)
+                        + 0.4f * (float) std::sin (2.0 * juce::MathConstants<double>::pi * 4000.0 * i / 44100.0);
+
+    auto source = writeTestWav ("separation_bands.wav", mix.data(), numSamples);
+    const std::array<juce::File, 2> stems { getTempDir().getChildFile ("bands_low.wav"),
+                                            getTempDir().getChildFile ("bands_high.wav") };
+
+    waive::SeparationSettings settings;
+    settings.crossoverHz = 500.0;
+    expect (waive::separateStems (source, {}, stems, settings).wasOk(), "Band split should succeed");
+
+    const auto low = readMonoWav (stems[0]);
+    const auto high = readMonoWav (stems[1]);
+    expect (low.size() == (size_t) numSamples && high.size() == (size_t) numSamples,
+            "Stems should match the source length");
+
+    double maxError = 0.0;
+    for (size_t i = 0; i < mix.size(); ++i)
+        maxError = std::max (maxError, (double) std::abs (low[i] + high[i] - mix[i]));
+    expect (maxError < 1.0e-3, "Stems should sum back to the source, max error " + std::to_string (maxError));
+
+    // A lone 80 Hz sine at 0.4 has an RMS of about 0.28.
+    expectApprox (rmsOf (low, 4410, 4410 * 20), 0.283, 0.03, "Low stem should hold the 80 Hz tone");
+    expectApprox (rmsOf (high, 4410, 4410 * 20), 0.283, 0.03, "High stem should hold the 4 kHz tone");
+
+    // Only the part a clip plays is separated.
+    expect (waive::separateStems (source, { 1.0, 0.5, 1.0 }, stems, settings).wasOk(), "Range split should succeed");
+    expect (readMonoWav (stems[0]).size() == 22050, "Range stems should cover only the clip");
+
+    expect (! waive::separateStems (source, {}, stems, settings, [] { return true; }).wasOk(),
+            "Cancelled separation should fail");
+    expect (! stems[0].exists() && ! stems[1].exists(), "Cancelled separation should delete its stem files");
+}
+
+void testSpectralSeparationHarmonicPercussive()
+{
+    // A steady 440 Hz tone with a broadband click every half second.
+    constexpr int numSamples = 44100 * 3;
+    std::vector<float> mix ((size_t) numSamples);
+    juce::Random random (7);
+    for (int i = 0; i < numSamples; ++i)
+        mix[(size_t) i] = 0.2f * (float) std::sin (2.0 * juce::MathConstants<double>::pi * 440.0 * i / 44100.0);
+
+    for (int click = 22050; click < numSamples; click += 22050)
+        for (int i = 0; i < 64; ++i)
+            mix[(size_t) (click + i)] += 0.7f * (random.nextFloat() * 2.0f - 1.0f);
+
+    auto source = writeTestWav ("separation_hpss.wav", mix.data(), numSamples);
+    const std::array<juce::File, 2> stems { getTempDir().getChildFile ("hpss_harmonic.wav"),
+                                            getTempDir().getChildFile ("hpss_percussive.wav") };
+
+    waive::SeparationSettings settings;
+    settings.method = waive::SeparationMethod::harmonicPercussive;
+    expect (waive::getStemNames (settings.method)[1] == "percussive", "HPSS stems should be named");
+    expect (waive::separateStems (source, {}, stems, settings).wasOk(), "HPSS should succeed");
+
+    const auto harmonic = readMonoWav (stems[0]);
+    const auto percussive = readMonoWav (stems[1]);
+    expect (harmonic.size() == (size_t) numSamples && percussive.size() == (size_t) numSamples,
+            "Stems should match the source length");
+
+    // Between clicks the tone belongs to the harmonic stem; at a click the
+    // percussive stem carries most of the energy.
+    const auto quietStart = (size_t) (22050 + 8000);
+    const auto quietEnd = (size_t) (22050 + 14000);
+    expect (rmsOf (harmonic, quietStart, quietEnd) > 4.0 * rmsOf (percussive, quietStart, quietEnd),
+            "Steady tone should land in the harmonic stem");
+    expect (rmsOf (percussive, 44100, 44100 + 64) > 2.0 * rmsOf (harmonic, 44100, 44100 + 64),
+            "Clicks should land in the percussive stem");
+}
+
+// ── Feature Extraction Tests ──────────────────────────────────────────────
+
+void testStreamingStftFrames()
+{
+    // A sine centred on bin 32, pushed in blocks that don't line up with
+    // the hop, should give one frame per hop with its peak in bin 32.
+    waive::StreamingStft stft (11, 512);
+    expect (stft.getFrameSize() == 2048 && stft.getNumBins() == 1025, "STFT size should follow the order");
+
+    constexpr int numSamples = 4096;
+    std::vector<float> signal ((size_t) numSamples);
     for (int i = 0; i < numSamples; ++i)
+        signal[(size_t) i] = (float) std::sin (2.0 * juce::MathConstants<double>::pi * 32.0 * i / 2048.0);
+
+    int numFrames = 0;
+    bool peaksAtBin = true;
+    const waive::StreamingStft::FrameCallback onFrame = [&] (const float*, const std::complex<float>* bins)
     {
-        float t = (float) i / 44100.0f;
-        float low = 0.4f * std::sin (2.0f * juce::MathConstants<float>::pi * 100.0f * t);
-        float high = 0.3f * std::sin (2.0f * juce::MathConstants<float>::pi * 4000.0f * t);
-        samples[i] = low + high;
+        int peakBin = 0;
+        for (int bin = 1; bin < 1025; ++bin)
+            if (std::abs (bins[bin]) > std::abs (bins[peakBin]))
+                peakBin = bin;
+
+        peaksAtBin = peaksAtBin && peakBin == 32;
+        ++numFrames;
+    };
+
+    for (int position = 0; position < numSamples; position += 333)
+        stft.push (signal.data() + position, std::min (333, numSamples - position), onFrame);
+
+    expect (numFrames == 5, "Expected 5 frames, got " + std::to_string (numFrames));
+    expect (peaksAtBin, "Every frame should peak at the sine's bin");
+
+    // The same plan is handed out for the same order, but only on one thread.
+    const auto* plan = &waive::getThreadLocalFft (11);
+    expect (plan == &waive::getThreadLocalFft (11), "FFT plans should be cached");
+    const juce::dsp::FFT* otherThreadPlan = nullptr;
+    std::thread ([&] { otherThreadPlan = &waive::getThreadLocalFft (11); }).join();
+    expect (otherThreadPlan != plan, "Each thread should get its own FFT plan");
+
+    // A 440 Hz magnitude spectrum lands in pitch class A.
+    const auto chroma = waive::SpectralFilterbank::chroma (2048, 44100.0);
+    std::vector<float> spectrum (1025, 0.0f);
+    spectrum[(size_t) std::lround (440.0 * 2048.0 / 44100.0)] = 1.0f;
+    std::array<float, 12> pitchClasses {};
+    chroma.apply (spectrum.data(), pitchClasses.data());
+    const auto peakClass = std::max_element (pitchClasses.begin(), pitchClasses.end()) - pitchClasses.begin();
+    expect (peakClass == 9, "440 Hz should map to A, got pitch class " + std::to_string (peakClass));
+}
+
+void testExtractFeatures()
+{
+    // One second of silence, then one second of a 440 Hz sine at 0.5.
+    constexpr int numSamples = 44100 * 2;
+    std::vector<float> samples ((size_t) numSamples, 0.0f);
+    for (int i = 44100; i < numSamples; ++i)
+        samples[(size_t) i] = 0.5f * (float) std::sin (2.0 * juce::MathConstants<double>::pi * 440.0 * i / 44100.0);
+
+    auto source = writeTestWav ("features_tone.wav", samples.data(), numSamples);
+
+    waive::FeatureSettings settings;
+    settings.computeMel = true;
+    settings.computeChroma = true;
+    settings.computeLoudness = true;
+
+    const auto features = waive::extractFeatures (source, {}, settings);
+    expect (features.valid, "Feature extraction should succeed");
+    expect (features.getNumFrames() == numSamples / 512 + 1,
+            "Expected one centred frame per hop, got " + std::to_string (features.getNumFrames()));
+    expect (features.onsetStrength.size() == (size_t) features.getNumFrames(), "Onsets should have one value per frame");
+    expect (features.mel.size() == (size_t) (features.getNumFrames() * 40), "Mel should have 40 bands per frame");
+    expect (features.chroma.size() == (size_t) (features.getNumFrames() * 12), "Chroma should have 12 values per frame");
+
+    const auto onsetFrame = (int) (std::max_element (features.onsetStrength.begin(), features.onsetStrength.end())
+                                   - features.onsetStrength.begin());
+    expectApprox (features.frameToClipSeconds (onsetFrame), 1.0, 0.03, "Onset should peak where the tone starts");
+
+    expectApprox (features.rms[10], 0.0, 1.0e-6, "Silent frames should have no level");
+    expectApprox (features.rms[150], 0.5 / std::sqrt (2.0), 0.01, "Tone frames should have the sine's RMS");
+
+    const auto* toneChroma = features.chroma.data() + 150 * 12;
+    expect (std::max_element (toneChroma, toneChroma + 12) - toneChroma == 9, "Tone chroma should peak at A");
+
+    // A 0.5 sine in one channel measures about -9 LUFS.
+    expect (! features.momentaryLufs.empty(), "Loudness frames should be produced");
+    expectApprox (features.momentaryLufs.back(), -9.0, 1.0, "Momentary loudness of the tone");
+
+    // Only the clip's range is analysed.
+    const auto ranged = waive::extractFeatures (source, { 1.0, 0.5, 1.0 }, settings);
+    expect (ranged.getNumFrames() == 22050 / 512 + 1, "Range features should cover only the clip");
+
+    const auto cancelled = waive::extractFeatures (source, {}, settings, [] { return true; });
+    expect (cancelled.cancelled && ! cancelled.valid, "Cancelled extraction should report it");
+}
+
+void testTempoDetectionClickTrain()
+{
+    // Decaying noise bursts every 0.6 s (100 BPM) from 1 s to 11 s.
+    constexpr int numSamples = 44100 * 12;
+    std::vector<float> samples ((size_t) numSamples, 0.0f);
+    juce::Random random (3);
+    for (double beat = 1.0; beat < 11.0; beat += 0.6)
+    {
+        const auto start = (int) std::lround (beat * 44100.0);
+        for (int i = 0; i < 200; ++i)
+            samples[(size_t) (start + i)] = 0.8f * (random.nextFloat() * 2.0f - 1.0f) * std::exp (-(float) i / 50.0f);
     }
 
-    // Simulate the tool's exponential smoothing separation
-    float smoothing = 0.03f;
-    std::vector<float> lowOutput (numSamples);
-    std::vector<float> highOutput (numSamples);
-    float lowState = 0.0f;
+    auto source = writeTestWav ("tempo_clicks.wav", samples.data(), numSamples);
 
-    for (int i = 0; i < numSamples; ++i)
+    waive::FeatureSettings featureSettings;
+    featureSettings.fftOrder = 10;
+    waive::AudioAnalysisCache cache (4);
+    const auto features = waive::extractFeatures (source, {}, featureSettings, {}, &cache);
+    expect (features.valid, "Onset extraction should succeed");
+    expect (cache.getFeatures ({ source, {}, featureSettings }).has_value(), "Onsets should be cached");
+
+    waive::TempoSettings tempoSettings;
+    const auto strength = waive::computeTempoStrength (features.onsetStrength, features.getFrameRate(), tempoSettings);
+    const auto bpm = waive::pickTempo (strength, tempoSettings);
+    expectApprox (bpm, 100.0, 0.5, "Tempo of the click train");
+
+    const auto beats = waive::trackBeats (features.onsetStrength, features.getFrameRate(), bpm, tempoSettings);
+    expect (beats.size() >= 16 && beats.size() <= 18, "Expected a beat per click, got " + std::to_string (beats.size()));
+    expectApprox (features.frameToClipSeconds (beats.front()), 1.0, 0.03, "First beat should land on the first click");
+
+    for (size_t i = 1; i < beats.size(); ++i)
+        expectApprox (features.frameToClipSeconds (beats[i]) - features.frameToClipSeconds (beats[i - 1]), 0.6, 0.03,
+                      "Beats should be one period apart");
+}
+
+// ── Sample Library Index Tests ────────────────────────────────────────────
+
+void testSampleLibraryIndex()
+{
+    auto libraryDir = getUniqueFixtureDir ("sample_library");
+    auto databaseFile = getUniqueFixtureDir ("sample_library_db").getChildFile ("sample_index.db");
+
+    auto placeInLibrary = [&] (const juce::File& written, const juce::String& relativePath)
     {
-        lowState += (samples[i] - lowState) * smoothing;
-        lowOutput[i] = lowState;
-        highOutput[i] = samples[i] - lowState;
+        auto target = libraryDir.getChildFile (relativePath);
+        target.getParentDirectory().createDirectory();
+        expect (written.moveFileTo (target), "Expected fixture move to succeed: " + relativePath.toStdString());
+        return target;
+    };
+
+    auto kick = placeInLibrary (generateSineWav ("library_kick.wav", 60.0, 0.5f, 0.5), "Drums/Kick_Hard.wav");
+    auto snare = placeInLibrary (generateSineWav ("library_snare.wav", 200.0, 0.25f, 0.5), "Drums/Snare 01.wav");
+    writeTextFile (libraryDir.getChildFile ("Drums/readme.txt"), "not audio");
+
+    // Decaying noise bursts at 100 BPM, long enough for a tempo estimate.
+    constexpr int loopSamples = 44100 * 8;
+    std::vector<float> loop ((size_t) loopSamples, 0.0f);
+    juce::Random random (5);
+    for (double beat = 0.5; beat < 7.5; beat += 0.6)
+    {
+        const auto start = (int) std::lround (beat * 44100.0);
+        for (int i = 0; i < 200; ++i)
+            loop[(size_t) (start + i)] = 0.8f * (random.nextFloat() * 2.0f - 1.0f) * std::exp (-(float) i / 50.0f);
     }
+    placeInLibrary (writeTestWav ("library_loop.wav", loop.data(), loopSamples), "Loops/Beat_Loop.wav");
+
+    waive::SampleLibraryScanOptions options;
+    options.detectTempoAndKey = true;
 
-    // Low output should have more energy at 100Hz
-    // High output should have more energy at 4000Hz
-    // Check RMS — low output should not be silent
-    float lowRms = 0.0f, highRms = 0.0f;
-    for (int i = 0; i < numSamples; ++i)
     {
-        lowRms += lowOutput[i] * lowOutput[i];
-        highRms += highOutput[i] * highOutput[i];
+        waive::SampleLibraryIndex index (databaseFile);
+        index.addRoot (libraryDir);
+        index.setScanOptions (options);
+
+        const auto stats = index.rescan();
+        expect (stats.filesSeen == 3 && stats.filesRead == 3 && ! stats.cancelled,
+                "A first scan should read every audio file and skip the rest");
+        expect (index.getNumEntries() == 3, "Every audio file should be indexed");
+
+        const auto kicks = index.search ("kick");
+        expect (kicks.size() == 1 && kicks.front().getFile() == kick, "Name search should find the kick");
+        const auto& entry = kicks.front();
+        expect (entry.readable && entry.numChannels == 1 && entry.sampleRate == 44100.0, "Header fields should be recorded");
+        expectApprox (entry.durationSeconds, 0.5, 1.0e-3, "Duration should be recorded");
+        expect (entry.hasLevels, "Levels should be measured");
+        expectApprox (entry.peakDb, -6.02, 0.2, "Peak level of the kick");
+        expect (entry.tempoBpm == 0.0, "A one-shot should not get a tempo");
+
+        expect (index.search ("dru").size() == 2, "Prefixes should match folder names");
+        expect (index.search ("drums snare").size() == 1, "Terms should all have to match");
+        expect (index.search ("snare 01").size() == 1, "Digits should be their own token");
+        expect (index.search ("kick snare").empty(), "Terms from different files should not match");
+        expect (index.search ("readme").empty(), "Non-audio files should not be indexed");
+
+        const auto loops = index.search ("bpm:98-102");
+        expect (loops.size() == 1 && loops.front().getFile().getFileName() == "Beat_Loop.wav",
+                "The tempo filter should find the loop");
+        expectApprox (loops.front().tempoBpm, 100.0, 1.0, "Tempo of the loop");
+        expect (index.search ("beat bpm:120").empty(), "The tempo filter should exclude other tempos");
+
+        const auto cancelled = index.rescan ([] { return true; });
+        expect (cancelled.cancelled && index.getNumEntries() == 3, "A cancelled scan should keep the existing entries");
     }
-    lowRms = std::sqrt (lowRms / numSamples);
-    highRms = std::sqrt (highRms / numSamples);
 
-    expect (lowRms > 0.01f, "Low stem should have energy");
-    expect (highRms > 0.01f, "High stem should have energy");
-    // Low stem should have more energy than high stem (100Hz is lower)
-    expect (lowRms > highRms * 0.5f, "Low stem should capture substantial energy from 100Hz content");
+    // The database survives a restart, and an unchanged library costs no reads.
+    waive::SampleLibraryIndex reloaded (databaseFile);
+    expect (reloaded.getNumEntries() == 3, "Entries should load from the database");
+    expect (reloaded.getRoots().size() == 1 && reloaded.getRoots().getFirst() == libraryDir, "Roots should load");
+    expectApprox (reloaded.search ("beat").front().tempoBpm, 100.0, 1.0, "Analysed tempo should load");
+
+    reloaded.setScanOptions (options);
+    expect (reloaded.rescan().filesRead == 0, "An unchanged library should not be read again");
+
+    juce::Thread::sleep (20);
+    expect (generateSineWav ("library_kick.wav", 60.0, 0.25f, 0.5).moveFileTo (kick), "Expected kick rewrite");
+    expect (reloaded.rescan().filesRead == 1, "Only the changed file should be read");
+    expectApprox (reloaded.search ("kick").front().peakDb, -12.04, 0.2, "The changed file should be measured again");
+
+    expect (snare.deleteFile(), "Expected snare delete");
+    const auto afterDelete = reloaded.rescan();
+    expect (afterDelete.filesRemoved == 1 && reloaded.getNumEntries() == 2, "Deleted files should leave the index");
+
+    reloaded.startBackgroundScan();
+    expect (reloaded.waitForScanForTesting() && reloaded.getNumEntries() == 2, "A background scan should finish");
+
+    // Key filters match the tonic, and the mode when given.
+    auto makeEntry = [] (const juce::String& path, const juce::String& key)
+    {
+        waive::SampleLibraryEntry entry;
+        entry.path = path;
+        entry.readable = true;
+        entry.key = key;
+        return entry;
+    };
+
+    waive::SampleLibraryIndex keyed (getUniqueFixtureDir ("sample_library_keys").getChildFile ("sample_index.db"));
+    const auto root = libraryDir.getFullPathName();
+    keyed.setEntries ({ makeEntry (root + "/pad_a.wav", "A minor"),
+                        makeEntry (root + "/pad_c.wav", "C major"),
+                        makeEntry (root + "/pad_cs.wav", "C# minor") });
+    expect (keyed.search ("key:am").size() == 1, "key:am should only match A minor");
+    expect (keyed.search ("key:c").size() == 1, "key:c should not match C#");
+    expect (keyed.search ("pad key:db").size() == 1, "Flats should match their enharmonic sharps");
+    expect (keyed.search ("pad key:cmaj").size() == 1, "The mode should filter when given");
+}
+
+void testSamplePreviewPlayer()
+{
+    // One second of silence, then one second of tone.
+    auto file = generateSilenceContentSilenceWav ("preview_test.wav", 1.0, 1.0, 0.0, 0.5f);
+
+    juce::AudioDeviceManager deviceManager;
+    waive::SamplePreviewPlayer player (deviceManager);
+    auto& source = player.getAudioSourceForTesting();
+    source.prepareToPlay (512, 44100.0);
+
+    juce::AudioBuffer<float> buffer (2, 512);
+    auto pullBlock = [&]
+    {
+        juce::AudioSourceChannelInfo info (buffer);
+        source.getNextAudioBlock (info);
+        return buffer.getMagnitude (0, 0, buffer.getNumSamples());
+    };
+
+    // The read-ahead thread fills the buffer behind the audio callback, so an
+    // audible block may take a few pulls after a start or a seek.
+    auto pullUntilAudible = [&]
+    {
+        for (int i = 0; i < 500; ++i)
+        {
+            if (pullBlock() > 0.1f)
+                return true;
+
+            juce::Thread::sleep (1);
+        }
+
+        return false;
+    };
+
+    expect (player.preview (getTempDir().getChildFile ("missing_preview.wav")).failed(),
+            "Previewing a missing file should fail");
+
+    expect (player.preview (file).wasOk() && player.isPlaying(), "Preview should start");
+    expect (player.getFile() == file, "The previewed file should be loaded");
+    expectApprox (player.getLengthSeconds(), 2.0, 1.0e-3, "Preview length");
+
+    for (int i = 0; i < 20; ++i)
+        expect (pullBlock() == 0.0f, "The silent first second should play silent");
+
+    player.setPosition (1.25);
+    expect (pullUntilAudible(), "Scrubbing into the tone should become audible");
+    expect (player.getPosition() > 1.25 && player.getPosition() < 2.0, "Playback should continue from the scrub position");
+
+    // Previewing the loaded file again reuses its reader and restarts from the given point.
+    expect (player.preview (file, 0.0).wasOk() && player.getPosition() < 0.1, "Re-preview should restart");
+
+    player.stop();
+    expect (! player.isPlaying(), "Stop should end the preview");
+    expect (pullBlock() == 0.0f, "A stopped preview should be silent");
+
+    source.releaseResources();
 }
 
 // ── Rename Tracks Logic Test ──────────────────────────────────────────────
@@ -948,6 +1742,10 @@ int main()
         runTest ("Transient detection (multiple clicks)", testAnalysisTransientDetectionMultipleClicks);
         runTest ("Analysis cancellation", testAnalysisCancellation);
         runTest ("Analysis caching", testAnalysisCaching);
+        runTest ("Clip range analysis", testAnalysisClipRange);
+        runTest ("Analysis caching per range", testAnalysisCachingPerRange);
+        runTest ("Analysis levels and loudness", testAnalysisLevelsAndLoudness);
+        runTest ("Tool analysis store", testToolAnalysisStore);
 
         std::cout << "\n=== Tool Registration Tests ===" << std::endl;
         runTest ("Tool registry completeness", testToolRegistryCompleteness);
@@ -958,6 +1756,7 @@ int main()
         runTest ("External tool manifest legacy command", testExternalToolManifestSupportsLegacyCommandArray);
         runTest ("External tool runner relative args", testExternalToolRunnerResolvesRelativeArgumentsWithoutChangingCwd);
         runTest ("External tool runner relative future args", testExternalToolRunnerResolvesRelativeArgumentsForCreatedPaths);
+        runTest ("External tool runner input loudness opt-in", testExternalToolRunnerMeasuresInputLoudnessOnlyWhenAsked);
         runTest ("External tool runner failure output", testExternalToolRunnerPreservesFailureOutput);
         runTest ("External tool runner missing success result", testExternalToolRunnerRequiresStructuredSuccessOrAudioOutput);
         runTest ("External tool runner structured failure message", testExternalToolRunnerReportsStructuredFailureWithoutFalseSuccessMessage);
@@ -967,9 +1766,21 @@ int main()
         runTest ("Normalization gain calculation", testNormalizationGainCalculation);
         runTest ("Silence detection regions", testSilenceDetectionRegions);
         runTest ("Silence detection quiet content", testSilenceDetectionWithQuietContent);
+        runTest ("Silence detection interior regions", testSilenceDetectionInteriorRegions);
         runTest ("Transient alignment calculation", testTransientAlignmentCalculation);
+        runTest ("Cross-correlation sample offset", testCrossCorrelationFindsSampleOffset);
+        runTest ("Parallel item processing", testRunInParallelVisitsEveryItem);
+        runTest ("Background jobs do not block normal jobs", testBackgroundJobsDoNotBlockNormalJobs);
+    runTest ("Promoted background job leaves the background queue", testPromotedBackgroundJobLeavesTheBackgroundQueue);
+    runTest ("Background job runs parallel work on its own thread", testBackgroundJobRunsParallelWorkOnItsOwnThread);
         runTest ("Gain staging calculation", testGainStagingCalculation);
-        runTest ("Stem separation smoothing", testExponentialSmoothingSeparation);
+        runTest ("Spectral separation band split", testSpectralSeparationBandSplit);
+        runTest ("Spectral separation HPSS", testSpectralSeparationHarmonicPercussive);
+        runTest ("Streaming STFT frames", testStreamingStftFrames);
+        runTest ("Feature extraction", testExtractFeatures);
+        runTest ("Tempo detection click train", testTempoDetectionClickTrain);
+        runTest ("Sample library index", testSampleLibraryIndex);
+        runTest ("Sample preview player", testSamplePreviewPlayer);
         runTest ("Rename track sanitization", [&] { testRenameLogicSanitization (edit); });
 
         std::cout << "\n=== Edge Cases ===" << std::endl;
@@ -16,10 +16,12 @@
 #include "LibraryComponent.h"
 #include "PluginBrowserComponent.h"
 #include "RenderDialog.h"
+#include "RenderScheduler.h"
 #include "PianoRollComponent.h"
 #include "EditSession.h"
 #include "ProjectManager.h"
 #include "AutoSaveManager.h"
+#include "ProjectFileFormat.h"
 #include "UndoableCommandHandler.h"
 #include "JobQueue.h"
 #include "CommandHandler.h"
@@ -30,6 +32,7 @@
 #include "AudioAnalysis.h"
 #include "AudioAnalysisCache.h"
 #include "WaiveLookAndFeel.h"
+#include "WaiveSpacing.h"
 
 #include <cmath>
 #include <cstdlib>
@@ -542,6 +545,7 @@ void runUiProjectLifecycleRegression()
 
     expect (mainComponent.invokeCommandForTesting (MainComponent::cmdSave),
             "Expected save command to execute");
+    expect (projectManager.waitForPendingSaves (10000), "Expected background save command to finish");
     expect (! projectManager.isDirty(), "Expected save command to clear dirty state");
     expect (projectFile.existsAsFile(), "Expected save command to write the project file");
 
@@ -1217,6 +1221,197 @@ void runSaveAsFailurePreservesCurrentProjectStateRegression()
     (void) originalProjectFile.deleteFile();
 }
 
+void runBinaryProjectSaveAsAndRecoveryRegression()
+{
+    using Format = waive::ProjectFileFormat::Format;
+
+    te::Engine engine ("WaiveUiBinaryProjectTests");
+    engine.getPluginManager().initialise();
+
+    EditSession session (engine);
+    ProjectManager projectManager (session);
+
+    auto xmlProjectFile = createLifecycleFixtureProject (engine);
+    expect (projectManager.openProject (xmlProjectFile), "Expected binary-project fixture to open");
+
+    auto binaryProjectFile = xmlProjectFile.withFileExtension ("waiveproject");
+    (void) binaryProjectFile.deleteFile();
+
+    expect (projectManager.saveAs (binaryProjectFile), "Expected Save As .waiveproject to succeed");
+    expect (projectManager.getCurrentFile() == binaryProjectFile, "Expected Save As to switch to the binary project");
+    expect (! projectManager.isDirty(), "Expected binary Save As to clear dirty state");
+    expect (waive::ProjectFileFormat::detectFormat (binaryProjectFile) == Format::compressedBinary,
+            "Expected .waiveproject to be written as compressed binary by default");
+    expect (te::EditFileOperations (session.getEdit()).getEditFile() == binaryProjectFile,
+            "Expected binary Save As to rebind the live edit backing file");
+
+    expect (session.performEdit ("Binary Project Add Clip", [&] (te::Edit& edit)
+    {
+        if (auto* track = getFirstTrack (edit))
+            track->insertMIDIClip ("binary_project_clip",
+                                   te::TimeRange (te::TimePosition::fromSeconds (1.0),
+                                                  te::TimePosition::fromSeconds (2.0)),
+                                   nullptr);
+    }), "Expected binary project mutation to succeed");
+    expect (projectManager.isDirty(), "Expected mutation to dirty the binary project");
+
+    const bool previousCompression = projectManager.shouldCompressBinaryProjects();
+    projectManager.setCompressBinaryProjects (false);
+    expect (projectManager.save(), "Expected save of binary project to succeed");
+    projectManager.setCompressBinaryProjects (previousCompression);
+    expect (! projectManager.isDirty(), "Expected binary save to clear dirty state");
+    expect (waive::ProjectFileFormat::detectFormat (binaryProjectFile) == Format::binary,
+            "Expected uncompressed binary save when compression is off");
+
+    // Autosaves follow the project's format and are recovered by content.
+    auto autoSaveFile = AutoSaveManager::getAutoSaveFileForProject (binaryProjectFile);
+    expect (session.performEdit ("Binary Project Autosaved Clip", [&] (te::Edit& edit)
+    {
+        if (auto* track = getFirstTrack (edit))
+            track->insertMIDIClip ("binary_autosaved_clip",
+                                   te::TimeRange (te::TimePosition::fromSeconds (2.0),
+                                                  te::TimePosition::fromSeconds (3.0)),
+                                   nullptr);
+    }), "Expected binary autosave mutation to succeed");
+
+    {
+        AutoSaveManager autoSaveManager (session, projectManager, 1);
+        autoSaveManager.triggerAutoSaveForTesting();
+    }
+
+    expect (autoSaveFile.existsAsFile(), "Expected binary project autosave to be written");
+    expect (waive::ProjectFileFormat::detectFormat (autoSaveFile) != Format::xml,
+            "Expected binary project autosave to be binary");
+
+    session.resetChangedStatus();
+    expect (projectManager.recoverProjectFromAutoSave (autoSaveFile, binaryProjectFile),
+            "Expected binary autosave recovery to succeed");
+    auto* recoveredTrack = getFirstTrack (session.getEdit());
+    expect (recoveredTrack != nullptr && getClipCount (*recoveredTrack) == 3,
+            "Expected binary autosave recovery to restore the autosaved clip");
+    expect (projectManager.isDirty(), "Expected recovered binary project to stay dirty until saved");
+
+    expect (projectManager.save(), "Expected save after binary recovery to succeed");
+    expect (! autoSaveFile.existsAsFile(), "Expected binary save to clear the autosave");
+
+    expect (projectManager.newProject(), "Expected new project after binary save");
+    expect (projectManager.openProject (binaryProjectFile), "Expected binary project to reopen");
+    expect (! projectManager.isDirty(), "Expected reopened binary project to start clean");
+    auto* reopenedTrack = getFirstTrack (session.getEdit());
+    expect (reopenedTrack != nullptr && getClipCount (*reopenedTrack) == 3,
+            "Expected reopened binary project to keep every clip");
+
+    projectManager.clearRecentFiles();
+    (void) binaryProjectFile.deleteFile();
+    (void) xmlProjectFile.deleteFile();
+}
+
+void runBackgroundSaveRegression()
+{
+    te::Engine engine ("WaiveUiBackgroundSaveTests");
+    engine.getPluginManager().initialise();
+
+    // Opening a project adds it to the recent files; keep the app's list untouched.
+    auto settingsOptions = ProjectManager::getDefaultSettingsOptions();
+    settingsOptions.applicationName = "WaiveUiBackgroundSaveTest";
+    settingsOptions.folderName = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                     .getChildFile ("waive_background_save_settings")
+                                     .getFullPathName();
+
+    EditSession session (engine);
+    ProjectManager projectManager (session, settingsOptions);
+
+    struct SaveListener final : ProjectManager::Listener
+    {
+        void projectDirtyChanged() override {}
+        void projectSaveStarted (const juce::File&) override                 { ++started; }
+        void projectSaveProgress (const juce::File&, float progress) override { lastProgress = progress; }
+        void projectSaveFinished (const juce::File&, const juce::Result& result) override
+        {
+            ++finished;
+            lastResult = result;
+        }
+
+        int started = 0;
+        int finished = 0;
+        float lastProgress = -1.0f;
+        juce::Result lastResult { juce::Result::ok() };
+    } listener;
+
+    projectManager.addListener (&listener);
+
+    auto projectFile = createLifecycleFixtureProject (engine);
+    expect (projectManager.openProject (projectFile), "Expected background-save fixture project to open");
+
+    auto addClip = [&] (const juce::String& name, double startSeconds)
+    {
+        return session.performEdit ("Background Save " + name, [&] (te::Edit& edit)
+        {
+            if (auto* track = getFirstTrack (edit))
+                track->insertMIDIClip (name,
+                                       te::TimeRange (te::TimePosition::fromSeconds (startSeconds),
+                                                      te::TimePosition::fromSeconds (startSeconds + 1.0)),
+                                       nullptr);
+        });
+    };
+
+    expect (addClip ("saved_clip", 1.0), "Expected pre-save mutation to succeed");
+    expect (projectManager.saveInBackground(), "Expected background save to start");
+    expect (listener.started == 1, "Expected save start to be reported");
+
+    // Edits keep landing in the live edit while the snapshot is written.
+    expect (addClip ("unsaved_clip", 2.0), "Expected mutation during background save to succeed");
+
+    const auto deadline = juce::Time::getMillisecondCounter() + 10000;
+    while (projectManager.isSaving() && juce::Time::getMillisecondCounter() < deadline)
+        juce::MessageManager::getInstance()->runDispatchLoopUntil (10);
+
+    expect (! projectManager.isSaving(), "Expected background save to finish");
+    expect (listener.finished == 1 && listener.lastResult.wasOk(), "Expected a successful save to be reported");
+    expect (listener.lastProgress >= 0.0f && listener.lastProgress <= 1.0f, "Expected save progress to be reported");
+    expect (projectManager.isDirty(), "Expected the edit made during the save to leave the project dirty");
+
+    {
+        te::Engine verifyEngine ("WaiveUiBackgroundSaveVerify");
+        verifyEngine.getPluginManager().initialise();
+        auto savedEdit = te::loadEditFromFile (verifyEngine, projectFile);
+        auto* savedTrack = getFirstTrack (*savedEdit);
+        expect (savedTrack != nullptr && getClipCount (*savedTrack) == 2,
+                "Expected the background save to write the state from when it started");
+    }
+
+    session.undo();
+    expect (! projectManager.isDirty(), "Expected undoing the later edit to return to the saved state");
+    session.redo();
+
+    // Overlapping saves finish in order and the last one leaves the project clean.
+    expect (projectManager.saveInBackground(), "Expected first overlapping save to start");
+    expect (projectManager.saveInBackground(), "Expected second overlapping save to start");
+    expect (projectManager.waitForPendingSaves (10000), "Expected overlapping saves to finish");
+    expect (listener.finished == 3, "Expected every save to be reported");
+    expect (! projectManager.isDirty(), "Expected the last save to clear dirty state");
+    expect (te::EditFileOperations (session.getEdit()).getEditFile() == projectFile,
+            "Expected the live edit to stay backed by the project file");
+
+    // A failed write is reported and leaves the project dirty.
+    expect (addClip ("failed_clip", 3.0), "Expected mutation before failing save to succeed");
+    auto unwritableProject = projectFile.getParentDirectory()
+                                 .getNonexistentChildFile ("background_save_target_", "", false)
+                                 .getChildFile ("project.tracktionedit");
+    expect (unwritableProject.getParentDirectory().createDirectory().wasOk(), "Expected save-target folder fixture");
+    expect (projectManager.saveAs (unwritableProject), "Expected Save As into the fixture folder to succeed");
+    expect (addClip ("failed_clip_2", 4.0), "Expected mutation after Save As to succeed");
+    expect (unwritableProject.getParentDirectory().deleteRecursively(), "Expected save-target folder removal");
+
+    expect (projectManager.saveInBackground(), "Expected failing background save to start");
+    expect (projectManager.waitForPendingSaves (10000), "Expected failing background save to finish");
+    expect (listener.lastResult.failed(), "Expected the failed write to be reported");
+    expect (projectManager.isDirty(), "Expected a failed background save to leave the project dirty");
+
+    projectManager.removeListener (&listener);
+    (void) projectFile.deleteFile();
+}
+
 void runUndoRedoDirtyStateNotificationRegression()
 {
     struct EditStateListener final : EditSession::Listener
@@ -1579,7 +1774,16 @@ void runUiPhase1LibraryAndPhase2PluginRoutingRegression()
             "Expected library target track selector to retain the selected track");
     const auto clipCountBeforeImport = getClipCount (*track);
     const auto secondTrackClipCountBeforeImport = getClipCount (*secondTrack);
+    // Shared with the timeline, so double-click imports draw placeholders there
+    // and coalesce with dropped files.
+    auto& timelineImporter = mainComponent.getSessionComponentForTesting().getTimeline().getMediaImporter();
+    expect (&library.getMediaImporterForTesting() == &timelineImporter,
+            "Expected the library and timeline to share one media importer");
     library.fileDoubleClicked (fixtureAudio);
+    expect (! timelineImporter.getPlaceholders().empty(),
+            "Expected a library double-click to show a timeline placeholder");
+    expect (library.getMediaImporterForTesting().waitForImportsForTesting (5000),
+            "Expected library double-click import to finish");
 
     expect (getClipCount (*track) == clipCountBeforeImport,
             "Expected library double-click import to leave the first track unchanged");
@@ -2220,6 +2424,32 @@ void runUiPhase4ToolFrameworkRegression()
     expect (std::abs (audioClip->getGainDB() - gainBeforeCancel) < 0.05f,
             "Expected cancellation to leave edit state unchanged");
 
+    // RMS targets set the clip gain outright, so the gain a clip already has
+    // makes no difference, with or without the full-scale cap.
+    const auto planRmsGain = [&] (double targetRmsDb, float startingGainDb, bool expectPeakLimited)
+    {
+        auto* rmsParamsObj = new juce::DynamicObject();
+        rmsParamsObj->setProperty ("mode", "rms");
+        rmsParamsObj->setProperty ("target_rms_db", targetRmsDb);
+        rmsParamsObj->setProperty ("analysis_delay_ms", 0);
+        toolsComponent.setParamsForTesting (juce::var (rmsParamsObj));
+
+        audioClip->setGainDB (startingGainDb);
+        timeline.getSelectionManager().selectClip (insertedClip.get());
+        expect (toolsComponent.runPlanForTesting(), "Expected RMS plan start");
+        expect (toolsComponent.waitForIdleForTesting(), "Expected RMS plan completion");
+        expect (toolsComponent.getPreviewTextForTesting().contains ("peak-limited") == expectPeakLimited,
+                expectPeakLimited ? "Expected a 0 dB RMS target to be peak-limited"
+                                  : "Expected a -40 dB RMS target not to be peak-limited");
+        expect (toolsComponent.applyPlanForTesting(), "Expected RMS apply to succeed");
+        return audioClip->getGainDB();
+    };
+
+    expect (std::abs (planRmsGain (-40.0, 0.0f, false) - planRmsGain (-40.0, 6.0f, false)) < 0.05f,
+            "Expected an RMS target to ignore the clip's existing gain");
+    expect (std::abs (planRmsGain (0.0, 0.0f, true) - planRmsGain (0.0, 6.0f, true)) < 0.05f,
+            "Expected the peak cap to ignore the clip's existing gain");
+
     (void) fixtureAudio.deleteFile();
 }
 
@@ -2326,6 +2556,396 @@ void runToolSidebarEditSwapClearsPendingPlanRegression()
     std::cout << "runToolSidebarEditSwapClearsPendingPlanRegression: PASS" << std::endl;
 }
 
+void runToolSidebarSpeculativePlanRegression()
+{
+    te::Engine engine ("WaiveUiToolSidebarSpeculativePlan");
+    engine.getPluginManager().initialise();
+
+    EditSession session (engine);
+    waive::JobQueue jobQueue;
+    ProjectManager projectManager (session);
+    CommandHandler commandHandler (session.getEdit());
+    UndoableCommandHandler undoableHandler (commandHandler, session);
+
+    MainComponent mainComponent (undoableHandler, session, jobQueue, projectManager);
+    mainComponent.setBounds (0, 0, 1400, 900);
+    mainComponent.resized();
+
+    auto& sessionComponent = mainComponent.getSessionComponentForTesting();
+    auto& timeline = sessionComponent.getTimeline();
+    auto& toolsComponent = mainComponent.getToolSidebarForTesting();
+    auto& edit = session.getEdit();
+
+    auto* track = getFirstTrack (edit);
+    expect (track != nullptr, "Expected speculative-plan test track");
+
+    auto fixtureAudio = createPhase4FixtureAudioFile();
+    auto insertedClip = track->insertWaveClip (
+        "speculative_source",
+        fixtureAudio,
+        { { te::TimePosition::fromSeconds (0.0),
+            te::TimePosition::fromSeconds (1.0) },
+          te::TimeDuration() },
+        false);
+    expect (insertedClip != nullptr, "Expected speculative-plan wave clip insertion");
+
+    mainComponent.setVisible (true);
+    timeline.rebuildTracks();
+
+    // The tool shown by default was never chosen, so nothing is speculated.
+    timeline.getSelectionManager().selectClip (insertedClip.get());
+    expect (! toolsComponent.waitForSpeculativePlanForTesting (500),
+            "Expected no speculative plan before the user picks a tool");
+
+    timeline.getSelectionManager().deselectAll();
+    toolsComponent.selectToolForTesting ("normalize_selected_clips");
+    timeline.getSelectionManager().selectClip (insertedClip.get());
+
+    // Selecting a clip starts planning with the form's current parameters.
+    expect (toolsComponent.waitForSpeculativePlanForTesting(),
+            "Expected a speculative plan after selecting a clip");
+    expect (toolsComponent.runPlanForTesting(), "Expected Plan to adopt the speculative plan");
+    expect (toolsComponent.hasPendingPlanForTesting(),
+            "Expected an adopted speculative plan to be ready without waiting");
+
+    // Only adopted plans write an artifact; speculation that is thrown away leaves none.
+    const auto adoptedArtifact = toolsComponent.getLastPlanArtifactForTesting();
+    expect (adoptedArtifact.existsAsFile(), "Expected the adopted plan to write its artifact");
+    const auto artifactDir = adoptedArtifact.getParentDirectory();
+    const auto countPlanArtifacts = [&artifactDir]
+    {
+        return artifactDir.getNumberOfChildFiles (juce::File::findFiles, "plan_*.json");
+    };
+    const auto artifactsAfterAdoption = countPlanArtifacts();
+
+    // A selection change discards it; different parameters make Plan start afresh.
+    toolsComponent.rejectPlanForTesting();
+    timeline.getSelectionManager().deselectAll();
+    timeline.getSelectionManager().selectClip (insertedClip.get());
+    expect (toolsComponent.waitForSpeculativePlanForTesting(),
+            "Expected the new selection to be planned speculatively");
+    expect (countPlanArtifacts() == artifactsAfterAdoption,
+            "Expected a speculative plan not to write an artifact before adoption");
+
+    auto* paramsObj = new juce::DynamicObject();
+    paramsObj->setProperty ("target_peak_db", -6.0);
+    paramsObj->setProperty ("analysis_delay_ms", 0);
+    toolsComponent.setParamsForTesting (juce::var (paramsObj));
+
+    expect (toolsComponent.runPlanForTesting(), "Expected plan start with changed parameters");
+    expect (! toolsComponent.hasPendingPlanForTesting(),
+            "Expected changed parameters not to reuse the speculative plan");
+    expect (toolsComponent.waitForIdleForTesting(), "Expected plan completion with changed parameters");
+    expect (toolsComponent.getPreviewTextForTesting().contains ("-6.0 dBFS"),
+            "Expected the plan to use the changed target");
+    expect (countPlanArtifacts() == artifactsAfterAdoption + 1,
+            "Expected only the requested plan to add an artifact");
+
+    // Applying changes the edit, so the next speculative plan starts from the new state.
+    expect (toolsComponent.applyPlanForTesting(), "Expected apply to succeed");
+
+    // A hidden sidebar doesn't speculate.
+    sessionComponent.toggleToolSidebar();
+    timeline.getSelectionManager().deselectAll();
+    timeline.getSelectionManager().selectClip (insertedClip.get());
+    expect (! toolsComponent.waitForSpeculativePlanForTesting (500),
+            "Expected no speculative plan while the sidebar is hidden");
+    sessionComponent.toggleToolSidebar();
+
+    toolsComponent.setSpeculativePlanningEnabled (false);
+    timeline.getSelectionManager().selectClip (insertedClip.get());
+    expect (! toolsComponent.waitForSpeculativePlanForTesting (500),
+            "Expected no speculative plan while speculation is disabled");
+
+    (void) fixtureAudio.deleteFile();
+
+    std::cout << "runToolSidebarSpeculativePlanRegression: PASS" << std::endl;
+}
+
+void runTimelineRefreshesOnceAfterBulkEditRegression()
+{
+    te::Engine engine ("WaiveUiTimelineBulkEdit");
+    engine.getPluginManager().initialise();
+
+    EditSession session (engine);
+    waive::JobQueue jobQueue;
+    ProjectManager projectManager (session);
+    CommandHandler commandHandler (session.getEdit());
+    UndoableCommandHandler undoableHandler (commandHandler, session);
+
+    MainComponent mainComponent (undoableHandler, session, jobQueue, projectManager);
+    mainComponent.setBounds (0, 0, 1400, 900);
+    mainComponent.resized();
+
+    auto& timeline = mainComponent.getSessionComponentForTesting().getTimeline();
+    auto& edit = session.getEdit();
+
+    auto* track = getFirstTrack (edit);
+    expect (track != nullptr, "Expected bulk-edit test track");
+
+    auto fixtureAudio = createPhase4FixtureAudioFile();
+    auto insertedClip = track->insertWaveClip (
+        "bulk_source",
+        fixtureAudio,
+        { { te::TimePosition::fromSeconds (0.0),
+            te::TimePosition::fromSeconds (1.0) },
+          te::TimeDuration() },
+        false);
+    expect (insertedClip != nullptr, "Expected bulk-edit wave clip insertion");
+    timeline.rebuildTracks();
+
+    TrackLaneComponent* lane = nullptr;
+    for (auto* candidate : timeline.getTrackLaneComponentsForTesting())
+        if (candidate != nullptr && candidate->getAudioTrack() == track)
+            lane = candidate;
+
+    expect (lane != nullptr, "Expected a lane for the bulk-edit track");
+    expect (lane->getNumClipComponentsForTesting() == 1, "Expected one clip component before the bulk edit");
+
+    constexpr int numSplits = 20;
+    expect (session.performBulkEdit ("Bulk Split", [&] (te::Edit&)
+    {
+        // Split from the back so the original clip keeps the earliest piece.
+        for (int i = numSplits; i >= 1; --i)
+            track->splitClip (*insertedClip, te::TimePosition::fromSeconds ((double) i / (numSplits + 1)));
+    }), "Expected bulk split to succeed");
+
+    // No message-loop turn: the lane must already match the edit.
+    expect (track->getClips().size() == numSplits + 1, "Expected the bulk edit to split the clip");
+    expect (lane->getNumClipComponentsForTesting() == numSplits + 1,
+            "Expected the timeline to refresh its clips as soon as the bulk edit finished");
+
+    session.undo();
+    expect (track->getClips().size() == 1, "Expected one undo to restore the unsplit clip");
+
+    (void) fixtureAudio.deleteFile();
+
+    std::cout << "runTimelineRefreshesOnceAfterBulkEditRegression: PASS" << std::endl;
+}
+
+void runLibrarySearchPanelRegression()
+{
+    te::Engine engine ("WaiveUiLibrarySearch");
+    engine.getPluginManager().initialise();
+
+    EditSession session (engine);
+    waive::JobQueue jobQueue;
+    ProjectManager projectManager (session);
+    CommandHandler commandHandler (session.getEdit());
+    UndoableCommandHandler undoableHandler (commandHandler, session);
+
+    MainComponent mainComponent (undoableHandler, session, jobQueue, projectManager);
+    mainComponent.setBounds (0, 0, 1400, 900);
+    mainComponent.resized();
+
+    auto fixtureDir = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                          .getChildFile ("waive_ui_library_" + juce::Uuid().toString());
+    auto samplesDir = fixtureDir.getChildFile ("Samples");
+    samplesDir.createDirectory();
+
+    auto fixtureAudio = createPhase4FixtureAudioFile();
+    auto vocal = samplesDir.getChildFile ("Vocal_Take.wav");
+    expect (fixtureAudio.moveFileTo (vocal), "Expected library fixture audio");
+
+    auto& library = mainComponent.getLibraryComponentForTesting();
+    library.setIndexDatabaseForTesting (fixtureDir.getChildFile ("sample_index.db"));
+    auto& index = library.getIndexForTesting();
+    index.addRoot (samplesDir);
+    expect (index.rescan().filesRead == 1, "Expected the library scan to read the fixture");
+    drainPendingUiWork();
+
+    library.setSearchTextForTesting ("voc");
+    expect (library.isShowingSearchResultsForTesting(), "Expected search results in place of the file tree");
+    const auto results = library.getSearchResultsForTesting();
+    expect (results.size() == 1 && results.front().getFile() == vocal, "Expected the search to find the fixture");
+
+    // Results drag the path itself, since the tree's selection is not involved.
+    auto& timeline = mainComponent.getSessionComponentForTesting().getTimeline();
+    const juce::DragAndDropTarget::SourceDetails drag (juce::Array<juce::var> { "LibraryFile", vocal.getFullPathName() },
+                                                       nullptr,
+                                                       { waive::Spacing::trackHeaderWidth + 10,
+                                                         waive::Spacing::rulerHeight + 5 });
+    expect (timeline.isInterestedInDragSource (drag), "Expected the timeline to accept search result drags");
+
+    auto* track = getFirstTrack (session.getEdit());
+    expect (track != nullptr, "Expected library search test track");
+    const auto clipCountBeforeDrop = getClipCount (*track);
+    timeline.itemDropped (drag);
+    expect (timeline.getMediaImporter().waitForImportsForTesting (5000), "Expected the dropped result to import");
+    expect (getClipCount (*track) == clipCountBeforeDrop + 1, "Expected the dropped result to insert a clip");
+
+    // Auditioning leaves the edit alone.
+    library.selectPreviewFileForTesting (vocal);
+    expect (library.togglePreviewForTesting(), "Expected the preview to start");
+    expect (library.getPreviewPlayerForTesting().getFile() == vocal, "Expected the selected file to be previewed");
+    expect (getClipCount (*track) == clipCountBeforeDrop + 1, "Expected previewing not to add clips");
+    expect (! library.togglePreviewForTesting(), "Expected the preview to stop");
+
+    library.setSearchTextForTesting ("nothing_matches_this");
+    expect (library.getSearchResultsForTesting().empty(), "Expected no results for an unknown name");
+
+    library.setSearchTextForTesting ({});
+    expect (! library.isShowingSearchResultsForTesting(), "Expected the file tree back for an empty query");
+
+    (void) fixtureDir.deleteRecursively();
+
+    std::cout << "runLibrarySearchPanelRegression: PASS" << std::endl;
+}
+
+void runTimelineBulkImportRegression()
+{
+    te::Engine engine ("WaiveUiBulkImport");
+    engine.getPluginManager().initialise();
+
+    EditSession session (engine);
+    waive::JobQueue jobQueue;
+    ProjectManager projectManager (session);
+    CommandHandler commandHandler (session.getEdit());
+    UndoableCommandHandler undoableHandler (commandHandler, session);
+
+    MainComponent mainComponent (undoableHandler, session, jobQueue, projectManager);
+    mainComponent.setBounds (0, 0, 1400, 900);
+    mainComponent.resized();
+
+    auto& timeline = mainComponent.getSessionComponentForTesting().getTimeline();
+    auto& importer = timeline.getMediaImporter();
+    auto& library = mainComponent.getLibraryComponentForTesting();
+    timeline.setSnapEnabled (false);
+
+    // Options saved by an earlier run would change where the files land.
+    library.setImportOptionsForTesting ({});
+
+    struct Listener final : waive::MediaImporter::Listener
+    {
+        void importFinished (int numImported, const juce::StringArray& errors) override
+        {
+            ++finishedCount;
+            lastNumImported = numImported;
+            lastErrors = errors;
+        }
+
+        int finishedCount = 0;
+        int lastNumImported = 0;
+        juce::StringArray lastErrors;
+    } listener;
+
+    importer.addListener (&listener);
+
+    constexpr int numFiles = 12;
+    juce::Array<juce::var> description { "LibraryFile" };
+    juce::Array<juce::File> fixtures;
+    for (int i = 0; i < numFiles; ++i)
+    {
+        fixtures.add (createPhase4FixtureAudioFile());
+        description.add (fixtures.getLast().getFullPathName());
+    }
+
+    // Not audio, so its probe fails without holding up the rest.
+    auto unreadable = fixtures.getFirst().getSiblingFile ("waive_ui_not_audio.wav");
+    expect (unreadable.replaceWithText ("not audio"), "Expected unreadable fixture");
+    description.add (unreadable.getFullPathName());
+
+    auto* track = getFirstTrack (session.getEdit());
+    expect (track != nullptr, "Expected bulk import test track");
+    const auto clipCountBeforeDrop = getClipCount (*track);
+
+    timeline.itemDropped ({ description, nullptr, { timeline.timeToX (2.0), waive::Spacing::rulerHeight + 5 } });
+
+    // The drop returns before any file is read; what it queued shows as placeholders.
+    expect (getClipCount (*track) == clipCountBeforeDrop, "Expected the drop not to insert clips synchronously");
+    expect (importer.isImporting(), "Expected the drop to queue an import");
+    expect ((int) importer.getPlaceholders().size() >= numFiles, "Expected a placeholder per queued file");
+
+    expect (importer.waitForImportsForTesting (10000), "Expected the bulk import to finish");
+    expect (importer.getPlaceholders().empty(), "Expected no placeholders once the import finished");
+    expect (listener.finishedCount == 1 && listener.lastNumImported == numFiles,
+            "Expected one finish notification counting the imported files");
+    expect (listener.lastErrors.size() == 1 && listener.lastErrors[0].contains (unreadable.getFileName()),
+            "Expected the unreadable file to be reported");
+    expect (getClipCount (*track) == clipCountBeforeDrop + numFiles, "Expected a clip per readable file");
+
+    // Laid end to end from the drop position, in drop order.
+    for (int i = 0; i < numFiles; ++i)
+    {
+        auto* clip = findClipAtStart (*track, 2.0 + i);
+        expect (clip != nullptr && clip->getSourceFileReference().getFile() == fixtures[i],
+                "Expected imported clips end to end in drop order");
+    }
+
+    session.undo();
+    expect (getClipCount (*track) == clipCountBeforeDrop, "Expected one undo to remove the whole import");
+
+    // A saved project converts into its Audio folder.
+    auto projectDir = getRepoRoot().getChildFile ("build").getChildFile ("ui_test_projects")
+                                   .getChildFile ("waive_ui_import_" + juce::Uuid().toString());
+    expect (projectDir.createDirectory().wasOk(), "Expected import project folder");
+    auto projectFile = projectDir.getChildFile ("import.tracktionedit");
+    session.getEdit().editFileRetriever = [projectFile] { return projectFile; };
+
+    // Set through the library's options, which are saved for the next session.
+    waive::MediaImportOptions options;
+    options.copyIntoProject = true;
+    options.targetSampleRate = 48000.0;
+    library.setImportOptionsForTesting (options);
+    expect (importer.getOptions().copyIntoProject && importer.getOptions().targetSampleRate == 48000.0,
+            "Expected the library options to reach the shared importer");
+    {
+        LibraryComponent reloaded (session);
+        const auto& loaded = reloaded.getMediaImporterForTesting().getOptions();
+        expect (loaded.copyIntoProject && ! loaded.oneTrackPerFile && loaded.targetSampleRate == 48000.0,
+                "Expected a new library to load the saved import options");
+    }
+
+    importer.importFiles ({ fixtures.getFirst() }, 0, 30.0);
+    expect (importer.waitForImportsForTesting (10000), "Expected the converting import to finish");
+
+    auto* converted = findClipAtStart (*track, 30.0);
+    expect (converted != nullptr, "Expected the converted clip");
+    if (auto* waveClip = dynamic_cast<te::WaveAudioClip*> (converted))
+    {
+        const auto convertedFile = waveClip->getSourceFileReference().getFile();
+        expect (convertedFile.isAChildOf (projectDir.getChildFile ("Audio")),
+                "Expected the converted file in the project Audio folder");
+        expect (std::abs (te::AudioFile (engine, convertedFile).getInfo().sampleRate - 48000.0) < 1.0,
+                "Expected the converted file at the target rate");
+        expect (std::abs (converted->getPosition().getLength().inSeconds() - 1.0) < 0.01,
+                "Expected conversion to keep the clip length");
+
+        // The fixture is a 220 Hz sine from sample 0; the converted file should
+        // follow it from its first sample to its last, with no delay.
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (convertedFile));
+        expect (reader != nullptr, "Expected the converted file to open");
+
+        if (reader != nullptr)
+        {
+            const auto length = (int) reader->lengthInSamples;
+            juce::AudioBuffer<float> samples (1, length);
+            reader->read (&samples, 0, length, 0, true, false);
+
+            float maxError = 0.0f;
+            for (int i = 0; i < length - 300; ++i)
+            {
+                const auto expected = 0.25 * std::sin (2.0 * juce::MathConstants<double>::pi * 220.0 * (double) i / 48000.0);
+                maxError = juce::jmax (maxError, std::abs (samples.getSample (0, i) - (float) expected));
+            }
+
+            expect (maxError < 0.01f, "Expected the converted file in phase with the source");
+            expect (samples.getMagnitude (0, length - 200, 100) > 0.1f, "Expected the tail to be flushed into the file");
+        }
+    }
+
+    library.setImportOptionsForTesting ({});
+    importer.removeListener (&listener);
+    for (auto& fixture : fixtures)
+        (void) fixture.deleteFile();
+    (void) unreadable.deleteFile();
+    (void) projectDir.deleteRecursively();
+
+    std::cout << "runTimelineBulkImportRegression: PASS" << std::endl;
+}
+
 void runProjectScopedChatHistoryRegression()
 {
     te::Engine engine ("WaiveUiProjectScopedChatHistory");
@@ -2829,6 +3449,13 @@ void runUiPhase5BuiltInToolsRegression()
     expect (std::abs (trimClip->getPosition().getEnd().inSeconds() - trimEndAfter) < 0.05,
             "Expected silence-cut redo to restore trimmed end");
 
+    // A looped clip's file positions don't map to one place in the clip, so it is left alone.
+    trimClip->setLoopRange ({ te::TimePosition(), te::TimePosition::fromSeconds (0.5) });
+    expect (trimClip->isLooping(), "Expected the silence-cut clip to loop");
+    expect (! toolsComponent.runPlanForTesting() && toolsComponent.getStatusTextForTesting().containsIgnoreCase ("looped"),
+            "Expected silence-cut to refuse a looped clip");
+    trimClip->disableLooping();
+
     // 5A.4: Align clips by transient.
     toolsComponent.selectToolForTesting ("align_clips_by_transient");
     timeline.getSelectionManager().selectClip (lateClip.get());
@@ -2868,10 +3495,70 @@ void runUiPhase5BuiltInToolsRegression()
     expect (std::abs (lateClip->getPosition().getStart().inSeconds() - lateStartAfterAlign) < 0.05,
             "Expected transient-align redo to restore aligned late clip start");
 
+    // 5A.5: Detect tempo from a 100 BPM click track.
+    const auto clickTrackFile = createPhase5FixtureAudioFile (
+        "waive_ui_phase5_click_track_",
+        8.0,
+        [] (int i, double sampleRate) -> float
+        {
+            const auto beatSamples = (int) std::round (0.6 * sampleRate);
+            const auto sinceBeat = i % beatSamples;
+            if (sinceBeat >= 400)
+                return 0.0f;
+
+            const auto noise = (float) std::sin ((double) i * 12.9898) * 43758.5453f;
+            return 0.8f * (2.0f * (noise - std::floor (noise)) - 1.0f) * std::exp (-(float) sinceBeat / 80.0f);
+        });
+
+    auto clickClip = track2->insertWaveClip (
+        "Click_Track",
+        clickTrackFile,
+        { { te::TimePosition::fromSeconds (10.0),
+            te::TimePosition::fromSeconds (18.0) },
+          te::TimeDuration() },
+        false);
+    expect (clickClip != nullptr, "Expected phase-5 click track clip");
+    timeline.rebuildTracks();
+
+    toolsComponent.selectToolForTesting ("detect_tempo");
+    timeline.getSelectionManager().selectClip (clickClip.get());
+
+    auto* tempoParams = new juce::DynamicObject();
+    tempoParams->setProperty ("add_beat_markers", true);
+    toolsComponent.setParamsForTesting (juce::var (tempoParams));
+
+    const auto bpmBeforeDetect = edit.tempoSequence.getTempo (0)->getBpm();
+    expect (std::abs (bpmBeforeDetect - 100.0) > 1.0, "Expected the test edit not to start at 100 BPM");
+
+    expect (toolsComponent.runPlanForTesting(), "Expected phase-5 tempo plan start");
+    expect (toolsComponent.waitForIdleForTesting(), "Expected phase-5 tempo plan completion");
+    expect (toolsComponent.hasPendingPlanForTesting(), "Expected pending tempo plan");
+    expect (toolsComponent.applyPlanForTesting(), "Expected phase-5 tempo apply to succeed");
+
+    expect (std::abs (edit.tempoSequence.getTempo (0)->getBpm() - 100.0) < 1.0,
+            "Expected detected tempo near 100 BPM");
+
+    auto countMarkers = [&edit]
+    {
+        auto* markerTrack = edit.getMarkerTrack();
+        return markerTrack != nullptr ? markerTrack->getClips().size() : 0;
+    };
+
+    const auto markersAfterDetect = countMarkers();
+    expect (markersAfterDetect >= 10 && markersAfterDetect <= 14,
+            "Expected about one marker per click, got " + std::to_string (markersAfterDetect));
+
+    expect (mainComponent.invokeCommandForTesting (MainComponent::cmdUndo),
+            "Expected undo command to execute for phase-5 tempo detection");
+    expect (std::abs (edit.tempoSequence.getTempo (0)->getBpm() - bpmBeforeDetect) < 0.01,
+            "Expected tempo undo to restore the original BPM");
+    expect (countMarkers() == 0, "Expected tempo undo to remove beat markers");
+
     (void) steadyClipFile.deleteFile();
     (void) trimClipFile.deleteFile();
     (void) lateTransientFile.deleteFile();
     (void) earlyTransientFile.deleteFile();
+    (void) clickTrackFile.deleteFile();
 }
 
 void runUiPhase5ModelBackedToolsRegression()
@@ -3112,6 +3799,20 @@ void runUiPhase5ModelBackedToolsRegression()
     expect (std::abs (getTrackPan (*track1) - track1PanAfterAutoMix) < 0.12f,
             "Expected auto-mix redo to restore track-1 pan");
 
+    auto* loudnessParams = new juce::DynamicObject();
+    loudnessParams->setProperty ("model_version", "1.0.0");
+    loudnessParams->setProperty ("level_mode", "loudness");
+    loudnessParams->setProperty ("target_lufs", -20.0);
+    loudnessParams->setProperty ("stereo_spread", false);
+    toolsComponent.setParamsForTesting (juce::var (loudnessParams));
+
+    expect (toolsComponent.runPlanForTesting(), "Expected loudness-mode auto-mix plan start");
+    expect (toolsComponent.waitForIdleForTesting(), "Expected loudness-mode auto-mix plan completion");
+    expect (toolsComponent.hasPendingPlanForTesting(), "Expected pending loudness-mode auto-mix plan");
+    expect (toolsComponent.getPreviewTextForTesting().contains ("Suggest volume"),
+            "Expected loudness-mode auto-mix to suggest volume moves");
+    toolsComponent.rejectPlanForTesting();
+
     auto uninstallAutoMixResult = toolsComponent.uninstallModelForTesting ("auto_mix_suggester", "1.0.0");
     expect (uninstallAutoMixResult.wasOk(), "Expected auto-mix model uninstall to succeed");
     expect (! toolsComponent.isModelInstalledForTesting ("auto_mix_suggester", "1.0.0"),
@@ -3940,11 +4641,13 @@ void runRenderDialogRegression()
     engine.getPluginManager().initialise();
 
     EditSession session (engine);
+    waive::RenderScheduler scheduler (engine, 2);
     CommandHandler commandHandler (session.getEdit());
+    commandHandler.setRenderScheduler (&scheduler);
     UndoableCommandHandler undoableHandler (commandHandler, session);
 
-    RenderDialog renderDialog (session, undoableHandler);
-    renderDialog.setBounds (0, 0, 600, 520);
+    RenderDialog renderDialog (session, undoableHandler, scheduler);
+    renderDialog.setBounds (0, 0, 600, 628);
     renderDialog.resized();
 
     expect (renderDialog.getSelectedFormatForTesting() == 1,
@@ -3971,6 +4674,16 @@ void runRenderDialogRegression()
             "Expected OGG quality hidden for FLAC");
     expect (renderDialog.getOutputPathForTesting().endsWithIgnoreCase (".flac"),
             "Expected output path to update to .flac");
+    expect (renderDialog.getSelectedNormalizationForTesting() == 1,
+            "Expected render normalisation to default to off");
+    renderDialog.selectNormalizationForTesting (3);
+    expect (renderDialog.getSelectedNormalizationForTesting() == 3,
+            "Expected loudness normalisation to be selectable");
+
+    expect (! renderDialog.isExtraFormatEnabledForTesting (2),
+            "Expected the primary format to be excluded from the extra encodes");
+    expect (renderDialog.isExtraFormatEnabledForTesting (1) && renderDialog.isExtraFormatEnabledForTesting (3),
+            "Expected the other formats to be available as extra encodes");
 
     renderDialog.selectRangeForTesting (3);
     expect (renderDialog.isCustomRangeVisibleForTesting(),
@@ -3996,6 +4709,37 @@ void runRenderDialogRegression()
     expect (renderDialog.getOutputPathForTesting().endsWithIgnoreCase (".flac"),
             "Expected mixdown mode to restore a format-aware file path");
 
+    // Extra ranges and alternate mixes expand into one batch of outputs.
+    session.getEdit().ensureNumberOfAudioTracks (2);
+    te::getAudioTracks (session.getEdit())[0]->setName ("Drums");
+    te::getAudioTracks (session.getEdit())[1]->setName ("Bass");
+    auto outputDir = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                         .getChildFile ("waive_render_dialog_" + juce::Uuid().toString());
+    outputDir.createDirectory();
+    renderDialog.selectRangeForTesting (3);
+    renderDialog.setCustomRangeForTesting ("0", "10");
+    renderDialog.setOutputPathForTesting (outputDir.getChildFile ("Mix.flac").getFullPathName());
+    renderDialog.setAlternateMixesForTesting (true);
+
+    renderDialog.setExtraRangesForTesting ("5-2");
+    expect (! renderDialog.triggerRenderForTesting(), "Expected a reversed extra range to be rejected");
+
+    renderDialog.setExtraRangesForTesting ("0-30, 60-90.5");
+    expect (renderDialog.triggerRenderForTesting(), "Expected extra ranges to validate");
+    const auto planned = renderDialog.getPlannedOutputNamesForTesting();
+    expect (planned.size() == 9, "Expected a mix plus two alternate mixes for each of three ranges");
+    expect (planned.contains ("Mix") && planned.contains ("Mix_0-30s") && planned.contains ("Mix_60-90.5s"),
+            "Expected extra ranges to be named by their bounds");
+    expect (planned.contains ("Mix_without_Drums") && planned.contains ("Mix_60-90.5s_without_Bass"),
+            "Expected an alternate mix named after each muted track");
+
+    renderDialog.setStemsModeForTesting (true);
+    renderDialog.setExtraRangesForTesting ({});
+    expect (renderDialog.triggerRenderForTesting(), "Expected stems render preparation to succeed");
+    expect (renderDialog.getPlannedOutputNamesForTesting() == juce::StringArray { "01_Drums", "02_Bass" },
+            "Expected one stem per track and no alternate mixes in stems mode");
+
+    (void) outputDir.deleteRecursively();
     std::cout << "runRenderDialogRegression: PASS" << std::endl;
 }
 
@@ -4268,6 +5012,8 @@ int main()
     RUN_TEST_SAFELY(runAutoSaveDiscardOnRecoverRegression);
     RUN_TEST_SAFELY(runAutoSaveSaveAsCleanupRegression);
     RUN_TEST_SAFELY(runSaveAsFailurePreservesCurrentProjectStateRegression);
+    RUN_TEST_SAFELY(runBinaryProjectSaveAsAndRecoveryRegression);
+    RUN_TEST_SAFELY(runBackgroundSaveRegression);
     RUN_TEST_SAFELY(runUndoRedoDirtyStateNotificationRegression);
     RUN_TEST_SAFELY(runCollectAndPackageCommandsClearDirtyStateRegression);
     RUN_TEST_SAFELY(runModelStorageAllowlistRefreshRegression);
@@ -4283,6 +5029,10 @@ int main()
     RUN_TEST_SAFELY(runConsoleErrorStatusRegression);
     RUN_TEST_SAFELY(runToolSidebarNoChangePlanRegression);
     RUN_TEST_SAFELY(runToolSidebarEditSwapClearsPendingPlanRegression);
+    RUN_TEST_SAFELY(runToolSidebarSpeculativePlanRegression);
+    RUN_TEST_SAFELY(runTimelineRefreshesOnceAfterBulkEditRegression);
+    RUN_TEST_SAFELY(runLibrarySearchPanelRegression);
+    RUN_TEST_SAFELY(runTimelineBulkImportRegression);
 
     if (automatedDialogHarness)
     {
@@ -124,8 +124,13 @@ def main():
         if was_mono:
             samples = samples.reshape(-1, 1)
 
-        # Measure current loudness
-        current_lufs = float(compute_lufs(samples, sr))
+        # Measure current loudness; prefer the host's EBU R128 measurement
+        approx_lufs = float(compute_lufs(samples, sr))
+        host_loudness = params.get("input_loudness") or {}
+        if "integrated_lufs" in host_loudness and host_loudness["integrated_lufs"] > -70:
+            current_lufs = round(float(host_loudness["integrated_lufs"]), 1)
+        else:
+            current_lufs = approx_lufs
 
         # Calculate gain adjustment
         gain_db = target_lufs - current_lufs
@@ -141,7 +146,8 @@ def main():
             result = soft_limit(result, ceiling_linear)
 
         # Measure final loudness
-        final_lufs = float(compute_lufs(result, sr))
+        # Carry the approximation's change over onto the (possibly host) baseline
+        final_lufs = float(round(current_lufs + float(compute_lufs(result, sr)) - approx_lufs, 1))
         final_peak_db = float(round(20 * np.log10(np.max(np.abs(result)) + 1e-20), 1))
 
         if was_mono: